@@ -46,6 +46,7 @@ either expressed or implied, of the Regents of The University of Michigan.
 
 #include "common/image_u8.h"
 #include "common/image_u8x3.h"
+#include "common/unionfind.h"
 #include "common/zhash.h"
 #include "common/zarray.h"
 #include "common/matd.h"
@@ -392,6 +393,11 @@ void apriltag_detector_destroy(apriltag_detector_t *td)
     timeprofile_destroy(td->tp);
     workerpool_destroy(td->wp);
 
+    free(td->threshim_buf);
+    free(td->tile_buf);
+    if (td->uf_buf)
+        unionfind_destroy(td->uf_buf);
+
     apriltag_detector_clear_families(td);
 
     zarray_destroy(td->tag_families);
@@ -186,6 +186,16 @@ struct apriltag_detector
     // Used to manage multi-threading.
     workerpool_t *wp;
 
+    // Buffers of the quad detection kept from one call to the next, so
+    // that a stream of images of the same size is processed without
+    // allocating them again.
+    image_u8_t threshim;
+    uint8_t *threshim_buf;
+    size_t threshim_buf_size;
+    uint8_t *tile_buf;
+    size_t tile_buf_size;
+    struct unionfind *uf_buf;
+
     // Used for thread safety.
     pthread_mutex_t mutex;
 };
@@ -47,6 +47,19 @@ either expressed or implied, of the Regents of The University of Michigan.
 #include "common/postscript_utils.h"
 #include "common/math_util.h"
 
+#if defined __AVX2__
+#include <immintrin.h>
+#define APRILTAG_HAVE_AVX2 1
+#endif
+#if defined __SSE2__ || defined _M_X64 || (defined _M_IX86_FP && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define APRILTAG_HAVE_SSE2 1
+#endif
+#if defined __ARM_NEON && defined __aarch64__
+#include <arm_neon.h>
+#define APRILTAG_HAVE_NEON 1
+#endif
+
 #ifdef _WIN32
 static inline long int random(void)
 {
@@ -58,34 +71,96 @@ static inline uint32_t u64hash_2(uint64_t x) {
     return (2654435761U * x) >> 32;
 }
 
+struct pt
+{
+    // Note: these represent 2*actual value.
+    uint16_t x, y;
+    int16_t gx, gy;
+
+    float slope;
+};
+
 struct uint64_zarray_entry
 {
     uint64_t id;
     zarray_t *cluster;
+};
 
-    struct uint64_zarray_entry *next;
+// open addressing hash table of the clusters, with linear probing. An id
+// of 0 marks an empty slot: a cluster id is never 0 since it joins two
+// different components.
+struct cluster_table
+{
+    struct uint64_zarray_entry *entries;
+    uint32_t capacity; // power of 2
+    uint32_t size;
+    int shift;
+
+    // the last accessed cluster, since neighboring pixels are most often
+    // added to the same cluster.
+    struct uint64_zarray_entry last;
 };
 
-#ifndef M_PI
-# define M_PI 3.141592653589793238462643383279502884196
-#endif
+static void cluster_table_init(struct cluster_table *table, int bits)
+{
+    table->capacity = 1u << bits;
+    table->shift = 64 - bits;
+    table->size = 0;
+    table->entries = (struct uint64_zarray_entry *)calloc(table->capacity, sizeof(struct uint64_zarray_entry));
+    table->last.id = 0;
+    table->last.cluster = NULL;
+}
 
-struct pt
+static inline uint32_t cluster_table_slot(const struct cluster_table *table, uint64_t id)
 {
-    // Note: these represent 2*actual value.
-    uint16_t x, y;
-    int16_t gx, gy;
+    return (uint32_t)((id * 0x9E3779B97F4A7C15ULL) >> table->shift);
+}
 
-    float slope;
-};
+static void cluster_table_grow(struct cluster_table *table)
+{
+    struct uint64_zarray_entry *entries = table->entries;
+    uint32_t capacity = table->capacity;
 
-struct unionfind_task
+    cluster_table_init(table, 64 - table->shift + 1);
+    for (uint32_t i = 0; i < capacity; i++) {
+        if (entries[i].id == 0)
+            continue;
+        uint32_t slot = cluster_table_slot(table, entries[i].id);
+        while (table->entries[slot].id != 0)
+            slot = (slot + 1) & (table->capacity - 1);
+        table->entries[slot] = entries[i];
+        table->size++;
+    }
+    free(entries);
+}
+
+static inline zarray_t *cluster_table_get(struct cluster_table *table, uint64_t id)
 {
-    int y0, y1;
-    int w, h, s;
-    unionfind_t *uf;
-    image_u8_t *im;
-};
+    if (table->last.id == id)
+        return table->last.cluster;
+
+    uint32_t slot = cluster_table_slot(table, id);
+    while (table->entries[slot].id != 0 && table->entries[slot].id != id)
+        slot = (slot + 1) & (table->capacity - 1);
+
+    if (table->entries[slot].id == 0) {
+        // keep the load factor under 1/2
+        if (2*(table->size + 1) > table->capacity) {
+            cluster_table_grow(table);
+            return cluster_table_get(table, id);
+        }
+        table->entries[slot].id = id;
+        table->entries[slot].cluster = zarray_create(sizeof(struct pt));
+        table->size++;
+    }
+
+    table->last = table->entries[slot];
+    return table->last.cluster;
+}
+
+#ifndef M_PI
+# define M_PI 3.141592653589793238462643383279502884196
+#endif
 
 struct quad_task
 {
@@ -985,70 +1060,135 @@ int fit_quad(
     return res;
 }
 
-#define DO_UNIONFIND2(dx, dy) if (im->buf[(y + dy)*s + x + dx] == v) unionfind_connect(uf, y*w + x, (y + dy)*w + x + dx);
-
-static void do_unionfind_first_line(unionfind_t *uf, image_u8_t *im, int h, int w, int s)
+// The connected components are found on runs of pixels rather than on
+// single pixels. A run is a maximal horizontal segment of pixels with the
+// same value (0 or 255), that are connected by the horizontal edges. The
+// first pixel of a run is its representative: it holds the size of the run
+// and the other pixels of the run point to it, so that all the records
+// are written while the runs are extracted and the union-find structure
+// does not need to be initialized.
+//
+// The components are exactly the ones of the original pixel-wise
+// algorithm, which considers the pixels x in [1, w-2] with their left,
+// upper, upper-left and upper-right neighbors (the two diagonals only for
+// white pixels). Hence the horizontal edges only join the columns [0, w-2]
+// and the last column is only joined by the upper-right diagonal of the
+// pixel (w-2, y), when (w-2, y-1) is not white.
+struct uf_run
 {
-    int y = 0;
+    int c0, c1; // [c0, c1]
     uint8_t v;
+};
 
-    for (int x = 1; x < w - 1; x++) {
-        v = im->buf[y*s + x];
+struct unionfind_task
+{
+    int y0, y1; // [y0, y1)
+    int w, s;
+    unionfind_t *uf;
+    image_u8_t *im;
+    struct uf_run *runs; // 2*w runs
+};
 
-        if (v == 127)
+// Extract the runs of row y. When write is set, the records of all the
+// pixels of the row are also written.
+static int do_unionfind_runs(unionfind_t *uf, image_u8_t *im, int w, int s, int y, struct uf_run *runs, int write)
+{
+    const uint8_t *row = im->buf + y*s;
+    struct ufrec *rec = uf->data + (uint32_t)y*w;
+    uint32_t base = (uint32_t)y*w;
+    int nruns = 0;
+
+    int x = 0;
+    while (x < w - 1) {
+        uint8_t v = row[x];
+        if (v == 127) {
+            if (write) {
+                rec[x].parent = base + x;
+                rec[x].size = 1;
+            }
+            x++;
             continue;
+        }
+
+        int c0 = x;
+        x++;
+        while (x < w - 1 && row[x] == v) {
+            if (write) {
+                rec[x].parent = base + c0;
+                rec[x].size = 1;
+            }
+            x++;
+        }
+
+        if (write) {
+            rec[c0].parent = base + c0;
+            rec[c0].size = x - c0;
+        }
+        runs[nruns].c0 = c0;
+        runs[nruns].c1 = x - 1;
+        runs[nruns].v = v;
+        nruns++;
+    }
 
-        DO_UNIONFIND2(-1, 0);
+    if (write && w > 0) {
+        rec[w - 1].parent = base + w - 1;
+        rec[w - 1].size = 1;
     }
+
+    return nruns;
 }
 
-static void do_unionfind_line2(unionfind_t *uf, image_u8_t *im, int h, int w, int s, int y)
+// Connect the runs of row y to the runs of row y-1.
+static void do_unionfind_connect_runs(unionfind_t *uf, image_u8_t *im, int w, int s, int y,
+                                      const struct uf_run *runs, int nruns,
+                                      const struct uf_run *prev, int nprev)
 {
-    assert(y > 0);
-
-    uint8_t v_m1_m1;
-    uint8_t v_0_m1 = im->buf[(y - 1)*s];
-    uint8_t v_1_m1 = im->buf[(y - 1)*s + 1];
-    uint8_t v_m1_0;
-    uint8_t v = im->buf[y*s];
-
-    for (int x = 1; x < w - 1; x++) {
-        v_m1_m1 = v_0_m1;
-        v_0_m1 = v_1_m1;
-        v_1_m1 = im->buf[(y - 1)*s + x + 1];
-        v_m1_0 = v;
-        v = im->buf[y*s + x];
-
-        if (v == 127)
+    uint32_t base = (uint32_t)y*w, prev_base = (uint32_t)(y - 1)*w;
+
+    int j = 0;
+    for (int i = 0; i < nruns; i++) {
+        // the first column has no upper neighbor of its own
+        int lo = runs[i].c0 > 1 ? runs[i].c0 : 1;
+        int hi = runs[i].c1;
+        if (lo > hi)
             continue;
 
-        // (dx,dy) pairs for 8 connectivity:
-        // (-1, -1)    (0, -1)    (1, -1)
-        // (-1, 0)    (REFERENCE)
-        DO_UNIONFIND2(-1, 0);
-
-        if (x == 1 || !((v_m1_0 == v_m1_m1) && (v_m1_m1 == v_0_m1))) {
-            DO_UNIONFIND2(0, -1);
+        if (runs[i].v == 255) {
+            lo--;
+            hi++;
         }
 
-        if (v == 255) {
-            if (x == 1 || !(v_m1_0 == v_m1_m1 || v_0_m1 == v_m1_m1) ) {
-                DO_UNIONFIND2(-1, -1);
-            }
-            if (!(v_0_m1 == v_1_m1)) {
-                DO_UNIONFIND2(1, -1);
-            }
+        while (j < nprev && prev[j].c1 < lo)
+            j++;
+
+        for (int k = j; k < nprev && prev[k].c0 <= hi; k++) {
+            if (prev[k].v == runs[i].v)
+                unionfind_connect(uf, base + runs[i].c0, prev_base + prev[k].c0);
         }
     }
+
+    if (w >= 3) {
+        const uint8_t *row = im->buf + y*s;
+        const uint8_t *prev_row = row - s;
+        if (row[w - 2] == 255 && prev_row[w - 1] == 255 && prev_row[w - 2] != 255)
+            unionfind_connect(uf, base + w - 2, prev_base + w - 1);
+    }
 }
-#undef DO_UNIONFIND2
 
 static void do_unionfind_task2(void *p)
 {
     struct unionfind_task *task = (struct unionfind_task*) p;
+    struct uf_run *runs = task->runs, *prev = task->runs + task->w;
+
+    int nprev = do_unionfind_runs(task->uf, task->im, task->w, task->s, task->y0, prev, 1);
+    for (int y = task->y0 + 1; y < task->y1; y++) {
+        int nruns = do_unionfind_runs(task->uf, task->im, task->w, task->s, y, runs, 1);
+        do_unionfind_connect_runs(task->uf, task->im, task->w, task->s, y, runs, nruns, prev, nprev);
 
-    for (int y = task->y0; y < task->y1; y++) {
-        do_unionfind_line2(task->uf, task->im, task->h, task->w, task->s, y);
+        struct uf_run *tmp = prev;
+        prev = runs;
+        runs = tmp;
+        nprev = nruns;
     }
 }
 
@@ -1090,14 +1230,197 @@ static void do_quad_task(void *p)
     }
 }
 
+#if defined APRILTAG_HAVE_SSE2
+// maximum of each group of 4 consecutive bytes, in the low byte of each
+// 32 bits word.
+static inline __m128i max_epu8_x4(__m128i v)
+{
+    v = _mm_max_epu8(v, _mm_srli_epi16(v, 8));
+    v = _mm_max_epu8(v, _mm_srli_epi32(v, 16));
+    return _mm_and_si128(v, _mm_set1_epi32(0xff));
+}
+
+static inline __m128i tiles_max_16(const __m128i *v)
+{
+    __m128i lo = _mm_packs_epi32(max_epu8_x4(v[0]), max_epu8_x4(v[1]));
+    __m128i hi = _mm_packs_epi32(max_epu8_x4(v[2]), max_epu8_x4(v[3]));
+    return _mm_packus_epi16(lo, hi);
+}
+#endif
+
+#if defined APRILTAG_HAVE_AVX2
+static inline __m256i max_epu8_x4_256(__m256i v)
+{
+    v = _mm256_max_epu8(v, _mm256_srli_epi16(v, 8));
+    v = _mm256_max_epu8(v, _mm256_srli_epi32(v, 16));
+    return _mm256_and_si256(v, _mm256_set1_epi32(0xff));
+}
+
+static inline __m256i tiles_max_32(const __m256i *v)
+{
+    __m256i lo = _mm256_packs_epi32(max_epu8_x4_256(v[0]), max_epu8_x4_256(v[1]));
+    __m256i hi = _mm256_packs_epi32(max_epu8_x4_256(v[2]), max_epu8_x4_256(v[3]));
+    // the packs work within each 128 bits lane
+    return _mm256_permutevar8x32_epi32(_mm256_packus_epi16(lo, hi), _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7));
+}
+#endif
+
+// Compute the min/max of the 4x4 tiles [tx0, tx1) of the tile row starting
+// at row. Return the first tile that has not been processed.
+static int tile_minmax_simd(const uint8_t *row, int s, int tx0, int tx1, uint8_t *im_max, uint8_t *im_min)
+{
+    int tx = tx0;
+#if defined APRILTAG_HAVE_AVX2
+    const __m256i ones = _mm256_set1_epi8((char)0xff);
+    for (; tx + 32 <= tx1; tx += 32) {
+        __m256i vmax[4], vmin[4];
+        for (int i = 0; i < 4; i++) {
+            const uint8_t *p = row + 4*tx + 32*i;
+            __m256i r0 = _mm256_loadu_si256((const __m256i *)p);
+            __m256i r1 = _mm256_loadu_si256((const __m256i *)(p + s));
+            __m256i r2 = _mm256_loadu_si256((const __m256i *)(p + 2*s));
+            __m256i r3 = _mm256_loadu_si256((const __m256i *)(p + 3*s));
+            vmax[i] = _mm256_max_epu8(_mm256_max_epu8(r0, r1), _mm256_max_epu8(r2, r3));
+            // min(v) = 255 - max(255 - v)
+            vmin[i] = _mm256_xor_si256(_mm256_min_epu8(_mm256_min_epu8(r0, r1), _mm256_min_epu8(r2, r3)), ones);
+        }
+        _mm256_storeu_si256((__m256i *)(im_max + tx), tiles_max_32(vmax));
+        _mm256_storeu_si256((__m256i *)(im_min + tx), _mm256_xor_si256(tiles_max_32(vmin), ones));
+    }
+#endif
+#if defined APRILTAG_HAVE_SSE2
+    const __m128i ones_128 = _mm_set1_epi8((char)0xff);
+    for (; tx + 16 <= tx1; tx += 16) {
+        __m128i vmax[4], vmin[4];
+        for (int i = 0; i < 4; i++) {
+            const uint8_t *p = row + 4*tx + 16*i;
+            __m128i r0 = _mm_loadu_si128((const __m128i *)p);
+            __m128i r1 = _mm_loadu_si128((const __m128i *)(p + s));
+            __m128i r2 = _mm_loadu_si128((const __m128i *)(p + 2*s));
+            __m128i r3 = _mm_loadu_si128((const __m128i *)(p + 3*s));
+            vmax[i] = _mm_max_epu8(_mm_max_epu8(r0, r1), _mm_max_epu8(r2, r3));
+            vmin[i] = _mm_xor_si128(_mm_min_epu8(_mm_min_epu8(r0, r1), _mm_min_epu8(r2, r3)), ones_128);
+        }
+        _mm_storeu_si128((__m128i *)(im_max + tx), tiles_max_16(vmax));
+        _mm_storeu_si128((__m128i *)(im_min + tx), _mm_xor_si128(tiles_max_16(vmin), ones_128));
+    }
+#elif defined APRILTAG_HAVE_NEON
+    for (; tx + 16 <= tx1; tx += 16) {
+        uint8x16_t vmax[4], vmin[4];
+        for (int i = 0; i < 4; i++) {
+            const uint8_t *p = row + 4*tx + 16*i;
+            uint8x16_t r0 = vld1q_u8(p);
+            uint8x16_t r1 = vld1q_u8(p + s);
+            uint8x16_t r2 = vld1q_u8(p + 2*s);
+            uint8x16_t r3 = vld1q_u8(p + 3*s);
+            vmax[i] = vmaxq_u8(vmaxq_u8(r0, r1), vmaxq_u8(r2, r3));
+            vmin[i] = vminq_u8(vminq_u8(r0, r1), vminq_u8(r2, r3));
+        }
+        // two rounds of pairwise max/min reduce each group of 4 bytes
+        vst1q_u8(im_max + tx, vpmaxq_u8(vpmaxq_u8(vmax[0], vmax[1]), vpmaxq_u8(vmax[2], vmax[3])));
+        vst1q_u8(im_min + tx, vpminq_u8(vpminq_u8(vmin[0], vmin[1]), vpminq_u8(vmin[2], vmin[3])));
+    }
+#else
+    (void)row;
+    (void)s;
+    (void)im_max;
+    (void)im_min;
+#endif
+    return tx;
+}
+
+// Threshold the rows [y, y+4) of the tiles [tx0, tx1), given the threshold
+// of each tile and a mask set to 0xff for the low contrast tiles. Return
+// the first tile that has not been processed.
+static int tile_threshold_simd(const uint8_t *src, uint8_t *dst, int s, int tx0, int tx1,
+                               const uint8_t *thresh, const uint8_t *low)
+{
+    int tx = tx0;
+#if defined APRILTAG_HAVE_AVX2
+    const __m256i sign = _mm256_set1_epi8((char)0x80);
+    const __m256i gray = _mm256_set1_epi8(127);
+    for (; tx + 8 <= tx1; tx += 8) {
+        // replicate the value of each tile on its 4 columns
+        __m128i t = _mm_loadl_epi64((const __m128i *)(thresh + tx));
+        __m128i m = _mm_loadl_epi64((const __m128i *)(low + tx));
+        t = _mm_unpacklo_epi8(t, t);
+        m = _mm_unpacklo_epi8(m, m);
+        __m256i vt = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_unpacklo_epi16(t, t)), _mm_unpackhi_epi16(t, t), 1);
+        __m256i vm = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_unpacklo_epi16(m, m)), _mm_unpackhi_epi16(m, m), 1);
+        vt = _mm256_xor_si256(vt, sign);
+        __m256i vgray = _mm256_and_si256(vm, gray);
+
+        for (int dy = 0; dy < 4; dy++) {
+            __m256i v = _mm256_loadu_si256((const __m256i *)(src + dy*s + 4*tx));
+            // unsigned v > thresh
+            __m256i gt = _mm256_cmpgt_epi8(_mm256_xor_si256(v, sign), vt);
+            _mm256_storeu_si256((__m256i *)(dst + dy*s + 4*tx), _mm256_or_si256(vgray, _mm256_andnot_si256(vm, gt)));
+        }
+    }
+#endif
+#if defined APRILTAG_HAVE_SSE2
+    const __m128i sign_128 = _mm_set1_epi8((char)0x80);
+    const __m128i gray_128 = _mm_set1_epi8(127);
+    for (; tx + 4 <= tx1; tx += 4) {
+        int32_t t32, m32;
+        memcpy(&t32, thresh + tx, sizeof(t32));
+        memcpy(&m32, low + tx, sizeof(m32));
+        __m128i vt = _mm_cvtsi32_si128(t32);
+        __m128i vm = _mm_cvtsi32_si128(m32);
+        vt = _mm_unpacklo_epi8(vt, vt);
+        vm = _mm_unpacklo_epi8(vm, vm);
+        vt = _mm_xor_si128(_mm_unpacklo_epi16(vt, vt), sign_128);
+        vm = _mm_unpacklo_epi16(vm, vm);
+        __m128i vgray = _mm_and_si128(vm, gray_128);
+
+        for (int dy = 0; dy < 4; dy++) {
+            __m128i v = _mm_loadu_si128((const __m128i *)(src + dy*s + 4*tx));
+            __m128i gt = _mm_cmpgt_epi8(_mm_xor_si128(v, sign_128), vt);
+            _mm_storeu_si128((__m128i *)(dst + dy*s + 4*tx), _mm_or_si128(vgray, _mm_andnot_si128(vm, gt)));
+        }
+    }
+#elif defined APRILTAG_HAVE_NEON
+    static const uint8_t expand[16] = { 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3 };
+    const uint8x16_t idx = vld1q_u8(expand);
+    const uint8x16_t gray = vdupq_n_u8(127);
+    for (; tx + 4 <= tx1; tx += 4) {
+        uint32_t t32, m32;
+        memcpy(&t32, thresh + tx, sizeof(t32));
+        memcpy(&m32, low + tx, sizeof(m32));
+        uint8x16_t vt = vqtbl1q_u8(vreinterpretq_u8_u32(vdupq_n_u32(t32)), idx);
+        uint8x16_t vm = vqtbl1q_u8(vreinterpretq_u8_u32(vdupq_n_u32(m32)), idx);
+
+        for (int dy = 0; dy < 4; dy++) {
+            uint8x16_t v = vld1q_u8(src + dy*s + 4*tx);
+            vst1q_u8(dst + dy*s + 4*tx, vbslq_u8(vm, gray, vcgtq_u8(v, vt)));
+        }
+    }
+#else
+    (void)src;
+    (void)dst;
+    (void)s;
+    (void)thresh;
+    (void)low;
+#endif
+    return tx;
+}
+
 image_u8_t *threshold(apriltag_detector_t *td, image_u8_t *im)
 {
     int w = im->width, h = im->height, s = im->stride;
     assert(w < 32768);
     assert(h < 32768);
 
-    image_u8_t *threshim = image_u8_create_alignment(w, h, s);
-    assert(threshim->stride == s);
+    // the thresholded image is kept by the detector and only grows when
+    // a larger image is processed. Every pixel is written below.
+    if (td->threshim_buf_size < (size_t)h*s) {
+        free(td->threshim_buf);
+        td->threshim_buf = (uint8_t *)malloc((size_t)h*s*sizeof(uint8_t));
+        td->threshim_buf_size = (size_t)h*s;
+    }
+    image_u8_t header = { (int32_t)w, (int32_t)h, (int32_t)s, td->threshim_buf };
+    memcpy(&td->threshim, &header, sizeof(image_u8_t));
+    image_u8_t *threshim = &td->threshim;
 
     // The idea is to find the maximum and minimum values in a
     // window around each pixel. If it's a contrast-free region
@@ -1129,12 +1452,23 @@ image_u8_t *threshold(apriltag_detector_t *td, image_u8_t *im)
     int tw = w / tilesz;
     int th = h / tilesz;
 
-    uint8_t *im_max = (uint8_t *)calloc(tw*th, sizeof(uint8_t));
-    uint8_t *im_min = (uint8_t *)calloc(tw*th, sizeof(uint8_t));
+    // the min/max tiles, their blurred version and the thresholds of a
+    // row of tiles share a buffer that is kept by the detector. Every tile
+    // is written before being read.
+    size_t tile_size = (size_t)tw*th;
+    if (td->tile_buf_size < 4*tile_size + 2*tw) {
+        free(td->tile_buf);
+        td->tile_buf = (uint8_t *)malloc((4*tile_size + 2*tw)*sizeof(uint8_t));
+        td->tile_buf_size = 4*tile_size + 2*tw;
+    }
+    uint8_t *im_max = td->tile_buf;
+    uint8_t *im_min = im_max + tile_size;
 
     // first, collect min/max statistics for each tile
     for (int ty = 0; ty < th; ty++) {
-        for (int tx = 0; tx < tw; tx++) {
+        int tx0 = tile_minmax_simd(im->buf + ty*tilesz*s, s, 0, tw, im_max + ty*tw, im_min + ty*tw);
+
+        for (int tx = tx0; tx < tw; tx++) {
             uint8_t max = 0, min = 255;
 
             for (int dy = 0; dy < tilesz; dy++) {
@@ -1158,8 +1492,8 @@ image_u8_t *threshold(apriltag_detector_t *td, image_u8_t *im)
     // over larger areas. This reduces artifacts due to abrupt changes
     // in the threshold value.
     if (1) {
-        uint8_t *im_max_tmp = (uint8_t *)calloc(tw*th, sizeof(uint8_t));
-        uint8_t *im_min_tmp = (uint8_t *)calloc(tw*th, sizeof(uint8_t));
+        uint8_t *im_max_tmp = im_min + tile_size;
+        uint8_t *im_min_tmp = im_max_tmp + tile_size;
 
         for (int ty = 0; ty < th; ty++) {
             for (int tx = 0; tx < tw; tx++) {
@@ -1185,49 +1519,50 @@ image_u8_t *threshold(apriltag_detector_t *td, image_u8_t *im)
                 im_min_tmp[ty*tw + tx] = min;
             }
         }
-        free(im_max);
-        free(im_min);
         im_max = im_max_tmp;
         im_min = im_min_tmp;
     }
 
+    uint8_t *tile_thresh = td->tile_buf + 4*tile_size;
+    uint8_t *tile_low = tile_thresh + tw;
+
     for (int ty = 0; ty < th; ty++) {
         for (int tx = 0; tx < tw; tx++) {
 
             int min = im_min[ty*tw + tx];
             int max = im_max[ty*tw + tx];
 
-            // low contrast region? (no edges)
+            // low contrast region? (no edges) Its pixels are set to 127.
+            // Otherwise, actually threshold this tile.
+            //
+            // argument for biasing towards dark; specular highlights
+            // can be substantially brighter than white tag parts
             if (max - min < td->qtp.min_white_black_diff) {
-                for (int dy = 0; dy < tilesz; dy++) {
-                    int y = ty*tilesz + dy;
-
-                    for (int dx = 0; dx < tilesz; dx++) {
-                        int x = tx*tilesz + dx;
-
-                        threshim->buf[y*s+x] = 127;
-                    }
-                }
-                continue;
+                tile_low[tx] = 0xff;
+                tile_thresh[tx] = 0;
+            } else {
+                tile_low[tx] = 0;
+                tile_thresh[tx] = min + (max - min) / 2;
             }
+        }
 
-            // otherwise, actually threshold this tile.
+        uint8_t *src = im->buf + ty*tilesz*s;
+        uint8_t *dst = threshim->buf + ty*tilesz*s;
+        int tx0 = tile_threshold_simd(src, dst, s, 0, tw, tile_thresh, tile_low);
 
-            // argument for biasing towards dark; specular highlights
-            // can be substantially brighter than white tag parts
-            uint8_t thresh = min + (max - min) / 2;
+        for (int tx = tx0; tx < tw; tx++) {
+            uint8_t thresh = tile_thresh[tx];
 
             for (int dy = 0; dy < tilesz; dy++) {
-                int y = ty*tilesz + dy;
-
                 for (int dx = 0; dx < tilesz; dx++) {
                     int x = tx*tilesz + dx;
 
-                    uint8_t v = im->buf[y*s+x];
-                    if (v > thresh)
-                        threshim->buf[y*s+x] = 255;
+                    if (tile_low[tx])
+                        dst[dy*s+x] = 127;
+                    else if (src[dy*s+x] > thresh)
+                        dst[dy*s+x] = 255;
                     else
-                        threshim->buf[y*s+x] = 0;
+                        dst[dy*s+x] = 0;
                 }
             }
         }
@@ -1270,9 +1605,6 @@ image_u8_t *threshold(apriltag_detector_t *td, image_u8_t *im)
         }
     }
 
-    free(im_min);
-    free(im_max);
-
     // this is a dilate/erode deglitching scheme that does not improve
     // anything as far as I can tell.
     if (0 || td->qtp.deglitch) {
@@ -1434,71 +1766,87 @@ image_u8_t *threshold_bayer(apriltag_detector_t *td, image_u8_t *im)
 }
 
 unionfind_t* connected_components(apriltag_detector_t *td, image_u8_t* threshim, int w, int h, int ts) {
-    unionfind_t *uf = unionfind_create(w * h);
-
-    if (td->nthreads <= 1) {
-        do_unionfind_first_line(uf, threshim, h, w, ts);
-        for (int y = 1; y < h; y++) {
-            do_unionfind_line2(uf, threshim, h, w, ts, y);
-        }
-    } else {
-        do_unionfind_first_line(uf, threshim, h, w, ts);
-
-        int sz = h;
-        int chunksize = 1 + sz / (APRILTAG_TASKS_PER_THREAD_TARGET * td->nthreads);
-        struct unionfind_task *tasks = (struct unionfind_task *)malloc(sizeof(struct unionfind_task)*(sz / chunksize + 1));
+    // the union-find records are kept by the detector between calls. They
+    // are all written when the runs are extracted.
+    unionfind_t *uf = unionfind_reserve(td->uf_buf, w * h);
+    td->uf_buf = uf;
+
+    // first pass: the rows are split in strips whose runs are connected
+    // in parallel, each task only touching the records of its strip.
+    int sz = h;
+    int chunksize = 1 + sz / (APRILTAG_TASKS_PER_THREAD_TARGET * td->nthreads);
+    if (td->nthreads <= 1)
+        chunksize = sz;
+    int maxtasks = sz / chunksize + 1;
+    struct unionfind_task *tasks = (struct unionfind_task *)malloc(sizeof(struct unionfind_task)*maxtasks);
+    struct uf_run *runs = (struct uf_run *)malloc(sizeof(struct uf_run)*2*(w + 1)*maxtasks);
 
-        int ntasks = 0;
+    int ntasks = 0;
 
-        for (int i = 1; i < sz; i += chunksize) {
-            // each task will process [y0, y1). Note that this attaches
-            // each cell to the right and down, so row y1 *is* potentially modified.
-            //
-            // for parallelization, make sure that each task doesn't touch rows
-            // used by another thread.
-            tasks[ntasks].y0 = i;
-            tasks[ntasks].y1 = imin(sz, i + chunksize - 1);
-            tasks[ntasks].h = h;
-            tasks[ntasks].w = w;
-            tasks[ntasks].s = ts;
-            tasks[ntasks].uf = uf;
-            tasks[ntasks].im = threshim;
-
-            workerpool_add_task(td->wp, do_unionfind_task2, &tasks[ntasks]);
-            ntasks++;
-        }
+    for (int i = 0; i < sz; i += chunksize) {
+        tasks[ntasks].y0 = i;
+        tasks[ntasks].y1 = imin(sz, i + chunksize);
+        tasks[ntasks].w = w;
+        tasks[ntasks].s = ts;
+        tasks[ntasks].uf = uf;
+        tasks[ntasks].im = threshim;
+        tasks[ntasks].runs = runs + 2*(w + 1)*ntasks;
 
-        workerpool_run(td->wp);
+        workerpool_add_task(td->wp, do_unionfind_task2, &tasks[ntasks]);
+        ntasks++;
+    }
 
-        // XXX stitch together the different chunks.
-        for (int i = 1; i < ntasks; i++) {
-            do_unionfind_line2(uf, threshim, h, w, ts, tasks[i].y0 - 1);
-        }
+    workerpool_run(td->wp);
 
-        free(tasks);
+    // second pass: stitch together the different strips.
+    struct uf_run *prev = runs + w + 1;
+    for (int i = 1; i < ntasks; i++) {
+        int y = tasks[i].y0;
+        int nprev = do_unionfind_runs(uf, threshim, w, ts, y - 1, prev, 0);
+        int nruns = do_unionfind_runs(uf, threshim, w, ts, y, runs, 0);
+        do_unionfind_connect_runs(uf, threshim, w, ts, y, runs, nruns, prev, nprev);
     }
+
+    free(runs);
+    free(tasks);
     return uf;
 }
 
-zarray_t* do_gradient_clusters(image_u8_t* threshim, int ts, int y0, int y1, int w, int nclustermap, unionfind_t* uf, zarray_t* clusters) {
-    struct uint64_zarray_entry **clustermap = (struct uint64_zarray_entry **)calloc(nclustermap, sizeof(struct uint64_zarray_entry*));
+static int cluster_hash_compare(const void *_a, const void *_b)
+{
+    const struct cluster_hash *a = (const struct cluster_hash *)_a;
+    const struct cluster_hash *b = (const struct cluster_hash *)_b;
 
-    int mem_chunk_size = 2048;
-    struct uint64_zarray_entry** mem_pools = (struct uint64_zarray_entry**)malloc(sizeof(struct uint64_zarray_entry *)*2*nclustermap/mem_chunk_size);
-    int mem_pool_idx = 0;
-    int mem_pool_loc = 0;
-    mem_pools[mem_pool_idx] = (struct uint64_zarray_entry *)calloc(mem_chunk_size, sizeof(struct uint64_zarray_entry));
+    if (a->hash != b->hash)
+        return a->hash < b->hash ? -1 : 1;
+    if (a->id != b->id)
+        return a->id < b->id ? -1 : 1;
+    return 0;
+}
+
+zarray_t* do_gradient_clusters(image_u8_t* threshim, int ts, int y0, int y1, int w, int nclustermap, unionfind_t* uf, zarray_t* clusters) {
+    struct cluster_table table;
+    cluster_table_init(&table, 10);
 
     for (int y = y0; y < y1; y++) {
+        uint8_t v_prev = 127;
+        uint64_t rep0 = 0;
+
         for (int x = 1; x < w-1; x++) {
 
             uint8_t v0 = threshim->buf[y*ts + x];
-            if (v0 == 127)
+            if (v0 == 127) {
+                v_prev = 127;
                 continue;
+            }
 
-            // XXX don't query this until we know we need it?
-            uint64_t rep0 = unionfind_get_representative(uf, y*w + x);
-            if (unionfind_get_set_size(uf, rep0) < 25) {
+            // the previous pixel with the same value belongs to the
+            // same run, thus to the same component.
+            if (v0 != v_prev) {
+                rep0 = unionfind_get_representative(uf, y*w + x);
+                v_prev = v0;
+            }
+            if (uf->data[rep0].size < 25) {
                 continue;
             }
 
@@ -1528,37 +1876,17 @@ zarray_t* do_gradient_clusters(image_u8_t* threshim, int ts, int y0, int y1, int
                                                                         \
                 if (v0 + v1 == 255) {                                   \
                     uint64_t rep1 = unionfind_get_representative(uf, (y + dy)*w + x + dx); \
-                    if (unionfind_get_set_size(uf, rep1) > 24) {        \
+                    if (uf->data[rep1].size > 24) {                     \
                         uint64_t clusterid;                                 \
                         if (rep0 < rep1)                                    \
                             clusterid = (rep1 << 32) + rep0;                \
                         else                                                \
                             clusterid = (rep0 << 32) + rep1;                \
                                                                             \
-                        /* XXX lousy hash function */                       \
-                        uint32_t clustermap_bucket = u64hash_2(clusterid) % nclustermap; \
-                        struct uint64_zarray_entry *entry = clustermap[clustermap_bucket]; \
-                        while (entry && entry->id != clusterid) {           \
-                            entry = entry->next;                            \
-                        }                                                   \
-                                                                            \
-                        if (!entry) {                                       \
-                            if (mem_pool_loc == mem_chunk_size) {           \
-                                mem_pool_loc = 0;                           \
-                                mem_pool_idx++;                             \
-                                mem_pools[mem_pool_idx] = (struct uint64_zarray_entry *)calloc(mem_chunk_size, sizeof(struct uint64_zarray_entry)); \
-                            }                                               \
-                            entry = mem_pools[mem_pool_idx] + mem_pool_loc; \
-                            mem_pool_loc++;                                 \
+                        zarray_t *cluster = cluster_table_get(&table, clusterid); \
                                                                             \
-                            entry->id = clusterid;                          \
-                            entry->cluster = zarray_create(sizeof(struct pt)); \
-                            entry->next = clustermap[clustermap_bucket];    \
-                            clustermap[clustermap_bucket] = entry;          \
-                        }                                                   \
- 			    \
                         struct pt p = { (uint16_t)(2*x + dx), (uint16_t)(2*y + dy), (int16_t)(dx*((int) v1-v0)), (int16_t)(dy*((int) v1-v0)), 0.f}; \
-                        zarray_add(entry->cluster, &p);                     \
+                        zarray_add(cluster, &p);                            \
                     }                                                   \
                 }                                                       \
             }
@@ -1574,38 +1902,29 @@ zarray_t* do_gradient_clusters(image_u8_t* threshim, int ts, int y0, int y1, int
     }
 #undef DO_CONN
 
-    for (int i = 0; i < nclustermap; i++) {
-        int start = zarray_size(clusters);
-        for (struct uint64_zarray_entry *entry = clustermap[i]; entry; entry = entry->next) {
-            struct cluster_hash* cluster_hash = (struct cluster_hash*)malloc(sizeof(struct cluster_hash));
-            cluster_hash->hash = u64hash_2(entry->id) % nclustermap;
-            cluster_hash->id = entry->id;
-            cluster_hash->data = entry->cluster;
-            zarray_add(clusters, &cluster_hash);
-        }
-        int end = zarray_size(clusters);
-
-        // Do a quick bubblesort on the secondary key.
-        int n = end - start;
-        for (int j = 0; j < n - 1; j++) {
-            for (int k = 0; k < n - j - 1; k++) {
-                struct cluster_hash* hash1;
-                struct cluster_hash* hash2;
-                zarray_get(clusters, start + k, &hash1);
-                zarray_get(clusters, start + k + 1, &hash2);
-                if (hash1->id > hash2->id) {
-                    struct cluster_hash tmp = *hash2;
-                    *hash2 = *hash1;
-                    *hash1 = tmp;
-                }
-            }
-        }
+    // the clusters are sorted by bucket of the original chained hash table,
+    // then by id, as expected by merge_clusters().
+    struct cluster_hash *hashes = (struct cluster_hash *)malloc(sizeof(struct cluster_hash)*(table.size + 1));
+    int n = 0;
+    for (uint32_t i = 0; i < table.capacity; i++) {
+        if (table.entries[i].id == 0)
+            continue;
+        hashes[n].hash = u64hash_2(table.entries[i].id) % nclustermap;
+        hashes[n].id = table.entries[i].id;
+        hashes[n].data = table.entries[i].cluster;
+        n++;
     }
-    for (int i = 0; i <= mem_pool_idx; i++) {
-        free(mem_pools[i]);
+    qsort(hashes, n, sizeof(struct cluster_hash), cluster_hash_compare);
+
+    zarray_ensure_capacity(clusters, zarray_size(clusters) + n);
+    for (int i = 0; i < n; i++) {
+        struct cluster_hash* cluster_hash = (struct cluster_hash*)malloc(sizeof(struct cluster_hash));
+        *cluster_hash = hashes[i];
+        zarray_add(clusters, &cluster_hash);
     }
-    free(mem_pools);
-    free(clustermap);
+
+    free(hashes);
+    free(table.entries);
 
     return clusters;
 }
@@ -1871,7 +2190,6 @@ zarray_t *apriltag_quad_thresh(apriltag_detector_t *td, image_u8_t *im)
     }
 
 
-    image_u8_destroy(threshim);
     timeprofile_stamp(td->tp, "make clusters");
 
     ////////////////////////////////////////////////////////
@@ -1921,8 +2239,6 @@ zarray_t *apriltag_quad_thresh(apriltag_detector_t *td, image_u8_t *im)
 
     timeprofile_stamp(td->tp, "fit quads to clusters");
 
-    unionfind_destroy(uf);
-
     for (int i = 0; i < zarray_size(clusters); i++) {
         zarray_t *cluster;
         zarray_get(clusters, i, &cluster);
@@ -36,6 +36,9 @@ struct unionfind
 {
     uint32_t maxid;
     struct ufrec *data;
+
+    // number of allocated records, at least maxid+1
+    uint32_t capacity;
 };
 
 struct ufrec
@@ -54,13 +57,52 @@ static inline unionfind_t *unionfind_create(uint32_t maxid)
     unionfind_t *uf = (unionfind_t*) calloc(1, sizeof(unionfind_t));
     uf->maxid = maxid;
     uf->data = (struct ufrec*) malloc((maxid+1) * sizeof(struct ufrec));
-    for (int i = 0; i <= maxid; i++) {
+    uf->capacity = maxid+1;
+    for (uint32_t i = 0; i <= maxid; i++) {
         uf->data[i].size = 1;
         uf->data[i].parent = i;
     }
     return uf;
 }
 
+// Reset a union-find structure for maxid+1 nodes, reusing its records
+// when they are enough. uf can be NULL.
+static inline unionfind_t *unionfind_reset(unionfind_t *uf, uint32_t maxid)
+{
+    if (uf == NULL)
+        return unionfind_create(maxid);
+
+    if (uf->capacity < maxid+1) {
+        free(uf->data);
+        uf->data = (struct ufrec*) malloc((maxid+1) * sizeof(struct ufrec));
+        uf->capacity = maxid+1;
+    }
+    uf->maxid = maxid;
+    for (uint32_t i = 0; i <= maxid; i++) {
+        uf->data[i].size = 1;
+        uf->data[i].parent = i;
+    }
+    return uf;
+}
+
+// Make sure a union-find structure has records for maxid+1 nodes, reusing
+// its records when they are enough. Unlike unionfind_reset(), the records
+// are not initialized: the caller must write all of them. uf can be NULL.
+static inline unionfind_t *unionfind_reserve(unionfind_t *uf, uint32_t maxid)
+{
+    if (uf == NULL) {
+        uf = (unionfind_t*) calloc(1, sizeof(unionfind_t));
+    }
+
+    if (uf->capacity < maxid+1) {
+        free(uf->data);
+        uf->data = (struct ufrec*) malloc((maxid+1) * sizeof(struct ufrec));
+        uf->capacity = maxid+1;
+    }
+    uf->maxid = maxid;
+    return uf;
+}
+
 static inline void unionfind_destroy(unionfind_t *uf)
 {
     free(uf->data);
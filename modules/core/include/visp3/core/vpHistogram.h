@@ -52,6 +52,7 @@
 #include <visp3/core/vpHistogramPeak.h>
 #include <visp3/core/vpHistogramValey.h>
 #include <visp3/core/vpImage.h>
+#include <visp3/core/vpRect.h>
 
 #ifdef VISP_BUILD_DEPRECATED_FUNCTIONS
 #include <visp3/core/vpList.h>
@@ -115,6 +116,7 @@ public:
   vpHistogram();
   vpHistogram(const vpHistogram &h);
   explicit vpHistogram(const vpImage<unsigned char> &I);
+  vpHistogram(const vpImage<unsigned char> &I, const vpImage<bool> *p_mask);
   virtual ~vpHistogram();
 
   vpHistogram &operator=(const vpHistogram &h);
@@ -239,6 +241,8 @@ public:
   };
 
   void calculate(const vpImage<unsigned char> &I, unsigned int nbins = 256, unsigned int nbThreads = 1);
+  void calculate(const vpImage<unsigned char> &I, const vpRect &roi, unsigned int nbins = 256,
+                 unsigned int nbThreads = 1);
 
   void display(const vpImage<unsigned char> &I, const vpColor &color = vpColor::white, unsigned int thickness = 2,
                unsigned int maxValue_ = 0);
@@ -289,11 +293,44 @@ public:
   */
   inline unsigned *getValues() { return histogram; };
 
+  /*!
+    Return the mask used by calculate(), or NULL if all the pixels are
+    counted.
+
+    \sa setMask()
+  */
+  inline const vpImage<bool> *getMask() const { return m_mask; }
+
+  /*!
+    Set the mask of the pixels counted by calculate(). The mask must have the
+    same size as the images and is not copied, it must stay valid until it is
+    replaced.
+
+    \param p_mask : Pointer to the mask, where the pixels to count are true,
+    or NULL to count all the pixels.
+
+    \code
+    vpImage<unsigned char> I; // A gray level image
+    vpImage<bool> mask(I.getHeight(), I.getWidth(), false);
+    // Set the pixels to count to true
+    ...
+    vpHistogram h;
+    h.setMask(&mask);
+    h.calculate(I);
+    \endcode
+
+    \sa getMask()
+  */
+  inline void setMask(const vpImage<bool> *p_mask) { m_mask = p_mask; }
+
 private:
+  void calculate(const vpImage<unsigned char> &I, unsigned int x0, unsigned int x1, unsigned int y0,
+                 unsigned int y1, unsigned int nbins, unsigned int nbThreads);
   void init(unsigned size = 256);
 
   unsigned int *histogram;
   unsigned size; // Histogram size (max allowed 256)
+  const vpImage<bool> *m_mask; // Pixels to count, or NULL
 };
 
 #endif
@@ -60,6 +60,27 @@
 
   \brief  Various mathematical morphology tools, erosion, dilatation...
 
+  Besides the 3x3 erosion and dilatation, the grayscale erosion and
+  dilatation of an unsigned char image can be computed with a flat
+  rectangular structuring element of any size, a horizontal or vertical
+  line when one of its dimensions is 1. The rectangle is decomposed in a
+  horizontal and a vertical line, each one computed with the van Herk /
+  Gil-Werman algorithm, with a constant number of comparisons per pixel
+  whatever the size of the structuring element. Opening, closing, top-hat,
+  black-hat and morphological gradient are built on top of them.
+
+  \code
+#include <visp3/core/vpImageMorphology.h>
+
+int main()
+{
+  vpImage<unsigned char> I(480, 640), I_opening;
+  // ...
+  // Remove the bright details smaller than 15x15 pixels
+  vpImageMorphology::opening(I, I_opening, 15, 15);
+}
+  \endcode
+
   \author Fabien Spindler  (Fabien.Spindler@irisa.fr) Irisa / Inria Rennes
 
 
@@ -87,6 +108,22 @@ public:
 
   static void erosion(vpImage<unsigned char> &I, const vpConnexityType &connexity = CONNEXITY_4);
   static void dilatation(vpImage<unsigned char> &I, const vpConnexityType &connexity = CONNEXITY_4);
+
+  static void erosion(const vpImage<unsigned char> &I, vpImage<unsigned char> &Ires, unsigned int width,
+                      unsigned int height);
+  static void dilatation(const vpImage<unsigned char> &I, vpImage<unsigned char> &Ires, unsigned int width,
+                         unsigned int height);
+
+  static void opening(const vpImage<unsigned char> &I, vpImage<unsigned char> &Ires, unsigned int width,
+                      unsigned int height);
+  static void closing(const vpImage<unsigned char> &I, vpImage<unsigned char> &Ires, unsigned int width,
+                      unsigned int height);
+  static void topHat(const vpImage<unsigned char> &I, vpImage<unsigned char> &Ires, unsigned int width,
+                     unsigned int height);
+  static void blackHat(const vpImage<unsigned char> &I, vpImage<unsigned char> &Ires, unsigned int width,
+                       unsigned int height);
+  static void gradient(const vpImage<unsigned char> &I, vpImage<unsigned char> &Ires, unsigned int width,
+                       unsigned int height);
 };
 
 /*!
@@ -84,11 +84,40 @@
   vpServer to simulate your network. Some exemples are provided in these
   classes.
 
+  By default, the requests are delimited by string markers and the received
+  bytes are searched for these markers, which is slow for large requests and
+  fails when a parameter contains a marker. With setFramingType() set to
+  vpNetwork::BINARY_FRAMING, each request is sent as a header giving the
+  sizes of its id and of its parameters, followed by the raw bytes of the id
+  and of the parameters. The header and the parameters are sent with a single
+  scatter/gather system call, without being first copied into a message, and
+  the received requests are cut according to their sizes. Once the header of
+  a request is received, the end of its parameters is read straight into the
+  parameters of the corresponding decoding request. Both ends of a
+  connection must use the same framing.
+  \code
+  vpServer serv(port);
+  serv.setFramingType(vpNetwork::BINARY_FRAMING);
+
+  vpClient client;
+  client.setFramingType(vpNetwork::BINARY_FRAMING);
+  \endcode
+
   \sa vpServer
   \sa vpNetwork
 */
 class VISP_EXPORT vpNetwork
 {
+public:
+  /*!
+    Framing of the requests sent and received by sendRequest() and
+    receiveRequest().
+  */
+  typedef enum {
+    TEXT_FRAMING,  /*!< Requests are delimited by string markers (default). */
+    BINARY_FRAMING /*!< Requests are prefixed by the sizes of their id and parameters. */
+  } vpFramingType;
+
 protected:
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
   struct vpReceptor {
@@ -102,7 +131,26 @@ protected:
     struct sockaddr_in receptorAddress;
     std::string receptorIP;
 
-    vpReceptor() : socketFileDescriptorReceptor(0), receptorAddressSize(), receptorAddress(), receptorIP() {}
+    // Binary frames received from the receptor and not handled yet
+    std::vector<char> receivedBuffer;
+    size_t receivedBegin;
+    size_t receivedEnd;
+    // Binary request whose parameters are read straight from the socket, the
+    // position of the next byte in its parameters, and whether all of them
+    // have been read but not handled yet
+    bool receivingBinaryRequest;
+    bool receivedBinaryRequest;
+    std::string receivingId;
+    std::vector<std::string> receivingParameters;
+    unsigned int receivingParameter;
+    size_t receivingOffset;
+
+    vpReceptor()
+      : socketFileDescriptorReceptor(0), receptorAddressSize(), receptorAddress(), receptorIP(), receivedBuffer(),
+        receivedBegin(0), receivedEnd(0), receivingBinaryRequest(false), receivedBinaryRequest(false),
+        receivingId(), receivingParameters(), receivingParameter(0), receivingOffset(0)
+    {
+    }
   };
 
   struct vpEmitter {
@@ -146,15 +194,31 @@ protected:
 
   std::string currentMessageReceived;
 
+  vpFramingType framingType;
+  // Bytes received by vpServer::processEvents(), or text received from any receptor
+  std::vector<char> receivedBuffer;
+  size_t receivedBegin;
+  size_t receivedEnd;
+  // True once a binary frame without magic word or larger than max_size_message is received
+  bool receivedInvalidFrame;
+
   struct timeval tv;
   long tv_sec;
   long tv_usec;
 
   bool verboseMode;
 
+  int _handleFirstRequest();
+
 private:
   std::vector<int> _handleRequests();
-  int _handleFirstRequest();
+  int _handleFirstBinaryRequest();
+  int _handleFirstBinaryFrame(std::vector<char> &buffer, size_t &begin, size_t &end);
+
+  int _findRequest(const std::string &id);
+  int _receiveMessage(const unsigned int &receptorEmitting);
+  int _receiveBinaryRequestEnd(const unsigned int &receptorEmitting);
+  int _sendBinaryRequestTo(vpRequest &req, const unsigned int &dest);
 
   void _receiveRequest();
   void _receiveRequestFrom(const unsigned int &receptorEmitting);
@@ -167,6 +231,15 @@ public:
 
   void addDecodingRequest(vpRequest *);
 
+  /*!
+    Get the framing of the requests.
+
+    \sa vpNetwork::setFramingType()
+
+    \return Framing of the requests sent and received.
+  */
+  inline vpFramingType getFramingType() const { return framingType; }
+
   int getReceptorIndex(const char *name);
 
   /*!
@@ -219,8 +292,13 @@ public:
   int sendAndEncodeRequest(vpRequest &req);
   int sendAndEncodeRequestTo(vpRequest &req, const unsigned int &dest);
 
+  void setFramingType(const vpFramingType &type);
+
   /*!
     Change the maximum size that the emitter can receive (in request mode).
+    With binary framing, this is also the maximum size of a received request:
+    a receptor announcing a larger request is disconnected before anything is
+    allocated for it.
 
     \sa vpNetwork::getMaxSizeReceivedMessage()
 
@@ -0,0 +1,223 @@
+/****************************************************************************
+ *
+ * ViSP, open source Visual Servoing Platform software.
+ * Copyright (C) 2005 - 2019 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Organized point cloud.
+ *
+ *****************************************************************************/
+
+#ifndef _vpPointCloud_h_
+#define _vpPointCloud_h_
+
+#include <stdint.h>
+#include <vector>
+
+#include <visp3/core/vpCameraParameters.h>
+#include <visp3/core/vpColVector.h>
+#include <visp3/core/vpConfig.h>
+#include <visp3/core/vpImage.h>
+
+/*!
+  \class vpPointCloud
+  \ingroup group_core_geometry
+
+  \brief Organized (image-like) point cloud stored in a single contiguous buffer.
+
+  Each pixel \f$(i,j)\f$ of a \e height x \e width grid holds a 3D point
+  \f$(X,Y,Z)\f$ expressed in meter in the sensor frame. A point is considered as
+  valid when \f$Z > 0\f$; invalid or missing depth values (0 or NaN) are thus
+  rejected by getPoint().
+
+  Two storages are available:
+  - packed float \f$X,Y,Z\f$ triplets with a row stride expressed in number of
+    floats (see resize(), setPoint() and the constructor wrapping an external
+    buffer),
+  - a view over a depth map (see buildFrom(const vpImage<uint16_t> &, const vpCameraParameters &, float)
+    and buildFrom(const vpImage<float> &, const vpCameraParameters &)). In that
+    case the 3D points are not materialized: \f$X\f$ and \f$Y\f$ are computed on
+    the fly from \f$Z\f$ using per-column and per-row lookup tables built from
+    the camera intrinsics. Since these tables are separable, only the
+    \f$p_x, p_y, u_0, v_0\f$ parameters are considered and lens distortion is
+    ignored.
+
+  When the point cloud is a view over a depth map or wraps an external buffer,
+  the corresponding memory is not copied and must outlive the vpPointCloud.
+
+  The following example shows how to track with the depth dense tracker a raw
+  depth map acquired by a RGB-D sensor:
+  \code
+  vpImage<uint16_t> I_depth_raw;
+  vpCameraParameters cam_depth;
+  float depth_scale = 0.001f;
+  vpPointCloud point_cloud;
+  vpMbDepthDenseTracker tracker;
+  // ...
+  while (true) {
+    // Acquire I_depth_raw
+    point_cloud.buildFrom(I_depth_raw, cam_depth, depth_scale);
+    tracker.track(point_cloud);
+  }
+  \endcode
+*/
+class VISP_EXPORT vpPointCloud
+{
+public:
+  //! Point cloud storage
+  typedef enum {
+    XYZ_STORAGE,          ///< Packed float X, Y, Z triplets
+    DEPTH_UINT16_STORAGE, ///< View over a raw uint16 depth map and a depth scale
+    DEPTH_FLOAT_STORAGE   ///< View over a metric float depth map
+  } vpPointCloudStorageType;
+
+  vpPointCloud();
+  vpPointCloud(unsigned int height, unsigned int width);
+  vpPointCloud(float *const data, unsigned int height, unsigned int width, unsigned int stride = 0);
+  vpPointCloud(const vpPointCloud &pointcloud);
+  virtual ~vpPointCloud() {}
+
+  void buildFrom(const std::vector<vpColVector> &point_cloud, unsigned int width, unsigned int height);
+  void buildFrom(const vpImage<uint16_t> &depth, const vpCameraParameters &cam, float depthScale);
+  void buildFrom(const vpImage<float> &depth, const vpCameraParameters &cam);
+
+  void clear();
+
+  /*!
+    Get a pointer to the packed \f$X,Y,Z\f$ data, or NULL if the point cloud is
+    a view over a depth map.
+  */
+  inline const float *getData() const { return m_xyz; }
+  /*!
+    Get a pointer to the packed \f$X,Y,Z\f$ data, or NULL if the point cloud is
+    a view over a depth map.
+  */
+  inline float *getData() { return m_xyz; }
+
+  //! Get the number of rows.
+  inline unsigned int getHeight() const { return m_height; }
+
+  /*!
+    Get the 3D point at image location \f$(i,j)\f$.
+
+    \param i : Row index.
+    \param j : Column index.
+    \param X, Y, Z : 3D point coordinates in meter.
+    \return true if the point is valid (\f$Z > 0\f$), false otherwise.
+  */
+  inline bool getPoint(unsigned int i, unsigned int j, float &X, float &Y, float &Z) const
+  {
+    if (m_storage == XYZ_STORAGE) {
+      const float *ptr = m_xyz + i * m_stride + 3 * j;
+      X = ptr[0];
+      Y = ptr[1];
+      Z = ptr[2];
+    } else {
+      Z = m_storage == DEPTH_UINT16_STORAGE ? m_depthScale * m_depthRaw[i * m_stride + j]
+                                            : m_depthFloat[i * m_stride + j];
+      X = m_xFactor[j] * Z;
+      Y = m_yFactor[i] * Z;
+    }
+
+    return Z > 0;
+  }
+
+  //! Get the number of points, that is height x width.
+  inline unsigned int getSize() const { return m_width * m_height; }
+
+  //! Get the storage type.
+  inline vpPointCloudStorageType getStorageType() const { return m_storage; }
+
+  /*!
+    Get the row stride: number of floats between two consecutive rows for
+    the packed storage, number of pixels for a depth map view.
+  */
+  inline unsigned int getStride() const { return m_stride; }
+
+  //! Get the number of columns.
+  inline unsigned int getWidth() const { return m_width; }
+
+  /*!
+    Get the depth at image location \f$(i,j)\f$ without computing \f$X\f$ and \f$Y\f$.
+  */
+  inline float getZ(unsigned int i, unsigned int j) const
+  {
+    if (m_storage == XYZ_STORAGE) {
+      return m_xyz[i * m_stride + 3 * j + 2];
+    }
+
+    return m_storage == DEPTH_UINT16_STORAGE ? m_depthScale * m_depthRaw[i * m_stride + j]
+                                             : m_depthFloat[i * m_stride + j];
+  }
+
+  vpPointCloud &operator=(const vpPointCloud &pointcloud);
+
+  void resize(unsigned int height, unsigned int width);
+
+  /*!
+    Set the 3D point at image location \f$(i,j)\f$. Only valid with the packed
+    \f$X,Y,Z\f$ storage.
+  */
+  inline void setPoint(unsigned int i, unsigned int j, float X, float Y, float Z)
+  {
+    float *ptr = m_xyz + i * m_stride + 3 * j;
+    ptr[0] = X;
+    ptr[1] = Y;
+    ptr[2] = Z;
+  }
+
+  void toVector(std::vector<vpColVector> &point_cloud) const;
+
+protected:
+  //! Storage type
+  vpPointCloudStorageType m_storage;
+  //! Number of columns
+  unsigned int m_width;
+  //! Number of rows
+  unsigned int m_height;
+  //! Row stride
+  unsigned int m_stride;
+  //! Owned packed X, Y, Z buffer
+  std::vector<float> m_data;
+  //! Pointer to the packed X, Y, Z data (owned or external)
+  float *m_xyz;
+  //! Raw depth map data
+  const uint16_t *m_depthRaw;
+  //! Metric depth map data
+  const float *m_depthFloat;
+  //! Scale to convert raw depth values into meter
+  float m_depthScale;
+  //! (u - u0) / px for each column
+  std::vector<float> m_xFactor;
+  //! (v - v0) / py for each row
+  std::vector<float> m_yFactor;
+
+  void computeFactors(const vpCameraParameters &cam);
+};
+
+#endif
@@ -159,12 +159,50 @@ int main(int argc,const char** argv)
 }
   \endcode
 
+  Under Linux, processEvents() is an event loop that serves many clients with
+  a single epoll() call. It accepts the new clients, reads all the available
+  bytes of each client into its own buffer without blocking, decodes the
+  complete requests and passes them to the handler set with
+  setRequestHandler(). Since each client has its own buffer, the requests of
+  several clients can be received in any order.
+  \code
+#include <visp3/core/vpServer.h>
+
+void handleImage(vpRequest &req, unsigned int client, void *data)
+{
+  // req has been decoded, client is the index of the client that sent it
+}
+
+int main()
+{
+  vpServer serv(35000);
+  vpImage<unsigned char> I;
+  vpRequestImage reqImage(&I);
+  serv.addDecodingRequest(&reqImage);
+  serv.setRequestHandler(handleImage);
+
+  while (true) {
+    serv.processEvents(100); // Wait up to 100 ms for events
+  }
+}
+  \endcode
+
   \sa vpClient
   \sa vpRequest
   \sa vpNetwork
 */
 class VISP_EXPORT vpServer : public vpNetwork
 {
+public:
+  /*!
+    Function called by processEvents() for each decoded request.
+
+    \param req : Decoding request that has been received and decoded.
+    \param client : Index of the client that sent the request.
+    \param data : Pointer given to setRequestHandler().
+  */
+  typedef void (*vpRequestHandler)(vpRequest &req, unsigned int client, void *data);
+
 private:
   //######## PARAMETERS ########
   //#                          #
@@ -174,6 +212,23 @@ private:
   bool started;
   unsigned int max_clients;
 
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+  class vpImpl;
+  vpImpl *m_impl;
+#endif
+  vpRequestHandler m_handler;
+  void *m_handlerData;
+
+  vpServer(const vpServer &); // noncopyable
+  vpServer &operator=(const vpServer &);
+
+#if defined(__linux__)
+  void acceptClients();
+  void closeClient(int fd);
+  int receiveClient(int fd);
+  void registerClients();
+#endif
+
 public:
   vpServer();
   explicit vpServer(const int &port);
@@ -210,6 +265,22 @@ public:
 
   void print();
 
+#if defined(__linux__)
+  int processEvents(int timeout_ms);
+#endif
+
+  /*!
+    Set the function called by processEvents() for each decoded request.
+
+    \param handler : Function to call, or NULL to only decode the requests.
+    \param data : Pointer passed to the function.
+  */
+  void setRequestHandler(vpRequestHandler handler, void *data = NULL)
+  {
+    m_handler = handler;
+    m_handlerData = data;
+  }
+
   bool start();
 
   /*!
@@ -0,0 +1,334 @@
+/****************************************************************************
+ *
+ * ViSP, open source Visual Servoing Platform software.
+ * Copyright (C) 2005 - 2019 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Ring buffer of images in shared memory.
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpSharedImageRing.h
+  \brief Ring buffer of images in POSIX shared memory.
+*/
+
+#ifndef vpSharedImageRing_h
+#define vpSharedImageRing_h
+
+#include <visp3/core/vpConfig.h>
+
+#if !defined(_WIN32) && (defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))) &&         \
+    (VISP_CXX_STANDARD >= VISP_CXX_STANDARD_11)
+
+#include <string>
+
+#include <visp3/core/vpException.h>
+#include <visp3/core/vpImage.h>
+
+/*!
+  \class vpSharedImageRing
+
+  \ingroup group_core_com_shm
+
+  \brief Lock-free ring buffer of images in POSIX shared memory, written by a
+  single producer process and read by any number of consumer processes.
+
+  The producer creates the ring with create(), giving its name, its number of
+  slots and the maximum size of the images. Each slot holds an image, its
+  timestamp and up to a given number of bytes of metadata. The consumers
+  attach to the ring with open().
+
+  Frames are published with write(), which copies an image in the next slot,
+  or with beginWrite() and endWrite(), which let a grabber acquire its image
+  directly in the slot. The producer never waits for the consumers: when the
+  ring is full, the oldest slot is overwritten.
+
+  Each slot is protected by a sequence number, incremented before and after
+  it is written. acquire() initializes an image whose bitmap aliases the
+  slot, without any copy, and isValid() tells whether the slot has been
+  overwritten since. read() copies the image and retries on the next frame
+  when the slot is overwritten during the copy. A consumer that falls behind
+  by more than the number of slots skips the overwritten frames, which are
+  counted by getNbDroppedFrames(). The consumers never write in the ring,
+  so that a slow or crashed consumer can't block the producer or the other
+  consumers.
+
+  The pixels of each slot start on a 64 bytes boundary.
+
+  \warning The bitmap of an image initialized by acquire() or beginWrite()
+  does not belong to the image. The image must not be used after the ring is
+  closed or destroyed, and its size must not be changed.
+
+  The producer side:
+  \code
+#include <visp3/core/vpSharedImageRing.h>
+#include <visp3/core/vpTime.h>
+
+int main()
+{
+  vpImage<unsigned char> I(480, 640);
+  vpSharedImageRing ring;
+  ring.create<unsigned char>("/camera", 8, 480, 640);
+  for (unsigned int i = 0; i < 100; i++) {
+    // Acquire I
+    ring.write(I, vpTime::measureTimeMs());
+  }
+}
+  \endcode
+
+  The consumer side, in another process:
+  \code
+#include <visp3/core/vpSharedImageRing.h>
+
+int main()
+{
+  vpSharedImageRing ring;
+  ring.open("/camera");
+  vpImage<unsigned char> I;
+  while (ring.waitForFrame(1000.)) {
+    ring.acquire(I, true); // Most recent frame, without copy
+    // Process I
+    if (!ring.isValid()) {
+      // I has been overwritten by the producer while being processed
+    }
+  }
+}
+  \endcode
+*/
+class VISP_EXPORT vpSharedImageRing
+{
+public:
+  vpSharedImageRing();
+  virtual ~vpSharedImageRing();
+
+  template <class Type> bool acquire(vpImage<Type> &I, bool latest = false);
+  template <class Type> void beginWrite(vpImage<Type> &I, unsigned int height, unsigned int width);
+
+  void close();
+  template <class Type>
+  void create(const std::string &name, unsigned int nbSlots, unsigned int maxHeight, unsigned int maxWidth,
+              unsigned int maxMetadataSize = 0, bool reclaim = false, unsigned int mode = 0600);
+
+  void endWrite(double timestamp, const std::string &metadata = "");
+
+  /*!
+    Return the index of the last acquired frame. The frames are numbered from
+    0 in the order they are written.
+  */
+  inline uint64_t getFrameIndex() const { return m_frameIndex; }
+  unsigned int getMaxHeight() const;
+  unsigned int getMaxMetadataSize() const;
+  unsigned int getMaxWidth() const;
+  /*!
+    Return the metadata of the last acquired frame.
+  */
+  inline const std::string &getMetadata() const { return m_metadata; }
+  /*!
+    Return the number of frames that have been overwritten before being
+    acquired, or skipped when acquiring the most recent frame.
+  */
+  inline uint64_t getNbDroppedFrames() const { return m_nbDroppedFrames; }
+  unsigned int getNbSlots() const;
+  uint64_t getNbWrittenFrames() const;
+  /*!
+    Return the timestamp of the last acquired frame.
+  */
+  inline double getTimestamp() const { return m_timestamp; }
+
+  /*!
+    Return true if the ring is created or opened.
+  */
+  inline bool isOpened() const { return m_data != NULL; }
+  bool isValid() const;
+
+  void open(const std::string &name);
+
+  template <class Type> bool read(vpImage<Type> &I, bool latest = false);
+
+  bool waitForFrame(double timeout_ms);
+
+  template <class Type> void write(const vpImage<Type> &I, double timestamp, const std::string &metadata = "");
+
+private:
+  vpSharedImageRing(const vpSharedImageRing &); // noncopyable
+  vpSharedImageRing &operator=(const vpSharedImageRing &);
+
+  unsigned char *acquireSlot(size_t pixelSize, bool latest, unsigned int &height, unsigned int &width);
+  unsigned char *beginWriteSlot(size_t pixelSize, unsigned int height, unsigned int width);
+  /*!
+    Return true if the pointer is in the shared memory of the ring.
+  */
+  inline bool contains(const void *ptr) const
+  {
+    const unsigned char *p = static_cast<const unsigned char *>(ptr);
+    return m_data != NULL && p >= m_data && p < m_data + m_size;
+  }
+  void createRing(const std::string &name, unsigned int nbSlots, unsigned int maxHeight, unsigned int maxWidth,
+                  size_t pixelSize, unsigned int maxMetadataSize, bool reclaim, unsigned int mode);
+
+  std::string m_name;
+  int m_fd;
+  unsigned char *m_data;
+  size_t m_size;
+  bool m_producer;
+  bool m_writing;
+  // Next frame to acquire
+  uint64_t m_nextIndex;
+  uint64_t m_frameIndex;
+  uint64_t m_nbDroppedFrames;
+  // Slot of the last acquired or written frame, and its sequence number
+  unsigned char *m_slot;
+  uint64_t m_sequence;
+  double m_timestamp;
+  std::string m_metadata;
+};
+
+/*!
+  Acquire the next frame, without copy. The bitmap of the image aliases the
+  slot of the frame, that can be overwritten by the producer while the image
+  is used: isValid() tells whether the image is still valid.
+
+  \param I : Image whose bitmap is set to the slot of the frame.
+  \param latest : If true, acquire the most recent frame and skip the frames
+  written since the previous call, otherwise acquire the oldest frame that has
+  not been acquired.
+
+  \return true if a frame has been acquired, false if there is no new frame.
+  The image is unchanged in that case.
+
+  \sa read(), waitForFrame()
+*/
+template <class Type> bool vpSharedImageRing::acquire(vpImage<Type> &I, bool latest)
+{
+  unsigned int height, width;
+  unsigned char *pixels = acquireSlot(sizeof(Type), latest, height, width);
+  if (pixels == NULL) {
+    return false;
+  }
+  I.init(reinterpret_cast<Type *>(pixels), height, width, false);
+  return true;
+}
+
+/*!
+  Start writing a frame in the next slot, without copy. The bitmap of the
+  image is set to the slot, so that a grabber can acquire its image directly
+  in the shared memory. The frame is published to the consumers by
+  endWrite().
+
+  \param I : Image whose bitmap is set to the slot of the frame.
+  \param height, width : Size of the image, that must not exceed the
+  maximum number of pixels given to create().
+*/
+template <class Type> void vpSharedImageRing::beginWrite(vpImage<Type> &I, unsigned int height, unsigned int width)
+{
+  unsigned char *pixels = beginWriteSlot(sizeof(Type), height, width);
+  I.init(reinterpret_cast<Type *>(pixels), height, width, false);
+}
+
+/*!
+  Create the ring buffer in shared memory, as the producer. The name is
+  removed from the system when the producer closes the ring.
+
+  \param name : Name of the shared memory object, for example "/camera".
+  \param nbSlots : Number of slots of the ring, at least 2.
+  \param maxHeight, maxWidth : Maximum size of the images.
+  \param maxMetadataSize : Maximum size in bytes of the metadata of a frame.
+  \param reclaim : If true, a shared memory object with the same name, for
+  example left by a producer that crashed, is replaced; the consumers still
+  attached to it must open the ring again. Otherwise an exception is thrown,
+  so that the ring of a running producer is never taken over.
+  \param mode : Permissions of the shared memory object. The default
+  0600 restricts the ring to the user of the producer; use for example 0640
+  or 0644 to let the consumers of other users read the ring. Only the
+  producer should be able to write in the ring, since the consumers trust
+  its content.
+
+  \exception vpException::ioError : If the shared memory can't be created, or
+  if it already exists and \e reclaim is false.
+*/
+template <class Type>
+void vpSharedImageRing::create(const std::string &name, unsigned int nbSlots, unsigned int maxHeight,
+                               unsigned int maxWidth, unsigned int maxMetadataSize, bool reclaim, unsigned int mode)
+{
+  createRing(name, nbSlots, maxHeight, maxWidth, sizeof(Type), maxMetadataSize, reclaim, mode);
+}
+
+/*!
+  Copy the next frame. If the slot of the frame is overwritten by the
+  producer during the copy, the next frame is copied instead. An image
+  previously initialized by acquire() gets its own bitmap.
+
+  \param I : Copy of the image of the frame.
+  \param latest : If true, copy the most recent frame and skip the frames
+  written since the previous call, otherwise copy the oldest frame that has
+  not been acquired.
+
+  \return true if a frame has been copied, false if there is no new frame.
+
+  \sa acquire(), waitForFrame()
+*/
+template <class Type> bool vpSharedImageRing::read(vpImage<Type> &I, bool latest)
+{
+  for (;;) {
+    unsigned int height, width;
+    unsigned char *pixels = acquireSlot(sizeof(Type), latest, height, width);
+    if (pixels == NULL) {
+      return false;
+    }
+    if (contains(I.bitmap)) {
+      I.destroy();
+    }
+    I.resize(height, width);
+    memcpy(static_cast<void *>(I.bitmap), pixels, static_cast<size_t>(height) * width * sizeof(Type));
+    if (isValid()) {
+      return true;
+    }
+    m_nbDroppedFrames++;
+  }
+}
+
+/*!
+  Copy an image in the next slot and publish it to the consumers.
+
+  \param I : Image to write, whose number of pixels must not exceed the
+  maximum given to create().
+  \param timestamp : Timestamp of the frame, for example in ms.
+  \param metadata : Metadata of the frame, of at most the size given to
+  create().
+*/
+template <class Type>
+void vpSharedImageRing::write(const vpImage<Type> &I, double timestamp, const std::string &metadata)
+{
+  unsigned char *pixels = beginWriteSlot(sizeof(Type), I.getHeight(), I.getWidth());
+  memcpy(pixels, static_cast<const void *>(I.bitmap), I.getSize() * sizeof(Type));
+  endWrite(timestamp, metadata);
+}
+
+#endif
+#endif
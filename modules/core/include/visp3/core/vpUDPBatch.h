@@ -0,0 +1,190 @@
+/****************************************************************************
+ *
+ * ViSP, open source Visual Servoing Platform software.
+ * Copyright (C) 2005 - 2019 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Batch of UDP datagrams
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpUDPBatch.h
+  \brief Batch of UDP datagrams sent or received with a single system call.
+*/
+
+#ifndef _vpUDPBatch_h_
+#define _vpUDPBatch_h_
+
+#include <visp3/core/vpConfig.h>
+
+// inet_ntop() not supported on win XP
+#ifdef VISP_HAVE_FUNC_INET_NTOP
+
+#if !defined(_WIN32) && (defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))) // UNIX
+#  include <netinet/in.h>
+#  include <sys/socket.h>
+#  include <sys/types.h>
+#else
+#  include <winsock2.h>
+#endif
+
+#include <string>
+#include <vector>
+
+#include <visp3/core/vpException.h>
+
+#define VP_MAX_UDP_PAYLOAD 508
+
+/*!
+  \class vpUDPBatch
+
+  \ingroup group_core_com_ethernet
+
+  \brief Preallocated batch of (IPv4) UDP datagrams, received or sent by
+  vpUDPServer and vpUDPClient with a single system call.
+
+  The buffers of all the datagrams are allocated once by the constructor, so
+  that streaming sensor data at a high rate does not allocate any memory.
+  Under Linux, the datagrams are received with recvmmsg() and sent with
+  sendmmsg(); on the other systems, they are received and sent in a loop.
+
+  Each received datagram comes with the address of its sender and its
+  timestamp in ms, with the same time base as vpTime::measureTimeMs(). Under
+  Linux, the timestamp is set by the kernel when the datagram reaches the
+  socket, otherwise it is the time at which the datagram is read.
+
+  Example of a server receiving the datagrams of its clients and echoing
+  them back:
+  \code
+#include <visp3/core/vpUDPServer.h>
+
+int main()
+{
+  vpUDPServer server(50037);
+  vpUDPBatch received(64), replies(64);
+
+  while (true) {
+    int nb = server.receive(received, 5000);
+    if (nb > 0) {
+      replies.clear();
+      for (unsigned int i = 0; i < received.size(); i++) {
+        replies.push(received.getData(i), received.getLength(i), received.getAddress(i));
+      }
+      server.send(replies);
+    }
+  }
+}
+  \endcode
+
+  \sa vpUDPServer, vpUDPClient
+*/
+class VISP_EXPORT vpUDPBatch
+{
+  friend class vpUDPClient;
+  friend class vpUDPServer;
+
+public:
+  explicit vpUDPBatch(unsigned int capacity = 64, unsigned int maxPayload = VP_MAX_UDP_PAYLOAD);
+  virtual ~vpUDPBatch();
+
+  /*!
+    Remove all the datagrams of the batch, without releasing the buffers.
+  */
+  inline void clear() { m_size = 0; }
+
+  /*!
+    Return the address of the sender of the i-th received datagram, or the
+    destination of the i-th datagram to send.
+  */
+  inline const struct sockaddr_in &getAddress(unsigned int i) const { return m_addresses[i]; }
+  /*!
+    Return the maximum number of datagrams of the batch.
+  */
+  inline unsigned int getCapacity() const { return m_capacity; }
+  /*!
+    Return the payload of the i-th datagram.
+  */
+  inline const unsigned char *getData(unsigned int i) const { return &m_data[i * m_maxPayload]; }
+  std::string getHostIp(unsigned int i) const;
+  int getHostPort(unsigned int i) const;
+  /*!
+    Return the payload size in bytes of the i-th datagram.
+  */
+  inline size_t getLength(unsigned int i) const { return m_lengths[i]; }
+  /*!
+    Return the maximum payload size of a datagram. Longer received datagrams
+    are truncated.
+  */
+  inline unsigned int getMaxPayload() const { return m_maxPayload; }
+  /*!
+    Return the timestamp in ms of the i-th received datagram.
+  */
+  inline double getTimestamp(unsigned int i) const { return m_timestamps[i]; }
+
+  void push(const void *data, size_t length);
+  void push(const void *data, size_t length, const struct sockaddr_in &address);
+  void push(const void *data, size_t length, const std::string &hostname, int port);
+
+  static struct sockaddr_in resolve(const std::string &hostname, int port);
+
+  /*!
+    Return the number of datagrams of the batch.
+  */
+  inline unsigned int size() const { return m_size; }
+
+private:
+  vpUDPBatch(const vpUDPBatch &); // noncopyable
+  vpUDPBatch &operator=(const vpUDPBatch &);
+
+#if !defined(_WIN32) && (defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))) // UNIX
+  int receiveFrom(int socketFileDescriptor, int timeoutMs);
+  int sendTo(int socketFileDescriptor, const struct sockaddr_in *address) const;
+  static void enableTimestamps(int socketFileDescriptor);
+#else
+  int receiveFrom(SOCKET socketFileDescriptor, int timeoutMs);
+  int sendTo(SOCKET socketFileDescriptor, const struct sockaddr_in *address) const;
+  static void enableTimestamps(SOCKET socketFileDescriptor);
+#endif
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+  class vpImpl;
+  vpImpl *m_impl;
+#endif
+
+  unsigned int m_capacity;
+  unsigned int m_maxPayload;
+  unsigned int m_size;
+  std::vector<unsigned char> m_data;
+  std::vector<size_t> m_lengths;
+  std::vector<struct sockaddr_in> m_addresses;
+  std::vector<double> m_timestamps;
+};
+
+#endif
+#endif
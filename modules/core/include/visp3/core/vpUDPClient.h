@@ -50,8 +50,7 @@
 #endif
 
 #include <visp3/core/vpException.h>
-
-#define VP_MAX_UDP_PAYLOAD 508
+#include <visp3/core/vpUDPBatch.h>
 
 /*!
   \class vpUDPClient
@@ -178,15 +177,17 @@ public:
 
   int receive(std::string &msg, int timeoutMs = 0);
   int receive(void *msg, size_t len, int timeoutMs = 0);
+  int receive(vpUDPBatch &datagrams, int timeoutMs = 0);
   int send(const std::string &msg);
   int send(const void *msg, size_t len);
+  int send(const vpUDPBatch &datagrams);
   //@}
 
 protected:
   bool m_is_init;
 
 private:
-  char m_buf[VP_MAX_UDP_PAYLOAD];
+  vpUDPBatch m_datagram;
   struct sockaddr_in m_serverAddress;
   int m_serverLength;
 #if !defined(_WIN32) && (defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))) // UNIX
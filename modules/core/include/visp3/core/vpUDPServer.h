@@ -50,8 +50,7 @@
 #endif
 
 #include <visp3/core/vpException.h>
-
-#define VP_MAX_UDP_PAYLOAD 508
+#include <visp3/core/vpUDPBatch.h>
 
 /*!
   \class vpUDPServer
@@ -203,10 +202,12 @@ public:
 
   int receive(std::string &msg, int timeoutMs = 0);
   int receive(std::string &msg, std::string &hostInfo, int timeoutMs = 0);
+  int receive(vpUDPBatch &datagrams, int timeoutMs = 0);
   int send(const std::string &msg, const std::string &hostname, int port);
+  int send(const vpUDPBatch &datagrams);
 
 private:
-  char m_buf[VP_MAX_UDP_PAYLOAD];
+  vpUDPBatch m_datagram;
   struct sockaddr_in m_clientAddress;
   int m_clientLength;
   struct sockaddr_in m_serverAddress;
@@ -36,10 +36,287 @@
  *
  *****************************************************************************/
 
+#include <algorithm>
+#include <vector>
+
+#if defined _OPENMP
+#include <omp.h>
+#endif
+
+#if defined __SSE2__ || defined _M_X64 || (defined _M_IX86_FP && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define VISP_HAVE_SSE2 1
+#endif
+
 #include <visp3/core/vpImageMorphology.h>
 
 #include <Simd/SimdLib.hpp>
 
+namespace
+{
+template <bool dilate> inline unsigned char morphologyOperator(unsigned char a, unsigned char b)
+{
+  return dilate ? (a > b ? a : b) : (a < b ? a : b);
+}
+
+// Pixel wise maximum (dilatation) or minimum (erosion) of two rows
+inline void morphologyRows(const unsigned char *a, const unsigned char *b, unsigned char *dst, unsigned int width,
+                           bool dilate)
+{
+  SimdOperationBinary8u(a, width, b, width, width, 1, 1, dst, width,
+                        dilate ? SimdOperationBinary8uMaximum : SimdOperationBinary8uMinimum);
+}
+
+// Number of rows processed together by the horizontal pass
+const unsigned int morphologyLanes = 16;
+
+// dst = max(a, b) (dilatation) or min(a, b) (erosion) on morphologyLanes pixels
+template <bool dilate>
+inline void morphologyLanesOperator(const unsigned char *a, const unsigned char *b, unsigned char *dst)
+{
+#if VISP_HAVE_SSE2
+  const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a));
+  const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b));
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(dst), dilate ? _mm_max_epu8(va, vb) : _mm_min_epu8(va, vb));
+#else
+  for (unsigned int k = 0; k < morphologyLanes; k++) {
+    dst[k] = morphologyOperator<dilate>(a[k], b[k]);
+  }
+#endif
+}
+
+/*
+  Transpose the block of nbRows x nbCols pixels at src into dst, both at most
+  morphologyLanes x morphologyLanes pixels.
+*/
+inline void morphologyTranspose(const unsigned char *src, size_t srcStride, unsigned char *dst, size_t dstStride,
+                                unsigned int nbRows, unsigned int nbCols)
+{
+#if VISP_HAVE_SSE2
+  if (nbRows == 16 && nbCols == 16) {
+    __m128i a[16], b[16];
+    for (int k = 0; k < 16; k++) {
+      a[k] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + k * srcStride));
+    }
+    for (int k = 0; k < 8; k++) {
+      b[2 * k] = _mm_unpacklo_epi8(a[2 * k], a[2 * k + 1]);
+      b[2 * k + 1] = _mm_unpackhi_epi8(a[2 * k], a[2 * k + 1]);
+    }
+    for (int k = 0; k < 4; k++) {
+      for (int m = 0; m < 2; m++) {
+        a[4 * k + m] = _mm_unpacklo_epi16(b[4 * k + m], b[4 * k + m + 2]);
+        a[4 * k + m + 2] = _mm_unpackhi_epi16(b[4 * k + m], b[4 * k + m + 2]);
+      }
+    }
+    for (int k = 0; k < 2; k++) {
+      for (int m = 0; m < 4; m++) {
+        b[8 * k + m] = _mm_unpacklo_epi32(a[8 * k + m], a[8 * k + m + 4]);
+        b[8 * k + m + 4] = _mm_unpackhi_epi32(a[8 * k + m], a[8 * k + m + 4]);
+      }
+    }
+    for (int m = 0; m < 8; m++) {
+      a[m] = _mm_unpacklo_epi64(b[m], b[m + 8]);
+      a[m + 8] = _mm_unpackhi_epi64(b[m], b[m + 8]);
+    }
+    // The unpacking stages leave the columns in bit reversed order
+    const int order[16] = {0, 8, 4, 12, 2, 10, 6, 14, 1, 9, 5, 13, 3, 11, 7, 15};
+    for (int k = 0; k < 16; k++) {
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + order[k] * dstStride), a[k]);
+    }
+    return;
+  }
+#endif
+  for (unsigned int r = 0; r < nbRows; r++) {
+    for (unsigned int c = 0; c < nbCols; c++) {
+      dst[c * dstStride + r] = src[r * srcStride + c];
+    }
+  }
+}
+
+/*
+  Van Herk / Gil-Werman dilatation or erosion of each row with a horizontal
+  line of size pixels, whose anchor is at anchor. The row, padded with the
+  neutral value, is split in blocks of size pixels where running maximums are
+  computed from the left and from the right: the result for a window is the
+  maximum of the right running maximum at its beginning and of the left one
+  at its end.
+
+  The running maximums being sequential along a row, the rows are processed
+  by strips of morphologyLanes rows, transposed in a buffer so that each step
+  of the scans operates on a vector of pixels from different rows.
+*/
+template <bool dilate>
+void morphologyHorizontal(const vpImage<unsigned char> &I, vpImage<unsigned char> &Ires, unsigned int size,
+                          unsigned int anchor)
+{
+  const unsigned int width = I.getWidth(), height = I.getHeight();
+  const unsigned int L = morphologyLanes;
+  const unsigned char border = dilate ? 0 : 255;
+  const unsigned int nbBlocks = (width + size - 1 + size - 1) / size;
+  const unsigned int paddedWidth = nbBlocks * size;
+  const int nbStrips = static_cast<int>((height + L - 1) / L);
+
+#if defined _OPENMP
+#pragma omp parallel
+#endif
+  {
+    std::vector<unsigned char> padded(paddedWidth * L, border), left(paddedWidth * L), right(paddedWidth * L);
+
+#if defined _OPENMP
+#pragma omp for
+#endif
+    for (int strip = 0; strip < nbStrips; strip++) {
+      const unsigned int i0 = static_cast<unsigned int>(strip) * L;
+      const unsigned int nbRows = std::min(L, height - i0);
+
+      for (unsigned int j = 0; j < width; j += L) {
+        morphologyTranspose(I[i0] + j, width, &padded[(anchor + j) * L], L, nbRows, std::min(L, width - j));
+      }
+
+      for (unsigned int start = 0; start < paddedWidth; start += size) {
+        const unsigned int end = start + size - 1;
+        memcpy(&left[start * L], &padded[start * L], L);
+        for (unsigned int j = start + 1; j <= end; j++) {
+          morphologyLanesOperator<dilate>(&left[(j - 1) * L], &padded[j * L], &left[j * L]);
+        }
+        memcpy(&right[end * L], &padded[end * L], L);
+        for (unsigned int j = end; j > start; j--) {
+          morphologyLanesOperator<dilate>(&right[j * L], &padded[(j - 1) * L], &right[(j - 1) * L]);
+        }
+      }
+
+      for (unsigned int j = 0; j < width; j++) {
+        morphologyLanesOperator<dilate>(&right[j * L], &left[(j + size - 1) * L], &right[j * L]);
+      }
+
+      for (unsigned int j = 0; j < width; j += L) {
+        morphologyTranspose(&right[j * L], L, Ires[i0] + j, width, std::min(L, width - j), nbRows);
+      }
+    }
+  }
+}
+
+/*
+  Van Herk / Gil-Werman dilatation or erosion of each column with a vertical
+  line of size pixels, whose anchor is at anchor. The running maximums are
+  computed on whole rows, block after block: the output rows starting in a
+  block only need the running maximums from the bottom of this block and the
+  ones from the top of the next block.
+*/
+void morphologyVertical(const vpImage<unsigned char> &I, vpImage<unsigned char> &Ires, unsigned int size,
+                        unsigned int anchor, bool dilate)
+{
+  const unsigned int width = I.getWidth(), height = I.getHeight();
+  const std::vector<unsigned char> border(width, dilate ? 0 : 255);
+  const unsigned int nbBlocks = (height + size - 1 + size - 1) / size;
+  const unsigned int paddedHeight = nbBlocks * size;
+
+  std::vector<const unsigned char *> padded(paddedHeight, &border[0]);
+  for (unsigned int i = 0; i < height; i++) {
+    padded[i + anchor] = I[i];
+  }
+
+  // The input rows are read by the next blocks, the result is thus written
+  // in a separate image when computed in place
+  vpImage<unsigned char> I_result;
+  vpImage<unsigned char> &result = (&Ires == &I) ? I_result : Ires;
+  result.resize(height, width);
+
+  const int nbOutputBlocks = static_cast<int>((height + size - 1) / size);
+#if defined _OPENMP
+#pragma omp parallel
+#endif
+  {
+    std::vector<unsigned char> bottom(static_cast<size_t>(size) * width), top(static_cast<size_t>(size) * width);
+
+#if defined _OPENMP
+#pragma omp for
+#endif
+    for (int block = 0; block < nbOutputBlocks; block++) {
+      const unsigned int start = static_cast<unsigned int>(block) * size;
+      const unsigned int nbRows = std::min(size, height - start);
+
+      // Running maximums from the bottom of the block
+      memcpy(&bottom[static_cast<size_t>(size - 1) * width], padded[start + size - 1], width);
+      for (unsigned int i = size - 1; i > 0; i--) {
+        morphologyRows(&bottom[static_cast<size_t>(i) * width], padded[start + i - 1],
+                       &bottom[static_cast<size_t>(i - 1) * width], width, dilate);
+      }
+      memcpy(result[start], &bottom[0], width);
+
+      // Running maximums from the top of the next block
+      if (nbRows > 1) {
+        memcpy(&top[0], padded[start + size], width);
+        for (unsigned int i = 1; i < nbRows - 1; i++) {
+          morphologyRows(&top[static_cast<size_t>(i - 1) * width], padded[start + size + i],
+                         &top[static_cast<size_t>(i) * width], width, dilate);
+        }
+      }
+
+      for (unsigned int i = 1; i < nbRows; i++) {
+        morphologyRows(&bottom[static_cast<size_t>(i) * width], &top[static_cast<size_t>(i - 1) * width],
+                       result[start + i], width, dilate);
+      }
+    }
+  }
+
+  if (&result != &Ires) {
+    Ires = result;
+  }
+}
+
+/*
+  Erosion or dilatation with a width x height rectangle anchored at
+  (width/2, height/2), or at the symmetric position when reflect is true, as
+  needed by the second operation of an opening or a closing with an even size.
+*/
+void morphologyRect(const vpImage<unsigned char> &I, vpImage<unsigned char> &Ires, unsigned int width,
+                    unsigned int height, bool dilate, bool reflect = false)
+{
+  if (width == 0 || height == 0) {
+    throw(vpException(vpException::badValue, "The size of the structuring element %ux%u is invalid", width, height));
+  }
+
+  if (I.getSize() == 0) {
+    Ires.resize(0, 0);
+    return;
+  }
+
+  if (width == 1 && height == 1) {
+    if (&Ires != &I) {
+      Ires = I;
+    }
+    return;
+  }
+
+  if (width == 1) {
+    morphologyVertical(I, Ires, height, reflect ? height - 1 - height / 2 : height / 2, dilate);
+    return;
+  }
+
+  vpImage<unsigned char> I_horizontal(I.getHeight(), I.getWidth());
+  if (dilate) {
+    morphologyHorizontal<true>(I, I_horizontal, width, reflect ? width - 1 - width / 2 : width / 2);
+  } else {
+    morphologyHorizontal<false>(I, I_horizontal, width, reflect ? width - 1 - width / 2 : width / 2);
+  }
+
+  if (height == 1) {
+    Ires = I_horizontal;
+  } else {
+    morphologyVertical(I_horizontal, Ires, height, reflect ? height - 1 - height / 2 : height / 2, dilate);
+  }
+}
+
+// Ires = I1 - I2, with I1 >= I2
+void subtract(const vpImage<unsigned char> &I1, const vpImage<unsigned char> &I2, vpImage<unsigned char> &Ires)
+{
+  Ires.resize(I1.getHeight(), I1.getWidth());
+  SimdOperationBinary8u(I1.bitmap, I1.getWidth(), I2.bitmap, I2.getWidth(), I1.getWidth(), I1.getHeight(), 1,
+                        Ires.bitmap, Ires.getWidth(), SimdOperationBinary8uSaturatedSubtraction);
+}
+} // namespace
+
 /*!
   Erode a grayscale image using the given structuring element.
 
@@ -139,3 +416,144 @@ void vpImageMorphology::dilatation(vpImage<unsigned char> &I, const vpConnexityT
   SimdImageDilatation(I.bitmap, J.bitmap, I.getWidth(), I.getHeight(),
                       connexity == CONNEXITY_4 ? SimdImageConnexity4 : SimdImageConnexity8);
 }
+
+/*!
+  Erode a grayscale image with a flat rectangular structuring element of
+  \e width x \e height pixels, whose anchor is at (\e width / 2, \e height / 2).
+  A size of 1 gives a vertical or horizontal line. The pixels outside the
+  image are considered as \f$ + \infty \f$.
+
+  The erosion is computed with the van Herk / Gil-Werman algorithm, first
+  along the rows then along the columns, with a number of comparisons per
+  pixel that does not depend on the size of the structuring element.
+
+  \param I : Image to process.
+  \param Ires : Eroded image. It can be the same image as \e I.
+  \param width : Width of the structuring element.
+  \param height : Height of the structuring element.
+
+  \exception vpException::badValue : If \e width or \e height is 0.
+
+  \sa dilatation(const vpImage<unsigned char> &, vpImage<unsigned char> &, unsigned int, unsigned int)
+*/
+void vpImageMorphology::erosion(const vpImage<unsigned char> &I, vpImage<unsigned char> &Ires, unsigned int width,
+                                unsigned int height)
+{
+  morphologyRect(I, Ires, width, height, false);
+}
+
+/*!
+  Dilate a grayscale image with a flat rectangular structuring element of
+  \e width x \e height pixels, whose anchor is at (\e width / 2, \e height / 2).
+  A size of 1 gives a vertical or horizontal line. The pixels outside the
+  image are considered as \f$ - \infty \f$.
+
+  The dilatation is computed with the van Herk / Gil-Werman algorithm, first
+  along the rows then along the columns, with a number of comparisons per
+  pixel that does not depend on the size of the structuring element.
+
+  \param I : Image to process.
+  \param Ires : Dilated image. It can be the same image as \e I.
+  \param width : Width of the structuring element.
+  \param height : Height of the structuring element.
+
+  \exception vpException::badValue : If \e width or \e height is 0.
+
+  \sa erosion(const vpImage<unsigned char> &, vpImage<unsigned char> &, unsigned int, unsigned int)
+*/
+void vpImageMorphology::dilatation(const vpImage<unsigned char> &I, vpImage<unsigned char> &Ires, unsigned int width,
+                                   unsigned int height)
+{
+  morphologyRect(I, Ires, width, height, true);
+}
+
+/*!
+  Opening of a grayscale image, the dilatation of its erosion, with a flat
+  rectangular structuring element of \e width x \e height pixels. With an
+  even size, the dilatation uses the reflected structuring element, so that
+  the opening is never greater than the image.
+
+  \param I : Image to process.
+  \param Ires : Result image. It can be the same image as \e I.
+  \param width : Width of the structuring element.
+  \param height : Height of the structuring element.
+*/
+void vpImageMorphology::opening(const vpImage<unsigned char> &I, vpImage<unsigned char> &Ires, unsigned int width,
+                                unsigned int height)
+{
+  morphologyRect(I, Ires, width, height, false);
+  morphologyRect(Ires, Ires, width, height, true, true);
+}
+
+/*!
+  Closing of a grayscale image, the erosion of its dilatation, with a flat
+  rectangular structuring element of \e width x \e height pixels. With an
+  even size, the erosion uses the reflected structuring element, so that the
+  closing is never lower than the image.
+
+  \param I : Image to process.
+  \param Ires : Result image. It can be the same image as \e I.
+  \param width : Width of the structuring element.
+  \param height : Height of the structuring element.
+*/
+void vpImageMorphology::closing(const vpImage<unsigned char> &I, vpImage<unsigned char> &Ires, unsigned int width,
+                                unsigned int height)
+{
+  morphologyRect(I, Ires, width, height, true);
+  morphologyRect(Ires, Ires, width, height, false, true);
+}
+
+/*!
+  White top-hat of a grayscale image, the difference between the image and
+  its opening, that keeps the bright details smaller than the flat
+  rectangular structuring element of \e width x \e height pixels.
+
+  \param I : Image to process.
+  \param Ires : Result image.
+  \param width : Width of the structuring element.
+  \param height : Height of the structuring element.
+*/
+void vpImageMorphology::topHat(const vpImage<unsigned char> &I, vpImage<unsigned char> &Ires, unsigned int width,
+                               unsigned int height)
+{
+  vpImage<unsigned char> I_opening;
+  opening(I, I_opening, width, height);
+  subtract(I, I_opening, Ires);
+}
+
+/*!
+  Black top-hat of a grayscale image, the difference between its closing and
+  the image, that keeps the dark details smaller than the flat rectangular
+  structuring element of \e width x \e height pixels.
+
+  \param I : Image to process.
+  \param Ires : Result image.
+  \param width : Width of the structuring element.
+  \param height : Height of the structuring element.
+*/
+void vpImageMorphology::blackHat(const vpImage<unsigned char> &I, vpImage<unsigned char> &Ires, unsigned int width,
+                                 unsigned int height)
+{
+  vpImage<unsigned char> I_closing;
+  closing(I, I_closing, width, height);
+  subtract(I_closing, I, Ires);
+}
+
+/*!
+  Morphological gradient of a grayscale image, the difference between its
+  dilatation and its erosion with a flat rectangular structuring element of
+  \e width x \e height pixels.
+
+  \param I : Image to process.
+  \param Ires : Result image.
+  \param width : Width of the structuring element.
+  \param height : Height of the structuring element.
+*/
+void vpImageMorphology::gradient(const vpImage<unsigned char> &I, vpImage<unsigned char> &Ires, unsigned int width,
+                                 unsigned int height)
+{
+  vpImage<unsigned char> I_dilatation, I_erosion;
+  morphologyRect(I, I_dilatation, width, height, true);
+  morphologyRect(I, I_erosion, width, height, false);
+  subtract(I_dilatation, I_erosion, Ires);
+}
@@ -0,0 +1,273 @@
+/****************************************************************************
+ *
+ * ViSP, open source Visual Servoing Platform software.
+ * Copyright (C) 2005 - 2019 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Organized point cloud.
+ *
+ *****************************************************************************/
+
+#include <visp3/core/vpException.h>
+#include <visp3/core/vpPointCloud.h>
+
+/*!
+  Default constructor: empty point cloud with the packed storage.
+*/
+vpPointCloud::vpPointCloud()
+  : m_storage(XYZ_STORAGE), m_width(0), m_height(0), m_stride(0), m_data(), m_xyz(NULL), m_depthRaw(NULL),
+    m_depthFloat(NULL), m_depthScale(1.0f), m_xFactor(), m_yFactor()
+{
+}
+
+/*!
+  Allocate a point cloud with the packed storage. Points are initialized to 0,
+  that is they are considered as invalid.
+
+  \param height : Number of rows.
+  \param width : Number of columns.
+*/
+vpPointCloud::vpPointCloud(unsigned int height, unsigned int width)
+  : m_storage(XYZ_STORAGE), m_width(0), m_height(0), m_stride(0), m_data(), m_xyz(NULL), m_depthRaw(NULL),
+    m_depthFloat(NULL), m_depthScale(1.0f), m_xFactor(), m_yFactor()
+{
+  resize(height, width);
+}
+
+/*!
+  Wrap an external buffer of packed \f$X,Y,Z\f$ float triplets. The data are
+  not copied and must outlive the point cloud.
+
+  \param data : Pointer to the first point.
+  \param height : Number of rows.
+  \param width : Number of columns.
+  \param stride : Number of floats between two consecutive rows. If 0, rows
+  are considered contiguous, that is the stride is 3 x \e width.
+*/
+vpPointCloud::vpPointCloud(float *const data, unsigned int height, unsigned int width, unsigned int stride)
+  : m_storage(XYZ_STORAGE), m_width(width), m_height(height), m_stride(stride == 0 ? 3 * width : stride), m_data(),
+    m_xyz(data), m_depthRaw(NULL), m_depthFloat(NULL), m_depthScale(1.0f), m_xFactor(), m_yFactor()
+{
+  if (m_stride < 3 * width) {
+    throw vpException(vpException::dimensionError, "Point cloud stride (%u) is lower than 3 x width (%u)", m_stride,
+                      3 * width);
+  }
+}
+
+/*!
+  Copy constructor. Owned data are deep copied while external buffers and
+  depth maps are shared.
+*/
+vpPointCloud::vpPointCloud(const vpPointCloud &pointcloud)
+  : m_storage(XYZ_STORAGE), m_width(0), m_height(0), m_stride(0), m_data(), m_xyz(NULL), m_depthRaw(NULL),
+    m_depthFloat(NULL), m_depthScale(1.0f), m_xFactor(), m_yFactor()
+{
+  *this = pointcloud;
+}
+
+/*!
+  Copy operator. Owned data are deep copied while external buffers and
+  depth maps are shared.
+*/
+vpPointCloud &vpPointCloud::operator=(const vpPointCloud &pointcloud)
+{
+  if (this == &pointcloud) {
+    return *this;
+  }
+
+  m_storage = pointcloud.m_storage;
+  m_width = pointcloud.m_width;
+  m_height = pointcloud.m_height;
+  m_stride = pointcloud.m_stride;
+  m_data = pointcloud.m_data;
+  m_depthRaw = pointcloud.m_depthRaw;
+  m_depthFloat = pointcloud.m_depthFloat;
+  m_depthScale = pointcloud.m_depthScale;
+  m_xFactor = pointcloud.m_xFactor;
+  m_yFactor = pointcloud.m_yFactor;
+
+  if (!pointcloud.m_data.empty() && pointcloud.m_xyz == &pointcloud.m_data[0]) {
+    m_xyz = &m_data[0];
+  } else {
+    m_xyz = pointcloud.m_xyz;
+  }
+
+  return *this;
+}
+
+/*!
+  Copy a point cloud stored as a vector of vpColVector, as produced by
+  vpRealSense2::acquire() or vpKinect. The packed storage is used.
+
+  \param point_cloud : Vector of \e width x \e height points, each point being
+  at least a 3-dim vector.
+  \param width : Number of columns.
+  \param height : Number of rows.
+*/
+void vpPointCloud::buildFrom(const std::vector<vpColVector> &point_cloud, unsigned int width, unsigned int height)
+{
+  if (point_cloud.size() != static_cast<size_t>(width) * height) {
+    throw vpException(vpException::dimensionError, "Point cloud size (%lu) is not %ux%u",
+                      static_cast<unsigned long>(point_cloud.size()), width, height);
+  }
+
+  resize(height, width);
+
+  for (unsigned int i = 0; i < height; i++) {
+    float *ptr = m_xyz + i * m_stride;
+    for (unsigned int j = 0; j < width; j++, ptr += 3) {
+      const vpColVector &pt = point_cloud[i * width + j];
+      ptr[0] = static_cast<float>(pt[0]);
+      ptr[1] = static_cast<float>(pt[1]);
+      ptr[2] = static_cast<float>(pt[2]);
+    }
+  }
+}
+
+/*!
+  Build a point cloud view over a raw depth map. 3D points are not
+  materialized, the depth map is not copied and must outlive the point cloud.
+
+  \param depth : Raw depth map, a value of 0 means no depth.
+  \param cam : Depth camera intrinsic parameters.
+  \param depthScale : Scale to convert raw depth values into meter.
+*/
+void vpPointCloud::buildFrom(const vpImage<uint16_t> &depth, const vpCameraParameters &cam, float depthScale)
+{
+  m_storage = DEPTH_UINT16_STORAGE;
+  m_width = depth.getWidth();
+  m_height = depth.getHeight();
+  m_stride = m_width;
+  m_xyz = NULL;
+  m_depthRaw = depth.bitmap;
+  m_depthFloat = NULL;
+  m_depthScale = depthScale;
+
+  computeFactors(cam);
+}
+
+/*!
+  Build a point cloud view over a metric depth map. 3D points are not
+  materialized, the depth map is not copied and must outlive the point cloud.
+
+  \param depth : Depth map in meter, values lower or equal to 0 or NaN mean no depth.
+  \param cam : Depth camera intrinsic parameters.
+*/
+void vpPointCloud::buildFrom(const vpImage<float> &depth, const vpCameraParameters &cam)
+{
+  m_storage = DEPTH_FLOAT_STORAGE;
+  m_width = depth.getWidth();
+  m_height = depth.getHeight();
+  m_stride = m_width;
+  m_xyz = NULL;
+  m_depthRaw = NULL;
+  m_depthFloat = depth.bitmap;
+  m_depthScale = 1.0f;
+
+  computeFactors(cam);
+}
+
+/*!
+  Release the owned memory and reset the point cloud to an empty packed storage.
+*/
+void vpPointCloud::clear()
+{
+  m_storage = XYZ_STORAGE;
+  m_width = 0;
+  m_height = 0;
+  m_stride = 0;
+  std::vector<float>().swap(m_data);
+  m_xyz = NULL;
+  m_depthRaw = NULL;
+  m_depthFloat = NULL;
+  m_depthScale = 1.0f;
+  m_xFactor.clear();
+  m_yFactor.clear();
+}
+
+void vpPointCloud::computeFactors(const vpCameraParameters &cam)
+{
+  const double inv_px = cam.get_px_inverse(), inv_py = cam.get_py_inverse();
+  const double u0 = cam.get_u0(), v0 = cam.get_v0();
+
+  m_xFactor.resize(m_width);
+  for (unsigned int j = 0; j < m_width; j++) {
+    m_xFactor[j] = static_cast<float>((j - u0) * inv_px);
+  }
+
+  m_yFactor.resize(m_height);
+  for (unsigned int i = 0; i < m_height; i++) {
+    m_yFactor[i] = static_cast<float>((i - v0) * inv_py);
+  }
+}
+
+/*!
+  Resize the point cloud and switch to the packed \f$X,Y,Z\f$ storage with
+  contiguous rows. The memory is reallocated only if the new size is greater
+  than the current capacity, so that resizing at each frame is allocation free.
+  Points are reset to 0.
+
+  \param height : Number of rows.
+  \param width : Number of columns.
+*/
+void vpPointCloud::resize(unsigned int height, unsigned int width)
+{
+  m_storage = XYZ_STORAGE;
+  m_width = width;
+  m_height = height;
+  m_stride = 3 * width;
+  m_data.assign(static_cast<size_t>(m_stride) * height, 0.0f);
+  m_xyz = m_data.empty() ? NULL : &m_data[0];
+  m_depthRaw = NULL;
+  m_depthFloat = NULL;
+  m_depthScale = 1.0f;
+}
+
+/*!
+  Convert the point cloud into the legacy vector of vpColVector
+  representation. Each point is a 4-dim homogeneous vector.
+
+  \param point_cloud : Vector of width x height points.
+*/
+void vpPointCloud::toVector(std::vector<vpColVector> &point_cloud) const
+{
+  point_cloud.resize(static_cast<size_t>(m_width) * m_height);
+
+  float X = 0, Y = 0, Z = 0;
+  for (unsigned int i = 0; i < m_height; i++) {
+    for (unsigned int j = 0; j < m_width; j++) {
+      getPoint(i, j, X, Y, Z);
+      vpColVector &pt = point_cloud[i * m_width + j];
+      pt.resize(4, false);
+      pt[0] = X;
+      pt[1] = Y;
+      pt[2] = Z;
+      pt[3] = 1.0;
+    }
+  }
+}
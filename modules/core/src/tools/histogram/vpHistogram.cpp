@@ -50,89 +50,95 @@
 #include <visp3/core/vpHistogram.h>
 #include <visp3/core/vpImageConvert.h>
 
-#if defined(VISP_HAVE_PTHREAD) || (defined(_WIN32) && !defined(WINRT_8_0))
+#if defined _OPENMP
+#include <omp.h>
+#elif defined(VISP_HAVE_PTHREAD) || (defined(_WIN32) && !defined(WINRT_8_0))
 #include <visp3/core/vpThread.h>
+#endif
 
 namespace
 {
-struct Histogram_Param_t {
-  unsigned int m_start_index;
-  unsigned int m_end_index;
-
-  unsigned int m_lut[256];
-  unsigned int *m_histogram;
-  const vpImage<unsigned char> *m_I;
-
-  Histogram_Param_t() : m_start_index(0), m_end_index(0), m_lut(), m_histogram(NULL), m_I(NULL) {}
-
-  Histogram_Param_t(unsigned int start_index, unsigned int end_index, const vpImage<unsigned char> *const I)
-    : m_start_index(start_index), m_end_index(end_index), m_lut(), m_histogram(NULL), m_I(I)
-  {
-  }
+/*
+  Number of interleaved sub-histograms. Consecutive pixels are counted in
+  different sub-histograms, so that incrementing the same bin twice in a row
+  does not wait for the previous store to complete.
+*/
+const unsigned int nbSubHistograms = 4;
 
-  ~Histogram_Param_t()
-  {
-    if (m_histogram != NULL) {
-      delete[] m_histogram;
+/*
+  Count the pixels of the rows [y0, y1) and columns [x0, x1) of I, where the
+  mask is true if any, in the nbSubHistograms interleaved histograms of 256
+  bins of subHist.
+*/
+void countHistogram(const vpImage<unsigned char> &I, const vpImage<bool> *mask, unsigned int x0, unsigned int x1,
+                    unsigned int y0, unsigned int y1, const unsigned int *lut, unsigned int *subHist)
+{
+  unsigned int *h0 = subHist, *h1 = subHist + 256, *h2 = subHist + 512, *h3 = subHist + 768;
+
+  for (unsigned int y = y0; y < y1; y++) {
+    const unsigned char *row = I[y];
+    unsigned int x = x0;
+
+    if (mask == NULL) {
+      for (; x + 4 <= x1; x += 4) {
+        h0[lut[row[x]]]++;
+        h1[lut[row[x + 1]]]++;
+        h2[lut[row[x + 2]]]++;
+        h3[lut[row[x + 3]]]++;
+      }
+      for (; x < x1; x++) {
+        h0[lut[row[x]]]++;
+      }
+    } else {
+      const bool *m = (*mask)[y];
+      for (; x + 4 <= x1; x += 4) {
+        h0[lut[row[x]]] += m[x] ? 1 : 0;
+        h1[lut[row[x + 1]]] += m[x + 1] ? 1 : 0;
+        h2[lut[row[x + 2]]] += m[x + 2] ? 1 : 0;
+        h3[lut[row[x + 3]]] += m[x + 3] ? 1 : 0;
+      }
+      for (; x < x1; x++) {
+        h0[lut[row[x]]] += m[x] ? 1 : 0;
+      }
     }
   }
-};
+}
 
-vpThread::Return computeHistogramThread(vpThread::Args args)
+// Add the interleaved sub-histograms to a histogram of size bins
+void mergeHistogram(const unsigned int *subHist, unsigned int size, unsigned int *histogram)
 {
-  Histogram_Param_t *histogram_param = static_cast<Histogram_Param_t *>(args);
-  unsigned int start_index = histogram_param->m_start_index;
-  unsigned int end_index = histogram_param->m_end_index;
-
-  const vpImage<unsigned char> *I = histogram_param->m_I;
-
-  unsigned char *ptrStart = (unsigned char *)(I->bitmap) + start_index;
-  unsigned char *ptrEnd = (unsigned char *)(I->bitmap) + end_index;
-  unsigned char *ptrCurrent = ptrStart;
-
-  //    while(ptrCurrent != ptrEnd) {
-  //      histogram_param->m_histogram[ histogram_param->m_lut[ *ptrCurrent ]
-  //      ] ++;
-  //      ++ptrCurrent;
-  //    }
-
-  if (end_index - start_index >= 8) {
-    // Unroll loop version
-    for (; ptrCurrent <= ptrEnd - 8;) {
-      histogram_param->m_histogram[histogram_param->m_lut[*ptrCurrent]]++;
-      ++ptrCurrent;
-
-      histogram_param->m_histogram[histogram_param->m_lut[*ptrCurrent]]++;
-      ++ptrCurrent;
-
-      histogram_param->m_histogram[histogram_param->m_lut[*ptrCurrent]]++;
-      ++ptrCurrent;
-
-      histogram_param->m_histogram[histogram_param->m_lut[*ptrCurrent]]++;
-      ++ptrCurrent;
-
-      histogram_param->m_histogram[histogram_param->m_lut[*ptrCurrent]]++;
-      ++ptrCurrent;
+  for (unsigned int i = 0; i < size; i++) {
+    histogram[i] += subHist[i] + subHist[i + 256] + subHist[i + 512] + subHist[i + 768];
+  }
+}
 
-      histogram_param->m_histogram[histogram_param->m_lut[*ptrCurrent]]++;
-      ++ptrCurrent;
+#if !defined _OPENMP && (defined(VISP_HAVE_PTHREAD) || (defined(_WIN32) && !defined(WINRT_8_0)))
+struct Histogram_Param_t {
+  unsigned int m_x0, m_x1, m_y0, m_y1;
 
-      histogram_param->m_histogram[histogram_param->m_lut[*ptrCurrent]]++;
-      ++ptrCurrent;
+  const unsigned int *m_lut;
+  std::vector<unsigned int> m_subHist;
+  const vpImage<unsigned char> *m_I;
+  const vpImage<bool> *m_mask;
 
-      histogram_param->m_histogram[histogram_param->m_lut[*ptrCurrent]]++;
-      ++ptrCurrent;
-    }
+  Histogram_Param_t(unsigned int x0, unsigned int x1, unsigned int y0, unsigned int y1, const unsigned int *lut,
+                    const vpImage<unsigned char> *const I, const vpImage<bool> *const mask)
+    : m_x0(x0), m_x1(x1), m_y0(y0), m_y1(y1), m_lut(lut), m_subHist(nbSubHistograms * 256, 0), m_I(I),
+      m_mask(mask)
+  {
   }
+};
 
-  for (; ptrCurrent != ptrEnd; ++ptrCurrent) {
-    histogram_param->m_histogram[histogram_param->m_lut[*ptrCurrent]]++;
-  }
+vpThread::Return computeHistogramThread(vpThread::Args args)
+{
+  Histogram_Param_t *param = static_cast<Histogram_Param_t *>(args);
+  countHistogram(*param->m_I, param->m_mask, param->m_x0, param->m_x1, param->m_y0, param->m_y1, param->m_lut,
+                 &param->m_subHist[0]);
 
   return 0;
 }
-}
 #endif
+} // namespace
 
 bool compare_vpHistogramPeak(vpHistogramPeak first, vpHistogramPeak second);
 
@@ -148,12 +154,12 @@ bool compare_vpHistogramPeak(vpHistogramPeak first, vpHistogramPeak second)
 /*!
   Defaut constructor for a gray level histogram.
 */
-vpHistogram::vpHistogram() : histogram(NULL), size(256) { init(); }
+vpHistogram::vpHistogram() : histogram(NULL), size(256), m_mask(NULL) { init(); }
 
 /*!
   Copy constructor of a gray level histogram.
 */
-vpHistogram::vpHistogram(const vpHistogram &h) : histogram(NULL), size(256)
+vpHistogram::vpHistogram(const vpHistogram &h) : histogram(NULL), size(256), m_mask(h.m_mask)
 {
   init(h.size);
   memcpy(histogram, h.histogram, size * sizeof(unsigned));
@@ -166,7 +172,25 @@ vpHistogram::vpHistogram(const vpHistogram &h) : histogram(NULL), size(256)
 
   \sa calculate()
 */
-vpHistogram::vpHistogram(const vpImage<unsigned char> &I) : histogram(NULL), size(256)
+vpHistogram::vpHistogram(const vpImage<unsigned char> &I) : histogram(NULL), size(256), m_mask(NULL)
+{
+  init();
+
+  calculate(I);
+}
+
+/*!
+  Calculates the histrogram from the pixels of a gray level image where a
+  mask is true.
+
+  \param I : Gray level image.
+  \param p_mask : Pointer to the mask, of the same size as \e I, or NULL to
+  count all the pixels. The mask is kept for the next calls to calculate().
+
+  \sa calculate(), setMask()
+*/
+vpHistogram::vpHistogram(const vpImage<unsigned char> &I, const vpImage<bool> *p_mask)
+  : histogram(NULL), size(256), m_mask(p_mask)
 {
   init();
 
@@ -201,8 +225,13 @@ vpHistogram::~vpHistogram()
 */
 vpHistogram &vpHistogram::operator=(const vpHistogram &h)
 {
+  if (this == &h) {
+    return *this;
+  }
+
   init(h.size);
   memcpy(histogram, h.histogram, size * sizeof(unsigned));
+  m_mask = h.m_mask;
 
   return *this;
 }
@@ -229,14 +258,70 @@ void vpHistogram::init(unsigned size_)
 
 /*!
 
-  Calculate the histogram from a gray level image.
+  Calculate the histogram from a gray level image. When a mask is set with
+  setMask(), only the pixels where the mask is true are counted.
+
+  The pixels are counted in interleaved sub-histograms, merged at the end,
+  which avoids the stalls of consecutive increments of the same bin. When
+  ViSP is built with OpenMP, the rows are shared between the threads of the
+  OpenMP pool, that persist between the calls.
 
   \param I : Gray level image.
   \param nbins : Number of bins to compute the histogram.
   \param nbThreads : Number of threads to use for the computation.
+
+  \exception vpException::dimensionError : The mask and the image sizes
+  differ.
 */
 void vpHistogram::calculate(const vpImage<unsigned char> &I, unsigned int nbins, unsigned int nbThreads)
 {
+  calculate(I, 0, I.getWidth(), 0, I.getHeight(), nbins, nbThreads);
+}
+
+/*!
+
+  Calculate the histogram of a region of interest of a gray level image.
+  When a mask is set with setMask(), only the pixels of the region where the
+  mask is true are counted.
+
+  \param I : Gray level image.
+  \param roi : Region of interest, clipped to the image. The pixels with
+  coordinates between roi.getLeft() and roi.getRight(), and between
+  roi.getTop() and roi.getBottom(), are counted.
+  \param nbins : Number of bins to compute the histogram.
+  \param nbThreads : Number of threads to use for the computation.
+
+  \exception vpException::dimensionError : The mask and the image sizes
+  differ.
+*/
+void vpHistogram::calculate(const vpImage<unsigned char> &I, const vpRect &roi, unsigned int nbins,
+                            unsigned int nbThreads)
+{
+  double left = (std::max)(0.0, std::ceil(roi.getLeft()));
+  double top = (std::max)(0.0, std::ceil(roi.getTop()));
+  double right = (std::min)((double)I.getWidth(), std::floor(roi.getRight()) + 1.0);
+  double bottom = (std::min)((double)I.getHeight(), std::floor(roi.getBottom()) + 1.0);
+
+  if (right <= left || bottom <= top) {
+    calculate(I, 0, 0, 0, 0, nbins, nbThreads);
+  } else {
+    calculate(I, (unsigned int)left, (unsigned int)right, (unsigned int)top, (unsigned int)bottom, nbins,
+              nbThreads);
+  }
+}
+
+/*!
+  Calculate the histogram of the rows [y0, y1) and columns [x0, x1) of an
+  image.
+*/
+void vpHistogram::calculate(const vpImage<unsigned char> &I, unsigned int x0, unsigned int x1, unsigned int y0,
+                            unsigned int y1, unsigned int nbins, unsigned int nbThreads)
+{
+  if (m_mask != NULL && (m_mask->getWidth() != I.getWidth() || m_mask->getHeight() != I.getHeight())) {
+    throw(vpException(vpException::dimensionError, "The mask size (%dx%d) differs from the image size (%dx%d)",
+                      m_mask->getWidth(), m_mask->getHeight(), I.getWidth(), I.getHeight()));
+  }
+
   if (size != nbins) {
     if (histogram != NULL) {
       delete[] histogram;
@@ -252,15 +337,9 @@ void vpHistogram::calculate(const vpImage<unsigned char> &I, unsigned int nbins,
 
   memset(histogram, 0, size * sizeof(unsigned int));
 
-  bool use_single_thread;
-#if !defined(VISP_HAVE_PTHREAD) && !defined(_WIN32)
-  use_single_thread = true;
-#else
-  use_single_thread = (nbThreads == 0 || nbThreads == 1);
-#endif
-
-  if (!use_single_thread && I.getSize() <= nbThreads) {
-    use_single_thread = true;
+  unsigned int nbRows = y1 - y0;
+  if (nbThreads == 0 || nbRows < nbThreads) {
+    nbThreads = 1;
   }
 
   unsigned int lut[256];
@@ -268,74 +347,56 @@ void vpHistogram::calculate(const vpImage<unsigned char> &I, unsigned int nbins,
     lut[i] = (unsigned int)(i * size / 256.0);
   }
 
-  if (use_single_thread) {
-    // Single thread
-
-    unsigned int size_ = I.getWidth() * I.getHeight();
-    unsigned char *ptrStart = (unsigned char *)I.bitmap;
-    unsigned char *ptrEnd = ptrStart + size_;
-    unsigned char *ptrCurrent = ptrStart;
-
-    while (ptrCurrent != ptrEnd) {
-      histogram[lut[*ptrCurrent]]++;
-      ++ptrCurrent;
-    }
-  } else {
-#if defined(VISP_HAVE_PTHREAD) || (defined(_WIN32) && !defined(WINRT_8_0))
-    // Multi-threads
-
-    std::vector<vpThread *> threadpool;
-    std::vector<Histogram_Param_t *> histogramParams;
-
-    unsigned int image_size = I.getSize();
-    unsigned int step = image_size / nbThreads;
-    unsigned int last_step = image_size - step * (nbThreads - 1);
-
-    for (unsigned int index = 0; index < nbThreads; index++) {
-      unsigned int start_index = index * step;
-      unsigned int end_index = (index + 1) * step;
-
-      if (index == nbThreads - 1) {
-        end_index = start_index + last_step;
-      }
-
-      Histogram_Param_t *histogram_param = new Histogram_Param_t(start_index, end_index, &I);
-      histogram_param->m_histogram = new unsigned int[size];
-      memset(histogram_param->m_histogram, 0, size * sizeof(unsigned int));
-      memcpy(histogram_param->m_lut, lut, 256 * sizeof(unsigned int));
+  if (nbThreads == 1) {
+    std::vector<unsigned int> subHist(nbSubHistograms * 256, 0);
+    countHistogram(I, m_mask, x0, x1, y0, y1, lut, &subHist[0]);
+    mergeHistogram(&subHist[0], size, histogram);
+    return;
+  }
 
-      histogramParams.push_back(histogram_param);
+#if defined _OPENMP
+#pragma omp parallel num_threads(nbThreads)
+  {
+    std::vector<unsigned int> subHist(nbSubHistograms * 256, 0);
 
-      // Start the threads
-      vpThread *histogram_thread = new vpThread((vpThread::Fn)computeHistogramThread, (vpThread::Args)histogram_param);
-      threadpool.push_back(histogram_thread);
+#pragma omp for schedule(static)
+    for (int y = (int)y0; y < (int)y1; y++) {
+      countHistogram(I, m_mask, x0, x1, (unsigned int)y, (unsigned int)y + 1, lut, &subHist[0]);
     }
 
-    for (size_t cpt = 0; cpt < threadpool.size(); cpt++) {
-      // Wait until thread ends up
-      threadpool[cpt]->join();
-    }
+#pragma omp critical
+    mergeHistogram(&subHist[0], size, histogram);
+  }
+#elif defined(VISP_HAVE_PTHREAD) || (defined(_WIN32) && !defined(WINRT_8_0))
+  std::vector<vpThread *> threadpool;
+  std::vector<Histogram_Param_t *> histogramParams;
 
-    for (unsigned int cpt1 = 0; cpt1 < size; cpt1++) {
-      unsigned int sum = 0;
+  unsigned int step = nbRows / nbThreads;
+  for (unsigned int index = 0; index < nbThreads; index++) {
+    unsigned int start_row = y0 + index * step;
+    unsigned int end_row = (index == nbThreads - 1) ? y1 : start_row + step;
 
-      for (size_t cpt2 = 0; cpt2 < histogramParams.size(); cpt2++) {
-        sum += histogramParams[cpt2]->m_histogram[cpt1];
-      }
+    Histogram_Param_t *histogram_param = new Histogram_Param_t(x0, x1, start_row, end_row, lut, &I, m_mask);
+    histogramParams.push_back(histogram_param);
 
-      histogram[cpt1] = sum;
-    }
+    // Start the threads
+    vpThread *histogram_thread = new vpThread((vpThread::Fn)computeHistogramThread, (vpThread::Args)histogram_param);
+    threadpool.push_back(histogram_thread);
+  }
 
-    // Delete
-    for (size_t cpt = 0; cpt < threadpool.size(); cpt++) {
-      delete threadpool[cpt];
-    }
+  for (size_t cpt = 0; cpt < threadpool.size(); cpt++) {
+    // Wait until thread ends up
+    threadpool[cpt]->join();
+    mergeHistogram(&histogramParams[cpt]->m_subHist[0], size, histogram);
 
-    for (size_t cpt = 0; cpt < histogramParams.size(); cpt++) {
-      delete histogramParams[cpt];
-    }
-#endif
+    delete threadpool[cpt];
+    delete histogramParams[cpt];
   }
+#else
+  std::vector<unsigned int> subHist(nbSubHistograms * 256, 0);
+  countHistogram(I, m_mask, x0, x1, y0, y1, lut, &subHist[0]);
+  mergeHistogram(&subHist[0], size, histogram);
+#endif
 }
 
 /*!
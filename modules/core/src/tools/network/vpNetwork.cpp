@@ -41,9 +41,84 @@
 // inet_ntop() not supported on win XP
 #ifdef VISP_HAVE_FUNC_INET_NTOP
 
+#include <algorithm>
+#include <errno.h>
+#include <limits.h>
+#include <stdint.h>
+#if !defined(_WIN32) && (defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))) // UNIX
+#include <sys/uio.h>
+#endif
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+namespace
+{
+// "VPNF" in network byte order, first word of a binary frame
+const uint32_t binaryFrameMagic = 0x56504e46;
+
+// Maximum number of buffers given to a single scatter/gather call
+#if defined(IOV_MAX)
+const size_t maxNbIoBuffers = IOV_MAX;
+#else
+const size_t maxNbIoBuffers = 16;
+#endif
+
+uint32_t readWord(const char *data)
+{
+  uint32_t word;
+  memcpy(&word, data, sizeof(word));
+  return ntohl(word);
+}
+
+/*
+  Parse the header of a binary frame: magic, size of the id, number of
+  parameters and size of each parameter. Return false while the header is not
+  entirely received. headerSize is the size of the header followed by the id,
+  frameSize the size of the whole frame. valid is set to false when the frame
+  doesn't start with the magic word or is larger than maxFrameSize, which is
+  detected before anything is allocated for the frame.
+*/
+bool parseFrameHeader(const char *data, size_t size, size_t maxFrameSize, bool &valid, uint32_t &nbParams,
+                      size_t &headerSize, size_t &frameSize)
+{
+  valid = true;
+  if (size < 3 * sizeof(uint32_t)) {
+    return false;
+  }
+  if (readWord(data) != binaryFrameMagic) {
+    valid = false;
+    return false;
+  }
+  uint32_t idSize = readWord(data + sizeof(uint32_t));
+  nbParams = readWord(data + 2 * sizeof(uint32_t));
+  // The sizes are summed on 64 bits, so that they can't overflow
+  uint64_t total = (3 + static_cast<uint64_t>(nbParams)) * sizeof(uint32_t) + idSize;
+  if (total > maxFrameSize) {
+    valid = false;
+    return false;
+  }
+  if (size < (3 + static_cast<size_t>(nbParams)) * sizeof(uint32_t)) {
+    return false;
+  }
+
+  headerSize = static_cast<size_t>(total);
+  for (uint32_t i = 0; i < nbParams; i++) {
+    total += readWord(data + (3 + i) * sizeof(uint32_t));
+    if (total > maxFrameSize) {
+      valid = false;
+      return false;
+    }
+  }
+  frameSize = static_cast<size_t>(total);
+
+  return size >= headerSize;
+}
+} // namespace
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
 vpNetwork::vpNetwork()
   : emitter(), receptor_list(), readFileDescriptor(), socketMax(0), request_list(), max_size_message(999999),
-    separator("[*@*]"), beginning("[*start*]"), end("[*end*]"), param_sep("[*|*]"), currentMessageReceived(), tv(),
+    separator("[*@*]"), beginning("[*start*]"), end("[*end*]"), param_sep("[*|*]"), currentMessageReceived(),
+    framingType(TEXT_FRAMING), receivedBuffer(), receivedBegin(0), receivedEnd(0), receivedInvalidFrame(false), tv(),
     tv_sec(0), tv_usec(10), verboseMode(false)
 {
   tv.tv_sec = tv_sec;
@@ -115,6 +190,33 @@ void vpNetwork::removeDecodingRequest(const char *id)
   }
 }
 
+/*!
+  Change the framing of the requests sent and received. The requests that are
+  partially received are discarded.
+
+  \sa vpNetwork::getFramingType()
+
+  \param type : vpNetwork::TEXT_FRAMING (default) to delimit the requests with
+  string markers, or vpNetwork::BINARY_FRAMING to prefix them with their
+  sizes. Both ends of a connection must use the same framing.
+*/
+void vpNetwork::setFramingType(const vpFramingType &type)
+{
+  framingType = type;
+  currentMessageReceived.clear();
+  receivedBegin = 0;
+  receivedEnd = 0;
+  receivedInvalidFrame = false;
+  for (unsigned int i = 0; i < receptor_list.size(); i++) {
+    vpReceptor &receptor = receptor_list[i];
+    receptor.receivedBegin = 0;
+    receptor.receivedEnd = 0;
+    receptor.receivingBinaryRequest = false;
+    receptor.receivedBinaryRequest = false;
+    receptor.receivingParameters.clear();
+  }
+}
+
 /*!
   Print the receptors.
 
@@ -196,6 +298,9 @@ int vpNetwork::sendRequestTo(vpRequest &req, const unsigned int &dest)
     return 0;
   }
 
+  if (framingType == BINARY_FRAMING)
+    return _sendBinaryRequestTo(req, dest);
+
   std::string message = beginning + req.getId() + separator;
 
   if (req.size() != 0) {
@@ -508,6 +613,9 @@ std::vector<int> vpNetwork::_handleRequests()
 */
 int vpNetwork::_handleFirstRequest()
 {
+  if (framingType == BINARY_FRAMING)
+    return _handleFirstBinaryRequest();
+
   size_t indStart = currentMessageReceived.find(beginning);
   size_t indSep = currentMessageReceived.find(separator);
   size_t indEnd = currentMessageReceived.find(end);
@@ -550,23 +658,15 @@ int vpNetwork::_handleFirstRequest()
   //   std::cout << "Handling : " << currentMessageReceived.substr(indStart,
   //   indEnd+end.size() - indStart) << std::endl;
 
-  int indRequest = 0;
-  bool hasBeenFound = false;
-  for (unsigned int i = 0; i < request_list.size(); i++) {
-    if (id == request_list[i]->getId()) {
-      hasBeenFound = true;
-      request_list[i]->clear();
-      indRequest = (int)i;
-      break;
-    }
-  }
+  int indRequest = _findRequest(id);
 
-  if (!hasBeenFound) {
+  if (indRequest == -1) {
     // currentMessageReceived.erase(indStart,indEnd+end.size());
     if (verboseMode)
       vpTRACE("No request corresponds to the received message");
     return -1;
   }
+  request_list[(unsigned)indRequest]->clear();
 
   size_t indDebParam = indSep + separator.size();
   size_t indEndParam = currentMessageReceived.find(param_sep, indDebParam);
@@ -686,23 +786,7 @@ int vpNetwork::_receiveRequestOnce()
   } else {
     for (unsigned int i = 0; i < receptor_list.size(); i++) {
       if (FD_ISSET((unsigned int)receptor_list[i].socketFileDescriptorReceptor, &readFileDescriptor)) {
-        char *buf = new char[max_size_message];
-#if !defined(_WIN32) && (defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))) // UNIX
-        numbytes = (int)recv(receptor_list[i].socketFileDescriptorReceptor, buf, max_size_message, 0);
-#else
-        numbytes = recv((unsigned int)receptor_list[i].socketFileDescriptorReceptor, buf, (int)max_size_message, 0);
-#endif
-
-        if (numbytes <= 0) {
-          std::cout << "Disconnected : " << inet_ntoa(receptor_list[i].receptorAddress.sin_addr) << std::endl;
-          receptor_list.erase(receptor_list.begin() + (int)i);
-          delete[] buf;
-          return numbytes;
-        } else {
-          std::string returnVal(buf, (unsigned int)numbytes);
-          currentMessageReceived.append(returnVal);
-        }
-        delete[] buf;
+        numbytes = _receiveMessage(i);
         break;
       }
     }
@@ -765,28 +849,433 @@ int vpNetwork::_receiveRequestOnceFrom(const unsigned int &receptorEmitting)
     return 0;
   } else {
     if (FD_ISSET((unsigned int)receptor_list[receptorEmitting].socketFileDescriptorReceptor, &readFileDescriptor)) {
-      char *buf = new char[max_size_message];
+      numbytes = _receiveMessage(receptorEmitting);
+    }
+  }
+
+  return numbytes;
+}
+
+/*!
+  Get the index of the decoding request with a given id.
+
+  \param id : Id of the request.
+
+  \return Index of the request in the list of decoding requests, or -1 if no
+  request has this id.
+*/
+int vpNetwork::_findRequest(const std::string &id)
+{
+  for (unsigned int i = 0; i < request_list.size(); i++) {
+    if (id == request_list[i]->getId())
+      return (int)i;
+  }
+
+  return -1;
+}
+
+/*!
+  Handle the first binary frame in the queue. The frames received by
+  vpServer::processEvents() are handled first, then the frames of each
+  receptor. The request of a receptor whose end has been read by
+  _receiveBinaryRequestEnd() is handled before the frames of this receptor,
+  since it always precedes the bytes kept in its receive buffer.
+
+  \sa vpNetwork::setFramingType()
+
+  \return : The index of the request that has been handled, or -1 if no
+  entire frame of a known request has been received.
+*/
+int vpNetwork::_handleFirstBinaryRequest()
+{
+  int indRequest = _handleFirstBinaryFrame(receivedBuffer, receivedBegin, receivedEnd);
+  if (indRequest != -1)
+    return indRequest;
+
+  for (unsigned int i = 0; i < receptor_list.size(); i++) {
+    vpReceptor &receptor = receptor_list[i];
+    if (receptor.receivedBinaryRequest) {
+      receptor.receivedBinaryRequest = false;
+      indRequest = _findRequest(receptor.receivingId);
+      if (indRequest != -1) {
+        // The parameters are moved to the request, without being copied
+        vpRequest &req = *request_list[(unsigned)indRequest];
+        req.clear();
+        for (unsigned int j = 0; j < receptor.receivingParameters.size(); j++) {
+          std::string emptyParam;
+          req.addParameter(emptyParam);
+          req[j].swap(receptor.receivingParameters[j]);
+        }
+      } else if (verboseMode) {
+        vpTRACE("No request corresponds to the received message");
+      }
+      receptor.receivingParameters.clear();
+      if (indRequest != -1)
+        return indRequest;
+    }
+
+    indRequest = _handleFirstBinaryFrame(receptor.receivedBuffer, receptor.receivedBegin, receptor.receivedEnd);
+    if (indRequest != -1)
+      return indRequest;
+  }
+
+  return -1;
+}
+
+/*!
+  Handle the first binary frame of a receive buffer.
+
+  \param buffer : Receive buffer.
+  \param begin : Index of the first byte of the buffer that is not handled yet.
+  \param end : Index following the last received byte of the buffer.
+
+  \return : The index of the request that has been handled, or -1 if no
+  entire frame of a known request is in the buffer.
+*/
+int vpNetwork::_handleFirstBinaryFrame(std::vector<char> &buffer, size_t &begin, size_t &end)
+{
+  while (begin < end) {
+    const char *frame = &buffer[begin];
+    bool valid;
+    uint32_t nbParams = 0;
+    size_t headerSize = 0, frameSize = 0;
+    bool hasHeader = parseFrameHeader(frame, end - begin, max_size_message, valid, nbParams, headerSize, frameSize);
+    if (!valid) {
+      // The frames can't be resynchronized
+      if (verboseMode)
+        vpTRACE("Incorrect message");
+      begin = end = 0;
+      receivedInvalidFrame = true;
+      return -1;
+    }
+    if (!hasHeader || end - begin < frameSize)
+      return -1;
+
+    size_t paramsOffset = (3 + nbParams) * sizeof(uint32_t);
+    std::string id(frame + paramsOffset, headerSize - paramsOffset);
+    int indRequest = _findRequest(id);
+    if (indRequest != -1) {
+      vpRequest &req = *request_list[(unsigned)indRequest];
+      req.clear();
+      const char *param = frame + headerSize;
+      for (uint32_t i = 0; i < nbParams; i++) {
+        size_t paramSize = readWord(frame + (3 + i) * sizeof(uint32_t));
+        std::string emptyParam;
+        req.addParameter(emptyParam);
+        req[i].assign(param, paramSize);
+        param += paramSize;
+      }
+    } else if (verboseMode) {
+      vpTRACE("No request corresponds to the received message");
+    }
+
+    begin += frameSize;
+    if (begin == end)
+      begin = end = 0;
+
+    if (indRequest != -1)
+      return indRequest;
+  }
+
+  return -1;
+}
+
+/*!
+  Receive the bytes available on a socket, in the limit of the maximum message
+  size value, and append them to the received message. With binary framing, the
+  end of a request whose header has been received is then read by
+  _receiveBinaryRequestEnd(), and a receptor sending an invalid frame is
+  disconnected.
+
+  \param receptorEmitting : Index of the receptor emitting the message.
+
+  \return The number of bytes received, 0 or -1 if the receptor has been
+  disconnected.
+*/
+int vpNetwork::_receiveMessage(const unsigned int &receptorEmitting)
+{
+  vpReceptor &receptor = receptor_list[receptorEmitting];
 #if !defined(_WIN32) && (defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))) // UNIX
-      numbytes = (int)recv(receptor_list[receptorEmitting].socketFileDescriptorReceptor, buf, max_size_message, 0);
+  if (framingType == BINARY_FRAMING && receptor.receivingBinaryRequest) {
+    // The bytes are the end of the parameters of a request
+    return _receiveBinaryRequestEnd(receptorEmitting);
+  }
+#endif
+
+  // The binary frames are kept in the buffer of their receptor until they are entirely received
+  std::vector<char> &buffer = (framingType == BINARY_FRAMING) ? receptor.receivedBuffer : receivedBuffer;
+  size_t offset = 0;
+  if (framingType == BINARY_FRAMING) {
+    if (receptor.receivedBegin != 0) {
+      memmove(&buffer[0], &buffer[receptor.receivedBegin], receptor.receivedEnd - receptor.receivedBegin);
+      receptor.receivedEnd -= receptor.receivedBegin;
+      receptor.receivedBegin = 0;
+    }
+    offset = receptor.receivedEnd;
+  }
+  if (buffer.size() < offset + max_size_message)
+    buffer.resize(offset + max_size_message);
+
+#if !defined(_WIN32) && (defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))) // UNIX
+  int numbytes = (int)recv(receptor.socketFileDescriptorReceptor, &buffer[offset], max_size_message, 0);
 #else
-      numbytes = recv((unsigned int)receptor_list[receptorEmitting].socketFileDescriptorReceptor, buf,
-                      (int)max_size_message, 0);
+  int numbytes = recv((unsigned int)receptor.socketFileDescriptorReceptor, &buffer[offset], (int)max_size_message, 0);
 #endif
-      if (numbytes <= 0) {
-        std::cout << "Disconnected : " << inet_ntoa(receptor_list[receptorEmitting].receptorAddress.sin_addr)
-                  << std::endl;
-        receptor_list.erase(receptor_list.begin() + (int)receptorEmitting);
-        delete[] buf;
-        return numbytes;
-      } else {
-        std::string returnVal(buf, (unsigned int)numbytes);
-        currentMessageReceived.append(returnVal);
+
+  if (numbytes <= 0) {
+    std::cout << "Disconnected : " << inet_ntoa(receptor.receptorAddress.sin_addr) << std::endl;
+    receptor_list.erase(receptor_list.begin() + (int)receptorEmitting);
+    return numbytes;
+  }
+
+  if (framingType == TEXT_FRAMING) {
+    currentMessageReceived.append(&buffer[0], (size_t)numbytes);
+    return numbytes;
+  }
+
+  receptor.receivedEnd += (size_t)numbytes;
+
+  bool valid;
+  uint32_t nbParams = 0;
+  size_t headerSize = 0, frameSize = 0;
+  parseFrameHeader(&buffer[receptor.receivedBegin], receptor.receivedEnd - receptor.receivedBegin, max_size_message,
+                   valid, nbParams, headerSize, frameSize);
+  if (!valid) {
+    // The frames can't be resynchronized, and the receptor may try to exhaust the memory
+    std::cout << "Invalid frame, disconnected : " << inet_ntoa(receptor.receptorAddress.sin_addr) << std::endl;
+#if !defined(_WIN32) && (defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))) // UNIX
+    close(receptor.socketFileDescriptorReceptor);
+#else
+    closesocket((unsigned)receptor.socketFileDescriptorReceptor);
+#endif
+    receptor_list.erase(receptor_list.begin() + (int)receptorEmitting);
+    return -1;
+  }
+
+#if !defined(_WIN32) && (defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))) // UNIX
+  if (!receptor.receivedBinaryRequest) {
+    int numbytesEnd = _receiveBinaryRequestEnd(receptorEmitting);
+    if (numbytesEnd < 0)
+      return numbytesEnd;
+    numbytes += numbytesEnd;
+  }
+#endif
+
+  return numbytes;
+}
+
+/*!
+  When the receive buffer of a receptor starts with the header of a frame
+  whose parameters are not entirely received, and the id of the frame is the
+  one of a decoding request, copy the received beginning of the parameters
+  into the receptor, and keep the position of the next parameter byte. The
+  end of the parameters is then read straight into the receptor by the next
+  calls, with scatter calls that only read the bytes already available, so
+  that the timeout of the receive functions is kept. The parameters are
+  moved to the decoding request when the request is handled, so that the
+  frames received at the same time from several receptors don't overwrite
+  each other.
+
+  \param receptorEmitting : Index of the receptor emitting the message.
+
+  \return The number of parameter bytes read from the socket, or -1 if the
+  receptor has been disconnected.
+*/
+int vpNetwork::_receiveBinaryRequestEnd(const unsigned int &receptorEmitting)
+{
+#if !defined(_WIN32) && (defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))) // UNIX
+  vpReceptor &receptor = receptor_list[receptorEmitting];
+  std::vector<std::string> &params = receptor.receivingParameters;
+  if (!receptor.receivingBinaryRequest) {
+    if (receptor.receivedBinaryRequest || receptor.receivedBegin == receptor.receivedEnd)
+      return 0;
+
+    const char *frame = &receptor.receivedBuffer[receptor.receivedBegin];
+    size_t available = receptor.receivedEnd - receptor.receivedBegin;
+    bool valid;
+    uint32_t nbParams = 0;
+    size_t headerSize = 0, frameSize = 0;
+    if (!parseFrameHeader(frame, available, max_size_message, valid, nbParams, headerSize, frameSize) ||
+        available >= frameSize)
+      return 0;
+
+    size_t paramsOffset = (3 + nbParams) * sizeof(uint32_t);
+    std::string id(frame + paramsOffset, headerSize - paramsOffset);
+    if (_findRequest(id) == -1)
+      return 0;
+
+    // Copy the received beginning of the parameters, whose sizes have been checked against max_size_message
+    const char *received = frame + headerSize;
+    size_t receivedSize = available - headerSize;
+    receptor.receivingId = id;
+    receptor.receivingParameter = nbParams;
+    receptor.receivingOffset = 0;
+    params.resize(nbParams);
+    for (uint32_t i = 0; i < nbParams; i++) {
+      size_t paramSize = readWord(frame + (3 + i) * sizeof(uint32_t));
+      params[i].resize(paramSize);
+      size_t copySize = std::min(paramSize, receivedSize);
+      if (copySize > 0) {
+        memcpy(&params[i][0], received, copySize);
+        received += copySize;
+        receivedSize -= copySize;
+      }
+      if (copySize < paramSize && receptor.receivingParameter == nbParams) {
+        receptor.receivingParameter = i;
+        receptor.receivingOffset = copySize;
       }
-      delete[] buf;
     }
+    receptor.receivedBegin = receptor.receivedEnd = 0;
+    receptor.receivingBinaryRequest = true;
   }
 
-  return numbytes;
+  // Read the bytes available, without waiting for the end of the frame
+  const int fd = receptor.socketFileDescriptorReceptor;
+  size_t numbytes = 0;
+  while (receptor.receivingParameter < params.size()) {
+    std::vector<struct iovec> iov;
+    for (size_t i = receptor.receivingParameter; i < params.size() && iov.size() < maxNbIoBuffers; i++) {
+      size_t begin = (i == receptor.receivingParameter) ? receptor.receivingOffset : 0;
+      if (begin < params[i].size()) {
+        struct iovec buffer;
+        buffer.iov_base = &params[i][begin];
+        buffer.iov_len = params[i].size() - begin;
+        iov.push_back(buffer);
+      }
+    }
+    if (iov.empty())
+      break;
+
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov[0];
+    msg.msg_iovlen = iov.size();
+    ssize_t value = recvmsg(fd, &msg, MSG_DONTWAIT);
+    if (value < 0 && errno == EINTR)
+      continue;
+    if (value < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+      break;
+    if (value <= 0) {
+      std::cout << "Disconnected : " << inet_ntoa(receptor.receptorAddress.sin_addr) << std::endl;
+      receptor_list.erase(receptor_list.begin() + (int)receptorEmitting);
+      return -1;
+    }
+    numbytes += (size_t)value;
+
+    size_t remaining = (size_t)value;
+    while (receptor.receivingParameter < params.size() &&
+           remaining >= params[receptor.receivingParameter].size() - receptor.receivingOffset) {
+      remaining -= params[receptor.receivingParameter].size() - receptor.receivingOffset;
+      receptor.receivingParameter++;
+      receptor.receivingOffset = 0;
+    }
+    receptor.receivingOffset += remaining;
+  }
+
+  if (receptor.receivingParameter >= params.size()) {
+    receptor.receivingBinaryRequest = false;
+    receptor.receivedBinaryRequest = true;
+  }
+  return (int)numbytes;
+#else
+  (void)receptorEmitting;
+  return 0;
+#endif
+}
+
+/*!
+  Send a request to a specific receptor as a binary frame. The header of the
+  frame, the id and the parameters of the request are sent with a single
+  gather call, without being copied into a message.
+
+  \sa vpNetwork::setFramingType()
+
+  \param req : Request to send.
+  \param dest : Index of the receptor receiving the request.
+
+  \return The number of bytes that have been sent, -1 if an error occured.
+*/
+int vpNetwork::_sendBinaryRequestTo(vpRequest &req, const unsigned int &dest)
+{
+  std::string id = req.getId();
+  unsigned int nbParams = req.size();
+  std::vector<uint32_t> header(3 + nbParams);
+  header[0] = htonl(binaryFrameMagic);
+  header[1] = htonl((uint32_t)id.size());
+  header[2] = htonl((uint32_t)nbParams);
+  for (unsigned int i = 0; i < nbParams; i++) {
+    header[3 + i] = htonl((uint32_t)req[i].size());
+  }
+
+  int flags = 0;
+#if defined(__linux__)
+  flags = MSG_NOSIGNAL; // Only for Linux
+#endif
+
+#if !defined(_WIN32) && (defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))) // UNIX
+  std::vector<struct iovec> iov;
+  iov.reserve(2 + nbParams);
+  struct iovec buffer;
+  buffer.iov_base = &header[0];
+  buffer.iov_len = header.size() * sizeof(uint32_t);
+  iov.push_back(buffer);
+  if (!id.empty()) {
+    buffer.iov_base = &id[0];
+    buffer.iov_len = id.size();
+    iov.push_back(buffer);
+  }
+  for (unsigned int i = 0; i < nbParams; i++) {
+    if (!req[i].empty()) {
+      buffer.iov_base = &req[i][0];
+      buffer.iov_len = req[i].size();
+      iov.push_back(buffer);
+    }
+  }
+
+  size_t numbytes = 0;
+  size_t first = 0;
+  while (first < iov.size()) {
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov[first];
+    msg.msg_iovlen = std::min(iov.size() - first, maxNbIoBuffers);
+    ssize_t value = sendmsg(receptor_list[dest].socketFileDescriptorReceptor, &msg, flags);
+    if (value < 0 && errno == EINTR)
+      continue;
+    if (value < 0)
+      return -1;
+    numbytes += (size_t)value;
+
+    size_t remaining = (size_t)value;
+    while (first < iov.size() && remaining >= iov[first].iov_len) {
+      remaining -= iov[first].iov_len;
+      first++;
+    }
+    if (first < iov.size()) {
+      iov[first].iov_base = static_cast<char *>(iov[first].iov_base) + remaining;
+      iov[first].iov_len -= remaining;
+    }
+  }
+
+  return (int)numbytes;
+#else
+  std::string message(reinterpret_cast<const char *>(&header[0]), header.size() * sizeof(uint32_t));
+  message += id;
+  for (unsigned int i = 0; i < nbParams; i++) {
+    message += req[i];
+  }
+
+  size_t numbytes = 0;
+  while (numbytes < message.size()) {
+    int value = send((unsigned)receptor_list[dest].socketFileDescriptorReceptor, message.c_str() + numbytes,
+                     (int)(message.size() - numbytes), flags);
+    if (value < 0)
+      return -1;
+    numbytes += (size_t)value;
+  }
+
+  return (int)numbytes;
+#endif
 }
 
 #elif !defined(VISP_BUILD_SHARED_LIBS)
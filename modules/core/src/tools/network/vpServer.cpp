@@ -45,10 +45,58 @@
 #include <TargetConditionals.h>             // To detect OSX or IOS using TARGET_OS_IPHONE or TARGET_OS_IOS macro
 #endif
 
+#if defined(__linux__)
+#include <algorithm>
+#include <errno.h>
+#include <fcntl.h>
+#include <map>
+#include <sys/epoll.h>
+#endif
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+class vpServer::vpImpl
+{
+public:
+#if defined(__linux__)
+  // Bytes received from a client, that don't form a complete request yet,
+  // and address of the client, to detect a socket reused by a new client
+  struct vpConnection {
+    std::string text;
+    std::vector<char> buffer;
+    size_t begin;
+    size_t end;
+    struct sockaddr_in address;
+
+    vpConnection() : text(), buffer(), begin(0), end(0), address() {}
+    explicit vpConnection(const struct sockaddr_in &addr) : text(), buffer(), begin(0), end(0), address(addr) {}
+
+    bool isFrom(const struct sockaddr_in &addr) const
+    {
+      return address.sin_addr.s_addr == addr.sin_addr.s_addr && address.sin_port == addr.sin_port;
+    }
+  };
+
+  vpImpl() : m_epoll(-1), m_events(64), m_connections() {}
+
+  ~vpImpl()
+  {
+    if (m_epoll != -1) {
+      close(m_epoll);
+    }
+  }
+
+  int m_epoll;
+  std::vector<struct epoll_event> m_events;
+  std::map<int, vpConnection> m_connections;
+#endif
+};
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
 /*!
   Construct a server on the machine launching it.
 */
-vpServer::vpServer() : adress(), port(0), started(false), max_clients(10)
+vpServer::vpServer()
+  : adress(), port(0), started(false), max_clients(10), m_impl(new vpImpl()), m_handler(NULL), m_handlerData(NULL)
 {
   int protocol = 0;
   emitter.socketFileDescriptorEmitter = socket(AF_INET, SOCK_STREAM, protocol);
@@ -73,7 +121,8 @@ vpServer::vpServer() : adress(), port(0), started(false), max_clients(10)
 
   \param port_serv : server's port.
 */
-vpServer::vpServer(const int &port_serv) : adress(), port(0), started(false), max_clients(10)
+vpServer::vpServer(const int &port_serv)
+  : adress(), port(0), started(false), max_clients(10), m_impl(new vpImpl()), m_handler(NULL), m_handlerData(NULL)
 {
   int protocol = 0;
   emitter.socketFileDescriptorEmitter = socket(AF_INET, SOCK_STREAM, protocol);
@@ -100,7 +149,7 @@ vpServer::vpServer(const int &port_serv) : adress(), port(0), started(false), ma
   \param port_serv : server's port.
 */
 vpServer::vpServer(const std::string &adress_serv, const int &port_serv)
-  : adress(), port(0), started(false), max_clients(10)
+  : adress(), port(0), started(false), max_clients(10), m_impl(new vpImpl()), m_handler(NULL), m_handlerData(NULL)
 {
   int protocol = 0;
   emitter.socketFileDescriptorEmitter = socket(AF_INET, SOCK_STREAM, protocol);
@@ -126,6 +175,8 @@ vpServer::vpServer(const std::string &adress_serv, const int &port_serv)
 */
 vpServer::~vpServer()
 {
+  delete m_impl;
+
 #if !defined(_WIN32) && (defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))) // UNIX
   close(emitter.socketFileDescriptorEmitter);
 #else // Win32
@@ -288,6 +339,246 @@ bool vpServer::checkForConnections()
 */
 void vpServer::print() { vpNetwork::print("Client"); }
 
+#if defined(__linux__)
+/*!
+  Wait for events on the connected clients and on the server socket, and
+  handle them:
+  - the new clients are accepted,
+  - the bytes sent by each client are appended to its own buffer, without
+    blocking,
+  - the complete requests are decoded, and passed to the handler set with
+    setRequestHandler(),
+  - the disconnected clients are removed.
+
+  The clients connected by checkForConnections() are also handled. The
+  server is started if needed.
+
+  \note Only available under Linux, since it relies on epoll().
+
+  \param timeout_ms : Maximum time to wait for an event in ms, 0 to return
+  immediately, -1 to wait forever.
+
+  \return The number of requests that have been decoded, or -1 if an error
+  occured.
+*/
+int vpServer::processEvents(int timeout_ms)
+{
+  if (!started)
+    if (!start()) {
+      return -1;
+    }
+
+  if (m_impl->m_epoll == -1) {
+    m_impl->m_epoll = epoll_create1(EPOLL_CLOEXEC);
+    if (m_impl->m_epoll == -1) {
+      vpERROR_TRACE("vpServer::processEvents(), epoll_create1()");
+      return -1;
+    }
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.fd = emitter.socketFileDescriptorEmitter;
+    epoll_ctl(m_impl->m_epoll, EPOLL_CTL_ADD, emitter.socketFileDescriptorEmitter, &event);
+  }
+  registerClients();
+
+  std::vector<struct epoll_event> &events = m_impl->m_events;
+  int nbEvents = epoll_wait(m_impl->m_epoll, &events[0], (int)events.size(), timeout_ms);
+  if (nbEvents == -1) {
+    return (errno == EINTR) ? 0 : -1;
+  }
+
+  int nbRequests = 0;
+  for (int i = 0; i < nbEvents; i++) {
+    if (events[(size_t)i].data.fd == emitter.socketFileDescriptorEmitter) {
+      acceptClients();
+    } else {
+      nbRequests += receiveClient(events[(size_t)i].data.fd);
+    }
+  }
+  if ((size_t)nbEvents == events.size()) {
+    events.resize(2 * events.size());
+  }
+
+  return nbRequests;
+}
+
+/*!
+  Accept the pending connections and register the new clients in the event
+  loop.
+
+  The server socket is only non-blocking while the pending connections are
+  accepted, so that checkForConnections() can still be used.
+*/
+void vpServer::acceptClients()
+{
+  int flags = fcntl(emitter.socketFileDescriptorEmitter, F_GETFL, 0);
+  fcntl(emitter.socketFileDescriptorEmitter, F_SETFL, flags | O_NONBLOCK);
+
+  for (;;) {
+    vpNetwork::vpReceptor client;
+    client.receptorAddressSize = sizeof(client.receptorAddress);
+    client.socketFileDescriptorReceptor =
+        accept4(emitter.socketFileDescriptorEmitter, (struct sockaddr *)&client.receptorAddress,
+                &client.receptorAddressSize, SOCK_CLOEXEC);
+    if (client.socketFileDescriptorReceptor == -1) {
+      if (errno == EINTR)
+        continue;
+      break;
+    }
+
+    client.receptorIP = inet_ntoa(client.receptorAddress.sin_addr);
+    printf("New client connected : %s\n", inet_ntoa(client.receptorAddress.sin_addr));
+    receptor_list.push_back(client);
+    registerClients();
+  }
+
+  fcntl(emitter.socketFileDescriptorEmitter, F_SETFL, flags);
+}
+
+/*!
+  Remove a client from the event loop and close its socket.
+
+  \param fd : Socket of the client.
+*/
+void vpServer::closeClient(int fd)
+{
+  epoll_ctl(m_impl->m_epoll, EPOLL_CTL_DEL, fd, NULL);
+  m_impl->m_connections.erase(fd);
+  for (unsigned int i = 0; i < receptor_list.size(); i++) {
+    if (receptor_list[i].socketFileDescriptorReceptor == fd) {
+      std::cout << "Disconnected : " << inet_ntoa(receptor_list[i].receptorAddress.sin_addr) << std::endl;
+      receptor_list.erase(receptor_list.begin() + (int)i);
+      break;
+    }
+  }
+  close(fd);
+}
+
+/*!
+  Read all the bytes available from a client, without blocking, and decode
+  the complete requests. The buffer of the client is swapped with the buffer
+  of vpNetwork while the requests are handled.
+
+  \param fd : Socket of the client.
+
+  \return The number of requests that have been decoded.
+*/
+int vpServer::receiveClient(int fd)
+{
+  std::map<int, vpImpl::vpConnection>::iterator it = m_impl->m_connections.find(fd);
+  if (it == m_impl->m_connections.end()) {
+    return 0;
+  }
+
+  // A socket that is no longer in the client list has no index to pass to the handler
+  unsigned int client = 0;
+  while (client < receptor_list.size() && receptor_list[client].socketFileDescriptorReceptor != fd)
+    client++;
+  if (client == receptor_list.size()) {
+    closeClient(fd);
+    return 0;
+  }
+
+  vpImpl::vpConnection &connection = it->second;
+  currentMessageReceived.swap(connection.text);
+  receivedBuffer.swap(connection.buffer);
+  std::swap(receivedBegin, connection.begin);
+  std::swap(receivedEnd, connection.end);
+
+  const size_t chunkSize = 65536;
+  bool disconnected = false;
+  for (;;) {
+    size_t offset = 0;
+    if (framingType == BINARY_FRAMING) {
+      if (receivedBegin != 0) {
+        memmove(&receivedBuffer[0], &receivedBuffer[receivedBegin], receivedEnd - receivedBegin);
+        receivedEnd -= receivedBegin;
+        receivedBegin = 0;
+      }
+      offset = receivedEnd;
+    }
+    if (receivedBuffer.size() < offset + chunkSize)
+      receivedBuffer.resize(offset + chunkSize);
+
+    ssize_t numbytes = recv(fd, &receivedBuffer[offset], chunkSize, MSG_DONTWAIT);
+    if (numbytes > 0) {
+      if (framingType == BINARY_FRAMING)
+        receivedEnd += (size_t)numbytes;
+      else
+        currentMessageReceived.append(&receivedBuffer[0], (size_t)numbytes);
+      if ((size_t)numbytes < chunkSize)
+        break;
+    } else if (numbytes == -1 && errno == EINTR) {
+      continue;
+    } else {
+      disconnected = (numbytes == 0 || (errno != EAGAIN && errno != EWOULDBLOCK));
+      break;
+    }
+  }
+
+  int nbRequests = 0;
+  receivedInvalidFrame = false;
+  int index = _handleFirstRequest();
+  while (index != -1) {
+    request_list[(unsigned)index]->decode();
+    if (m_handler != NULL)
+      m_handler(*request_list[(unsigned)index], client, m_handlerData);
+    nbRequests++;
+    index = _handleFirstRequest();
+  }
+  // The frames of a client sending an invalid or too large frame can't be resynchronized
+  disconnected = disconnected || receivedInvalidFrame;
+
+  currentMessageReceived.swap(connection.text);
+  receivedBuffer.swap(connection.buffer);
+  std::swap(receivedBegin, connection.begin);
+  std::swap(receivedEnd, connection.end);
+
+  if (disconnected)
+    closeClient(fd);
+
+  return nbRequests;
+}
+
+/*!
+  Register in the event loop the clients that are not registered yet, and
+  forget the clients removed by other functions. A socket whose client has
+  been removed and that is reused by a new client gets a new empty buffer.
+*/
+void vpServer::registerClients()
+{
+  std::map<int, vpImpl::vpConnection> &connections = m_impl->m_connections;
+
+  std::vector<int> fds(receptor_list.size());
+  for (unsigned int i = 0; i < receptor_list.size(); i++) {
+    int fd = receptor_list[i].socketFileDescriptorReceptor;
+    fds[i] = fd;
+    std::map<int, vpImpl::vpConnection>::iterator it = connections.find(fd);
+    if (it == connections.end() || !it->second.isFrom(receptor_list[i].receptorAddress)) {
+      struct epoll_event event;
+      memset(&event, 0, sizeof(event));
+      event.events = EPOLLIN | EPOLLRDHUP;
+      event.data.fd = fd;
+      if (epoll_ctl(m_impl->m_epoll, EPOLL_CTL_ADD, fd, &event) == -1 && errno == EEXIST)
+        epoll_ctl(m_impl->m_epoll, EPOLL_CTL_MOD, fd, &event);
+      connections[fd] = vpImpl::vpConnection(receptor_list[i].receptorAddress);
+    }
+  }
+
+  std::sort(fds.begin(), fds.end());
+  std::map<int, vpImpl::vpConnection>::iterator it = connections.begin();
+  while (it != connections.end()) {
+    if (!std::binary_search(fds.begin(), fds.end(), it->first)) {
+      epoll_ctl(m_impl->m_epoll, EPOLL_CTL_DEL, it->first, NULL);
+      connections.erase(it++);
+    } else {
+      ++it;
+    }
+  }
+}
+#endif
+
 #elif !defined(VISP_BUILD_SHARED_LIBS)
 // Work arround to avoid warning: libvisp_core.a(vpServer.cpp.o) has no symbols
 void dummy_vpServer(){};
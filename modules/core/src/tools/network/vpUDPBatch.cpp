@@ -0,0 +1,396 @@
+/****************************************************************************
+ *
+ * ViSP, open source Visual Servoing Platform software.
+ * Copyright (C) 2005 - 2019 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Batch of UDP datagrams
+ *
+ *****************************************************************************/
+
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+#include <visp3/core/vpConfig.h>
+
+// inet_ntop() not supported on win XP
+#ifdef VISP_HAVE_FUNC_INET_NTOP
+
+#if !defined(_WIN32) && (defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))) // UNIX
+#  include <arpa/inet.h>
+#  include <errno.h>
+#  include <netdb.h>
+#  include <sys/select.h>
+#  include <time.h>
+#  include <unistd.h>
+#  define DWORD int
+#else
+#  if defined(__MINGW32__)
+#    ifndef _WIN32_WINNT
+#      define _WIN32_WINNT _WIN32_WINNT_VISTA // 0x0600
+#    endif
+#  endif
+#  include <Ws2tcpip.h>
+#endif
+
+#include <visp3/core/vpTime.h>
+#include <visp3/core/vpUDPBatch.h>
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+class vpUDPBatch::vpImpl
+{
+public:
+  vpImpl() {}
+
+#if defined(__linux__)
+  std::vector<struct mmsghdr> m_headers;
+  std::vector<struct iovec> m_iovecs;
+  // Ancillary data of each datagram, 8 bytes aligned for the cmsghdr
+  std::vector<uint64_t> m_control;
+  size_t m_controlSize;
+#endif
+};
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+/*!
+  Allocate the buffers of a batch of datagrams.
+
+  \param capacity : Maximum number of datagrams received or sent with a
+  single call.
+  \param maxPayload : Maximum payload size in bytes of a datagram.
+*/
+vpUDPBatch::vpUDPBatch(unsigned int capacity, unsigned int maxPayload)
+  : m_impl(new vpImpl()), m_capacity(capacity), m_maxPayload(maxPayload), m_size(0),
+    m_data(static_cast<size_t>(capacity) * maxPayload), m_lengths(capacity, 0), m_addresses(capacity),
+    m_timestamps(capacity, 0.)
+{
+  if (capacity == 0 || maxPayload == 0) {
+    delete m_impl;
+    throw vpException(vpException::badValue, "The capacity and the payload of a UDP batch must be positive");
+  }
+  memset(&m_addresses[0], 0, capacity * sizeof(struct sockaddr_in));
+
+#if defined(__linux__)
+  // The headers point once and for all to the preallocated buffers
+  m_impl->m_controlSize = CMSG_SPACE(sizeof(struct timespec));
+  m_impl->m_headers.resize(capacity);
+  m_impl->m_iovecs.resize(capacity);
+  m_impl->m_control.resize((capacity * m_impl->m_controlSize + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+  memset(&m_impl->m_headers[0], 0, capacity * sizeof(struct mmsghdr));
+  for (unsigned int i = 0; i < capacity; i++) {
+    m_impl->m_iovecs[i].iov_base = &m_data[i * maxPayload];
+    m_impl->m_headers[i].msg_hdr.msg_iov = &m_impl->m_iovecs[i];
+    m_impl->m_headers[i].msg_hdr.msg_iovlen = 1;
+  }
+#endif
+}
+
+vpUDPBatch::~vpUDPBatch() { delete m_impl; }
+
+/*!
+  Return the IP address of the sender of the i-th received datagram, in
+  numeric form. Contrary to vpUDPServer::receive(), there is no name lookup.
+*/
+std::string vpUDPBatch::getHostIp(unsigned int i) const
+{
+  char result[INET_ADDRSTRLEN];
+  const char *ptr = inet_ntop(AF_INET, (void *)&m_addresses[i].sin_addr, result, sizeof(result));
+  return ptr == NULL ? std::string() : std::string(result);
+}
+
+/*!
+  Return the port of the sender of the i-th received datagram.
+*/
+int vpUDPBatch::getHostPort(unsigned int i) const { return ntohs(m_addresses[i].sin_port); }
+
+/*!
+  Add a datagram to send to the server with vpUDPClient::send().
+
+  \param data : Payload of the datagram, copied in the batch.
+  \param length : Payload size, that must not exceed getMaxPayload().
+*/
+void vpUDPBatch::push(const void *data, size_t length)
+{
+  struct sockaddr_in address;
+  memset(&address, 0, sizeof(address));
+  push(data, length, address);
+}
+
+/*!
+  Add a datagram to send with vpUDPServer::send().
+
+  \param data : Payload of the datagram, copied in the batch.
+  \param length : Payload size, that must not exceed getMaxPayload().
+  \param address : Destination of the datagram, for example the address of
+  the sender of a received datagram or an address given by resolve().
+*/
+void vpUDPBatch::push(const void *data, size_t length, const struct sockaddr_in &address)
+{
+  if (m_size == m_capacity) {
+    throw vpException(vpException::dimensionError, "The UDP batch is full");
+  }
+  if (length > m_maxPayload) {
+    throw vpException(vpException::dimensionError, "The datagram is too long for the UDP batch");
+  }
+  if (length > 0) {
+    memcpy(&m_data[m_size * m_maxPayload], data, length);
+  }
+  m_lengths[m_size] = length;
+  m_addresses[m_size] = address;
+  m_timestamps[m_size] = 0.;
+  m_size++;
+}
+
+/*!
+  Add a datagram to send with vpUDPServer::send(). The hostname is resolved
+  on each call: resolve() it once when many datagrams are sent to the same
+  host.
+
+  \param data : Payload of the datagram, copied in the batch.
+  \param length : Payload size, that must not exceed getMaxPayload().
+  \param hostname : Destination hostname or IP address.
+  \param port : Destination port number.
+*/
+void vpUDPBatch::push(const void *data, size_t length, const std::string &hostname, int port)
+{
+  push(data, length, resolve(hostname, port));
+}
+
+/*!
+  Return the (IPv4) address of a host.
+
+  \param hostname : Hostname or IP address.
+  \param port : Port number.
+*/
+struct sockaddr_in vpUDPBatch::resolve(const std::string &hostname, int port)
+{
+  struct sockaddr_in address;
+  memset(&address, 0, sizeof(address));
+  std::stringstream ss;
+  ss << port;
+  struct addrinfo hints;
+  struct addrinfo *result = NULL;
+  struct addrinfo *ptr = NULL;
+
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_INET;
+  hints.ai_socktype = SOCK_DGRAM;
+  hints.ai_protocol = IPPROTO_UDP;
+
+  DWORD dwRetval = getaddrinfo(hostname.c_str(), ss.str().c_str(), &hints, &result);
+  if (dwRetval != 0) {
+    ss.str("");
+    ss << "getaddrinfo failed with error: " << dwRetval;
+    throw vpException(vpException::fatalError, ss.str());
+  }
+
+  for (ptr = result; ptr != NULL; ptr = ptr->ai_next) {
+    if (ptr->ai_family == AF_INET && ptr->ai_socktype == SOCK_DGRAM) {
+      address = *(struct sockaddr_in *)ptr->ai_addr;
+      break;
+    }
+  }
+
+  freeaddrinfo(result);
+  return address;
+}
+
+/*!
+  Ask the kernel to timestamp the datagrams received by a socket.
+*/
+#if !defined(_WIN32) && (defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))) // UNIX
+void vpUDPBatch::enableTimestamps(int socketFileDescriptor)
+#else
+void vpUDPBatch::enableTimestamps(SOCKET socketFileDescriptor)
+#endif
+{
+#if defined(__linux__) && defined(SO_TIMESTAMPNS)
+  int optval = 1;
+  setsockopt(socketFileDescriptor, SOL_SOCKET, SO_TIMESTAMPNS, (const void *)&optval, sizeof(int));
+#else
+  (void)socketFileDescriptor;
+#endif
+}
+
+/*!
+  Wait for datagrams and receive as many of them as are available, up to the
+  capacity of the batch.
+
+  \return The number of received datagrams, or -1 if there is an error, or 0
+  if there is a timeout.
+*/
+#if !defined(_WIN32) && (defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))) // UNIX
+int vpUDPBatch::receiveFrom(int socketFileDescriptor, int timeoutMs)
+#else
+int vpUDPBatch::receiveFrom(SOCKET socketFileDescriptor, int timeoutMs)
+#endif
+{
+  m_size = 0;
+
+  fd_set s;
+  FD_ZERO(&s);
+  FD_SET(socketFileDescriptor, &s);
+  struct timeval timeout;
+  if (timeoutMs > 0) {
+    timeout.tv_sec = timeoutMs / 1000;
+    timeout.tv_usec = (timeoutMs % 1000) * 1000;
+  }
+  int retval = select((int)socketFileDescriptor + 1, &s, NULL, NULL, timeoutMs > 0 ? &timeout : NULL);
+
+  if (retval == -1) {
+    std::cerr << "Error select!" << std::endl;
+    return -1;
+  }
+  if (retval == 0) {
+    // Timeout
+    return 0;
+  }
+
+#if defined(__linux__)
+  for (unsigned int i = 0; i < m_capacity; i++) {
+    struct msghdr &header = m_impl->m_headers[i].msg_hdr;
+    header.msg_name = &m_addresses[i];
+    header.msg_namelen = sizeof(struct sockaddr_in);
+    header.msg_control = reinterpret_cast<unsigned char *>(&m_impl->m_control[0]) + i * m_impl->m_controlSize;
+    header.msg_controllen = m_impl->m_controlSize;
+    header.msg_flags = 0;
+    m_impl->m_iovecs[i].iov_len = m_maxPayload;
+  }
+
+  // The socket is readable: take all the pending datagrams without blocking
+  int nb = recvmmsg(socketFileDescriptor, &m_impl->m_headers[0], m_capacity, MSG_DONTWAIT, NULL);
+  if (nb < 0) {
+    return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+  }
+
+  double now = vpTime::measureTimeMs();
+  for (int i = 0; i < nb; i++) {
+    struct msghdr &header = m_impl->m_headers[i].msg_hdr;
+    m_lengths[i] = m_impl->m_headers[i].msg_len;
+    m_timestamps[i] = now;
+    for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&header); cmsg != NULL; cmsg = CMSG_NXTHDR(&header, cmsg)) {
+      if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMPNS) {
+        struct timespec ts;
+        memcpy(&ts, CMSG_DATA(cmsg), sizeof(ts));
+        m_timestamps[i] = 1000.0 * ts.tv_sec + ts.tv_nsec / 1000000.0;
+      }
+    }
+  }
+  m_size = static_cast<unsigned int>(nb);
+#else
+  while (m_size < m_capacity) {
+    if (m_size > 0) {
+      // Only read the datagrams that are already there
+      FD_ZERO(&s);
+      FD_SET(socketFileDescriptor, &s);
+      struct timeval noWait;
+      noWait.tv_sec = 0;
+      noWait.tv_usec = 0;
+      if (select((int)socketFileDescriptor + 1, &s, NULL, NULL, &noWait) <= 0) {
+        break;
+      }
+    }
+
+#if !defined(_WIN32) && (defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))) // UNIX
+    socklen_t addressLength = sizeof(struct sockaddr_in);
+    int length = static_cast<int>(recvfrom(socketFileDescriptor, &m_data[m_size * m_maxPayload], m_maxPayload, 0,
+                                           (struct sockaddr *)&m_addresses[m_size], &addressLength));
+#else
+    int addressLength = sizeof(struct sockaddr_in);
+    int length = recvfrom(socketFileDescriptor, (char *)&m_data[m_size * m_maxPayload], (int)m_maxPayload, 0,
+                          (struct sockaddr *)&m_addresses[m_size], &addressLength);
+#endif
+    if (length < 0) {
+      return m_size > 0 ? static_cast<int>(m_size) : -1;
+    }
+    m_lengths[m_size] = static_cast<size_t>(length);
+    m_timestamps[m_size] = vpTime::measureTimeMs();
+    m_size++;
+  }
+#endif
+
+  return static_cast<int>(m_size);
+}
+
+/*!
+  Send the datagrams of the batch.
+
+  \param address : Destination of all the datagrams, or NULL to send each
+  datagram to its own address.
+
+  \return The number of sent datagrams, or -1 if there is an error.
+*/
+#if !defined(_WIN32) && (defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))) // UNIX
+int vpUDPBatch::sendTo(int socketFileDescriptor, const struct sockaddr_in *address) const
+#else
+int vpUDPBatch::sendTo(SOCKET socketFileDescriptor, const struct sockaddr_in *address) const
+#endif
+{
+#if defined(__linux__)
+  for (unsigned int i = 0; i < m_size; i++) {
+    struct msghdr &header = m_impl->m_headers[i].msg_hdr;
+    header.msg_name = const_cast<struct sockaddr_in *>(address != NULL ? address : &m_addresses[i]);
+    header.msg_namelen = sizeof(struct sockaddr_in);
+    header.msg_control = NULL;
+    header.msg_controllen = 0;
+    header.msg_flags = 0;
+    m_impl->m_iovecs[i].iov_len = m_lengths[i];
+  }
+
+  unsigned int nbSent = 0;
+  while (nbSent < m_size) {
+    int nb = sendmmsg(socketFileDescriptor, &m_impl->m_headers[nbSent], m_size - nbSent, 0);
+    if (nb <= 0) {
+      return nbSent > 0 ? static_cast<int>(nbSent) : -1;
+    }
+    nbSent += static_cast<unsigned int>(nb);
+  }
+  return static_cast<int>(nbSent);
+#else
+  for (unsigned int i = 0; i < m_size; i++) {
+    const struct sockaddr_in *destination = address != NULL ? address : &m_addresses[i];
+#if !defined(_WIN32) && (defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))) // UNIX
+    ssize_t length = sendto(socketFileDescriptor, &m_data[i * m_maxPayload], m_lengths[i], 0,
+                            (const struct sockaddr *)destination, sizeof(struct sockaddr_in));
+#else
+    int length = sendto(socketFileDescriptor, (const char *)&m_data[i * m_maxPayload], (int)m_lengths[i], 0,
+                        (const struct sockaddr *)destination, sizeof(struct sockaddr_in));
+#endif
+    if (length < 0) {
+      return i > 0 ? static_cast<int>(i) : -1;
+    }
+  }
+  return static_cast<int>(m_size);
+#endif
+}
+
+#elif !defined(VISP_BUILD_SHARED_LIBS)
+// Work arround to avoid warning: libvisp_core.a(vpUDPBatch.cpp.o) has no symbols
+void dummy_vpUDPBatch(){};
+#endif
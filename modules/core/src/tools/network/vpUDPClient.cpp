@@ -64,7 +64,7 @@
   Use connect() to establish the connexion with the server.
 */
 vpUDPClient::vpUDPClient()
-  : m_is_init(false), m_serverAddress(), m_serverLength(0), m_socketFileDescriptor()
+  : m_is_init(false), m_datagram(1), m_serverAddress(), m_serverLength(0), m_socketFileDescriptor()
 #if defined(_WIN32)
     , m_wsa()
 #endif
@@ -78,7 +78,7 @@ vpUDPClient::vpUDPClient()
   \param port : Server port number.
 */
 vpUDPClient::vpUDPClient(const std::string &hostname, int port)
-  : m_is_init(false), m_serverAddress(), m_serverLength(0), m_socketFileDescriptor()
+  : m_is_init(false), m_datagram(1), m_serverAddress(), m_serverLength(0), m_socketFileDescriptor()
 #if defined(_WIN32)
     , m_wsa()
 #endif
@@ -165,6 +165,7 @@ void vpUDPClient::init(const std::string &hostname, int port)
   freeaddrinfo(result);
 
   m_serverLength = sizeof(m_serverAddress);
+  vpUDPBatch::enableTimestamps(m_socketFileDescriptor);
   m_is_init = true;
 }
 
@@ -195,35 +196,20 @@ int vpUDPClient::receive(std::string &msg, int timeoutMs)
   if (!m_is_init) {
     throw(vpException(vpException::notInitialized, "UDP client is not initialized"));
   }
-  fd_set s;
-  FD_ZERO(&s);
-  FD_SET(m_socketFileDescriptor, &s);
-  struct timeval timeout;
-  if (timeoutMs > 0) {
-    timeout.tv_sec = timeoutMs / 1000;
-    timeout.tv_usec = (timeoutMs % 1000) * 1000;
-  }
-  int retval = select((int)m_socketFileDescriptor + 1, &s, NULL, NULL, timeoutMs > 0 ? &timeout : NULL);
-
-  if (retval == -1) {
-    std::cerr << "Error select!" << std::endl;
-    return -1;
-  }
+  int retval = m_datagram.receiveFrom(m_socketFileDescriptor, timeoutMs);
 
   if (retval > 0) {
-    /* recvfrom: receive a UDP datagram from the server */
-    int length = static_cast<int>(recvfrom(m_socketFileDescriptor, m_buf, sizeof(m_buf), 0, (struct sockaddr *)&m_serverAddress,
-                                           (socklen_t *)&m_serverLength));
-    if (length <= 0) {
-      return length < 0 ? -1 : 0;
+    int length = static_cast<int>(m_datagram.getLength(0));
+    if (length == 0) {
+      return 0;
     }
 
-    msg = std::string(m_buf, length);
+    msg = std::string(reinterpret_cast<const char *>(m_datagram.getData(0)), m_datagram.getLength(0));
     return length;
   }
 
-  // Timeout
-  return 0;
+  // Error or timeout
+  return retval;
 }
 
 /*!
@@ -271,6 +257,25 @@ int vpUDPClient::receive(void *msg, size_t len, int timeoutMs)
   return 0;
 }
 
+/*!
+  Receive the datagrams sent by the server. After waiting for the first
+  datagram, all the datagrams already queued in the socket are received at
+  once, up to the capacity of the batch, with recvmmsg() under Linux.
+
+  \param datagrams : Batch whose preallocated buffers receive the datagrams,
+  with their timestamp.
+  \param timeoutMs : Timeout in millisecond (if zero, the call is blocking).
+
+  \return The number of received datagrams, or -1 if there is an error, or 0
+  if there is a timeout.
+*/
+int vpUDPClient::receive(vpUDPBatch &datagrams, int timeoutMs)
+{
+  if (!m_is_init) {
+    throw(vpException(vpException::notInitialized, "UDP client is not initialized"));
+  }
+  return datagrams.receiveFrom(m_socketFileDescriptor, timeoutMs);
+}
 
 /*!
   Send data to the server.
@@ -307,14 +312,11 @@ int vpUDPClient::send(const std::string &msg)
     return 0;
   }
 
-/* send the message to the server */
-#if !defined(_WIN32) && (defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))) // UNIX
-  return static_cast<int>(sendto(m_socketFileDescriptor, msg.c_str(), msg.size(), 0, (struct sockaddr *)&m_serverAddress,
-                                 m_serverLength));
-#else
-  return sendto(m_socketFileDescriptor, msg.c_str(), (int)msg.size(), 0, (struct sockaddr *)&m_serverAddress,
-                m_serverLength);
-#endif
+  m_datagram.clear();
+  m_datagram.push(msg.c_str(), msg.size());
+
+  /* send the message to the server */
+  return m_datagram.sendTo(m_socketFileDescriptor, &m_serverAddress) == 1 ? static_cast<int>(msg.size()) : -1;
 }
 
 /*!
@@ -346,6 +348,21 @@ int vpUDPClient::send(const void *msg, size_t len)
 #endif
 }
 
+/*!
+  Send a batch of datagrams to the server, with sendmmsg() under Linux.
+
+  \param datagrams : Datagrams to send, added with vpUDPBatch::push().
+
+  \return The number of sent datagrams, or -1 if there is an error.
+*/
+int vpUDPClient::send(const vpUDPBatch &datagrams)
+{
+  if (!m_is_init) {
+    throw(vpException(vpException::notInitialized, "UDP client is not initialized"));
+  }
+  return datagrams.sendTo(m_socketFileDescriptor, &m_serverAddress);
+}
+
 #elif !defined(VISP_BUILD_SHARED_LIBS)
 // Work arround to avoid warning: libvisp_core.a(vpUDPClient.cpp.o) has no symbols
 void dummy_vpUDPClient(){};
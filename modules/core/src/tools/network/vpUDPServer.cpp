@@ -72,7 +72,7 @@
   \note The server will listen to all the interfaces (see INADDR_ANY).
 */
 vpUDPServer::vpUDPServer(int port)
-  : m_clientAddress(), m_clientLength(0), m_serverAddress(), m_socketFileDescriptor(0)
+  : m_datagram(1), m_clientAddress(), m_clientLength(0), m_serverAddress(), m_socketFileDescriptor(0)
 #if defined(_WIN32)
     ,
     m_wsa()
@@ -88,7 +88,7 @@ vpUDPServer::vpUDPServer(int port)
   \param port : Server port number.
 */
 vpUDPServer::vpUDPServer(const std::string &hostname, int port)
-  : m_clientAddress(), m_clientLength(0), m_serverAddress(), m_socketFileDescriptor(0)
+  : m_datagram(1), m_clientAddress(), m_clientLength(0), m_serverAddress(), m_socketFileDescriptor(0)
 #if defined(_WIN32)
     ,
     m_wsa()
@@ -179,6 +179,7 @@ void vpUDPServer::init(const std::string &hostname, int port)
     throw vpException(vpException::fatalError, "Error on binding on the server!");
 
   m_clientLength = sizeof(m_clientAddress);
+  vpUDPBatch::enableTimestamps(m_socketFileDescriptor);
 }
 
 /*!
@@ -212,35 +213,16 @@ int vpUDPServer::receive(std::string &msg, int timeoutMs)
 */
 int vpUDPServer::receive(std::string &msg, std::string &hostInfo, int timeoutMs)
 {
-  fd_set s;
-  FD_ZERO(&s);
-  FD_SET(m_socketFileDescriptor, &s);
-  struct timeval timeout;
-  if (timeoutMs > 0) {
-    timeout.tv_sec = timeoutMs / 1000;
-    timeout.tv_usec = (timeoutMs % 1000) * 1000;
-  }
-  int retval = select((int)m_socketFileDescriptor + 1, &s, NULL, NULL, timeoutMs > 0 ? &timeout : NULL);
-
-  if (retval == -1) {
-    std::cerr << "Error select!" << std::endl;
-    return -1;
-  }
+  int retval = m_datagram.receiveFrom(m_socketFileDescriptor, timeoutMs);
 
   if (retval > 0) {
-/* recvfrom: receive a UDP datagram from a client */
-#if !defined(_WIN32) && (defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))) // UNIX
-    int length = static_cast<int>(recvfrom(m_socketFileDescriptor, m_buf, sizeof(m_buf), 0, (struct sockaddr *)&m_clientAddress,
-                                           (socklen_t *)&m_clientLength));
-#else
-    int length =
-        recvfrom(m_socketFileDescriptor, m_buf, sizeof(m_buf), 0, (struct sockaddr *)&m_clientAddress, &m_clientLength);
-#endif
-    if (length <= 0) {
-      return length < 0 ? -1 : 0;
+    int length = static_cast<int>(m_datagram.getLength(0));
+    if (length == 0) {
+      return 0;
     }
 
-    msg = std::string(m_buf, length);
+    msg = std::string(reinterpret_cast<const char *>(m_datagram.getData(0)), m_datagram.getLength(0));
+    m_clientAddress = m_datagram.getAddress(0);
 
     /* getnameinfo: determine who sent the datagram */
     char hostname[NI_MAXHOST];
@@ -271,8 +253,25 @@ int vpUDPServer::receive(std::string &msg, std::string &hostInfo, int timeoutMs)
     return length;
   }
 
-  // Timeout
-  return 0;
+  // Error or timeout
+  return retval;
+}
+
+/*!
+  Receive the datagrams sent by the clients. After waiting for the first
+  datagram, all the datagrams already queued in the socket are received at
+  once, up to the capacity of the batch, with recvmmsg() under Linux.
+
+  \param datagrams : Batch whose preallocated buffers receive the datagrams,
+  with the address of their sender and their timestamp.
+  \param timeoutMs : Timeout in millisecond (if zero, the call is blocking).
+
+  \return The number of received datagrams, or -1 if there is an error, or 0
+  if there is a timeout.
+*/
+int vpUDPServer::receive(vpUDPBatch &datagrams, int timeoutMs)
+{
+  return datagrams.receiveFrom(m_socketFileDescriptor, timeoutMs);
 }
 
 /*!
@@ -292,44 +291,23 @@ int vpUDPServer::send(const std::string &msg, const std::string &hostname, int p
     return 0;
   }
 
-  // Create client address
-  memset(&m_clientAddress, 0, sizeof(m_clientAddress));
-  std::stringstream ss;
-  ss << port;
-  struct addrinfo hints;
-  struct addrinfo *result = NULL;
-  struct addrinfo *ptr = NULL;
-
-  memset(&hints, 0, sizeof(hints));
-  hints.ai_family = AF_INET;
-  hints.ai_socktype = SOCK_DGRAM;
-  hints.ai_protocol = IPPROTO_UDP;
-
-  DWORD dwRetval = getaddrinfo(hostname.c_str(), ss.str().c_str(), &hints, &result);
-  if (dwRetval != 0) {
-    ss.str("");
-    ss << "getaddrinfo failed with error: " << dwRetval;
-    throw vpException(vpException::fatalError, ss.str());
-  }
+  m_datagram.clear();
+  m_datagram.push(msg.c_str(), msg.size(), hostname, port);
+  m_clientAddress = m_datagram.getAddress(0);
 
-  for (ptr = result; ptr != NULL; ptr = ptr->ai_next) {
-    if (ptr->ai_family == AF_INET && ptr->ai_socktype == SOCK_DGRAM) {
-      m_clientAddress = *(struct sockaddr_in *)ptr->ai_addr;
-      break;
-    }
-  }
+  /* send the message to the client */
+  return m_datagram.sendTo(m_socketFileDescriptor, NULL) == 1 ? static_cast<int>(msg.size()) : -1;
+}
+
+/*!
+  Send a batch of datagrams, each one to its own address, with sendmmsg()
+  under Linux.
 
-  freeaddrinfo(result);
+  \param datagrams : Datagrams to send, added with vpUDPBatch::push().
 
-/* send the message to the client */
-#if !defined(_WIN32) && (defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))) // UNIX
-  return static_cast<int>(sendto(m_socketFileDescriptor, msg.c_str(), msg.size(), 0, (struct sockaddr *)&m_clientAddress,
-                                 m_clientLength));
-#else
-  return sendto(m_socketFileDescriptor, msg.c_str(), (int)msg.size(), 0, (struct sockaddr *)&m_clientAddress,
-                m_clientLength);
-#endif
-}
+  \return The number of sent datagrams, or -1 if there is an error.
+*/
+int vpUDPServer::send(const vpUDPBatch &datagrams) { return datagrams.sendTo(m_socketFileDescriptor, NULL); }
 
 #elif !defined(VISP_BUILD_SHARED_LIBS)
 // Work arround to avoid warning: libvisp_core.a(vpUDPServer.cpp.o) has no symbols
@@ -0,0 +1,480 @@
+/****************************************************************************
+ *
+ * ViSP, open source Visual Servoing Platform software.
+ * Copyright (C) 2005 - 2019 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Ring buffer of images in shared memory.
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpSharedImageRing.cpp
+  \brief Ring buffer of images in POSIX shared memory.
+*/
+
+#include <visp3/core/vpSharedImageRing.h>
+
+#if !defined(_WIN32) && (defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))) &&         \
+    (VISP_CXX_STANDARD >= VISP_CXX_STANDARD_11)
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <new>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+#include <visp3/core/vpTime.h>
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+namespace
+{
+const char ringMagic[8] = {'V', 'P', 'S', 'H', 'R', 'I', 'N', 'G'};
+const uint32_t ringVersion = 1;
+const size_t cacheLineSize = 64;
+// The header of the ring and the write counter are on their own cache lines
+const size_t ringHeaderSize = 2 * cacheLineSize;
+
+struct vpRingHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t nbSlots;
+  uint32_t pixelSize;
+  uint32_t maxHeight;
+  uint32_t maxWidth;
+  uint32_t maxMetadataSize;
+  uint64_t slotSize;
+  // Offset of the pixels from the beginning of a slot
+  uint64_t pixelsOffset;
+};
+
+struct vpRingSlot {
+  // 2 n + 1 while frame n is written in the slot, 2 n + 2 once it is written
+  std::atomic<uint64_t> sequence;
+  double timestamp;
+  uint32_t height;
+  uint32_t width;
+  uint32_t metadataSize;
+};
+
+// Metadata start after the slot header, pixels after the metadata
+const size_t slotHeaderSize = cacheLineSize;
+
+size_t alignSize(size_t size) { return (size + cacheLineSize - 1) / cacheLineSize * cacheLineSize; }
+
+std::string shmName(const std::string &name) { return (!name.empty() && name[0] == '/') ? name : "/" + name; }
+
+inline const vpRingHeader *header(const unsigned char *data) { return reinterpret_cast<const vpRingHeader *>(data); }
+
+inline std::atomic<uint64_t> *nbWritten(unsigned char *data)
+{
+  return reinterpret_cast<std::atomic<uint64_t> *>(data + cacheLineSize);
+}
+
+inline vpRingSlot *slot(unsigned char *data, uint64_t index)
+{
+  const vpRingHeader *h = header(data);
+  return reinterpret_cast<vpRingSlot *>(data + ringHeaderSize + (index % h->nbSlots) * h->slotSize);
+}
+} // namespace
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+/*!
+  Default constructor. Use create() or open() to attach to a ring.
+*/
+vpSharedImageRing::vpSharedImageRing()
+  : m_name(), m_fd(-1), m_data(NULL), m_size(0), m_producer(false), m_writing(false), m_nextIndex(0),
+    m_frameIndex(0), m_nbDroppedFrames(0), m_slot(NULL), m_sequence(0), m_timestamp(0), m_metadata()
+{
+}
+
+/*!
+  Destructor, that closes the ring.
+*/
+vpSharedImageRing::~vpSharedImageRing() { close(); }
+
+/*!
+  Detach from the ring. When called by the producer, the name of the ring is
+  removed from the system, unless the ring has been reclaimed by another
+  producer; the shared memory is released once all the consumers have closed
+  it.
+*/
+void vpSharedImageRing::close()
+{
+  if (m_data != NULL) {
+    munmap(m_data, m_size);
+    m_data = NULL;
+  }
+  if (m_producer) {
+    // The name is kept when the ring has been reclaimed by another producer
+    int fd = shm_open(m_name.c_str(), O_RDONLY, 0);
+    if (fd != -1) {
+      struct stat st_ring, st_name;
+      if (fstat(m_fd, &st_ring) == 0 && fstat(fd, &st_name) == 0 && st_ring.st_dev == st_name.st_dev &&
+          st_ring.st_ino == st_name.st_ino) {
+        shm_unlink(m_name.c_str());
+      }
+      ::close(fd);
+    }
+  }
+  if (m_fd != -1) {
+    ::close(m_fd);
+    m_fd = -1;
+  }
+  m_name.clear();
+  m_size = 0;
+  m_producer = false;
+  m_writing = false;
+  m_nextIndex = 0;
+  m_frameIndex = 0;
+  m_nbDroppedFrames = 0;
+  m_slot = NULL;
+  m_sequence = 0;
+}
+
+void vpSharedImageRing::createRing(const std::string &name, unsigned int nbSlots, unsigned int maxHeight,
+                                   unsigned int maxWidth, size_t pixelSize, unsigned int maxMetadataSize, bool reclaim,
+                                   unsigned int mode)
+{
+  close();
+
+  if (nbSlots < 2) {
+    throw(vpException(vpException::badValue, "A shared image ring needs at least 2 slots"));
+  }
+
+  const size_t pixelsOffset = slotHeaderSize + alignSize(maxMetadataSize);
+  const size_t slotSize = pixelsOffset + alignSize(static_cast<size_t>(maxHeight) * maxWidth * pixelSize);
+  const size_t size = ringHeaderSize + nbSlots * slotSize;
+
+  const std::string shm_name = shmName(name);
+  int fd = shm_open(shm_name.c_str(), O_CREAT | O_EXCL | O_RDWR, static_cast<mode_t>(mode));
+  if (fd == -1 && errno == EEXIST && reclaim) {
+    // Replace a ring left by a previous producer
+    shm_unlink(shm_name.c_str());
+    fd = shm_open(shm_name.c_str(), O_CREAT | O_EXCL | O_RDWR, static_cast<mode_t>(mode));
+  }
+  if (fd == -1) {
+    if (errno == EEXIST) {
+      throw(vpException(vpException::ioError,
+                        "Shared memory %s already exists: it may be used by another producer, or be left by a "
+                        "producer that crashed and can be reclaimed",
+                        shm_name.c_str()));
+    }
+    throw(vpException(vpException::ioError, "Cannot create shared memory %s: %s", shm_name.c_str(), strerror(errno)));
+  }
+  if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+    ::close(fd);
+    shm_unlink(shm_name.c_str());
+    throw(vpException(vpException::ioError, "Cannot allocate %lu bytes of shared memory %s",
+                      static_cast<unsigned long>(size), shm_name.c_str()));
+  }
+  void *data = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (data == MAP_FAILED) {
+    ::close(fd);
+    shm_unlink(shm_name.c_str());
+    throw(vpException(vpException::ioError, "Cannot map shared memory %s", shm_name.c_str()));
+  }
+
+  m_name = shm_name;
+  m_fd = fd;
+  m_data = static_cast<unsigned char *>(data);
+  m_size = size;
+  m_producer = true;
+
+  // The memory is zero filled by ftruncate()
+  vpRingHeader *h = reinterpret_cast<vpRingHeader *>(m_data);
+  h->version = ringVersion;
+  h->nbSlots = nbSlots;
+  h->pixelSize = static_cast<uint32_t>(pixelSize);
+  h->maxHeight = maxHeight;
+  h->maxWidth = maxWidth;
+  h->maxMetadataSize = maxMetadataSize;
+  h->slotSize = slotSize;
+  h->pixelsOffset = pixelsOffset;
+  std::atomic<uint64_t> *counter = new (m_data + cacheLineSize) std::atomic<uint64_t>(0);
+  for (unsigned int i = 0; i < nbSlots; i++) {
+    new (m_data + ringHeaderSize + i * slotSize) std::atomic<uint64_t>(0);
+  }
+  if (!counter->is_lock_free()) {
+    close();
+    throw(vpException(vpException::fatalError, "64 bits atomic counters are not lock-free on this system"));
+  }
+
+  // Consumers check the magic number last
+  std::atomic_thread_fence(std::memory_order_release);
+  memcpy(h->magic, ringMagic, sizeof(ringMagic));
+}
+
+/*!
+  Attach to a ring created by a producer, as a consumer. The frames written
+  from now on can be acquired.
+
+  \param name : Name of the shared memory object given to create().
+
+  \exception vpException::ioError : If the ring doesn't exist or isn't a
+  valid ring.
+*/
+void vpSharedImageRing::open(const std::string &name)
+{
+  close();
+
+  const std::string shm_name = shmName(name);
+  int fd = shm_open(shm_name.c_str(), O_RDONLY, 0);
+  if (fd == -1) {
+    throw(vpException(vpException::ioError, "Cannot open shared memory %s", shm_name.c_str()));
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < ringHeaderSize) {
+    ::close(fd);
+    throw(vpException(vpException::ioError, "Shared memory %s is not an image ring", shm_name.c_str()));
+  }
+  size_t size = static_cast<size_t>(st.st_size);
+  void *data = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+  if (data == MAP_FAILED) {
+    ::close(fd);
+    throw(vpException(vpException::ioError, "Cannot map shared memory %s", shm_name.c_str()));
+  }
+
+  m_name = shm_name;
+  m_fd = fd;
+  m_data = static_cast<unsigned char *>(data);
+  m_size = size;
+
+  const vpRingHeader *h = header(m_data);
+  bool valid = memcmp(h->magic, ringMagic, sizeof(ringMagic)) == 0;
+  std::atomic_thread_fence(std::memory_order_acquire);
+  if (!valid || h->version != ringVersion || h->nbSlots < 2 || ringHeaderSize + h->nbSlots * h->slotSize > size) {
+    close();
+    throw(vpException(vpException::ioError, "Shared memory %s is not an image ring", shm_name.c_str()));
+  }
+
+  m_nextIndex = nbWritten(m_data)->load(std::memory_order_acquire);
+}
+
+/*!
+  Return the maximum height of the images, or 0 if the ring isn't opened.
+*/
+unsigned int vpSharedImageRing::getMaxHeight() const { return m_data != NULL ? header(m_data)->maxHeight : 0; }
+
+/*!
+  Return the maximum size in bytes of the metadata of a frame, or 0 if the
+  ring isn't opened.
+*/
+unsigned int vpSharedImageRing::getMaxMetadataSize() const
+{
+  return m_data != NULL ? header(m_data)->maxMetadataSize : 0;
+}
+
+/*!
+  Return the maximum width of the images, or 0 if the ring isn't opened.
+*/
+unsigned int vpSharedImageRing::getMaxWidth() const { return m_data != NULL ? header(m_data)->maxWidth : 0; }
+
+/*!
+  Return the number of slots of the ring, or 0 if the ring isn't opened.
+*/
+unsigned int vpSharedImageRing::getNbSlots() const { return m_data != NULL ? header(m_data)->nbSlots : 0; }
+
+/*!
+  Return the number of frames written by the producer since the ring has been
+  created, or 0 if the ring isn't opened.
+*/
+uint64_t vpSharedImageRing::getNbWrittenFrames() const
+{
+  return m_data != NULL ? nbWritten(m_data)->load(std::memory_order_acquire) : 0;
+}
+
+/*!
+  Return true if the slot of the last acquired frame has not been overwritten
+  by the producer since the frame was acquired, in which case the image
+  initialized by acquire() holds the acquired frame.
+*/
+bool vpSharedImageRing::isValid() const
+{
+  if (m_slot == NULL) {
+    return false;
+  }
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return reinterpret_cast<vpRingSlot *>(m_slot)->sequence.load(std::memory_order_relaxed) == m_sequence;
+}
+
+/*!
+  Wait for a frame that has not been acquired yet. The ring is polled
+  continuously during the first milliseconds, so that a frame is detected
+  within a few microseconds of its writing, then every 50 us.
+
+  \param timeout_ms : Maximum waiting time in ms, negative to wait forever.
+
+  \return true if a new frame can be acquired, false on timeout.
+*/
+bool vpSharedImageRing::waitForFrame(double timeout_ms)
+{
+  if (m_data == NULL) {
+    throw(vpException(vpException::notInitialized, "The shared image ring is not opened"));
+  }
+
+  const std::atomic<uint64_t> *counter = nbWritten(m_data);
+  const double t_start = vpTime::measureTimeMs();
+  while (counter->load(std::memory_order_acquire) <= m_nextIndex) {
+    double elapsed = vpTime::measureTimeMs() - t_start;
+    if (timeout_ms >= 0 && elapsed > timeout_ms) {
+      return false;
+    }
+    if (elapsed < 2.) {
+      std::this_thread::yield();
+    } else {
+      std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+  }
+
+  return true;
+}
+
+unsigned char *vpSharedImageRing::acquireSlot(size_t pixelSize, bool latest, unsigned int &height,
+                                              unsigned int &width)
+{
+  if (m_data == NULL) {
+    throw(vpException(vpException::notInitialized, "The shared image ring is not opened"));
+  }
+  const vpRingHeader *h = header(m_data);
+  if (pixelSize != h->pixelSize) {
+    throw(vpException(vpException::badValue, "The shared image ring holds pixels of %u bytes, not %u", h->pixelSize,
+                      static_cast<unsigned int>(pixelSize)));
+  }
+
+  const std::atomic<uint64_t> *counter = nbWritten(m_data);
+  for (;;) {
+    uint64_t nb_written = counter->load(std::memory_order_acquire);
+    if (m_nextIndex >= nb_written) {
+      return NULL;
+    }
+
+    // The oldest slot may be overwritten at any time
+    uint64_t index = latest ? nb_written - 1 : m_nextIndex;
+    if (nb_written - index > h->nbSlots) {
+      index = nb_written - h->nbSlots;
+    }
+    m_nbDroppedFrames += index - m_nextIndex;
+    m_nextIndex = index + 1;
+
+    vpRingSlot *s = slot(m_data, index);
+    uint64_t sequence = s->sequence.load(std::memory_order_acquire);
+    if (sequence != 2 * index + 2) {
+      m_nbDroppedFrames++;
+      continue;
+    }
+    height = s->height;
+    width = s->width;
+    double timestamp = s->timestamp;
+    size_t metadataSize = std::min<size_t>(s->metadataSize, h->maxMetadataSize);
+    m_metadata.assign(reinterpret_cast<const char *>(s) + slotHeaderSize, metadataSize);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (s->sequence.load(std::memory_order_relaxed) != sequence) {
+      m_nbDroppedFrames++;
+      continue;
+    }
+
+    m_frameIndex = index;
+    m_timestamp = timestamp;
+    m_slot = reinterpret_cast<unsigned char *>(s);
+    m_sequence = sequence;
+    return m_slot + h->pixelsOffset;
+  }
+}
+
+unsigned char *vpSharedImageRing::beginWriteSlot(size_t pixelSize, unsigned int height, unsigned int width)
+{
+  if (m_data == NULL || !m_producer) {
+    throw(vpException(vpException::notInitialized, "The shared image ring is not created by this producer"));
+  }
+  if (m_writing) {
+    throw(vpException(vpException::badValue, "The previous frame written in the shared image ring is not ended"));
+  }
+  const vpRingHeader *h = header(m_data);
+  if (pixelSize != h->pixelSize) {
+    throw(vpException(vpException::badValue, "The shared image ring holds pixels of %u bytes, not %u", h->pixelSize,
+                      static_cast<unsigned int>(pixelSize)));
+  }
+  if (static_cast<uint64_t>(height) * width > static_cast<uint64_t>(h->maxHeight) * h->maxWidth) {
+    throw(vpException(vpException::dimensionError, "Image %ux%u is larger than the slots of the ring (%ux%u)", width,
+                      height, h->maxWidth, h->maxHeight));
+  }
+
+  // The producer is the only writer of the counter
+  uint64_t index = nbWritten(m_data)->load(std::memory_order_relaxed);
+  vpRingSlot *s = slot(m_data, index);
+  s->sequence.store(2 * index + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  s->height = height;
+  s->width = width;
+
+  m_writing = true;
+  m_slot = reinterpret_cast<unsigned char *>(s);
+  m_sequence = 2 * index + 2;
+  return m_slot + h->pixelsOffset;
+}
+
+/*!
+  Publish the frame started by beginWrite() to the consumers.
+
+  \param timestamp : Timestamp of the frame, for example in ms.
+  \param metadata : Metadata of the frame, of at most the size given to
+  create().
+*/
+void vpSharedImageRing::endWrite(double timestamp, const std::string &metadata)
+{
+  if (!m_writing) {
+    throw(vpException(vpException::badValue, "No frame is being written in the shared image ring"));
+  }
+  const vpRingHeader *h = header(m_data);
+  if (metadata.size() > h->maxMetadataSize) {
+    throw(vpException(vpException::dimensionError, "Metadata of %u bytes exceed the %u bytes of the ring slots",
+                      static_cast<unsigned int>(metadata.size()), h->maxMetadataSize));
+  }
+
+  vpRingSlot *s = reinterpret_cast<vpRingSlot *>(m_slot);
+  s->timestamp = timestamp;
+  s->metadataSize = static_cast<uint32_t>(metadata.size());
+  if (!metadata.empty()) {
+    memcpy(m_slot + slotHeaderSize, metadata.data(), metadata.size());
+  }
+  s->sequence.store(m_sequence, std::memory_order_release);
+  nbWritten(m_data)->store((m_sequence - 2) / 2 + 1, std::memory_order_release);
+  m_writing = false;
+}
+
+#elif !defined(VISP_BUILD_SHARED_LIBS)
+// Work arround to avoid warning: libvisp_core.a(vpSharedImageRing.cpp.o) has no symbols
+void dummy_vpSharedImageRing(){};
+#endif
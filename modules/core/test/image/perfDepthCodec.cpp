@@ -0,0 +1,162 @@
+/****************************************************************************
+ *
+ * ViSP, open source Visual Servoing Platform software.
+ * Copyright (C) 2005 - 2019 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Benchmark the lossless depth image codec.
+ *
+ *****************************************************************************/
+
+#include <visp3/core/vpConfig.h>
+
+/*!
+  \example perfDepthCodec.cpp
+
+  \brief Benchmark the lossless depth image codec against raw files.
+*/
+
+#if defined(VISP_HAVE_CATCH2)
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+#define CATCH_CONFIG_RUNNER
+#include <catch.hpp>
+#include <cmath>
+#include <cstdio>
+
+#include <visp3/core/vpIoTools.h>
+#include <visp3/core/vpUniRand.h>
+#include <visp3/io/vpDepthCodec.h>
+
+namespace
+{
+void createDepth(vpImage<uint16_t> &I)
+{
+  vpUniRand rng(1);
+  I.resize(480, 640);
+  for (unsigned int i = 0; i < I.getHeight(); i++) {
+    for (unsigned int j = 0; j < I.getWidth(); j++) {
+      double z = 1000. + 2. * i + 20. * std::sin(j / 40.) + rng.uniform(-4., 4.);
+      I[i][j] = (j < 40) ? 0 : static_cast<uint16_t>(z);
+    }
+  }
+}
+
+void readRaw(vpImage<uint16_t> &I, const std::string &filename)
+{
+  FILE *fd = fopen(filename.c_str(), "rb");
+  if (fd != NULL) {
+    if (fread(I.bitmap, sizeof(uint16_t), I.getSize(), fd) != I.getSize()) {
+      std::cerr << "Cannot read " << filename << std::endl;
+    }
+    fclose(fd);
+  }
+}
+} // namespace
+
+TEST_CASE("Benchmark vpDepthCodec", "[benchmark]")
+{
+  std::string username;
+  vpIoTools::getUserName(username);
+  const std::string tmp_dir = "/tmp/" + username + "/perfDepthCodec/";
+  vpIoTools::makeDirectory(tmp_dir);
+
+  vpImage<uint16_t> I;
+  createDepth(I);
+
+  const std::string filename_raw = vpIoTools::createFilePath(tmp_dir, "depth.raw");
+  FILE *fd = fopen(filename_raw.c_str(), "wb");
+  REQUIRE(fd != NULL);
+  CHECK(fwrite(I.bitmap, sizeof(uint16_t), I.getSize(), fd) == I.getSize());
+  fclose(fd);
+
+  const std::string filename_vpd = vpIoTools::createFilePath(tmp_dir, "depth.vpd");
+  vpDepthCodec::write(I, filename_vpd);
+
+  std::vector<unsigned char> data;
+  vpDepthCodec::encode(I, data);
+  WARN("Compression ratio: " << static_cast<double>(I.getSize() * sizeof(uint16_t)) / data.size());
+
+  vpImage<uint16_t> I_read(I.getHeight(), I.getWidth());
+  BENCHMARK("Read raw 16 bits file") {
+    readRaw(I_read, filename_raw);
+    return I_read;
+  };
+
+  BENCHMARK("Read vpd file") {
+    vpDepthCodec::read(I_read, filename_vpd);
+    return I_read;
+  };
+
+  BENCHMARK("Decode in memory") {
+    vpDepthCodec::decode(&data[0], data.size(), I_read);
+    return I_read;
+  };
+
+  BENCHMARK("Encode in memory") {
+    vpDepthCodec::encode(I, data);
+    return data.size();
+  };
+
+  vpIoTools::remove(tmp_dir);
+}
+
+int main(int argc, char *argv[])
+{
+  Catch::Session session; // There must be exactly one instance
+
+  bool runBenchmark = false;
+  // Build a new parser on top of Catch's
+  using namespace Catch::clara;
+  auto cli = session.cli() // Get Catch's composite command line parser
+    | Opt(runBenchmark)    // bind variable to a new option, with a hint string
+    ["--benchmark"]        // the option names it will respond to
+    ("run benchmark?");    // description string for the help output
+
+  // Now pass the new composite back to Catch so it uses that
+  session.cli(cli);
+
+  // Let Catch (using Clara) parse the command line
+  session.applyCommandLine(argc, argv);
+
+  if (runBenchmark) {
+    int numFailed = session.run();
+
+    // numFailed is clamped to 255 as some unices only use the lower 8 bits.
+    // This clamping has already been applied, so just return it here
+    // You can also do any post run clean-up here
+    return numFailed;
+  }
+
+  return EXIT_SUCCESS;
+}
+#else
+int main()
+{
+  return 0;
+}
+#endif
@@ -39,6 +39,7 @@
 #define CATCH_CONFIG_ENABLE_BENCHMARKING
 #define CATCH_CONFIG_RUNNER
 #include <catch.hpp>
+#include <sstream>
 
 #include <visp3/core/vpIoTools.h>
 #include <visp3/core/vpImageMorphology.h>
@@ -120,6 +121,61 @@ TEST_CASE("Benchmark binary image morphology", "[benchmark]") {
   }
 }
 
+TEST_CASE("Benchmark gray image morphology with rectangular structuring elements", "[benchmark]") {
+  std::string imagePath = vpIoTools::createFilePath(ipath, "Klimt/Klimt.pgm");
+  vpImage<unsigned char> I;
+  vpImageIo::read(I, imagePath);
+
+  const unsigned int sizes[] = {3, 5, 7, 11, 15, 21, 31, 41, 51};
+  for (size_t k = 0; k < sizeof(sizes) / sizeof(sizes[0]); k++) {
+    const unsigned int size = sizes[k];
+    std::ostringstream oss;
+    oss << size << "x" << size;
+
+    vpImage<unsigned char> I_morph;
+    BENCHMARK("Benchmark dilatation " + oss.str() + " (repeated 3x3)") {
+      I_morph = I;
+      for (unsigned int i = 0; i < size / 2; i++) {
+        vpImageMorphology::dilatation(I_morph, vpImageMorphology::CONNEXITY_8);
+      }
+      return I_morph;
+    };
+
+    BENCHMARK("Benchmark dilatation " + oss.str() + " (van Herk/Gil-Werman)") {
+      vpImageMorphology::dilatation(I, I_morph, size, size);
+      return I_morph;
+    };
+
+    BENCHMARK("Benchmark erosion " + oss.str() + " (repeated 3x3)") {
+      I_morph = I;
+      for (unsigned int i = 0; i < size / 2; i++) {
+        vpImageMorphology::erosion(I_morph, vpImageMorphology::CONNEXITY_8);
+      }
+      return I_morph;
+    };
+
+    BENCHMARK("Benchmark erosion " + oss.str() + " (van Herk/Gil-Werman)") {
+      vpImageMorphology::erosion(I, I_morph, size, size);
+      return I_morph;
+    };
+
+    BENCHMARK("Benchmark opening " + oss.str() + " (van Herk/Gil-Werman)") {
+      vpImageMorphology::opening(I, I_morph, size, size);
+      return I_morph;
+    };
+
+#if (VISP_HAVE_OPENCV_VERSION >= 0x030000)
+    cv::Mat img, imgMorph;
+    vpImageConvert::convert(I, img);
+    cv::Mat rect_SE = cv::getStructuringElement(cv::MORPH_RECT, cv::Size(size, size));
+    BENCHMARK("Benchmark dilatation " + oss.str() + " (OpenCV)") {
+      cv::dilate(img, imgMorph, rect_SE);
+      return imgMorph;
+    };
+#endif
+  }
+}
+
 #if (VISP_HAVE_OPENCV_VERSION >= 0x030000)
 TEST_CASE("Benchmark gray image morphology", "[benchmark]") {
   std::string imagePath = vpIoTools::createFilePath(ipath, "Klimt/Klimt.pgm");
@@ -0,0 +1,243 @@
+/****************************************************************************
+ *
+ * ViSP, open source Visual Servoing Platform software.
+ * Copyright (C) 2005 - 2019 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test the asynchronous image writer.
+ *
+ *****************************************************************************/
+
+#include <visp3/core/vpConfig.h>
+
+/*!
+  \example testAsyncImageWriter.cpp
+
+  \brief Test writing images in the background with vpAsyncImageWriter and
+  vpVideoWriter.
+*/
+
+#if defined(VISP_HAVE_CATCH2)
+#define CATCH_CONFIG_RUNNER
+#include <catch.hpp>
+
+#include <visp3/core/vpIoTools.h>
+#include <visp3/io/vpAsyncImageWriter.h>
+#include <visp3/io/vpImageIo.h>
+#include <visp3/io/vpVideoReader.h>
+#include <visp3/io/vpVideoWriter.h>
+
+namespace
+{
+std::string getTmpDir()
+{
+#if defined(_WIN32)
+  std::string tmp_dir = "C:/temp/";
+#else
+  std::string tmp_dir = "/tmp/";
+#endif
+
+  // Get the user login name
+  std::string username;
+  vpIoTools::getUserName(username);
+  tmp_dir += username + "/testAsyncImageWriter/";
+  vpIoTools::makeDirectory(tmp_dir);
+
+  return tmp_dir;
+}
+
+vpImage<vpRGBa> createImage(unsigned int index, unsigned int height = 48, unsigned int width = 64)
+{
+  vpImage<vpRGBa> I(height, width);
+  for (unsigned int i = 0; i < height; i++) {
+    for (unsigned int j = 0; j < width; j++) {
+      I[i][j] = vpRGBa(static_cast<unsigned char>((index * 9 + i) % 256), static_cast<unsigned char>((j * 3) % 256),
+                       static_cast<unsigned char>((index + i + j) % 256));
+    }
+  }
+  return I;
+}
+
+std::string getFilename(const std::string &tmp_dir, unsigned int index, const std::string &ext)
+{
+  char name[FILENAME_MAX];
+  sprintf(name, "image%04u.%s", index, ext.c_str());
+  return vpIoTools::createFilePath(tmp_dir, name);
+}
+
+double meanAbsoluteDifference(const vpImage<vpRGBa> &I1, const vpImage<vpRGBa> &I2)
+{
+  double sum = 0.;
+  for (unsigned int i = 0; i < I1.getSize(); i++) {
+    sum += std::fabs(static_cast<double>(I1.bitmap[i].R) - I2.bitmap[i].R) +
+           std::fabs(static_cast<double>(I1.bitmap[i].G) - I2.bitmap[i].G) +
+           std::fabs(static_cast<double>(I1.bitmap[i].B) - I2.bitmap[i].B);
+  }
+  return sum / (3. * I1.getSize());
+}
+} // namespace
+
+TEST_CASE("Asynchronous writing", "[io]")
+{
+  std::string tmp_dir = getTmpDir();
+  const unsigned int nbImages = 20;
+
+  SECTION("Write and read back")
+  {
+    {
+      vpAsyncImageWriter writer(3, 4);
+      vpImage<vpRGBa> I;
+      for (unsigned int index = 0; index < nbImages; index++) {
+        // The image can be modified as soon as write() returns
+        I = createImage(index);
+        CHECK(writer.write(I, getFilename(tmp_dir, index, "png")));
+        CHECK(writer.write(I, getFilename(tmp_dir, index, "jpg")));
+        vpImage<unsigned char> I_gray;
+        vpImageConvert::convert(I, I_gray);
+        CHECK(writer.write(I_gray, getFilename(tmp_dir, index, "pgm")));
+      }
+      writer.flush();
+      CHECK(writer.getQueueSize() == 0);
+      vpAsyncImageWriter::vpStatistics statistics = writer.getStatistics();
+      CHECK(statistics.nbQueued == 3 * nbImages);
+      CHECK(statistics.nbWritten == 3 * nbImages);
+      CHECK(statistics.nbDropped == 0);
+      CHECK(statistics.nbFailed == 0);
+      CHECK(statistics.maxQueueSize <= 4);
+      writer.resetStatistics();
+      CHECK(writer.getStatistics().nbWritten == 0);
+    }
+
+    for (unsigned int index = 0; index < nbImages; index++) {
+      vpImage<vpRGBa> I_ref = createImage(index);
+      vpImage<vpRGBa> I_png, I_jpg;
+      vpImageIo::read(I_png, getFilename(tmp_dir, index, "png"));
+      CHECK((I_png == I_ref));
+      vpImageIo::read(I_jpg, getFilename(tmp_dir, index, "jpg"));
+      REQUIRE(I_jpg.getSize() == I_ref.getSize());
+      CHECK(meanAbsoluteDifference(I_jpg, I_ref) < 8.);
+
+      vpImage<unsigned char> I_gray_ref, I_gray;
+      vpImageConvert::convert(I_ref, I_gray_ref);
+      vpImageIo::read(I_gray, getFilename(tmp_dir, index, "pgm"));
+      CHECK((I_gray == I_gray_ref));
+    }
+  }
+
+  SECTION("Gray level encoders")
+  {
+    vpImage<unsigned char> I_gray_ref, I_gray;
+    vpImageConvert::convert(createImage(3), I_gray_ref);
+    vpImageIo::write(I_gray_ref, getFilename(tmp_dir, 0, "png"));
+    vpImageIo::read(I_gray, getFilename(tmp_dir, 0, "png"));
+    CHECK((I_gray == I_gray_ref));
+    vpImageIo::write(I_gray_ref, getFilename(tmp_dir, 0, "jpg"));
+    vpImageIo::read(I_gray, getFilename(tmp_dir, 0, "jpg"));
+    CHECK(I_gray.getSize() == I_gray_ref.getSize());
+  }
+
+  SECTION("Drop policy")
+  {
+    vpAsyncImageWriter writer(1, 1, vpAsyncImageWriter::DROP);
+    vpImage<vpRGBa> I = createImage(0, 480, 640);
+    unsigned int nbAccepted = 0;
+    for (unsigned int index = 0; index < nbImages; index++) {
+      if (writer.write(I, getFilename(tmp_dir, index, "png"))) {
+        nbAccepted++;
+      }
+    }
+    writer.flush();
+    vpAsyncImageWriter::vpStatistics statistics = writer.getStatistics();
+    CHECK(statistics.nbQueued == nbAccepted);
+    CHECK(statistics.nbQueued + statistics.nbDropped == nbImages);
+    CHECK(statistics.nbDropped > 0);
+    CHECK(statistics.nbWritten == nbAccepted);
+    CHECK(statistics.nbBlocked == 0);
+  }
+
+  SECTION("Errors are reported by flush")
+  {
+    vpAsyncImageWriter writer(2, 2);
+    vpImage<vpRGBa> I = createImage(0);
+    writer.write(I, getFilename(vpIoTools::createFilePath(tmp_dir, "missing"), 0, "png"));
+    writer.write(I, getFilename(tmp_dir, 0, "png"));
+    CHECK_THROWS_AS(writer.flush(), vpImageException);
+    CHECK_NOTHROW(writer.flush());
+    CHECK(writer.getStatistics().nbFailed == 1);
+    CHECK(writer.getStatistics().nbWritten == 1);
+  }
+
+  SECTION("Video writer")
+  {
+    std::string generic_name = vpIoTools::createFilePath(tmp_dir, "frame%04d.png");
+    vpVideoWriter writer;
+    writer.setFileName(generic_name);
+    writer.setFirstFrameIndex(1);
+    writer.setAsyncWrite(2, 3);
+    vpImage<vpRGBa> I = createImage(0);
+    writer.open(I);
+    for (unsigned int index = 1; index <= nbImages; index++) {
+      I = createImage(index);
+      writer.saveFrame(I);
+    }
+    writer.close();
+    CHECK(writer.getAsyncWriteStatistics().nbWritten == nbImages);
+
+    vpVideoReader reader;
+    reader.setFileName(generic_name);
+    reader.open(I);
+    CHECK(reader.getLastFrameIndex() == static_cast<long>(nbImages));
+    for (unsigned int index = 1; index <= nbImages; index++) {
+      reader.getFrame(I, index);
+      CHECK((I == createImage(index)));
+    }
+  }
+
+  vpIoTools::remove(tmp_dir);
+}
+
+int main(int argc, char *argv[])
+{
+  Catch::Session session; // There must be exactly one instance
+
+  // Let Catch (using Clara) parse the command line
+  session.applyCommandLine(argc, argv);
+
+  int numFailed = session.run();
+
+  // numFailed is clamped to 255 as some unices only use the lower 8 bits.
+  // This clamping has already been applied, so just return it here
+  // You can also do any post run clean-up here
+  return numFailed;
+}
+#else
+int main()
+{
+  return 0;
+}
+#endif
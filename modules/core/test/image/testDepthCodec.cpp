@@ -0,0 +1,403 @@
+/****************************************************************************
+ *
+ * ViSP, open source Visual Servoing Platform software.
+ * Copyright (C) 2005 - 2019 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test the lossless depth image codec.
+ *
+ *****************************************************************************/
+
+#include <visp3/core/vpConfig.h>
+
+/*!
+  \example testDepthCodec.cpp
+
+  \brief Test the lossless coding of depth images with vpDepthCodec, and the
+  depth image sequences of vpVideoWriter and vpVideoReader.
+*/
+
+#if defined(VISP_HAVE_CATCH2)
+#define CATCH_CONFIG_RUNNER
+#include <catch.hpp>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include <visp3/core/vpIoTools.h>
+#include <visp3/core/vpUniRand.h>
+#include <visp3/io/vpDepthCodec.h>
+#include <visp3/io/vpImageIo.h>
+#include <visp3/io/vpVideoReader.h>
+#include <visp3/io/vpVideoWriter.h>
+
+namespace
+{
+std::string getTmpDir()
+{
+#if defined(_WIN32)
+  std::string tmp_dir = "C:/temp/";
+#else
+  std::string tmp_dir = "/tmp/";
+#endif
+
+  // Get the user login name
+  std::string username;
+  vpIoTools::getUserName(username);
+  tmp_dir += username + "/testDepthCodec/";
+  vpIoTools::makeDirectory(tmp_dir);
+
+  return tmp_dir;
+}
+
+// Depth map of a tilted plane and a sphere, with noise and invalid pixels
+void createDepth(unsigned int height, unsigned int width, unsigned int seed, vpImage<uint16_t> &I)
+{
+  vpUniRand rng(seed);
+  I.resize(height, width);
+  for (unsigned int i = 0; i < height; i++) {
+    for (unsigned int j = 0; j < width; j++) {
+      double di = static_cast<double>(i) - height / 2.0, dj = static_cast<double>(j) - width / 3.0;
+      double z = 1500. + 2. * i + 0.5 * j;
+      double r2 = di * di + dj * dj, R = height / 4.0;
+      if (r2 < R * R) {
+        z -= 10. * std::sqrt(R * R - r2);
+      }
+      z += rng.uniform(-3., 3.);
+      I[i][j] = static_cast<uint16_t>(z);
+    }
+  }
+  // Invalid pixels
+  for (unsigned int i = 0; i < height / 5; i++) {
+    for (unsigned int j = 0; j < width / 4; j++) {
+      I[i][j] = 0;
+    }
+  }
+  for (unsigned int k = 0; k < I.getSize() / 50; k++) {
+    I.bitmap[rng.uniform(0, static_cast<int>(I.getSize()))] = 0;
+  }
+}
+
+void createDepth(unsigned int height, unsigned int width, unsigned int seed, vpImage<float> &I)
+{
+  vpImage<uint16_t> I_depth;
+  createDepth(height, width, seed, I_depth);
+  I.resize(height, width);
+  for (unsigned int i = 0; i < I.getSize(); i++) {
+    I.bitmap[i] = I_depth.bitmap[i] * 0.001f;
+  }
+}
+
+template <class Type> bool sameBits(const vpImage<Type> &I1, const vpImage<Type> &I2)
+{
+  return I1.getHeight() == I2.getHeight() && I1.getWidth() == I2.getWidth() &&
+         (I1.getSize() == 0 || memcmp(I1.bitmap, I2.bitmap, I1.getSize() * sizeof(Type)) == 0);
+}
+
+template <class Type> bool roundTrip(const vpImage<Type> &I, unsigned int stripeHeight = 32)
+{
+  std::vector<unsigned char> data;
+  vpDepthCodec::encode(I, data, stripeHeight);
+  vpImage<Type> I_decoded;
+  vpDepthCodec::decode(&data[0], data.size(), I_decoded);
+  return sameBits(I, I_decoded);
+}
+} // namespace
+
+TEST_CASE("Depth codec 16 bits round trip", "[io]")
+{
+  SECTION("Smooth depth map")
+  {
+    vpImage<uint16_t> I;
+    createDepth(120, 160, 1, I);
+    std::vector<unsigned char> data;
+    vpDepthCodec::encode(I, data);
+    CHECK(data.size() < I.getSize() * sizeof(uint16_t) / 2);
+
+    vpImage<uint16_t> I_decoded(3, 3, 7);
+    vpDepthCodec::decode(&data[0], data.size(), I_decoded);
+    CHECK(sameBits(I, I_decoded));
+
+    for (unsigned int stripeHeight = 1; stripeHeight <= 256; stripeHeight *= 4) {
+      INFO("Stripe height: " << stripeHeight);
+      CHECK(roundTrip(I, stripeHeight));
+    }
+  }
+
+  SECTION("Random and extreme values")
+  {
+    vpUniRand rng(42);
+    vpImage<uint16_t> I(31, 45);
+    for (unsigned int i = 0; i < I.getSize(); i++) {
+      I.bitmap[i] = static_cast<uint16_t>(rng.next());
+    }
+    CHECK(roundTrip(I));
+    CHECK(roundTrip(I, 7));
+
+    for (unsigned int i = 0; i < I.getSize(); i++) {
+      I.bitmap[i] = (i % 3 == 0) ? 65535 : 0;
+    }
+    CHECK(roundTrip(I));
+
+    I = 0;
+    std::vector<unsigned char> data;
+    vpDepthCodec::encode(I, data);
+    CHECK(data.size() < 200);
+    CHECK(roundTrip(I));
+  }
+
+  SECTION("Small sizes")
+  {
+    unsigned int sizes[][2] = {{0, 0}, {1, 1}, {1, 17}, {17, 1}, {2, 16}, {33, 15}};
+    for (size_t k = 0; k < sizeof(sizes) / sizeof(sizes[0]); k++) {
+      INFO("Size: " << sizes[k][0] << "x" << sizes[k][1]);
+      vpImage<uint16_t> I(sizes[k][0], sizes[k][1]);
+      for (unsigned int i = 0; i < I.getSize(); i++) {
+        I.bitmap[i] = static_cast<uint16_t>(i * 977);
+      }
+      CHECK(roundTrip(I));
+    }
+  }
+}
+
+TEST_CASE("Depth codec float round trip", "[io]")
+{
+  vpImage<float> I;
+  createDepth(97, 131, 2, I);
+  std::vector<unsigned char> data;
+  vpDepthCodec::encode(I, data);
+  // Noisy float depths are less compressible than their 16 bits counterpart
+  CHECK(data.size() < I.getSize() * sizeof(float) * 3 / 4);
+  CHECK(roundTrip(I));
+
+  // Special values are kept bit for bit
+  I[0][0] = std::numeric_limits<float>::quiet_NaN();
+  I[0][1] = std::numeric_limits<float>::infinity();
+  I[0][2] = -std::numeric_limits<float>::infinity();
+  I[1][0] = -0.0f;
+  I[1][1] = -1.5f;
+  I[1][2] = std::numeric_limits<float>::denorm_min();
+  I[2][2] = std::numeric_limits<float>::max();
+  CHECK(roundTrip(I));
+  CHECK(roundTrip(I, 1));
+
+  vpUniRand rng(3);
+  for (unsigned int i = 0; i < I.getSize(); i++) {
+    uint32_t bits = rng.next();
+    memcpy(&I.bitmap[i], &bits, sizeof(bits));
+  }
+  CHECK(roundTrip(I));
+}
+
+TEST_CASE("Depth codec invalid data", "[io]")
+{
+  vpImage<uint16_t> I;
+  createDepth(64, 80, 4, I);
+  std::vector<unsigned char> data;
+  vpDepthCodec::encode(I, data, 16);
+
+  vpImage<uint16_t> I_decoded;
+  vpImage<float> I_float;
+  CHECK_THROWS_AS(vpDepthCodec::decode(&data[0], data.size(), I_float), vpImageException);
+  CHECK_THROWS_AS(vpDepthCodec::decode(&data[0], 10, I_decoded), vpImageException);
+  CHECK_THROWS_AS(vpDepthCodec::decode(&data[0], data.size() - 1, I_decoded), vpImageException);
+  CHECK_THROWS_AS(vpDepthCodec::decode(NULL, 0, I_decoded), vpImageException);
+  CHECK_THROWS_AS(vpDepthCodec::encode(I, data, 0), vpImageException);
+
+  std::vector<unsigned char> corrupted = data;
+  corrupted[0] = 'X';
+  CHECK_THROWS_AS(vpDepthCodec::decode(&corrupted[0], corrupted.size(), I_decoded), vpImageException);
+
+  // Corrupted sizes in the header are rejected before allocating the image:
+  // a single stripe announcing a huge image, a number of pixels overflowing
+  // vpImage, and an image without columns
+  const size_t widthField = 8 + 3 * sizeof(uint32_t);
+  uint32_t fields[][4] = {{80, 0x1000000u, 0x1000000u, 1},
+                          {0x10000u, 0x10001u, 0x10001u, 1},
+                          {0, 0x7fffffffu, 0x7fffffffu, 1},
+                          {80, 1000, 250, 4}};
+  for (size_t k = 0; k < sizeof(fields) / sizeof(fields[0]); k++) {
+    INFO("Header: " << fields[k][0] << "x" << fields[k][1] << ", stripes of " << fields[k][2] << " rows");
+    corrupted = data;
+    memcpy(&corrupted[widthField], fields[k], sizeof(fields[k]));
+    CHECK_THROWS_AS(vpDepthCodec::decode(&corrupted[0], corrupted.size(), I_decoded), vpImageException);
+  }
+
+  // Corrupted bit streams may decode to wrong pixels, but never read out of
+  // the data
+  vpUniRand rng(5);
+  for (unsigned int k = 0; k < 50; k++) {
+    corrupted = data;
+    for (unsigned int n = 0; n < 8; n++) {
+      size_t idx = 100 + static_cast<size_t>(rng.uniform(0, static_cast<int>(data.size()) - 100));
+      corrupted[idx] = static_cast<unsigned char>(rng.next());
+    }
+    try {
+      vpDepthCodec::decode(&corrupted[0], corrupted.size(), I_decoded);
+      CHECK(I_decoded.getSize() == I.getSize());
+    } catch (const vpImageException &) {
+    }
+  }
+}
+
+TEST_CASE("Depth image files", "[io]")
+{
+  const std::string tmp_dir = getTmpDir();
+
+  vpImage<uint16_t> I;
+  createDepth(48, 64, 6, I);
+  vpImage<float> I_float;
+  createDepth(48, 64, 7, I_float);
+
+  const std::string filename_vpd = vpIoTools::createFilePath(tmp_dir, "depth.vpd");
+  vpImageIo::write(I, filename_vpd);
+  vpImage<uint16_t> I_read;
+  vpImageIo::read(I_read, filename_vpd);
+  CHECK(sameBits(I, I_read));
+  vpImage<float> I_float_read;
+  CHECK_THROWS_AS(vpImageIo::read(I_float_read, filename_vpd), vpImageException);
+
+  const std::string filename_float_vpd = vpIoTools::createFilePath(tmp_dir, "depth_float.vpd");
+  vpImageIo::write(I_float, filename_float_vpd);
+  vpImageIo::read(I_float_read, filename_float_vpd);
+  CHECK(sameBits(I_float, I_float_read));
+
+  const std::string filename_pfm = vpIoTools::createFilePath(tmp_dir, "depth.pfm");
+  vpImageIo::write(I_float, filename_pfm);
+  vpImageIo::read(I_float_read, filename_pfm);
+  CHECK(sameBits(I_float, I_float_read));
+
+  CHECK_THROWS_AS(vpImageIo::write(I, vpIoTools::createFilePath(tmp_dir, "depth.png")), vpImageException);
+  CHECK_THROWS_AS(vpImageIo::read(I_read, vpIoTools::createFilePath(tmp_dir, "missing.vpd")), vpImageException);
+
+  vpIoTools::remove(tmp_dir);
+}
+
+TEST_CASE("Depth image sequences", "[io]")
+{
+  const std::string tmp_dir = getTmpDir();
+  const unsigned int nbFrames = 6;
+
+  std::vector<vpImage<uint16_t> > frames(nbFrames);
+  std::vector<vpImage<float> > frames_float(nbFrames);
+  for (unsigned int k = 0; k < nbFrames; k++) {
+    createDepth(40, 56, 10 + k, frames[k]);
+    createDepth(40, 56, 20 + k, frames_float[k]);
+  }
+
+  SECTION("16 bits depth")
+  {
+    const std::string filename = vpIoTools::createFilePath(tmp_dir, "depth%04d.vpd");
+    {
+      vpVideoWriter writer;
+      writer.setAsyncWrite(2);
+      writer.setFileName(filename);
+      writer.open(frames[0]);
+      for (unsigned int k = 0; k < nbFrames; k++) {
+        writer.saveFrame(frames[k]);
+      }
+      writer.close();
+    }
+
+    vpVideoReader reader;
+    reader.setFileName(filename);
+    reader.setPrefetch(2);
+    vpImage<uint16_t> I;
+    reader.open(I);
+    CHECK(reader.getFirstFrameIndex() == 0);
+    CHECK(reader.getLastFrameIndex() == static_cast<long>(nbFrames) - 1);
+    unsigned int k = 0;
+    while (!reader.end()) {
+      reader.acquire(I);
+      REQUIRE(k < nbFrames);
+      CHECK(sameBits(I, frames[k]));
+      k++;
+    }
+    CHECK(k == nbFrames);
+
+    CHECK(reader.getFrame(I, 3));
+    CHECK(sameBits(I, frames[3]));
+  }
+
+  SECTION("Float depth")
+  {
+    const std::string filename = vpIoTools::createFilePath(tmp_dir, "depth%04d.vpd");
+    {
+      vpVideoWriter writer;
+      writer.setFileName(filename);
+      writer.open(frames_float[0]);
+      for (unsigned int k = 0; k < nbFrames; k++) {
+        writer.saveFrame(frames_float[k]);
+      }
+      writer.close();
+    }
+
+    vpVideoReader reader;
+    reader.setFileName(filename);
+    vpImage<float> I;
+    reader.open(I);
+    unsigned int k = 0;
+    while (!reader.end()) {
+      reader.acquire(I);
+      REQUIRE(k < nbFrames);
+      CHECK(sameBits(I, frames_float[k]));
+      k++;
+    }
+    CHECK(k == nbFrames);
+  }
+
+  SECTION("Unsupported formats")
+  {
+    vpVideoWriter writer;
+    writer.setFileName(vpIoTools::createFilePath(tmp_dir, "depth%04d.png"));
+    CHECK_THROWS_AS(writer.open(frames[0]), vpException);
+  }
+
+  vpIoTools::remove(tmp_dir);
+}
+
+int main(int argc, char *argv[])
+{
+  Catch::Session session; // There must be exactly one instance
+
+  // Let Catch (using Clara) parse the command line
+  session.applyCommandLine(argc, argv);
+
+  int numFailed = session.run();
+
+  // numFailed is clamped to 255 as some unices only use the lower 8 bits.
+  // This clamping has already been applied, so just return it here
+  // You can also do any post run clean-up here
+  return numFailed;
+}
+#else
+int main()
+{
+  return 0;
+}
+#endif
@@ -0,0 +1,239 @@
+/****************************************************************************
+ *
+ * ViSP, open source Visual Servoing Platform software.
+ * Copyright (C) 2005 - 2019 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test memory-mapped PGM, PPM and PFM image files.
+ *
+ *****************************************************************************/
+
+#include <visp3/core/vpConfig.h>
+
+/*!
+  \example testImageMap.cpp
+
+  \brief Test reading and writing PGM, PPM and PFM files with vpImageMap.
+*/
+
+#if defined(VISP_HAVE_CATCH2)
+#define CATCH_CONFIG_RUNNER
+#include <catch.hpp>
+#include <fstream>
+
+#include <visp3/core/vpIoTools.h>
+#include <visp3/io/vpImageIo.h>
+#include <visp3/io/vpImageMap.h>
+
+namespace
+{
+std::string getTmpDir()
+{
+#if defined(_WIN32)
+  std::string tmp_dir = "C:/temp/";
+#else
+  std::string tmp_dir = "/tmp/";
+#endif
+
+  // Get the user login name
+  std::string username;
+  vpIoTools::getUserName(username);
+  tmp_dir += username + "/testImageMap/";
+  vpIoTools::makeDirectory(tmp_dir);
+
+  return tmp_dir;
+}
+
+void createImages(vpImage<unsigned char> &I, vpImage<vpRGBa> &I_color, vpImage<float> &I_float)
+{
+  unsigned int height = 37, width = 53;
+  I.resize(height, width);
+  I_color.resize(height, width);
+  I_float.resize(height, width);
+  for (unsigned int i = 0; i < height; i++) {
+    for (unsigned int j = 0; j < width; j++) {
+      I[i][j] = static_cast<unsigned char>((i * 11 + j * 5) % 256);
+      I_color[i][j] = vpRGBa(static_cast<unsigned char>(i * 3), static_cast<unsigned char>(j * 7),
+                             static_cast<unsigned char>((i + j) % 256));
+      I_float[i][j] = static_cast<float>(i) * 0.5f - static_cast<float>(j) * 1.25f;
+    }
+  }
+}
+} // namespace
+
+TEST_CASE("Write and map images", "[io]")
+{
+  std::string tmp_dir = getTmpDir();
+  vpImage<unsigned char> I;
+  vpImage<vpRGBa> I_color;
+  vpImage<float> I_float;
+  createImages(I, I_color, I_float);
+
+  std::string filename_pgm = vpIoTools::createFilePath(tmp_dir, "image.pgm");
+  std::string filename_ppm = vpIoTools::createFilePath(tmp_dir, "image.ppm");
+  std::string filename_pfm = vpIoTools::createFilePath(tmp_dir, "image.pfm");
+  vpImageMap::write(I, filename_pgm);
+  vpImageMap::write(I_color, filename_ppm);
+  vpImageMap::write(I_float, filename_pfm);
+
+  SECTION("Read with vpImageIo")
+  {
+    vpImage<unsigned char> I_read;
+    vpImageIo::readPGM(I_read, filename_pgm);
+    CHECK((I_read == I));
+
+    vpImage<vpRGBa> I_color_read;
+    vpImageIo::readPPM(I_color_read, filename_ppm);
+    CHECK((I_color_read == I_color));
+
+    vpImage<float> I_float_read;
+    vpImageIo::readPFM(I_float_read, filename_pfm);
+    CHECK((I_float_read == I_float));
+
+    // Color to gray conversion as in vpImageConvert
+    vpImage<unsigned char> I_gray, I_gray_ref;
+    vpImageIo::readPPM(I_gray, filename_ppm);
+    vpImageConvert::convert(I_color, I_gray_ref);
+    CHECK((I_gray == I_gray_ref));
+
+    vpImage<vpRGBa> I_gray_color, I_gray_color_ref;
+    vpImageIo::readPGM(I_gray_color, filename_pgm);
+    vpImageConvert::convert(I, I_gray_color_ref);
+    CHECK((I_gray_color == I_gray_color_ref));
+  }
+
+  SECTION("Map without copy")
+  {
+    vpImageMap file(filename_pgm);
+    CHECK(file.getFormat() == vpImageMap::FORMAT_PGM);
+    CHECK(file.getWidth() == I.getWidth());
+    CHECK(file.getHeight() == I.getHeight());
+    vpImage<unsigned char> I_map;
+    REQUIRE(file.map(I_map));
+    CHECK(reinterpret_cast<size_t>(I_map.bitmap) % 16 == 0);
+    CHECK((I_map == I));
+
+    // Private mapping: the file is not modified
+    I_map[0][0] = 255 - I[0][0];
+    vpImage<unsigned char> I_read;
+    vpImageIo::readPGM(I_read, filename_pgm);
+    CHECK((I_read == I));
+
+    vpImageMap file_float(filename_pfm);
+    vpImage<float> I_float_map;
+    REQUIRE(file_float.map(I_float_map));
+    CHECK((I_float_map == I_float));
+
+    // A PPM file is decoded
+    vpImageMap file_color(filename_ppm);
+    vpImage<unsigned char> I_gray;
+    CHECK_FALSE(file_color.map(I_gray));
+    CHECK(I_gray.getSize() == I.getSize());
+    CHECK_THROWS(file_color.map(I_float_map));
+  }
+
+  SECTION("Files written by vpImageIo")
+  {
+    vpImageIo::writePGM(I, filename_pgm);
+    vpImageIo::writePFM(I_float, filename_pfm);
+
+    vpImageMap file(filename_pgm);
+    vpImage<unsigned char> I_map;
+    CHECK(file.map(I_map));
+    CHECK((I_map == I));
+
+    // Pixels are aligned or copied
+    vpImageMap file_float(filename_pfm);
+    vpImage<float> I_float_map;
+    file_float.map(I_float_map);
+    CHECK((I_float_map == I_float));
+  }
+
+  SECTION("Create and write in place")
+  {
+    {
+      vpImageMap file;
+      file.create(filename_pgm, I.getWidth(), I.getHeight(), vpImageMap::FORMAT_PGM);
+      vpImage<unsigned char> I_map;
+      REQUIRE(file.map(I_map));
+      I_map = 0;
+      I_map[3][4] = 42;
+      vpImage<float> I_float_map;
+      CHECK_THROWS(file.map(I_float_map));
+    }
+    vpImage<unsigned char> I_read;
+    vpImageIo::readPGM(I_read, filename_pgm);
+    REQUIRE(I_read.getSize() == I.getSize());
+    CHECK(I_read[3][4] == 42);
+    CHECK(I_read[0][0] == 0);
+  }
+
+  SECTION("Invalid files")
+  {
+    vpImageMap file;
+    vpImage<unsigned char> I_read;
+    CHECK_THROWS(file.read(I_read));
+    CHECK_THROWS(file.open(vpIoTools::createFilePath(tmp_dir, "missing.pgm")));
+    CHECK_THROWS(file.open(filename_pgm, vpImageMap::FORMAT_PPM));
+    CHECK_THROWS(vpImageIo::readPPM(I_read, filename_pgm));
+
+    // Truncated file
+    std::string filename_truncated = vpIoTools::createFilePath(tmp_dir, "truncated.pgm");
+    {
+      std::ofstream truncated(filename_truncated.c_str(), std::ios::out | std::ios::binary);
+      truncated << "P5\n10 10\n255\n";
+      truncated << "0123456789";
+    }
+    CHECK_THROWS_AS(file.open(filename_truncated), vpImageException);
+    CHECK_FALSE(file.isOpen());
+    CHECK_THROWS_AS(vpImageIo::readPGM(I_read, filename_truncated), vpImageException);
+  }
+
+  vpIoTools::remove(tmp_dir);
+}
+
+int main(int argc, char *argv[])
+{
+  Catch::Session session; // There must be exactly one instance
+
+  // Let Catch (using Clara) parse the command line
+  session.applyCommandLine(argc, argv);
+
+  int numFailed = session.run();
+
+  // numFailed is clamped to 255 as some unices only use the lower 8 bits.
+  // This clamping has already been applied, so just return it here
+  // You can also do any post run clean-up here
+  return numFailed;
+}
+#else
+int main()
+{
+  return 0;
+}
+#endif
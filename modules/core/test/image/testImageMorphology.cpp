@@ -45,8 +45,35 @@
 #define CATCH_CONFIG_RUNNER
 #include <catch.hpp>
 #include <visp3/core/vpImageMorphology.h>
+#include <visp3/core/vpUniRand.h>
 #include "common.hpp"
 
+namespace
+{
+// Naive erosion or dilatation with a width x height rectangle, anchored at
+// its center or at the symmetric position when reflect is true
+void morphologyRectRef(const vpImage<unsigned char> &I, vpImage<unsigned char> &Ires, unsigned int width,
+                       unsigned int height, bool dilate, bool reflect = false)
+{
+  Ires.resize(I.getHeight(), I.getWidth());
+  const int anchor_u = static_cast<int>(reflect ? width - 1 - width / 2 : width / 2);
+  const int anchor_v = static_cast<int>(reflect ? height - 1 - height / 2 : height / 2);
+  for (int i = 0; i < static_cast<int>(I.getHeight()); i++) {
+    for (int j = 0; j < static_cast<int>(I.getWidth()); j++) {
+      unsigned char value = dilate ? 0 : 255;
+      for (int v = i - anchor_v; v < i - anchor_v + static_cast<int>(height); v++) {
+        for (int u = j - anchor_u; u < j - anchor_u + static_cast<int>(width); u++) {
+          if (v >= 0 && u >= 0 && v < static_cast<int>(I.getHeight()) && u < static_cast<int>(I.getWidth())) {
+            value = dilate ? std::max(value, I[v][u]) : std::min(value, I[v][u]);
+          }
+        }
+      }
+      Ires[i][j] = value;
+    }
+  }
+}
+} // namespace
+
 TEST_CASE("Binary image morphology", "[image_morphology]") {
   unsigned char image_data[8 * 16] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0, 1, 0,
                                        0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 1, 0, 0, 0, 1, 1, 0, 0, 0, 1, 1,
@@ -330,6 +357,88 @@ TEST_CASE("Gray image morphology", "[image_morphology]") {
   }
 }
 
+TEST_CASE("Gray image morphology with rectangular structuring elements", "[image_morphology]") {
+  vpUniRand rng;
+  vpImage<unsigned char> I(37, 53);
+  for (unsigned int i = 0; i < I.getSize(); i++) {
+    I.bitmap[i] = static_cast<unsigned char>(rng.uniform(0, 256));
+  }
+
+  SECTION("Comparison with the naive implementation")
+  {
+    const unsigned int sizes[] = {1, 2, 3, 4, 5, 8, 11, 36, 37, 38, 60};
+    for (size_t w = 0; w < sizeof(sizes) / sizeof(sizes[0]); w++) {
+      for (size_t h = 0; h < sizeof(sizes) / sizeof(sizes[0]); h++) {
+        vpImage<unsigned char> I_dilatation, I_erosion, I_dilatation_ref, I_erosion_ref;
+        vpImageMorphology::dilatation(I, I_dilatation, sizes[w], sizes[h]);
+        vpImageMorphology::erosion(I, I_erosion, sizes[w], sizes[h]);
+        morphologyRectRef(I, I_dilatation_ref, sizes[w], sizes[h], true);
+        morphologyRectRef(I, I_erosion_ref, sizes[w], sizes[h], false);
+        INFO("Structuring element " << sizes[w] << "x" << sizes[h]);
+        CHECK((I_dilatation == I_dilatation_ref));
+        CHECK((I_erosion == I_erosion_ref));
+      }
+    }
+  }
+
+  SECTION("Comparison with the 3x3 structuring element")
+  {
+    for (unsigned int n = 1; n <= 4; n++) {
+      vpImage<unsigned char> I_dilatation_ref = I, I_erosion_ref = I, I_dilatation, I_erosion;
+      for (unsigned int k = 0; k < n; k++) {
+        vpImageMorphology::dilatation(I_dilatation_ref, vpImageMorphology::CONNEXITY_8);
+        vpImageMorphology::erosion(I_erosion_ref, vpImageMorphology::CONNEXITY_8);
+      }
+      vpImageMorphology::dilatation(I, I_dilatation, 2 * n + 1, 2 * n + 1);
+      vpImageMorphology::erosion(I, I_erosion, 2 * n + 1, 2 * n + 1);
+      CHECK((I_dilatation == I_dilatation_ref));
+      CHECK((I_erosion == I_erosion_ref));
+    }
+  }
+
+  SECTION("Opening, closing, top-hat, black-hat and gradient")
+  {
+    const unsigned int width = 7, height = 4;
+    vpImage<unsigned char> I_dilatation, I_erosion, I_opening_ref, I_closing_ref;
+    morphologyRectRef(I, I_dilatation, width, height, true);
+    morphologyRectRef(I, I_erosion, width, height, false);
+    morphologyRectRef(I_erosion, I_opening_ref, width, height, true, true);
+    morphologyRectRef(I_dilatation, I_closing_ref, width, height, false, true);
+
+    vpImage<unsigned char> I_opening, I_closing, I_top_hat, I_black_hat, I_gradient;
+    vpImageMorphology::opening(I, I_opening, width, height);
+    vpImageMorphology::closing(I, I_closing, width, height);
+    vpImageMorphology::topHat(I, I_top_hat, width, height);
+    vpImageMorphology::blackHat(I, I_black_hat, width, height);
+    vpImageMorphology::gradient(I, I_gradient, width, height);
+    CHECK((I_opening == I_opening_ref));
+    CHECK((I_closing == I_closing_ref));
+
+    bool ok = true;
+    for (unsigned int i = 0; i < I.getSize(); i++) {
+      ok = ok && I_top_hat.bitmap[i] == I.bitmap[i] - I_opening_ref.bitmap[i];
+      ok = ok && I_black_hat.bitmap[i] == I_closing_ref.bitmap[i] - I.bitmap[i];
+      ok = ok && I_gradient.bitmap[i] == I_dilatation.bitmap[i] - I_erosion.bitmap[i];
+    }
+    CHECK(ok);
+
+    // In place
+    vpImage<unsigned char> I_in_place = I;
+    vpImageMorphology::opening(I_in_place, I_in_place, width, height);
+    CHECK((I_in_place == I_opening_ref));
+    I_in_place = I;
+    vpImageMorphology::dilatation(I_in_place, I_in_place, 1, height);
+    morphologyRectRef(I, I_dilatation, 1, height, true);
+    CHECK((I_in_place == I_dilatation));
+  }
+
+  SECTION("Invalid structuring element")
+  {
+    vpImage<unsigned char> I_dilatation;
+    CHECK_THROWS_AS(vpImageMorphology::dilatation(I, I_dilatation, 0, 3), vpException);
+  }
+}
+
 int main(int argc, char *argv[])
 {
   Catch::Session session; // There must be exactly one instance
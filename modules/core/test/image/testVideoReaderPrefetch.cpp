@@ -0,0 +1,219 @@
+/****************************************************************************
+ *
+ * ViSP, open source Visual Servoing Platform software.
+ * Copyright (C) 2005 - 2019 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test image sequence prefetching in vpVideoReader and vpDiskGrabber.
+ *
+ *****************************************************************************/
+
+#include <visp3/core/vpConfig.h>
+
+/*!
+  \example testVideoReaderPrefetch.cpp
+
+  \brief Test that reading an image sequence with background prefetching
+  returns the same frames as the synchronous reading.
+*/
+
+#if defined(VISP_HAVE_CATCH2)
+#define CATCH_CONFIG_RUNNER
+#include <catch.hpp>
+
+#include <visp3/core/vpIoTools.h>
+#include <visp3/io/vpDiskGrabber.h>
+#include <visp3/io/vpImageIo.h>
+#include <visp3/io/vpVideoReader.h>
+
+namespace
+{
+const long firstFrame = 1;
+const long lastFrame = 20;
+
+vpImage<unsigned char> createFrame(long index)
+{
+  vpImage<unsigned char> I(48, 64);
+  for (unsigned int i = 0; i < I.getHeight(); i++) {
+    for (unsigned int j = 0; j < I.getWidth(); j++) {
+      I[i][j] = static_cast<unsigned char>((index * 7 + i + 3 * j) % 256);
+    }
+  }
+  return I;
+}
+
+std::string createSequence()
+{
+#if defined(_WIN32)
+  std::string tmp_dir = "C:/temp/";
+#else
+  std::string tmp_dir = "/tmp/";
+#endif
+
+  // Get the user login name
+  std::string username;
+  vpIoTools::getUserName(username);
+  tmp_dir += username + "/testVideoReaderPrefetch/";
+  vpIoTools::makeDirectory(tmp_dir);
+
+  for (long index = firstFrame; index <= lastFrame; index++) {
+    char filename[FILENAME_MAX];
+    sprintf(filename, "image%04ld.pgm", index);
+    vpImageIo::write(createFrame(index), vpIoTools::createFilePath(tmp_dir, filename));
+  }
+
+  return tmp_dir;
+}
+
+void readSequence(vpVideoReader &reader, std::vector<long> &indexes, std::vector<vpImage<unsigned char> > &frames)
+{
+  vpImage<unsigned char> I;
+  reader.open(I);
+  while (!reader.end()) {
+    reader.acquire(I);
+    indexes.push_back(reader.getFrameIndex());
+    frames.push_back(I);
+  }
+}
+} // namespace
+
+TEST_CASE("Image sequence prefetching", "[io]")
+{
+  std::string tmp_dir = createSequence();
+  std::string generic_name = vpIoTools::createFilePath(tmp_dir, "image%04d.pgm");
+
+  SECTION("Sequence with frame step")
+  {
+    long steps[] = {1, 3};
+    for (size_t k = 0; k < sizeof(steps) / sizeof(steps[0]); k++) {
+      std::vector<long> indexes, indexes_prefetch;
+      std::vector<vpImage<unsigned char> > frames, frames_prefetch;
+
+      vpVideoReader reader;
+      reader.setFileName(generic_name);
+      reader.setFrameStep(steps[k]);
+      readSequence(reader, indexes, frames);
+
+      vpVideoReader reader_prefetch;
+      reader_prefetch.setFileName(generic_name);
+      reader_prefetch.setFrameStep(steps[k]);
+      reader_prefetch.setPrefetch(4, 2);
+      readSequence(reader_prefetch, indexes_prefetch, frames_prefetch);
+
+      REQUIRE(indexes.size() > 0);
+      REQUIRE(indexes == indexes_prefetch);
+      for (size_t i = 0; i < frames.size(); i++) {
+        CHECK((frames_prefetch[i] == createFrame(indexes[i])));
+        CHECK((frames[i] == frames_prefetch[i]));
+      }
+    }
+  }
+
+  SECTION("Random seek and backward step")
+  {
+    vpVideoReader reader, reader_prefetch;
+    reader.setFileName(generic_name);
+    reader_prefetch.setFileName(generic_name);
+    reader_prefetch.setPrefetch(3);
+    vpImage<unsigned char> I, I_prefetch;
+    reader.open(I);
+    reader_prefetch.open(I_prefetch);
+    CHECK((I_prefetch == createFrame(firstFrame)));
+
+    // Interleave seeks, forward and backward acquisitions
+    long seeks[] = {15, 3, 12};
+    long steps[] = {1, 1, -2};
+    for (size_t k = 0; k < sizeof(seeks) / sizeof(seeks[0]); k++) {
+      REQUIRE(reader_prefetch.getFrame(I_prefetch, seeks[k]));
+      CHECK((I_prefetch == createFrame(seeks[k])));
+      reader.getFrame(I, seeks[k]);
+      reader.setFrameStep(steps[k]);
+      reader_prefetch.setFrameStep(steps[k]);
+      for (int n = 0; n < 4; n++) {
+        reader.acquire(I);
+        reader_prefetch.acquire(I_prefetch);
+        CHECK(reader_prefetch.getFrameIndex() == reader.getFrameIndex());
+        CHECK((I_prefetch == I));
+        CHECK((I_prefetch == createFrame(reader.getFrameIndex())));
+      }
+    }
+  }
+
+  SECTION("Disk grabber with image type change and missing image")
+  {
+    vpDiskGrabber grabber(generic_name);
+    grabber.setPrefetch(4, 3);
+    CHECK(grabber.getPrefetchLookahead() == 4);
+    grabber.setImageNumber(firstFrame);
+    vpImage<unsigned char> I;
+    vpImage<vpRGBa> I_color;
+    for (long index = firstFrame; index < 6; index++) {
+      grabber.acquire(I);
+      CHECK(grabber.getImageNumber() == index);
+      CHECK((I == createFrame(index)));
+    }
+    grabber.acquire(I_color);
+    CHECK(grabber.getImageNumber() == 6);
+    vpImage<vpRGBa> I_color_ref;
+    vpImageConvert::convert(createFrame(6), I_color_ref);
+    CHECK((I_color == I_color_ref));
+
+    grabber.setImageNumber(lastFrame);
+    grabber.acquire(I);
+    CHECK((I == createFrame(lastFrame)));
+    CHECK_THROWS(grabber.acquire(I));
+
+    grabber.acquire(I, firstFrame);
+    CHECK((I == createFrame(firstFrame)));
+    grabber.acquire(I);
+    CHECK((I == createFrame(firstFrame + 1)));
+  }
+
+  vpIoTools::remove(tmp_dir);
+}
+
+int main(int argc, char *argv[])
+{
+  Catch::Session session; // There must be exactly one instance
+
+  // Let Catch (using Clara) parse the command line
+  session.applyCommandLine(argc, argv);
+
+  int numFailed = session.run();
+
+  // numFailed is clamped to 255 as some unices only use the lower 8 bits.
+  // This clamping has already been applied, so just return it here
+  // You can also do any post run clean-up here
+  return numFailed;
+}
+#else
+int main()
+{
+  return 0;
+}
+#endif
@@ -0,0 +1,311 @@
+/****************************************************************************
+ *
+ * ViSP, open source Visual Servoing Platform software.
+ * Copyright (C) 2005 - 2019 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Benchmark the text and binary framing of the vpNetwork requests.
+ *
+ *****************************************************************************/
+
+#include <visp3/core/vpConfig.h>
+
+/*!
+  \example perfNetworkFraming.cpp
+
+  \brief Benchmark the throughput of the text and binary framing of the
+  requests exchanged by vpClient and vpServer over the loopback interface.
+*/
+
+#if defined(VISP_HAVE_CATCH2) && defined(VISP_HAVE_FUNC_INET_NTOP) && (VISP_CXX_STANDARD >= VISP_CXX_STANDARD_11)
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+#define CATCH_CONFIG_RUNNER
+#include <catch.hpp>
+#include <thread>
+
+#include <visp3/core/vpClient.h>
+#include <visp3/core/vpHomogeneousMatrix.h>
+#include <visp3/core/vpImage.h>
+#include <visp3/core/vpServer.h>
+#include <visp3/core/vpTime.h>
+
+namespace
+{
+class vpRequestFrame : public vpRequest
+{
+public:
+  vpRequestFrame(vpImage<unsigned char> &I, vpHomogeneousMatrix &cMo) : m_I(I), m_cMo(cMo) { request_id = "frame"; }
+
+  virtual void encode()
+  {
+    clear();
+    unsigned int h = m_I.getHeight(), w = m_I.getWidth();
+    addParameterObject(&h);
+    addParameterObject(&w);
+    addParameterObject(m_I.bitmap, (int)m_I.getSize());
+    addParameterObject(m_cMo.data, (int)(16 * sizeof(double)));
+  }
+
+  virtual void decode()
+  {
+    if (size() == 4) {
+      unsigned int h, w;
+      memcpy(&h, listOfParams[0].c_str(), sizeof(h));
+      memcpy(&w, listOfParams[1].c_str(), sizeof(w));
+      m_I.resize(h, w);
+      memcpy(m_I.bitmap, listOfParams[2].c_str(), m_I.getSize());
+      memcpy(m_cMo.data, listOfParams[3].c_str(), 16 * sizeof(double));
+    }
+  }
+
+private:
+  vpImage<unsigned char> &m_I;
+  vpHomogeneousMatrix &m_cMo;
+};
+
+void sendFrames(vpClient *client, vpRequestFrame *req, unsigned int nbFrames)
+{
+  for (unsigned int i = 0; i < nbFrames; i++) {
+    client->sendAndEncodeRequest(*req);
+  }
+}
+
+unsigned int receiveFrames(vpServer &server, unsigned int nbFrames)
+{
+  unsigned int nbReceived = 0;
+  while (nbReceived < nbFrames && server.getNumberOfClients() > 0) {
+    if (server.receiveAndDecodeRequestOnce() != -1) {
+      nbReceived++;
+    }
+  }
+  return nbReceived;
+}
+
+void runFraming(vpNetwork::vpFramingType framing, int port, const std::string &name)
+{
+  const unsigned int nbFrames = 20;
+
+  vpServer server(port);
+  server.setFramingType(framing);
+  REQUIRE(server.start());
+
+  vpClient client;
+  client.setFramingType(framing);
+  REQUIRE(client.connectToHostname("localhost", (unsigned int)port));
+  while (server.getNumberOfClients() == 0) {
+    server.checkForConnections();
+  }
+
+  // Gradient image, so that the text markers can't appear in the parameters
+  vpImage<unsigned char> I(480, 640);
+  for (unsigned int i = 0; i < I.getHeight(); i++) {
+    for (unsigned int j = 0; j < I.getWidth(); j++) {
+      I[i][j] = (unsigned char)((i + j) % 200);
+    }
+  }
+  vpHomogeneousMatrix cMo(0.1, 0.2, 0.5, 0.1, 0.2, 0.3);
+  vpRequestFrame reqSend(I, cMo);
+
+  vpImage<unsigned char> I_received;
+  vpHomogeneousMatrix cMo_received;
+  vpRequestFrame reqReceive(I_received, cMo_received);
+  server.addDecodingRequest(&reqReceive);
+
+  std::thread sender(sendFrames, &client, &reqSend, 1);
+  CHECK(receiveFrames(server, 1) == 1);
+  sender.join();
+  CHECK((I_received == I));
+  CHECK(cMo_received == cMo);
+
+  BENCHMARK(name.c_str())
+  {
+    std::thread thread(sendFrames, &client, &reqSend, nbFrames);
+    unsigned int nbReceived = receiveFrames(server, nbFrames);
+    thread.join();
+    return nbReceived;
+  };
+}
+
+// Binary frame of a request with a single parameter, announcing paramSize bytes
+std::string createFrame(const std::string &id, uint32_t paramSize, const std::string &param)
+{
+  uint32_t header[4] = {htonl(0x56504e46), htonl((uint32_t)id.size()), htonl(1), htonl(paramSize)};
+  return std::string((const char *)header, sizeof(header)) + id + param;
+}
+
+class vpRequestString : public vpRequest
+{
+public:
+  vpRequestString() { request_id = "string"; }
+  virtual void encode() {}
+  virtual void decode() {}
+};
+} // namespace
+
+TEST_CASE("Binary framing of partial and invalid frames", "[network]")
+{
+  const int port = 35102;
+  vpServer server(port);
+  server.setFramingType(vpNetwork::BINARY_FRAMING);
+  server.setMaxSizeReceivedMessage(1000);
+  REQUIRE(server.start());
+  vpRequestString req;
+  server.addDecodingRequest(&req);
+
+  vpClient client;
+  REQUIRE(client.connectToHostname("localhost", (unsigned int)port));
+  while (server.getNumberOfClients() == 0) {
+    server.checkForConnections();
+  }
+
+  // The receive functions don't wait for the end of a partially sent frame
+  std::string param(600, 'a');
+  std::string frame = createFrame("string", (uint32_t)param.size(), param);
+  CHECK(client.send(&frame[0], 200) == 200);
+  double t = vpTime::measureTimeMs();
+  for (int i = 0; i < 10; i++) {
+    CHECK(server.receiveAndDecodeRequestOnce() == -1);
+  }
+  CHECK(vpTime::measureTimeMs() - t < 1000.);
+  CHECK(client.send(&frame[200], (unsigned int)frame.size() - 200) == (int)frame.size() - 200);
+  int index = -1;
+  for (int i = 0; i < 1000 && index == -1; i++) {
+    index = server.receiveAndDecodeRequestOnce();
+  }
+  REQUIRE(index == 0);
+  REQUIRE(req.size() == 1);
+  CHECK(req[0] == param);
+
+  // A frame larger than the maximum size disconnects the client before being allocated
+  frame = createFrame("string", 0x7fffffff, "");
+  CHECK(client.send(&frame[0], (unsigned int)frame.size()) == (int)frame.size());
+  for (int i = 0; i < 1000 && server.getNumberOfClients() > 0; i++) {
+    CHECK(server.receiveAndDecodeRequestOnce() == -1);
+  }
+  CHECK(server.getNumberOfClients() == 0);
+}
+
+TEST_CASE("Binary framing of frames interleaved between clients", "[network]")
+{
+  const int port = 35103;
+  vpServer server(port);
+  server.setFramingType(vpNetwork::BINARY_FRAMING);
+  server.setMaxSizeReceivedMessage(1000);
+  REQUIRE(server.start());
+  vpRequestString req;
+  server.addDecodingRequest(&req);
+
+  vpClient client1, client2;
+  REQUIRE(client1.connectToHostname("localhost", (unsigned int)port));
+  REQUIRE(client2.connectToHostname("localhost", (unsigned int)port));
+  while (server.getNumberOfClients() < 2) {
+    server.checkForConnections();
+  }
+
+  std::string param1(600, 'a'), param2(600, 'b');
+  std::string frame1 = createFrame("string", (uint32_t)param1.size(), param1);
+  std::string frame2 = createFrame("string", (uint32_t)param2.size(), param2);
+
+  // The first client starts a frame, whose end is then read straight from its socket
+  CHECK(client1.send(&frame1[0], 200) == 200);
+  for (int i = 0; i < 10; i++) {
+    CHECK(server.receiveAndDecodeRequestOnce() == -1);
+  }
+
+  // A frame of the same request sent by the second client doesn't abandon the first one
+  CHECK(client2.send(&frame2[0], (unsigned int)frame2.size()) == (int)frame2.size());
+  int index = -1;
+  for (int i = 0; i < 1000 && index == -1; i++) {
+    index = server.receiveAndDecodeRequestOnce();
+  }
+  REQUIRE(index == 0);
+  CHECK(req[0] == param2);
+
+  // A partial header of the second client isn't continued by the bytes of the first client
+  CHECK(client2.send(&frame2[0], 10) == 10);
+  for (int i = 0; i < 10; i++) {
+    CHECK(server.receiveAndDecodeRequestOnce() == -1);
+  }
+  CHECK(client1.send(&frame1[200], (unsigned int)frame1.size() - 200) == (int)frame1.size() - 200);
+  index = -1;
+  for (int i = 0; i < 1000 && index == -1; i++) {
+    index = server.receiveAndDecodeRequestOnce();
+  }
+  REQUIRE(index == 0);
+  CHECK(req[0] == param1);
+
+  CHECK(client2.send(&frame2[10], (unsigned int)frame2.size() - 10) == (int)frame2.size() - 10);
+  index = -1;
+  for (int i = 0; i < 1000 && index == -1; i++) {
+    index = server.receiveAndDecodeRequestOnce();
+  }
+  REQUIRE(index == 0);
+  CHECK(req[0] == param2);
+  CHECK(server.getNumberOfClients() == 2);
+}
+
+TEST_CASE("Benchmark vpNetwork framing", "[benchmark]")
+{
+  runFraming(vpNetwork::TEXT_FRAMING, 35100, "Text framing, 20 VGA images");
+  runFraming(vpNetwork::BINARY_FRAMING, 35101, "Binary framing, 20 VGA images");
+}
+
+int main(int argc, char *argv[])
+{
+  Catch::Session session; // There must be exactly one instance
+
+  bool runBenchmark = false;
+  // Build a new parser on top of Catch's
+  using namespace Catch::clara;
+  auto cli = session.cli() // Get Catch's composite command line parser
+    | Opt(runBenchmark)    // bind variable to a new option, with a hint string
+    ["--benchmark"]        // the option names it will respond to
+    ("run benchmark?");    // description string for the help output
+
+  // Now pass the new composite back to Catch so it uses that
+  session.cli(cli);
+
+  // Let Catch (using Clara) parse the command line
+  session.applyCommandLine(argc, argv);
+
+  if (!runBenchmark) {
+    session.configData().testsOrTags.push_back("~[benchmark]");
+  }
+  int numFailed = session.run();
+
+  // numFailed is clamped to 255 as some unices only use the lower 8 bits.
+  // This clamping has already been applied, so just return it here
+  // You can also do any post run clean-up here
+  return numFailed;
+}
+#else
+int main()
+{
+  return 0;
+}
+#endif
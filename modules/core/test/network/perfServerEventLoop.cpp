@@ -0,0 +1,220 @@
+/****************************************************************************
+ *
+ * ViSP, open source Visual Servoing Platform software.
+ * Copyright (C) 2005 - 2019 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Benchmark the event loop of vpServer against its select() based receive.
+ *
+ *****************************************************************************/
+
+#include <visp3/core/vpConfig.h>
+
+/*!
+  \example perfServerEventLoop.cpp
+
+  \brief Benchmark the reception of the requests sent by many clients over
+  the loopback interface, with vpServer::processEvents() and with
+  vpNetwork::receiveAndDecodeRequestOnce().
+*/
+
+#if defined(VISP_HAVE_CATCH2) && defined(VISP_HAVE_FUNC_INET_NTOP) && defined(__linux__) &&                          \
+    (VISP_CXX_STANDARD >= VISP_CXX_STANDARD_11)
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+#define CATCH_CONFIG_RUNNER
+#include <catch.hpp>
+#include <thread>
+
+#include <visp3/core/vpClient.h>
+#include <visp3/core/vpHomogeneousMatrix.h>
+#include <visp3/core/vpServer.h>
+#include <visp3/core/vpTime.h>
+
+namespace
+{
+const unsigned int nbClients = 32;
+const unsigned int nbRounds = 20;
+
+class vpRequestPose : public vpRequest
+{
+public:
+  explicit vpRequestPose(vpHomogeneousMatrix &cMo) : m_cMo(cMo) { request_id = "pose"; }
+
+  virtual void encode()
+  {
+    clear();
+    addParameterObject(m_cMo.data, (int)(16 * sizeof(double)));
+  }
+
+  virtual void decode()
+  {
+    if (size() == 1) {
+      memcpy(m_cMo.data, listOfParams[0].c_str(), 16 * sizeof(double));
+    }
+  }
+
+private:
+  vpHomogeneousMatrix &m_cMo;
+};
+
+void countRequest(vpRequest &, unsigned int client, void *data)
+{
+  std::vector<unsigned int> &nbReceived = *static_cast<std::vector<unsigned int> *>(data);
+  nbReceived[client]++;
+}
+
+void sendPoses(std::vector<vpClient *> *clients, vpRequestPose *req)
+{
+  for (unsigned int r = 0; r < nbRounds; r++) {
+    for (size_t c = 0; c < clients->size(); c++) {
+      (*clients)[c]->sendAndEncodeRequest(*req);
+    }
+  }
+}
+
+void connectClients(vpServer &server, int port, std::vector<vpClient *> &clients, bool eventLoop)
+{
+  unsigned int maxClients = nbClients;
+  server.setMaxNumberOfClients(maxClients);
+  REQUIRE(server.start());
+  for (unsigned int i = 0; i < nbClients; i++) {
+    clients.push_back(new vpClient());
+    REQUIRE(clients.back()->connectToHostname("localhost", (unsigned int)port));
+  }
+
+  double t_start = vpTime::measureTimeMs();
+  while (server.getNumberOfClients() < nbClients && vpTime::measureTimeMs() - t_start < 5000.) {
+    if (eventLoop)
+      server.processEvents(10);
+    else
+      server.checkForConnections();
+  }
+  REQUIRE(server.getNumberOfClients() == nbClients);
+}
+} // namespace
+
+TEST_CASE("Benchmark vpServer event loop", "[benchmark]")
+{
+  const unsigned int nbRequests = nbClients * nbRounds;
+  vpHomogeneousMatrix cMo(0.1, 0.2, 0.5, 0.1, 0.2, 0.3), cMo_received;
+  vpRequestPose reqSend(cMo);
+
+  SECTION("select() and one request per call")
+  {
+    vpServer server(35110);
+    std::vector<vpClient *> clients;
+    connectClients(server, 35110, clients, false);
+    vpRequestPose reqReceive(cMo_received);
+    server.addDecodingRequest(&reqReceive);
+
+    BENCHMARK("receiveAndDecodeRequestOnce(), 32 clients")
+    {
+      std::thread sender(sendPoses, &clients, &reqSend);
+      unsigned int nbReceived = 0;
+      double t_start = vpTime::measureTimeMs();
+      while (nbReceived < nbRequests && vpTime::measureTimeMs() - t_start < 10000.) {
+        if (server.receiveAndDecodeRequestOnce() != -1)
+          nbReceived++;
+      }
+      sender.join();
+      return nbReceived;
+    };
+    CHECK(cMo_received == cMo);
+
+    for (size_t i = 0; i < clients.size(); i++)
+      delete clients[i];
+  }
+
+  SECTION("epoll() event loop")
+  {
+    vpServer server(35111);
+    std::vector<vpClient *> clients;
+    connectClients(server, 35111, clients, true);
+    vpRequestPose reqReceive(cMo_received);
+    server.addDecodingRequest(&reqReceive);
+    std::vector<unsigned int> nbReceivedPerClient(nbClients, 0);
+    server.setRequestHandler(countRequest, &nbReceivedPerClient);
+
+    BENCHMARK("processEvents(), 32 clients")
+    {
+      std::thread sender(sendPoses, &clients, &reqSend);
+      int nbReceived = 0;
+      double t_start = vpTime::measureTimeMs();
+      while (nbReceived < (int)nbRequests && vpTime::measureTimeMs() - t_start < 10000.) {
+        int res = server.processEvents(10);
+        if (res > 0)
+          nbReceived += res;
+      }
+      sender.join();
+      return nbReceived;
+    };
+    CHECK(cMo_received == cMo);
+    for (unsigned int i = 1; i < nbClients; i++) {
+      CHECK(nbReceivedPerClient[i] == nbReceivedPerClient[0]);
+    }
+
+    for (size_t i = 0; i < clients.size(); i++)
+      delete clients[i];
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  Catch::Session session; // There must be exactly one instance
+
+  bool runBenchmark = false;
+  // Build a new parser on top of Catch's
+  using namespace Catch::clara;
+  auto cli = session.cli() // Get Catch's composite command line parser
+    | Opt(runBenchmark)    // bind variable to a new option, with a hint string
+    ["--benchmark"]        // the option names it will respond to
+    ("run benchmark?");    // description string for the help output
+
+  // Now pass the new composite back to Catch so it uses that
+  session.cli(cli);
+
+  // Let Catch (using Clara) parse the command line
+  session.applyCommandLine(argc, argv);
+
+  if (runBenchmark) {
+    int numFailed = session.run();
+
+    // numFailed is clamped to 255 as some unices only use the lower 8 bits.
+    // This clamping has already been applied, so just return it here
+    // You can also do any post run clean-up here
+    return numFailed;
+  }
+
+  return EXIT_SUCCESS;
+}
+#else
+int main()
+{
+  return 0;
+}
+#endif
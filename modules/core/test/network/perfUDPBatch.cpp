@@ -0,0 +1,209 @@
+/****************************************************************************
+ *
+ * ViSP, open source Visual Servoing Platform software.
+ * Copyright (C) 2005 - 2019 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Benchmark the batched UDP send and receive.
+ *
+ *****************************************************************************/
+
+#include <visp3/core/vpConfig.h>
+
+/*!
+  \example perfUDPBatch.cpp
+
+  \brief Benchmark the number of UDP datagrams per second exchanged by
+  vpUDPClient and vpUDPServer over the loopback interface, one datagram per
+  call or with vpUDPBatch.
+*/
+
+#if defined(VISP_HAVE_CATCH2) && defined(VISP_HAVE_FUNC_INET_NTOP) && (VISP_CXX_STANDARD >= VISP_CXX_STANDARD_11)
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+#define CATCH_CONFIG_RUNNER
+#include <catch.hpp>
+#include <cstring>
+#include <iostream>
+
+#include <visp3/core/vpTime.h>
+#include <visp3/core/vpUDPClient.h>
+#include <visp3/core/vpUDPServer.h>
+
+namespace
+{
+// Force-torque sample: timestamp and 6 values
+struct vpSample {
+  double timestamp;
+  double wrench[6];
+};
+
+const unsigned int burstSize = 32;
+const unsigned int nbBursts = 200;
+
+unsigned int exchangeStrings(vpUDPClient &client, vpUDPServer &server)
+{
+  vpSample sample;
+  memset(&sample, 0, sizeof(sample));
+  std::string msg;
+  unsigned int nbReceived = 0;
+  for (unsigned int i = 0; i < nbBursts; i++) {
+    for (unsigned int j = 0; j < burstSize; j++) {
+      sample.timestamp = i * burstSize + j;
+      client.send(&sample, sizeof(sample));
+    }
+    for (unsigned int j = 0; j < burstSize; j++) {
+      if (server.receive(msg, 1000) > 0) {
+        nbReceived++;
+      }
+    }
+  }
+  return nbReceived;
+}
+
+unsigned int exchangeBatches(vpUDPClient &client, vpUDPServer &server, vpUDPBatch &sent, vpUDPBatch &received)
+{
+  vpSample sample;
+  memset(&sample, 0, sizeof(sample));
+  unsigned int nbReceived = 0;
+  for (unsigned int i = 0; i < nbBursts; i++) {
+    sent.clear();
+    for (unsigned int j = 0; j < burstSize; j++) {
+      sample.timestamp = i * burstSize + j;
+      sent.push(&sample, sizeof(sample));
+    }
+    client.send(sent);
+    for (unsigned int j = 0; j < burstSize;) {
+      int nb = server.receive(received, 1000);
+      if (nb <= 0) {
+        break;
+      }
+      j += static_cast<unsigned int>(nb);
+      nbReceived += static_cast<unsigned int>(nb);
+    }
+  }
+  return nbReceived;
+}
+} // namespace
+
+TEST_CASE("Batch of datagrams", "[benchmark]")
+{
+  const int port = 35120;
+  vpUDPServer server(port);
+  vpUDPClient client("127.0.0.1", port);
+  vpUDPBatch sent(burstSize), received(burstSize);
+
+  // Check the content, the sender and the timestamps of a batch
+  vpSample sample;
+  memset(&sample, 0, sizeof(sample));
+  double t0 = vpTime::measureTimeMs();
+  for (unsigned int i = 0; i < burstSize; i++) {
+    sample.timestamp = i;
+    sent.push(&sample, sizeof(sample));
+  }
+  CHECK(client.send(sent) == static_cast<int>(burstSize));
+  unsigned int nbReceived = 0;
+  while (nbReceived < burstSize) {
+    REQUIRE(server.receive(received, 1000) > 0);
+    for (unsigned int i = 0; i < received.size(); i++, nbReceived++) {
+      REQUIRE(received.getLength(i) == sizeof(sample));
+      vpSample sample_received;
+      memcpy(&sample_received, received.getData(i), sizeof(sample_received));
+      CHECK(sample_received.timestamp == nbReceived);
+      CHECK(received.getHostIp(i) == "127.0.0.1");
+      CHECK(received.getTimestamp(i) >= t0 - 1.);
+      CHECK(received.getTimestamp(i) <= vpTime::measureTimeMs() + 1.);
+    }
+  }
+
+  // Echo the batch with the addresses of the senders
+  sent.clear();
+  for (unsigned int i = 0; i < received.size(); i++) {
+    sent.push(received.getData(i), received.getLength(i), received.getAddress(i));
+  }
+  CHECK(server.send(sent) == static_cast<int>(sent.size()));
+  std::string msg;
+  CHECK(client.receive(msg, 1000) == static_cast<int>(sizeof(sample)));
+
+  // The string API still works on top of the batches
+  while (client.receive(received, 10) > 0) {
+  }
+  CHECK(client.send("ping") == 4);
+  std::string hostInfo;
+  CHECK(server.receive(msg, hostInfo, 1000) == 4);
+  CHECK(msg == "ping");
+
+  const unsigned int nbMessages = nbBursts * burstSize;
+  double t = vpTime::measureTimeMs();
+  CHECK(exchangeStrings(client, server) == nbMessages);
+  double tStrings = vpTime::measureTimeMs() - t;
+  t = vpTime::measureTimeMs();
+  CHECK(exchangeBatches(client, server, sent, received) == nbMessages);
+  double tBatches = vpTime::measureTimeMs() - t;
+  std::cout << "One datagram per call: " << nbMessages / tStrings * 1000. << " messages/s" << std::endl;
+  std::cout << "Batches of " << burstSize << " datagrams: " << nbMessages / tBatches * 1000. << " messages/s"
+            << std::endl;
+
+  BENCHMARK("One datagram per call") { return exchangeStrings(client, server); };
+  BENCHMARK("Batches of datagrams") { return exchangeBatches(client, server, sent, received); };
+}
+
+int main(int argc, char *argv[])
+{
+  Catch::Session session; // There must be exactly one instance
+
+  bool runBenchmark = false;
+  // Build a new parser on top of Catch's
+  using namespace Catch::clara;
+  auto cli = session.cli() // Get Catch's composite command line parser
+    | Opt(runBenchmark)    // bind variable to a new option, with a hint string
+    ["--benchmark"]        // the option names it will respond to
+    ("run benchmark?");    // description string for the help output
+
+  // Now pass the new composite back to Catch so it uses that
+  session.cli(cli);
+
+  // Let Catch (using Clara) parse the command line
+  session.applyCommandLine(argc, argv);
+
+  if (runBenchmark) {
+    int numFailed = session.run();
+
+    // numFailed is clamped to 255 as some unices only use the lower 8 bits.
+    // This clamping has already been applied, so just return it here
+    // You can also do any post run clean-up here
+    return numFailed;
+  }
+
+  return EXIT_SUCCESS;
+}
+#else
+int main()
+{
+  return 0;
+}
+#endif
@@ -0,0 +1,178 @@
+/****************************************************************************
+ *
+ * ViSP, open source Visual Servoing Platform software.
+ * Copyright (C) 2005 - 2019 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test vpPointCloud.
+ *
+ *****************************************************************************/
+
+#include <visp3/core/vpConfig.h>
+
+/*!
+  \example testPointCloud.cpp
+
+  \brief Test organized point cloud storages.
+*/
+
+#if defined(VISP_HAVE_CATCH2)
+#define CATCH_CONFIG_RUNNER
+#include <catch.hpp>
+#include <visp3/core/vpPixelMeterConversion.h>
+#include <visp3/core/vpPointCloud.h>
+
+namespace
+{
+void fillDepth(vpImage<uint16_t> &I_depth_raw)
+{
+  for (unsigned int i = 0; i < I_depth_raw.getHeight(); i++) {
+    for (unsigned int j = 0; j < I_depth_raw.getWidth(); j++) {
+      // Every 7th pixel has no depth
+      I_depth_raw[i][j] = (i * I_depth_raw.getWidth() + j) % 7 == 0 ? 0 : static_cast<uint16_t>(500 + i + 3 * j);
+    }
+  }
+}
+}
+
+TEST_CASE("Point cloud from raw depth map", "[point_cloud]")
+{
+  vpImage<uint16_t> I_depth_raw(48, 64);
+  fillDepth(I_depth_raw);
+  vpCameraParameters cam(60.0, 62.0, 31.5, 23.5);
+  const float depth_scale = 0.001f;
+
+  vpPointCloud point_cloud;
+  point_cloud.buildFrom(I_depth_raw, cam, depth_scale);
+  CHECK(point_cloud.getStorageType() == vpPointCloud::DEPTH_UINT16_STORAGE);
+  CHECK(point_cloud.getData() == NULL);
+  CHECK(point_cloud.getWidth() == I_depth_raw.getWidth());
+  CHECK(point_cloud.getHeight() == I_depth_raw.getHeight());
+
+  for (unsigned int i = 0; i < I_depth_raw.getHeight(); i++) {
+    for (unsigned int j = 0; j < I_depth_raw.getWidth(); j++) {
+      float X = 0, Y = 0, Z = 0;
+      bool valid = point_cloud.getPoint(i, j, X, Y, Z);
+      CHECK(valid == (I_depth_raw[i][j] > 0));
+      CHECK(point_cloud.getZ(i, j) == Approx(Z));
+
+      if (valid) {
+        double x = 0, y = 0;
+        vpPixelMeterConversion::convertPoint(cam, j, i, x, y);
+        double Z_ref = depth_scale * I_depth_raw[i][j];
+        CHECK(Z == Approx(Z_ref));
+        CHECK(X == Approx(x * Z_ref).margin(1e-6));
+        CHECK(Y == Approx(y * Z_ref).margin(1e-6));
+      }
+    }
+  }
+
+  SECTION("Conversion to and from the legacy representation")
+  {
+    std::vector<vpColVector> pointcloud_vec;
+    point_cloud.toVector(pointcloud_vec);
+    REQUIRE(pointcloud_vec.size() == I_depth_raw.getSize());
+
+    vpPointCloud point_cloud_xyz;
+    point_cloud_xyz.buildFrom(pointcloud_vec, I_depth_raw.getWidth(), I_depth_raw.getHeight());
+    CHECK(point_cloud_xyz.getStorageType() == vpPointCloud::XYZ_STORAGE);
+    CHECK(point_cloud_xyz.getStride() == 3 * I_depth_raw.getWidth());
+
+    for (unsigned int i = 0; i < I_depth_raw.getHeight(); i++) {
+      for (unsigned int j = 0; j < I_depth_raw.getWidth(); j++) {
+        float X1 = 0, Y1 = 0, Z1 = 0, X2 = 0, Y2 = 0, Z2 = 0;
+        CHECK(point_cloud.getPoint(i, j, X1, Y1, Z1) == point_cloud_xyz.getPoint(i, j, X2, Y2, Z2));
+        CHECK(X1 == X2);
+        CHECK(Y1 == Y2);
+        CHECK(Z1 == Z2);
+      }
+    }
+  }
+}
+
+TEST_CASE("Point cloud wrapping an external buffer", "[point_cloud]")
+{
+  const unsigned int height = 4, width = 5, stride = 3 * width + 2;
+  std::vector<float> buffer(height * stride, -1.0f);
+  for (unsigned int i = 0; i < height; i++) {
+    for (unsigned int j = 0; j < width; j++) {
+      buffer[i * stride + 3 * j] = static_cast<float>(j);
+      buffer[i * stride + 3 * j + 1] = static_cast<float>(i);
+      buffer[i * stride + 3 * j + 2] = static_cast<float>(i + j);
+    }
+  }
+
+  vpPointCloud point_cloud(&buffer[0], height, width, stride);
+  CHECK(point_cloud.getData() == &buffer[0]);
+
+  float X = 0, Y = 0, Z = 0;
+  CHECK_FALSE(point_cloud.getPoint(0, 0, X, Y, Z));
+  CHECK(point_cloud.getPoint(3, 4, X, Y, Z));
+  CHECK(X == 4.0f);
+  CHECK(Y == 3.0f);
+  CHECK(Z == 7.0f);
+
+  SECTION("Copy shares the external buffer")
+  {
+    vpPointCloud point_cloud_copy(point_cloud);
+    CHECK(point_cloud_copy.getData() == &buffer[0]);
+  }
+
+  SECTION("Copy deep copies owned data")
+  {
+    vpPointCloud point_cloud_owned(height, width);
+    point_cloud_owned.setPoint(1, 2, 1.0f, 2.0f, 3.0f);
+    vpPointCloud point_cloud_copy = point_cloud_owned;
+    CHECK(point_cloud_copy.getData() != point_cloud_owned.getData());
+    CHECK(point_cloud_copy.getPoint(1, 2, X, Y, Z));
+    CHECK(Z == 3.0f);
+  }
+
+  CHECK_THROWS(vpPointCloud(&buffer[0], height, width, 3 * width - 1));
+}
+
+int main(int argc, char *argv[])
+{
+  Catch::Session session; // There must be exactly one instance
+
+  // Let Catch (using Clara) parse the command line
+  session.applyCommandLine(argc, argv);
+
+  int numFailed = session.run();
+
+  // numFailed is clamped to 255 as some unices only use the lower 8 bits.
+  // This clamping has already been applied, so just return it here
+  // You can also do any post run clean-up here
+  return numFailed;
+}
+#else
+int main()
+{
+  return 0;
+}
+#endif
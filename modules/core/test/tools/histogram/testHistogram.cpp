@@ -41,6 +41,7 @@
 #include <visp3/core/vpHistogram.h>
 #include <visp3/core/vpImage.h>
 #include <visp3/core/vpIoTools.h>
+#include <visp3/core/vpRect.h>
 #include <visp3/io/vpImageIo.h>
 #include <visp3/io/vpParseArgv.h>
 
@@ -197,6 +198,43 @@ bool compareHistogram(const vpImage<unsigned char> &I, unsigned int nbBins)
   return true;
 }
 
+/*!
+  Compare the histogram of a region of interest of an image computed with a
+  mask to the histogram computed pixel by pixel.
+
+  \param I : Input image.
+  \param mask : Mask of the pixels to count.
+  \param roi : Region of interest.
+  \param nbBins : Number of histogram bins.
+  \param nbThreads : Number of computation threads.
+*/
+bool compareMaskedHistogram(const vpImage<unsigned char> &I, const vpImage<bool> &mask, const vpRect &roi,
+                            unsigned int nbBins, unsigned int nbThreads)
+{
+  std::vector<unsigned int> reference(nbBins, 0);
+  for (unsigned int i = 0; i < I.getHeight(); i++) {
+    for (unsigned int j = 0; j < I.getWidth(); j++) {
+      if (mask[i][j] && roi.isInside(vpImagePoint(i, j))) {
+        reference[(unsigned int)(I[i][j] * nbBins / 256.0)]++;
+      }
+    }
+  }
+
+  vpHistogram histogram;
+  histogram.setMask(&mask);
+  histogram.calculate(I, roi, nbBins, nbThreads);
+
+  for (unsigned int cpt = 0; cpt < nbBins; cpt++) {
+    if (histogram[cpt] != reference[cpt]) {
+      std::cerr << "histogram[" << cpt << "]=" << histogram[cpt] << " ; reference[" << cpt << "]=" << reference[cpt]
+                << std::endl;
+      return false;
+    }
+  }
+
+  return true;
+}
+
 int main(int argc, const char **argv)
 {
   try {
@@ -234,6 +272,24 @@ int main(int argc, const char **argv)
       }
     }
 
+    // Test histogram computation with a mask and a region of interest
+    vpImage<unsigned char> I_synthetic(240, 320);
+    vpImage<bool> mask(I_synthetic.getHeight(), I_synthetic.getWidth());
+    for (unsigned int i = 0; i < I_synthetic.getHeight(); i++) {
+      for (unsigned int j = 0; j < I_synthetic.getWidth(); j++) {
+        I_synthetic[i][j] = static_cast<unsigned char>((i * 7 + j * 13 + (i * j) % 31) % 256);
+        mask[i][j] = ((i / 7 + j / 5) % 3) != 0;
+      }
+    }
+    vpRect roi(13, 21, I_synthetic.getWidth() / 2, I_synthetic.getHeight() / 3);
+    vpRect image_rect(0, 0, I_synthetic.getWidth(), I_synthetic.getHeight());
+    if (!compareMaskedHistogram(I_synthetic, mask, roi, 256, 1) ||
+        !compareMaskedHistogram(I_synthetic, mask, roi, 101, nbThreads) ||
+        !compareMaskedHistogram(I_synthetic, mask, image_rect, 256, nbThreads)) {
+      std::cerr << "Problem with the histogram computation with a mask!" << std::endl;
+      return -1;
+    }
+
     // Test if an input path is set
     if (opt_ipath.empty() && env_ipath.empty()) {
       usage(argv[0], NULL, ipath);
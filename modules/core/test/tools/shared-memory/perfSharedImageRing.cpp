@@ -0,0 +1,197 @@
+/****************************************************************************
+ *
+ * ViSP, open source Visual Servoing Platform software.
+ * Copyright (C) 2005 - 2019 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Benchmark the ring buffer of images in shared memory.
+ *
+ *****************************************************************************/
+
+#include <visp3/core/vpConfig.h>
+
+/*!
+  \example perfSharedImageRing.cpp
+
+  \brief Benchmark the hand-off of images between two processes through
+  vpSharedImageRing.
+*/
+
+#include <visp3/core/vpSharedImageRing.h>
+
+#if defined(VISP_HAVE_CATCH2) && !defined(_WIN32) &&                                                                   \
+    (defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))) &&                             \
+    (VISP_CXX_STANDARD >= VISP_CXX_STANDARD_11)
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+#define CATCH_CONFIG_RUNNER
+#include <catch.hpp>
+#include <sstream>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <visp3/core/vpIoTools.h>
+#include <visp3/core/vpTime.h>
+
+namespace
+{
+std::string ringName(const std::string &suffix)
+{
+  std::string username;
+  vpIoTools::getUserName(username);
+  std::stringstream ss;
+  ss << "/perfSharedImageRing_" << username << "_" << getpid() << "_" << suffix;
+  return ss.str();
+}
+
+// Send back the index of each frame received on the ping ring
+void pong(const std::string &ping_name, const std::string &pong_name)
+{
+  vpSharedImageRing ring_ping, ring_pong;
+  ring_ping.open(ping_name);
+  ring_pong.create<unsigned char>(pong_name, 2, 1, 1, 8);
+  vpImage<unsigned char> I, I_pong(1, 1);
+  while (ring_ping.waitForFrame(5000.)) {
+    ring_ping.acquire(I, true);
+    if (ring_ping.getMetadata() == "quit") {
+      break;
+    }
+    ring_pong.write(I_pong, static_cast<double>(ring_ping.getFrameIndex()));
+  }
+}
+} // namespace
+
+TEST_CASE("Benchmark vpSharedImageRing", "[benchmark]")
+{
+  const std::string ping_name = ringName("ping");
+  const std::string pong_name = ringName("pong");
+  vpImage<unsigned char> I(480, 640, 128), I_read;
+
+  vpSharedImageRing ring_ping;
+  ring_ping.create<unsigned char>(ping_name, 4, 480, 640, 8);
+
+  SECTION("Within a process")
+  {
+    vpSharedImageRing consumer;
+    consumer.open(ping_name);
+
+    BENCHMARK("Write a VGA image")
+    {
+      ring_ping.write(I, 0.);
+      return ring_ping.getNbWrittenFrames();
+    };
+
+    BENCHMARK("Acquire a VGA image without copy")
+    {
+      ring_ping.write(I, 0.);
+      return consumer.acquire(I_read);
+    };
+
+    BENCHMARK("Read a VGA image")
+    {
+      ring_ping.write(I, 0.);
+      return consumer.read(I_read);
+    };
+  }
+
+  SECTION("Between two processes")
+  {
+    pid_t pid = fork();
+    REQUIRE(pid != -1);
+    if (pid == 0) {
+      int status = EXIT_SUCCESS;
+      try {
+        pong(ping_name, pong_name);
+      } catch (...) {
+        status = EXIT_FAILURE;
+      }
+      _exit(status);
+    }
+
+    vpSharedImageRing ring_pong;
+    bool opened = false;
+    for (unsigned int i = 0; i < 1000 && !opened; i++) {
+      try {
+        ring_pong.open(pong_name);
+        opened = true;
+      } catch (const vpException &) {
+        vpTime::sleepMs(1);
+      }
+    }
+    REQUIRE(opened);
+
+    vpImage<unsigned char> I_pong;
+    BENCHMARK("Round trip of a VGA image and its acknowledgment")
+    {
+      ring_ping.write(I, 0.);
+      ring_pong.waitForFrame(1000.);
+      return ring_pong.acquire(I_pong, true);
+    };
+
+    ring_ping.write(I, 0., "quit");
+    int status;
+    waitpid(pid, &status, 0);
+    CHECK(WIFEXITED(status));
+    CHECK(WEXITSTATUS(status) == EXIT_SUCCESS);
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  Catch::Session session; // There must be exactly one instance
+
+  bool runBenchmark = false;
+  // Build a new parser on top of Catch's
+  using namespace Catch::clara;
+  auto cli = session.cli() // Get Catch's composite command line parser
+    | Opt(runBenchmark)    // bind variable to a new option, with a hint string
+    ["--benchmark"]        // the option names it will respond to
+    ("run benchmark?");    // description string for the help output
+
+  // Now pass the new composite back to Catch so it uses that
+  session.cli(cli);
+
+  // Let Catch (using Clara) parse the command line
+  session.applyCommandLine(argc, argv);
+
+  if (runBenchmark) {
+    int numFailed = session.run();
+
+    // numFailed is clamped to 255 as some unices only use the lower 8 bits.
+    // This clamping has already been applied, so just return it here
+    // You can also do any post run clean-up here
+    return numFailed;
+  }
+
+  return EXIT_SUCCESS;
+}
+#else
+int main()
+{
+  return 0;
+}
+#endif
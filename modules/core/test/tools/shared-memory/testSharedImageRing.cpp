@@ -0,0 +1,311 @@
+/****************************************************************************
+ *
+ * ViSP, open source Visual Servoing Platform software.
+ * Copyright (C) 2005 - 2019 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test the ring buffer of images in shared memory.
+ *
+ *****************************************************************************/
+
+#include <visp3/core/vpConfig.h>
+
+/*!
+  \example testSharedImageRing.cpp
+
+  \brief Test the exchange of images through vpSharedImageRing, within a
+  process and between two processes.
+*/
+
+#include <visp3/core/vpSharedImageRing.h>
+
+#if defined(VISP_HAVE_CATCH2) && !defined(_WIN32) &&                                                                   \
+    (defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))) &&                             \
+    (VISP_CXX_STANDARD >= VISP_CXX_STANDARD_11)
+#define CATCH_CONFIG_RUNNER
+#include <catch.hpp>
+#include <fcntl.h>
+#include <sstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <visp3/core/vpIoTools.h>
+#include <visp3/core/vpRGBa.h>
+#include <visp3/core/vpTime.h>
+
+namespace
+{
+std::string ringName()
+{
+  std::string username;
+  vpIoTools::getUserName(username);
+  std::stringstream ss;
+  ss << "/testSharedImageRing_" << username << "_" << getpid();
+  return ss.str();
+}
+
+void fillFrame(vpImage<unsigned char> &I, unsigned int index)
+{
+  for (unsigned int i = 0; i < I.getSize(); i++) {
+    I.bitmap[i] = static_cast<unsigned char>(index + i);
+  }
+}
+
+bool checkFrame(const vpImage<unsigned char> &I, unsigned int index)
+{
+  for (unsigned int i = 0; i < I.getSize(); i++) {
+    if (I.bitmap[i] != static_cast<unsigned char>(index + i)) {
+      return false;
+    }
+  }
+  return true;
+}
+} // namespace
+
+TEST_CASE("Write and read frames", "[vpSharedImageRing]")
+{
+  const std::string name = ringName();
+  vpSharedImageRing producer;
+  producer.create<vpRGBa>(name, 4, 48, 64, 32);
+  CHECK(producer.getNbSlots() == 4);
+  CHECK(producer.getMaxHeight() == 48);
+  CHECK(producer.getMaxWidth() == 64);
+  CHECK(producer.getMaxMetadataSize() == 32);
+
+  vpSharedImageRing consumer;
+  consumer.open(name);
+  CHECK(consumer.getNbSlots() == 4);
+
+  vpImage<vpRGBa> I_read;
+  CHECK_FALSE(consumer.read(I_read));
+  CHECK_FALSE(consumer.waitForFrame(1.));
+
+  vpImage<vpRGBa> I(24, 32);
+  for (unsigned int i = 0; i < I.getSize(); i++) {
+    I.bitmap[i] = vpRGBa(static_cast<unsigned char>(i), static_cast<unsigned char>(2 * i), 3, 4);
+  }
+  producer.write(I, 12.5, "pose");
+  CHECK(producer.getNbWrittenFrames() == 1);
+
+  REQUIRE(consumer.waitForFrame(1.));
+  REQUIRE(consumer.read(I_read));
+  CHECK((I_read == I));
+  CHECK(consumer.getFrameIndex() == 0);
+  CHECK(consumer.getTimestamp() == 12.5);
+  CHECK(consumer.getMetadata() == "pose");
+  CHECK_FALSE(consumer.read(I_read));
+
+  SECTION("Zero-copy acquisition")
+  {
+    vpImage<vpRGBa> I_slot;
+    producer.write(I, 13., "");
+    REQUIRE(consumer.acquire(I_slot));
+    CHECK((I_slot == I));
+    CHECK(consumer.getMetadata().empty());
+    CHECK(consumer.isValid());
+
+    // Overwrite the slot of the acquired frame
+    for (unsigned int i = 0; i < producer.getNbSlots(); i++) {
+      producer.write(I, 14., "");
+    }
+    CHECK_FALSE(consumer.isValid());
+  }
+
+  SECTION("Zero-copy writing")
+  {
+    vpImage<vpRGBa> I_slot;
+    producer.beginWrite(I_slot, 48, 64);
+    I_slot = vpRGBa(7);
+    CHECK_FALSE(consumer.read(I_read));
+    producer.endWrite(15., "0123456789");
+
+    REQUIRE(consumer.read(I_read));
+    CHECK(I_read.getHeight() == 48);
+    CHECK(I_read.getWidth() == 64);
+    CHECK((I_read[47][63] == vpRGBa(7)));
+    CHECK(consumer.getMetadata() == "0123456789");
+  }
+
+  SECTION("Slow consumer")
+  {
+    for (unsigned int i = 0; i < 10; i++) {
+      producer.write(I, i, "");
+    }
+    // Only the last frames are still in the ring
+    REQUIRE(consumer.read(I_read));
+    CHECK(consumer.getFrameIndex() == 7);
+    CHECK(consumer.getNbDroppedFrames() == 6);
+    for (unsigned int i = 8; i <= 10; i++) {
+      REQUIRE(consumer.read(I_read));
+      CHECK(consumer.getFrameIndex() == i);
+    }
+    CHECK_FALSE(consumer.read(I_read));
+  }
+
+  SECTION("Latest frame")
+  {
+    for (unsigned int i = 0; i < 3; i++) {
+      producer.write(I, i, "");
+    }
+    REQUIRE(consumer.read(I_read, true));
+    CHECK(consumer.getFrameIndex() == 3);
+    CHECK(consumer.getTimestamp() == 2.);
+    CHECK(consumer.getNbDroppedFrames() == 2);
+    CHECK_FALSE(consumer.read(I_read, true));
+  }
+
+  SECTION("Errors")
+  {
+    vpImage<unsigned char> I_gray(24, 32);
+    CHECK_THROWS_AS(producer.write(I_gray, 0.), vpException);
+    CHECK_THROWS_AS(consumer.read(I_gray), vpException);
+    vpImage<vpRGBa> I_large(64, 64);
+    CHECK_THROWS_AS(producer.write(I_large, 0.), vpException);
+    CHECK_THROWS_AS(producer.write(I, 0., std::string(33, 'a')), vpException);
+    producer.endWrite(0., "");
+    CHECK_THROWS_AS(consumer.write(I, 0.), vpException);
+    CHECK_THROWS_AS(producer.endWrite(0., ""), vpException);
+  }
+
+  producer.close();
+  vpSharedImageRing ring;
+  CHECK_THROWS_AS(ring.open(name), vpException);
+}
+
+TEST_CASE("Create a ring whose name exists", "[vpSharedImageRing]")
+{
+  const std::string name = ringName();
+  vpSharedImageRing producer;
+  producer.create<unsigned char>(name, 2, 12, 16);
+
+  // The ring is only accessible by its user by default
+  int fd = shm_open(name.c_str(), O_RDONLY, 0);
+  REQUIRE(fd != -1);
+  struct stat st;
+  REQUIRE(fstat(fd, &st) == 0);
+  CHECK((st.st_mode & 077) == 0);
+  close(fd);
+
+  // The ring of a running producer is not taken over
+  vpSharedImageRing producer2;
+  CHECK_THROWS_AS(producer2.create<unsigned char>(name, 2, 12, 16), vpException);
+  CHECK_FALSE(producer2.isOpened());
+  vpImage<unsigned char> I(12, 16, 7);
+  producer.write(I, 1.);
+  vpSharedImageRing consumer;
+  consumer.open(name);
+  CHECK(consumer.getNbSlots() == 2);
+
+  // Unless it is explicitly reclaimed
+  producer2.create<unsigned char>(name, 3, 12, 16, 0, true);
+  CHECK(producer2.getNbSlots() == 3);
+  consumer.open(name);
+  CHECK(consumer.getNbSlots() == 3);
+
+  // The previous producer doesn't remove the name of the new ring
+  producer.close();
+  consumer.open(name);
+  CHECK(consumer.getNbSlots() == 3);
+  producer2.close();
+  CHECK_THROWS_AS(consumer.open(name), vpException);
+}
+
+TEST_CASE("Exchange frames between processes", "[vpSharedImageRing]")
+{
+  const std::string name = ringName();
+  const unsigned int nbFrames = 200;
+  vpSharedImageRing producer;
+  producer.create<unsigned char>(name, 3, 120, 160);
+
+  pid_t pid = fork();
+  REQUIRE(pid != -1);
+  if (pid == 0) {
+    // Consumer process: each copied frame must be consistent
+    int status = EXIT_SUCCESS;
+    try {
+      vpSharedImageRing consumer;
+      consumer.open(name);
+      vpImage<unsigned char> I;
+      unsigned int nbRead = 0;
+      while (nbRead < nbFrames / 4 && consumer.waitForFrame(5000.)) {
+        if (consumer.read(I)) {
+          if (!checkFrame(I, static_cast<unsigned int>(consumer.getTimestamp()))) {
+            status = EXIT_FAILURE;
+          }
+          nbRead++;
+        }
+      }
+      if (nbRead < nbFrames / 4) {
+        status = EXIT_FAILURE;
+      }
+    } catch (...) {
+      status = EXIT_FAILURE;
+    }
+    _exit(status);
+  }
+
+  // Producer process: write frames until the consumer has read enough of them
+  vpImage<unsigned char> I(120, 160);
+  int status = EXIT_FAILURE;
+  unsigned int index = 0;
+  for (;;) {
+    pid_t res = waitpid(pid, &status, WNOHANG);
+    if (res == pid) {
+      break;
+    }
+    fillFrame(I, index);
+    producer.write(I, index);
+    index++;
+    vpTime::sleepMs(index < nbFrames ? 0.2 : 2.);
+  }
+  CHECK(WIFEXITED(status));
+  CHECK(WEXITSTATUS(status) == EXIT_SUCCESS);
+}
+
+int main(int argc, char *argv[])
+{
+  Catch::Session session; // There must be exactly one instance
+
+  // Let Catch (using Clara) parse the command line
+  session.applyCommandLine(argc, argv);
+
+  int numFailed = session.run();
+
+  // numFailed is clamped to 255 as some unices only use the lower 8 bits.
+  // This clamping has already been applied, so just return it here
+  // You can also do any post run clean-up here
+  return numFailed;
+}
+#else
+int main()
+{
+  return 0;
+}
+#endif
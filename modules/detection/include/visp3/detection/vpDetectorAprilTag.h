@@ -44,6 +44,7 @@
 #include <visp3/core/vpHomogeneousMatrix.h>
 #include <visp3/core/vpImage.h>
 #include <visp3/core/vpColor.h>
+#include <visp3/core/vpRect.h>
 #include <visp3/detection/vpDetectorBase.h>
 
 /*!
@@ -250,6 +251,9 @@ public:
   vpDetectorAprilTag &operator=(vpDetectorAprilTag o);
   virtual ~vpDetectorAprilTag();
 
+  vpDetectorBase *clone() const;
+
+  using vpDetectorBase::detect;
   bool detect(const vpImage<unsigned char> &I);
   bool detect(const vpImage<unsigned char> &I, double tagSize, const vpCameraParameters &cam,
               std::vector<vpHomogeneousMatrix> &cMo_vec, std::vector<vpHomogeneousMatrix> *cMo_vec2=NULL,
@@ -264,9 +268,11 @@ public:
   */
   inline vpPoseEstimationMethod getPoseEstimationMethod() const { return m_poseEstimationMethod; }
 
+  std::vector<vpRect> getRois() const;
   std::vector<std::vector<vpImagePoint> > getTagsCorners() const;
   std::vector<int> getTagsId() const;
   std::vector<std::vector<vpPoint> > getTagsPoints3D(const std::vector<int>& tagsId, const std::map<int, double>& tagsSize) const;
+  void getTimings(std::vector<std::string> &stageNames, std::vector<double> &stageDurations) const;
 
   void setAprilTagDecodeSharpening(double decodeSharpening);
   void setAprilTagFamily(const vpAprilTagFamily &tagFamily);
@@ -287,6 +293,8 @@ public:
     m_displayTagThickness = thickness;
   }
 
+  void setRoiTracking(bool enable, unsigned int fullDetectionPeriod = 10, double roiMargin = 0.5);
+
   friend void swap(vpDetectorAprilTag &o1, vpDetectorAprilTag &o2);
 
   void setZAlignedWithCameraAxis(bool zAlignedWithCameraFrame);
@@ -55,6 +55,9 @@ public:
   vpDetectorDNN();
   virtual ~vpDetectorDNN();
 
+  virtual vpDetectorBase *clone() const;
+
+  using vpDetectorBase::detect;
   virtual bool detect(const vpImage<unsigned char> &I);
   virtual bool detect(const vpImage<vpRGBa> &I, std::vector<vpRect> &boundingBoxes);
 
@@ -112,6 +115,12 @@ private:
   double m_scaleFactor;
   //! If true, swap R and B for mean subtraction, e.g. when a model has been trained on BGR image format
   bool m_swapRB;
+  //! Arguments of readNet(), to load the network again in clone()
+  std::string m_model, m_config, m_framework;
+  //! Preferable backend of the network
+  int m_backendId;
+  //! Preferable target of the network
+  int m_targetId;
 };
 #endif
 #endif
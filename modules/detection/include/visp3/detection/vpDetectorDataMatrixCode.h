@@ -115,6 +115,8 @@ class VISP_EXPORT vpDetectorDataMatrixCode : public vpDetectorBase
 public:
   vpDetectorDataMatrixCode();
   virtual ~vpDetectorDataMatrixCode(){};
+  vpDetectorBase *clone() const;
+  using vpDetectorBase::detect;
   bool detect(const vpImage<unsigned char> &I);
 };
 
@@ -91,6 +91,7 @@ protected:
   std::vector<cv::Rect> m_faces;        //!< Bounding box of each detected face.
   cv::CascadeClassifier m_face_cascade; //!< Haar cascade classifier file name.
   cv::Mat m_frame_gray;                 //!< OpenCV image used as input for the face detection.
+  std::string m_cascade_file;           //!< Haar cascade classifier file name.
 
 public:
   vpDetectorFace();
@@ -99,6 +100,9 @@ public:
    */
   virtual ~vpDetectorFace(){}
 
+  vpDetectorBase *clone() const;
+
+  using vpDetectorBase::detect;
   bool detect(const vpImage<unsigned char> &I);
   bool detect(const cv::Mat &frame_gray);
   void setCascadeClassifierFile(const std::string &filename);
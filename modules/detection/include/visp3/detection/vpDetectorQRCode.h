@@ -119,6 +119,8 @@ protected:
 public:
   vpDetectorQRCode();
   virtual ~vpDetectorQRCode(){}
+  vpDetectorBase *clone() const;
+  using vpDetectorBase::detect;
   bool detect(const vpImage<unsigned char> &I);
 };
 
@@ -52,6 +52,17 @@
  */
 vpDetectorDataMatrixCode::vpDetectorDataMatrixCode() { setTimeout(50); }
 
+/*!
+  Return a new detector with the same timeout, used by the batch detection of
+  vpDetectorBase.
+ */
+vpDetectorBase *vpDetectorDataMatrixCode::clone() const
+{
+  vpDetectorDataMatrixCode *detector = new vpDetectorDataMatrixCode();
+  detector->setTimeout(m_timeout_ms);
+  return detector;
+}
+
 /*!
   Detect datamatrix codes in the image. Return true if a code is detected, false otherwise.
   There is the setTimeout() function that allows to tune the value of the timeout used to detect a datamatrix code.
@@ -51,6 +51,17 @@ vpDetectorQRCode::vpDetectorQRCode() : m_scanner()
   m_scanner.set_config(zbar::ZBAR_NONE, zbar::ZBAR_CFG_ENABLE, 1);
 }
 
+/*!
+  Return a new detector with the same timeout, used by the batch detection of
+  vpDetectorBase.
+ */
+vpDetectorBase *vpDetectorQRCode::clone() const
+{
+  vpDetectorQRCode *detector = new vpDetectorQRCode();
+  detector->setTimeout(m_timeout_ms);
+  return detector;
+}
+
 /*!
   Detect QR codes in the image. Return true if a code is detected, false
   otherwise.
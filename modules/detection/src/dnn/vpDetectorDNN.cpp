@@ -40,10 +40,33 @@
 
 vpDetectorDNN::vpDetectorDNN() : m_blob(), m_boxes(), m_classIds(), m_confidences(),
     m_confidenceThreshold(0.5), m_I_color(), m_img(), m_inputSize(300,300), m_mean(127.5, 127.5, 127.5),
-    m_net(), m_nmsThreshold(0.4f), m_outNames(), m_outs(), m_scaleFactor(2.0/255.0), m_swapRB(true) {}
+    m_net(), m_nmsThreshold(0.4f), m_outNames(), m_outs(), m_scaleFactor(2.0/255.0), m_swapRB(true),
+    m_model(), m_config(), m_framework(), m_backendId(cv::dnn::DNN_BACKEND_DEFAULT), m_targetId(cv::dnn::DNN_TARGET_CPU) {}
 
 vpDetectorDNN::~vpDetectorDNN() {}
 
+/*!
+  Return a new detector with the same settings, used by the batch detection of
+  vpDetectorBase. The network is read again, since a network cannot run
+  several inferences at the same time.
+*/
+vpDetectorBase *vpDetectorDNN::clone() const {
+  vpDetectorDNN *detector = new vpDetectorDNN();
+  detector->setTimeout(m_timeout_ms);
+  detector->m_confidenceThreshold = m_confidenceThreshold;
+  detector->m_inputSize = m_inputSize;
+  detector->m_mean = m_mean;
+  detector->m_nmsThreshold = m_nmsThreshold;
+  detector->m_scaleFactor = m_scaleFactor;
+  detector->m_swapRB = m_swapRB;
+  if (!m_model.empty()) {
+    detector->readNet(m_model, m_config, m_framework);
+    detector->setPreferableBackend(m_backendId);
+    detector->setPreferableTarget(m_targetId);
+  }
+  return detector;
+}
+
 /*!
   Object detection using OpenCV DNN module.
   \warning Classical object detection network uses as input 3-channels.
@@ -300,11 +323,15 @@ void vpDetectorDNN::postProcess() {
 */
 void vpDetectorDNN::readNet(const std::string &model, const std::string &config, const std::string &framework) {
   m_net = cv::dnn::readNet(model, config, framework);
+  m_model = model;
+  m_config = config;
+  m_framework = framework;
 #if (VISP_HAVE_OPENCV_VERSION == 0x030403)
   m_outNames = getOutputsNames();
 #else
   m_outNames = m_net.getUnconnectedOutLayersNames();
 #endif
+  clearBatchDetectors();
 }
 
 /*!
@@ -314,6 +341,7 @@ void vpDetectorDNN::readNet(const std::string &model, const std::string &config,
 */
 void vpDetectorDNN::setConfidenceThreshold(float confThreshold) {
   m_confidenceThreshold = confThreshold;
+  clearBatchDetectors();
 }
 
 /*!
@@ -325,6 +353,7 @@ void vpDetectorDNN::setConfidenceThreshold(float confThreshold) {
 void vpDetectorDNN::setInputSize(int width, int height) {
   m_inputSize.width = width;
   m_inputSize.height = height;
+  clearBatchDetectors();
 }
 
 /*!
@@ -336,6 +365,7 @@ void vpDetectorDNN::setInputSize(int width, int height) {
 */
 void vpDetectorDNN::setMean(double meanR, double meanG, double meanB) {
   m_mean = cv::Scalar(meanR, meanG, meanB);
+  clearBatchDetectors();
 }
 
 /*!
@@ -346,6 +376,7 @@ void vpDetectorDNN::setMean(double meanR, double meanG, double meanB) {
 */
 void vpDetectorDNN::setNMSThreshold(float nmsThreshold) {
   m_nmsThreshold = nmsThreshold;
+  clearBatchDetectors();
 }
 
 /*!
@@ -356,6 +387,8 @@ void vpDetectorDNN::setNMSThreshold(float nmsThreshold) {
 */
 void vpDetectorDNN::setPreferableBackend(int backendId) {
   m_net.setPreferableBackend(backendId);
+  m_backendId = backendId;
+  clearBatchDetectors();
 }
 
 /*!
@@ -366,6 +399,8 @@ void vpDetectorDNN::setPreferableBackend(int backendId) {
 */
 void vpDetectorDNN::setPreferableTarget(int targetId) {
   m_net.setPreferableTarget(targetId);
+  m_targetId = targetId;
+  clearBatchDetectors();
 }
 
 /*!
@@ -373,6 +408,7 @@ void vpDetectorDNN::setPreferableTarget(int targetId) {
 */
 void vpDetectorDNN::setScaleFactor(double scaleFactor) {
   m_scaleFactor = scaleFactor;
+  clearBatchDetectors();
 }
 
 /*!
@@ -382,6 +418,7 @@ void vpDetectorDNN::setScaleFactor(double scaleFactor) {
 */
 void vpDetectorDNN::setSwapRB(bool swapRB) {
   m_swapRB = swapRB;
+  clearBatchDetectors();
 }
 
 #elif !defined(VISP_BUILD_SHARED_LIBS)
@@ -49,7 +49,21 @@ bool vpSortLargestFace(cv::Rect rect1, cv::Rect rect2) { return (rect1.area() >
 /*!
   Default constructor.
  */
-vpDetectorFace::vpDetectorFace() : m_faces(), m_face_cascade(), m_frame_gray() {}
+vpDetectorFace::vpDetectorFace() : m_faces(), m_face_cascade(), m_frame_gray(), m_cascade_file() {}
+
+/*!
+  Return a new detector loading the same cascade classifier file, used by the
+  batch detection of vpDetectorBase.
+ */
+vpDetectorBase *vpDetectorFace::clone() const
+{
+  vpDetectorFace *detector = new vpDetectorFace();
+  detector->setTimeout(m_timeout_ms);
+  if (!m_cascade_file.empty()) {
+    detector->setCascadeClassifierFile(m_cascade_file);
+  }
+  return detector;
+}
 
 /*!
   Set the name of the OpenCV cascade classifier file used for face detection.
@@ -62,6 +76,8 @@ void vpDetectorFace::setCascadeClassifierFile(const std::string &filename)
   if (!m_face_cascade.load(filename)) {
     throw vpException(vpException::ioError, "Cannot read haar file: %s", filename.c_str());
   }
+  m_cascade_file = filename;
+  clearBatchDetectors();
 }
 
 /*!
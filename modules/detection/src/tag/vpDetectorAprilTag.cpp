@@ -35,6 +35,8 @@
 #include <visp3/core/vpConfig.h>
 
 #ifdef VISP_HAVE_APRILTAG
+#include <cstring>
+#include <limits>
 #include <map>
 
 #include <apriltag.h>
@@ -58,6 +60,7 @@
 #include <visp3/core/vpDisplay.h>
 #include <visp3/core/vpPixelMeterConversion.h>
 #include <visp3/core/vpPoint.h>
+#include <visp3/core/vpTime.h>
 #include <visp3/vision/vpPose.h>
 
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
@@ -66,7 +69,9 @@ class vpDetectorAprilTag::Impl
 public:
   Impl(const vpAprilTagFamily &tagFamily, const vpPoseEstimationMethod &method)
     : m_poseEstimationMethod(method), m_tagsId(), m_tagFamily(tagFamily),
-      m_td(NULL), m_tf(NULL), m_detections(NULL), m_zAlignedWithCameraFrame(false)
+      m_td(NULL), m_tf(NULL), m_detections(NULL), m_zAlignedWithCameraFrame(false), m_roiTracking(false),
+      m_fullDetectionPeriod(10), m_roiMargin(0.5), m_frameIndex(0), m_trackedTags(), m_rois(), m_stageNames(),
+      m_stageDurations()
   {
     switch (m_tagFamily) {
     case TAG_36h11:
@@ -135,7 +140,10 @@ public:
 
   Impl(const Impl &o)
     : m_poseEstimationMethod(o.m_poseEstimationMethod), m_tagsId(o.m_tagsId), m_tagFamily(o.m_tagFamily),
-      m_td(NULL), m_tf(NULL), m_detections(NULL), m_zAlignedWithCameraFrame(o.m_zAlignedWithCameraFrame)
+      m_td(NULL), m_tf(NULL), m_detections(NULL), m_zAlignedWithCameraFrame(o.m_zAlignedWithCameraFrame),
+      m_roiTracking(o.m_roiTracking), m_fullDetectionPeriod(o.m_fullDetectionPeriod), m_roiMargin(o.m_roiMargin),
+      m_frameIndex(o.m_frameIndex), m_trackedTags(o.m_trackedTags), m_rois(o.m_rois), m_stageNames(o.m_stageNames),
+      m_stageDurations(o.m_stageDurations)
   {
     switch (m_tagFamily) {
     case TAG_36h11:
@@ -196,6 +204,16 @@ public:
     if (m_tagFamily != TAG_36ARTOOLKIT && m_tf) {
       m_td = apriltag_detector_create();
       apriltag_detector_add_family(m_td, m_tf);
+
+      if (o.m_td) {
+        m_td->nthreads = o.m_td->nthreads;
+        m_td->quad_decimate = o.m_td->quad_decimate;
+        m_td->quad_sigma = o.m_td->quad_sigma;
+        m_td->refine_edges = o.m_td->refine_edges;
+        m_td->decode_sharpening = o.m_td->decode_sharpening;
+        m_td->debug = o.m_td->debug;
+        m_td->qtp = o.m_td->qtp;
+      }
     }
 
     m_mapOfCorrespondingPoseMethods[DEMENTHON_VIRTUAL_VS] = vpPose::DEMENTHON;
@@ -305,18 +323,42 @@ public:
 #endif
 
     const bool computePose = (cMo_vec != NULL);
-
-    image_u8_t im = {/*.width =*/(int32_t)I.getWidth(),
-                     /*.height =*/(int32_t)I.getHeight(),
-                     /*.stride =*/(int32_t)I.getWidth(),
-                     /*.buf =*/I.bitmap};
+    const double t_start = vpTime::measureTimeMs();
+    m_stageNames.clear();
+    m_stageDurations.clear();
 
     if (m_detections) {
       apriltag_detections_destroy(m_detections);
       m_detections = NULL;
     }
 
-    m_detections = apriltag_detector_detect(m_td, &im);
+    // Between two full image detections, only search the tags around their predicted location
+    m_rois.clear();
+    bool lostTags = false;
+    if (m_roiTracking && m_frameIndex != 0 && !m_trackedTags.empty()) {
+      m_detections = detectInRois(I);
+      lostTags = (m_detections == NULL || zarray_size(m_detections) < static_cast<int>(m_trackedTags.size()));
+    }
+
+    if (m_detections == NULL) {
+      m_rois.clear();
+      lostTags = false;
+      image_u8_t im = {/*.width =*/(int32_t)I.getWidth(),
+                       /*.height =*/(int32_t)I.getHeight(),
+                       /*.stride =*/(int32_t)I.getWidth(),
+                       /*.buf =*/I.bitmap};
+
+      m_detections = apriltag_detector_detect(m_td, &im);
+      addTimings(m_td->tp);
+      m_frameIndex = 0;
+    }
+
+    if (m_roiTracking) {
+      updateTrackedTags();
+      // A lost tag is searched again in the whole next image
+      m_frameIndex = (lostTags || m_frameIndex + 1 >= m_fullDetectionPeriod) ? 0 : m_frameIndex + 1;
+    }
+
     int nb_detections = zarray_size(m_detections);
     bool detected = nb_detections > 0;
 
@@ -355,6 +397,7 @@ public:
       }
 
       if (computePose) {
+        const double t_pose = vpTime::measureTimeMs();
         vpHomogeneousMatrix cMo, cMo2;
         double err1, err2;
         if (getPose(static_cast<size_t>(i), tagSize, cam, cMo, cMo_vec2 ? &cMo2 : NULL,
@@ -371,12 +414,173 @@ public:
           }
         }
         // else case should never happen
+        addTiming("pose", vpTime::measureTimeMs() - t_pose);
       }
     }
 
+    addTiming("total", vpTime::measureTimeMs() - t_start);
+
     return detected;
   }
 
+  void addTiming(const std::string &stage, double duration)
+  {
+    for (size_t i = 0; i < m_stageNames.size(); i++) {
+      if (m_stageNames[i] == stage) {
+        m_stageDurations[i] += duration;
+        return;
+      }
+    }
+    m_stageNames.push_back(stage);
+    m_stageDurations.push_back(duration);
+  }
+
+  // Add the duration of the stages of the last AprilTag detection
+  void addTimings(const timeprofile_t *tp)
+  {
+    int64_t last_utime = tp->utime;
+    for (int i = 0; i < zarray_size(tp->stamps); i++) {
+      struct timeprofile_entry *stamp;
+      zarray_get_volatile(tp->stamps, i, &stamp);
+      addTiming(stamp->name, (stamp->utime - last_utime) / 1000.0);
+      last_utime = stamp->utime;
+    }
+  }
+
+  /*
+    Detect the tags in regions of interest around the predicted location of
+    the tracked tags. The regions are cropped without copy, by passing the
+    image stride to the AprilTag detector. Return NULL if no tag is found.
+  */
+  zarray_t *detectInRois(const vpImage<unsigned char> &I)
+  {
+    const double t_roi = vpTime::measureTimeMs();
+    const int width = static_cast<int>(I.getWidth()), height = static_cast<int>(I.getHeight());
+    // The detector needs a few tiles of the decimated image
+    const int min_size = static_cast<int>(std::ceil(32 * std::max(1.0f, m_td->quad_decimate)));
+
+    // Bounding boxes (left, top, right, bottom) of the predicted corners
+    std::vector<std::vector<int> > boxes;
+    for (size_t i = 0; i < m_trackedTags.size(); i++) {
+      const vpTrackedTag &tag = m_trackedTags[i];
+      double u_min = std::numeric_limits<double>::max(), v_min = u_min;
+      double u_max = -u_min, v_max = -u_min;
+      for (int j = 0; j < 4; j++) {
+        double u = tag.p[j][0] + tag.v[j][0], v = tag.p[j][1] + tag.v[j][1];
+        u_min = std::min(u_min, u);
+        u_max = std::max(u_max, u);
+        v_min = std::min(v_min, v);
+        v_max = std::max(v_max, v);
+      }
+      double margin = m_roiMargin * std::max(u_max - u_min, v_max - v_min);
+      double grow_u = std::max(0.0, (min_size - (u_max - u_min) - 2 * margin) / 2);
+      double grow_v = std::max(0.0, (min_size - (v_max - v_min) - 2 * margin) / 2);
+      std::vector<int> box(4);
+      box[0] = std::max(0, vpMath::round(u_min - margin - grow_u));
+      box[1] = std::max(0, vpMath::round(v_min - margin - grow_v));
+      box[2] = std::min(width - 1, vpMath::round(u_max + margin + grow_u));
+      box[3] = std::min(height - 1, vpMath::round(v_max + margin + grow_v));
+      if (box[2] - box[0] + 1 >= min_size && box[3] - box[1] + 1 >= min_size) {
+        boxes.push_back(box);
+      }
+    }
+
+    // Merge the overlapping boxes, so that a tag is searched only once
+    for (bool merged = true; merged;) {
+      merged = false;
+      for (size_t i = 0; i < boxes.size() && !merged; i++) {
+        for (size_t j = i + 1; j < boxes.size() && !merged; j++) {
+          if (boxes[i][0] <= boxes[j][2] && boxes[j][0] <= boxes[i][2] && boxes[i][1] <= boxes[j][3] &&
+              boxes[j][1] <= boxes[i][3]) {
+            boxes[i][0] = std::min(boxes[i][0], boxes[j][0]);
+            boxes[i][1] = std::min(boxes[i][1], boxes[j][1]);
+            boxes[i][2] = std::max(boxes[i][2], boxes[j][2]);
+            boxes[i][3] = std::max(boxes[i][3], boxes[j][3]);
+            boxes.erase(boxes.begin() + static_cast<long>(j));
+            merged = true;
+          }
+        }
+      }
+    }
+    addTiming("roi", vpTime::measureTimeMs() - t_roi);
+
+    zarray_t *detections = zarray_create(sizeof(apriltag_detection_t *));
+    for (size_t i = 0; i < boxes.size(); i++) {
+      const int left = boxes[i][0], top = boxes[i][1];
+      const int roi_width = boxes[i][2] - left + 1, roi_height = boxes[i][3] - top + 1;
+      m_rois.push_back(vpRect(left, top, roi_width, roi_height));
+
+      image_u8_t im = {/*.width =*/(int32_t)roi_width,
+                       /*.height =*/(int32_t)roi_height,
+                       /*.stride =*/(int32_t)width,
+                       /*.buf =*/I.bitmap + top * width + left};
+      zarray_t *roi_detections = apriltag_detector_detect(m_td, &im);
+      addTimings(m_td->tp);
+
+      // Express the corners, the center and the homography in the image frame
+      for (int j = 0; j < zarray_size(roi_detections); j++) {
+        apriltag_detection_t *det;
+        zarray_get(roi_detections, j, &det);
+        for (int k = 0; k < 4; k++) {
+          det->p[k][0] += left;
+          det->p[k][1] += top;
+        }
+        det->c[0] += left;
+        det->c[1] += top;
+        for (int k = 0; k < 3; k++) {
+          MATD_EL(det->H, 0, k) += left * MATD_EL(det->H, 2, k);
+          MATD_EL(det->H, 1, k) += top * MATD_EL(det->H, 2, k);
+        }
+        zarray_add(detections, &det);
+      }
+      zarray_destroy(roi_detections);
+    }
+
+    if (zarray_size(detections) == 0) {
+      zarray_destroy(detections);
+      return NULL;
+    }
+    return detections;
+  }
+
+  // Keep the corners of the detected tags and their motion since the previous image
+  void updateTrackedTags()
+  {
+    std::vector<vpTrackedTag> tags(static_cast<size_t>(zarray_size(m_detections)));
+    for (int i = 0; i < zarray_size(m_detections); i++) {
+      apriltag_detection_t *det;
+      zarray_get(m_detections, i, &det);
+      vpTrackedTag &tag = tags[static_cast<size_t>(i)];
+      tag.id = det->id;
+      std::memcpy(tag.p, det->p, sizeof(tag.p));
+      std::memset(tag.v, 0, sizeof(tag.v));
+
+      // Previous location of the same tag: same id and closest center
+      double min_dist = std::numeric_limits<double>::max();
+      const vpTrackedTag *previous = NULL;
+      for (size_t j = 0; j < m_trackedTags.size(); j++) {
+        if (m_trackedTags[j].id == tag.id) {
+          double du = 0, dv = 0;
+          for (int k = 0; k < 4; k++) {
+            du += (tag.p[k][0] - m_trackedTags[j].p[k][0]) / 4;
+            dv += (tag.p[k][1] - m_trackedTags[j].p[k][1]) / 4;
+          }
+          if (du * du + dv * dv < min_dist) {
+            min_dist = du * du + dv * dv;
+            previous = &m_trackedTags[j];
+          }
+        }
+      }
+      if (previous != NULL) {
+        for (int k = 0; k < 4; k++) {
+          tag.v[k][0] = tag.p[k][0] - previous->p[k][0];
+          tag.v[k][1] = tag.p[k][1] - previous->p[k][1];
+        }
+      }
+    }
+    m_trackedTags = tags;
+  }
+
   bool getPose(size_t tagIndex, double tagSize, const vpCameraParameters &cam, vpHomogeneousMatrix &cMo, vpHomogeneousMatrix *cMo2,
                double *projErrors, double *projErrors2) {
     if (m_detections == NULL) {
@@ -676,8 +880,16 @@ public:
     return m_zAlignedWithCameraFrame;
   }
 
+  std::vector<vpRect> getRois() const { return m_rois; }
+
   std::vector<int> getTagsId() const { return m_tagsId; }
 
+  void getTimings(std::vector<std::string> &stageNames, std::vector<double> &stageDurations) const
+  {
+    stageNames = m_stageNames;
+    stageDurations = m_stageDurations;
+  }
+
   void setAprilTagDecodeSharpening(double decodeSharpening) {
     if (m_td) {
       m_td->decode_sharpening = decodeSharpening;
@@ -712,6 +924,15 @@ public:
 
   void setRefinePose(bool) { }
 
+  void setRoiTracking(bool enable, unsigned int fullDetectionPeriod, double roiMargin)
+  {
+    m_roiTracking = enable;
+    m_fullDetectionPeriod = std::max(1u, fullDetectionPeriod);
+    m_roiMargin = roiMargin;
+    m_frameIndex = 0;
+    m_trackedTags.clear();
+  }
+
   void setPoseEstimationMethod(const vpPoseEstimationMethod &method) { m_poseEstimationMethod = method; }
 
   void setZAlignedWithCameraAxis(bool zAlignedWithCameraFrame) { m_zAlignedWithCameraFrame = zAlignedWithCameraFrame; }
@@ -725,6 +946,22 @@ protected:
   apriltag_family_t *m_tf;
   zarray_t *m_detections;
   bool m_zAlignedWithCameraFrame;
+
+  // Tag detected in the previous image
+  struct vpTrackedTag {
+    int id;
+    double p[4][2]; // corners
+    double v[4][2]; // motion of the corners since the image before
+  };
+
+  bool m_roiTracking;
+  unsigned int m_fullDetectionPeriod;
+  double m_roiMargin;
+  unsigned int m_frameIndex; // number of images since the last full image detection
+  std::vector<vpTrackedTag> m_trackedTags;
+  std::vector<vpRect> m_rois;
+  std::vector<std::string> m_stageNames;
+  std::vector<double> m_stageDurations;
 };
 #endif // DOXYGEN_SHOULD_SKIP_THIS
 
@@ -747,11 +984,28 @@ vpDetectorAprilTag::vpDetectorAprilTag(const vpDetectorAprilTag &o)
 vpDetectorAprilTag &vpDetectorAprilTag::operator=(vpDetectorAprilTag o)
 {
   swap(*this, o);
+  clearBatchDetectors();
   return *this;
 }
 
 vpDetectorAprilTag::~vpDetectorAprilTag() { delete m_impl; }
 
+/*!
+  Return a new detector with the same settings, used by the batch detection
+  of vpDetectorBase. Since the images of a batch are processed independently,
+  the tracking of the tags in regions of interest is disabled in the new
+  detector. The batch already runs one detector per thread, so the new
+  detector uses a single thread (see setAprilTagNbThreads()) instead of
+  multiplying the threads of each image by the threads of the batch.
+*/
+vpDetectorBase *vpDetectorAprilTag::clone() const
+{
+  vpDetectorAprilTag *detector = new vpDetectorAprilTag(*this);
+  detector->setRoiTracking(false);
+  detector->setAprilTagNbThreads(1);
+  return detector;
+}
+
 /*!
   Detect AprilTag tags in the image. Return true if at least one tag is
   detected, false otherwise.
@@ -923,9 +1177,39 @@ std::vector<int> vpDetectorAprilTag::getTagsId() const
   return m_impl->getTagsId();
 }
 
+/*!
+  Return the regions of interest in which the tags have been searched by the
+  last call to detect(), or an empty vector if the whole image has been
+  processed.
+
+  \sa setRoiTracking()
+*/
+std::vector<vpRect> vpDetectorAprilTag::getRois() const
+{
+  return m_impl->getRois();
+}
+
+/*!
+  Get the computation time of each stage of the last call to detect().
+
+  The stages are the ones of the AprilTag detector ("decimate", "threshold",
+  "unionfind", "decode+refinement", ...), summed over all the regions of
+  interest when setRoiTracking() is enabled, followed by "roi" for the
+  prediction of the regions of interest, "pose" for the pose estimation and
+  "total" for the whole call.
+
+  \param[out] stageNames : Name of each stage, in processing order.
+  \param[out] stageDurations : Duration in ms of each stage.
+*/
+void vpDetectorAprilTag::getTimings(std::vector<std::string> &stageNames, std::vector<double> &stageDurations) const
+{
+  m_impl->getTimings(stageNames, stageDurations);
+}
+
 void vpDetectorAprilTag::setAprilTagDecodeSharpening(double decodeSharpening)
 {
-  return m_impl->setAprilTagDecodeSharpening(decodeSharpening);
+  m_impl->setAprilTagDecodeSharpening(decodeSharpening);
+  clearBatchDetectors();
 }
 
 void vpDetectorAprilTag::setAprilTagFamily(const vpAprilTagFamily &tagFamily)
@@ -951,6 +1235,7 @@ void vpDetectorAprilTag::setAprilTagFamily(const vpAprilTagFamily &tagFamily)
   m_impl->setQuadSigma(quadSigma);
   m_impl->setRefineEdges(refineEdges);
   m_impl->setZAlignedWithCameraAxis(zAxis);
+  clearBatchDetectors();
 }
 
 /*!
@@ -962,6 +1247,7 @@ void vpDetectorAprilTag::setAprilTagNbThreads(int nThreads)
 {
   if (nThreads > 0) {
     m_impl->setNbThreads(nThreads);
+    clearBatchDetectors();
   }
 }
 
@@ -991,6 +1277,7 @@ void vpDetectorAprilTag::setAprilTagPoseEstimationMethod(const vpPoseEstimationM
 void vpDetectorAprilTag::setAprilTagQuadDecimate(float quadDecimate)
 {
   m_impl->setQuadDecimate(quadDecimate);
+  clearBatchDetectors();
 }
 
 /*!
@@ -1008,6 +1295,7 @@ void vpDetectorAprilTag::setAprilTagQuadDecimate(float quadDecimate)
 void vpDetectorAprilTag::setAprilTagQuadSigma(float quadSigma)
 {
   m_impl->setQuadSigma(quadSigma);
+  clearBatchDetectors();
 }
 
 #if defined(VISP_BUILD_DEPRECATED_FUNCTIONS)
@@ -1016,6 +1304,7 @@ void vpDetectorAprilTag::setAprilTagQuadSigma(float quadSigma)
 */
 vp_deprecated void vpDetectorAprilTag::setAprilTagRefineDecode(bool refineDecode) {
   m_impl->setRefineDecode(refineDecode);
+  clearBatchDetectors();
 }
 #endif
 
@@ -1036,6 +1325,7 @@ vp_deprecated void vpDetectorAprilTag::setAprilTagRefineDecode(bool refineDecode
 void vpDetectorAprilTag::setAprilTagRefineEdges(bool refineEdges)
 {
   m_impl->setRefineEdges(refineEdges);
+  clearBatchDetectors();
 }
 
 #if defined(VISP_BUILD_DEPRECATED_FUNCTIONS)
@@ -1048,6 +1338,36 @@ vp_deprecated void vpDetectorAprilTag::setAprilTagRefinePose(bool refinePose)
 }
 #endif
 
+/*!
+  Enable or disable the detection of the tags around their location in the
+  previous image, which reduces the computation time when a video stream is
+  processed at a high frame rate.
+
+  When enabled, the whole image is processed only every \e fullDetectionPeriod
+  calls to detect(), with the decimation set by setAprilTagQuadDecimate().
+  In between, the tags are only searched in regions of interest around their
+  corners, predicted with a constant velocity model from the two previous
+  detections. Overlapping regions are merged, and each region is passed to
+  the AprilTag detector without copy. The whole image is processed again as
+  soon as a tracked tag is lost. New tags appearing in the image are thus
+  detected with a delay of at most \e fullDetectionPeriod images.
+
+  The buffers used by the AprilTag detector to threshold the image and find
+  the connected components are kept from one call to the next.
+
+  \param enable : If true, enable the tracking of the tags.
+  \param fullDetectionPeriod : Number of images between two detections in
+  the whole image. 1 processes the whole image each time.
+  \param roiMargin : Margin added around the predicted bounding box of each
+  tag, as a ratio of its size.
+
+  \sa getRois(), getTimings()
+*/
+void vpDetectorAprilTag::setRoiTracking(bool enable, unsigned int fullDetectionPeriod, double roiMargin)
+{
+  m_impl->setRoiTracking(enable, fullDetectionPeriod, roiMargin);
+}
+
 void swap(vpDetectorAprilTag &o1, vpDetectorAprilTag &o2)
 {
   using std::swap;
@@ -39,14 +39,269 @@
 
 #include <visp3/detection/vpDetectorBase.h>
 
+#include <algorithm>
+
+#if (VISP_CXX_STANDARD >= VISP_CXX_STANDARD_11)
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#endif
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+namespace
+{
+#if (VISP_CXX_STANDARD >= VISP_CXX_STANDARD_11)
+// Detect the objects in the next image of the batch until all the images are
+// processed or a thread failed
+void detectBatch(vpDetectorBase *detector, const std::vector<const vpImage<unsigned char> *> &images,
+                 std::vector<vpDetectorBase::vpDetectionResult> &results, std::atomic<size_t> &next,
+                 std::mutex &mutex, std::exception_ptr &error)
+{
+  try {
+    for (size_t i = next++; i < images.size(); i = next++) {
+      detector->detect(*images[i]);
+      results[i].polygon = detector->getPolygon();
+      results[i].message = detector->getMessage();
+    }
+  } catch (...) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!error) {
+      error = std::current_exception();
+    }
+    next = images.size();
+  }
+}
+#endif
+} // namespace
+
+#if (VISP_CXX_STANDARD >= VISP_CXX_STANDARD_11)
+// Threads of the batch detection, each one working with its own detector.
+// They are started once, and wait for the next batch between two batches.
+struct vpDetectorBase::vpBatchPool {
+  std::vector<std::thread> m_threads;
+  std::mutex m_mutex;
+  std::condition_variable m_start;
+  std::condition_variable m_done;
+  bool m_stop;
+  // Index of the current batch, number of threads working on it with the
+  // calling thread, and number of pool threads that haven't finished it
+  unsigned long m_batch;
+  size_t m_nbThreads;
+  size_t m_nbRunning;
+  const std::vector<const vpImage<unsigned char> *> *m_images;
+  std::vector<vpDetectionResult> *m_results;
+  std::atomic<size_t> m_next;
+  std::exception_ptr m_error;
+
+  // The first detector is used by the calling thread, the others by the pool threads
+  explicit vpBatchPool(const std::vector<vpDetectorBase *> &detectors)
+    : m_threads(), m_mutex(), m_start(), m_done(), m_stop(false), m_batch(0), m_nbThreads(0), m_nbRunning(0),
+      m_images(NULL), m_results(NULL), m_next(0), m_error()
+  {
+    for (size_t k = 1; k < detectors.size(); k++) {
+      m_threads.push_back(std::thread(&vpBatchPool::run, this, detectors[k], k));
+    }
+  }
+
+  ~vpBatchPool()
+  {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_stop = true;
+    }
+    m_start.notify_all();
+    for (size_t k = 0; k < m_threads.size(); k++) {
+      m_threads[k].join();
+    }
+  }
+
+  void run(vpDetectorBase *detector, size_t index)
+  {
+    unsigned long batch = 0;
+    for (;;) {
+      {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_start.wait(lock, [&] { return m_stop || m_batch != batch; });
+        if (m_stop) {
+          return;
+        }
+        batch = m_batch;
+        if (index >= m_nbThreads) {
+          continue;
+        }
+      }
+      detectBatch(detector, *m_images, *m_results, m_next, m_mutex, m_error);
+      std::lock_guard<std::mutex> lock(m_mutex);
+      if (--m_nbRunning == 0) {
+        m_done.notify_one();
+      }
+    }
+  }
+
+  // Detect the objects with nbThreads threads, including the calling thread that uses detector
+  void detect(vpDetectorBase *detector, const std::vector<const vpImage<unsigned char> *> &images,
+              std::vector<vpDetectionResult> &results, size_t nbThreads)
+  {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_images = &images;
+      m_results = &results;
+      m_next = 0;
+      m_error = std::exception_ptr();
+      m_nbThreads = std::min(nbThreads, m_threads.size() + 1);
+      m_nbRunning = m_nbThreads - 1;
+      m_batch++;
+    }
+    m_start.notify_all();
+
+    detectBatch(detector, images, results, m_next, m_mutex, m_error);
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_done.wait(lock, [&] { return m_nbRunning == 0; });
+    if (m_error) {
+      std::rethrow_exception(m_error);
+    }
+  }
+};
+#endif
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
 /*!
         Default constructor.
 */
-vpDetectorBase::vpDetectorBase() : m_polygon(), m_message(), m_nb_objects(0), m_timeout_ms(0) {}
+vpDetectorBase::vpDetectorBase()
+  : m_polygon(), m_message(), m_nb_objects(0), m_timeout_ms(0), m_batch_nb_threads(0), m_batch_detectors(),
+    m_batch_pool(NULL)
+{
+}
 
+/*!
+  Copy constructor. The detectors of the batch detection are not copied.
+*/
 vpDetectorBase::vpDetectorBase(const vpDetectorBase &o)
-  : m_polygon(o.m_polygon), m_message(o.m_message), m_nb_objects(o.m_nb_objects), m_timeout_ms(o.m_timeout_ms)
+  : m_polygon(o.m_polygon), m_message(o.m_message), m_nb_objects(o.m_nb_objects), m_timeout_ms(o.m_timeout_ms),
+    m_batch_nb_threads(o.m_batch_nb_threads), m_batch_detectors(), m_batch_pool(NULL)
+{
+}
+
+/*!
+  Destructor.
+*/
+vpDetectorBase::~vpDetectorBase() { clearBatchDetectors(); }
+
+/*!
+  Copy operator. The detectors of the batch detection are not copied.
+*/
+vpDetectorBase &vpDetectorBase::operator=(const vpDetectorBase &o)
+{
+  if (this != &o) {
+    m_polygon = o.m_polygon;
+    m_message = o.m_message;
+    m_nb_objects = o.m_nb_objects;
+    m_timeout_ms = o.m_timeout_ms;
+    m_batch_nb_threads = o.m_batch_nb_threads;
+    clearBatchDetectors();
+  }
+  return *this;
+}
+
+/*!
+  Stop the threads and delete the detectors kept by the batch detection, so
+  that the next batch clones this detector again with its current settings.
+*/
+void vpDetectorBase::clearBatchDetectors()
+{
+#if (VISP_CXX_STANDARD >= VISP_CXX_STANDARD_11)
+  delete m_batch_pool;
+  m_batch_pool = NULL;
+#endif
+  for (size_t i = 0; i < m_batch_detectors.size(); i++) {
+    delete m_batch_detectors[i];
+  }
+  m_batch_detectors.clear();
+}
+
+/*!
+  Detect objects in several images, shared between a pool of threads (see
+  setBatchNbThreads()). Each thread uses its own detector returned by
+  clone(). The threads and their detectors are kept for the next batches, so
+  that the images are processed
+  independently of each other and the objects detected by
+  detect(const vpImage<unsigned char> &) are kept. When the detector cannot be cloned, or without C++11 support, the
+  images are processed one after the other with this detector.
+
+  \param images : Images where to detect objects.
+  \param results : Objects detected in each image, in the same order as the
+  images.
+  \return true if one or multiple objects are detected in at least one image,
+  false otherwise.
+*/
+bool vpDetectorBase::detect(const std::vector<const vpImage<unsigned char> *> &images,
+                            std::vector<vpDetectionResult> &results)
 {
+  for (size_t i = 0; i < images.size(); i++) {
+    if (images[i] == NULL) {
+      throw(vpException(vpException::badValue, "Image %u of the batch is NULL", static_cast<unsigned int>(i)));
+    }
+  }
+
+  results.clear();
+  results.resize(images.size());
+
+  unsigned int nbThreads = 1;
+#if (VISP_CXX_STANDARD >= VISP_CXX_STANDARD_11)
+  nbThreads = m_batch_nb_threads;
+  if (nbThreads == 0) {
+    nbThreads = std::max(1u, std::thread::hardware_concurrency());
+  }
+#endif
+  nbThreads = static_cast<unsigned int>(std::min(static_cast<size_t>(nbThreads), images.size()));
+
+  while (m_batch_detectors.size() < nbThreads) {
+    vpDetectorBase *detector = clone();
+    if (detector == NULL) {
+      break;
+    }
+    m_batch_detectors.push_back(detector);
+  }
+  nbThreads = static_cast<unsigned int>(std::min(static_cast<size_t>(nbThreads), m_batch_detectors.size()));
+
+  if (nbThreads == 0) {
+    bool detected = false;
+    for (size_t i = 0; i < images.size(); i++) {
+      detected |= detect(*images[i]);
+      results[i].polygon = m_polygon;
+      results[i].message = m_message;
+    }
+    return detected;
+  }
+
+#if (VISP_CXX_STANDARD >= VISP_CXX_STANDARD_11)
+  // The threads are started again only when new detectors have been cloned
+  if (m_batch_pool == NULL || m_batch_pool->m_threads.size() + 1 != m_batch_detectors.size()) {
+    delete m_batch_pool;
+    m_batch_pool = NULL;
+    m_batch_pool = new vpBatchPool(m_batch_detectors);
+  }
+  // The calling thread works with the first detector
+  m_batch_pool->detect(m_batch_detectors[0], images, results, nbThreads);
+#else
+  vpDetectorBase *detector = m_batch_detectors[0];
+  for (size_t i = 0; i < images.size(); i++) {
+    detector->detect(*images[i]);
+    results[i].polygon = detector->m_polygon;
+    results[i].message = detector->m_message;
+  }
+#endif
+
+  for (size_t i = 0; i < results.size(); i++) {
+    if (!results[i].polygon.empty()) {
+      return true;
+    }
+  }
+  return false;
 }
 
 /*!
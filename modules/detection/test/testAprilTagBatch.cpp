@@ -0,0 +1,216 @@
+/****************************************************************************
+ *
+ * ViSP, open source Visual Servoing Platform software.
+ * Copyright (C) 2005 - 2019 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test the detection of AprilTag tags in a batch of images.
+ *
+ *****************************************************************************/
+
+#include <visp3/core/vpConfig.h>
+
+/*!
+  \example testAprilTagBatch.cpp
+
+  \brief Test the detection of AprilTag tags in a batch of synthetic images
+  shared between several threads.
+*/
+
+#if defined(VISP_HAVE_CATCH2) && defined(VISP_HAVE_APRILTAG)
+#define CATCH_CONFIG_RUNNER
+#include <catch.hpp>
+
+#include <iostream>
+#include <visp3/core/vpImage.h>
+#include <visp3/core/vpTime.h>
+#include <visp3/detection/vpDetectorAprilTag.h>
+
+namespace
+{
+// Layout of the 36 bits of the 36h11 family inside the 6x6 data cells
+const unsigned int bit_x[36] = {1, 2, 3, 4, 5, 2, 3, 4, 3, 6, 6, 6, 6, 6, 5, 5, 5, 4,
+                                6, 5, 4, 3, 2, 5, 4, 3, 4, 1, 1, 1, 1, 1, 2, 2, 2, 3};
+const unsigned int bit_y[36] = {1, 1, 1, 1, 1, 2, 2, 2, 3, 1, 2, 3, 4, 5, 2, 3, 4, 3,
+                                6, 6, 6, 6, 6, 5, 5, 5, 4, 6, 5, 4, 3, 2, 5, 4, 3, 4};
+// Codes of the 36h11 tags with id 0, 1 and 2
+const uint64_t codes[3] = {0x0000000d7e00984bULL, 0x0000000dda664ca7ULL, 0x0000000dc4a1c821ULL};
+
+// Draw a 36h11 tag with its white border, each cell being cellSize pixels wide
+void drawTag(vpImage<unsigned char> &I, int id, int top, int left, int cellSize)
+{
+  for (int cy = 0; cy < 10; cy++) {
+    for (int cx = 0; cx < 10; cx++) {
+      unsigned char value = 0;
+      if (cx == 0 || cy == 0 || cx == 9 || cy == 9) {
+        value = 255;
+      }
+      for (unsigned int b = 0; b < 36; b++) {
+        if (static_cast<int>(bit_x[b]) + 1 == cx && static_cast<int>(bit_y[b]) + 1 == cy &&
+            (codes[id] & (1ULL << (35 - b)))) {
+          value = 255;
+        }
+      }
+      for (int y = 0; y < cellSize; y++) {
+        for (int x = 0; x < cellSize; x++) {
+          I[top + cy * cellSize + y][left + cx * cellSize + x] = value;
+        }
+      }
+    }
+  }
+}
+
+// Draw the tags 0, 1 and 2 at positions depending on the frame index
+void drawFrame(vpImage<unsigned char> &I, int frame)
+{
+  I = 180;
+  drawTag(I, 0, 10 + 3 * frame, 20 + 5 * frame, 5);
+  if (frame % 3 != 0) {
+    drawTag(I, 1, 150 - 2 * frame, 200, 4);
+  }
+  if (frame % 2 == 0) {
+    drawTag(I, 2, 170, 30 + 4 * frame, 6);
+  }
+}
+} // namespace
+
+TEST_CASE("Batch detection", "[apriltag]")
+{
+  const int nbFrames = 24;
+  std::vector<vpImage<unsigned char> > frames(nbFrames, vpImage<unsigned char>(240, 320));
+  std::vector<const vpImage<unsigned char> *> images;
+  for (int i = 0; i < nbFrames; i++) {
+    drawFrame(frames[i], i);
+    images.push_back(&frames[i]);
+  }
+
+  // Reference: one image after the other
+  vpDetectorAprilTag reference(vpDetectorAprilTag::TAG_36h11);
+  std::vector<std::vector<std::string> > messages(nbFrames);
+  std::vector<std::vector<std::vector<vpImagePoint> > > polygons(nbFrames);
+  double t = vpTime::measureTimeMs();
+  for (int i = 0; i < nbFrames; i++) {
+    REQUIRE(reference.detect(frames[i]));
+    messages[i] = reference.getMessage();
+    polygons[i] = reference.getPolygon();
+    CHECK(messages[i].size() == static_cast<size_t>(1 + (i % 3 != 0) + (i % 2 == 0)));
+  }
+  double t_reference = vpTime::measureTimeMs() - t;
+
+  vpDetectorAprilTag detector(vpDetectorAprilTag::TAG_36h11);
+  // The batch detection does not change the objects detected in a single image
+  REQUIRE(detector.detect(frames[0]));
+  size_t nbObjects = detector.getNbObjects();
+
+  for (unsigned int nbThreads = 0; nbThreads <= 4; nbThreads++) {
+    detector.setBatchNbThreads(nbThreads);
+    std::vector<vpDetectorBase::vpDetectionResult> results;
+    // The first batch clones the detector for each thread
+    REQUIRE(detector.detect(images, results));
+    t = vpTime::measureTimeMs();
+    REQUIRE(detector.detect(images, results));
+    double t_batch = vpTime::measureTimeMs() - t;
+    std::cout << "Batch of " << nbFrames << " images with " << nbThreads << " threads: " << t_batch
+              << " ms, one image after the other: " << t_reference << " ms" << std::endl;
+
+    REQUIRE(results.size() == images.size());
+    for (int i = 0; i < nbFrames; i++) {
+      CHECK(results[i].message == messages[i]);
+      REQUIRE(results[i].polygon.size() == polygons[i].size());
+      for (size_t j = 0; j < polygons[i].size(); j++) {
+        REQUIRE(results[i].polygon[j].size() == polygons[i][j].size());
+        for (size_t k = 0; k < polygons[i][j].size(); k++) {
+          CHECK(results[i].polygon[j][k] == polygons[i][j][k]);
+        }
+      }
+    }
+    CHECK(detector.getNbObjects() == nbObjects);
+  }
+
+  // Empty batch and images without tags
+  std::vector<vpDetectorBase::vpDetectionResult> results;
+  CHECK(!detector.detect(std::vector<const vpImage<unsigned char> *>(), results));
+  CHECK(results.empty());
+  vpImage<unsigned char> I_empty(100, 100, 0);
+  CHECK(!detector.detect(std::vector<const vpImage<unsigned char> *>(3, &I_empty), results));
+  CHECK(results.size() == 3);
+
+  // The detectors of the batch follow the settings of the detector
+  detector.setAprilTagFamily(vpDetectorAprilTag::TAG_25h9);
+  CHECK(!detector.detect(std::vector<const vpImage<unsigned char> *>(images.begin(), images.begin() + 4), results));
+  CHECK(results.size() == 4);
+  detector.setAprilTagFamily(vpDetectorAprilTag::TAG_36h11);
+  CHECK(detector.detect(std::vector<const vpImage<unsigned char> *>(images.begin(), images.begin() + 4), results));
+  CHECK(results[0].message == messages[0]);
+
+  // The detectors of the batch are created with the settings of the detector
+  detector.setAprilTagQuadDecimate(2);
+  detector.setAprilTagQuadSigma(0.8f);
+  detector.setAprilTagRefineEdges(false);
+  detector.setAprilTagDecodeSharpening(0.5);
+  detector.setBatchNbThreads(2);
+  REQUIRE(detector.detect(images, results));
+  REQUIRE(results.size() == images.size());
+  for (int i = 0; i < nbFrames; i++) {
+    detector.detect(frames[i]);
+    CHECK(results[i].message == detector.getMessage());
+    std::vector<std::vector<vpImagePoint> > polygon = detector.getPolygon();
+    REQUIRE(results[i].polygon.size() == polygon.size());
+    for (size_t j = 0; j < polygon.size(); j++) {
+      REQUIRE(results[i].polygon[j].size() == polygon[j].size());
+      for (size_t k = 0; k < polygon[j].size(); k++) {
+        CHECK(results[i].polygon[j][k] == polygon[j][k]);
+      }
+    }
+  }
+
+  // Invalid image
+  images[5] = NULL;
+  CHECK_THROWS_AS(detector.detect(images, results), vpException);
+}
+
+int main(int argc, char *argv[])
+{
+  Catch::Session session; // There must be exactly one instance
+
+  // Let Catch (using Clara) parse the command line
+  session.applyCommandLine(argc, argv);
+
+  int numFailed = session.run();
+
+  // numFailed is clamped to 255 as some unices only use the lower 8 bits.
+  // This clamping has already been applied, so just return it here
+  // You can also do any post run clean-up here
+  return numFailed;
+}
+#else
+int main()
+{
+  return 0;
+}
+#endif
@@ -0,0 +1,304 @@
+/****************************************************************************
+ *
+ * ViSP, open source Visual Servoing Platform software.
+ * Copyright (C) 2005 - 2019 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test AprilTag detection with tracking of the tags.
+ *
+ *****************************************************************************/
+
+#include <visp3/core/vpConfig.h>
+
+/*!
+  \example testAprilTagTracking.cpp
+
+  \brief Test AprilTag detection in regions of interest around the tags
+  detected in the previous images, on a synthetic sequence, and with
+  several threads.
+*/
+
+#if defined(VISP_HAVE_CATCH2) && defined(VISP_HAVE_APRILTAG)
+#define CATCH_CONFIG_RUNNER
+#include <catch.hpp>
+
+#include <algorithm>
+#include <iostream>
+#include <visp3/core/vpImage.h>
+#include <visp3/detection/vpDetectorAprilTag.h>
+
+namespace
+{
+// Layout of the 36 bits of the 36h11 family inside the 6x6 data cells
+const unsigned int bit_x[36] = {1, 2, 3, 4, 5, 2, 3, 4, 3, 6, 6, 6, 6, 6, 5, 5, 5, 4,
+                                6, 5, 4, 3, 2, 5, 4, 3, 4, 1, 1, 1, 1, 1, 2, 2, 2, 3};
+const unsigned int bit_y[36] = {1, 1, 1, 1, 1, 2, 2, 2, 3, 1, 2, 3, 4, 5, 2, 3, 4, 3,
+                                6, 6, 6, 6, 6, 5, 5, 5, 4, 6, 5, 4, 3, 2, 5, 4, 3, 4};
+// Codes of the 36h11 tags with id 0, 1 and 2
+const uint64_t codes[3] = {0x0000000d7e00984bULL, 0x0000000dda664ca7ULL, 0x0000000dc4a1c821ULL};
+
+// Draw a 36h11 tag with its white border, each cell being cellSize pixels wide
+void drawTag(vpImage<unsigned char> &I, int id, int top, int left, int cellSize)
+{
+  for (int cy = 0; cy < 10; cy++) {
+    for (int cx = 0; cx < 10; cx++) {
+      unsigned char value = 0;
+      if (cx == 0 || cy == 0 || cx == 9 || cy == 9) {
+        value = 255;
+      }
+      for (unsigned int b = 0; b < 36; b++) {
+        if (static_cast<int>(bit_x[b]) + 1 == cx && static_cast<int>(bit_y[b]) + 1 == cy &&
+            (codes[id] & (1ULL << (35 - b)))) {
+          value = 255;
+        }
+      }
+      for (int y = 0; y < cellSize; y++) {
+        for (int x = 0; x < cellSize; x++) {
+          I[top + cy * cellSize + y][left + cx * cellSize + x] = value;
+        }
+      }
+    }
+  }
+}
+
+struct vpSyntheticTag {
+  int id;
+  int top, left;
+  int dv, du;
+};
+
+void drawFrame(vpImage<unsigned char> &I, const std::vector<vpSyntheticTag> &tags, int frame)
+{
+  I = 180;
+  for (size_t i = 0; i < tags.size(); i++) {
+    drawTag(I, tags[i].id, tags[i].top + frame * tags[i].dv, tags[i].left + frame * tags[i].du, 6);
+  }
+}
+
+void checkSameDetections(vpDetectorAprilTag &detector, vpDetectorAprilTag &reference)
+{
+  REQUIRE(detector.getNbObjects() == reference.getNbObjects());
+  for (size_t i = 0; i < reference.getNbObjects(); i++) {
+    bool found = false;
+    for (size_t j = 0; j < detector.getNbObjects() && !found; j++) {
+      if (detector.getMessage(j) == reference.getMessage(i)) {
+        found = true;
+        std::vector<vpImagePoint> corners = detector.getPolygon(j), corners_ref = reference.getPolygon(i);
+        for (size_t k = 0; k < corners.size(); k++) {
+          CHECK(vpImagePoint::distance(corners[k], corners_ref[k]) < 0.5);
+        }
+      }
+    }
+    CHECK(found);
+  }
+}
+} // namespace
+
+TEST_CASE("Tracking of moving tags", "[apriltag]")
+{
+  vpImage<unsigned char> I(480, 640);
+  std::vector<vpSyntheticTag> tags;
+  vpSyntheticTag tag0 = {0, 40, 30, 3, 5};
+  vpSyntheticTag tag1 = {1, 300, 500, -2, -4};
+  tags.push_back(tag0);
+  tags.push_back(tag1);
+
+  vpDetectorAprilTag reference(vpDetectorAprilTag::TAG_36h11);
+  vpDetectorAprilTag detector(vpDetectorAprilTag::TAG_36h11);
+  const unsigned int period = 5;
+  detector.setRoiTracking(true, period);
+
+  double t_reference = 0, t_tracking = 0;
+  const int nbFrames = 30;
+  for (int frame = 0; frame < nbFrames; frame++) {
+    drawFrame(I, tags, frame);
+    REQUIRE(reference.detect(I));
+    REQUIRE(detector.detect(I));
+    REQUIRE(reference.getNbObjects() == 2);
+    checkSameDetections(detector, reference);
+
+    // The whole image is only processed every period images
+    CHECK(detector.getRois().empty() == (frame % period == 0));
+    for (size_t i = 0; i < detector.getRois().size(); i++) {
+      CHECK(detector.getRois()[i].getArea() < I.getSize() / 4);
+    }
+
+    std::vector<std::string> stages, stages_ref;
+    std::vector<double> durations, durations_ref;
+    detector.getTimings(stages, durations);
+    reference.getTimings(stages_ref, durations_ref);
+    REQUIRE(stages.size() == durations.size());
+    REQUIRE(!stages.empty());
+    CHECK(std::find(stages.begin(), stages.end(), "threshold") != stages.end());
+    CHECK(stages.back() == "total");
+    CHECK(stages_ref.back() == "total");
+    CHECK(std::find(stages_ref.begin(), stages_ref.end(), "roi") == stages_ref.end());
+    for (size_t i = 0; i < durations.size(); i++) {
+      CHECK(durations[i] >= 0);
+    }
+    t_tracking += durations.back();
+    t_reference += durations_ref.back();
+
+    if (frame == nbFrames - 1) {
+      std::cout << "Stages of the last detection in regions of interest:" << std::endl;
+      for (size_t i = 0; i < stages.size(); i++) {
+        std::cout << "  " << stages[i] << ": " << durations[i] << " ms" << std::endl;
+      }
+    }
+  }
+  std::cout << "Mean detection time: " << t_reference / nbFrames << " ms in the whole image, "
+            << t_tracking / nbFrames << " ms with tracking" << std::endl;
+}
+
+TEST_CASE("Tracking of appearing and disappearing tags", "[apriltag]")
+{
+  vpImage<unsigned char> I(480, 640);
+  std::vector<vpSyntheticTag> tags;
+  vpSyntheticTag tag0 = {0, 100, 100, 0, 1};
+  vpSyntheticTag tag1 = {1, 200, 400, 1, 0};
+  tags.push_back(tag0);
+  tags.push_back(tag1);
+
+  vpDetectorAprilTag detector(vpDetectorAprilTag::TAG_36h11);
+  const unsigned int period = 10;
+  detector.setRoiTracking(true, period);
+
+  drawFrame(I, tags, 0);
+  REQUIRE(detector.detect(I));
+  CHECK(detector.getNbObjects() == 2);
+  CHECK(detector.getRois().empty());
+
+  drawFrame(I, tags, 1);
+  REQUIRE(detector.detect(I));
+  CHECK(detector.getNbObjects() == 2);
+  CHECK(!detector.getRois().empty());
+
+  SECTION("Lost tag")
+  {
+    // The remaining tag is found in its region, the next image is processed entirely
+    tags.pop_back();
+    drawFrame(I, tags, 2);
+    REQUIRE(detector.detect(I));
+    CHECK(detector.getNbObjects() == 1);
+    CHECK(!detector.getRois().empty());
+
+    drawFrame(I, tags, 3);
+    REQUIRE(detector.detect(I));
+    CHECK(detector.getNbObjects() == 1);
+    CHECK(detector.getRois().empty());
+  }
+
+  SECTION("All tags lost")
+  {
+    // The whole image is processed as soon as no tag is found in the regions
+    vpSyntheticTag tag2 = {2, 350, 40, 0, 0};
+    tags.clear();
+    tags.push_back(tag2);
+    drawFrame(I, tags, 2);
+    REQUIRE(detector.detect(I));
+    CHECK(detector.getNbObjects() == 1);
+    CHECK(detector.getMessage(0) == "36h11 id: 2");
+    CHECK(detector.getRois().empty());
+  }
+
+  SECTION("New tag")
+  {
+    // A new tag is detected at the latest with the next whole image detection
+    vpSyntheticTag tag2 = {2, 350, 40, 0, 0};
+    tags.push_back(tag2);
+    int frame = 2;
+    for (; frame < 2 + static_cast<int>(period); frame++) {
+      drawFrame(I, tags, frame);
+      REQUIRE(detector.detect(I));
+      if (detector.getNbObjects() == 3) {
+        break;
+      }
+      CHECK(!detector.getRois().empty());
+    }
+    CHECK(detector.getNbObjects() == 3);
+    CHECK(detector.getRois().empty());
+    CHECK(frame == static_cast<int>(period));
+  }
+
+  SECTION("Disabled")
+  {
+    detector.setRoiTracking(false);
+    drawFrame(I, tags, 2);
+    REQUIRE(detector.detect(I));
+    CHECK(detector.getNbObjects() == 2);
+    CHECK(detector.getRois().empty());
+  }
+}
+
+TEST_CASE("Detection with several threads", "[apriltag]")
+{
+  // Size that is not a multiple of the tile and vector sizes, with tags
+  // touching the last columns and rows
+  vpImage<unsigned char> I(487, 643);
+  std::vector<vpSyntheticTag> tags;
+  vpSyntheticTag tag0 = {0, 3, 5, 0, 0};
+  vpSyntheticTag tag1 = {1, 200, 579, 0, 0};
+  vpSyntheticTag tag2 = {2, 421, 300, 0, 0};
+  tags.push_back(tag0);
+  tags.push_back(tag1);
+  tags.push_back(tag2);
+  drawFrame(I, tags, 0);
+
+  vpDetectorAprilTag reference(vpDetectorAprilTag::TAG_36h11);
+  reference.setAprilTagNbThreads(1);
+  REQUIRE(reference.detect(I));
+  CHECK(reference.getNbObjects() == 3);
+
+  for (int nThreads = 2; nThreads <= 4; nThreads++) {
+    vpDetectorAprilTag detector(vpDetectorAprilTag::TAG_36h11);
+    detector.setAprilTagNbThreads(nThreads);
+    REQUIRE(detector.detect(I));
+    checkSameDetections(detector, reference);
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  Catch::Session session; // There must be exactly one instance
+
+  // Let Catch (using Clara) parse the command line
+  session.applyCommandLine(argc, argv);
+
+  int numFailed = session.run();
+
+  // numFailed is clamped to 255 as some unices only use the lower 8 bits.
+  // This clamping has already been applied, so just return it here
+  // You can also do any post run clean-up here
+  return numFailed;
+}
+#else
+int main()
+{
+  return 0;
+}
+#endif
@@ -241,14 +241,87 @@ struct vpContour {
   }
 };
 
+/*!
+  \ingroup group_imgproc_contours
+
+  Contours stored in flat arrays instead of a tree of vpContour.
+
+  The points of all the contours are stored one contour after the other in
+  m_points, the points of the contour \e k being the m_points elements from
+  m_offsets[k] to m_offsets[k+1]-1. The hierarchy is given by indexes in the
+  set, -1 meaning no contour: m_parents[k] is the contour enclosing the
+  contour \e k, m_firstChildren[k] the first contour it encloses and
+  m_nextSiblings[k] the next contour with the same parent. The contours
+  without parent are chained from m_firstRoot.
+
+  \code
+for (int k = contours.m_firstRoot; k != -1; k = contours.m_nextSiblings[k]) {
+  // Outer contour k and its holes
+  for (int h = contours.m_firstChildren[k]; h != -1; h = contours.m_nextSiblings[h]) {
+  }
+}
+  \endcode
+*/
+struct vpContourSet {
+  //! Points of all the contours
+  std::vector<vpImagePoint> m_points;
+  //! Index in m_points of the first point of each contour, followed by the total number of points
+  std::vector<unsigned int> m_offsets;
+  //! Type of each contour
+  std::vector<vpContourType> m_types;
+  //! Index of the parent of each contour, or -1
+  std::vector<int> m_parents;
+  //! Index of the first child of each contour, or -1
+  std::vector<int> m_firstChildren;
+  //! Index of the next sibling of each contour, or -1
+  std::vector<int> m_nextSiblings;
+  //! Index of the first contour without parent, or -1
+  int m_firstRoot;
+
+  vpContourSet()
+    : m_points(), m_offsets(1, 0), m_types(), m_parents(), m_firstChildren(), m_nextSiblings(), m_firstRoot(-1)
+  {
+  }
+
+  void clear()
+  {
+    m_points.clear();
+    m_offsets.assign(1, 0);
+    m_types.clear();
+    m_parents.clear();
+    m_firstChildren.clear();
+    m_nextSiblings.clear();
+    m_firstRoot = -1;
+  }
+
+  /*!
+    Copy the points of the contour \e index in \e points.
+  */
+  void getContour(unsigned int index, std::vector<vpImagePoint> &points) const
+  {
+    points.assign(m_points.begin() + m_offsets[index], m_points.begin() + m_offsets[index + 1]);
+  }
+
+  //! Return the number of points of the contour \e index.
+  unsigned int getNbPoints(unsigned int index) const { return m_offsets[index + 1] - m_offsets[index]; }
+
+  //! Return the number of contours.
+  unsigned int size() const { return static_cast<unsigned int>(m_types.size()); }
+};
+
 VISP_EXPORT void drawContours(vpImage<unsigned char> &I, const std::vector<std::vector<vpImagePoint> > &contours,
                               unsigned char grayValue = 255);
 VISP_EXPORT void drawContours(vpImage<vpRGBa> &I, const std::vector<std::vector<vpImagePoint> > &contours,
                               const vpColor &color);
+VISP_EXPORT void drawContours(vpImage<unsigned char> &I, const vpContourSet &contours, unsigned char grayValue = 255);
+VISP_EXPORT void drawContours(vpImage<vpRGBa> &I, const vpContourSet &contours, const vpColor &color);
 
 VISP_EXPORT void findContours(const vpImage<unsigned char> &I_original, vpContour &contours,
                               std::vector<std::vector<vpImagePoint> > &contourPts,
                               const vpContourRetrievalType &retrievalMode = vp::CONTOUR_RETR_TREE);
+VISP_EXPORT void findContours(const vpImage<unsigned char> &I, vpContourSet &contours,
+                              const vpContourRetrievalType &retrievalMode = vp::CONTOUR_RETR_TREE,
+                              double epsilon = 0.);
 }
 
 #endif
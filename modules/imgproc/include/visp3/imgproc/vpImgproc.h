@@ -45,8 +45,10 @@
 #ifndef _vpImgproc_h_
 #define _vpImgproc_h_
 
+#include <visp3/core/vpHistogram.h>
 #include <visp3/core/vpImage.h>
 #include <visp3/core/vpImageMorphology.h>
+#include <visp3/core/vpRect.h>
 #include <visp3/imgproc/vpContours.h>
 
 #define USE_OLD_FILL_HOLE 0
@@ -83,6 +85,19 @@ typedef enum {
                               */
 } vpAutoThresholdMethod;
 
+/*!
+  Statistics of a connected component computed by connectedComponents().
+*/
+struct vpConnectedComponent {
+  int m_label;              //!< Label of the component in the label image.
+  unsigned char m_value;    //!< Value of the pixels of the component.
+  unsigned int m_area;      //!< Number of pixels of the component.
+  vpRect m_bbox;            //!< Bounding box of the component, in pixels.
+  vpImagePoint m_centroid;  //!< Center of gravity of the component.
+
+  vpConnectedComponent() : m_label(0), m_value(0), m_area(0), m_bbox(), m_centroid() {}
+};
+
 VISP_EXPORT void adjust(vpImage<unsigned char> &I, double alpha, double beta);
 VISP_EXPORT void adjust(const vpImage<unsigned char> &I1, vpImage<unsigned char> &I2, double alpha,
                         double beta);
@@ -95,6 +110,7 @@ VISP_EXPORT void clahe(const vpImage<vpRGBa> &I1, vpImage<vpRGBa> &I2, int block
                        int bins = 256, float slope = 3.0f, bool fast = true);
 
 VISP_EXPORT void equalizeHistogram(vpImage<unsigned char> &I);
+VISP_EXPORT void equalizeHistogram(vpImage<unsigned char> &I, const vpHistogram &hist);
 VISP_EXPORT void equalizeHistogram(const vpImage<unsigned char> &I1, vpImage<unsigned char> &I2);
 VISP_EXPORT void equalizeHistogram(vpImage<vpRGBa> &I, bool useHSV = false);
 VISP_EXPORT void equalizeHistogram(const vpImage<vpRGBa> &I1, vpImage<vpRGBa> &I2, bool useHSV = false);
@@ -110,6 +126,7 @@ VISP_EXPORT void retinex(const vpImage<vpRGBa> &I1, vpImage<vpRGBa> &I2, int sca
                          int level = RETINEX_UNIFORM, double dynamic = 1.2, int kernelSize = -1);
 
 VISP_EXPORT void stretchContrast(vpImage<unsigned char> &I);
+VISP_EXPORT void stretchContrast(vpImage<unsigned char> &I, const vpHistogram &hist);
 VISP_EXPORT void stretchContrast(const vpImage<unsigned char> &I1, vpImage<unsigned char> &I2);
 VISP_EXPORT void stretchContrast(vpImage<vpRGBa> &I);
 VISP_EXPORT void stretchContrast(const vpImage<vpRGBa> &I1, vpImage<vpRGBa> &I2);
@@ -127,6 +144,10 @@ VISP_EXPORT void unsharpMask(const vpImage<vpRGBa> &I, vpImage<vpRGBa> &Ires, un
 VISP_EXPORT void
 connectedComponents(const vpImage<unsigned char> &I, vpImage<int> &labels, int &nbComponents,
                     const vpImageMorphology::vpConnexityType &connexity = vpImageMorphology::CONNEXITY_4);
+VISP_EXPORT void
+connectedComponents(const vpImage<unsigned char> &I, vpImage<int> &labels, int &nbComponents,
+                    std::vector<vpConnectedComponent> &components,
+                    const vpImageMorphology::vpConnexityType &connexity = vpImageMorphology::CONNEXITY_4);
 
 VISP_EXPORT void fillHoles(vpImage<unsigned char> &I
 #if USE_OLD_FILL_HOLE
@@ -146,6 +167,10 @@ VISP_EXPORT void reconstruct(const vpImage<unsigned char> &marker, const vpImage
 VISP_EXPORT unsigned char autoThreshold(vpImage<unsigned char> &I, const vp::vpAutoThresholdMethod &method,
                                         const unsigned char backgroundValue = 0,
                                         const unsigned char foregroundValue = 255);
+VISP_EXPORT unsigned char autoThreshold(vpImage<unsigned char> &I, const vpHistogram &histogram,
+                                        const vp::vpAutoThresholdMethod &method,
+                                        const unsigned char backgroundValue = 0,
+                                        const unsigned char foregroundValue = 255);
 }
 
 #endif
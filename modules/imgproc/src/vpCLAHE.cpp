@@ -84,6 +84,10 @@
 #include <visp3/core/vpImageConvert.h>
 #include <visp3/imgproc/vpImgproc.h>
 
+#if defined _OPENMP
+#include <omp.h>
+#endif
+
 namespace
 {
 int fastRound(float value) { return (int)(value + 0.5f); }
@@ -120,7 +124,7 @@ void clipHistogram(const std::vector<int> &hist, std::vector<int> &clippedHist,
   } while (clippedEntries != clippedEntriesBefore);
 }
 
-void createHistogram(int blockRadius, int bins, int blockXCenter, int blockYCenter,
+void createHistogram(int blockRadius, const std::vector<int> &binOf, int blockXCenter, int blockYCenter,
                      const vpImage<unsigned char> &I, std::vector<int> &hist)
 {
   std::fill(hist.begin(), hist.end(), 0);
@@ -131,13 +135,14 @@ void createHistogram(int blockRadius, int bins, int blockXCenter, int blockYCent
   int yMax = std::min((int)I.getHeight(), blockYCenter + blockRadius + 1);
 
   for (int y = yMin; y < yMax; ++y) {
+    const unsigned char *row = I[y];
     for (int x = xMin; x < xMax; ++x) {
-      ++hist[fastRound(I[y][x] / 255.0f * bins)];
+      ++hist[binOf[row[x]]];
     }
   }
 }
 
-std::vector<float> createTransfer(const std::vector<int> &hist, int limit, std::vector<int> &cdfs)
+void createTransfer(const std::vector<int> &hist, int limit, std::vector<int> &cdfs, float *transfer)
 {
   clipHistogram(hist, cdfs, limit);
   int hMin = (int)hist.size() - 1;
@@ -156,12 +161,9 @@ std::vector<float> createTransfer(const std::vector<int> &hist, int limit, std::
   int cdfMin = cdfs[hMin];
   int cdfMax = cdfs[hist.size() - 1];
 
-  std::vector<float> transfer(hist.size());
-  for (int i = 0; i < (int)transfer.size(); ++i) {
+  for (int i = 0; i < (int)hist.size(); ++i) {
     transfer[i] = (cdfs[i] - cdfMin) / (float)(cdfMax - cdfMin);
   }
-
-  return transfer;
 }
 
 float transferValue(int v, std::vector<int> &clippedHist)
@@ -194,248 +196,189 @@ float transferValue(int v, const std::vector<int> &hist, std::vector<int> &clipp
 
   return transferValue(v, clippedHist);
 }
-}
-
-/*!
-  \ingroup group_imgproc_brightness
-
-  Adjust the contrast of a grayscale image locally using the Contrast Limited
-  Adaptative Histogram Equalization method. The limit parameter allows to
-  limit the slope of the transformation function to prevent the
-  overamplification of noise. This method is a transcription of the CLAHE
-  ImageJ plugin code by Stephan Saalfeld.
 
-  \param I1 : The first grayscale image.
-  \param I2 : The second grayscale image after application of the CLAHE
-  method.
-  \param blockRadius : The size (2*blockRadius+1) of the local region
-  around a pixel for which the histogram is equalized. This size should be
-  larger than the size of features to be preserved.
-  \param bins : The number
-  of histogram bins used for histogram equalization (between 1 and 256). The
-  number of histogram bins should be smaller than the number of pixels in a
-  block.
-  \param slope : Limits the contrast stretch in the intensity transfer
-  function. Very large values will let the histogram equalization do whatever
-  it wants to do, that is result in maximal local contrast. The value 1 will
-  result in the original image.
-  \param fast : Use the fast but less accurate
-  version of the filter. The fast version does not evaluate the intensity
-  transfer function for each pixel independently but for a grid of adjacent
-  boxes of the given block size only and interpolates for locations in
-  between.
+/*
+  Centers of the blocks along a dimension of the image, for the fast version
+  of CLAHE.
 */
-void vp::clahe(const vpImage<unsigned char> &I1, vpImage<unsigned char> &I2, int blockRadius, int bins,
-               float slope, bool fast)
+std::vector<int> blockCenters(int length, int blockRadius)
 {
-  if (blockRadius < 0) {
-    std::cerr << "Error: blockRadius < 0!" << std::endl;
-    return;
-  }
-
-  if (bins < 0 || bins > 256) {
-    std::cerr << "Error: (bins < 0 || bins > 256)!" << std::endl;
-    return;
-  }
+  int blockSize = 2 * blockRadius + 1;
+  int n = length / blockSize;
+  int m = length - n * blockSize;
+  std::vector<int> centers;
+
+  switch (m) {
+  case 0:
+    centers.resize((size_t)n);
+    for (int i = 0; i < n; ++i) {
+      centers[i] = i * blockSize + blockRadius + 1;
+    }
+    break;
 
-  if ((unsigned int)(2 * blockRadius + 1) > I1.getWidth() || (unsigned int)(2 * blockRadius + 1) > I1.getHeight()) {
-    std::cerr << "Error: (unsigned int) (2*blockRadius+1) > I1.getWidth() || "
-                 "(unsigned int) (2*blockRadius+1) > I1.getHeight()!"
-              << std::endl;
-    return;
+  case 1:
+    centers.resize((size_t)(n + 1));
+    for (int i = 0; i < n; ++i) {
+      centers[i] = i * blockSize + blockRadius + 1;
+    }
+    centers[n] = length - blockRadius - 1;
+    break;
+
+  default:
+    centers.resize((size_t)(n + 2));
+    centers[0] = blockRadius + 1;
+    for (int i = 0; i < n; ++i) {
+      centers[i + 1] = i * blockSize + blockRadius + 1 + m / 2;
+    }
+    centers[n + 1] = length - blockRadius - 1;
   }
 
-  I2.resize(I1.getHeight(), I1.getWidth());
+  return centers;
+}
 
-  if (fast) {
-    int blockSize = 2 * blockRadius + 1;
-    int limit = (int)(slope * blockSize * blockSize / bins + 0.5);
-
-    /* div */
-    int nc = I1.getWidth() / blockSize;
-    int nr = I1.getHeight() / blockSize;
-
-    /* % */
-    int cm = I1.getWidth() - nc * blockSize;
-    std::vector<int> cs;
-
-    switch (cm) {
-    case 0:
-      cs.resize(nc);
-      for (int i = 0; i < nc; ++i) {
-        cs[i] = i * blockSize + blockRadius + 1;
-      }
-      break;
+/*
+  Fast version: the transfer functions of the blocks centered on the grid
+  nodes are computed once, in parallel, then each cell between four nodes is
+  interpolated bilinearly. The cells are independent and processed in
+  parallel too.
+*/
+void claheFast(const vpImage<unsigned char> &I1, vpImage<unsigned char> &I2, int blockRadius, int bins, float slope,
+               const std::vector<int> &binOf)
+{
+  int blockSize = 2 * blockRadius + 1;
+  int limit = (int)(slope * blockSize * blockSize / bins + 0.5);
+
+  const std::vector<int> cs = blockCenters((int)I1.getWidth(), blockRadius);
+  const std::vector<int> rs = blockCenters((int)I1.getHeight(), blockRadius);
+  const int nbNodes = (int)(rs.size() * cs.size());
+  const size_t transferSize = (size_t)(bins + 1);
+
+  // Transfer function of each node of the grid
+  std::vector<float> transfers(nbNodes * transferSize);
+#if defined _OPENMP
+#pragma omp parallel
+#endif
+  {
+    std::vector<int> hist(transferSize);
+    std::vector<int> cdfs(transferSize);
 
-    case 1:
-      cs.resize(nc + 1);
-      for (int i = 0; i < nc; ++i) {
-        cs[i] = i * blockSize + blockRadius + 1;
-      }
-      cs[nc] = I1.getWidth() - blockRadius - 1;
-      break;
-
-    default:
-      cs.resize(nc + 2);
-      cs[0] = blockRadius + 1;
-      for (int i = 0; i < nc; ++i) {
-        cs[i + 1] = i * blockSize + blockRadius + 1 + cm / 2;
-      }
-      cs[nc + 1] = I1.getWidth() - blockRadius - 1;
+#if defined _OPENMP
+#pragma omp for schedule(dynamic)
+#endif
+    for (int node = 0; node < nbNodes; node++) {
+      int r = node / (int)cs.size(), c = node % (int)cs.size();
+      createHistogram(blockRadius, binOf, cs[c], rs[r], I1, hist);
+      createTransfer(hist, limit, cdfs, &transfers[node * transferSize]);
     }
+  }
 
-    int rm = I1.getHeight() - nr * blockSize;
-    std::vector<int> rs;
-
-    switch (rm) {
-    case 0:
-      rs.resize((size_t)nr);
-      for (int i = 0; i < nr; ++i) {
-        rs[i] = i * blockSize + blockRadius + 1;
-      }
-      break;
+  // Interpolation in the cells between the nodes
+  const int nbCellRows = (int)rs.size() + 1, nbCellCols = (int)cs.size() + 1;
+#if defined _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+  for (int cell = 0; cell < nbCellRows * nbCellCols; cell++) {
+    int r = cell / nbCellCols, c = cell % nbCellCols;
+    int r0 = std::max(0, r - 1);
+    int r1 = std::min((int)rs.size() - 1, r);
+    int dr = rs[r1] - rs[r0];
+    int c0 = std::max(0, c - 1);
+    int c1 = std::min((int)cs.size() - 1, c);
+    int dc = cs[c1] - cs[c0];
+
+    const float *tl = &transfers[(r0 * cs.size() + c0) * transferSize];
+    const float *tr = &transfers[(r0 * cs.size() + c1) * transferSize];
+    const float *bl = &transfers[(r1 * cs.size() + c0) * transferSize];
+    const float *br = &transfers[(r1 * cs.size() + c1) * transferSize];
+
+    int yMin = (r == 0 ? 0 : rs[r0]);
+    int yMax = (r < (int)rs.size() ? rs[r1] : (int)I1.getHeight());
+    int xMin = (c == 0 ? 0 : cs[c0]);
+    int xMax = (c < (int)cs.size() ? cs[c1] : (int)I1.getWidth());
+
+    for (int y = yMin; y < yMax; ++y) {
+      float wy = (r0 == r1) ? 0.0f : (float)(rs[r1] - y) / dr;
+      const unsigned char *src = I1[y];
+      unsigned char *dst = I2[y];
+
+      for (int x = xMin; x < xMax; ++x) {
+        int v = binOf[src[x]];
+        float t0 = 0.0f, t1 = 0.0f;
+
+        if (c0 == c1) {
+          t0 = tl[v];
+          t1 = bl[v];
+        } else {
+          float wx = (float)(cs[c1] - x) / dc;
+          t0 = wx * tl[v] + (1.0f - wx) * tr[v];
+          t1 = wx * bl[v] + (1.0f - wx) * br[v];
+        }
 
-    case 1:
-      rs.resize((size_t)(nr + 1));
-      for (int i = 0; i < nr; ++i) {
-        rs[i] = i * blockSize + blockRadius + 1;
-      }
-      rs[nr] = I1.getHeight() - blockRadius - 1;
-      break;
-
-    default:
-      rs.resize((size_t)(nr + 2));
-      rs[0] = blockRadius + 1;
-      for (int i = 0; i < nr; ++i) {
-        rs[i + 1] = i * blockSize + blockRadius + 1 + rm / 2;
+        float t = (r0 == r1) ? t0 : wy * t0 + (1.0f - wy) * t1;
+        dst[x] = (unsigned char)std::max(0, std::min(255, fastRound(t * 255.0f)));
       }
-      rs[nr + 1] = I1.getHeight() - blockRadius - 1;
     }
+  }
+}
 
-    std::vector<int> hist((size_t)(bins + 1));
-    std::vector<int> cdfs((size_t)(bins + 1));
-    std::vector<float> tl;
-    std::vector<float> tr;
-    std::vector<float> br;
-    std::vector<float> bl;
-
-    for (int r = 0; r <= (int)rs.size(); ++r) {
-      int r0 = std::max(0, r - 1);
-      int r1 = std::min((int)rs.size() - 1, r);
-      int dr = rs[r1] - rs[r0];
-
-      createHistogram(blockRadius, bins, cs[0], rs[r0], I1, hist);
-      tr = createTransfer(hist, limit, cdfs);
-      if (r0 == r1) {
-        br = tr;
-      } else {
-        createHistogram(blockRadius, bins, cs[0], rs[r1], I1, hist);
-        br = createTransfer(hist, limit, cdfs);
-      }
-
-      int yMin = (r == 0 ? 0 : rs[r0]);
-      int yMax = (r < (int)rs.size() ? rs[r1] : I1.getHeight());
-
-      for (int c = 0; c <= (int)cs.size(); ++c) {
-        int c0 = std::max(0, c - 1);
-        int c1 = std::min((int)cs.size() - 1, c);
-        int dc = cs[c1] - cs[c0];
-
-        tl = tr;
-        bl = br;
-
-        if (c0 != c1) {
-          createHistogram(blockRadius, bins, cs[c1], rs[r0], I1, hist);
-          tr = createTransfer(hist, limit, cdfs);
-          if (r0 == r1) {
-            br = tr;
-          } else {
-            createHistogram(blockRadius, bins, cs[c1], rs[r1], I1, hist);
-            br = createTransfer(hist, limit, cdfs);
-          }
-        }
+/*
+  Accurate version: the histogram of the block around each pixel is updated
+  incrementally, by removing the column leaving the block and adding the one
+  entering it. The image is split in horizontal bands processed in parallel,
+  each band starting its own sliding histogram.
+*/
+void claheAccurate(const vpImage<unsigned char> &I1, vpImage<unsigned char> &I2, int blockRadius, int bins,
+                   float slope, const std::vector<int> &binOf)
+{
+  const int width = (int)I1.getWidth(), height = (int)I1.getHeight();
+  int nbBands = 1;
+#if defined _OPENMP
+  nbBands = std::max(1, std::min(omp_get_max_threads(), height));
+#endif
 
-        int xMin = (c == 0 ? 0 : cs[c0]);
-        int xMax = (c < (int)cs.size() ? cs[c1] : I1.getWidth());
-        for (int y = yMin; y < yMax; ++y) {
-          float wy = (float)(rs[r1] - y) / dr;
-
-          for (int x = xMin; x < xMax; ++x) {
-            float wx = (float)(cs[c1] - x) / dc;
-            int v = fastRound(I1[y][x] / 255.0f * bins);
-            float t00 = tl[v];
-            float t01 = tr[v];
-            float t10 = bl[v];
-            float t11 = br[v];
-            float t0 = 0.0f, t1 = 0.0f;
-
-            if (c0 == c1) {
-              t0 = t00;
-              t1 = t10;
-            } else {
-              t0 = wx * t00 + (1.0f - wx) * t01;
-              t1 = wx * t10 + (1.0f - wx) * t11;
-            }
-
-            float t = (r0 == r1) ? t0 : wy * t0 + (1.0f - wy) * t1;
-            I2[y][x] = std::max(0, std::min(255, fastRound(t * 255.0f)));
-          }
-        }
-      }
-    }
-  } else {
-    std::vector<int> hist(bins + 1), prev_hist(bins + 1);
+#if defined _OPENMP
+#pragma omp parallel for schedule(static, 1)
+#endif
+  for (int band = 0; band < nbBands; band++) {
+    const int yStart = (int)(((long long)height * band) / nbBands);
+    const int yEnd = (int)(((long long)height * (band + 1)) / nbBands);
+    std::vector<int> hist(bins + 1, 0), rowHist(bins + 1, 0);
     std::vector<int> clippedHist(bins + 1);
 
-    bool first = true;
-    int xMin0 = 0;
-    int xMax0 = std::min((int)I1.getWidth(), blockRadius);
+    int xMax0 = std::min(width, blockRadius);
 
-    for (int y = 0; y < (int)I1.getHeight(); y++) {
+    for (int y = yStart; y < yEnd; y++) {
       int yMin = std::max(0, y - (int)blockRadius);
-      int yMax = std::min((int)I1.getHeight(), y + blockRadius + 1);
+      int yMax = std::min(height, y + blockRadius + 1);
       int h = yMax - yMin;
 
-#if 0
-      std::fill(hist.begin(), hist.end(), 0);
-      // Compute histogram for the current block
-      for (int yi = yMin; yi < yMax; yi++) {
-        for (int xi = xMin0; xi < xMax0; xi++) {
-          ++hist[fastRound(I1[yi][xi] / 255.0f * bins)];
-        }
-      }
-#else
-      if (first) {
-        first = false;
-        // Compute histogram for the block at (0,0)
+      if (y == yStart) {
+        // Histogram of the columns at the left of the first pixel of the row
         for (int yi = yMin; yi < yMax; yi++) {
-          for (int xi = xMin0; xi < xMax0; xi++) {
-            ++hist[fastRound(I1[yi][xi] / 255.0f * bins)];
+          for (int xi = 0; xi < xMax0; xi++) {
+            ++rowHist[binOf[I1[yi][xi]]];
           }
         }
       } else {
-        hist = prev_hist;
-
         if (yMin > 0) {
           int yMin1 = yMin - 1;
           // Sliding histogram, remove top
-          for (int xi = xMin0; xi < xMax0; xi++) {
-            --hist[fastRound(I1[yMin1][xi] / 255.0f * bins)];
+          for (int xi = 0; xi < xMax0; xi++) {
+            --rowHist[binOf[I1[yMin1][xi]]];
           }
         }
 
-        if (y + blockRadius < (int)I1.getHeight()) {
+        if (y + blockRadius < height) {
           int yMax1 = yMax - 1;
           // Sliding histogram, add bottom
-          for (int xi = xMin0; xi < xMax0; xi++) {
-            ++hist[fastRound(I1[yMax1][xi] / 255.0f * bins)];
+          for (int xi = 0; xi < xMax0; xi++) {
+            ++rowHist[binOf[I1[yMax1][xi]]];
           }
         }
       }
-      prev_hist = hist;
-#endif
+      std::copy(rowHist.begin(), rowHist.end(), hist.begin());
 
-      for (int x = 0; x < (int)I1.getWidth(); x++) {
+      for (int x = 0; x < width; x++) {
         int xMin = std::max(0, x - (int)blockRadius);
         int xMax = x + blockRadius + 1;
 
@@ -443,20 +386,20 @@ void vp::clahe(const vpImage<unsigned char> &I1, vpImage<unsigned char> &I2, int
           int xMin1 = xMin - 1;
           // Sliding histogram, remove left
           for (int yi = yMin; yi < yMax; yi++) {
-            --hist[fastRound(I1[yi][xMin1] / 255.0f * bins)];
+            --hist[binOf[I1[yi][xMin1]]];
           }
         }
 
-        if (xMax <= (int)I1.getWidth()) {
+        if (xMax <= width) {
           int xMax1 = xMax - 1;
           // Sliding histogram, add right
           for (int yi = yMin; yi < yMax; yi++) {
-            ++hist[fastRound(I1[yi][xMax1] / 255.0f * bins)];
+            ++hist[binOf[I1[yi][xMax1]]];
           }
         }
 
-        int v = fastRound(I1[y][x] / 255.0f * bins);
-        int w = std::min((int)I1.getWidth(), xMax) - xMin;
+        int v = binOf[I1[y][x]];
+        int w = std::min(width, xMax) - xMin;
         int n = h * w;
         int limit = (int)(slope * n / bins + 0.5f);
         I2[y][x] = fastRound(transferValue(v, hist, clippedHist, limit) * 255.0f);
@@ -464,6 +407,76 @@ void vp::clahe(const vpImage<unsigned char> &I1, vpImage<unsigned char> &I2, int
     }
   }
 }
+} // namespace
+
+/*!
+  \ingroup group_imgproc_brightness
+
+  Adjust the contrast of a grayscale image locally using the Contrast Limited
+  Adaptative Histogram Equalization method. The limit parameter allows to
+  limit the slope of the transformation function to prevent the
+  overamplification of noise. This method is a transcription of the CLAHE
+  ImageJ plugin code by Stephan Saalfeld.
+
+  When OpenMP is available, the blocks of the fast version and horizontal
+  bands of the image in the accurate version are processed in parallel.
+
+  \param I1 : The first grayscale image.
+  \param I2 : The second grayscale image after application of the CLAHE
+  method.
+  \param blockRadius : The size (2*blockRadius+1) of the local region
+  around a pixel for which the histogram is equalized. This size should be
+  larger than the size of features to be preserved.
+  \param bins : The number
+  of histogram bins used for histogram equalization (between 1 and 256). The
+  number of histogram bins should be smaller than the number of pixels in a
+  block.
+  \param slope : Limits the contrast stretch in the intensity transfer
+  function. Very large values will let the histogram equalization do whatever
+  it wants to do, that is result in maximal local contrast. The value 1 will
+  result in the original image.
+  \param fast : Use the fast but less accurate
+  version of the filter. The fast version does not evaluate the intensity
+  transfer function for each pixel independently but for a grid of adjacent
+  boxes of the given block size only and interpolates bilinearly for
+  locations in between. The accurate version updates the histogram of the
+  block around each pixel incrementally with the columns entering and leaving
+  the block.
+*/
+void vp::clahe(const vpImage<unsigned char> &I1, vpImage<unsigned char> &I2, int blockRadius, int bins,
+               float slope, bool fast)
+{
+  if (blockRadius < 0) {
+    std::cerr << "Error: blockRadius < 0!" << std::endl;
+    return;
+  }
+
+  if (bins < 0 || bins > 256) {
+    std::cerr << "Error: (bins < 0 || bins > 256)!" << std::endl;
+    return;
+  }
+
+  if ((unsigned int)(2 * blockRadius + 1) > I1.getWidth() || (unsigned int)(2 * blockRadius + 1) > I1.getHeight()) {
+    std::cerr << "Error: (unsigned int) (2*blockRadius+1) > I1.getWidth() || "
+                 "(unsigned int) (2*blockRadius+1) > I1.getHeight()!"
+              << std::endl;
+    return;
+  }
+
+  I2.resize(I1.getHeight(), I1.getWidth());
+
+  // Histogram bin of each gray level
+  std::vector<int> binOf(256);
+  for (int i = 0; i < 256; i++) {
+    binOf[i] = fastRound(i / 255.0f * bins);
+  }
+
+  if (fast) {
+    claheFast(I1, I2, blockRadius, bins, slope, binOf);
+  } else {
+    claheAccurate(I1, I2, blockRadius, bins, slope, binOf);
+  }
+}
 
 /*!
   \ingroup group_imgproc_brightness
@@ -474,6 +487,11 @@ void vp::clahe(const vpImage<unsigned char> &I1, vpImage<unsigned char> &I2, int
   overamplification of noise. This method is a transcription of the CLAHE
   ImageJ plugin code by Stephan Saalfeld.
 
+  The method is applied on the luminance of the image. The red, green and
+  blue components of each pixel are then scaled by the ratio between the
+  equalized and the original luminance, which preserves the hue without
+  converting the image to another color space.
+
   \param I1 : The first color image.
   \param I2 : The second color image after application of the CLAHE method.
   \param blockRadius : The size (2*blockRadius+1) of the local region around a
@@ -493,40 +511,32 @@ void vp::clahe(const vpImage<unsigned char> &I1, vpImage<unsigned char> &I2, int
 void vp::clahe(const vpImage<vpRGBa> &I1, vpImage<vpRGBa> &I2, int blockRadius, int bins, float slope,
                bool fast)
 {
-  // Split
-  vpImage<unsigned char> pR(I1.getHeight(), I1.getWidth());
-  vpImage<unsigned char> pG(I1.getHeight(), I1.getWidth());
-  vpImage<unsigned char> pB(I1.getHeight(), I1.getWidth());
-  vpImage<unsigned char> pa(I1.getHeight(), I1.getWidth());
-
-  vpImageConvert::split(I1, &pR, &pG, &pB, &pa);
-
-  // Apply CLAHE independently on RGB channels
-  vpImage<unsigned char> resR, resG, resB;
-  clahe(pR, resR, blockRadius, bins, slope, fast);
-  clahe(pG, resG, blockRadius, bins, slope, fast);
-  clahe(pB, resB, blockRadius, bins, slope, fast);
+  vpImage<unsigned char> Y, Y_clahe;
+  vpImageConvert::convert(I1, Y);
+  clahe(Y, Y_clahe, blockRadius, bins, slope, fast);
+  if (Y_clahe.getSize() != Y.getSize()) {
+    // Invalid parameters
+    return;
+  }
 
   I2.resize(I1.getHeight(), I1.getWidth());
-  unsigned int size = I2.getWidth() * I2.getHeight();
-  unsigned char *ptrStart = (unsigned char *)I2.bitmap;
-  unsigned char *ptrEnd = ptrStart + size * 4;
-  unsigned char *ptrCurrent = ptrStart;
-
-  unsigned int cpt = 0;
-  while (ptrCurrent != ptrEnd) {
-    *ptrCurrent = resR.bitmap[cpt];
-    ++ptrCurrent;
-
-    *ptrCurrent = resG.bitmap[cpt];
-    ++ptrCurrent;
-
-    *ptrCurrent = resB.bitmap[cpt];
-    ++ptrCurrent;
-
-    *ptrCurrent = pa.bitmap[cpt];
-    ++ptrCurrent;
-
-    cpt++;
+  const int size = (int)I1.getSize();
+#if defined _OPENMP
+#pragma omp parallel for
+#endif
+  for (int i = 0; i < size; i++) {
+    const vpRGBa &src = I1.bitmap[i];
+    vpRGBa &dst = I2.bitmap[i];
+    const unsigned char y = Y.bitmap[i], y_clahe = Y_clahe.bitmap[i];
+    if (y == 0) {
+      dst.R = dst.G = dst.B = y_clahe;
+    } else {
+      // Ratio between the equalized and the original luminance
+      const float ratio = y_clahe / (float)y;
+      dst.R = (unsigned char)std::min(255, fastRound(src.R * ratio));
+      dst.G = (unsigned char)std::min(255, fastRound(src.G * ratio));
+      dst.B = (unsigned char)std::min(255, fastRound(src.B * ratio));
+    }
+    dst.A = src.A;
   }
 }
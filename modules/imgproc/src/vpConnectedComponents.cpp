@@ -41,132 +41,362 @@
   \brief Basic connected components.
 */
 
-#include <queue>
+#include <algorithm>
+#include <limits>
 #include <visp3/imgproc/vpImgproc.h>
 
+#if defined _OPENMP
+#include <omp.h>
+#endif
+
 namespace
 {
-void getNeighbors(const vpImage<unsigned char> &I, std::queue<vpImagePoint> &listOfNeighbors, unsigned int i,
-                  unsigned int j, const vpImageMorphology::vpConnexityType &connexity)
+/*
+  Return the root of the equivalence class of label. The parent of a label is
+  never greater than the label itself, the root of a class is thus its
+  smallest provisional label.
+*/
+inline int findRoot(std::vector<int> &parent, int label)
 {
-  unsigned char currValue = I[i][j];
+  int root = label;
+  while (parent[root] < root) {
+    root = parent[root];
+  }
 
-  if (connexity == vpImageMorphology::CONNEXITY_4) {
-    // Top
-    if (I[i - 1][j] == currValue) {
-      listOfNeighbors.push(vpImagePoint(i - 1, j));
-    }
+  // Path compression
+  while (parent[label] > root) {
+    int next = parent[label];
+    parent[label] = root;
+    label = next;
+  }
 
-    // Left
-    if (I[i][j - 1] == currValue) {
-      listOfNeighbors.push(vpImagePoint(i, j - 1));
-    }
+  return root;
+}
 
-    // Right
-    if (I[i][j + 1] == currValue) {
-      listOfNeighbors.push(vpImagePoint(i, j + 1));
-    }
+inline int merge(std::vector<int> &parent, int label1, int label2)
+{
+  int root1 = findRoot(parent, label1);
+  int root2 = findRoot(parent, label2);
+  if (root1 < root2) {
+    parent[root2] = root1;
+    return root1;
+  }
 
-    // Bottom
-    if (I[i + 1][j] == currValue) {
-      listOfNeighbors.push(vpImagePoint(i + 1, j));
-    }
-  } else {
-    for (int cpt1 = -1; cpt1 <= 1; cpt1++) {
-      for (int cpt2 = -1; cpt2 <= 1; cpt2++) {
-        // Everything except the current position
-        if (cpt1 != 0 || cpt2 != 0) {
-          if (I[(int)i + cpt1][(int)j + cpt2] == currValue) {
-            listOfNeighbors.push(vpImagePoint((int)i + cpt1, (int)j + cpt2));
+  parent[root1] = root2;
+  return root2;
+}
+
+/*
+  First pass of the two-pass labeling on the rows [rowStart, rowEnd[. The
+  provisional label of a new component is one plus the index of its first
+  pixel in the image, so that the stripes can be labeled independently and
+  the smallest label of a component is the one of its first pixel in raster
+  scan order. The pixels of the first row of the stripe are not connected to
+  the previous row, this is done by mergeStripes().
+*/
+void labelStripe(const vpImage<unsigned char> &I, vpImage<int> &labels, std::vector<int> &parent,
+                 unsigned int rowStart, unsigned int rowEnd, const vpImageMorphology::vpConnexityType &connexity)
+{
+  const unsigned int width = I.getWidth();
+
+  for (unsigned int i = rowStart; i < rowEnd; i++) {
+    const unsigned char *row = I[i];
+    const unsigned char *rowUp = (i > rowStart) ? I[i - 1] : NULL;
+    int *lab = labels[i];
+    const int *labUp = (i > rowStart) ? labels[i - 1] : NULL;
+    const int offset = static_cast<int>(i * width) + 1;
+
+    for (unsigned int j = 0; j < width; j++) {
+      const unsigned char value = row[j];
+      if (value == 0) {
+        lab[j] = 0;
+        continue;
+      }
+
+      int label = 0;
+      const bool left = (j > 0 && row[j - 1] == value);
+
+      if (rowUp == NULL) {
+        if (left) {
+          label = lab[j - 1];
+        }
+      } else if (connexity == vpImageMorphology::CONNEXITY_4) {
+        if (rowUp[j] == value) {
+          label = labUp[j];
+          if (left && lab[j - 1] != label) {
+            label = merge(parent, label, lab[j - 1]);
+          }
+        } else if (left) {
+          label = lab[j - 1];
+        }
+      } else {
+        // With 8-connexity, the top-left, top-right and left neighbors are
+        // already connected through the top neighbor when it has the same
+        // value
+        if (rowUp[j] == value) {
+          label = labUp[j];
+        } else if (j + 1 < width && rowUp[j + 1] == value) {
+          label = labUp[j + 1];
+          if (j > 0 && rowUp[j - 1] == value) {
+            label = merge(parent, label, labUp[j - 1]);
+          } else if (left) {
+            label = merge(parent, label, lab[j - 1]);
           }
+        } else if (j > 0 && rowUp[j - 1] == value) {
+          label = labUp[j - 1];
+        } else if (left) {
+          label = lab[j - 1];
         }
       }
+
+      if (label == 0) {
+        label = offset + static_cast<int>(j);
+        parent[label] = label;
+      }
+      lab[j] = label;
     }
   }
 }
 
-void visitNeighbors(vpImage<unsigned char> &I_copy, std::queue<vpImagePoint> &listOfNeighbors, vpImage<int> &labels,
-                    int current_label, const vpImageMorphology::vpConnexityType &connexity)
+/*
+  Connect the first row of a stripe with the last row of the previous one.
+*/
+void mergeStripes(const vpImage<unsigned char> &I, const vpImage<int> &labels, std::vector<int> &parent,
+                  unsigned int row, const vpImageMorphology::vpConnexityType &connexity)
 {
-  // Visit the neighbors
-  while (!listOfNeighbors.empty()) {
-    vpImagePoint imPt = listOfNeighbors.front();
-    unsigned int i = (unsigned int)imPt.get_i();
-    unsigned int j = (unsigned int)imPt.get_j();
-    listOfNeighbors.pop();
-
-    if (I_copy[i][j]) {
-      getNeighbors(I_copy, listOfNeighbors, i, j, connexity);
-
-      // Reset current position and set label
-      I_copy[i][j] = 0;
-      labels[i][j] = current_label;
+  const unsigned int width = I.getWidth();
+  const unsigned char *rowCurr = I[row];
+  const unsigned char *rowUp = I[row - 1];
+  const int *lab = labels[row];
+  const int *labUp = labels[row - 1];
+
+  for (unsigned int j = 0; j < width; j++) {
+    const unsigned char value = rowCurr[j];
+    if (value == 0) {
+      continue;
+    }
+
+    if (rowUp[j] == value) {
+      merge(parent, lab[j], labUp[j]);
+    } else if (connexity == vpImageMorphology::CONNEXITY_8) {
+      if (j > 0 && rowUp[j - 1] == value) {
+        merge(parent, lab[j], labUp[j - 1]);
+      }
+      if (j + 1 < width && rowUp[j + 1] == value) {
+        merge(parent, lab[j], labUp[j + 1]);
+      }
     }
   }
 }
-} // namespace
 
-/*!
-  \ingroup group_imgproc_connected_components
+// Statistics of a component accumulated during the second pass
+struct vpComponentAccumulator {
+  unsigned int area;
+  unsigned int top, left, bottom, right;
+  double sum_i, sum_j;
+  unsigned char value;
 
-  Perform connected components detection.
+  vpComponentAccumulator()
+    : area(0), top(std::numeric_limits<unsigned int>::max()), left(std::numeric_limits<unsigned int>::max()),
+      bottom(0), right(0), sum_i(0.0), sum_j(0.0), value(0)
+  {
+  }
+};
 
-  \param I : Input image (0 means background).
-  \param labels : Label image that contain for each position the component
-  label. \param nbComponents : Number of connected components. \param
-  connexity : Type of connexity.
+/*
+  Second pass on the rows [rowStart, rowEnd[: replace the provisional labels
+  by the final ones and accumulate the statistics of the components.
 */
-void vp::connectedComponents(const vpImage<unsigned char> &I, vpImage<int> &labels, int &nbComponents,
+void relabelStripe(const vpImage<unsigned char> &I, vpImage<int> &labels, const std::vector<int> &finalLabels,
+                   unsigned int rowStart, unsigned int rowEnd, std::vector<vpComponentAccumulator> *stats)
+{
+  const unsigned int width = I.getWidth();
+
+  for (unsigned int i = rowStart; i < rowEnd; i++) {
+    int *lab = labels[i];
+
+    if (stats == NULL) {
+      for (unsigned int j = 0; j < width; j++) {
+        lab[j] = finalLabels[lab[j]];
+      }
+    } else {
+      // The statistics are updated once per run of pixels with the same
+      // provisional label
+      for (unsigned int j = 0; j < width;) {
+        const int provisional = lab[j];
+        const unsigned int start = j;
+        const int label = finalLabels[provisional];
+        for (; j < width && lab[j] == provisional; j++) {
+          lab[j] = label;
+        }
+
+        if (label) {
+          const unsigned int length = j - start;
+          vpComponentAccumulator &acc = (*stats)[label - 1];
+          acc.area += length;
+          acc.top = std::min(acc.top, i);
+          acc.bottom = std::max(acc.bottom, i);
+          acc.left = std::min(acc.left, start);
+          acc.right = std::max(acc.right, j - 1);
+          acc.sum_i += static_cast<double>(i) * length;
+          acc.sum_j += (static_cast<double>(start) + (j - 1)) * length / 2.0;
+          acc.value = I[i][start];
+        }
+      }
+    }
+  }
+}
+
+void connectedComponentsImpl(const vpImage<unsigned char> &I, vpImage<int> &labels, int &nbComponents,
+                             std::vector<vp::vpConnectedComponent> *components,
                              const vpImageMorphology::vpConnexityType &connexity)
 {
+  nbComponents = 0;
+  if (components != NULL) {
+    components->clear();
+  }
   if (I.getSize() == 0) {
     return;
   }
 
-  labels.resize(I.getHeight(), I.getWidth());
+  const unsigned int height = I.getHeight(), width = I.getWidth();
+  labels.resize(height, width);
 
-  vpImage<unsigned char> I_copy(I.getHeight() + 2, I.getWidth() + 2);
-  // Copy and add border
-  for (unsigned int i = 0; i < I_copy.getHeight(); i++) {
-    if (i == 0 || i == I_copy.getHeight() - 1) {
-      memset(I_copy[i], 0, sizeof(unsigned char) * I_copy.getWidth());
+  // Provisional labels are in [1, height*width], 0 is the background
+  std::vector<int> parent(static_cast<size_t>(height) * width + 1, 0);
+
+  int nbStripes = 1;
+#if defined _OPENMP
+  nbStripes = std::max(1, std::min(omp_get_max_threads(), static_cast<int>(height / 16)));
+#endif
+  std::vector<unsigned int> stripeStart(static_cast<size_t>(nbStripes) + 1);
+  for (int s = 0; s <= nbStripes; s++) {
+    stripeStart[static_cast<size_t>(s)] = static_cast<unsigned int>((static_cast<size_t>(height) * s) / nbStripes);
+  }
+
+  // First pass: each stripe only merges its own provisional labels
+#if defined _OPENMP
+#pragma omp parallel for schedule(static, 1) if (nbStripes > 1)
+#endif
+  for (int s = 0; s < nbStripes; s++) {
+    labelStripe(I, labels, parent, stripeStart[static_cast<size_t>(s)], stripeStart[static_cast<size_t>(s) + 1],
+                connexity);
+  }
+
+  for (int s = 1; s < nbStripes; s++) {
+    mergeStripes(I, labels, parent, stripeStart[static_cast<size_t>(s)], connexity);
+  }
+
+  // Resolve the equivalences. The provisional labels are visited in
+  // increasing order, which is the raster scan order of the first pixel of
+  // the components: the final labels are numbered the same way. The parent of
+  // a label being smaller than the label, it has already been resolved.
+  std::vector<int> &finalLabels = parent;
+  for (size_t label = 1; label < parent.size(); label++) {
+    const int p = parent[label];
+    if (p == 0) {
+      continue; // label not used
+    }
+    if (p == static_cast<int>(label)) {
+      finalLabels[label] = ++nbComponents;
     } else {
-      I_copy[i][0] = 0;
-      memcpy(I_copy[i] + 1, I[i - 1], sizeof(unsigned char) * I.getWidth());
-      I_copy[i][I_copy.getWidth() - 1] = 0;
+      finalLabels[label] = finalLabels[static_cast<size_t>(p)];
     }
   }
 
-  vpImage<int> labels_copy(I.getHeight() + 2, I.getWidth() + 2, 0);
+  // Second pass
+  if (components == NULL) {
+#if defined _OPENMP
+#pragma omp parallel for schedule(static, 1) if (nbStripes > 1)
+#endif
+    for (int s = 0; s < nbStripes; s++) {
+      relabelStripe(I, labels, finalLabels, stripeStart[static_cast<size_t>(s)],
+                    stripeStart[static_cast<size_t>(s) + 1], NULL);
+    }
+    return;
+  }
 
-  int current_label = 1;
-  std::queue<vpImagePoint> listOfNeighbors;
+  std::vector<std::vector<vpComponentAccumulator> > stats(static_cast<size_t>(nbStripes));
+#if defined _OPENMP
+#pragma omp parallel for schedule(static, 1) if (nbStripes > 1)
+#endif
+  for (int s = 0; s < nbStripes; s++) {
+    stats[static_cast<size_t>(s)].resize(static_cast<size_t>(nbComponents));
+    relabelStripe(I, labels, finalLabels, stripeStart[static_cast<size_t>(s)],
+                  stripeStart[static_cast<size_t>(s) + 1], &stats[static_cast<size_t>(s)]);
+  }
+
+  components->resize(static_cast<size_t>(nbComponents));
+  for (size_t k = 0; k < components->size(); k++) {
+    vpComponentAccumulator acc;
+    for (size_t s = 0; s < stats.size(); s++) {
+      const vpComponentAccumulator &acc_s = stats[s][k];
+      if (acc_s.area) {
+        acc.area += acc_s.area;
+        acc.top = std::min(acc.top, acc_s.top);
+        acc.bottom = std::max(acc.bottom, acc_s.bottom);
+        acc.left = std::min(acc.left, acc_s.left);
+        acc.right = std::max(acc.right, acc_s.right);
+        acc.sum_i += acc_s.sum_i;
+        acc.sum_j += acc_s.sum_j;
+        acc.value = acc_s.value;
+      }
+    }
+
+    vp::vpConnectedComponent &component = (*components)[k];
+    component.m_label = static_cast<int>(k) + 1;
+    component.m_value = acc.value;
+    component.m_area = acc.area;
+    component.m_bbox = vpRect(acc.left, acc.top, acc.right - acc.left + 1, acc.bottom - acc.top + 1);
+    component.m_centroid = vpImagePoint(acc.sum_i / acc.area, acc.sum_j / acc.area);
+  }
+}
+} // namespace
 
-  for (unsigned int cpt1 = 0; cpt1 < I.getHeight(); cpt1++) {
-    unsigned int i = cpt1 + 1;
+/*!
+  \ingroup group_imgproc_connected_components
 
-    for (unsigned int cpt2 = 0; cpt2 < I.getWidth(); cpt2++) {
-      unsigned int j = cpt2 + 1;
+  Perform connected components detection. Two neighboring pixels belong to the
+  same component when they have the same non zero value.
 
-      if (I_copy[i][j] && labels_copy[i][j] == 0) {
-        // Get all the neighbors relative to the current position
-        getNeighbors(I_copy, listOfNeighbors, i, j, connexity);
+  The components are labeled with a two-pass algorithm: a first raster scan
+  assigns provisional labels and records their equivalences in a union-find
+  structure, the second scan replaces the provisional labels by the final
+  ones. With OpenMP, the first and second passes are done in parallel on
+  horizontal stripes of the image, whose boundaries are then merged.
 
-        // Reset current position and set label
-        I_copy[i][j] = 0;
-        labels_copy[i][j] = current_label;
+  The components are numbered from 1 in the raster scan order of their first
+  pixel.
 
-        visitNeighbors(I_copy, listOfNeighbors, labels_copy, current_label, connexity);
+  \param I : Input image (0 means background).
+  \param labels : Label image that contain for each position the component
+  label.
+  \param nbComponents : Number of connected components.
+  \param connexity : Type of connexity.
+*/
+void vp::connectedComponents(const vpImage<unsigned char> &I, vpImage<int> &labels, int &nbComponents,
+                             const vpImageMorphology::vpConnexityType &connexity)
+{
+  connectedComponentsImpl(I, labels, nbComponents, NULL, connexity);
+}
 
-        // Increment label
-        current_label++;
-      }
-    }
-  }
+/*!
+  \ingroup group_imgproc_connected_components
 
-  for (unsigned int i = 0; i < labels.getHeight(); i++) {
-    memcpy(labels[i], labels_copy[i + 1] + 1, sizeof(int) * labels.getWidth());
-  }
+  Perform connected components detection and compute the area, the bounding
+  box and the centroid of each component during the labeling.
 
-  nbComponents = current_label - 1;
+  \param I : Input image (0 means background).
+  \param labels : Label image that contain for each position the component
+  label.
+  \param nbComponents : Number of connected components.
+  \param components : Statistics of the components, the statistics of the
+  component labeled \e k being at index \e k-1.
+  \param connexity : Type of connexity.
+*/
+void vp::connectedComponents(const vpImage<unsigned char> &I, vpImage<int> &labels, int &nbComponents,
+                             std::vector<vpConnectedComponent> &components,
+                             const vpImageMorphology::vpConnexityType &connexity)
+{
+  connectedComponentsImpl(I, labels, nbComponents, &components, connexity);
 }
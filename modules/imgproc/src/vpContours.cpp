@@ -72,154 +72,284 @@
   \brief Basic contours extraction.
 */
 
-#include <map>
+#include <cstdlib>
 #include <visp3/imgproc/vpImgproc.h>
 
+#if defined __SSE2__ || defined _M_X64 || (defined _M_IX86_FP && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define VISP_HAVE_SSE2 1
+#endif
+
 namespace
 {
-bool fromTo(const vpImagePoint &from, const vpImagePoint &to, vpDirection &direction)
+// Directions of the 8-neighbourhood in clockwise order, starting from north
+const int contourDirx[8] = {0, 1, 1, 1, 0, -1, -1, -1};
+const int contourDiry[8] = {-1, -1, 0, 1, 1, 1, 0, -1};
+const int contourEast = 2;
+const int contourWest = 6;
+
+/*
+  Append to runs the first and last columns of the runs of non zero pixels of
+  a row, shifted by one to take into account the padding of the label image.
+*/
+void encodeRow(const unsigned char *row, int width, std::vector<int> &runs)
 {
-  if (from == to) {
-    return false;
-  }
-
-  if (std::fabs(from.get_i() - to.get_i()) < std::numeric_limits<double>::epsilon()) {
-    if (from.get_j() < to.get_j()) {
-      direction.m_direction = EAST;
-    } else {
-      direction.m_direction = WEST;
+  bool inRun = false;
+  int j = 0;
+
+#if VISP_HAVE_SSE2
+  const __m128i zero = _mm_setzero_si128();
+  for (; j + 16 <= width; j += 16) {
+    const int zeros =
+        _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(row + j)), zero));
+    // Skip the blocks of 16 pixels that do not start or end a run
+    if (zeros == (inRun ? 0 : 0xFFFF)) {
+      continue;
     }
-  } else if (from.get_i() < to.get_i()) {
-    if (std::fabs(from.get_j() - to.get_j()) < std::numeric_limits<double>::epsilon()) {
-      direction.m_direction = SOUTH;
-    } else if (from.get_j() < to.get_j()) {
-      direction.m_direction = SOUTH_EAST;
-    } else {
-      direction.m_direction = SOUTH_WEST;
+
+    for (int k = 0; k < 16; k++) {
+      const bool foreground = ((zeros >> k) & 1) == 0;
+      if (foreground != inRun) {
+        runs.push_back(foreground ? j + k + 1 : j + k);
+        inRun = foreground;
+      }
     }
-  } else {
-    if (std::fabs(from.get_j() - to.get_j()) < std::numeric_limits<double>::epsilon()) {
-      direction.m_direction = NORTH;
-    } else if (from.get_j() < to.get_j()) {
-      direction.m_direction = NORTH_EAST;
-    } else {
-      direction.m_direction = NORTH_WEST;
+  }
+#endif
+
+  for (; j < width; j++) {
+    const bool foreground = row[j] != 0;
+    if (foreground != inRun) {
+      runs.push_back(foreground ? j + 1 : j);
+      inRun = foreground;
     }
   }
 
-  return true;
+  if (inRun) {
+    runs.push_back(width);
+  }
 }
 
-bool crossesEastBorder(const vpImage<int> &I, bool checked[8], const vpImagePoint &point)
+/*
+  Follow the border starting at the pixel (i, j) of the padded label image,
+  coming from its neighbour in direction fromDir (3.1 to 3.5).
+*/
+void followBorder(vpImage<int> &L, int i, int j, int fromDir, int nbd, std::vector<vpImagePoint> &points)
 {
-  vpDirection direction;
-  if (!fromTo(point, vpImagePoint(point.get_i(), point.get_j() + 1), direction)) {
-    return false;
+  const long width = static_cast<long>(L.getWidth());
+  long offsets[8];
+  for (int d = 0; d < 8; d++) {
+    offsets[d] = contourDiry[d] * width + contourDirx[d];
   }
 
-  bool b = checked[(int)direction.m_direction];
+  int *labels = L.bitmap;
+  const long ij = i * width + j;
 
-  if (point.get_i() < 0 || point.get_j() < 0) {
-    return false;
+  // Find i1j1 (3.1)
+  int dir = -1;
+  for (int k = 1; k < 8; k++) {
+    int d = (fromDir + k) & 7;
+    if (labels[ij + offsets[d]] != 0) {
+      dir = d;
+      break;
+    }
   }
 
-  unsigned int i = (unsigned int)point.get_i();
-  unsigned int j = (unsigned int)point.get_j();
+  if (dir < 0) {
+    //(3.1) ; single pixel contour
+    return;
+  }
 
-  return I[i][j] != 0 && ((unsigned int)point.get_j() == I.getWidth() - 1 || b);
-}
+  const long i1j1 = ij + offsets[dir];
+  long i3j3 = ij; //(3.2)
+  int i3 = i, j3 = j;
 
-void addContourPoint(vpImage<int> &I, vp::vpContour *border, const vpImagePoint &point, bool checked[8], int nbd)
-{
-  border->m_points.push_back(vpImagePoint(point.get_i() - 1, point.get_j() - 1)); // remove 1-pixel padding
+  while (true) {
+    // Search counterclockwise from the direction of i2j2 (3.3)
+    bool checkedEast = false;
+    int trace = (dir + 7) & 7;
+    while (labels[i3j3 + offsets[trace]] == 0) {
+      checkedEast = checkedEast || trace == contourEast;
+      trace = (trace + 7) & 7;
+    }
+    const long i4j4 = i3j3 + offsets[trace];
 
-  unsigned int i = (unsigned int)point.get_i();
-  unsigned int j = (unsigned int)point.get_j();
+    // (3.4)
+    points.push_back(vpImagePoint(i3 - 1, j3 - 1)); // remove 1-pixel padding
+    if (checkedEast) {
+      labels[i3j3] = -nbd;
+    } else if (labels[i3j3] == 1) {
+      // Only set if the pixel has not been visited before (3.4) (b)
+      labels[i3j3] = nbd;
+    } // Otherwise leave it alone
+
+    if (i4j4 == ij && i3j3 == i1j1) {
+      //(3.5)
+      break;
+    }
 
-  if (crossesEastBorder(I, checked, point)) {
-    I[i][j] = -nbd;
-  } else if (I[i][j] == 1) {
-    // Only set if the pixel has not been visited before (3.4) (b)
-    I[i][j] = nbd;
-  } // Otherwise leave it alone
+    //(3.5)
+    dir = (trace + 4) & 7;
+    i3j3 = i4j4;
+    i3 += contourDiry[trace];
+    j3 += contourDirx[trace];
+  }
 }
 
-void followBorder(vpImage<int> &I, const vpImagePoint &ij, vpImagePoint &i2j2, vp::vpContour *border, int nbd)
+/*
+  Start a new border at the pixel (i, j) of the padded label image if it is
+  the first pixel of an outer border or of a hole border (1), and update lnbd
+  (4). Only the first and last pixels of a run can start a border.
+*/
+void scanPixel(vpImage<int> &L, int i, int j, bool isRunStart, bool isRunEnd, int &nbd, int &lnbd,
+               vp::vpContourSet &contours)
 {
-  vpDirection dir;
-  if (!fromTo(ij, i2j2, dir)) {
-    throw vpException(vpException::fatalError, "ij == i2j2");
-  }
+  const int fji = L[i][j];
+  const bool isOuter = isRunStart && fji == 1;
+  const bool isHole = isRunEnd && fji >= 1;
+
+  if (isOuter || isHole) { // else (1) (c)
+    nbd++;
+    if (!isOuter && fji > 1) {
+      lnbd = fji;
+    }
 
-  vpDirection trace = dir.clockwise();
-  vpImagePoint i1j1(-1, -1);
+    // The background is a hole contour without parent
+    const int borderPrime = lnbd - 2;
+    const vp::vpContourType primeType = borderPrime < 0 ? vp::CONTOUR_HOLE : contours.m_types[borderPrime];
+    const int primeParent = borderPrime < 0 ? -1 : contours.m_parents[borderPrime];
 
-  // Find i1j1 (3.1)
-  while (trace.m_direction != dir.m_direction) {
-    vpImagePoint activePixel = trace.active(I, ij);
+    // Table 1
+    if (isOuter) {
+      //(1) (a)
+      contours.m_types.push_back(vp::CONTOUR_OUTER);
+      contours.m_parents.push_back(primeType == vp::CONTOUR_OUTER ? primeParent : borderPrime);
+    } else {
+      //(1) (b)
+      contours.m_types.push_back(vp::CONTOUR_HOLE);
+      contours.m_parents.push_back(primeType == vp::CONTOUR_OUTER ? borderPrime : primeParent);
+    }
 
-    if (activePixel.get_i() >= 0 && activePixel.get_j() >= 0) {
-      i1j1 = activePixel;
-      break;
+    const size_t nbPoints = contours.m_points.size();
+    followBorder(L, i, j, isOuter ? contourWest : contourEast, nbd, contours.m_points);
+
+    //(3) (1) ; single pixel contour
+    if (contours.m_points.size() == nbPoints) {
+      contours.m_points.push_back(vpImagePoint(i - 1, j - 1)); // remove 1-pixel padding
+      L[i][j] = -nbd;
     }
 
-    trace = trace.clockwise();
+    contours.m_offsets.push_back(static_cast<unsigned int>(contours.m_points.size()));
   }
 
-  if (i1j1.get_i() < 0 || i1j1.get_j() < 0) {
-    //(3.1) ; single pixel contour
-    return;
+  //(4)
+  if (fji != 0 && fji != 1) {
+    lnbd = std::abs(fji);
   }
+}
 
-  i2j2 = i1j1;
-  vpImagePoint i3j3 = ij; //(3.2)
-
-  bool checked[8] = {false, false, false, false, false, false, false, false};
+// Squared distance between the point p and the segment [a, b]
+double segmentSquareDistance(const vpImagePoint &p, const vpImagePoint &a, const vpImagePoint &b)
+{
+  const double abi = b.get_i() - a.get_i(), abj = b.get_j() - a.get_j();
+  double api = p.get_i() - a.get_i(), apj = p.get_j() - a.get_j();
+  const double ab2 = abi * abi + abj * abj;
+  if (ab2 > 0) {
+    const double t = std::min(std::max((api * abi + apj * abj) / ab2, 0.), 1.);
+    api -= t * abi;
+    apj -= t * abj;
+  }
 
-  while (true) {
-    if (!fromTo(i3j3, i2j2, dir)) {
-      throw vpException(vpException::fatalError, "i3j3 == i2j2");
-    }
+  return api * api + apj * apj;
+}
 
-    trace = dir.counterClockwise();
-    vpImagePoint i4j4(-1, -1);
+/*
+  Douglas-Peucker simplification of the closed polygon of n points. Set keep[k]
+  to 1 for the points that are vertices of the simplified polygon.
+*/
+void simplifyPolygon(const vpImagePoint *points, unsigned int n, double epsilon, std::vector<unsigned char> &keep,
+                     std::vector<std::pair<unsigned int, unsigned int> > &chains)
+{
+  keep.assign(n, 0);
+  if (n <= 2) {
+    keep.assign(n, 1);
+    return;
+  }
 
-    // Reset checked
-    for (int cpt = 0; cpt < 8; cpt++) {
-      checked[cpt] = false;
+  // Split the polygon at the farthest point from the first one
+  unsigned int farthest = 0;
+  double farthestDistance = -1.;
+  for (unsigned int k = 1; k < n; k++) {
+    const double di = points[k].get_i() - points[0].get_i(), dj = points[k].get_j() - points[0].get_j();
+    if (di * di + dj * dj > farthestDistance) {
+      farthestDistance = di * di + dj * dj;
+      farthest = k;
     }
+  }
 
-    while (true) {
-      i4j4 = trace.active(I, i3j3); //(3.3)
-      if (i4j4.get_i() >= 0 && i4j4.get_j() >= 0) {
-        break;
+  keep[0] = keep[farthest] = 1;
+  chains.clear();
+  chains.push_back(std::make_pair(0u, farthest));
+  chains.push_back(std::make_pair(farthest, n)); // index n is the first point
+  const double epsilon2 = epsilon * epsilon;
+
+  while (!chains.empty()) {
+    const unsigned int first = chains.back().first, last = chains.back().second;
+    chains.pop_back();
+
+    unsigned int worst = 0;
+    double worstDistance = epsilon2;
+    for (unsigned int k = first + 1; k < last; k++) {
+      const double d = segmentSquareDistance(points[k], points[first], points[last % n]);
+      if (d > worstDistance) {
+        worstDistance = d;
+        worst = k;
       }
-
-      checked[(int)trace.m_direction] = true;
-      trace = trace.counterClockwise();
     }
 
-    addContourPoint(I, border, i3j3, checked, nbd);
-
-    if (i4j4 == ij && i3j3 == i1j1) {
-      //(3.5)
-      break;
+    if (worst != 0) {
+      keep[worst] = 1;
+      chains.push_back(std::make_pair(first, worst));
+      chains.push_back(std::make_pair(worst, last));
     }
-
-    //(3.5)
-    i2j2 = i3j3;
-    i3j3 = i4j4;
   }
 }
 
-bool isOuterBorderStart(const vpImage<int> &I, unsigned int i, unsigned int j)
+template <class Type> void drawContourSet(vpImage<Type> &I, const vp::vpContourSet &contours, const Type &value)
 {
-  return (I[i][j] == 1 && (j == 0 || I[i][j - 1] == 0));
-}
+  const int height = static_cast<int>(I.getHeight()), width = static_cast<int>(I.getWidth());
+
+  for (unsigned int k = 0; k < contours.size(); k++) {
+    const unsigned int first = contours.m_offsets[k], last = contours.m_offsets[k + 1];
+    for (unsigned int m = first; m < last; m++) {
+      // Bresenham line to the next vertex, that is the next pixel if the contour is not simplified
+      const vpImagePoint &next = contours.m_points[m + 1 < last ? m + 1 : first];
+      int i = static_cast<int>(contours.m_points[m].get_i()), j = static_cast<int>(contours.m_points[m].get_j());
+      const int i2 = static_cast<int>(next.get_i()), j2 = static_cast<int>(next.get_j());
+      const int di = std::abs(i2 - i), dj = -std::abs(j2 - j);
+      const int si = i < i2 ? 1 : -1, sj = j < j2 ? 1 : -1;
+      int error = di + dj;
+
+      while (true) {
+        if (i >= 0 && i < height && j >= 0 && j < width) {
+          I[i][j] = value;
+        }
+        if (i == i2 && j == j2) {
+          break;
+        }
 
-bool isHoleBorderStart(const vpImage<int> &I, unsigned int i, unsigned int j)
-{
-  return (I[i][j] >= 1 && (j == I.getWidth() - 1 || I[i][j + 1] == 0));
+        const int error2 = 2 * error;
+        if (error2 >= dj) {
+          error += dj;
+          i += si;
+        }
+        if (error2 <= di) {
+          error += di;
+          j += sj;
+        }
+      }
+    }
+  }
 }
 
 void getContoursList(const vp::vpContour &root, int level, vp::vpContour &contour_list)
@@ -287,6 +417,38 @@ void vp::drawContours(vpImage<vpRGBa> &I, const std::vector<std::vector<vpImageP
   }
 }
 
+/*!
+  \ingroup group_imgproc_contours
+
+  Draw the input contours on the binary image. The consecutive points of a
+  contour are joined by a line, so that simplified contours are drawn as
+  closed polygons.
+
+  \param I : Grayscale image where we want to draw the input contours.
+  \param contours : Detected contours.
+  \param grayValue : Drawing grayscale color.
+*/
+void vp::drawContours(vpImage<unsigned char> &I, const vpContourSet &contours, unsigned char grayValue)
+{
+  drawContourSet(I, contours, grayValue);
+}
+
+/*!
+  \ingroup group_imgproc_contours
+
+  Draw the input contours on the color image. The consecutive points of a
+  contour are joined by a line, so that simplified contours are drawn as
+  closed polygons.
+
+  \param I : Color image where we want to draw the input contours.
+  \param contours : Detected contours.
+  \param color : Drawing color.
+*/
+void vp::drawContours(vpImage<vpRGBa> &I, const vpContourSet &contours, const vpColor &color)
+{
+  drawContourSet(I, contours, vpRGBa(color.R, color.G, color.B));
+}
+
 /*!
   \ingroup group_imgproc_contours
 
@@ -296,6 +458,8 @@ void vp::drawContours(vpImage<vpRGBa> &I, const std::vector<std::vector<vpImageP
   foreground, other values are not allowed). \param contours : Detected
   contours. \param contourPts : List of contours, each contour contains a list
   of contour points. \param retrievalMode : Contour retrieval mode.
+
+  \sa findContours(const vpImage<unsigned char> &, vpContourSet &, const vpContourRetrievalType &, double)
 */
 void vp::findContours(const vpImage<unsigned char> &I_original, vpContour &contours,
                       std::vector<std::vector<vpImagePoint> > &contourPts, const vpContourRetrievalType &retrievalMode)
@@ -307,115 +471,23 @@ void vp::findContours(const vpImage<unsigned char> &I_original, vpContour &conto
   // Clear output results
   contourPts.clear();
 
-  // Copy uchar I_original into int I + padding
-  vpImage<int> I(I_original.getHeight() + 2, I_original.getWidth() + 2);
-  for (unsigned int i = 0; i < I.getHeight(); i++) {
-    if (i == 0 || i == I.getHeight() - 1) {
-      memset(I.bitmap, 0, sizeof(int) * I.getWidth());
-    } else {
-      I[i][0] = 0;
-      for (unsigned int j = 0; j < I_original.getWidth(); j++) {
-        I[i][j + 1] = I_original[i - 1][j];
-      }
-      I[i][I.getWidth() - 1] = 0;
-    }
-  }
-
-  // Ref: http://openimaj.org/
-  // Ref: Satoshi Suzuki and others. Topological structural analysis of
-  // digitized binary images by border following.
-  int nbd = 1;  // Newest border
-  int lnbd = 1; // Last newest border
+  vpContourSet contourSet;
+  findContours(I_original, contourSet, CONTOUR_RETR_TREE);
 
   // Background contour
   // By default the root contour is a hole contour
   vpContour *root = new vpContour(vp::CONTOUR_HOLE);
 
-  std::map<int, vpContour *> borderMap;
-  borderMap[lnbd] = root;
-
-  for (unsigned int i = 0; i < I.getHeight(); i++) {
-    lnbd = 1; // Reset LNBD at the beginning of each scan row
-
-    for (unsigned int j = 0; j < I.getWidth(); j++) {
-      int fji = I[i][j];
-
-      bool isOuter = isOuterBorderStart(I, i, j);
-      bool isHole = isHoleBorderStart(I, i, j);
-
-      if (isOuter || isHole) { // else (1) (c)
-        vpContour *border = new vpContour;
-        vpContour *borderPrime = NULL;
-        vpImagePoint from(i, j);
-
-        if (isOuter) {
-          //(1) (a)
-          nbd++;
-          from.set_j(from.get_j() - 1);
-          border->m_contourType = vp::CONTOUR_OUTER;
-          borderPrime = borderMap[lnbd];
-
-          // Table 1
-          switch (borderPrime->m_contourType) {
-          case vp::CONTOUR_OUTER:
-            border->setParent(borderPrime->m_parent);
-            break;
-
-          case vp::CONTOUR_HOLE:
-            border->setParent(borderPrime);
-            break;
-
-          default:
-            break;
-          }
-        } else {
-          //(1) (b)
-          nbd++;
-
-          if (fji > 1) {
-            lnbd = fji;
-          }
-
-          borderPrime = borderMap[lnbd];
-          from.set_j(from.get_j() + 1);
-          border->m_contourType = vp::CONTOUR_HOLE;
-
-          // Table 1
-          switch (borderPrime->m_contourType) {
-          case vp::CONTOUR_OUTER:
-            border->setParent(borderPrime);
-            break;
-
-          case vp::CONTOUR_HOLE:
-            border->setParent(borderPrime->m_parent);
-            break;
-
-          default:
-            break;
-          }
-        }
-
-        vpImagePoint ij(i, j);
-        followBorder(I, ij, from, border, nbd);
-
-        //(3) (1) ; single pixel contour
-        if (border->m_points.empty()) {
-          border->m_points.push_back(vpImagePoint(ij.get_i() - 1, ij.get_j() - 1)); // remove 1-pixel padding
-          I[i][j] = -nbd;
-        }
-
-        if (retrievalMode == CONTOUR_RETR_LIST || retrievalMode == CONTOUR_RETR_TREE) {
-          // Add contour points
-          contourPts.push_back(border->m_points);
-        }
+  std::vector<vpContour *> borders(contourSet.size());
+  for (unsigned int k = 0; k < contourSet.size(); k++) {
+    vpContour *border = new vpContour(contourSet.m_types[k]);
+    contourSet.getContour(k, border->m_points);
+    border->setParent(contourSet.m_parents[k] < 0 ? root : borders[contourSet.m_parents[k]]);
+    borders[k] = border;
 
-        borderMap[nbd] = border;
-      }
-
-      //(4)
-      if (fji != 0 && fji != 1) {
-        lnbd = std::abs(fji);
-      }
+    if (retrievalMode == CONTOUR_RETR_LIST || retrievalMode == CONTOUR_RETR_TREE) {
+      // Add contour points
+      contourPts.push_back(border->m_points);
     }
   }
 
@@ -466,3 +538,132 @@ void vp::findContours(const vpImage<unsigned char> &I_original, vpContour &conto
   delete root;
   root = NULL;
 }
+
+/*!
+  \ingroup group_imgproc_contours
+
+  Extract contours from a binary image, with the same border following
+  algorithm as findContours(const vpImage<unsigned char> &, vpContour &, std::vector<std::vector<vpImagePoint> > &, const vpContourRetrievalType &)
+  but with the contours stored in flat arrays.
+
+  The rows are first run-length encoded, so that only the first and last
+  pixels of the runs of foreground pixels are visited when looking for new
+  borders. This makes the extraction cost mainly proportional to the number
+  of runs and of contour points instead of the number of pixels.
+
+  \param I : Input binary image (0 means background, any other value
+  means foreground).
+  \param contours : Detected contours, in the order they are found when
+  scanning the image. With vp::CONTOUR_RETR_LIST no hierarchy is kept and all
+  the contours are roots, with vp::CONTOUR_RETR_EXTERNAL only the outer
+  contours without parent are kept.
+  \param retrievalMode : Contour retrieval mode.
+  \param epsilon : If greater than 0, each contour is simplified with the
+  Douglas-Peucker algorithm into a closed polygon whose vertices are contour
+  points and whose distance to the removed points is at most epsilon pixels.
+*/
+void vp::findContours(const vpImage<unsigned char> &I, vpContourSet &contours,
+                      const vpContourRetrievalType &retrievalMode, double epsilon)
+{
+  contours.clear();
+  if (I.getSize() == 0) {
+    return;
+  }
+
+  const int height = static_cast<int>(I.getHeight()), width = static_cast<int>(I.getWidth());
+
+  // Run-length encoding of the rows
+  std::vector<int> runs;
+  std::vector<size_t> rowRuns(I.getHeight() + 1, 0);
+  for (int i = 0; i < height; i++) {
+    encodeRow(I[i], width, runs);
+    rowRuns[i + 1] = runs.size();
+  }
+
+  // Label image with 1-pixel padding: 0 for the background, 1 for the foreground
+  vpImage<int> L(I.getHeight() + 2, I.getWidth() + 2, 0);
+  for (int i = 0; i < height; i++) {
+    int *row = L[i + 1];
+    for (size_t r = rowRuns[i]; r < rowRuns[i + 1]; r += 2) {
+      std::fill(row + runs[r], row + runs[r + 1] + 1, 1);
+    }
+  }
+
+  // Ref: Satoshi Suzuki and others. Topological structural analysis of
+  // digitized binary images by border following.
+  int nbd = 1; // Newest border
+  for (int i = 0; i < height; i++) {
+    int lnbd = 1; // Last newest border, reset at the beginning of each scan row
+    const int *row = L[i + 1];
+
+    for (size_t r = rowRuns[i]; r < rowRuns[i + 1]; r += 2) {
+      const int first = runs[r], last = runs[r + 1];
+      scanPixel(L, i + 1, first, true, first == last, nbd, lnbd, contours);
+
+      if (last > first) {
+        // The pixels inside a run cannot start a border but may update lnbd (4),
+        // which only matters if the last pixel starts a new hole border
+        if (row[last] == 1) {
+          for (int j = last - 1; j > first; j--) {
+            if (row[j] != 0 && row[j] != 1) {
+              lnbd = std::abs(row[j]);
+              break;
+            }
+          }
+        }
+        scanPixel(L, i + 1, last, false, true, nbd, lnbd, contours);
+      }
+    }
+  }
+
+  if (retrievalMode != CONTOUR_RETR_TREE) {
+    // Keep the external contours or forget the hierarchy
+    unsigned int nbContours = 0, nbPoints = 0;
+    for (unsigned int k = 0; k < contours.size(); k++) {
+      if (retrievalMode == CONTOUR_RETR_EXTERNAL && contours.m_parents[k] != -1) {
+        continue;
+      }
+
+      const unsigned int first = contours.m_offsets[k], last = contours.m_offsets[k + 1];
+      std::copy(contours.m_points.begin() + first, contours.m_points.begin() + last,
+                contours.m_points.begin() + nbPoints);
+      nbPoints += last - first;
+      contours.m_types[nbContours] = contours.m_types[k];
+      contours.m_parents[nbContours] = -1;
+      contours.m_offsets[++nbContours] = nbPoints;
+    }
+
+    contours.m_points.resize(nbPoints);
+    contours.m_offsets.resize(nbContours + 1);
+    contours.m_types.resize(nbContours);
+    contours.m_parents.resize(nbContours);
+  }
+
+  if (epsilon > 0) {
+    std::vector<unsigned char> keep;
+    std::vector<std::pair<unsigned int, unsigned int> > chains;
+    unsigned int nbPoints = 0;
+    for (unsigned int k = 0; k < contours.size(); k++) {
+      // The points of the previous contours are already moved, not those of this one
+      const unsigned int first = contours.m_offsets[k], n = contours.m_offsets[k + 1] - first;
+      simplifyPolygon(&contours.m_points[first], n, epsilon, keep, chains);
+      contours.m_offsets[k] = nbPoints;
+      for (unsigned int m = 0; m < n; m++) {
+        if (keep[m]) {
+          contours.m_points[nbPoints++] = contours.m_points[first + m];
+        }
+      }
+    }
+    contours.m_offsets.back() = nbPoints;
+    contours.m_points.resize(nbPoints);
+  }
+
+  // Children and siblings, in the order the contours are found
+  contours.m_firstChildren.assign(contours.size(), -1);
+  contours.m_nextSiblings.assign(contours.size(), -1);
+  for (int k = static_cast<int>(contours.size()) - 1; k >= 0; k--) {
+    int &first = contours.m_parents[k] < 0 ? contours.m_firstRoot : contours.m_firstChildren[contours.m_parents[k]];
+    contours.m_nextSiblings[k] = first;
+    first = k;
+  }
+}
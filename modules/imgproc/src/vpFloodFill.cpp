@@ -68,14 +68,53 @@
   \brief Flood fill algorithm.
 */
 
-#include <queue>
+#include <algorithm>
+#include <cstring>
+#include <vector>
 #include <visp3/imgproc/vpImgproc.h>
 
+namespace
+{
+// Seed of a span to fill
+struct vpSpanSeed {
+  int x, y;
+  vpSpanSeed(int x_, int y_) : x(x_), y(y_) {}
+};
+
+/*
+  Push a seed for each run of oldValue pixels in [xl, xr] of the row y.
+*/
+inline void pushSpans(const vpImage<unsigned char> &I, std::vector<vpSpanSeed> &seeds, int xl, int xr, int y,
+                      unsigned char oldValue)
+{
+  const unsigned char *row = I[y];
+  int x = xl;
+  while (x <= xr) {
+    while (x <= xr && row[x] != oldValue) {
+      x++;
+    }
+    if (x > xr) {
+      break;
+    }
+    seeds.push_back(vpSpanSeed(x, y));
+    while (x <= xr && row[x] == oldValue) {
+      x++;
+    }
+  }
+}
+} // namespace
+
 /*!
   \ingroup group_imgproc_connected_components
 
   Perform the flood fill algorithm.
 
+  The image is filled span by span: each seed is extended to the left and to
+  the right over the pixels equal to \e oldValue, the span is filled, then a
+  seed is pushed for each run of \e oldValue pixels adjacent to the span in
+  the rows above and below (extended by one pixel on each side with
+  8-connexity). Each pixel is thus read a bounded number of times.
+
   \param I : Input image to flood fill.
   \param seedPoint : Seed position in the image.
   \param oldValue : Old value to replace.
@@ -85,89 +124,47 @@
 void vp::floodFill(vpImage<unsigned char> &I, const vpImagePoint &seedPoint, const unsigned char oldValue,
                    const unsigned char newValue, const vpImageMorphology::vpConnexityType &connexity)
 {
-  // Code from Lode Vandevenne tutorial.
-  // Naive modification for 8-connexity implementation
+  // Scanline flood fill, from Lode Vandevenne tutorial
   if (oldValue == newValue || I.getSize() == 0) {
     return;
   }
 
-  std::queue<vpImagePoint> seed_queue;
-
-  // Add initial seed point
-  seed_queue.push(seedPoint);
+  const int width = static_cast<int>(I.getWidth()), height = static_cast<int>(I.getHeight());
+  const int x0 = static_cast<int>(seedPoint.get_j()), y0 = static_cast<int>(seedPoint.get_i());
+  if (x0 < 0 || y0 < 0 || x0 >= width || y0 >= height) {
+    return;
+  }
 
-  while (!seed_queue.empty()) {
-    vpImagePoint current_seed = seed_queue.front();
-    seed_queue.pop();
+  const int diag = (connexity == vpImageMorphology::CONNEXITY_4) ? 0 : 1;
+  std::vector<vpSpanSeed> seeds;
+  seeds.push_back(vpSpanSeed(x0, y0));
 
-    unsigned int x = (unsigned int)current_seed.get_j();
-    unsigned int y = (unsigned int)current_seed.get_i();
-    int x1 = (int)x;
+  while (!seeds.empty()) {
+    const vpSpanSeed seed = seeds.back();
+    seeds.pop_back();
 
-    // Find most left pixel
-    while (x1 >= 0 && I[y][x1] == oldValue) {
-      x1--;
+    unsigned char *row = I[seed.y];
+    if (row[seed.x] != oldValue) {
+      // Already filled from another seed
+      continue;
     }
-    x1++;
-
-    bool spanAbove = false, spanBelow = false;
-
-    while (x1 < (int)I.getWidth() && I[y][x1] == oldValue) {
-      I[y][x1] = newValue;
-
-      if (!spanAbove && y > 0) {
-        if (I[y - 1][x1] == oldValue) {
-          // North
-          spanAbove = true;
-          seed_queue.push(vpImagePoint(y - 1, x1));
-        }
 
-        if (connexity != vpImageMorphology::CONNEXITY_4) {
-          if (x1 > 0 && I[y - 1][x1 - 1] == oldValue) {
-            // North west
-            spanAbove = true;
-            seed_queue.push(vpImagePoint(y - 1, x1 - 1));
-          }
-          if (x1 < (int)I.getWidth() - 1 && I[y - 1][x1 + 1] == oldValue) {
-            // North east
-            spanAbove = true;
-            seed_queue.push(vpImagePoint(y - 1, x1 + 1));
-          }
-        }
-      } else if (spanAbove && y > 0 && I[y - 1][x1] != oldValue) {
-        spanAbove = false;
-      }
-
-      if (!spanBelow && y < I.getHeight() - 1) {
-        if (I[y + 1][x1] == oldValue) {
-          // South
-          seed_queue.push(vpImagePoint(y + 1, x1));
-          spanBelow = true;
-        }
-
-        if (connexity != vpImageMorphology::CONNEXITY_4) {
-          if (x1 > 0 && I[y + 1][x1 - 1] == oldValue) {
-            // South west
-            seed_queue.push(vpImagePoint(y + 1, x1 - 1));
-            spanBelow = true;
-          }
-          if (x1 < (int)I.getWidth() - 1 && I[y + 1][x1 + 1] == oldValue) {
-            // South east
-            seed_queue.push(vpImagePoint(y + 1, x1 + 1));
-            spanBelow = true;
-          }
-        }
-      } else if (spanBelow && y < I.getHeight() - 1 && I[y + 1][x1] != oldValue) {
-        spanBelow = false;
-      }
-
-      // TODO: improve 8-connexity
-      if (connexity != vpImageMorphology::CONNEXITY_4) {
-        spanBelow = false;
-        spanAbove = false;
-      }
+    // Find the extent of the span
+    int xl = seed.x, xr = seed.x;
+    while (xl > 0 && row[xl - 1] == oldValue) {
+      xl--;
+    }
+    while (xr < width - 1 && row[xr + 1] == oldValue) {
+      xr++;
+    }
+    memset(row + xl, newValue, static_cast<size_t>(xr - xl + 1));
 
-      x1++;
+    const int xmin = std::max(xl - diag, 0), xmax = std::min(xr + diag, width - 1);
+    if (seed.y > 0) {
+      pushSpans(I, seeds, xmin, xmax, seed.y - 1, oldValue);
+    }
+    if (seed.y < height - 1) {
+      pushSpans(I, seeds, xmin, xmax, seed.y + 1, oldValue);
     }
   }
 }
@@ -171,6 +171,32 @@ void vp::equalizeHistogram(vpImage<unsigned char> &I)
   vpHistogram hist;
   hist.calculate(I);
 
+  vp::equalizeHistogram(I, hist);
+}
+
+/*!
+  \ingroup group_imgproc_histogram
+
+  Adjust the contrast of a grayscale image by performing an histogram
+  equalization with its precomputed histogram, so that the same histogram can
+  be shared with other functions such as vp::autoThreshold(). When the
+  histogram is computed on a region of interest or with a mask, the
+  cumulative distribution of these pixels becomes linear; the gray levels
+  below the lowest level of the histogram are set to 0 and the ones above its
+  highest level to 255.
+
+  \param I : The grayscale image to apply histogram equalization.
+  \param hist : Histogram of \e I with 256 bins.
+
+  \exception vpException::dimensionError : The histogram does not have 256
+  bins.
+*/
+void vp::equalizeHistogram(vpImage<unsigned char> &I, const vpHistogram &hist)
+{
+  if (hist.getSize() != 256) {
+    throw(vpException(vpException::dimensionError, "The histogram has %d bins instead of 256", hist.getSize()));
+  }
+
   // Calculate the cumulative distribution function
   unsigned int cdf[256];
   unsigned int cdfMin = /*std::numeric_limits<unsigned int>::max()*/ UINT_MAX, cdfMax = 0;
@@ -185,7 +211,7 @@ void vp::equalizeHistogram(vpImage<unsigned char> &I)
   }
 
   for (unsigned int i = 1; i < 256; i++) {
-    cdf[i] = cdf[i - 1] + hist[i];
+    cdf[i] = cdf[i - 1] + hist[(unsigned char)i];
 
     if (cdf[i] < cdfMin && cdf[i] > 0) {
       cdfMin = cdf[i];
@@ -198,17 +224,23 @@ void vp::equalizeHistogram(vpImage<unsigned char> &I)
     }
   }
 
-  unsigned int nbPixels = I.getWidth() * I.getHeight();
-  if (nbPixels == cdfMin) {
+  unsigned int nbPixels = cdf[255];
+  if (nbPixels == cdfMin || nbPixels == 0) {
     // Only one brightness value in the image
     return;
   }
 
   // Construct the look-up table
   unsigned char lut[256];
+  for (unsigned int x = 0; x < minValue; x++) {
+    lut[x] = 0;
+  }
   for (unsigned int x = minValue; x <= maxValue; x++) {
     lut[x] = vpMath::round((cdf[x] - cdfMin) / (double)(nbPixels - cdfMin) * 255.0);
   }
+  for (unsigned int x = maxValue + 1; x < 256; x++) {
+    lut[x] = 255;
+  }
 
   I.performLut(lut);
 }
@@ -417,20 +449,60 @@ void vp::gammaCorrection(const vpImage<vpRGBa> &I1, vpImage<vpRGBa> &I2, double
 */
 void vp::stretchContrast(vpImage<unsigned char> &I)
 {
+  vpHistogram hist(I);
+  vp::stretchContrast(I, hist);
+}
+
+/*!
+  \ingroup group_imgproc_contrast
+
+  Stretch the contrast of a grayscale image with its precomputed histogram,
+  so that the same histogram can be shared with other functions such as
+  vp::autoThreshold(). The lowest and highest gray levels of the histogram
+  are mapped to 0 and 255. When the histogram is computed on a region of
+  interest or with a mask, the gray levels outside this range are set to 0 or
+  255.
+
+  \param I : The grayscale image to stretch the contrast.
+  \param hist : Histogram of \e I with 256 bins.
+
+  \exception vpException::dimensionError : The histogram does not have 256
+  bins.
+*/
+void vp::stretchContrast(vpImage<unsigned char> &I, const vpHistogram &hist)
+{
+  if (hist.getSize() != 256) {
+    throw(vpException(vpException::dimensionError, "The histogram has %d bins instead of 256", hist.getSize()));
+  }
+
   // Find min and max intensity values
-  unsigned char min = 255, max = 0;
-  I.getMinMaxValue(min, max);
+  int min = 0, max = 255;
+  while (min < 256 && hist[(unsigned char)min] == 0) {
+    min++;
+  }
+  if (min == 256) {
+    // Empty histogram
+    return;
+  }
+  while (hist[(unsigned char)max] == 0) {
+    max--;
+  }
 
-  unsigned char range = max - min;
+  int range = max - min;
+  if (range == 0) {
+    return;
+  }
 
   // Construct the look-up table
   unsigned char lut[256];
-  if (range > 0) {
-    for (unsigned int x = min; x <= max; x++) {
-      lut[x] = 255 * (x - min) / range;
+  for (int x = 0; x < 256; x++) {
+    if (x < min) {
+      lut[x] = 0;
+    } else if (x > max) {
+      lut[x] = 255;
+    } else {
+      lut[x] = (unsigned char)(255 * (x - min) / range);
     }
-  } else {
-    lut[min] = min;
   }
 
   I.performLut(lut);
@@ -41,9 +41,36 @@
   \brief Additional image morphology functions.
 */
 
+#include <algorithm>
+#include <queue>
+#include <vector>
 #include <visp3/core/vpImageTools.h>
 #include <visp3/imgproc/vpImgproc.h>
 
+namespace
+{
+/*
+  Maximum of each pixel of row with the pixels of the neighboring row
+  (vertical neighbor, and diagonal neighbors with 8-connexity). Independent
+  per pixel, the loops are vectorized by the compiler.
+*/
+void maxWithNeighborRow(const unsigned char *row, const unsigned char *neighborRow, unsigned char *dst,
+                        unsigned int width, bool connexity8)
+{
+  for (unsigned int j = 0; j < width; j++) {
+    dst[j] = std::max(row[j], neighborRow[j]);
+  }
+
+  if (connexity8 && width > 1) {
+    dst[0] = std::max(dst[0], neighborRow[1]);
+    for (unsigned int j = 1; j < width - 1; j++) {
+      dst[j] = std::max(dst[j], std::max(neighborRow[j - 1], neighborRow[j + 1]));
+    }
+    dst[width - 1] = std::max(dst[width - 1], neighborRow[width - 2]);
+  }
+}
+} // namespace
+
 /*!
   \ingroup group_imgproc_morph
 
@@ -111,16 +138,16 @@ void vp::fillHoles(vpImage<unsigned char> &I
   // Perform flood fill
   vp::floodFill(flood_fill_mask, vpImagePoint(0, 0), 0, 255);
 
-  // Get current mask
-  vpImage<unsigned char> mask(I.getHeight(), I.getWidth());
-  for (unsigned int i = 0; i < mask.getHeight(); i++) {
-    memcpy(mask[i], flood_fill_mask[i + 1] + 1, sizeof(unsigned char) * mask.getWidth());
+  // Background pixels not reached by the flood fill are holes. The
+  // foreground is set to 255, as the saturated addition of the holes image
+  // used to do.
+  for (unsigned int i = 0; i < I.getHeight(); i++) {
+    const unsigned char *mask = flood_fill_mask[i + 1] + 1;
+    unsigned char *row = I[i];
+    for (unsigned int j = 0; j < I.getWidth(); j++) {
+      row[j] = (row[j] == 0 && mask[j] == 255) ? 0 : 255;
+    }
   }
-
-  // Get image with holes filled
-  vpImage<unsigned char> I_white(I.getHeight(), I.getWidth(), 255), I_holes;
-  vpImageTools::imageSubtract(I_white, mask, I_holes);
-  vpImageTools::imageAdd(I, I_holes, I, true);
 #endif
 }
 
@@ -137,6 +164,14 @@ void vp::fillHoles(vpImage<unsigned char> &I
   ) \f] with \f$ k \f$ such that: \f$ D_{g}^{\left ( k \right )} \left ( f
   \right ) = D_{g}^{\left ( k+1 \right )} \left ( f \right ) \f$
 
+  The reconstruction is computed with the hybrid algorithm of L. Vincent,
+  "Morphological grayscale reconstruction in image analysis: applications and
+  efficient algorithms", IEEE Transactions on Image Processing, 2(2):176-201,
+  1993: a raster scan and an anti-raster scan propagate the marker, then the
+  pixels that can still be modified are propagated with a FIFO queue. Unlike
+  the iterated geodesic dilations, the number of image scans does not depend
+  on the image content.
+
   \param marker : Grayscale image marker.
   \param mask : Grayscale image mask.
   \param h_kp1 : Image morphologically reconstructed.
@@ -157,24 +192,101 @@ void vp::reconstruct(const vpImage<unsigned char> &marker, const vpImage<unsigne
     return;
   }
 
-  vpImage<unsigned char> h_k = marker;
-  h_kp1 = h_k;
+  const unsigned int height = marker.getHeight(), width = marker.getWidth();
+  const bool connexity8 = (connexity == vpImageMorphology::CONNEXITY_8);
 
-  do {
-    // Dilatation
-    vpImageMorphology::dilatation(h_kp1, connexity);
+  vpImage<unsigned char> mask_copy;
+  const vpImage<unsigned char> *I = &mask;
+  if (&h_kp1 == &mask) {
+    mask_copy = mask;
+    I = &mask_copy;
+  }
 
-    // Keep min
-    for (unsigned int i = 0; i < h_kp1.getHeight(); i++) {
-      for (unsigned int j = 0; j < h_kp1.getWidth(); j++) {
-        h_kp1[i][j] = std::min(h_kp1[i][j], mask[i][j]);
-      }
+  // The reconstructed image J starts from the first geodesic dilation of the
+  // marker, which also brings the marker under the mask
+  vpImage<unsigned char> &J = h_kp1;
+  if (&J != &marker) {
+    J = marker;
+  }
+  vpImageMorphology::dilatation(J, connexity);
+  for (unsigned int k = 0; k < J.getSize(); k++) {
+    J.bitmap[k] = std::min(J.bitmap[k], I->bitmap[k]);
+  }
+
+  std::vector<unsigned char> tmp(width);
+
+  // Raster scan: propagate from the top and left neighbors
+  for (unsigned int i = 0; i < height; i++) {
+    unsigned char *row = J[i];
+    const unsigned char *rowMask = (*I)[i];
+    if (i > 0) {
+      maxWithNeighborRow(row, J[i - 1], &tmp[0], width, connexity8);
+    } else {
+      memcpy(&tmp[0], row, width);
+    }
+
+    unsigned char prev = 0;
+    for (unsigned int j = 0; j < width; j++) {
+      prev = std::min(std::max(tmp[j], prev), rowMask[j]);
+      row[j] = prev;
+    }
+  }
+
+  // Anti-raster scan: propagate from the bottom and right neighbors, and
+  // queue the pixels that may still propagate their value to them
+  std::queue<unsigned int> fifo;
+  for (unsigned int i = height; i-- > 0;) {
+    unsigned char *row = J[i];
+    const unsigned char *rowMask = (*I)[i];
+    if (i + 1 < height) {
+      maxWithNeighborRow(row, J[i + 1], &tmp[0], width, connexity8);
+    } else {
+      memcpy(&tmp[0], row, width);
+    }
+
+    unsigned char prev = 0;
+    for (unsigned int j = width; j-- > 0;) {
+      prev = std::min(std::max(tmp[j], prev), rowMask[j]);
+      row[j] = prev;
     }
 
-    if (h_kp1 == h_k) {
-      break;
+    for (unsigned int j = 0; j < width; j++) {
+      const unsigned char value = row[j];
+      bool push = (j + 1 < width && row[j + 1] < value && row[j + 1] < rowMask[j + 1]);
+      if (!push && i + 1 < height) {
+        const unsigned char *rowDown = J[i + 1], *rowMaskDown = (*I)[i + 1];
+        push = (rowDown[j] < value && rowDown[j] < rowMaskDown[j]);
+        if (!push && connexity8) {
+          push = (j > 0 && rowDown[j - 1] < value && rowDown[j - 1] < rowMaskDown[j - 1]) ||
+                 (j + 1 < width && rowDown[j + 1] < value && rowDown[j + 1] < rowMaskDown[j + 1]);
+        }
+      }
+      if (push) {
+        fifo.push(i * width + j);
+      }
     }
+  }
+
+  // Propagation
+  const int di[] = {-1, 0, 0, 1, -1, -1, 1, 1};
+  const int dj[] = {0, -1, 1, 0, -1, 1, -1, 1};
+  const int nbNeighbors = connexity8 ? 8 : 4;
+  while (!fifo.empty()) {
+    const unsigned int p = fifo.front();
+    fifo.pop();
+    const int pi = static_cast<int>(p / width), pj = static_cast<int>(p % width);
+    const unsigned char value = J.bitmap[p];
 
-    h_k = h_kp1;
-  } while (true);
+    for (int n = 0; n < nbNeighbors; n++) {
+      const int qi = pi + di[n], qj = pj + dj[n];
+      if (qi < 0 || qj < 0 || qi >= static_cast<int>(height) || qj >= static_cast<int>(width)) {
+        continue;
+      }
+      const unsigned int q = static_cast<unsigned int>(qi) * width + static_cast<unsigned int>(qj);
+      if (J.bitmap[q] < value && J.bitmap[q] != I->bitmap[q]) {
+        J.bitmap[q] = std::min(value, I->bitmap[q]);
+        fifo.push(q);
+      }
+    }
+  }
 }
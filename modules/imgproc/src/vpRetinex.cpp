@@ -86,9 +86,6 @@
   \brief Retinex algorithm
 */
 
-#include <functional>
-#include <numeric>
-
 #include <visp3/core/vpImageFilter.h>
 #include <visp3/core/vpMath.h>
 #include <visp3/imgproc/vpImgproc.h>
@@ -137,6 +134,221 @@ std::vector<double> retinexScalesDistribution(int scaleDiv, int level, int scale
   return scales;
 }
 
+namespace
+{
+/*
+  Recursive approximation of the Gaussian filter of Young and van Vliet,
+  "Recursive implementation of the Gaussian filter", Signal Processing, 1995.
+  The filter is applied forward then backward, each pass costing a constant
+  number of operations per pixel whatever sigma. Instead of the linear
+  relation of the paper between q and sigma, which overestimates the standard
+  deviation by up to 10%, q is chosen so that the variance of the impulse
+  response is exactly sigma^2.
+*/
+struct vpRecursiveGaussian {
+  explicit vpRecursiveGaussian(double sigma) : B(1.0f), b1(0.0f), b2(0.0f), b3(0.0f), identity(sigma <= 0.0), pad(0)
+  {
+    if (identity) {
+      return;
+    }
+
+    // The standard deviation increases with q
+    double qMin = 0.0, qMax = 2.0 * sigma + 2.0;
+    for (int iter = 0; iter < 60; iter++) {
+      double q = 0.5 * (qMin + qMax);
+      if (standardDeviation(q) < sigma) {
+        qMin = q;
+      } else {
+        qMax = q;
+      }
+    }
+
+    double c[3];
+    coefficients(0.5 * (qMin + qMax), c);
+    b1 = (float)c[0];
+    b2 = (float)c[1];
+    b3 = (float)c[2];
+    B = (float)(1.0 - c[0] - c[1] - c[2]);
+    // Mirrored samples used to initialize the recursion on each side
+    pad = (int)std::ceil(4.0 * sigma);
+  }
+
+  // Feedback coefficients b1/b0, b2/b0 and b3/b0 of the paper
+  static void coefficients(double q, double c[3])
+  {
+    double q2 = q * q, q3 = q2 * q;
+    double b0 = 1.57825 + 2.44413 * q + 1.4281 * q2 + 0.422205 * q3;
+    c[0] = (2.44413 * q + 2.85619 * q2 + 1.26661 * q3) / b0;
+    c[1] = -(1.4281 * q2 + 1.26661 * q3) / b0;
+    c[2] = 0.422205 * q3 / b0;
+  }
+
+  /*
+    Standard deviation of the forward-backward filter, from the derivatives in
+    1 of the transfer function B / (1 - b1 u - b2 u^2 - b3 u^3) of each pass.
+  */
+  static double standardDeviation(double q)
+  {
+    double c[3];
+    coefficients(q, c);
+    double B = 1.0 - c[0] - c[1] - c[2];
+    double d1 = -(c[0] + 2.0 * c[1] + 3.0 * c[2]);
+    double d2 = -(2.0 * c[1] + 6.0 * c[2]);
+    double h1 = -d1 / B;
+    double h2 = 2.0 * d1 * d1 / (B * B) - d2 / B;
+    return std::sqrt(2.0 * (h2 + h1 - h1 * h1));
+  }
+
+  float B, b1, b2, b3;
+  bool identity;
+  int pad;
+};
+
+/*
+  Standard deviation of the truncated and normalized Gaussian kernel used by
+  vpImageFilter::gaussianBlur(). The recursive filter with this standard
+  deviation has the same variance as the truncated kernel, which matters when
+  the kernel is much smaller than 6 sigma, as with the default scales.
+*/
+double truncatedGaussianSigma(unsigned int size, double sigma)
+{
+  std::vector<double> fg((size + 1) / 2);
+  vpImageFilter::getGaussianKernel(&fg[0], size, sigma, true);
+
+  double variance = 0.0;
+  for (size_t i = 1; i < fg.size(); i++) {
+    variance += 2.0 * fg[i] * (double)(i * i);
+  }
+
+  return std::sqrt(variance);
+}
+
+// Maximum number of rows filtered together by recursiveGaussianRows()
+const int retinexBlockHeight = 16;
+
+// Index of the sample mirrored at the borders, as in vpImageFilter::filterX()
+inline int mirror(int i, int length)
+{
+  if (i < 0) {
+    return std::min(-i, length - 1);
+  }
+  if (i >= length) {
+    return std::max(2 * length - i - 2, 0);
+  }
+  return i;
+}
+
+/*
+  Forward and backward recursive Gaussian passes along n samples of m
+  interleaved signals stored in buf, the samples of the signals being
+  contiguous. The inner loops over the signals vectorize. The signals are
+  supposed constant before the first and after the last sample.
+*/
+void recursiveGaussianPasses(float *buf, int n, int m, const vpRecursiveGaussian &g)
+{
+  for (int i = 1; i < n; i++) {
+    const float *w1 = buf + (i - 1) * m;
+    const float *w2 = buf + std::max(i - 2, 0) * m;
+    const float *w3 = buf + std::max(i - 3, 0) * m;
+    float *w = buf + i * m;
+    for (int j = 0; j < m; j++) {
+      w[j] = g.B * w[j] + g.b1 * w1[j] + g.b2 * w2[j] + g.b3 * w3[j];
+    }
+  }
+
+  for (int i = n - 2; i >= 0; i--) {
+    const float *w1 = buf + (i + 1) * m;
+    const float *w2 = buf + std::min(i + 2, n - 1) * m;
+    const float *w3 = buf + std::min(i + 3, n - 1) * m;
+    float *w = buf + i * m;
+    for (int j = 0; j < m; j++) {
+      w[j] = g.B * w[j] + g.b1 * w1[j] + g.b2 * w2[j] + g.b3 * w3[j];
+    }
+  }
+}
+
+/*
+  Horizontal recursive Gaussian filtering of the rows [y0, y0 + nbRows) of I
+  into the same rows of dst. The rows, extended by mirrored samples, are
+  interleaved in buf to be filtered together.
+*/
+void recursiveGaussianRows(const vpImage<float> &I, int y0, int nbRows, const vpRecursiveGaussian &g,
+                           std::vector<float> &buf, vpImage<float> &dst)
+{
+  int width = (int)I.getWidth();
+
+  if (g.identity) {
+    for (int y = y0; y < y0 + nbRows; y++) {
+      std::copy(I[y], I[y] + width, dst[y]);
+    }
+    return;
+  }
+
+  int pad = std::min(g.pad, width - 1);
+  int n = width + 2 * pad;
+  buf.resize((size_t)(n * nbRows));
+  const float *rows[retinexBlockHeight];
+  for (int r = 0; r < nbRows; r++) {
+    rows[r] = I[y0 + r];
+  }
+  for (int i = 0; i < n; i++) {
+    int x = mirror(i - pad, width);
+    float *b = &buf[(size_t)(i * nbRows)];
+    for (int r = 0; r < nbRows; r++) {
+      b[r] = rows[r][x];
+    }
+  }
+
+  recursiveGaussianPasses(&buf[0], n, nbRows, g);
+
+  for (int x = 0; x < width; x++) {
+    const float *b = &buf[(size_t)((x + pad) * nbRows)];
+    for (int r = 0; r < nbRows; r++) {
+      dst[y0 + r][x] = b[r];
+    }
+  }
+}
+
+/*
+  Vertical recursive Gaussian filtering of the columns [x0, x0 + cw) of I.
+  The result is multiplied into prod, a cw-wide band of the image height.
+*/
+void recursiveGaussianColumnsProduct(const vpImage<float> &I, int x0, int cw, const vpRecursiveGaussian &g,
+                                     std::vector<float> &buf, std::vector<float> &prod)
+{
+  int height = (int)I.getHeight();
+
+  if (g.identity) {
+    for (int y = 0; y < height; y++) {
+      const float *src = I[y] + x0;
+      float *p = &prod[(size_t)(y * cw)];
+      for (int x = 0; x < cw; x++) {
+        p[x] *= src[x];
+      }
+    }
+    return;
+  }
+
+  int pad = std::min(g.pad, height - 1);
+  int n = height + 2 * pad;
+  buf.resize((size_t)(n * cw));
+  for (int i = 0; i < n; i++) {
+    const float *src = I[mirror(i - pad, height)] + x0;
+    std::copy(src, src + cw, &buf[(size_t)(i * cw)]);
+  }
+
+  recursiveGaussianPasses(&buf[0], n, cw, g);
+
+  for (int y = 0; y < height; y++) {
+    const float *w = &buf[(size_t)((y + pad) * cw)];
+    float *p = &prod[(size_t)(y * cw)];
+    for (int x = 0; x < cw; x++) {
+      p[x] *= w[x];
+    }
+  }
+}
+} // namespace
+
 // See: http://imagej.net/Retinex and
 // https://docs.gimp.org/en/plug-in-retinex.html
 void MSRCR(vpImage<vpRGBa> &I, int _scale, int scaleDiv, int level, double dynamic,
@@ -149,11 +361,10 @@ void MSRCR(vpImage<vpRGBa> &I, int _scale, int scaleDiv, int level, double dynam
   // Filtering according to the various scales.
   // Summarize the results of the various filters according to a specific
   // weight(here equivalent for all).
-  double weight = 1.0 / (double)scaleDiv;
+  float weight = 1.0f / (float)scaleDiv;
 
-  std::vector<vpImage<double> > doubleRGB(3);
-  std::vector<vpImage<double> > doubleResRGB(3);
-  unsigned int size = I.getSize();
+  const int width = (int)I.getWidth(), height = (int)I.getHeight();
+  const int size = (int)I.getSize();
 
   int kernelSize = _kernelSize;
   if (kernelSize == -1) {
@@ -162,71 +373,116 @@ void MSRCR(vpImage<vpRGBa> &I, int _scale, int scaleDiv, int level, double dynam
     kernelSize = (kernelSize - kernelSize % 2) + 1;
   }
 
-  for (int channel = 0; channel < 3; channel++) {
-    doubleRGB[(size_t)channel] = vpImage<double>(I.getHeight(), I.getWidth());
-    doubleResRGB[(size_t)channel] = vpImage<double>(I.getHeight(), I.getWidth());
-
-    for (unsigned int cpt = 0; cpt < size; cpt++) {
-      // Shift the pixel values by 1 to avoid problem with log(0)
-      switch (channel) {
-      case 0:
-        doubleRGB[(size_t)channel].bitmap[cpt] = I.bitmap[cpt].R + 1.0;
-        break;
-
-      case 1:
-        doubleRGB[(size_t)channel].bitmap[cpt] = I.bitmap[cpt].G + 1.0;
-        break;
-
-      case 2:
-        doubleRGB[(size_t)channel].bitmap[cpt] = I.bitmap[cpt].B + 1.0;
-        break;
-
-      default:
-        break;
-      }
-    }
+  std::vector<vpRecursiveGaussian> gaussians;
+  for (int sc = 0; sc < scaleDiv; sc++) {
+    gaussians.push_back(vpRecursiveGaussian(truncatedGaussianSigma((unsigned int)kernelSize, retinexScales[(size_t)sc])));
+  }
 
-    for (int sc = 0; sc < scaleDiv; sc++) {
-      vpImage<double> blurImage;
-      double sigma = retinexScales[(size_t)sc];
-      vpImageFilter::gaussianBlur(doubleRGB[(size_t)channel], blurImage, (unsigned int)kernelSize, sigma);
-
-      for (unsigned int cpt = 0; cpt < size; cpt++) {
-        // Summarize the filtered values.
-        // In fact one calculates a ratio between the original values and the
-        // filtered values.
-        doubleResRGB[(size_t)channel].bitmap[cpt] +=
-            weight * (std::log(doubleRGB[(size_t)channel].bitmap[cpt]) - std::log(blurImage.bitmap[cpt]));
-      }
-    }
+  // Logarithms of the pixel values, shifted by 1 to avoid problem with log(0)
+  float logValue[256], logAlphaValue[256], logLuminance[766];
+  const float alpha = 128.0f;
+  for (int i = 0; i < 256; i++) {
+    logValue[i] = std::log(i + 1.0f);
+    logAlphaValue[i] = std::log(alpha * (i + 1.0f));
+  }
+  for (int i = 0; i < 766; i++) {
+    logLuminance[i] = std::log(i + 3.0f);
   }
 
-  std::vector<double> dest(size * 3);
-  const double gain = 1.0, alpha = 128.0, offset = 0.0;
+  // Rows of the blocks filtered horizontally and columns of the bands
+  // filtered vertically
+  const int blockHeight = retinexBlockHeight, bandWidth = 64;
+  const int nbBlocks = (height + blockHeight - 1) / blockHeight;
+  const int nbBands = (width + bandWidth - 1) / bandWidth;
+
+  vpImage<float> src(I.getHeight(), I.getWidth());
+  std::vector<vpImage<float> > floatResRGB(3);
+  // Images filtered horizontally at each scale
+  std::vector<vpImage<float> > blurRows((size_t)scaleDiv);
+  for (int sc = 0; sc < scaleDiv; sc++) {
+    blurRows[(size_t)sc].resize(I.getHeight(), I.getWidth());
+  }
 
-  for (unsigned int cpt = 0; cpt < size; cpt++) {
-    double logl = std::log((double)(I.bitmap[cpt].R + I.bitmap[cpt].G + I.bitmap[cpt].B + 3.0));
+  for (int channel = 0; channel < 3; channel++) {
+    vpImage<float> &res = floatResRGB[(size_t)channel];
+    res.resize(I.getHeight(), I.getWidth());
 
-    dest[cpt * 3] = gain * (std::log(alpha * doubleRGB[0].bitmap[cpt]) - logl) * doubleResRGB[0].bitmap[cpt] + offset;
-    dest[cpt * 3 + 1] =
-        gain * (std::log(alpha * doubleRGB[1].bitmap[cpt]) - logl) * doubleResRGB[1].bitmap[cpt] + offset;
-    dest[cpt * 3 + 2] =
-        gain * (std::log(alpha * doubleRGB[2].bitmap[cpt]) - logl) * doubleResRGB[2].bitmap[cpt] + offset;
-  }
+#if defined _OPENMP
+#pragma omp parallel
+#endif
+    {
+      std::vector<float> buf;
 
-  double sum = std::accumulate(dest.begin(), dest.end(), 0.0);
-  double mean = sum / dest.size();
+      // Horizontal filtering of each block of rows, for all the scales
+#if defined _OPENMP
+#pragma omp for schedule(dynamic)
+#endif
+      for (int block = 0; block < nbBlocks; block++) {
+        int y0 = block * blockHeight;
+        int nbRows = std::min(blockHeight, height - y0);
+        for (int y = y0; y < y0 + nbRows; y++) {
+          const vpRGBa *rgba = I[y];
+          float *row = src[y];
+          for (int x = 0; x < width; x++) {
+            row[x] = (channel == 0 ? rgba[x].R : (channel == 1 ? rgba[x].G : rgba[x].B)) + 1.0f;
+          }
+        }
+        for (int sc = 0; sc < scaleDiv; sc++) {
+          recursiveGaussianRows(src, y0, nbRows, gaussians[(size_t)sc], buf, blurRows[(size_t)sc]);
+        }
+      }
 
-  std::vector<double> diff(dest.size());
+      // Vertical filtering of each band of columns. The sum of the logarithms
+      // of the blurred images is the logarithm of their product.
+      std::vector<float> prod;
+#if defined _OPENMP
+#pragma omp for schedule(dynamic)
+#endif
+      for (int band = 0; band < nbBands; band++) {
+        int x0 = band * bandWidth;
+        int cw = std::min(bandWidth, width - x0);
+        prod.assign((size_t)(height * cw), 1.0f);
+        for (int sc = 0; sc < scaleDiv; sc++) {
+          recursiveGaussianColumnsProduct(blurRows[(size_t)sc], x0, cw, gaussians[(size_t)sc], buf, prod);
+        }
+
+        // In fact one calculates a ratio between the original values and
+        // the filtered values.
+        for (int y = 0; y < height; y++) {
+          const float *p = &prod[(size_t)(y * cw)];
+          const float *s = src[y] + x0;
+          float *r = res[y] + x0;
+          for (int x = 0; x < cw; x++) {
+            r[x] = logValue[(int)s[x] - 1] - weight * std::log(p[x]);
+          }
+        }
+      }
+    }
+  }
 
-#if VISP_CXX_STANDARD > VISP_CXX_STANDARD_98
-  std::transform(dest.begin(), dest.end(), diff.begin(), std::bind(std::minus<double>(), std::placeholders::_1, mean));
-#else
-  std::transform(dest.begin(), dest.end(), diff.begin(), std::bind2nd(std::minus<double>(), mean));
+  const float gain = 1.0f, offset = 0.0f;
+  double sum = 0.0, sq_sum = 0.0;
+
+#if defined _OPENMP
+#pragma omp parallel for reduction(+ : sum, sq_sum)
 #endif
+  for (int cpt = 0; cpt < size; cpt++) {
+    const vpRGBa &v = I.bitmap[cpt];
+    float logl = logLuminance[v.R + v.G + v.B];
+
+    float r = gain * (logAlphaValue[v.R] - logl) * floatResRGB[0].bitmap[cpt] + offset;
+    float g = gain * (logAlphaValue[v.G] - logl) * floatResRGB[1].bitmap[cpt] + offset;
+    float b = gain * (logAlphaValue[v.B] - logl) * floatResRGB[2].bitmap[cpt] + offset;
+    floatResRGB[0].bitmap[cpt] = r;
+    floatResRGB[1].bitmap[cpt] = g;
+    floatResRGB[2].bitmap[cpt] = b;
+
+    sum += (double)r + (double)g + (double)b;
+    sq_sum += (double)r * r + (double)g * g + (double)b * b;
+  }
 
-  double sq_sum = std::inner_product(diff.begin(), diff.end(), diff.begin(), 0.0);
-  double stdev = std::sqrt(sq_sum / dest.size());
+  double mean = sum / (3.0 * size);
+  double stdev = std::sqrt(std::max(0.0, sq_sum / (3.0 * size) - mean * mean));
 
   double mini = mean - dynamic * stdev;
   double maxi = mean + dynamic * stdev;
@@ -236,10 +492,15 @@ void MSRCR(vpImage<vpRGBa> &I, int _scale, int scaleDiv, int level, double dynam
     range = 1.0;
   }
 
-  for (unsigned int cpt = 0; cpt < size; cpt++) {
-    I.bitmap[cpt].R = vpMath::saturate<unsigned char>((255.0 * (dest[cpt * 3 + 0] - mini) / range));
-    I.bitmap[cpt].G = vpMath::saturate<unsigned char>((255.0 * (dest[cpt * 3 + 1] - mini) / range));
-    I.bitmap[cpt].B = vpMath::saturate<unsigned char>((255.0 * (dest[cpt * 3 + 2] - mini) / range));
+  const float scale = (float)(255.0 / range);
+  const float shift = (float)mini;
+#if defined _OPENMP
+#pragma omp parallel for
+#endif
+  for (int cpt = 0; cpt < size; cpt++) {
+    I.bitmap[cpt].R = vpMath::saturate<unsigned char>(scale * (floatResRGB[0].bitmap[cpt] - shift));
+    I.bitmap[cpt].G = vpMath::saturate<unsigned char>(scale * (floatResRGB[1].bitmap[cpt] - shift));
+    I.bitmap[cpt].B = vpMath::saturate<unsigned char>(scale * (floatResRGB[2].bitmap[cpt] - shift));
   }
 }
 
@@ -260,6 +521,10 @@ void MSRCR(vpImage<vpRGBa> &I, int _scale, int scaleDiv, int level, double dynam
   \param dynamic : Adjusts the color of the result. Large values produce less
   saturated images. \param kernelSize : Kernel size for the gaussian blur
   operation. If -1, the kernel size is calculated from the image size.
+
+  \note The Gaussian blurs are computed with a recursive filter whose cost
+  does not depend on the scale, with the same variance as the Gaussian kernel
+  of size \e kernelSize truncated by vpImageFilter::gaussianBlur().
 */
 void vp::retinex(vpImage<vpRGBa> &I, int scale, int scaleDiv, int level, const double dynamic,
                  int kernelSize)
@@ -302,6 +567,10 @@ void vp::retinex(vpImage<vpRGBa> &I, int scale, int scaleDiv, int level, const d
   \param dynamic : Adjusts the color of the result. Large values produce less
   saturated images. \param kernelSize : Kernel size for the gaussian blur
   operation. If -1, the kernel size is calculated from the image size.
+
+  \note The Gaussian blurs are computed with a recursive filter whose cost
+  does not depend on the scale, with the same variance as the Gaussian kernel
+  of size \e kernelSize truncated by vpImageFilter::gaussianBlur().
 */
 void vp::retinex(const vpImage<vpRGBa> &I1, vpImage<vpRGBa> &I2, int scale, int scaleDiv, int level,
                  double dynamic, int kernelSize)
@@ -380,6 +380,48 @@ unsigned char vp::autoThreshold(vpImage<unsigned char> &I, const vpAutoThreshold
 
   // Compute image histogram
   vpHistogram histogram(I);
+
+  return vp::autoThreshold(I, histogram, method, backgroundValue, foregroundValue);
+}
+
+/*!
+  \ingroup group_imgproc_threshold
+
+  Automatic thresholding with the precomputed histogram of the image, so that
+  the same histogram can be shared with other functions such as
+  vp::equalizeHistogram(vpImage<unsigned char> &, const vpHistogram &). The
+  histogram may have been computed on a region of interest or with a mask,
+  the threshold then only depends on these pixels but is applied to the whole
+  image.
+
+  \param I : Input grayscale image.
+  \param histogram : Histogram of \e I with 256 bins.
+  \param method : Automatic thresholding method.
+  \param backgroundValue : Value to set to the background.
+  \param foregroundValue : Value to set to the foreground.
+
+  \exception vpException::dimensionError : The histogram does not have 256
+  bins.
+*/
+unsigned char vp::autoThreshold(vpImage<unsigned char> &I, const vpHistogram &histogram,
+                                const vpAutoThresholdMethod &method, const unsigned char backgroundValue,
+                                const unsigned char foregroundValue)
+{
+  if (histogram.getSize() != 256) {
+    throw(vpException(vpException::dimensionError, "The histogram has %d bins instead of 256",
+                      histogram.getSize()));
+  }
+
+  // Number of pixels in the histogram
+  unsigned int nbPixels = 0;
+  for (unsigned int i = 0; i < 256; i++) {
+    nbPixels += histogram[(unsigned char)i];
+  }
+
+  if (I.getSize() == 0 || nbPixels == 0) {
+    return 0;
+  }
+
   int threshold = -1;
 
   switch (method) {
@@ -392,20 +434,23 @@ unsigned char vp::autoThreshold(vpImage<unsigned char> &I, const vpAutoThreshold
     break;
 
   case AUTO_THRESHOLD_ISODATA:
-    threshold = computeThresholdIsoData(histogram, I.getSize());
+    threshold = computeThresholdIsoData(histogram, nbPixels);
     break;
 
   case AUTO_THRESHOLD_MEAN:
-    threshold = computeThresholdMean(histogram, I.getSize());
+    threshold = computeThresholdMean(histogram, nbPixels);
     break;
 
   case AUTO_THRESHOLD_OTSU:
-    threshold = computeThresholdOtsu(histogram, I.getSize());
+    threshold = computeThresholdOtsu(histogram, nbPixels);
     break;
 
-  case AUTO_THRESHOLD_TRIANGLE:
-    threshold = computeThresholdTriangle(histogram);
+  case AUTO_THRESHOLD_TRIANGLE: {
+    // The histogram is flipped by the method
+    vpHistogram hist(histogram);
+    threshold = computeThresholdTriangle(hist);
     break;
+  }
 
   default:
     break;
@@ -36,8 +36,10 @@
  *
  *****************************************************************************/
 #include <map>
+#include <queue>
 #include <set>
 #include <visp3/core/vpImageTools.h>
+#include <visp3/core/vpUniRand.h>
 #include <visp3/core/vpIoTools.h>
 #include <visp3/imgproc/vpImgproc.h>
 #include <visp3/io/vpImageIo.h>
@@ -56,6 +58,165 @@ void usage(const char *name, const char *badparam, std::string ipath, std::strin
 bool getOptions(int argc, const char **argv, std::string &ipath, std::string &opath, std::string user);
 bool checkLabels(const vpImage<int> &label1, const vpImage<int> &label2);
 
+namespace
+{
+// Breadth-first search implementation used before the two-pass algorithm,
+// kept as a reference for the labels and the computation time
+void getNeighbors(const vpImage<unsigned char> &I, std::queue<vpImagePoint> &listOfNeighbors, unsigned int i,
+                  unsigned int j, const vpImageMorphology::vpConnexityType &connexity)
+{
+  unsigned char currValue = I[i][j];
+
+  for (int cpt1 = -1; cpt1 <= 1; cpt1++) {
+    for (int cpt2 = -1; cpt2 <= 1; cpt2++) {
+      if ((cpt1 != 0 || cpt2 != 0) && (connexity == vpImageMorphology::CONNEXITY_8 || cpt1 == 0 || cpt2 == 0)) {
+        if (I[(int)i + cpt1][(int)j + cpt2] == currValue) {
+          listOfNeighbors.push(vpImagePoint((int)i + cpt1, (int)j + cpt2));
+        }
+      }
+    }
+  }
+}
+
+void connectedComponentsBFS(const vpImage<unsigned char> &I, vpImage<int> &labels, int &nbComponents,
+                            const vpImageMorphology::vpConnexityType &connexity)
+{
+  labels.resize(I.getHeight(), I.getWidth());
+
+  vpImage<unsigned char> I_copy(I.getHeight() + 2, I.getWidth() + 2, 0);
+  for (unsigned int i = 0; i < I.getHeight(); i++) {
+    memcpy(I_copy[i + 1] + 1, I[i], sizeof(unsigned char) * I.getWidth());
+  }
+
+  vpImage<int> labels_copy(I.getHeight() + 2, I.getWidth() + 2, 0);
+  int current_label = 1;
+  std::queue<vpImagePoint> listOfNeighbors;
+
+  for (unsigned int i = 1; i <= I.getHeight(); i++) {
+    for (unsigned int j = 1; j <= I.getWidth(); j++) {
+      if (I_copy[i][j] && labels_copy[i][j] == 0) {
+        getNeighbors(I_copy, listOfNeighbors, i, j, connexity);
+        I_copy[i][j] = 0;
+        labels_copy[i][j] = current_label;
+
+        while (!listOfNeighbors.empty()) {
+          vpImagePoint imPt = listOfNeighbors.front();
+          unsigned int u = (unsigned int)imPt.get_j(), v = (unsigned int)imPt.get_i();
+          listOfNeighbors.pop();
+
+          if (I_copy[v][u]) {
+            getNeighbors(I_copy, listOfNeighbors, v, u, connexity);
+            I_copy[v][u] = 0;
+            labels_copy[v][u] = current_label;
+          }
+        }
+
+        current_label++;
+      }
+    }
+  }
+
+  for (unsigned int i = 0; i < labels.getHeight(); i++) {
+    memcpy(labels[i], labels_copy[i + 1] + 1, sizeof(int) * labels.getWidth());
+  }
+
+  nbComponents = current_label - 1;
+}
+
+// Check the statistics of the components against the label image
+bool checkComponents(const vpImage<unsigned char> &I, const vpImage<int> &labels, int nbComponents,
+                     const std::vector<vp::vpConnectedComponent> &components)
+{
+  if (components.size() != (size_t)nbComponents) {
+    std::cerr << "components.size() != nbComponents" << std::endl;
+    return false;
+  }
+
+  std::vector<unsigned int> area(components.size(), 0);
+  std::vector<double> sum_i(components.size(), 0.0), sum_j(components.size(), 0.0);
+  for (unsigned int i = 0; i < labels.getHeight(); i++) {
+    for (unsigned int j = 0; j < labels.getWidth(); j++) {
+      if (labels[i][j]) {
+        const vp::vpConnectedComponent &component = components[(size_t)labels[i][j] - 1];
+        if (component.m_value != I[i][j] || j < component.m_bbox.getLeft() || j > component.m_bbox.getRight() ||
+            i < component.m_bbox.getTop() || i > component.m_bbox.getBottom()) {
+          std::cerr << "Wrong value or bounding box for component " << labels[i][j] << std::endl;
+          return false;
+        }
+        area[(size_t)labels[i][j] - 1]++;
+        sum_i[(size_t)labels[i][j] - 1] += i;
+        sum_j[(size_t)labels[i][j] - 1] += j;
+      }
+    }
+  }
+
+  for (size_t k = 0; k < components.size(); k++) {
+    const vp::vpConnectedComponent &component = components[k];
+    if (component.m_label != (int)k + 1 || component.m_area != area[k] ||
+        !vpMath::equal(component.m_centroid.get_i(), sum_i[k] / area[k], 1e-6) ||
+        !vpMath::equal(component.m_centroid.get_j(), sum_j[k] / area[k], 1e-6)) {
+      std::cerr << "Wrong statistics for component " << k + 1 << std::endl;
+      return false;
+    }
+    // The bounding box must be tight
+    unsigned int top = (unsigned int)component.m_bbox.getTop(), left = (unsigned int)component.m_bbox.getLeft();
+    unsigned int bottom = (unsigned int)component.m_bbox.getBottom(),
+                 right = (unsigned int)component.m_bbox.getRight();
+    bool found_top = false, found_bottom = false, found_left = false, found_right = false;
+    for (unsigned int j = left; j <= right; j++) {
+      found_top = found_top || labels[top][j] == component.m_label;
+      found_bottom = found_bottom || labels[bottom][j] == component.m_label;
+    }
+    for (unsigned int i = top; i <= bottom; i++) {
+      found_left = found_left || labels[i][left] == component.m_label;
+      found_right = found_right || labels[i][right] == component.m_label;
+    }
+    if (!found_top || !found_bottom || !found_left || !found_right) {
+      std::cerr << "Bounding box of component " << k + 1 << " is not tight" << std::endl;
+      return false;
+    }
+  }
+
+  return true;
+}
+
+// Compare the labels with the reference implementation on random images
+// with several gray levels
+bool checkRandomImages()
+{
+  vpUniRand rng;
+  const unsigned int sizes[][2] = {{1, 1}, {1, 37}, {29, 1}, {2, 2}, {17, 23}, {64, 64}, {100, 211}, {240, 320}};
+  const vpImageMorphology::vpConnexityType connexities[] = {vpImageMorphology::CONNEXITY_4,
+                                                            vpImageMorphology::CONNEXITY_8};
+
+  for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+    for (int nbLevels = 2; nbLevels <= 4; nbLevels++) {
+      vpImage<unsigned char> I(sizes[s][0], sizes[s][1]);
+      for (unsigned int i = 0; i < I.getSize(); i++) {
+        I.bitmap[i] = (unsigned char)rng.uniform(0, nbLevels);
+      }
+
+      for (size_t c = 0; c < 2; c++) {
+        vpImage<int> labels_ref, labels;
+        int nbComponents_ref = 0, nbComponents = 0;
+        std::vector<vp::vpConnectedComponent> components;
+        connectedComponentsBFS(I, labels_ref, nbComponents_ref, connexities[c]);
+        vp::connectedComponents(I, labels, nbComponents, components, connexities[c]);
+
+        if (nbComponents != nbComponents_ref || !(labels == labels_ref) ||
+            !checkComponents(I, labels, nbComponents, components)) {
+          std::cerr << "Wrong connected components on a random " << I.getWidth() << "x" << I.getHeight()
+                    << " image with " << nbLevels << " levels" << std::endl;
+          return false;
+        }
+      }
+    }
+  }
+
+  return true;
+}
+} // namespace
+
 /*
   Print the program options.
 
@@ -265,6 +426,11 @@ int main(int argc, const char **argv)
       }
     }
 
+    // Compare with the breadth-first search implementation
+    if (!checkRandomImages()) {
+      throw vpException(vpException::fatalError, "Connected components differ from the reference on random images");
+    }
+
     // Test if an input path is set
     if (opt_ipath.empty() && env_ipath.empty()) {
       usage(argv[0], NULL, ipath, opt_opath, username);
@@ -306,6 +472,46 @@ int main(int argc, const char **argv)
     std::cout << "Time: " << t << " ms" << std::endl;
     std::cout << "nbComponents=" << nbComponents << std::endl;
 
+    const vpImageMorphology::vpConnexityType connexities[] = {vpImageMorphology::CONNEXITY_4,
+                                                              vpImageMorphology::CONNEXITY_8};
+    const vpImage<int> *labels_connexities[] = {&labels_connex4, &labels_connex8};
+    const int nbIterations = 10;
+    for (int c = 0; c < 2; c++) {
+      vpImage<int> labels_ref, labels;
+      int nbComponents_ref = 0;
+      std::vector<vp::vpConnectedComponent> components;
+
+      double t_ref = vpTime::measureTimeMs();
+      for (int iter = 0; iter < nbIterations; iter++) {
+        connectedComponentsBFS(I, labels_ref, nbComponents_ref, connexities[c]);
+      }
+      t_ref = (vpTime::measureTimeMs() - t_ref) / nbIterations;
+
+      t = vpTime::measureTimeMs();
+      for (int iter = 0; iter < nbIterations; iter++) {
+        vp::connectedComponents(I, labels, nbComponents, connexities[c]);
+      }
+      t = (vpTime::measureTimeMs() - t) / nbIterations;
+
+      double t_stats = vpTime::measureTimeMs();
+      for (int iter = 0; iter < nbIterations; iter++) {
+        vp::connectedComponents(I, labels, nbComponents, components, connexities[c]);
+      }
+      t_stats = (vpTime::measureTimeMs() - t_stats) / nbIterations;
+
+      std::cout << "\n" << (c == 0 ? 4 : 8) << "-connexity, mean time over " << nbIterations << " runs:" << std::endl;
+      std::cout << "Breadth-first search: " << t_ref << " ms" << std::endl;
+      std::cout << "Two-pass: " << t << " ms" << std::endl;
+      std::cout << "Two-pass with statistics: " << t_stats << " ms" << std::endl;
+
+      if (nbComponents != nbComponents_ref || !(labels_ref == *labels_connexities[c]) || !(labels_ref == labels)) {
+        throw vpException(vpException::fatalError, "Connected components differ from the breadth-first search");
+      }
+      if (!checkComponents(I, labels, nbComponents, components)) {
+        throw vpException(vpException::fatalError, "Wrong connected components statistics");
+      }
+    }
+
     // Save results
     vpImage<vpRGBa> labels_connex4_color(labels_connex4.getHeight(), labels_connex4.getWidth(), vpRGBa(0, 0, 0, 0));
     for (unsigned int i = 0; i < labels_connex4.getHeight(); i++) {
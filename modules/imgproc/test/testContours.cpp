@@ -36,10 +36,13 @@
  *
  *****************************************************************************/
 
+#include <algorithm>
 #include <iomanip>
+#include <map>
 
 #include <visp3/core/vpImageTools.h>
 #include <visp3/core/vpIoTools.h>
+#include <visp3/core/vpUniRand.h>
 #include <visp3/imgproc/vpImgproc.h>
 #include <visp3/io/vpImageIo.h>
 #include <visp3/io/vpParseArgv.h>
@@ -55,6 +58,436 @@
 
 void usage(const char *name, const char *badparam, std::string ipath, std::string opath, std::string user);
 bool getOptions(int argc, const char **argv, std::string &ipath, std::string &opath, std::string user);
+bool compareContourSet(const vp::vpContour &contour, const vp::vpContourSet &contour_set, int first_child);
+
+namespace
+{
+// Per-pixel border following implementation used before the run-length
+// encoded extraction, kept as a reference for the contours and their hierarchy
+bool fromTo(const vpImagePoint &from, const vpImagePoint &to, vpDirection &direction)
+{
+  if (from == to) {
+    return false;
+  }
+
+  if (std::fabs(from.get_i() - to.get_i()) < std::numeric_limits<double>::epsilon()) {
+    if (from.get_j() < to.get_j()) {
+      direction.m_direction = EAST;
+    } else {
+      direction.m_direction = WEST;
+    }
+  } else if (from.get_i() < to.get_i()) {
+    if (std::fabs(from.get_j() - to.get_j()) < std::numeric_limits<double>::epsilon()) {
+      direction.m_direction = SOUTH;
+    } else if (from.get_j() < to.get_j()) {
+      direction.m_direction = SOUTH_EAST;
+    } else {
+      direction.m_direction = SOUTH_WEST;
+    }
+  } else {
+    if (std::fabs(from.get_j() - to.get_j()) < std::numeric_limits<double>::epsilon()) {
+      direction.m_direction = NORTH;
+    } else if (from.get_j() < to.get_j()) {
+      direction.m_direction = NORTH_EAST;
+    } else {
+      direction.m_direction = NORTH_WEST;
+    }
+  }
+
+  return true;
+}
+
+bool crossesEastBorder(const vpImage<int> &I, bool checked[8], const vpImagePoint &point)
+{
+  vpDirection direction;
+  if (!fromTo(point, vpImagePoint(point.get_i(), point.get_j() + 1), direction)) {
+    return false;
+  }
+
+  bool b = checked[(int)direction.m_direction];
+
+  if (point.get_i() < 0 || point.get_j() < 0) {
+    return false;
+  }
+
+  unsigned int i = (unsigned int)point.get_i();
+  unsigned int j = (unsigned int)point.get_j();
+
+  return I[i][j] != 0 && ((unsigned int)point.get_j() == I.getWidth() - 1 || b);
+}
+
+void addContourPoint(vpImage<int> &I, vp::vpContour *border, const vpImagePoint &point, bool checked[8], int nbd)
+{
+  border->m_points.push_back(vpImagePoint(point.get_i() - 1, point.get_j() - 1)); // remove 1-pixel padding
+
+  unsigned int i = (unsigned int)point.get_i();
+  unsigned int j = (unsigned int)point.get_j();
+
+  if (crossesEastBorder(I, checked, point)) {
+    I[i][j] = -nbd;
+  } else if (I[i][j] == 1) {
+    // Only set if the pixel has not been visited before (3.4) (b)
+    I[i][j] = nbd;
+  } // Otherwise leave it alone
+}
+
+void followBorder(vpImage<int> &I, const vpImagePoint &ij, vpImagePoint &i2j2, vp::vpContour *border, int nbd)
+{
+  vpDirection dir;
+  if (!fromTo(ij, i2j2, dir)) {
+    throw vpException(vpException::fatalError, "ij == i2j2");
+  }
+
+  vpDirection trace = dir.clockwise();
+  vpImagePoint i1j1(-1, -1);
+
+  // Find i1j1 (3.1)
+  while (trace.m_direction != dir.m_direction) {
+    vpImagePoint activePixel = trace.active(I, ij);
+
+    if (activePixel.get_i() >= 0 && activePixel.get_j() >= 0) {
+      i1j1 = activePixel;
+      break;
+    }
+
+    trace = trace.clockwise();
+  }
+
+  if (i1j1.get_i() < 0 || i1j1.get_j() < 0) {
+    //(3.1) ; single pixel contour
+    return;
+  }
+
+  i2j2 = i1j1;
+  vpImagePoint i3j3 = ij; //(3.2)
+
+  bool checked[8] = {false, false, false, false, false, false, false, false};
+
+  while (true) {
+    if (!fromTo(i3j3, i2j2, dir)) {
+      throw vpException(vpException::fatalError, "i3j3 == i2j2");
+    }
+
+    trace = dir.counterClockwise();
+    vpImagePoint i4j4(-1, -1);
+
+    // Reset checked
+    for (int cpt = 0; cpt < 8; cpt++) {
+      checked[cpt] = false;
+    }
+
+    while (true) {
+      i4j4 = trace.active(I, i3j3); //(3.3)
+      if (i4j4.get_i() >= 0 && i4j4.get_j() >= 0) {
+        break;
+      }
+
+      checked[(int)trace.m_direction] = true;
+      trace = trace.counterClockwise();
+    }
+
+    addContourPoint(I, border, i3j3, checked, nbd);
+
+    if (i4j4 == ij && i3j3 == i1j1) {
+      //(3.5)
+      break;
+    }
+
+    //(3.5)
+    i2j2 = i3j3;
+    i3j3 = i4j4;
+  }
+}
+
+bool isOuterBorderStart(const vpImage<int> &I, unsigned int i, unsigned int j)
+{
+  return (I[i][j] == 1 && (j == 0 || I[i][j - 1] == 0));
+}
+
+bool isHoleBorderStart(const vpImage<int> &I, unsigned int i, unsigned int j)
+{
+  return (I[i][j] >= 1 && (j == I.getWidth() - 1 || I[i][j + 1] == 0));
+}
+
+void getContoursList(const vp::vpContour &root, int level, vp::vpContour &contour_list)
+{
+  if (level > 0) {
+    vp::vpContour *contour_node = new vp::vpContour;
+    contour_node->m_contourType = root.m_contourType;
+    contour_node->m_points = root.m_points;
+
+    contour_list.m_children.push_back(contour_node);
+  }
+
+  for (std::vector<vp::vpContour *>::const_iterator it = root.m_children.begin(); it != root.m_children.end(); ++it) {
+    getContoursList(**it, level + 1, contour_list);
+  }
+}
+
+void findContoursSuzuki(const vpImage<unsigned char> &I_original, vp::vpContour &contours,
+                        std::vector<std::vector<vpImagePoint> > &contourPts,
+                        const vp::vpContourRetrievalType &retrievalMode)
+{
+  if (I_original.getSize() == 0) {
+    return;
+  }
+
+  // Clear output results
+  contourPts.clear();
+
+  // Copy uchar I_original into int I + padding
+  vpImage<int> I(I_original.getHeight() + 2, I_original.getWidth() + 2);
+  for (unsigned int i = 0; i < I.getHeight(); i++) {
+    if (i == 0 || i == I.getHeight() - 1) {
+      memset(I.bitmap, 0, sizeof(int) * I.getWidth());
+    } else {
+      I[i][0] = 0;
+      for (unsigned int j = 0; j < I_original.getWidth(); j++) {
+        I[i][j + 1] = I_original[i - 1][j];
+      }
+      I[i][I.getWidth() - 1] = 0;
+    }
+  }
+
+  // Ref: http://openimaj.org/
+  // Ref: Satoshi Suzuki and others. Topological structural analysis of
+  // digitized binary images by border following.
+  int nbd = 1;  // Newest border
+  int lnbd = 1; // Last newest border
+
+  // Background contour
+  // By default the root contour is a hole contour
+  vp::vpContour *root = new vp::vpContour(vp::CONTOUR_HOLE);
+
+  std::map<int, vp::vpContour *> borderMap;
+  borderMap[lnbd] = root;
+
+  for (unsigned int i = 0; i < I.getHeight(); i++) {
+    lnbd = 1; // Reset LNBD at the beginning of each scan row
+
+    for (unsigned int j = 0; j < I.getWidth(); j++) {
+      int fji = I[i][j];
+
+      bool isOuter = isOuterBorderStart(I, i, j);
+      bool isHole = isHoleBorderStart(I, i, j);
+
+      if (isOuter || isHole) { // else (1) (c)
+        vp::vpContour *border = new vp::vpContour;
+        vp::vpContour *borderPrime = NULL;
+        vpImagePoint from(i, j);
+
+        if (isOuter) {
+          //(1) (a)
+          nbd++;
+          from.set_j(from.get_j() - 1);
+          border->m_contourType = vp::CONTOUR_OUTER;
+          borderPrime = borderMap[lnbd];
+
+          // Table 1
+          switch (borderPrime->m_contourType) {
+          case vp::CONTOUR_OUTER:
+            border->setParent(borderPrime->m_parent);
+            break;
+
+          case vp::CONTOUR_HOLE:
+            border->setParent(borderPrime);
+            break;
+
+          default:
+            break;
+          }
+        } else {
+          //(1) (b)
+          nbd++;
+
+          if (fji > 1) {
+            lnbd = fji;
+          }
+
+          borderPrime = borderMap[lnbd];
+          from.set_j(from.get_j() + 1);
+          border->m_contourType = vp::CONTOUR_HOLE;
+
+          // Table 1
+          switch (borderPrime->m_contourType) {
+          case vp::CONTOUR_OUTER:
+            border->setParent(borderPrime);
+            break;
+
+          case vp::CONTOUR_HOLE:
+            border->setParent(borderPrime->m_parent);
+            break;
+
+          default:
+            break;
+          }
+        }
+
+        vpImagePoint ij(i, j);
+        followBorder(I, ij, from, border, nbd);
+
+        //(3) (1) ; single pixel contour
+        if (border->m_points.empty()) {
+          border->m_points.push_back(vpImagePoint(ij.get_i() - 1, ij.get_j() - 1)); // remove 1-pixel padding
+          I[i][j] = -nbd;
+        }
+
+        if (retrievalMode == vp::CONTOUR_RETR_LIST || retrievalMode == vp::CONTOUR_RETR_TREE) {
+          // Add contour points
+          contourPts.push_back(border->m_points);
+        }
+
+        borderMap[nbd] = border;
+      }
+
+      //(4)
+      if (fji != 0 && fji != 1) {
+        lnbd = std::abs(fji);
+      }
+    }
+  }
+
+  if (retrievalMode == vp::CONTOUR_RETR_EXTERNAL || retrievalMode == vp::CONTOUR_RETR_LIST) {
+    // Delete contours content
+    contours.m_parent = NULL;
+
+    for (std::vector<vp::vpContour *>::iterator it = contours.m_children.begin(); it != contours.m_children.end(); ++it) {
+      (*it)->m_parent = NULL;
+      if (*it != NULL) {
+        delete *it;
+        *it = NULL;
+      }
+    }
+
+    contours.m_children.clear();
+  }
+
+  if (retrievalMode == vp::CONTOUR_RETR_EXTERNAL) {
+    // Add only external contours
+    for (std::vector<vp::vpContour *>::const_iterator it = root->m_children.begin(); it != root->m_children.end(); ++it) {
+      // Save children
+      std::vector<vp::vpContour *> children_copy = (*it)->m_children;
+      // Erase children
+      (*it)->m_children.clear();
+      // Copy contour
+      contours.m_children.push_back(new vp::vpContour(**it));
+      // Restore children
+      (*it)->m_children = children_copy;
+      // Set parent to children
+      for (size_t i = 0; i < contours.m_children.size(); i++) {
+        contours.m_children[i]->m_parent = &contours;
+      }
+      contourPts.push_back((*it)->m_points);
+    }
+  } else if (retrievalMode == vp::CONTOUR_RETR_LIST) {
+    getContoursList(*root, 0, contours);
+
+    // Set parent to root
+    for (std::vector<vp::vpContour *>::iterator it = contours.m_children.begin(); it != contours.m_children.end(); ++it) {
+      (*it)->m_parent = &contours;
+    }
+  } else {
+    // CONTOUR_RETR_TREE
+    contours = *root;
+  }
+
+  delete root;
+  root = NULL;
+}
+
+bool sameContours(const vp::vpContour &contour1, const vp::vpContour &contour2)
+{
+  if (contour1.m_contourType != contour2.m_contourType || contour1.m_points != contour2.m_points ||
+      contour1.m_children.size() != contour2.m_children.size()) {
+    return false;
+  }
+
+  for (size_t k = 0; k < contour1.m_children.size(); k++) {
+    if (!sameContours(*contour1.m_children[k], *contour2.m_children[k])) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+// Compare the contours with the reference implementation for all the retrieval modes
+bool checkImage(const vpImage<unsigned char> &I)
+{
+  const vp::vpContourRetrievalType modes[] = {vp::CONTOUR_RETR_TREE, vp::CONTOUR_RETR_LIST,
+                                              vp::CONTOUR_RETR_EXTERNAL};
+
+  for (size_t m = 0; m < sizeof(modes) / sizeof(modes[0]); m++) {
+    vp::vpContour contours_ref, contours;
+    std::vector<std::vector<vpImagePoint> > contourPts_ref, contourPts;
+    vp::vpContourSet contour_set;
+    findContoursSuzuki(I, contours_ref, contourPts_ref, modes[m]);
+    vp::findContours(I, contours, contourPts, modes[m]);
+    vp::findContours(I, contour_set, modes[m]);
+
+    // The contour set keeps the scanning order of contourPts, and the
+    // hierarchy only with vp::CONTOUR_RETR_TREE
+    bool same_set = contour_set.size() == contourPts_ref.size();
+    for (unsigned int k = 0; same_set && k < contour_set.size(); k++) {
+      std::vector<vpImagePoint> points;
+      contour_set.getContour(k, points);
+      same_set = points == contourPts_ref[k] &&
+                 (modes[m] == vp::CONTOUR_RETR_TREE || contour_set.m_parents[k] == -1);
+    }
+    if (modes[m] == vp::CONTOUR_RETR_TREE) {
+      same_set = same_set && compareContourSet(contours_ref, contour_set, contour_set.m_firstRoot);
+    }
+
+    if (contourPts != contourPts_ref || !sameContours(contours, contours_ref) || !same_set) {
+      std::cerr << "Wrong contours on a " << I.getWidth() << "x" << I.getHeight() << " image with the retrieval mode "
+                << m << std::endl;
+      return false;
+    }
+  }
+
+  return true;
+}
+
+// Compare the contours with the reference implementation on random and
+// synthetic binary images
+bool checkRandomImages()
+{
+  vpUniRand rng;
+  const unsigned int sizes[][2] = {{1, 1}, {1, 37}, {29, 1}, {2, 2}, {17, 23}, {40, 70}, {64, 64}, {120, 160}};
+  const int densities[] = {5, 30, 50, 70, 95};
+
+  for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+    for (size_t d = 0; d < sizeof(densities) / sizeof(densities[0]); d++) {
+      vpImage<unsigned char> I(sizes[s][0], sizes[s][1]);
+      for (unsigned int i = 0; i < I.getSize(); i++) {
+        I.bitmap[i] = rng.uniform(0, 100) < densities[d] ? 1 : 0;
+      }
+
+      if (!checkImage(I)) {
+        return false;
+      }
+    }
+  }
+
+  // Full image, checkerboard, isolated pixels and nested rings
+  vpImage<unsigned char> I_full(31, 47, 1), I_checkerboard(31, 47), I_pixels(31, 47, 0), I_rings(64, 80, 0);
+  for (unsigned int i = 0; i < I_checkerboard.getHeight(); i++) {
+    for (unsigned int j = 0; j < I_checkerboard.getWidth(); j++) {
+      I_checkerboard[i][j] = (i + j) % 2;
+      I_pixels[i][j] = (i % 2 == 0 && j % 3 == 0) ? 1 : 0;
+    }
+  }
+  for (unsigned int r = 0; 2 * r < I_rings.getHeight(); r += 2) {
+    for (unsigned int i = r; i < I_rings.getHeight() - r; i++) {
+      for (unsigned int j = r; j < I_rings.getWidth() - r; j++) {
+        I_rings[i][j] = (r / 2) % 2 == 0 ? 1 : 0;
+      }
+    }
+  }
+
+  return checkImage(I_full) && checkImage(I_checkerboard) && checkImage(I_pixels) && checkImage(I_rings);
+}
+} // namespace
 
 /*
   Print the program options.
@@ -184,6 +617,68 @@ void displayContourInfo(const vp::vpContour &contour, int level)
   }
 }
 
+bool compareContourSet(const vp::vpContour &contour, const vp::vpContourSet &contour_set, int first_child)
+{
+  int index = first_child;
+  for (std::vector<vp::vpContour *>::const_iterator it = contour.m_children.begin(); it != contour.m_children.end();
+       ++it, index = contour_set.m_nextSiblings[index]) {
+    if (index < 0) {
+      return false;
+    }
+
+    std::vector<vpImagePoint> points;
+    contour_set.getContour(static_cast<unsigned int>(index), points);
+    if ((*it)->m_contourType != contour_set.m_types[index] || (*it)->m_points != points ||
+        !compareContourSet(**it, contour_set, contour_set.m_firstChildren[index])) {
+      return false;
+    }
+  }
+
+  return index == -1;
+}
+
+// Check that the simplified contours are made of contour points and are not farther than epsilon from them
+bool checkSimplification(const vp::vpContourSet &contour_set, const vp::vpContourSet &simplified, double epsilon)
+{
+  if (simplified.size() != contour_set.size() || simplified.m_parents != contour_set.m_parents) {
+    return false;
+  }
+
+  for (unsigned int k = 0; k < contour_set.size(); k++) {
+    std::vector<vpImagePoint> points, polygon;
+    contour_set.getContour(k, points);
+    simplified.getContour(k, polygon);
+    if (polygon.empty() || polygon.size() > points.size()) {
+      return false;
+    }
+
+    for (size_t m = 0; m < polygon.size(); m++) {
+      if (std::find(points.begin(), points.end(), polygon[m]) == points.end()) {
+        return false;
+      }
+    }
+
+    for (size_t m = 0; m < points.size(); m++) {
+      double min_distance = vpImagePoint::distance(points[m], polygon[0]);
+      for (size_t n = 0; n < polygon.size(); n++) {
+        const vpImagePoint &a = polygon[n], &b = polygon[(n + 1) % polygon.size()];
+        double ab2 = vpImagePoint::sqrDistance(a, b);
+        double u = ab2 > 0 ? ((points[m].get_i() - a.get_i()) * (b.get_i() - a.get_i()) +
+                              (points[m].get_j() - a.get_j()) * (b.get_j() - a.get_j())) / ab2
+                           : 0;
+        u = std::min(std::max(u, 0.), 1.);
+        vpImagePoint proj(a.get_i() + u * (b.get_i() - a.get_i()), a.get_j() + u * (b.get_j() - a.get_j()));
+        min_distance = std::min(min_distance, vpImagePoint::distance(points[m], proj));
+      }
+      if (min_distance > epsilon + 1e-9) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
 int main(int argc, const char **argv)
 {
   try {
@@ -252,6 +747,11 @@ int main(int argc, const char **argv)
       }
     }
 
+    // Compare with the per-pixel border following implementation
+    if (!checkRandomImages()) {
+      throw vpException(vpException::fatalError, "Contours differ from the reference on random images");
+    }
+
     // Test if an input path is set
     if (opt_ipath.empty() && env_ipath.empty()) {
       usage(argv[0], NULL, ipath, opt_opath, username);
@@ -361,6 +861,46 @@ int main(int argc, const char **argv)
     filename = vpIoTools::createFilePath(opath, "Klimt_contours_extracted_external.pgm");
     vpImageIo::write(I_draw_contours_external, filename);
 
+    // Test contours stored in flat arrays
+    vp::vpContourSet contour_set;
+    t = vpTime::measureTimeMs();
+    vp::findContours(I, contour_set);
+    t = vpTime::measureTimeMs() - t;
+    std::cout << "\nContour set: nb contours=" << contour_set.size() << " ; t=" << t << " ms" << std::endl;
+
+    vp::findContours(I, vp_contours, contours);
+    bool same_contours = compareContourSet(vp_contours, contour_set, contour_set.m_firstRoot);
+    std::cout << "(vp_contours == contour_set)? " << same_contours << std::endl;
+
+    vpImage<unsigned char> I_draw_contour_set(I.getHeight(), I.getWidth(), 0);
+    vp::drawContours(I_draw_contour_set, contour_set);
+    bool same_drawing = (I_draw_contours == I_draw_contour_set);
+    std::cout << "(I_draw_contours == I_draw_contour_set)? " << same_drawing << std::endl;
+
+    vp::vpContourSet contour_set_external;
+    vp::findContours(I, contour_set_external, vp::CONTOUR_RETR_EXTERNAL);
+    I_draw_contour_set = 0;
+    vp::drawContours(I_draw_contour_set, contour_set_external);
+    bool same_external = (I_draw_contours_external == I_draw_contour_set);
+    std::cout << "(I_draw_contours_external == I_draw_contour_set)? " << same_external << std::endl;
+
+    const double epsilon = 2.;
+    vp::vpContourSet contour_set_simplified;
+    vp::findContours(I, contour_set_simplified, vp::CONTOUR_RETR_TREE, epsilon);
+    bool simplified = checkSimplification(contour_set, contour_set_simplified, epsilon);
+    std::cout << "Simplified contours: nb points=" << contour_set_simplified.m_points.size() << " / "
+              << contour_set.m_points.size() << " ; valid? " << simplified << std::endl;
+
+    I_draw_contour_set = 0;
+    vp::drawContours(I_draw_contour_set, contour_set_simplified);
+    filename = vpIoTools::createFilePath(opath, "Klimt_contours_simplified.pgm");
+    vpImageIo::write(I_draw_contour_set, filename);
+
+    if (!same_contours || !same_drawing || !same_external || !simplified) {
+      std::cerr << "Contour set differs from the contour tree" << std::endl;
+      return EXIT_FAILURE;
+    }
+
     // Test fillHoles
     vpImage<unsigned char> I_holes = I_draw_contours_external;
     vpImageTools::binarise(I_holes, (unsigned char)127, (unsigned char)255, (unsigned char)0, (unsigned char)255,
@@ -37,8 +37,10 @@
  *****************************************************************************/
 
 #include <iomanip>
+#include <queue>
 
 #include <visp3/core/vpImageTools.h>
+#include <visp3/core/vpUniRand.h>
 #include <visp3/core/vpIoTools.h>
 #include <visp3/imgproc/vpImgproc.h>
 #include <visp3/io/vpImageIo.h>
@@ -175,6 +177,113 @@ void printImage(const vpImage<unsigned char> &I, const std::string &name)
   }
 }
 
+namespace
+{
+// Reference flood fill: breadth-first search on the pixels
+void floodFillReference(vpImage<unsigned char> &I, unsigned int seed_i, unsigned int seed_j, unsigned char oldValue,
+                        unsigned char newValue, const vpImageMorphology::vpConnexityType &connexity)
+{
+  if (oldValue == newValue || I[seed_i][seed_j] != oldValue) {
+    return;
+  }
+
+  std::queue<std::pair<int, int> > seeds;
+  seeds.push(std::make_pair((int)seed_i, (int)seed_j));
+  I[seed_i][seed_j] = newValue;
+  while (!seeds.empty()) {
+    std::pair<int, int> seed = seeds.front();
+    seeds.pop();
+    for (int di = -1; di <= 1; di++) {
+      for (int dj = -1; dj <= 1; dj++) {
+        if ((di == 0 && dj == 0) || (connexity == vpImageMorphology::CONNEXITY_4 && di != 0 && dj != 0)) {
+          continue;
+        }
+        int i = seed.first + di, j = seed.second + dj;
+        if (i >= 0 && j >= 0 && i < (int)I.getHeight() && j < (int)I.getWidth() && I[i][j] == oldValue) {
+          I[i][j] = newValue;
+          seeds.push(std::make_pair(i, j));
+        }
+      }
+    }
+  }
+}
+
+// Reference reconstruction: geodesic dilations iterated until stability
+void reconstructReference(const vpImage<unsigned char> &marker, const vpImage<unsigned char> &mask,
+                          vpImage<unsigned char> &h_kp1, const vpImageMorphology::vpConnexityType &connexity)
+{
+  vpImage<unsigned char> h_k = marker;
+  h_kp1 = h_k;
+
+  do {
+    vpImageMorphology::dilatation(h_kp1, connexity);
+    for (unsigned int i = 0; i < h_kp1.getSize(); i++) {
+      h_kp1.bitmap[i] = std::min(h_kp1.bitmap[i], mask.bitmap[i]);
+    }
+
+    if (h_kp1 == h_k) {
+      break;
+    }
+
+    h_k = h_kp1;
+  } while (true);
+}
+
+// Compare vp::floodFill() and vp::reconstruct() with the references on
+// random images
+bool checkRandomImages()
+{
+  vpUniRand rng;
+  const unsigned int sizes[][2] = {{1, 1}, {1, 31}, {23, 1}, {3, 3}, {17, 29}, {64, 64}, {120, 97}};
+  const vpImageMorphology::vpConnexityType connexities[] = {vpImageMorphology::CONNEXITY_4,
+                                                            vpImageMorphology::CONNEXITY_8};
+
+  for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+    for (int nbLevels = 2; nbLevels <= 3; nbLevels++) {
+      vpImage<unsigned char> I(sizes[s][0], sizes[s][1]);
+      for (unsigned int i = 0; i < I.getSize(); i++) {
+        I.bitmap[i] = (unsigned char)rng.uniform(0, nbLevels);
+      }
+      unsigned int seed_i = (unsigned int)rng.uniform(0, (int)I.getHeight());
+      unsigned int seed_j = (unsigned int)rng.uniform(0, (int)I.getWidth());
+
+      // Smooth mask and sparse marker for the reconstruction
+      vpImage<unsigned char> mask(I.getHeight(), I.getWidth()), marker(I.getHeight(), I.getWidth(), 0);
+      for (unsigned int i = 0; i < mask.getHeight(); i++) {
+        for (unsigned int j = 0; j < mask.getWidth(); j++) {
+          mask[i][j] = (unsigned char)(I[i][j] * 60 + rng.uniform(0, 20));
+          if (rng.uniform(0, 50) == 0) {
+            marker[i][j] = (unsigned char)rng.uniform(0, 256);
+          }
+        }
+      }
+
+      for (size_t c = 0; c < 2; c++) {
+        vpImage<unsigned char> I_ref = I, I_fill = I;
+        floodFillReference(I_ref, seed_i, seed_j, I[seed_i][seed_j], 5, connexities[c]);
+        vp::floodFill(I_fill, vpImagePoint(seed_i, seed_j), I[seed_i][seed_j], 5, connexities[c]);
+        if (I_fill != I_ref) {
+          std::cerr << "Wrong flood fill on a random " << I.getWidth() << "x" << I.getHeight() << " image"
+                    << std::endl;
+          return false;
+        }
+
+        vpImage<unsigned char> R_ref, R;
+        reconstructReference(marker, mask, R_ref, connexities[c]);
+        vp::reconstruct(marker, mask, R, connexities[c]);
+        if (R != R_ref) {
+          std::cerr << "Wrong reconstruction on a random " << I.getWidth() << "x" << I.getHeight() << " image"
+                    << std::endl;
+          return false;
+        }
+      }
+    }
+  }
+
+  return true;
+}
+} // namespace
+
 int main(int argc, const char **argv)
 {
   try {
@@ -243,6 +352,11 @@ int main(int argc, const char **argv)
       }
     }
 
+    // Compare with the reference implementations, no test image is needed
+    if (!checkRandomImages()) {
+      throw vpException(vpException::fatalError, "Problem with vp::floodFill() or vp::reconstruct() on random images!");
+    }
+
     // Test if an input path is set
     if (opt_ipath.empty() && env_ipath.empty()) {
       usage(argv[0], NULL, ipath, opt_opath, username);
@@ -325,6 +439,34 @@ int main(int argc, const char **argv)
     filename = vpIoTools::createFilePath(opath, "Klimt_flood_fill_8_connexity.pgm");
     vpImageIo::write(I_klimt_flood_fill_8_connexity, filename);
 
+    // Reconstruction of the image from its border, as done to fill the holes
+    vpImage<unsigned char> I_klimt_marker(I_klimt.getHeight(), I_klimt.getWidth(), 0), I_klimt_mask = I_klimt;
+    for (unsigned int i = 0; i < I_klimt.getHeight(); i++) {
+      for (unsigned int j = 0; j < I_klimt.getWidth(); j++) {
+        I_klimt_mask[i][j] = 255 - I_klimt[i][j];
+        if (i == 0 || j == 0 || i == I_klimt.getHeight() - 1 || j == I_klimt.getWidth() - 1) {
+          I_klimt_marker[i][j] = I_klimt_mask[i][j];
+        }
+      }
+    }
+    const vpImageMorphology::vpConnexityType connexities[] = {vpImageMorphology::CONNEXITY_4,
+                                                              vpImageMorphology::CONNEXITY_8};
+    for (size_t c = 0; c < 2; c++) {
+      vpImage<unsigned char> I_klimt_reconstruct, I_klimt_reconstruct_ref;
+      t = vpTime::measureTimeMs();
+      reconstructReference(I_klimt_marker, I_klimt_mask, I_klimt_reconstruct_ref, connexities[c]);
+      double t_ref = vpTime::measureTimeMs() - t;
+      t = vpTime::measureTimeMs();
+      vp::reconstruct(I_klimt_marker, I_klimt_mask, I_klimt_reconstruct, connexities[c]);
+      t = vpTime::measureTimeMs() - t;
+      std::cout << "Reconstruction on Klimt image (" << (c == 0 ? 4 : 8) << "-connexity): " << t
+                << " ms, iterated geodesic dilations: " << t_ref << " ms" << std::endl;
+
+      if (I_klimt_reconstruct != I_klimt_reconstruct_ref) {
+        throw vpException(vpException::fatalError, "Problem with vp::reconstruct() on Klimt image!");
+      }
+    }
+
 #if VISP_HAVE_OPENCV_VERSION >= 0x020408
     cv::Mat matImg_klimt_4_connexity, matImg_klimt_8_connexity;
     vpImageConvert::convert(I_klimt, matImg_klimt_4_connexity);
@@ -39,8 +39,11 @@
 #include <cstdio>
 #include <cstdlib>
 #include <visp3/core/vpImage.h>
+#include <visp3/core/vpImageConvert.h>
+#include <visp3/core/vpImageFilter.h>
 #include <visp3/core/vpIoTools.h>
 #include <visp3/core/vpMath.h>
+#include <visp3/core/vpUniRand.h>
 #include <visp3/imgproc/vpImgproc.h>
 #include <visp3/io/vpImageIo.h>
 #include <visp3/io/vpParseArgv.h>
@@ -57,6 +60,320 @@
 void usage(const char *name, const char *badparam, std::string ipath, std::string opath, std::string user);
 bool getOptions(int argc, const char **argv, std::string &ipath, std::string &opath, std::string user);
 
+namespace
+{
+// Multi-scale Retinex with vpImageFilter::gaussianBlur(), as computed before the
+// recursive Gaussian filtering, kept as a reference
+void retinexGaussianBlur(vpImage<vpRGBa> &I, int scale, int scaleDiv, int level, double dynamic, int kernelSize)
+{
+  std::vector<double> scales((size_t)scaleDiv);
+  if (scaleDiv == 1) {
+    scales[0] = scale / 2.0;
+  } else if (scaleDiv == 2) {
+    scales[0] = scale / 2.0;
+    scales[1] = scale;
+  } else {
+    double size_step = scale / (double)scaleDiv;
+    for (int i = 0; i < scaleDiv; i++) {
+      if (level == vp::RETINEX_UNIFORM) {
+        scales[(size_t)i] = 2.0 + i * size_step;
+      } else {
+        size_step = std::log(scale - 2.0) / (double)scaleDiv;
+        double step = std::pow(10.0, (i * size_step) / std::log(10.0));
+        scales[(size_t)i] = level == vp::RETINEX_LOW ? 2.0 + step : scale - step;
+      }
+    }
+  }
+
+  if (kernelSize == -1) {
+    kernelSize = (int)(std::min(I.getWidth(), I.getHeight()) / 2.0);
+    kernelSize = (kernelSize - kernelSize % 2) + 1;
+  }
+
+  unsigned int size = I.getSize();
+  std::vector<vpImage<double> > doubleRGB(3), doubleResRGB(3);
+  for (size_t channel = 0; channel < 3; channel++) {
+    doubleRGB[channel].resize(I.getHeight(), I.getWidth());
+    doubleResRGB[channel].resize(I.getHeight(), I.getWidth(), 0.0);
+    for (unsigned int cpt = 0; cpt < size; cpt++) {
+      unsigned char value = channel == 0 ? I.bitmap[cpt].R : (channel == 1 ? I.bitmap[cpt].G : I.bitmap[cpt].B);
+      doubleRGB[channel].bitmap[cpt] = value + 1.0;
+    }
+
+    for (size_t sc = 0; sc < scales.size(); sc++) {
+      vpImage<double> blurImage;
+      vpImageFilter::gaussianBlur(doubleRGB[channel], blurImage, (unsigned int)kernelSize, scales[sc]);
+      for (unsigned int cpt = 0; cpt < size; cpt++) {
+        doubleResRGB[channel].bitmap[cpt] +=
+            (std::log(doubleRGB[channel].bitmap[cpt]) - std::log(blurImage.bitmap[cpt])) / scaleDiv;
+      }
+    }
+  }
+
+  std::vector<double> dest(size * 3);
+  double sum = 0.0;
+  for (unsigned int cpt = 0; cpt < size; cpt++) {
+    double logl = std::log((double)(I.bitmap[cpt].R + I.bitmap[cpt].G + I.bitmap[cpt].B + 3.0));
+    for (size_t channel = 0; channel < 3; channel++) {
+      dest[cpt * 3 + channel] =
+          (std::log(128.0 * doubleRGB[channel].bitmap[cpt]) - logl) * doubleResRGB[channel].bitmap[cpt];
+      sum += dest[cpt * 3 + channel];
+    }
+  }
+
+  double mean = sum / dest.size(), sq_sum = 0.0;
+  for (size_t k = 0; k < dest.size(); k++) {
+    sq_sum += (dest[k] - mean) * (dest[k] - mean);
+  }
+  double stdev = std::sqrt(sq_sum / dest.size());
+  double mini = mean - dynamic * stdev, range = 2 * dynamic * stdev;
+  if (vpMath::nul(range)) {
+    range = 1.0;
+  }
+
+  for (unsigned int cpt = 0; cpt < size; cpt++) {
+    I.bitmap[cpt].R = vpMath::saturate<unsigned char>(255.0 * (dest[cpt * 3 + 0] - mini) / range);
+    I.bitmap[cpt].G = vpMath::saturate<unsigned char>(255.0 * (dest[cpt * 3 + 1] - mini) / range);
+    I.bitmap[cpt].B = vpMath::saturate<unsigned char>(255.0 * (dest[cpt * 3 + 2] - mini) / range);
+  }
+}
+
+// Compare vp::retinex() with the truncated Gaussian kernel version on a
+// synthetic image: gradients, disks and noise
+bool checkRetinex()
+{
+  vpImage<vpRGBa> I(120, 160);
+  vpUniRand rng;
+  for (unsigned int i = 0; i < I.getHeight(); i++) {
+    for (unsigned int j = 0; j < I.getWidth(); j++) {
+      double d = std::sqrt(vpMath::sqr(i - 60.0) + vpMath::sqr(j - 100.0));
+      I[i][j].R = vpMath::saturate<unsigned char>(j * 1.5 + rng.uniform(-10.0, 10.0));
+      I[i][j].G = vpMath::saturate<unsigned char>(i * 2.0 + (d < 30 ? 60 : 0) + rng.uniform(-10.0, 10.0));
+      I[i][j].B = vpMath::saturate<unsigned char>((d < 45 ? 200.0 : 40.0) + rng.uniform(-10.0, 10.0));
+    }
+  }
+
+  // scale, scaleDiv, level, kernelSize. With the default kernel size, the
+  // kernel is truncated well below 3 sigma for the large scales, which is
+  // closer to a box filter, hence the larger tolerances
+  const int params[][4] = {{16, 1, vp::RETINEX_UNIFORM, -1},
+                           {240, 3, vp::RETINEX_UNIFORM, -1},
+                           {100, 1, vp::RETINEX_UNIFORM, -1},
+                           {150, 4, vp::RETINEX_LOW, 31},
+                           {150, 4, vp::RETINEX_HIGH, 31}};
+  // Mean and max absolute differences in gray levels
+  const double tolerances[][2] = {{2.0, 32.0}, {6.0, 128.0}, {6.0, 128.0}, {6.0, 128.0}, {6.0, 128.0}};
+  for (size_t p = 0; p < sizeof(params) / sizeof(params[0]); p++) {
+    vpImage<vpRGBa> I_retinex, I_ref = I;
+    vp::retinex(I, I_retinex, params[p][0], params[p][1], params[p][2], 1.2, params[p][3]);
+    retinexGaussianBlur(I_ref, params[p][0], params[p][1], params[p][2], 1.2, params[p][3]);
+
+    double mean_error = 0.0, max_error = 0.0;
+    for (unsigned int cpt = 0; cpt < I.getSize(); cpt++) {
+      const double errors[] = {std::fabs((double)I_retinex.bitmap[cpt].R - I_ref.bitmap[cpt].R),
+                               std::fabs((double)I_retinex.bitmap[cpt].G - I_ref.bitmap[cpt].G),
+                               std::fabs((double)I_retinex.bitmap[cpt].B - I_ref.bitmap[cpt].B)};
+      for (int c = 0; c < 3; c++) {
+        mean_error += errors[c];
+        max_error = std::max(max_error, errors[c]);
+      }
+    }
+    mean_error /= 3 * I.getSize();
+    std::cout << "Retinex " << p << " error with the Gaussian blur version: mean=" << mean_error
+              << " ; max=" << max_error << std::endl;
+
+    if (mean_error > tolerances[p][0] || max_error > tolerances[p][1]) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+// Histogram of the block centered on (blockXCenter, blockYCenter) with the
+// same binning as vp::clahe()
+void claheHistogram(const vpImage<unsigned char> &I, int blockRadius, int bins, int blockXCenter, int blockYCenter,
+                    std::vector<int> &hist)
+{
+  hist.assign((size_t)(bins + 1), 0);
+  int xMin = std::max(0, blockXCenter - blockRadius), xMax = std::min((int)I.getWidth(), blockXCenter + blockRadius + 1);
+  int yMin = std::max(0, blockYCenter - blockRadius), yMax = std::min((int)I.getHeight(), blockYCenter + blockRadius + 1);
+  for (int y = yMin; y < yMax; ++y) {
+    for (int x = xMin; x < xMax; ++x) {
+      ++hist[(size_t)(int)(I[y][x] / 255.0f * bins + 0.5f)];
+    }
+  }
+}
+
+void claheClipHistogram(std::vector<int> &hist, int limit)
+{
+  int clippedEntries = 0, clippedEntriesBefore = 0;
+  int histlength = (int)hist.size();
+  do {
+    clippedEntriesBefore = clippedEntries;
+    clippedEntries = 0;
+    for (int i = 0; i < histlength; i++) {
+      int d = hist[(size_t)i] - limit;
+      if (d > 0) {
+        clippedEntries += d;
+        hist[(size_t)i] = limit;
+      }
+    }
+
+    int d = clippedEntries / histlength, m = clippedEntries % histlength;
+    for (int i = 0; i < histlength; i++) {
+      hist[(size_t)i] += d;
+    }
+    if (m != 0) {
+      int step = (histlength - 1) / m;
+      for (int i = step / 2; i < histlength; i += step) {
+        ++hist[(size_t)i];
+      }
+    }
+  } while (clippedEntries != clippedEntriesBefore);
+}
+
+// Clipped cumulative distribution normalized between the first non empty bin and the last bin
+std::vector<float> claheTransfer(std::vector<int> hist, int limit)
+{
+  claheClipHistogram(hist, limit);
+  int hMin = (int)hist.size() - 1;
+  for (int i = 0; i < hMin; ++i) {
+    if (hist[(size_t)i] != 0) {
+      hMin = i;
+    }
+  }
+
+  std::vector<float> transfer(hist.size(), 0.0f);
+  int cdf = 0, cdfMin = hist[(size_t)hMin], cdfMax = 0;
+  for (size_t i = (size_t)hMin; i < hist.size(); ++i) {
+    cdfMax += hist[i];
+  }
+  for (size_t i = (size_t)hMin; i < hist.size(); ++i) {
+    cdf += hist[i];
+    transfer[i] = (cdf - cdfMin) / (float)(cdfMax - cdfMin);
+  }
+  for (int i = 0; i < hMin; ++i) {
+    transfer[(size_t)i] = -cdfMin / (float)(cdfMax - cdfMin);
+  }
+
+  return transfer;
+}
+
+int claheRound(float value) { return (int)(value + 0.5f); }
+
+// Grid positions of the block centers along one dimension for the fast CLAHE
+std::vector<int> claheBlockCenters(int length, int blockRadius)
+{
+  int blockSize = 2 * blockRadius + 1, n = length / blockSize, remainder = length - n * blockSize;
+  std::vector<int> centers;
+  if (remainder > 1) {
+    centers.push_back(blockRadius + 1);
+  }
+  for (int i = 0; i < n; ++i) {
+    centers.push_back(i * blockSize + blockRadius + 1 + (remainder > 1 ? remainder / 2 : 0));
+  }
+  if (remainder > 0) {
+    centers.push_back(length - blockRadius - 1);
+  }
+
+  return centers;
+}
+
+// CLAHE computed pixel by pixel as before the block transfers and the parallel
+// bands, kept as a reference: the histogram of the whole block around each
+// pixel for the accurate version, the transfers of the four surrounding grid
+// blocks for the fast version
+void claheReference(const vpImage<unsigned char> &I1, vpImage<unsigned char> &I2, int blockRadius, int bins,
+                    float slope, bool fast)
+{
+  I2.resize(I1.getHeight(), I1.getWidth());
+  std::vector<int> hist;
+
+  if (!fast) {
+    for (int y = 0; y < (int)I1.getHeight(); y++) {
+      for (int x = 0; x < (int)I1.getWidth(); x++) {
+        claheHistogram(I1, blockRadius, bins, x, y, hist);
+        int n = (std::min((int)I1.getHeight(), y + blockRadius + 1) - std::max(0, y - blockRadius)) *
+                (std::min((int)I1.getWidth(), x + blockRadius + 1) - std::max(0, x - blockRadius));
+        int limit = (int)(slope * n / bins + 0.5f);
+        I2[y][x] = (unsigned char)claheRound(claheTransfer(hist, limit)[(size_t)claheRound(I1[y][x] / 255.0f * bins)] *
+                                             255.0f);
+      }
+    }
+    return;
+  }
+
+  int blockSize = 2 * blockRadius + 1;
+  int limit = (int)(slope * blockSize * blockSize / bins + 0.5);
+  std::vector<int> cs = claheBlockCenters((int)I1.getWidth(), blockRadius);
+  std::vector<int> rs = claheBlockCenters((int)I1.getHeight(), blockRadius);
+  for (int y = 0; y < (int)I1.getHeight(); y++) {
+    // Grid rows r0 and r1 around y, equal on the borders
+    int r1 = 0;
+    while (r1 < (int)rs.size() && rs[(size_t)r1] <= y) {
+      r1++;
+    }
+    int r0 = std::max(0, r1 - 1);
+    r1 = std::min((int)rs.size() - 1, r1);
+
+    for (int x = 0; x < (int)I1.getWidth(); x++) {
+      int c1 = 0;
+      while (c1 < (int)cs.size() && cs[(size_t)c1] <= x) {
+        c1++;
+      }
+      int c0 = std::max(0, c1 - 1);
+      c1 = std::min((int)cs.size() - 1, c1);
+
+      int v = claheRound(I1[y][x] / 255.0f * bins);
+      float t[2][2];
+      for (int r = 0; r < 2; r++) {
+        for (int c = 0; c < 2; c++) {
+          claheHistogram(I1, blockRadius, bins, cs[(size_t)(c == 0 ? c0 : c1)], rs[(size_t)(r == 0 ? r0 : r1)], hist);
+          t[r][c] = claheTransfer(hist, limit)[(size_t)v];
+        }
+      }
+
+      float wx = c0 == c1 ? 1.0f : (float)(cs[(size_t)c1] - x) / (cs[(size_t)c1] - cs[(size_t)c0]);
+      float wy = r0 == r1 ? 1.0f : (float)(rs[(size_t)r1] - y) / (rs[(size_t)r1] - rs[(size_t)r0]);
+      float t0 = c0 == c1 ? t[0][0] : wx * t[0][0] + (1.0f - wx) * t[0][1];
+      float t1 = c0 == c1 ? t[1][0] : wx * t[1][0] + (1.0f - wx) * t[1][1];
+      float value = r0 == r1 ? t0 : wy * t0 + (1.0f - wy) * t1;
+      I2[y][x] = (unsigned char)std::max(0, std::min(255, claheRound(value * 255.0f)));
+    }
+  }
+}
+
+// Compare vp::clahe() with the reference on synthetic images
+bool checkCLAHE()
+{
+  vpUniRand rng;
+  // height, width, blockRadius, bins, slope x 10
+  const int params[][5] = {{61, 83, 7, 256, 30}, {60, 75, 7, 64, 20}, {45, 52, 4, 256, 15}, {40, 41, 10, 128, 40}};
+  for (size_t p = 0; p < sizeof(params) / sizeof(params[0]); p++) {
+    vpImage<unsigned char> I((unsigned int)params[p][0], (unsigned int)params[p][1]);
+    for (unsigned int i = 0; i < I.getHeight(); i++) {
+      for (unsigned int j = 0; j < I.getWidth(); j++) {
+        double value = 40.0 + 2.0 * j + ((i / 10 + j / 10) % 2 == 0 ? 60.0 : 0.0) + rng.uniform(-15.0, 15.0);
+        I[i][j] = vpMath::saturate<unsigned char>(value);
+      }
+    }
+
+    for (int fast = 0; fast < 2; fast++) {
+      vpImage<unsigned char> I_clahe, I_ref;
+      vp::clahe(I, I_clahe, params[p][2], params[p][3], params[p][4] / 10.0f, fast != 0);
+      claheReference(I, I_ref, params[p][2], params[p][3], params[p][4] / 10.0f, fast != 0);
+      if (I_clahe != I_ref) {
+        std::cerr << "CLAHE " << p << (fast ? " fast" : " accurate") << " differs from the reference" << std::endl;
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+} // namespace
+
 /*
   Print the program options.
 
@@ -217,6 +534,17 @@ int main(int argc, const char **argv)
       }
     }
 
+    // Compare with the reference implementations on synthetic images
+    if (!checkRetinex()) {
+      std::cerr << "vp::retinex() differs from the Gaussian blur version!" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    if (!checkCLAHE()) {
+      std::cerr << "vp::clahe() differs from the per-pixel version!" << std::endl;
+      return EXIT_FAILURE;
+    }
+
     // Test if an input path is set
     if (opt_ipath.empty() && env_ipath.empty()) {
       usage(argv[0], NULL, ipath, opt_opath, username);
@@ -392,6 +720,25 @@ int main(int argc, const char **argv)
     filename = vpIoTools::createFilePath(opath, "image0000_stretch_contrast.pgm");
     vpImageIo::write(I_stretch_contrast, filename);
 
+    // Histogram computed once and shared between the functions
+    vpImage<unsigned char> I_equalize_histogram_shared = I, I_stretch_contrast_shared = I;
+    vpImage<unsigned char> I_threshold = I, I_threshold_shared = I;
+    t = vpTime::measureTimeMs();
+    vpHistogram hist(I);
+    vp::equalizeHistogram(I_equalize_histogram_shared, hist);
+    vp::stretchContrast(I_stretch_contrast_shared, hist);
+    unsigned char threshold_shared = vp::autoThreshold(I_threshold_shared, hist, vp::AUTO_THRESHOLD_OTSU);
+    t = vpTime::measureTimeMs() - t;
+    std::cout << "Time to do grayscale equalization, contrast stretching and thresholding with a shared histogram: "
+              << t << " ms" << std::endl;
+
+    unsigned char threshold = vp::autoThreshold(I_threshold, vp::AUTO_THRESHOLD_OTSU);
+    if (I_equalize_histogram_shared != I_equalize_histogram || I_stretch_contrast_shared != I_stretch_contrast ||
+        threshold_shared != threshold || I_threshold_shared != I_threshold) {
+      std::cerr << "The functions with a shared histogram give different results!" << std::endl;
+      return EXIT_FAILURE;
+    }
+
     // Unsharp Mask
     vpImage<unsigned char> I_unsharp_mask;
     t = vpTime::measureTimeMs();
@@ -414,6 +761,25 @@ int main(int argc, const char **argv)
     filename = vpIoTools::createFilePath(opath, "image0000_CLAHE.pgm");
     vpImageIo::write(I_clahe, filename);
 
+    // CLAHE accurate version
+    vpImage<unsigned char> I_clahe_accurate;
+    t = vpTime::measureTimeMs();
+    vp::clahe(I, I_clahe_accurate, 50, 256, 3.0f, false);
+    t = vpTime::measureTimeMs() - t;
+    std::cout << "Time to do grayscale accurate CLAHE: " << t << " ms" << std::endl;
+
+    // CLAHE of a color image with equal components is the grayscale CLAHE
+    vpImage<vpRGBa> I_gray_color, I_gray_color_clahe;
+    vpImageConvert::convert(I, I_gray_color);
+    vp::clahe(I_gray_color, I_gray_color_clahe, 50);
+    for (unsigned int i = 0; i < I.getSize(); i++) {
+      if (I_gray_color_clahe.bitmap[i].R != I_clahe.bitmap[i] || I_gray_color_clahe.bitmap[i].G != I_clahe.bitmap[i] ||
+          I_gray_color_clahe.bitmap[i].B != I_clahe.bitmap[i]) {
+        std::cerr << "Color CLAHE of a grayscale image differs from grayscale CLAHE at pixel " << i << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+
     return EXIT_SUCCESS;
   } catch (const vpException &e) {
     std::cerr << "Catch an exception: " << e.what() << std::endl;
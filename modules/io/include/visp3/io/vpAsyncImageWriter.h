@@ -0,0 +1,135 @@
+/****************************************************************************
+ *
+ * ViSP, open source Visual Servoing Platform software.
+ * Copyright (C) 2005 - 2019 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Asynchronous image writer.
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpAsyncImageWriter.h
+  \brief Asynchronous image writer.
+*/
+
+#ifndef vpAsyncImageWriter_h
+#define vpAsyncImageWriter_h
+
+#include <string>
+
+#include <visp3/core/vpImage.h>
+#include <visp3/core/vpRGBa.h>
+
+/*!
+  \class vpAsyncImageWriter
+
+  \ingroup group_io_image
+
+  \brief Write images in the background with a pool of threads.
+
+  write() copies the image in a bounded queue and returns; the images are
+  then encoded and written with vpImageIo::write() by the worker threads, so
+  that the file format is given by the extension of the file name. The image
+  buffers of the queue are recycled from one image to the next.
+
+  When the queue is full, write() either waits for a free place (BLOCK) or
+  drops the image (DROP). The statistics returned by getStatistics() allow to
+  monitor this backpressure, for instance to size the queue or the number of
+  threads when logging several camera streams.
+
+  Errors raised by the workers are reported by flush().
+
+  \code
+#include <visp3/io/vpAsyncImageWriter.h>
+
+int main()
+{
+  vpImage<vpRGBa> I(480, 640);
+  vpAsyncImageWriter writer(4, 16);
+  for (unsigned int i = 0; i < 100; i++) {
+    // Acquire I
+    char filename[FILENAME_MAX];
+    sprintf(filename, "image%04u.jpg", i);
+    writer.write(I, filename);
+  }
+  writer.flush();
+  std::cout << "Time spent waiting: " << writer.getStatistics().blockedTime << " ms" << std::endl;
+}
+  \endcode
+
+  \note Without C++11 support the images are written by write() on the
+  caller thread.
+*/
+class VISP_EXPORT vpAsyncImageWriter
+{
+public:
+  //! Behavior of write() when the queue is full
+  typedef enum {
+    BLOCK, //!< Wait until an image of the queue is written
+    DROP   //!< Drop the image
+  } vpOverflowPolicy;
+
+  //! Backpressure statistics
+  struct vpStatistics {
+    unsigned int nbQueued;     //!< Number of images accepted by write()
+    unsigned int nbWritten;    //!< Number of images written
+    unsigned int nbDropped;    //!< Number of images dropped because the queue was full
+    unsigned int nbFailed;     //!< Number of images that could not be written
+    unsigned int nbBlocked;    //!< Number of calls to write() that waited for a free place
+    double blockedTime;        //!< Total time in ms spent waiting in write()
+    unsigned int maxQueueSize; //!< Largest number of images waiting in the queue
+  };
+
+  explicit vpAsyncImageWriter(unsigned int nbThreads = 2, unsigned int queueSize = 8,
+                              vpOverflowPolicy policy = BLOCK);
+  virtual ~vpAsyncImageWriter();
+
+  void flush();
+
+  unsigned int getQueueSize() const;
+  vpStatistics getStatistics() const;
+
+  void resetStatistics();
+
+  bool write(const vpImage<unsigned char> &I, const std::string &filename);
+  bool write(const vpImage<vpRGBa> &I, const std::string &filename);
+  bool write(const vpImage<uint16_t> &I, const std::string &filename);
+  bool write(const vpImage<float> &I, const std::string &filename);
+
+private:
+  vpAsyncImageWriter(const vpAsyncImageWriter &);            // noncopyable
+  vpAsyncImageWriter &operator=(const vpAsyncImageWriter &); //
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+  class vpImpl;
+#endif
+  vpImpl *m_impl;
+};
+
+#endif
@@ -0,0 +1,109 @@
+/****************************************************************************
+ *
+ * ViSP, open source Visual Servoing Platform software.
+ * Copyright (C) 2005 - 2019 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Lossless depth image codec.
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpDepthCodec.h
+  \brief Lossless depth image codec.
+*/
+
+#ifndef vpDepthCodec_h
+#define vpDepthCodec_h
+
+#include <string>
+#include <vector>
+
+#include <visp3/core/vpImage.h>
+
+/*!
+  \class vpDepthCodec
+
+  \ingroup group_io_image
+
+  \brief Lossless compression of 16 bits and float depth images.
+
+  Each pixel is predicted from the three closest pixels of the upper row,
+  weighted by (1, 2, 1) / 4 to smooth the noise of the sensor. Since the
+  prediction does not depend on the pixels of the same row, the rows are
+  reconstructed with vectorized loops. The prediction residuals, which are
+  small on the smooth surfaces of a depth map, are coded with adaptive Rice
+  codes whose parameter is chosen for each block of 16 residuals. Blocks of
+  zeros, such as the invalid pixels of a depth sensor, cost a few bits.
+
+  Float pixels are coded through an order preserving mapping of their bits on
+  32 bits integers, so that any value, including NaN and infinities, is
+  restored exactly.
+
+  The image is cut in horizontal stripes that are coded independently, which
+  allows to encode and decode them in parallel when OpenMP is available.
+
+  Files with the \c .vpd extension are read and written by vpImageIo, so that
+  depth sequences can be recorded and replayed with vpVideoWriter and
+  vpVideoReader:
+  \code
+#include <visp3/io/vpVideoWriter.h>
+
+int main()
+{
+  vpImage<uint16_t> I_depth(480, 640);
+  vpVideoWriter writer;
+  writer.setFileName("depth%04d.vpd");
+  writer.open(I_depth);
+  for (unsigned int i = 0; i < 100; i++) {
+    // Acquire I_depth
+    writer.saveFrame(I_depth);
+  }
+  writer.close();
+}
+  \endcode
+
+  \sa vpImageIo
+*/
+class VISP_EXPORT vpDepthCodec
+{
+public:
+  static void decode(const unsigned char *data, size_t size, vpImage<uint16_t> &I);
+  static void decode(const unsigned char *data, size_t size, vpImage<float> &I);
+
+  static void encode(const vpImage<uint16_t> &I, std::vector<unsigned char> &data, unsigned int stripeHeight = 32);
+  static void encode(const vpImage<float> &I, std::vector<unsigned char> &data, unsigned int stripeHeight = 32);
+
+  static void read(vpImage<uint16_t> &I, const std::string &filename);
+  static void read(vpImage<float> &I, const std::string &filename);
+
+  static void write(const vpImage<uint16_t> &I, const std::string &filename);
+  static void write(const vpImage<float> &I, const std::string &filename);
+};
+
+#endif
@@ -60,6 +60,11 @@
   Defined a virtual video device. "Grab" the images from the disk.
   Derived from the vpFrameGrabber class.
 
+  By default the images are decoded by acquire() on the caller thread. With
+  setPrefetch() the next images of the sequence are decoded in advance by
+  background threads, so that the time spent in acquire() is mostly a buffer
+  exchange when the caller processes the images slower than they are decoded.
+
   \sa vpFrameGrabber
 
   Here an example of capture from the directory
@@ -121,6 +126,16 @@ private:
   bool m_use_generic_name;
   std::string m_generic_name;
 
+  unsigned int m_prefetch_lookahead; //!< number of images decoded in advance
+  unsigned int m_prefetch_threads;   //!< number of decoding threads
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+  class vpPrefetcher;
+#endif
+  vpPrefetcher *m_prefetcher; //!< background decoding pipeline
+
+  vpDiskGrabber(const vpDiskGrabber &);            // noncopyable
+  vpDiskGrabber &operator=(const vpDiskGrabber &); //
+
 public:
   vpDiskGrabber();
   explicit vpDiskGrabber(const std::string &genericName);
@@ -130,9 +145,11 @@ public:
 
   void acquire(vpImage<unsigned char> &I);
   void acquire(vpImage<vpRGBa> &I);
+  void acquire(vpImage<uint16_t> &I);
   void acquire(vpImage<float> &I);
   void acquire(vpImage<unsigned char> &I, long image_number);
   void acquire(vpImage<vpRGBa> &I, long image_number);
+  void acquire(vpImage<uint16_t> &I, long image_number);
   void acquire(vpImage<float> &I, long image_number);
 
   void close();
@@ -142,8 +159,17 @@ public:
   */
   long getImageNumber() { return m_image_number; };
 
+  /*!
+    Return the number of images decoded in advance, 0 if prefetching is
+    disabled.
+
+    \sa setPrefetch()
+  */
+  inline unsigned int getPrefetchLookahead() const { return m_prefetch_lookahead; }
+
   void open(vpImage<unsigned char> &I);
   void open(vpImage<vpRGBa> &I);
+  void open(vpImage<uint16_t> &I);
   void open(vpImage<float> &I);
 
   void setBaseName(const std::string &name);
@@ -152,7 +178,11 @@ public:
   void setGenericName(const std::string &genericName);
   void setImageNumber(long number);
   void setNumberOfZero(unsigned int noz);
+  void setPrefetch(unsigned int lookahead, unsigned int nbThreads = 1);
   void setStep(long step);
+
+private:
+  std::string getImageFilename(long image_number) const;
 };
 
 #endif
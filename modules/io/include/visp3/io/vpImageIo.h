@@ -60,6 +60,7 @@
   \brief Read/write images with various image format.
 
   This class has its own implementation of PGM and PPM images read/write.
+  PGM, PPM and PFM files can also be memory-mapped with vpImageMap.
 
   This class may benefit from optional 3rd parties:
   - libpng: If installed this optional 3rd party is used to read/write PNG
@@ -117,6 +118,9 @@ private:
     FORMAT_PBM,
     FORMAT_RASTER,
     FORMAT_JPEG2000,
+    // Depth image formats
+    FORMAT_PFM,
+    FORMAT_VPD,
     FORMAT_UNKNOWN
   } vpImageFormatType;
 
@@ -126,9 +130,13 @@ private:
 public:
   static void read(vpImage<unsigned char> &I, const std::string &filename);
   static void read(vpImage<vpRGBa> &I, const std::string &filename);
+  static void read(vpImage<uint16_t> &I, const std::string &filename);
+  static void read(vpImage<float> &I, const std::string &filename);
 
   static void write(const vpImage<unsigned char> &I, const std::string &filename);
   static void write(const vpImage<vpRGBa> &I, const std::string &filename);
+  static void write(const vpImage<uint16_t> &I, const std::string &filename);
+  static void write(const vpImage<float> &I, const std::string &filename);
 
   static void readPFM(vpImage<float> &I, const std::string &filename);
 
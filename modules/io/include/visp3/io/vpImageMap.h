@@ -0,0 +1,164 @@
+/****************************************************************************
+ *
+ * ViSP, open source Visual Servoing Platform software.
+ * Copyright (C) 2005 - 2019 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Memory-mapped PGM, PPM and PFM image files.
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpImageMap.h
+  \brief Memory-mapped PGM, PPM and PFM image files.
+*/
+
+#ifndef vpImageMap_h
+#define vpImageMap_h
+
+#include <string>
+#include <vector>
+
+#include <visp3/core/vpImage.h>
+#include <visp3/core/vpRGBa.h>
+
+/*!
+  \class vpImageMap
+
+  \ingroup group_io_image
+
+  \brief Memory-mapped access to PGM P5, PPM P6 and PFM P8 image files.
+
+  The file is mapped in memory when the system supports it, otherwise its
+  pixels are read in an internal buffer. The pixels of a PGM or PFM file can
+  then be accessed without any copy: map() initializes an image whose bitmap
+  aliases the mapped pages. A PPM file, or a file whose pixels are not
+  suitably aligned, is decoded in the image instead.
+
+  An image mapped from a file opened with open() can be modified; the
+  modifications are private to the process and never written back to the
+  file. An image mapped from a file created with create() writes directly in
+  the file.
+
+  \warning The bitmap of an image initialized by map() does not belong to the
+  image. The image must not be used after the vpImageMap is closed or
+  destroyed.
+
+  The next example loads a large PGM file without copying its pixels:
+  \code
+#include <visp3/io/vpImageMap.h>
+
+int main()
+{
+  vpImageMap file("image.pgm");
+  vpImage<unsigned char> I;
+  file.map(I); // I aliases the pixels of image.pgm
+  // ... use I while file is open
+}
+  \endcode
+
+  The static write() functions create a file with its final size, so that
+  its extents are allocated once, and copy the pixels directly in the mapped
+  pages. The header of such files is padded with a comment so that the pixels
+  start on a 16 bytes boundary and can be mapped back without any copy.
+
+  \sa vpImageIo
+*/
+class VISP_EXPORT vpImageMap
+{
+public:
+  typedef enum {
+    FORMAT_PGM,    //!< Portable gray map, P5
+    FORMAT_PPM,    //!< Portable pixmap, P6
+    FORMAT_PFM,    //!< Portable float map, P8
+    FORMAT_UNKNOWN //!< Detect the format from the magic number
+  } vpImageMapFormatType;
+
+  vpImageMap();
+  explicit vpImageMap(const std::string &filename, vpImageMapFormatType format = FORMAT_UNKNOWN);
+  virtual ~vpImageMap();
+
+  void close();
+  void create(const std::string &filename, unsigned int width, unsigned int height, vpImageMapFormatType format);
+
+  /*!
+    Return the format of the opened file.
+  */
+  inline vpImageMapFormatType getFormat() const { return m_format; }
+  /*!
+    Return the height of the opened image.
+  */
+  inline unsigned int getHeight() const { return m_height; }
+  /*!
+    Return the width of the opened image.
+  */
+  inline unsigned int getWidth() const { return m_width; }
+  /*!
+    Return true if the file is mapped in memory, false if its pixels were read
+    in an internal buffer.
+  */
+  inline bool isMapped() const { return m_mapped != NULL; }
+  /*!
+    Return true if a file is opened or created.
+  */
+  inline bool isOpen() const { return m_data != NULL; }
+
+  bool map(vpImage<unsigned char> &I);
+  bool map(vpImage<float> &I);
+
+  void open(const std::string &filename, vpImageMapFormatType format = FORMAT_UNKNOWN);
+
+  void read(vpImage<unsigned char> &I) const;
+  void read(vpImage<vpRGBa> &I) const;
+  void read(vpImage<float> &I) const;
+
+  static void write(const vpImage<unsigned char> &I, const std::string &filename);
+  static void write(const vpImage<vpRGBa> &I, const std::string &filename);
+  static void write(const vpImage<float> &I, const std::string &filename);
+
+private:
+  vpImageMap(const vpImageMap &);            // noncopyable
+  vpImageMap &operator=(const vpImageMap &); //
+
+  template <class Type> bool mapPixels(vpImage<Type> &I, vpImageMapFormatType format);
+  size_t getDataSize() const;
+
+  std::string m_filename;
+  vpImageMapFormatType m_format;
+  unsigned int m_width;
+  unsigned int m_height;
+  bool m_writable; //!< true for a file created with create()
+
+  void *m_mapped;      //!< mapped file, NULL when not mapped
+  size_t m_mappedSize; //!< size of the mapping
+  std::vector<double> m_buffer; //!< pixels when the file could not be mapped
+  std::string m_header;         //!< header of a created file that is not mapped
+  unsigned char *m_data;        //!< first pixel
+};
+
+#endif
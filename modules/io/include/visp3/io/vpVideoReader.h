@@ -146,6 +146,26 @@ int main()
 }
   \endcode
 
+  When a sequence of images is used to replay a dataset, the decoding of the
+  images can be moved to background threads with setPrefetch(), so that the
+  processing of an image overlaps with the decoding of the next ones.
+  \code
+  reader.setFileName("./image/image%04d.jpeg");
+  reader.setPrefetch(4, 2); // Decode the next 4 images with 2 threads
+  reader.open(I);
+  \endcode
+
+  Depth sequences recorded by vpVideoWriter in the lossless \c .vpd format,
+  or float sequences in the \c .pfm format, are read in vpImage<uint16_t> or
+  vpImage<float> images:
+  \code
+  vpImage<uint16_t> I_depth;
+  reader.setFileName("./depth/depth%04d.vpd");
+  reader.open(I_depth);
+  while (! reader.end() )
+    reader.acquire(I_depth);
+  \endcode
+
   Note that it is also possible to access to a specific frame using getFrame().
 \code
 #include <visp3/io/vpVideoReader.h>
@@ -192,6 +212,9 @@ private:
     FORMAT_PBM,
     FORMAT_RASTER,
     FORMAT_JPEG2000,
+    // Depth image formats
+    FORMAT_PFM,
+    FORMAT_VPD,
     // Video format
     FORMAT_AVI,
     FORMAT_MPEG,
@@ -225,6 +248,10 @@ private:
   //! The frame step
   long m_frameStep;
   double m_frameRate;
+  //! Number of images of a sequence decoded in advance
+  unsigned int m_prefetchLookahead;
+  //! Number of threads decoding the images of a sequence
+  unsigned int m_prefetchThreads;
 
   // private:
   //#ifndef DOXYGEN_SHOULD_SKIP_THIS
@@ -252,6 +279,8 @@ public:
 
   void acquire(vpImage<vpRGBa> &I);
   void acquire(vpImage<unsigned char> &I);
+  void acquire(vpImage<uint16_t> &I);
+  void acquire(vpImage<float> &I);
   void close() { ; }
 
   /*!
@@ -270,6 +299,8 @@ public:
   }
   bool getFrame(vpImage<vpRGBa> &I, long frame);
   bool getFrame(vpImage<unsigned char> &I, long frame);
+  bool getFrame(vpImage<uint16_t> &I, long frame);
+  bool getFrame(vpImage<float> &I, long frame);
   /*!
     Return the frame rate in Hz used to encode the video stream.
 
@@ -328,6 +359,8 @@ public:
   bool isVideoFormat() const;
   void open(vpImage<vpRGBa> &I);
   void open(vpImage<unsigned char> &I);
+  void open(vpImage<uint16_t> &I);
+  void open(vpImage<float> &I);
 
   vpVideoReader &operator>>(vpImage<unsigned char> &I);
   vpVideoReader &operator>>(vpImage<vpRGBa> &I);
@@ -378,6 +411,8 @@ public:
 */
   inline void setFrameStep(const long frame_step) { m_frameStep = frame_step; }
 
+  void setPrefetch(unsigned int lookahead, unsigned int nbThreads = 1);
+
 private:
   vpVideoFormatType getFormat(const std::string &filename) const;
   static std::string getExtension(const std::string &filename);
@@ -388,6 +423,10 @@ private:
   long extractImageIndex(const std::string &imageName, const std::string &format) const;
   bool checkImageNameFormat(const std::string &format) const;
   void getProperties();
+
+  template <class Type> void acquireDepth(vpImage<Type> &I);
+  template <class Type> bool getDepthFrame(vpImage<Type> &I, long frame_index);
+  template <class Type> void openDepth(vpImage<Type> &I);
 };
 
 #endif
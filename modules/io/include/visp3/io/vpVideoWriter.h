@@ -46,6 +46,7 @@
 
 #include <string>
 
+#include <visp3/io/vpAsyncImageWriter.h>
 #include <visp3/io/vpImageIo.h>
 
 #if VISP_HAVE_OPENCV_VERSION >= 0x020200
@@ -79,6 +80,10 @@ these image formats. OpenCV allows also to consider AVI, MPEG, MPEG4, MOV,
 OGV, WMV, FLV, MKV video formats. Installation instructions are provided here
 https://visp.inria.fr/3rd_opencv.
 
+  Depth images of vpImage<uint16_t> or vpImage<float> type are written in a
+sequence of images with the lossless \c .vpd format of vpDepthCodec, or with
+the \c .pfm format for float images. They can be replayed with vpVideoReader.
+
   The following example available in tutorial-video-recorder.cpp shows how
 this class can be used to record a video from a camera by default in an mpeg
 file. \include tutorial-video-recorder.cpp
@@ -154,6 +159,18 @@ int main()
   return 0;
 }
   \endcode
+
+  When an image sequence is written, saveFrame() can return as soon as the
+  image is copied in a queue, the images being encoded and written by a pool
+  of threads. This avoids dropping frames when logging camera streams:
+
+  \code
+  writer.setFileName("./image/image%04d.jpeg");
+  writer.setAsyncWrite(4, 16); // 4 threads, up to 16 images waiting
+  writer.open(I);
+  // ... writer.saveFrame(I);
+  writer.close(); // wait until all the images are written
+  \endcode
 */
 
 class VISP_EXPORT vpVideoWriter
@@ -170,6 +187,9 @@ private:
     FORMAT_PPM,
     FORMAT_JPEG,
     FORMAT_PNG,
+    // Depth image formats
+    FORMAT_PFM,
+    FORMAT_VPD,
     FORMAT_AVI,
     FORMAT_MPEG,
     FORMAT_MPEG4,
@@ -199,12 +219,23 @@ private:
   unsigned int width;
   unsigned int height;
 
+  //! Number of threads writing the image sequence, 0 to write in saveFrame()
+  unsigned int m_asyncThreads;
+  //! Maximum number of images waiting to be written
+  unsigned int m_asyncQueueSize;
+  vpAsyncImageWriter *m_asyncWriter;
+
+  vpVideoWriter(const vpVideoWriter &);            // noncopyable
+  vpVideoWriter &operator=(const vpVideoWriter &); //
+
 public:
   vpVideoWriter();
   virtual ~vpVideoWriter();
 
   void close();
 
+  vpAsyncImageWriter::vpStatistics getAsyncWriteStatistics() const;
+
   /*!
     Gets the current frame index.
 
@@ -214,6 +245,8 @@ public:
 
   void open(vpImage<vpRGBa> &I);
   void open(vpImage<unsigned char> &I);
+  void open(vpImage<uint16_t> &I);
+  void open(vpImage<float> &I);
   /*!
     Reset the frame counter and sets it to the first image index.
 
@@ -223,6 +256,10 @@ public:
 
   void saveFrame(vpImage<vpRGBa> &I);
   void saveFrame(vpImage<unsigned char> &I);
+  void saveFrame(vpImage<uint16_t> &I);
+  void saveFrame(vpImage<float> &I);
+
+  void setAsyncWrite(unsigned int nbThreads, unsigned int queueSize = 8);
 
 #if VISP_HAVE_OPENCV_VERSION >= 0x020100
   inline void setCodec(const int fourcc_codec) { this->fourcc = fourcc_codec; }
@@ -250,6 +287,9 @@ public:
 private:
   vpVideoFormatType getFormat(const char *filename);
   static std::string getExtension(const std::string &filename);
+
+  template <class Type> void openDepth(vpImage<Type> &I);
+  template <class Type> void saveDepthFrame(vpImage<Type> &I);
 };
 
 #endif
@@ -0,0 +1,445 @@
+/****************************************************************************
+ *
+ * ViSP, open source Visual Servoing Platform software.
+ * Copyright (C) 2005 - 2019 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Asynchronous image writer.
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpAsyncImageWriter.cpp
+  \brief Asynchronous image writer.
+*/
+
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <vector>
+
+#include <visp3/core/vpImageException.h>
+#include <visp3/core/vpTime.h>
+#include <visp3/io/vpAsyncImageWriter.h>
+#include <visp3/io/vpImageIo.h>
+
+#if (VISP_CXX_STANDARD >= VISP_CXX_STANDARD_11)
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+namespace
+{
+// Copy in a recycled image, the memory is only allocated when the size changes
+template <class Type> void copyImage(const vpImage<Type> &src, vpImage<Type> &dst)
+{
+  if (src.getHeight() != dst.getHeight() || src.getWidth() != dst.getWidth()) {
+    dst.resize(src.getHeight(), src.getWidth());
+  }
+  if (src.getSize() > 0) {
+    memcpy(static_cast<void *>(dst.bitmap), static_cast<const void *>(src.bitmap), src.getSize() * sizeof(Type));
+  }
+}
+
+void resetStatistics(vpAsyncImageWriter::vpStatistics &statistics)
+{
+  statistics.nbQueued = 0;
+  statistics.nbWritten = 0;
+  statistics.nbDropped = 0;
+  statistics.nbFailed = 0;
+  statistics.nbBlocked = 0;
+  statistics.blockedTime = 0.;
+  statistics.maxQueueSize = 0;
+}
+} // namespace
+
+#if (VISP_CXX_STANDARD >= VISP_CXX_STANDARD_11)
+class vpAsyncImageWriter::vpImpl
+{
+public:
+  struct vpJob {
+    enum { GRAY, RGBA, DEPTH, FLOAT } type;
+    vpImage<unsigned char> Igray;
+    vpImage<vpRGBa> Irgba;
+    vpImage<uint16_t> Idepth;
+    vpImage<float> Ifloat;
+    std::string filename;
+  };
+
+  vpImpl(unsigned int nbThreads, unsigned int queueSize, vpOverflowPolicy policy)
+    : m_queueSize(std::max(queueSize, 1u)), m_policy(policy), m_mutex(), m_condWork(), m_condSpace(),
+      m_condIdle(), m_pending(), m_free(), m_jobs(), m_threads(), m_nbReserved(0), m_nbActive(0), m_stop(false),
+      m_statistics(), m_hasError(false), m_errorMessage()
+  {
+    ::resetStatistics(m_statistics);
+    unsigned int nb = std::max(nbThreads, 1u);
+    // Images being written by the workers are not in the queue
+    m_jobs.resize(m_queueSize + nb);
+    for (size_t i = 0; i < m_jobs.size(); i++) {
+      m_jobs[i] = new vpJob;
+      m_free.push_back(m_jobs[i]);
+    }
+    for (unsigned int i = 0; i < nb; i++) {
+      m_threads.push_back(std::thread(&vpImpl::run, this));
+    }
+  }
+
+  ~vpImpl()
+  {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_stop = true;
+    }
+    m_condWork.notify_all();
+    for (size_t i = 0; i < m_threads.size(); i++) {
+      m_threads[i].join();
+    }
+    for (size_t i = 0; i < m_jobs.size(); i++) {
+      delete m_jobs[i];
+    }
+  }
+
+  void flush()
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_pending.empty() || m_nbActive > 0) {
+      m_condIdle.wait(lock);
+    }
+    if (m_hasError) {
+      std::string message = m_errorMessage;
+      m_hasError = false;
+      m_errorMessage.clear();
+      throw(vpImageException(vpImageException::ioError, "%s", message.c_str()));
+    }
+  }
+
+  unsigned int getQueueSize()
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return static_cast<unsigned int>(m_pending.size());
+  }
+
+  vpStatistics getStatistics()
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_statistics;
+  }
+
+  void resetStatistics()
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ::resetStatistics(m_statistics);
+  }
+
+  template <class Type> bool write(const vpImage<Type> &I, const std::string &filename)
+  {
+    vpJob *job = NULL;
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      if (m_pending.size() + m_nbReserved >= m_queueSize) {
+        if (m_policy == DROP) {
+          m_statistics.nbDropped++;
+          return false;
+        }
+        double t = vpTime::measureTimeMs();
+        while (m_pending.size() + m_nbReserved >= m_queueSize) {
+          m_condSpace.wait(lock);
+        }
+        m_statistics.nbBlocked++;
+        m_statistics.blockedTime += vpTime::measureTimeMs() - t;
+      }
+      // A free job always exists when the queue is not full
+      job = m_free.back();
+      m_free.pop_back();
+      m_nbReserved++;
+    }
+
+    // Copy outside the lock, the job is owned by the caller
+    setImage(*job, I);
+    job->filename = filename;
+
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_pending.push_back(job);
+      m_nbReserved--;
+      m_statistics.nbQueued++;
+      m_statistics.maxQueueSize =
+          std::max(m_statistics.maxQueueSize, static_cast<unsigned int>(m_pending.size()));
+    }
+    m_condWork.notify_one();
+    return true;
+  }
+
+private:
+  void setImage(vpJob &job, const vpImage<unsigned char> &I)
+  {
+    job.type = vpJob::GRAY;
+    copyImage(I, job.Igray);
+  }
+
+  void setImage(vpJob &job, const vpImage<vpRGBa> &I)
+  {
+    job.type = vpJob::RGBA;
+    copyImage(I, job.Irgba);
+  }
+
+  void setImage(vpJob &job, const vpImage<uint16_t> &I)
+  {
+    job.type = vpJob::DEPTH;
+    copyImage(I, job.Idepth);
+  }
+
+  void setImage(vpJob &job, const vpImage<float> &I)
+  {
+    job.type = vpJob::FLOAT;
+    copyImage(I, job.Ifloat);
+  }
+
+  void run()
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;) {
+      while (m_pending.empty() && !m_stop) {
+        m_condWork.wait(lock);
+      }
+      if (m_pending.empty()) {
+        return;
+      }
+
+      vpJob *job = m_pending.front();
+      m_pending.pop_front();
+      m_nbActive++;
+      lock.unlock();
+      m_condSpace.notify_one();
+
+      bool failed = false;
+      std::string message;
+      try {
+        switch (job->type) {
+        case vpJob::GRAY:
+          vpImageIo::write(job->Igray, job->filename);
+          break;
+        case vpJob::RGBA:
+          vpImageIo::write(job->Irgba, job->filename);
+          break;
+        case vpJob::DEPTH:
+          vpImageIo::write(job->Idepth, job->filename);
+          break;
+        case vpJob::FLOAT:
+          vpImageIo::write(job->Ifloat, job->filename);
+          break;
+        }
+      } catch (const vpException &e) {
+        failed = true;
+        message = e.getStringMessage();
+      } catch (...) {
+        failed = true;
+        message = "Cannot write image \"" + job->filename + "\"";
+      }
+
+      lock.lock();
+      m_nbActive--;
+      m_free.push_back(job);
+      if (failed) {
+        m_statistics.nbFailed++;
+        if (!m_hasError) {
+          m_hasError = true;
+          m_errorMessage = message;
+        }
+      } else {
+        m_statistics.nbWritten++;
+      }
+      if (m_pending.empty() && m_nbActive == 0) {
+        m_condIdle.notify_all();
+      }
+    }
+  }
+
+  unsigned int m_queueSize;
+  vpOverflowPolicy m_policy;
+  std::mutex m_mutex;
+  std::condition_variable m_condWork;  // an image is queued or the writer stops
+  std::condition_variable m_condSpace; // an image left the queue
+  std::condition_variable m_condIdle;  // all the images are written
+  std::deque<vpJob *> m_pending;
+  std::vector<vpJob *> m_free;
+  std::vector<vpJob *> m_jobs;
+  std::vector<std::thread> m_threads;
+  unsigned int m_nbReserved; // jobs being filled by write()
+  unsigned int m_nbActive;   // jobs being written by the workers
+  bool m_stop;
+  vpStatistics m_statistics;
+  bool m_hasError; // first error, reported by flush()
+  std::string m_errorMessage;
+};
+#else
+class vpAsyncImageWriter::vpImpl
+{
+public:
+  vpImpl(unsigned int, unsigned int, vpOverflowPolicy) : m_statistics() { ::resetStatistics(m_statistics); }
+
+  void flush() {}
+  unsigned int getQueueSize() { return 0; }
+  vpStatistics getStatistics() { return m_statistics; }
+  void resetStatistics() { ::resetStatistics(m_statistics); }
+
+  template <class Type> bool write(const vpImage<Type> &I, const std::string &filename)
+  {
+    m_statistics.nbQueued++;
+    try {
+      vpImageIo::write(I, filename);
+    } catch (...) {
+      m_statistics.nbFailed++;
+      throw;
+    }
+    m_statistics.nbWritten++;
+    return true;
+  }
+
+private:
+  vpStatistics m_statistics;
+};
+#endif
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+/*!
+  Create the writer and start its threads.
+
+  \param nbThreads : Number of threads that encode and write the images. At
+  least one thread is used.
+  \param queueSize : Maximum number of images waiting to be written. At least
+  one image can wait.
+  \param policy : Behavior of write() when the queue is full.
+*/
+vpAsyncImageWriter::vpAsyncImageWriter(unsigned int nbThreads, unsigned int queueSize, vpOverflowPolicy policy)
+  : m_impl(new vpImpl(nbThreads, queueSize, policy))
+{
+}
+
+/*!
+  Write the images still in the queue and stop the threads. Errors are not
+  reported, call flush() before to get them.
+*/
+vpAsyncImageWriter::~vpAsyncImageWriter()
+{
+  try {
+    m_impl->flush();
+  } catch (...) {
+  }
+  delete m_impl;
+}
+
+/*!
+  Wait until all the queued images are written.
+
+  \exception vpImageException::ioError : If an image could not be written
+  since the previous call, with the message of the first error.
+*/
+void vpAsyncImageWriter::flush() { m_impl->flush(); }
+
+/*!
+  Return the number of images waiting in the queue.
+*/
+unsigned int vpAsyncImageWriter::getQueueSize() const { return m_impl->getQueueSize(); }
+
+/*!
+  Return the backpressure statistics since the creation of the writer or the
+  last call to resetStatistics().
+*/
+vpAsyncImageWriter::vpStatistics vpAsyncImageWriter::getStatistics() const { return m_impl->getStatistics(); }
+
+/*!
+  Reset the statistics.
+*/
+void vpAsyncImageWriter::resetStatistics() { m_impl->resetStatistics(); }
+
+/*!
+  Queue a gray level image to be written.
+
+  \param I : Image to write. It is copied, it can be modified as soon as the
+  function returns.
+  \param filename : Name of the file; its extension gives the image format
+  as in vpImageIo::write().
+
+  \return True if the image was queued, false if it was dropped because the
+  queue is full and the policy is DROP.
+*/
+bool vpAsyncImageWriter::write(const vpImage<unsigned char> &I, const std::string &filename)
+{
+  return m_impl->write(I, filename);
+}
+
+/*!
+  Queue a color image to be written.
+
+  \param I : Image to write. It is copied, it can be modified as soon as the
+  function returns.
+  \param filename : Name of the file; its extension gives the image format
+  as in vpImageIo::write().
+
+  \return True if the image was queued, false if it was dropped because the
+  queue is full and the policy is DROP.
+*/
+bool vpAsyncImageWriter::write(const vpImage<vpRGBa> &I, const std::string &filename)
+{
+  return m_impl->write(I, filename);
+}
+
+/*!
+  Queue a 16 bits depth image to be written.
+
+  \param I : Image to write. It is copied, it can be modified as soon as the
+  function returns.
+  \param filename : Name of the file; its extension gives the image format
+  as in vpImageIo::write().
+
+  \return True if the image was queued, false if it was dropped because the
+  queue is full and the policy is DROP.
+*/
+bool vpAsyncImageWriter::write(const vpImage<uint16_t> &I, const std::string &filename)
+{
+  return m_impl->write(I, filename);
+}
+
+/*!
+  Queue a float image to be written.
+
+  \param I : Image to write. It is copied, it can be modified as soon as the
+  function returns.
+  \param filename : Name of the file; its extension gives the image format
+  as in vpImageIo::write().
+
+  \return True if the image was queued, false if it was dropped because the
+  queue is full and the policy is DROP.
+*/
+bool vpAsyncImageWriter::write(const vpImage<float> &I, const std::string &filename)
+{
+  return m_impl->write(I, filename);
+}
@@ -0,0 +1,715 @@
+/****************************************************************************
+ *
+ * ViSP, open source Visual Servoing Platform software.
+ * Copyright (C) 2005 - 2019 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Lossless depth image codec.
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpDepthCodec.cpp
+  \brief Lossless depth image codec.
+*/
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+
+#include <visp3/core/vpImageException.h>
+#include <visp3/core/vpIoTools.h>
+#include <visp3/io/vpDepthCodec.h>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+namespace
+{
+// File layout, all the fields are in the byte order of the writer:
+//   magic, version, byte order, pixel type, width, height, stripe height,
+//   number of stripes, then the size in bytes of each stripe (uint64_t),
+//   then the bit streams of the stripes.
+const char depthCodecMagic[8] = {'V', 'P', 'D', 'E', 'P', 'T', 'H', '\0'};
+const uint32_t depthCodecVersion = 1;
+const uint32_t depthCodecByteOrder = 0x01020304;
+const size_t depthCodecHeaderSize = sizeof(depthCodecMagic) + 7 * sizeof(uint32_t);
+
+const uint32_t depthCodecTypeUint16 = 0;
+const uint32_t depthCodecTypeFloat = 1;
+
+// Residuals are coded by blocks sharing the same Rice parameter
+const unsigned int blockSize = 16;
+const unsigned int blockHeaderBits = 5;
+// Rice parameter announcing a block of zeros, not followed by any residual
+const unsigned int zeroBlock = 31;
+// Unary length announcing a residual stored on all its bits
+const unsigned int escapeLength = 16;
+
+// Conversion of the pixels to the unsigned integers that are predicted
+struct vpDepthUint16 {
+  static const unsigned int bits = 16;
+  static const uint32_t type = depthCodecTypeUint16;
+  static inline uint32_t toSymbol(uint16_t v) { return v; }
+  static inline uint16_t fromSymbol(uint32_t s) { return static_cast<uint16_t>(s); }
+};
+
+struct vpDepthFloat {
+  static const unsigned int bits = 32;
+  static const uint32_t type = depthCodecTypeFloat;
+  // Order preserving mapping of the IEEE 754 bits: close depths give close
+  // integers, whatever their sign
+  static inline uint32_t toSymbol(float v)
+  {
+    uint32_t u;
+    memcpy(&u, &v, sizeof(u));
+    return (u & 0x80000000u) ? ~u : (u | 0x80000000u);
+  }
+  static inline float fromSymbol(uint32_t s)
+  {
+    uint32_t u = (s & 0x80000000u) ? (s & 0x7fffffffu) : ~s;
+    float v;
+    memcpy(&v, &u, sizeof(v));
+    return v;
+  }
+};
+
+template <class Type> struct vpDepthTraits;
+template <> struct vpDepthTraits<uint16_t> : public vpDepthUint16 {
+};
+template <> struct vpDepthTraits<float> : public vpDepthFloat {
+};
+
+inline uint32_t symbolMask(unsigned int bits) { return bits >= 32 ? 0xffffffffu : ((1u << bits) - 1u); }
+
+inline unsigned int countTrailingZeros(uint32_t v)
+{
+#if defined(__GNUC__)
+  return static_cast<unsigned int>(__builtin_ctz(v));
+#elif defined(_MSC_VER)
+  unsigned long index;
+  _BitScanForward(&index, v);
+  return static_cast<unsigned int>(index);
+#else
+  unsigned int n = 0;
+  while ((v & 1u) == 0) {
+    v >>= 1;
+    n++;
+  }
+  return n;
+#endif
+}
+
+// Averages of two integers without overflow, rounded down and up
+inline uint32_t averageDown(uint32_t a, uint32_t b) { return (a & b) + ((a ^ b) >> 1); }
+inline uint32_t averageUp(uint32_t a, uint32_t b) { return (a | b) - ((a ^ b) >> 1); }
+
+// Prediction of a pixel from the upper row only, the noise of the sensor
+// being smoothed by the weights (1, 2, 1) / 4. Unlike a predictor using the
+// left neighbor, the pixels of a row are reconstructed independently, which
+// lets the compilers vectorize the loops.
+inline uint32_t predictUp(const uint32_t *prev, unsigned int j)
+{
+  return averageUp(prev[j], averageDown(prev[j - 1], prev[j + 1]));
+}
+
+inline uint32_t zigzag(uint32_t r, uint32_t mask, unsigned int signShift)
+{
+  return ((r << 1) ^ (0u - (r >> signShift))) & mask;
+}
+
+inline uint32_t unzigzag(uint32_t z) { return (z >> 1) ^ (0u - (z & 1u)); }
+
+// Residuals of a row, mapped on unsigned integers with a zigzag. The first
+// row of a stripe is predicted from the left neighbor, the first and last
+// pixels of the other rows from the upper pixel.
+void computeResiduals(const uint32_t *cur, const uint32_t *prev, unsigned int width, unsigned int bits,
+                      uint32_t *residuals)
+{
+  const uint32_t mask = symbolMask(bits);
+  const unsigned int signShift = bits - 1;
+  if (prev == NULL) {
+    residuals[0] = zigzag(cur[0] & mask, mask, signShift);
+    for (unsigned int j = 1; j < width; j++) {
+      residuals[j] = zigzag((cur[j] - cur[j - 1]) & mask, mask, signShift);
+    }
+    return;
+  }
+
+  residuals[0] = zigzag((cur[0] - prev[0]) & mask, mask, signShift);
+  for (unsigned int j = 1; j + 1 < width; j++) {
+    residuals[j] = zigzag((cur[j] - predictUp(prev, j)) & mask, mask, signShift);
+  }
+  if (width > 1) {
+    residuals[width - 1] = zigzag((cur[width - 1] - prev[width - 1]) & mask, mask, signShift);
+  }
+}
+
+// Inverse of computeResiduals()
+void reconstructRow(const uint32_t *residuals, const uint32_t *prev, unsigned int width, unsigned int bits,
+                    uint32_t *cur)
+{
+  const uint32_t mask = symbolMask(bits);
+  if (prev == NULL) {
+    cur[0] = unzigzag(residuals[0]) & mask;
+    for (unsigned int j = 1; j < width; j++) {
+      cur[j] = (cur[j - 1] + unzigzag(residuals[j])) & mask;
+    }
+    return;
+  }
+
+  cur[0] = (prev[0] + unzigzag(residuals[0])) & mask;
+  for (unsigned int j = 1; j + 1 < width; j++) {
+    cur[j] = (predictUp(prev, j) + unzigzag(residuals[j])) & mask;
+  }
+  if (width > 1) {
+    cur[width - 1] = (prev[width - 1] + unzigzag(residuals[width - 1])) & mask;
+  }
+}
+
+// Little-endian bit stream writer
+class vpBitWriter
+{
+public:
+  explicit vpBitWriter(std::vector<unsigned char> &data) : m_data(data), m_buffer(0), m_nbBits(0) {}
+
+  // Append the nbBits <= 32 lowest bits of value
+  inline void put(uint32_t value, unsigned int nbBits)
+  {
+    m_buffer |= static_cast<uint64_t>(value) << m_nbBits;
+    m_nbBits += nbBits;
+    if (m_nbBits >= 32) {
+      for (unsigned int i = 0; i < 4; i++) {
+        m_data.push_back(static_cast<unsigned char>(m_buffer >> (8 * i)));
+      }
+      m_buffer >>= 32;
+      m_nbBits -= 32;
+    }
+  }
+
+  void flush()
+  {
+    while (m_nbBits > 0) {
+      m_data.push_back(static_cast<unsigned char>(m_buffer));
+      m_buffer >>= 8;
+      m_nbBits = m_nbBits > 8 ? m_nbBits - 8 : 0;
+    }
+  }
+
+private:
+  vpBitWriter &operator=(const vpBitWriter &);
+
+  std::vector<unsigned char> &m_data;
+  uint64_t m_buffer;
+  unsigned int m_nbBits;
+};
+
+// Little-endian bit stream reader. Reading past the end returns zeros;
+// isOverrun() tells if such bits were consumed.
+class vpBitReader
+{
+public:
+  vpBitReader(const unsigned char *data, size_t size)
+    : m_data(data), m_end(data + size), m_buffer(0), m_nbBits(0), m_nbPaddingBits(0)
+  {
+  }
+
+  // Ensure that at least 56 bits are buffered
+  inline void refill()
+  {
+    if (m_end - m_data >= 8) {
+      // Fast path, the bytes are assembled in a single load by the compilers
+      uint64_t v = static_cast<uint64_t>(m_data[0]) | (static_cast<uint64_t>(m_data[1]) << 8) |
+                   (static_cast<uint64_t>(m_data[2]) << 16) | (static_cast<uint64_t>(m_data[3]) << 24) |
+                   (static_cast<uint64_t>(m_data[4]) << 32) | (static_cast<uint64_t>(m_data[5]) << 40) |
+                   (static_cast<uint64_t>(m_data[6]) << 48) | (static_cast<uint64_t>(m_data[7]) << 56);
+      unsigned int nbBytes = (63 - m_nbBits) >> 3;
+      m_buffer |= (v & ((static_cast<uint64_t>(1) << (8 * nbBytes)) - 1)) << m_nbBits;
+      m_data += nbBytes;
+      m_nbBits += 8 * nbBytes;
+      return;
+    }
+    while (m_nbBits <= 56) {
+      if (m_data < m_end) {
+        m_buffer |= static_cast<uint64_t>(*m_data++) << m_nbBits;
+      } else {
+        m_nbPaddingBits += 8;
+      }
+      m_nbBits += 8;
+    }
+  }
+
+  inline uint64_t getBuffer() const { return m_buffer; }
+  inline unsigned int getNbBits() const { return m_nbBits; }
+
+  inline void skip(unsigned int nbBits)
+  {
+    m_buffer >>= nbBits;
+    m_nbBits -= nbBits;
+  }
+
+  // Read nbBits <= 32 bits
+  inline uint32_t get(unsigned int nbBits)
+  {
+    uint32_t value = static_cast<uint32_t>(m_buffer & ((static_cast<uint64_t>(1) << nbBits) - 1));
+    skip(nbBits);
+    return value;
+  }
+
+  inline bool isOverrun() const { return m_nbPaddingBits > m_nbBits; }
+
+private:
+  const unsigned char *m_data;
+  const unsigned char *m_end;
+  uint64_t m_buffer;
+  unsigned int m_nbBits;
+  unsigned int m_nbPaddingBits;
+};
+
+// Number of bits of a block of residuals coded with the Rice parameter k
+inline unsigned int riceCost(const uint32_t *z, unsigned int n, unsigned int k, unsigned int bits)
+{
+  unsigned int cost = 0;
+  for (unsigned int j = 0; j < n; j++) {
+    uint32_t q = z[j] >> k;
+    cost += q < escapeLength ? q + 1 + k : escapeLength + bits;
+  }
+  return cost;
+}
+
+void encodeResiduals(const uint32_t *residuals, unsigned int width, unsigned int bits, vpBitWriter &writer)
+{
+  for (unsigned int b = 0; b < width; b += blockSize) {
+    unsigned int n = std::min(blockSize, width - b);
+    const uint32_t *z = residuals + b;
+    uint64_t sum = 0;
+    for (unsigned int j = 0; j < n; j++) {
+      sum += z[j];
+    }
+    if (sum == 0) {
+      writer.put(zeroBlock, blockHeaderBits);
+      continue;
+    }
+
+    // Smallest k such that n.2^k >= sum, as in LOCO-I. This estimate is
+    // biased by the outliers at the borders of the invalid areas, so that the
+    // cheapest of the smaller parameters is selected.
+    const unsigned int maxK = std::min(bits - 1, zeroBlock - 1);
+    unsigned int kEstimate = 0;
+    while (kEstimate < maxK && (static_cast<uint64_t>(n) << kEstimate) < sum) {
+      kEstimate++;
+    }
+    unsigned int k = kEstimate;
+    unsigned int bestCost = riceCost(z, n, k, bits);
+    for (unsigned int kCandidate = kEstimate > 3 ? kEstimate - 3 : 0; kCandidate < kEstimate; kCandidate++) {
+      unsigned int cost = riceCost(z, n, kCandidate, bits);
+      if (cost < bestCost) {
+        bestCost = cost;
+        k = kCandidate;
+      }
+    }
+    writer.put(k, blockHeaderBits);
+    const uint32_t lowMask = symbolMask(k);
+    for (unsigned int j = 0; j < n; j++) {
+      uint32_t q = z[j] >> k;
+      if (q < escapeLength) {
+        writer.put(1u << q, q + 1);
+        if (k > 0) {
+          writer.put(z[j] & lowMask, k);
+        }
+      } else {
+        writer.put(0, escapeLength);
+        writer.put(z[j], bits);
+      }
+    }
+  }
+}
+
+bool decodeResiduals(vpBitReader &reader, unsigned int width, unsigned int bits, uint32_t *residuals)
+{
+  const uint32_t mask = symbolMask(bits);
+  const uint32_t escapeMask = (1u << escapeLength) - 1u;
+  for (unsigned int b = 0; b < width; b += blockSize) {
+    unsigned int n = std::min(blockSize, width - b);
+    uint32_t *z = residuals + b;
+    if (reader.getNbBits() < blockHeaderBits) {
+      reader.refill();
+    }
+    unsigned int k = reader.get(blockHeaderBits);
+    if (k == zeroBlock) {
+      for (unsigned int j = 0; j < n; j++) {
+        z[j] = 0;
+      }
+      continue;
+    }
+    if (k >= bits) {
+      return false;
+    }
+    const uint64_t lowMask = symbolMask(k);
+    for (unsigned int j = 0; j < n; j++) {
+      // A residual takes at most escapeLength + bits bits
+      if (reader.getNbBits() < escapeLength + bits) {
+        reader.refill();
+      }
+      uint64_t buffer = reader.getBuffer();
+      if ((buffer & escapeMask) == 0) {
+        reader.skip(escapeLength);
+        z[j] = reader.get(bits);
+      } else {
+        unsigned int q = countTrailingZeros(static_cast<uint32_t>(buffer));
+        z[j] = ((static_cast<uint32_t>(q) << k) | static_cast<uint32_t>((buffer >> (q + 1)) & lowMask)) & mask;
+        reader.skip(q + 1 + k);
+      }
+    }
+  }
+  return !reader.isOverrun();
+}
+
+template <class Type>
+void encodeStripe(const vpImage<Type> &I, unsigned int i0, unsigned int i1, std::vector<unsigned char> &data)
+{
+  typedef vpDepthTraits<Type> Traits;
+  const unsigned int width = I.getWidth();
+  std::vector<uint32_t> prev(width), cur(width), residuals(width);
+  data.reserve(static_cast<size_t>(i1 - i0) * width * sizeof(Type) / 2);
+  vpBitWriter writer(data);
+
+  for (unsigned int i = i0; i < i1; i++) {
+    const Type *row = I[i];
+    for (unsigned int j = 0; j < width; j++) {
+      cur[j] = Traits::toSymbol(row[j]);
+    }
+    computeResiduals(&cur[0], i == i0 ? NULL : &prev[0], width, Traits::bits, &residuals[0]);
+    encodeResiduals(&residuals[0], width, Traits::bits, writer);
+    cur.swap(prev);
+  }
+  writer.flush();
+}
+
+template <class Type>
+bool decodeStripe(const unsigned char *data, size_t size, unsigned int i0, unsigned int i1, vpImage<Type> &I)
+{
+  typedef vpDepthTraits<Type> Traits;
+  const unsigned int width = I.getWidth();
+  std::vector<uint32_t> prev(width), cur(width), residuals(width);
+  vpBitReader reader(data, size);
+
+  for (unsigned int i = i0; i < i1; i++) {
+    if (!decodeResiduals(reader, width, Traits::bits, &residuals[0])) {
+      return false;
+    }
+    reconstructRow(&residuals[0], i == i0 ? NULL : &prev[0], width, Traits::bits, &cur[0]);
+    Type *row = I[i];
+    for (unsigned int j = 0; j < width; j++) {
+      row[j] = Traits::fromSymbol(cur[j]);
+    }
+    cur.swap(prev);
+  }
+  return true;
+}
+
+inline void putUint32(unsigned char *&ptr, uint32_t value)
+{
+  memcpy(ptr, &value, sizeof(value));
+  ptr += sizeof(value);
+}
+
+inline uint32_t getUint32(const unsigned char *&ptr)
+{
+  uint32_t value;
+  memcpy(&value, ptr, sizeof(value));
+  ptr += sizeof(value);
+  return value;
+}
+
+template <class Type>
+void encodeImage(const vpImage<Type> &I, std::vector<unsigned char> &data, unsigned int stripeHeight)
+{
+  typedef vpDepthTraits<Type> Traits;
+  if (stripeHeight == 0) {
+    throw(vpImageException(vpImageException::incorrectInitializationError, "Stripe height must be positive"));
+  }
+  const unsigned int height = I.getHeight();
+  const unsigned int width = I.getWidth();
+  const unsigned int nbStripes = (height + stripeHeight - 1) / stripeHeight;
+
+  std::vector<std::vector<unsigned char> > stripes(nbStripes);
+  if (width > 0) {
+    int nb = static_cast<int>(nbStripes);
+#if defined _OPENMP // only to disable warning: ignoring #pragma omp parallel [-Wunknown-pragmas]
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for (int s = 0; s < nb; s++) {
+      unsigned int i0 = static_cast<unsigned int>(s) * stripeHeight;
+      encodeStripe(I, i0, std::min(i0 + stripeHeight, height), stripes[static_cast<size_t>(s)]);
+    }
+  }
+
+  size_t size = depthCodecHeaderSize + nbStripes * sizeof(uint64_t);
+  for (unsigned int s = 0; s < nbStripes; s++) {
+    size += stripes[s].size();
+  }
+  data.resize(size);
+
+  unsigned char *ptr = &data[0];
+  memcpy(ptr, depthCodecMagic, sizeof(depthCodecMagic));
+  ptr += sizeof(depthCodecMagic);
+  putUint32(ptr, depthCodecVersion);
+  putUint32(ptr, depthCodecByteOrder);
+  putUint32(ptr, Traits::type);
+  putUint32(ptr, width);
+  putUint32(ptr, height);
+  putUint32(ptr, stripeHeight);
+  putUint32(ptr, nbStripes);
+  for (unsigned int s = 0; s < nbStripes; s++) {
+    uint64_t stripeSize = stripes[s].size();
+    memcpy(ptr, &stripeSize, sizeof(stripeSize));
+    ptr += sizeof(stripeSize);
+  }
+  for (unsigned int s = 0; s < nbStripes; s++) {
+    if (!stripes[s].empty()) {
+      memcpy(ptr, &stripes[s][0], stripes[s].size());
+      ptr += stripes[s].size();
+    }
+  }
+}
+
+template <class Type> void decodeImage(const unsigned char *data, size_t size, vpImage<Type> &I)
+{
+  typedef vpDepthTraits<Type> Traits;
+  if (data == NULL || size < depthCodecHeaderSize || memcmp(data, depthCodecMagic, sizeof(depthCodecMagic)) != 0) {
+    throw(vpImageException(vpImageException::ioError, "Cannot decode depth image: bad magic number"));
+  }
+  const unsigned char *ptr = data + sizeof(depthCodecMagic);
+  uint32_t version = getUint32(ptr);
+  uint32_t byteOrder = getUint32(ptr);
+  uint32_t type = getUint32(ptr);
+  uint32_t width = getUint32(ptr);
+  uint32_t height = getUint32(ptr);
+  uint32_t stripeHeight = getUint32(ptr);
+  uint32_t nbStripes = getUint32(ptr);
+
+  if (version != depthCodecVersion) {
+    throw(vpImageException(vpImageException::ioError, "Cannot decode depth image: unsupported version %u", version));
+  }
+  if (byteOrder != depthCodecByteOrder) {
+    throw(vpImageException(vpImageException::ioError, "Cannot decode depth image: written with another byte order"));
+  }
+  if (type != Traits::type) {
+    throw(vpImageException(vpImageException::ioError, "Cannot decode depth image: it contains %s pixels",
+                           type == depthCodecTypeFloat ? "float" : "16 bits"));
+  }
+  if (stripeHeight == 0 || nbStripes != (static_cast<uint64_t>(height) + stripeHeight - 1) / stripeHeight ||
+      (size - depthCodecHeaderSize) / sizeof(uint64_t) < nbStripes) {
+    throw(vpImageException(vpImageException::ioError, "Cannot decode depth image: corrupted header"));
+  }
+  // The number of pixels must fit in a vpImage, and an image without columns
+  // has no rows
+  const uint64_t nbPixels = static_cast<uint64_t>(width) * height;
+  if (nbPixels > std::numeric_limits<unsigned int>::max() ||
+      nbPixels > std::numeric_limits<size_t>::max() / sizeof(Type) || (width == 0 && height != 0)) {
+    throw(vpImageException(vpImageException::ioError, "Cannot decode depth image: corrupted header"));
+  }
+
+  // Each row of a stripe takes at least one block header per block of
+  // pixels, which bounds the size of the image by the size of the data
+  const uint64_t rowMinBits = static_cast<uint64_t>((width + blockSize - 1) / blockSize) * blockHeaderBits;
+  std::vector<size_t> offsets(nbStripes + 1);
+  offsets[0] = depthCodecHeaderSize + static_cast<size_t>(nbStripes) * sizeof(uint64_t);
+  for (uint32_t s = 0; s < nbStripes; s++) {
+    uint64_t stripeSize;
+    memcpy(&stripeSize, ptr, sizeof(stripeSize));
+    ptr += sizeof(stripeSize);
+    if (stripeSize > size - offsets[s]) {
+      throw(vpImageException(vpImageException::ioError, "Cannot decode depth image: truncated data"));
+    }
+    const uint64_t nbRows =
+        std::min(static_cast<uint64_t>(stripeHeight), height - static_cast<uint64_t>(s) * stripeHeight);
+    if (stripeSize * 8 < nbRows * rowMinBits) {
+      throw(vpImageException(vpImageException::ioError, "Cannot decode depth image: truncated stripe %u", s));
+    }
+    offsets[s + 1] = offsets[s] + static_cast<size_t>(stripeSize);
+  }
+
+  if (I.getHeight() != height || I.getWidth() != width) {
+    I.resize(height, width);
+  }
+  if (width == 0) {
+    return;
+  }
+
+  std::vector<unsigned char> valid(nbStripes, 1);
+  int nb = static_cast<int>(nbStripes);
+#if defined _OPENMP // only to disable warning: ignoring #pragma omp parallel [-Wunknown-pragmas]
+#pragma omp parallel for schedule(dynamic)
+#endif
+  for (int s = 0; s < nb; s++) {
+    size_t idx = static_cast<size_t>(s);
+    unsigned int i0 = static_cast<unsigned int>(s) * stripeHeight;
+    unsigned int i1 = std::min(i0 + stripeHeight, static_cast<unsigned int>(height));
+    valid[idx] = decodeStripe(data + offsets[idx], offsets[idx + 1] - offsets[idx], i0, i1, I) ? 1 : 0;
+  }
+
+  for (uint32_t s = 0; s < nbStripes; s++) {
+    if (!valid[s]) {
+      throw(vpImageException(vpImageException::ioError, "Cannot decode depth image: corrupted stripe %u", s));
+    }
+  }
+}
+
+template <class Type> void readImage(vpImage<Type> &I, const std::string &filename)
+{
+  FILE *fd = fopen(filename.c_str(), "rb");
+  if (fd == NULL) {
+    throw(vpImageException(vpImageException::ioError, "Cannot read file \"%s\"", filename.c_str()));
+  }
+  std::vector<unsigned char> data;
+  bool ok = fseek(fd, 0, SEEK_END) == 0;
+  long size = ok ? ftell(fd) : -1;
+  ok = size > 0 && fseek(fd, 0, SEEK_SET) == 0;
+  if (ok) {
+    data.resize(static_cast<size_t>(size));
+    ok = fread(&data[0], 1, data.size(), fd) == data.size();
+  }
+  fclose(fd);
+  if (!ok) {
+    throw(vpImageException(vpImageException::ioError, "Cannot read file \"%s\"", filename.c_str()));
+  }
+  decodeImage(&data[0], data.size(), I);
+}
+
+template <class Type> void writeImage(const vpImage<Type> &I, const std::string &filename)
+{
+  if (filename.empty()) {
+    throw(vpImageException(vpImageException::noFileNameError, "Filename empty"));
+  }
+  std::vector<unsigned char> data;
+  encodeImage(I, data, 32);
+
+  FILE *fd = fopen(filename.c_str(), "wb");
+  if (fd == NULL) {
+    throw(vpImageException(vpImageException::ioError, "Cannot create file \"%s\"", filename.c_str()));
+  }
+  bool ok = fwrite(&data[0], 1, data.size(), fd) == data.size();
+  ok = (fclose(fd) == 0) && ok;
+  if (!ok) {
+    throw(vpImageException(vpImageException::ioError, "Cannot write file \"%s\"", filename.c_str()));
+  }
+}
+} // namespace
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+/*!
+  Decode a 16 bits depth image.
+
+  \param data : Encoded image, as produced by encode().
+  \param size : Size of \e data in bytes.
+  \param I : Decoded image, resized if needed.
+
+  \exception vpImageException::ioError : If the data is corrupted or contains
+  float pixels.
+*/
+void vpDepthCodec::decode(const unsigned char *data, size_t size, vpImage<uint16_t> &I)
+{
+  decodeImage(data, size, I);
+}
+
+/*!
+  Decode a float depth image.
+
+  \param data : Encoded image, as produced by encode().
+  \param size : Size of \e data in bytes.
+  \param I : Decoded image, resized if needed.
+
+  \exception vpImageException::ioError : If the data is corrupted or contains
+  16 bits pixels.
+*/
+void vpDepthCodec::decode(const unsigned char *data, size_t size, vpImage<float> &I) { decodeImage(data, size, I); }
+
+/*!
+  Encode a 16 bits depth image.
+
+  \param I : Image to encode.
+  \param data : Encoded image.
+  \param stripeHeight : Number of rows of the stripes that are coded
+  independently. Smaller stripes allow more parallelism but reduce the
+  compression a little.
+*/
+void vpDepthCodec::encode(const vpImage<uint16_t> &I, std::vector<unsigned char> &data, unsigned int stripeHeight)
+{
+  encodeImage(I, data, stripeHeight);
+}
+
+/*!
+  Encode a float depth image. The bits of the pixels are kept exactly.
+
+  \param I : Image to encode.
+  \param data : Encoded image.
+  \param stripeHeight : Number of rows of the stripes that are coded
+  independently. Smaller stripes allow more parallelism but reduce the
+  compression a little.
+*/
+void vpDepthCodec::encode(const vpImage<float> &I, std::vector<unsigned char> &data, unsigned int stripeHeight)
+{
+  encodeImage(I, data, stripeHeight);
+}
+
+/*!
+  Read a 16 bits depth image from a file written by write().
+
+  \param I : Image read from the file, resized if needed.
+  \param filename : Name of the file.
+*/
+void vpDepthCodec::read(vpImage<uint16_t> &I, const std::string &filename) { readImage(I, filename); }
+
+/*!
+  Read a float depth image from a file written by write().
+
+  \param I : Image read from the file, resized if needed.
+  \param filename : Name of the file.
+*/
+void vpDepthCodec::read(vpImage<float> &I, const std::string &filename) { readImage(I, filename); }
+
+/*!
+  Encode a 16 bits depth image in a file.
+
+  \param I : Image to write.
+  \param filename : Name of the file, usually with the \c .vpd extension.
+*/
+void vpDepthCodec::write(const vpImage<uint16_t> &I, const std::string &filename) { writeImage(I, filename); }
+
+/*!
+  Encode a float depth image in a file.
+
+  \param I : Image to write.
+  \param filename : Name of the file, usually with the \c .vpd extension.
+*/
+void vpDepthCodec::write(const vpImage<float> &I, const std::string &filename) { writeImage(I, filename); }
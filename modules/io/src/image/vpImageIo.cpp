@@ -44,7 +44,9 @@
 #include <visp3/core/vpImage.h>
 #include <visp3/core/vpImageConvert.h> //image  conversion
 #include <visp3/core/vpIoTools.h>
+#include <visp3/io/vpDepthCodec.h>
 #include <visp3/io/vpImageIo.h>
+#include <visp3/io/vpImageMap.h>
 
 #if defined(_WIN32)
 // Include WinSock2.h before windows.h to ensure that winsock.h is not
@@ -208,6 +210,15 @@ vpImageIo::vpImageFormatType vpImageIo::getFormat(const std::string &filename)
     return FORMAT_JPEG2000;
   else if (ext.compare(".jp2") == 0)
     return FORMAT_JPEG2000;
+  // Depth image formats
+  else if (ext.compare(".PFM") == 0)
+    return FORMAT_PFM;
+  else if (ext.compare(".pfm") == 0)
+    return FORMAT_PFM;
+  else if (ext.compare(".VPD") == 0)
+    return FORMAT_VPD;
+  else if (ext.compare(".vpd") == 0)
+    return FORMAT_VPD;
   else
     return FORMAT_UNKNOWN;
 }
@@ -280,6 +291,8 @@ void vpImageIo::read(vpImage<unsigned char> &I, const std::string &filename)
   case FORMAT_PBM:
   case FORMAT_RASTER:
   case FORMAT_JPEG2000:
+  case FORMAT_PFM:
+  case FORMAT_VPD:
   case FORMAT_UNKNOWN:
     try_opencv_reader = true;
     break;
@@ -316,6 +329,8 @@ void vpImageIo::read(vpImage<unsigned char> &I, const std::string &filename)
     case FORMAT_PBM:
     case FORMAT_RASTER:
     case FORMAT_JPEG2000:
+    case FORMAT_PFM:
+    case FORMAT_VPD:
     case FORMAT_UNKNOWN:
     default:
       std::string message = "Cannot read file \"" + std::string(final_filename) + "\": Image format not supported";
@@ -383,6 +398,8 @@ void vpImageIo::read(vpImage<vpRGBa> &I, const std::string &filename)
   case FORMAT_PBM:
   case FORMAT_RASTER:
   case FORMAT_JPEG2000:
+  case FORMAT_PFM:
+  case FORMAT_VPD:
   case FORMAT_UNKNOWN:
     try_opencv_reader = true;
     break;
@@ -419,6 +436,8 @@ void vpImageIo::read(vpImage<vpRGBa> &I, const std::string &filename)
     case FORMAT_PBM:
     case FORMAT_RASTER:
     case FORMAT_JPEG2000:
+    case FORMAT_PFM:
+    case FORMAT_VPD:
     case FORMAT_UNKNOWN:
     default:
       std::string message = "Cannot read file \"" + std::string(final_filename) + "\": Image format not supported";
@@ -473,6 +492,8 @@ void vpImageIo::write(const vpImage<unsigned char> &I, const std::string &filena
   case FORMAT_PBM:
   case FORMAT_RASTER:
   case FORMAT_JPEG2000:
+  case FORMAT_PFM:
+  case FORMAT_VPD:
   case FORMAT_UNKNOWN:
     try_opencv_writer = true;
     break;
@@ -498,6 +519,8 @@ void vpImageIo::write(const vpImage<unsigned char> &I, const std::string &filena
     case FORMAT_PBM:
     case FORMAT_RASTER:
     case FORMAT_JPEG2000:
+    case FORMAT_PFM:
+    case FORMAT_VPD:
     case FORMAT_UNKNOWN:
     default:
       vpCERROR << "Cannot write file: Image format not supported..." << std::endl;
@@ -552,6 +575,8 @@ void vpImageIo::write(const vpImage<vpRGBa> &I, const std::string &filename)
   case FORMAT_PBM:
   case FORMAT_RASTER:
   case FORMAT_JPEG2000:
+  case FORMAT_PFM:
+  case FORMAT_VPD:
   case FORMAT_UNKNOWN:
     try_opencv_writer = true;
     break;
@@ -577,6 +602,8 @@ void vpImageIo::write(const vpImage<vpRGBa> &I, const std::string &filename)
     case FORMAT_PBM:
     case FORMAT_RASTER:
     case FORMAT_JPEG2000:
+    case FORMAT_PFM:
+    case FORMAT_VPD:
     case FORMAT_UNKNOWN:
     default:
       vpCERROR << "Cannot write file: Image format not supported..." << std::endl;
@@ -586,6 +613,116 @@ void vpImageIo::write(const vpImage<vpRGBa> &I, const std::string &filename)
   }
 }
 
+/*!
+  Read the contents of a 16 bits depth image file.
+
+  If the image has been already initialized, memory allocation is done
+  only if the new image size is different, else we re-use the same
+  memory space.
+
+  The supported format is *.vpd, the lossless depth codec of vpDepthCodec.
+
+  \param I : Image to set with the \e filename content.
+  \param filename : Name of the file containing the image.
+ */
+void vpImageIo::read(vpImage<uint16_t> &I, const std::string &filename)
+{
+  bool exist = vpIoTools::checkFilename(filename);
+  if (!exist) {
+    std::string message = "Cannot read file: \"" + std::string(filename) + "\" doesn't exist";
+    throw(vpImageException(vpImageException::ioError, message));
+  }
+
+  // Allows to use ~ symbol or env variables in path
+  std::string final_filename = vpIoTools::path(filename);
+
+  if (getFormat(final_filename) == FORMAT_VPD) {
+    vpDepthCodec::read(I, final_filename);
+  } else {
+    std::string message = "Cannot read file \"" + std::string(final_filename) + "\": Image format not supported";
+    throw(vpImageException(vpImageException::ioError, message));
+  }
+}
+
+/*!
+  Read the contents of a float depth image file.
+
+  If the image has been already initialized, memory allocation is done
+  only if the new image size is different, else we re-use the same
+  memory space.
+
+  Supported formats are *.pfm and *.vpd, the lossless depth codec of
+  vpDepthCodec.
+
+  \param I : Image to set with the \e filename content.
+  \param filename : Name of the file containing the image.
+ */
+void vpImageIo::read(vpImage<float> &I, const std::string &filename)
+{
+  bool exist = vpIoTools::checkFilename(filename);
+  if (!exist) {
+    std::string message = "Cannot read file: \"" + std::string(filename) + "\" doesn't exist";
+    throw(vpImageException(vpImageException::ioError, message));
+  }
+
+  // Allows to use ~ symbol or env variables in path
+  std::string final_filename = vpIoTools::path(filename);
+
+  switch (getFormat(final_filename)) {
+  case FORMAT_PFM:
+    readPFM(I, final_filename);
+    break;
+  case FORMAT_VPD:
+    vpDepthCodec::read(I, final_filename);
+    break;
+  default:
+    std::string message = "Cannot read file \"" + std::string(final_filename) + "\": Image format not supported";
+    throw(vpImageException(vpImageException::ioError, message));
+  }
+}
+
+/*!
+  Write a 16 bits depth image in the file which name is given by \e
+  filename.
+
+  The supported format is *.vpd, the lossless depth codec of vpDepthCodec.
+
+  \param I : Image to write.
+  \param filename : Name of the file containing the image.
+ */
+void vpImageIo::write(const vpImage<uint16_t> &I, const std::string &filename)
+{
+  if (getFormat(filename) == FORMAT_VPD) {
+    vpDepthCodec::write(I, filename);
+  } else {
+    throw(vpImageException(vpImageException::ioError, "Cannot write file: Image format not supported"));
+  }
+}
+
+/*!
+  Write a float depth image in the file which name is given by \e
+  filename.
+
+  Supported formats are *.pfm and *.vpd, the lossless depth codec of
+  vpDepthCodec.
+
+  \param I : Image to write.
+  \param filename : Name of the file containing the image.
+ */
+void vpImageIo::write(const vpImage<float> &I, const std::string &filename)
+{
+  switch (getFormat(filename)) {
+  case FORMAT_PFM:
+    writePFM(I, filename);
+    break;
+  case FORMAT_VPD:
+    vpDepthCodec::write(I, filename);
+    break;
+  default:
+    throw(vpImageException(vpImageException::ioError, "Cannot write file: Image format not supported"));
+  }
+}
+
 //--------------------------------------------------------------------------
 // PFM
 //--------------------------------------------------------------------------
@@ -767,41 +904,8 @@ void vpImageIo::writePGM(const vpImage<vpRGBa> &I, const std::string &filename)
 
 void vpImageIo::readPFM(vpImage<float> &I, const std::string &filename)
 {
-  unsigned int w = 0, h = 0, maxval = 0;
-  unsigned int w_max = 100000, h_max = 100000, maxval_max = 255;
-  std::string magic("P8");
-
-  std::ifstream fd(filename.c_str(), std::ios::binary);
-
-  // Open the filename
-  if (!fd.is_open()) {
-    throw(vpImageException(vpImageException::ioError, "Cannot open file \"%s\"", filename.c_str()));
-  }
-
-  vp_decodeHeaderPNM(filename, fd, magic, w, h, maxval);
-
-  if (w > w_max || h > h_max) {
-    fd.close();
-    throw(vpException(vpException::badValue, "Bad image size in \"%s\"", filename.c_str()));
-  }
-  if (maxval > maxval_max) {
-    fd.close();
-    throw(vpImageException(vpImageException::ioError, "Bad maxval in \"%s\"", filename.c_str()));
-  }
-
-  if ((h != I.getHeight()) || (w != I.getWidth())) {
-    I.resize(h, w);
-  }
-
-  unsigned int nbyte = I.getHeight() * I.getWidth();
-  fd.read((char *)I.bitmap, sizeof(float) * nbyte);
-  if (!fd) {
-    fd.close();
-    throw(vpImageException(vpImageException::ioError, "Read only %d of %d bytes in file \"%s\"", fd.gcount(), nbyte,
-                           filename.c_str()));
-  }
-
-  fd.close();
+  vpImageMap file(filename, vpImageMap::FORMAT_PFM);
+  file.read(I);
 }
 
 /*!
@@ -821,41 +925,8 @@ void vpImageIo::readPFM(vpImage<float> &I, const std::string &filename)
 
 void vpImageIo::readPGM(vpImage<unsigned char> &I, const std::string &filename)
 {
-  unsigned int w = 0, h = 0, maxval = 0;
-  unsigned int w_max = 100000, h_max = 100000, maxval_max = 255;
-  std::string magic("P5");
-
-  std::ifstream fd(filename.c_str(), std::ios::binary);
-
-  // Open the filename
-  if (!fd.is_open()) {
-    throw(vpImageException(vpImageException::ioError, "Cannot open file \"%s\"", filename.c_str()));
-  }
-
-  vp_decodeHeaderPNM(filename, fd, magic, w, h, maxval);
-
-  if (w > w_max || h > h_max) {
-    fd.close();
-    throw(vpException(vpException::badValue, "Bad image size in \"%s\"", filename.c_str()));
-  }
-  if (maxval > maxval_max) {
-    fd.close();
-    throw(vpImageException(vpImageException::ioError, "Bad maxval in \"%s\"", filename.c_str()));
-  }
-
-  if ((h != I.getHeight()) || (w != I.getWidth())) {
-    I.resize(h, w);
-  }
-
-  unsigned int nbyte = I.getHeight() * I.getWidth();
-  fd.read((char *)I.bitmap, nbyte);
-  if (!fd) {
-    fd.close();
-    throw(vpImageException(vpImageException::ioError, "Read only %d of %d bytes in file \"%s\"", fd.gcount(), nbyte,
-                           filename.c_str()));
-  }
-
-  fd.close();
+  vpImageMap file(filename, vpImageMap::FORMAT_PGM);
+  file.read(I);
 }
 
 /*!
@@ -878,11 +949,8 @@ void vpImageIo::readPGM(vpImage<unsigned char> &I, const std::string &filename)
 
 void vpImageIo::readPGM(vpImage<vpRGBa> &I, const std::string &filename)
 {
-  vpImage<unsigned char> Itmp;
-
-  vpImageIo::readPGM(Itmp, filename);
-
-  vpImageConvert::convert(Itmp, I);
+  vpImageMap file(filename, vpImageMap::FORMAT_PGM);
+  file.read(I);
 }
 
 //--------------------------------------------------------------------------
@@ -907,11 +975,8 @@ void vpImageIo::readPGM(vpImage<vpRGBa> &I, const std::string &filename)
 */
 void vpImageIo::readPPM(vpImage<unsigned char> &I, const std::string &filename)
 {
-  vpImage<vpRGBa> Itmp;
-
-  vpImageIo::readPPM(Itmp, filename);
-
-  vpImageConvert::convert(Itmp, I);
+  vpImageMap file(filename, vpImageMap::FORMAT_PPM);
+  file.read(I);
 }
 
 /*!
@@ -927,51 +992,8 @@ void vpImageIo::readPPM(vpImage<unsigned char> &I, const std::string &filename)
 */
 void vpImageIo::readPPM(vpImage<vpRGBa> &I, const std::string &filename)
 {
-  unsigned int w = 0, h = 0, maxval = 0;
-  unsigned int w_max = 100000, h_max = 100000, maxval_max = 255;
-  std::string magic("P6");
-
-  std::ifstream fd(filename.c_str(), std::ios::binary);
-
-  // Open the filename
-  if (!fd.is_open()) {
-    throw(vpImageException(vpImageException::ioError, "Cannot open file \"%s\"", filename.c_str()));
-  }
-
-  vp_decodeHeaderPNM(filename, fd, magic, w, h, maxval);
-
-  if (w > w_max || h > h_max) {
-    fd.close();
-    throw(vpException(vpException::badValue, "Bad image size in \"%s\"", filename.c_str()));
-  }
-  if (maxval > maxval_max) {
-    fd.close();
-    throw(vpImageException(vpImageException::ioError, "Bad maxval in \"%s\"", filename.c_str()));
-  }
-
-  if ((h != I.getHeight()) || (w != I.getWidth())) {
-    I.resize(h, w);
-  }
-
-  for (unsigned int i = 0; i < I.getHeight(); i++) {
-    for (unsigned int j = 0; j < I.getWidth(); j++) {
-      unsigned char rgb[3];
-      fd.read((char *)&rgb, 3);
-
-      if (!fd) {
-        fd.close();
-        throw(vpImageException(vpImageException::ioError, "Read only %d of %d bytes in file \"%s\"",
-                               (i * I.getWidth() + j) * 3 + fd.gcount(), I.getSize() * 3, filename.c_str()));
-      }
-
-      I[i][j].R = rgb[0];
-      I[i][j].G = rgb[1];
-      I[i][j].B = rgb[2];
-      I[i][j].A = vpRGBa::alpha_default;
-    }
-  }
-
-  fd.close();
+  vpImageMap file(filename, vpImageMap::FORMAT_PPM);
+  file.read(I);
 }
 
 /*!
@@ -1085,20 +1107,14 @@ void vpImageIo::writeJPEG(const vpImage<unsigned char> &I, const std::string &fi
 
   jpeg_start_compress(&cinfo, TRUE);
 
-  unsigned char *line;
-  line = new unsigned char[width];
-  unsigned char *input = (unsigned char *)I.bitmap;
+  // Scanlines are read in place from the image
   while (cinfo.next_scanline < cinfo.image_height) {
-    for (unsigned int i = 0; i < width; i++) {
-      line[i] = *(input);
-      input++;
-    }
+    JSAMPROW line = (JSAMPROW)I[cinfo.next_scanline];
     jpeg_write_scanlines(&cinfo, &line, 1);
   }
 
   jpeg_finish_compress(&cinfo);
   jpeg_destroy_compress(&cinfo);
-  delete[] line;
   fclose(file);
 }
 
@@ -1136,31 +1152,35 @@ void vpImageIo::writeJPEG(const vpImage<vpRGBa> &I, const std::string &filename)
 
   cinfo.image_width = width;
   cinfo.image_height = height;
+#if defined(JCS_EXTENSIONS)
+  // libjpeg-turbo skips the alpha channel while reading the RGBa scanlines
+  cinfo.input_components = 4;
+  cinfo.in_color_space = JCS_EXT_RGBX;
+#else
   cinfo.input_components = 3;
   cinfo.in_color_space = JCS_RGB;
+#endif
   jpeg_set_defaults(&cinfo);
 
   jpeg_start_compress(&cinfo, TRUE);
 
+#if defined(JCS_EXTENSIONS)
+  while (cinfo.next_scanline < cinfo.image_height) {
+    JSAMPROW line = (JSAMPROW)I[cinfo.next_scanline];
+    jpeg_write_scanlines(&cinfo, &line, 1);
+  }
+#else
   unsigned char *line;
   line = new unsigned char[3 * width];
-  unsigned char *input = (unsigned char *)I.bitmap;
   while (cinfo.next_scanline < cinfo.image_height) {
-    for (unsigned int i = 0; i < width; i++) {
-      line[i * 3] = *(input);
-      input++;
-      line[i * 3 + 1] = *(input);
-      input++;
-      line[i * 3 + 2] = *(input);
-      input++;
-      input++;
-    }
+    vpImageConvert::RGBaToRGB((unsigned char *)I[cinfo.next_scanline], line, width);
     jpeg_write_scanlines(&cinfo, &line, 1);
   }
+  delete[] line;
+#endif
 
   jpeg_finish_compress(&cinfo);
   jpeg_destroy_compress(&cinfo);
-  delete[] line;
   fclose(file);
 }
 
@@ -1570,27 +1590,15 @@ void vpImageIo::writePNG(const vpImage<unsigned char> &I, const std::string &fil
 
   png_write_info(png_ptr, info_ptr);
 
+  // Rows are read in place from the image
   png_bytep *row_ptrs = new png_bytep[height];
   for (unsigned int i = 0; i < height; i++)
-    row_ptrs[i] = new png_byte[width];
-
-  unsigned char *input = (unsigned char *)I.bitmap;
-
-  for (unsigned int i = 0; i < height; i++) {
-    png_byte *row = row_ptrs[i];
-    for (unsigned int j = 0; j < width; j++) {
-      row[j] = *(input);
-      input++;
-    }
-  }
+    row_ptrs[i] = (png_bytep)I[i];
 
   png_write_image(png_ptr, row_ptrs);
 
   png_write_end(png_ptr, NULL);
 
-  for (unsigned int j = 0; j < height; j++)
-    delete[] row_ptrs[j];
-
   delete[] row_ptrs;
 
   png_destroy_write_struct(&png_ptr, &info_ptr);
@@ -1667,33 +1675,17 @@ void vpImageIo::writePNG(const vpImage<vpRGBa> &I, const std::string &filename)
 
   png_write_info(png_ptr, info_ptr);
 
+  // libpng strips the alpha channel while reading the RGBa rows in place
+  png_set_filler(png_ptr, 0, PNG_FILLER_AFTER);
+
   png_bytep *row_ptrs = new png_bytep[height];
   for (unsigned int i = 0; i < height; i++)
-    row_ptrs[i] = new png_byte[3 * width];
-
-  unsigned char *input = (unsigned char *)I.bitmap;
-  ;
-
-  for (unsigned int i = 0; i < height; i++) {
-    png_byte *row = row_ptrs[i];
-    for (unsigned int j = 0; j < width; j++) {
-      row[3 * j] = *(input);
-      input++;
-      row[3 * j + 1] = *(input);
-      input++;
-      row[3 * j + 2] = *(input);
-      input++;
-      input++;
-    }
-  }
+    row_ptrs[i] = (png_bytep)I[i];
 
   png_write_image(png_ptr, row_ptrs);
 
   png_write_end(png_ptr, NULL);
 
-  for (unsigned int j = 0; j < height; j++)
-    delete[] row_ptrs[j];
-
   delete[] row_ptrs;
 
   png_destroy_write_struct(&png_ptr, &info_ptr);
@@ -0,0 +1,593 @@
+/****************************************************************************
+ *
+ * ViSP, open source Visual Servoing Platform software.
+ * Copyright (C) 2005 - 2019 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Memory-mapped PGM, PPM and PFM image files.
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpImageMap.cpp
+  \brief Memory-mapped PGM, PPM and PFM image files.
+*/
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#include <visp3/core/vpImageConvert.h>
+#include <visp3/core/vpImageException.h>
+#include <visp3/io/vpImageMap.h>
+
+#if !defined(_WIN32) && (defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))) // UNIX
+#define VP_IMAGE_MAP_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+void vp_decodeHeaderPNM(const std::string &filename, std::ifstream &fd, const std::string &magic, unsigned int &w,
+                        unsigned int &h, unsigned int &maxval);
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+namespace
+{
+// Alignment of the pixels in the files created by vpImageMap
+const size_t imageMapAlignment = 16;
+
+std::string getMagic(vpImageMap::vpImageMapFormatType format)
+{
+  switch (format) {
+  case vpImageMap::FORMAT_PGM:
+    return "P5";
+  case vpImageMap::FORMAT_PPM:
+    return "P6";
+  case vpImageMap::FORMAT_PFM:
+    return "P8";
+  case vpImageMap::FORMAT_UNKNOWN:
+  default:
+    return "";
+  }
+}
+
+size_t getPixelSize(vpImageMap::vpImageMapFormatType format)
+{
+  switch (format) {
+  case vpImageMap::FORMAT_PPM:
+    return 3;
+  case vpImageMap::FORMAT_PFM:
+    return sizeof(float);
+  case vpImageMap::FORMAT_PGM:
+  case vpImageMap::FORMAT_UNKNOWN:
+  default:
+    return 1;
+  }
+}
+} // namespace
+#endif
+
+/*!
+  Default constructor. Use open() or create() to access a file.
+*/
+vpImageMap::vpImageMap()
+  : m_filename(), m_format(FORMAT_UNKNOWN), m_width(0), m_height(0), m_writable(false), m_mapped(NULL),
+    m_mappedSize(0), m_buffer(), m_header(), m_data(NULL)
+{
+}
+
+/*!
+  Open an image file.
+
+  \param filename : Name of the PGM P5, PPM P6 or PFM P8 file.
+  \param format : Expected format, or FORMAT_UNKNOWN to detect the format
+  from the magic number.
+
+  \sa open()
+*/
+vpImageMap::vpImageMap(const std::string &filename, vpImageMapFormatType format)
+  : m_filename(), m_format(FORMAT_UNKNOWN), m_width(0), m_height(0), m_writable(false), m_mapped(NULL),
+    m_mappedSize(0), m_buffer(), m_header(), m_data(NULL)
+{
+  open(filename, format);
+}
+
+/*!
+  Destructor that closes the file.
+*/
+vpImageMap::~vpImageMap()
+{
+  try {
+    close();
+  } catch (...) {
+  }
+}
+
+/*!
+  Close the file. The pixels of a created file that could not be mapped are
+  written at this time.
+
+  \warning Images initialized with map() must not be used anymore.
+
+  \exception vpImageException::ioError : If the pixels of a created file could
+  not be written.
+*/
+void vpImageMap::close()
+{
+  bool writeBuffer = m_writable && (m_mapped == NULL) && (m_data != NULL);
+  std::string filename = m_filename;
+  std::string header = m_header;
+  std::vector<double> buffer;
+  size_t dataSize = getDataSize();
+  if (writeBuffer) {
+    buffer.swap(m_buffer);
+  }
+
+#if defined(VP_IMAGE_MAP_MMAP)
+  if (m_mapped != NULL) {
+    munmap(m_mapped, m_mappedSize);
+  }
+#endif
+  m_filename.clear();
+  m_format = FORMAT_UNKNOWN;
+  m_width = 0;
+  m_height = 0;
+  m_writable = false;
+  m_mapped = NULL;
+  m_mappedSize = 0;
+  m_buffer.clear();
+  m_header.clear();
+  m_data = NULL;
+
+  if (writeBuffer) {
+    FILE *fd = fopen(filename.c_str(), "wb");
+    if (fd == NULL) {
+      throw(vpImageException(vpImageException::ioError, "Cannot create file \"%s\"", filename.c_str()));
+    }
+    if (fwrite(header.c_str(), 1, header.size(), fd) != header.size() ||
+        fwrite(&buffer[0], 1, dataSize, fd) != dataSize) {
+      fclose(fd);
+      throw(vpImageException(vpImageException::ioError, "Cannot write file \"%s\"", filename.c_str()));
+    }
+    fclose(fd);
+  }
+}
+
+/*!
+  Create an image file with its final size and map it in memory. The pixels
+  are then written with map(), or by the static write() functions.
+
+  The header is padded with a comment so that the pixels start on a 16 bytes
+  boundary. When memory mapping is not available the pixels are written in
+  the file by close().
+
+  \param filename : Name of the file to create.
+  \param width, height : Size of the image.
+  \param format : Format of the file.
+
+  \exception vpException::badValue : If the format is FORMAT_UNKNOWN.
+  \exception vpImageException::ioError : If the file cannot be created.
+*/
+void vpImageMap::create(const std::string &filename, unsigned int width, unsigned int height,
+                        vpImageMapFormatType format)
+{
+  close();
+
+  if (format == FORMAT_UNKNOWN) {
+    throw(vpException(vpException::badValue, "Cannot create file \"%s\": unknown format", filename.c_str()));
+  }
+  if (filename.empty()) {
+    throw(vpImageException(vpImageException::ioError, "Cannot create file: filename empty"));
+  }
+
+  std::ostringstream ss;
+  ss << width << " " << height << "\n255\n";
+  std::string size = ss.str();
+  // Pad the header with a comment line "#  ...  \n"
+  size_t headerSize = getMagic(format).size() + 1 + size.size() + 2;
+  std::string padding((imageMapAlignment - headerSize % imageMapAlignment) % imageMapAlignment, ' ');
+  std::string header = getMagic(format) + "\n#" + padding + "\n" + size;
+
+  m_format = format;
+  m_width = width;
+  m_height = height;
+  size_t dataSize = getDataSize();
+
+#if defined(VP_IMAGE_MAP_MMAP)
+  size_t fileSize = header.size() + dataSize;
+  int fd = ::open(filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0666);
+  if (fd < 0) {
+    close();
+    throw(vpImageException(vpImageException::ioError, "Cannot create file \"%s\"", filename.c_str()));
+  }
+#if defined(__linux__)
+  // Allocate the extents at once, ftruncate() only creates a sparse file.
+  // Fall back to ftruncate() on file systems that do not support it.
+  int err = posix_fallocate(fd, 0, static_cast<off_t>(fileSize));
+  if (err == EINVAL || err == EOPNOTSUPP) {
+    err = ftruncate(fd, static_cast<off_t>(fileSize)) != 0 ? errno : 0;
+  }
+#else
+  int err = ftruncate(fd, static_cast<off_t>(fileSize)) != 0 ? errno : 0;
+#endif
+  if (err != 0) {
+    ::close(fd);
+    ::unlink(filename.c_str());
+    close();
+    throw(vpImageException(vpImageException::ioError, "Cannot allocate %lu bytes for file \"%s\": %s",
+                           static_cast<unsigned long>(fileSize), filename.c_str(), strerror(err)));
+  }
+  void *mapped = mmap(NULL, fileSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (mapped != MAP_FAILED) {
+    m_mapped = mapped;
+    m_mappedSize = fileSize;
+    std::memcpy(mapped, header.c_str(), header.size());
+    m_data = static_cast<unsigned char *>(mapped) + header.size();
+  }
+#endif
+
+  if (m_data == NULL) {
+    m_header = header;
+    m_buffer.resize(dataSize / sizeof(double) + 1);
+    m_data = reinterpret_cast<unsigned char *>(&m_buffer[0]);
+  }
+  m_filename = filename;
+  m_writable = true;
+}
+
+/*!
+  Return the size in bytes of the pixels.
+*/
+size_t vpImageMap::getDataSize() const
+{
+  return static_cast<size_t>(m_width) * static_cast<size_t>(m_height) * getPixelSize(m_format);
+}
+
+/*!
+  Initialize \e I with the pixels of a PGM file. The bitmap of \e I aliases
+  the file pages, no pixel is copied.
+
+  If the file is not a PGM file, the image is decoded in \e I with read().
+
+  \param I : Image that aliases or receives the pixels.
+
+  \return True if \e I aliases the file, false if the pixels were copied.
+
+  \exception vpException::notInitialized : If no file is opened.
+  \exception vpException::badValue : If the file was created with an other
+  format.
+*/
+bool vpImageMap::map(vpImage<unsigned char> &I) { return mapPixels(I, FORMAT_PGM); }
+
+/*!
+  Initialize \e I with the pixels of a PFM file. The bitmap of \e I aliases
+  the file pages, no pixel is copied.
+
+  If the pixels are not aligned on a float boundary in the file, which does
+  not happen with files created by vpImageMap, they are copied in \e I with
+  read().
+
+  \param I : Image that aliases or receives the pixels.
+
+  \return True if \e I aliases the file, false if the pixels were copied.
+
+  \exception vpException::notInitialized : If no file is opened.
+  \exception vpException::badValue : If the file was created with an other
+  format.
+  \exception vpImageException::ioError : If the file is not a PFM file.
+*/
+bool vpImageMap::map(vpImage<float> &I) { return mapPixels(I, FORMAT_PFM); }
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+template <class Type> bool vpImageMap::mapPixels(vpImage<Type> &I, vpImageMapFormatType format)
+{
+  if (!isOpen()) {
+    throw(vpException(vpException::notInitialized, "No image file opened"));
+  }
+
+  bool aligned = (reinterpret_cast<size_t>(m_data) % sizeof(Type)) == 0;
+  if (m_format != format || !aligned) {
+    if (m_writable) {
+      throw(vpException(vpException::badValue, "Cannot map the pixels of file \"%s\" in the image",
+                        m_filename.c_str()));
+    }
+    read(I);
+    return false;
+  }
+
+  I.init(reinterpret_cast<Type *>(m_data), m_height, m_width, false);
+  return true;
+}
+#endif
+
+/*!
+  Open an image file. Its header is decoded, then the file is mapped in
+  memory, or its pixels are read in an internal buffer if the file cannot be
+  mapped.
+
+  \param filename : Name of the PGM P5, PPM P6 or PFM P8 file.
+  \param format : Expected format, or FORMAT_UNKNOWN to detect the format
+  from the magic number.
+
+  \exception vpImageException::ioError : If the file cannot be opened, if its
+  header is not valid or if the file is truncated.
+  \exception vpException::badValue : If the image size is not valid.
+*/
+void vpImageMap::open(const std::string &filename, vpImageMapFormatType format)
+{
+  close();
+
+  std::ifstream fd(filename.c_str(), std::ios::binary);
+  if (!fd.is_open()) {
+    throw(vpImageException(vpImageException::ioError, "Cannot open file \"%s\"", filename.c_str()));
+  }
+
+  if (format == FORMAT_UNKNOWN) {
+    char magic[2] = {'\0', '\0'};
+    fd.read(magic, 2);
+    if (magic[0] == 'P' && magic[1] == '5') {
+      format = FORMAT_PGM;
+    } else if (magic[0] == 'P' && magic[1] == '6') {
+      format = FORMAT_PPM;
+    } else if (magic[0] == 'P' && magic[1] == '8') {
+      format = FORMAT_PFM;
+    } else {
+      throw(vpImageException(vpImageException::ioError, "\"%s\" is not a PGM P5, PPM P6 or PFM P8 file",
+                             filename.c_str()));
+    }
+    fd.seekg(0, std::ios::beg);
+  }
+
+  unsigned int w = 0, h = 0, maxval = 0;
+  unsigned int w_max = 100000, h_max = 100000, maxval_max = 255;
+  vp_decodeHeaderPNM(filename, fd, getMagic(format), w, h, maxval);
+
+  if (w > w_max || h > h_max) {
+    throw(vpException(vpException::badValue, "Bad image size in \"%s\"", filename.c_str()));
+  }
+  if (maxval > maxval_max) {
+    throw(vpImageException(vpImageException::ioError, "Bad maxval in \"%s\"", filename.c_str()));
+  }
+
+  std::streamoff offset = fd.tellg();
+  fd.seekg(0, std::ios::end);
+  std::streamoff fileSize = fd.tellg();
+  if (offset < 0 || fileSize < offset) {
+    throw(vpImageException(vpImageException::ioError, "Cannot read header of file \"%s\"", filename.c_str()));
+  }
+
+  m_format = format;
+  m_width = w;
+  m_height = h;
+  size_t dataSize = getDataSize();
+  size_t available = static_cast<size_t>(fileSize - offset);
+  if (available < dataSize) {
+    close();
+    throw(vpImageException(vpImageException::ioError, "Read only %d of %d bytes in file \"%s\"",
+                           static_cast<int>(available), static_cast<int>(dataSize), filename.c_str()));
+  }
+
+#if defined(VP_IMAGE_MAP_MMAP)
+  int fdm = ::open(filename.c_str(), O_RDONLY);
+  if (fdm >= 0) {
+    // Private writable mapping: the mapped images can be modified without
+    // changing the file
+    void *mapped = mmap(NULL, static_cast<size_t>(fileSize), PROT_READ | PROT_WRITE, MAP_PRIVATE, fdm, 0);
+    ::close(fdm);
+    if (mapped != MAP_FAILED) {
+#if defined(MADV_SEQUENTIAL)
+      madvise(mapped, static_cast<size_t>(fileSize), MADV_SEQUENTIAL);
+#endif
+      m_mapped = mapped;
+      m_mappedSize = static_cast<size_t>(fileSize);
+      m_data = static_cast<unsigned char *>(mapped) + offset;
+    }
+  }
+#endif
+
+  if (m_data == NULL) {
+    m_buffer.resize(dataSize / sizeof(double) + 1);
+    fd.clear();
+    fd.seekg(offset, std::ios::beg);
+    fd.read(reinterpret_cast<char *>(&m_buffer[0]), static_cast<std::streamsize>(dataSize));
+    if (!fd) {
+      std::streamsize count = fd.gcount();
+      close();
+      throw(vpImageException(vpImageException::ioError, "Read only %d of %d bytes in file \"%s\"",
+                             static_cast<int>(count), static_cast<int>(dataSize), filename.c_str()));
+    }
+    m_data = reinterpret_cast<unsigned char *>(&m_buffer[0]);
+  }
+  m_filename = filename;
+}
+
+/*!
+  Copy the pixels in a gray level image. A PPM image is converted in gray
+  level.
+
+  If the image has been already initialized, memory allocation is done
+  only if the new image size is different, else we re-use the same
+  memory space.
+
+  \param I : Image to set with the file content.
+
+  \exception vpException::notInitialized : If no file is opened.
+  \exception vpImageException::ioError : If the file is a PFM file.
+*/
+void vpImageMap::read(vpImage<unsigned char> &I) const
+{
+  if (!isOpen()) {
+    throw(vpException(vpException::notInitialized, "No image file opened"));
+  }
+  if (m_format == FORMAT_PFM) {
+    throw(vpImageException(vpImageException::ioError, "Cannot read PFM file \"%s\" in a gray level image",
+                           m_filename.c_str()));
+  }
+
+  if ((m_height != I.getHeight()) || (m_width != I.getWidth())) {
+    I.resize(m_height, m_width);
+  }
+  if (I.bitmap == m_data || I.getSize() == 0) {
+    return;
+  }
+
+  if (m_format == FORMAT_PPM) {
+    vpImageConvert::RGBToGrey(m_data, I.bitmap, I.getSize());
+  } else {
+    std::memcpy(I.bitmap, m_data, getDataSize());
+  }
+}
+
+/*!
+  Copy the pixels in a color image. A PGM image is converted in color.
+
+  If the image has been already initialized, memory allocation is done
+  only if the new image size is different, else we re-use the same
+  memory space.
+
+  \param I : Image to set with the file content.
+
+  \exception vpException::notInitialized : If no file is opened.
+  \exception vpImageException::ioError : If the file is a PFM file.
+*/
+void vpImageMap::read(vpImage<vpRGBa> &I) const
+{
+  if (!isOpen()) {
+    throw(vpException(vpException::notInitialized, "No image file opened"));
+  }
+  if (m_format == FORMAT_PFM) {
+    throw(vpImageException(vpImageException::ioError, "Cannot read PFM file \"%s\" in a color image",
+                           m_filename.c_str()));
+  }
+
+  if ((m_height != I.getHeight()) || (m_width != I.getWidth())) {
+    I.resize(m_height, m_width);
+  }
+  if (I.getSize() == 0) {
+    return;
+  }
+
+  if (m_format == FORMAT_PPM) {
+    vpImageConvert::RGBToRGBa(m_data, reinterpret_cast<unsigned char *>(I.bitmap), I.getSize());
+  } else {
+    vpImageConvert::GreyToRGBa(m_data, reinterpret_cast<unsigned char *>(I.bitmap), I.getSize());
+  }
+}
+
+/*!
+  Copy the pixels of a PFM file in a float image.
+
+  If the image has been already initialized, memory allocation is done
+  only if the new image size is different, else we re-use the same
+  memory space.
+
+  \param I : Image to set with the file content.
+
+  \exception vpException::notInitialized : If no file is opened.
+  \exception vpImageException::ioError : If the file is not a PFM file.
+*/
+void vpImageMap::read(vpImage<float> &I) const
+{
+  if (!isOpen()) {
+    throw(vpException(vpException::notInitialized, "No image file opened"));
+  }
+  if (m_format != FORMAT_PFM) {
+    throw(vpImageException(vpImageException::ioError, "\"%s\" is not a PFM file", m_filename.c_str()));
+  }
+
+  if ((m_height != I.getHeight()) || (m_width != I.getWidth())) {
+    I.resize(m_height, m_width);
+  }
+  if (reinterpret_cast<unsigned char *>(I.bitmap) == m_data || I.getSize() == 0) {
+    return;
+  }
+  std::memcpy(I.bitmap, m_data, getDataSize());
+}
+
+/*!
+  Write a gray level image in a PGM P5 file created with create().
+
+  \param I : Image to save.
+  \param filename : Name of the file.
+
+  \exception vpImageException::ioError : If the file cannot be created or
+  written.
+*/
+void vpImageMap::write(const vpImage<unsigned char> &I, const std::string &filename)
+{
+  vpImageMap file;
+  file.create(filename, I.getWidth(), I.getHeight(), FORMAT_PGM);
+  if (I.getSize() > 0) {
+    std::memcpy(file.m_data, I.bitmap, file.getDataSize());
+  }
+  file.close();
+}
+
+/*!
+  Write a color image in a PPM P6 file created with create(). The pixels are
+  converted from RGBa to RGB directly in the file.
+
+  \param I : Image to save.
+  \param filename : Name of the file.
+
+  \exception vpImageException::ioError : If the file cannot be created or
+  written.
+*/
+void vpImageMap::write(const vpImage<vpRGBa> &I, const std::string &filename)
+{
+  vpImageMap file;
+  file.create(filename, I.getWidth(), I.getHeight(), FORMAT_PPM);
+  if (I.getSize() > 0) {
+    vpImageConvert::RGBaToRGB(reinterpret_cast<unsigned char *>(I.bitmap), file.m_data, I.getSize());
+  }
+  file.close();
+}
+
+/*!
+  Write a float image in a PFM P8 file created with create().
+
+  \param I : Image to save.
+  \param filename : Name of the file.
+
+  \exception vpImageException::ioError : If the file cannot be created or
+  written.
+*/
+void vpImageMap::write(const vpImage<float> &I, const std::string &filename)
+{
+  vpImageMap file;
+  file.create(filename, I.getWidth(), I.getHeight(), FORMAT_PFM);
+  if (I.getSize() > 0) {
+    std::memcpy(file.m_data, I.bitmap, file.getDataSize());
+  }
+  file.close();
+}
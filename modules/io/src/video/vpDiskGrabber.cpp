@@ -36,14 +36,271 @@
  *
  *****************************************************************************/
 
+#include <algorithm>
+
 #include <visp3/io/vpDiskGrabber.h>
 
+#if (VISP_CXX_STANDARD >= VISP_CXX_STANDARD_11)
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+/*
+  Background decoding pipeline of vpDiskGrabber. A fixed pool of slots holds
+  the requested image and the next lookahead images of the sequence; each
+  slot owns its image buffers, which are exchanged with the caller image when
+  a frame is consumed, so that the buffers are recycled from one frame to the
+  next instead of being reallocated.
+*/
+class vpDiskGrabber::vpPrefetcher
+{
+public:
+  vpPrefetcher(unsigned int lookahead, unsigned int nbThreads)
+    : m_slots(lookahead + 1), m_mutex(), m_cond(), m_threads(), m_stop(false)
+  {
+    for (unsigned int i = 0; i < nbThreads; i++) {
+      m_threads.push_back(std::thread(&vpPrefetcher::run, this));
+    }
+  }
+
+  ~vpPrefetcher()
+  {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_stop = true;
+    }
+    m_cond.notify_all();
+    for (size_t i = 0; i < m_threads.size(); i++) {
+      m_threads[i].join();
+    }
+  }
+
+  /*
+    Return in I the image number of the sequence, and schedule the decoding
+    of the next images considering step.
+  */
+  template <class Type> void acquire(const vpDiskGrabber &grabber, long number, long step, vpImage<Type> &I)
+  {
+    vpImageType type = getType(I);
+    std::string filename = grabber.getImageFilename(number);
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    vpSlot *slot = NULL;
+    while (true) {
+      slot = find(filename, type);
+      if (slot == NULL) {
+        schedule(grabber, number, step, type);
+        slot = find(filename, type);
+      }
+      if (slot != NULL && (slot->state == READY || slot->state == FAILED)) {
+        break;
+      }
+      m_cond.wait(lock);
+    }
+
+    bool failed = slot->state == FAILED;
+    int errorCode = slot->errorCode;
+    std::string errorMessage = slot->errorMessage;
+    if (!failed) {
+      swap(getImage(*slot, I), I);
+    }
+    slot->state = FREE;
+
+    // Keep decoding the following images while the caller processes this one
+    schedule(grabber, number + step, step, type);
+    lock.unlock();
+
+    if (failed) {
+      throw vpException(errorCode, errorMessage);
+    }
+  }
+
+private:
+  typedef enum { GRAY, RGBA, DEPTH, FLOAT } vpImageType;
+  typedef enum { FREE, PENDING, DECODING, READY, FAILED } vpSlotState;
+
+  struct vpSlot {
+    vpSlot()
+      : state(FREE), discard(false), order(0), type(GRAY), filename(), Igray(), Irgba(), Idepth(), Ifloat(),
+        errorCode(0), errorMessage()
+    {
+    }
+
+    vpSlotState state;
+    bool discard; // decoded image no longer requested
+    unsigned int order;
+    vpImageType type;
+    std::string filename;
+    vpImage<unsigned char> Igray;
+    vpImage<vpRGBa> Irgba;
+    vpImage<uint16_t> Idepth;
+    vpImage<float> Ifloat;
+    int errorCode;
+    std::string errorMessage;
+  };
+
+  static vpImageType getType(const vpImage<unsigned char> &) { return GRAY; }
+  static vpImageType getType(const vpImage<vpRGBa> &) { return RGBA; }
+  static vpImageType getType(const vpImage<uint16_t> &) { return DEPTH; }
+  static vpImageType getType(const vpImage<float> &) { return FLOAT; }
+  static vpImage<unsigned char> &getImage(vpSlot &slot, const vpImage<unsigned char> &) { return slot.Igray; }
+  static vpImage<vpRGBa> &getImage(vpSlot &slot, const vpImage<vpRGBa> &) { return slot.Irgba; }
+  static vpImage<uint16_t> &getImage(vpSlot &slot, const vpImage<uint16_t> &) { return slot.Idepth; }
+  static vpImage<float> &getImage(vpSlot &slot, const vpImage<float> &) { return slot.Ifloat; }
+
+  static void decode(vpSlot &slot, vpImageType type, const std::string &filename)
+  {
+    switch (type) {
+    case GRAY:
+      vpImageIo::read(slot.Igray, filename);
+      break;
+    case RGBA:
+      vpImageIo::read(slot.Irgba, filename);
+      break;
+    case DEPTH:
+      vpImageIo::read(slot.Idepth, filename);
+      break;
+    case FLOAT:
+    default:
+      vpImageIo::read(slot.Ifloat, filename);
+      break;
+    }
+  }
+
+  // Must be called with the mutex locked
+  vpSlot *find(const std::string &filename, vpImageType type)
+  {
+    for (size_t i = 0; i < m_slots.size(); i++) {
+      if (m_slots[i].state != FREE && !m_slots[i].discard && m_slots[i].type == type &&
+          m_slots[i].filename == filename) {
+        return &m_slots[i];
+      }
+    }
+    return NULL;
+  }
+
+  // Must be called with the mutex locked
+  void schedule(const vpDiskGrabber &grabber, long number, long step, vpImageType type)
+  {
+    std::vector<std::string> wanted;
+    for (size_t k = 0; k < m_slots.size() && (k == 0 || step != 0); k++) {
+      wanted.push_back(grabber.getImageFilename(number + static_cast<long>(k) * step));
+    }
+
+    // Release the slots of the images that are no more expected
+    for (size_t i = 0; i < m_slots.size(); i++) {
+      vpSlot &slot = m_slots[i];
+      if (slot.state == FREE) {
+        continue;
+      }
+      std::vector<std::string>::const_iterator it = std::find(wanted.begin(), wanted.end(), slot.filename);
+      if (slot.type != type || it == wanted.end()) {
+        if (slot.state == DECODING) {
+          slot.discard = true;
+        } else {
+          slot.state = FREE;
+        }
+      } else {
+        slot.discard = false;
+        slot.order = static_cast<unsigned int>(it - wanted.begin());
+      }
+    }
+
+    // Assign the free slots to the missing images, nearest first
+    for (size_t k = 0; k < wanted.size(); k++) {
+      if (find(wanted[k], type) != NULL) {
+        continue;
+      }
+      vpSlot *free_slot = NULL;
+      for (size_t i = 0; i < m_slots.size() && free_slot == NULL; i++) {
+        if (m_slots[i].state == FREE) {
+          free_slot = &m_slots[i];
+        }
+      }
+      if (free_slot == NULL) {
+        break;
+      }
+      free_slot->state = PENDING;
+      free_slot->discard = false;
+      free_slot->order = static_cast<unsigned int>(k);
+      free_slot->type = type;
+      free_slot->filename = wanted[k];
+    }
+    m_cond.notify_all();
+  }
+
+  // Decoding thread
+  void run()
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+      vpSlot *slot = NULL;
+      while (!m_stop) {
+        for (size_t i = 0; i < m_slots.size(); i++) {
+          if (m_slots[i].state == PENDING && (slot == NULL || m_slots[i].order < slot->order)) {
+            slot = &m_slots[i];
+          }
+        }
+        if (slot != NULL) {
+          break;
+        }
+        m_cond.wait(lock);
+      }
+      if (m_stop) {
+        return;
+      }
+
+      // The slot is only accessed by this thread while decoding
+      slot->state = DECODING;
+      vpImageType type = slot->type;
+      std::string filename = slot->filename;
+      lock.unlock();
+
+      bool failed = false;
+      int errorCode = 0;
+      std::string errorMessage;
+      try {
+        decode(*slot, type, filename);
+      } catch (vpException &e) {
+        failed = true;
+        errorCode = e.getCode();
+        errorMessage = e.getStringMessage();
+      } catch (...) {
+        failed = true;
+        errorCode = vpException::ioError;
+        errorMessage = "Cannot read file: " + filename;
+      }
+
+      lock.lock();
+      if (slot->discard) {
+        slot->state = FREE;
+        slot->discard = false;
+      } else {
+        slot->state = failed ? FAILED : READY;
+        slot->errorCode = errorCode;
+        slot->errorMessage = errorMessage;
+      }
+      m_cond.notify_all();
+    }
+  }
+
+  std::vector<vpSlot> m_slots;
+  std::mutex m_mutex;
+  std::condition_variable m_cond;
+  std::vector<std::thread> m_threads;
+  bool m_stop;
+};
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+#endif
+
 /*!
   Elementary constructor.
 */
 vpDiskGrabber::vpDiskGrabber()
   : m_image_number(0), m_image_number_next(0), m_image_step(1), m_number_of_zero(0), m_directory("/tmp"),
-    m_base_name("I"), m_extension("pgm"), m_use_generic_name(false), m_generic_name("empty")
+    m_base_name("I"), m_extension("pgm"), m_use_generic_name(false), m_generic_name("empty"),
+    m_prefetch_lookahead(0), m_prefetch_threads(1), m_prefetcher(NULL)
 {
   init = false;
 }
@@ -53,7 +310,8 @@ vpDiskGrabber::vpDiskGrabber()
 */
 vpDiskGrabber::vpDiskGrabber(const std::string &generic_name)
   : m_image_number(0), m_image_number_next(0), m_image_step(1), m_number_of_zero(0), m_directory("/tmp"),
-    m_base_name("I"), m_extension("pgm"), m_use_generic_name(true), m_generic_name(generic_name)
+    m_base_name("I"), m_extension("pgm"), m_use_generic_name(true), m_generic_name(generic_name),
+    m_prefetch_lookahead(0), m_prefetch_threads(1), m_prefetcher(NULL)
 {
   init = false;
 }
@@ -72,7 +330,8 @@ vpDiskGrabber::vpDiskGrabber(const std::string &generic_name)
 vpDiskGrabber::vpDiskGrabber(const std::string &dir, const std::string &basename, long number, int step,
                              unsigned int noz, const std::string &ext)
   : m_image_number(number), m_image_number_next(number), m_image_step(step), m_number_of_zero(noz), m_directory(dir),
-    m_base_name(basename), m_extension(ext), m_use_generic_name(false), m_generic_name("empty")
+    m_base_name(basename), m_extension(ext), m_use_generic_name(false), m_generic_name("empty"),
+    m_prefetch_lookahead(0), m_prefetch_threads(1), m_prefetcher(NULL)
 {
   init = false;
 }
@@ -115,6 +374,24 @@ void vpDiskGrabber::open(vpImage<vpRGBa> &I)
   init = true;
 }
 
+/*!
+  Read the first image of the sequence.
+  The image number is not incremented.
+*/
+void vpDiskGrabber::open(vpImage<uint16_t> &I)
+{
+  long first_number = getImageNumber();
+
+  acquire(I);
+
+  setImageNumber(first_number);
+
+  width = I.getWidth();
+  height = I.getHeight();
+
+  init = true;
+}
+
 /*!
   Read the first image of the sequence.
   The image number is not incremented.
@@ -144,20 +421,20 @@ void vpDiskGrabber::open(vpImage<float> &I)
 void vpDiskGrabber::acquire(vpImage<unsigned char> &I)
 {
   m_image_number = m_image_number_next;
-  std::stringstream ss;
+  m_image_number_next += m_image_step;
 
-  if (m_use_generic_name) {
-    char filename[FILENAME_MAX];
-    sprintf(filename, m_generic_name.c_str(), m_image_number);
-    ss << filename;
-  } else {
-    ss << m_directory << "/" << m_base_name << std::setfill('0') << std::setw(m_number_of_zero) << m_image_number << "."
-       << m_extension;
+#if (VISP_CXX_STANDARD >= VISP_CXX_STANDARD_11)
+  if (m_prefetch_lookahead > 0) {
+    if (m_prefetcher == NULL) {
+      m_prefetcher = new vpPrefetcher(m_prefetch_lookahead, m_prefetch_threads);
+    }
+    m_prefetcher->acquire(*this, m_image_number, m_image_step, I);
+  } else
+#endif
+  {
+    vpImageIo::read(I, getImageFilename(m_image_number));
   }
 
-  m_image_number_next += m_image_step;
-  vpImageIo::read(I, ss.str());
-
   width = I.getWidth();
   height = I.getHeight();
 }
@@ -171,27 +448,53 @@ void vpDiskGrabber::acquire(vpImage<unsigned char> &I)
 void vpDiskGrabber::acquire(vpImage<vpRGBa> &I)
 {
   m_image_number = m_image_number_next;
-  std::stringstream ss;
+  m_image_number_next += m_image_step;
 
-  if (m_use_generic_name) {
-    char filename[FILENAME_MAX];
-    sprintf(filename, m_generic_name.c_str(), m_image_number);
-    ss << filename;
-  } else {
-    ss << m_directory << "/" << m_base_name << std::setfill('0') << std::setw(m_number_of_zero) << m_image_number << "."
-       << m_extension;
+#if (VISP_CXX_STANDARD >= VISP_CXX_STANDARD_11)
+  if (m_prefetch_lookahead > 0) {
+    if (m_prefetcher == NULL) {
+      m_prefetcher = new vpPrefetcher(m_prefetch_lookahead, m_prefetch_threads);
+    }
+    m_prefetcher->acquire(*this, m_image_number, m_image_step, I);
+  } else
+#endif
+  {
+    vpImageIo::read(I, getImageFilename(m_image_number));
   }
 
+  width = I.getWidth();
+  height = I.getHeight();
+}
+
+/*!
+  Acquire a 16 bits depth image reading the next vpd image from the disk.
+  After this call, the image number is incremented considering the step.
+
+  \param I : The image read from a file.
+ */
+void vpDiskGrabber::acquire(vpImage<uint16_t> &I)
+{
+  m_image_number = m_image_number_next;
   m_image_number_next += m_image_step;
 
-  vpImageIo::read(I, ss.str());
+#if (VISP_CXX_STANDARD >= VISP_CXX_STANDARD_11)
+  if (m_prefetch_lookahead > 0) {
+    if (m_prefetcher == NULL) {
+      m_prefetcher = new vpPrefetcher(m_prefetch_lookahead, m_prefetch_threads);
+    }
+    m_prefetcher->acquire(*this, m_image_number, m_image_step, I);
+  } else
+#endif
+  {
+    vpImageIo::read(I, getImageFilename(m_image_number));
+  }
 
   width = I.getWidth();
   height = I.getHeight();
 }
 
 /*!
-  Acquire an image reading the next pfm image from the disk.
+  Acquire an image reading the next pfm or vpd image from the disk.
   After this call, the image number is incremented considering the step.
 
   \param I : The image read from a file.
@@ -199,19 +502,19 @@ void vpDiskGrabber::acquire(vpImage<vpRGBa> &I)
 void vpDiskGrabber::acquire(vpImage<float> &I)
 {
   m_image_number = m_image_number_next;
-  std::stringstream ss;
-  if (m_use_generic_name) {
-    char filename[FILENAME_MAX];
-    sprintf(filename, m_generic_name.c_str(), m_image_number);
-    ss << filename;
-  } else {
-    ss << m_directory << "/" << m_base_name << std::setfill('0') << std::setw(m_number_of_zero) << m_image_number << "."
-       << m_extension;
-  }
-
   m_image_number_next += m_image_step;
 
-  vpImageIo::readPFM(I, ss.str());
+#if (VISP_CXX_STANDARD >= VISP_CXX_STANDARD_11)
+  if (m_prefetch_lookahead > 0) {
+    if (m_prefetcher == NULL) {
+      m_prefetcher = new vpPrefetcher(m_prefetch_lookahead, m_prefetch_threads);
+    }
+    m_prefetcher->acquire(*this, m_image_number, m_image_step, I);
+  } else
+#endif
+  {
+    vpImageIo::read(I, getImageFilename(m_image_number));
+  }
 
   width = I.getWidth();
   height = I.getHeight();
@@ -227,19 +530,19 @@ void vpDiskGrabber::acquire(vpImage<float> &I)
 void vpDiskGrabber::acquire(vpImage<unsigned char> &I, long img_number)
 {
   m_image_number = img_number;
-  std::stringstream ss;
-  if (m_use_generic_name) {
-    char filename[FILENAME_MAX];
-    sprintf(filename, m_generic_name.c_str(), m_image_number);
-    ss << filename;
-  } else {
-    ss << m_directory << "/" << m_base_name << std::setfill('0') << std::setw(m_number_of_zero) << m_image_number << "."
-       << m_extension;
-  }
-
   m_image_number_next = m_image_number + m_image_step;
 
-  vpImageIo::read(I, ss.str());
+#if (VISP_CXX_STANDARD >= VISP_CXX_STANDARD_11)
+  if (m_prefetch_lookahead > 0) {
+    if (m_prefetcher == NULL) {
+      m_prefetcher = new vpPrefetcher(m_prefetch_lookahead, m_prefetch_threads);
+    }
+    m_prefetcher->acquire(*this, m_image_number, m_image_step, I);
+  } else
+#endif
+  {
+    vpImageIo::read(I, getImageFilename(m_image_number));
+  }
 
   width = I.getWidth();
   height = I.getHeight();
@@ -255,47 +558,77 @@ void vpDiskGrabber::acquire(vpImage<unsigned char> &I, long img_number)
 void vpDiskGrabber::acquire(vpImage<vpRGBa> &I, long img_number)
 {
   m_image_number = img_number;
-  std::stringstream ss;
-  if (m_use_generic_name) {
-    char filename[FILENAME_MAX];
-    sprintf(filename, m_generic_name.c_str(), m_image_number);
-    ss << filename;
-  } else {
-    ss << m_directory << "/" << m_base_name << std::setfill('0') << std::setw(m_number_of_zero) << m_image_number << "."
-       << m_extension;
+  m_image_number_next = m_image_number + m_image_step;
+
+#if (VISP_CXX_STANDARD >= VISP_CXX_STANDARD_11)
+  if (m_prefetch_lookahead > 0) {
+    if (m_prefetcher == NULL) {
+      m_prefetcher = new vpPrefetcher(m_prefetch_lookahead, m_prefetch_threads);
+    }
+    m_prefetcher->acquire(*this, m_image_number, m_image_step, I);
+  } else
+#endif
+  {
+    vpImageIo::read(I, getImageFilename(m_image_number));
   }
 
+  width = I.getWidth();
+  height = I.getHeight();
+}
+
+/*!
+  Acquire a 16 bits depth image reading the image with number \e img_number
+  from the disk. After this call, the image number is incremented considering
+  the step.
+
+  \param I : The image read from a file.
+  \param img_number : The number of the desired image.
+ */
+void vpDiskGrabber::acquire(vpImage<uint16_t> &I, long img_number)
+{
+  m_image_number = img_number;
   m_image_number_next = m_image_number + m_image_step;
 
-  vpImageIo::read(I, ss.str());
+#if (VISP_CXX_STANDARD >= VISP_CXX_STANDARD_11)
+  if (m_prefetch_lookahead > 0) {
+    if (m_prefetcher == NULL) {
+      m_prefetcher = new vpPrefetcher(m_prefetch_lookahead, m_prefetch_threads);
+    }
+    m_prefetcher->acquire(*this, m_image_number, m_image_step, I);
+  } else
+#endif
+  {
+    vpImageIo::read(I, getImageFilename(m_image_number));
+  }
 
   width = I.getWidth();
   height = I.getHeight();
 }
 
 /*!
-  Acquire an image reading the pfm image with number \e img_number from the
-  disk. After this call, the image number is incremented considering the step.
+  Acquire an image reading the pfm or vpd image with number \e img_number
+  from the disk. After this call, the image number is incremented considering
+  the step.
 
   \param I : The image read from a file.
   \param img_number : The number of the desired image.
  */
 void vpDiskGrabber::acquire(vpImage<float> &I, long img_number)
 {
-  m_image_number = m_image_number_next;
-  std::stringstream ss;
-  if (m_use_generic_name) {
-    char filename[FILENAME_MAX];
-    sprintf(filename, m_generic_name.c_str(), m_image_number);
-    ss << filename;
-  } else {
-    ss << m_directory << "/" << m_base_name << std::setfill('0') << std::setw(m_number_of_zero) << img_number << "."
-       << m_extension;
-  }
-
-  m_image_number_next += m_image_step;
+  m_image_number = img_number;
+  m_image_number_next = m_image_number + m_image_step;
 
-  vpImageIo::readPFM(I, ss.str());
+#if (VISP_CXX_STANDARD >= VISP_CXX_STANDARD_11)
+  if (m_prefetch_lookahead > 0) {
+    if (m_prefetcher == NULL) {
+      m_prefetcher = new vpPrefetcher(m_prefetch_lookahead, m_prefetch_threads);
+    }
+    m_prefetcher->acquire(*this, m_image_number, m_image_step, I);
+  } else
+#endif
+  {
+    vpImageIo::read(I, getImageFilename(m_image_number));
+  }
 
   width = I.getWidth();
   height = I.getHeight();
@@ -312,11 +645,32 @@ void vpDiskGrabber::close()
 }
 
 /*!
-  Destructor
-
-  In fact nothing to destroy...
+  Destructor. Stop the decoding threads if prefetching is enabled.
  */
-vpDiskGrabber::~vpDiskGrabber() {}
+vpDiskGrabber::~vpDiskGrabber()
+{
+#if (VISP_CXX_STANDARD >= VISP_CXX_STANDARD_11)
+  delete m_prefetcher;
+#endif
+}
+
+/*!
+  Return the name of the file containing the image with number \e image_number.
+*/
+std::string vpDiskGrabber::getImageFilename(long image_number) const
+{
+  std::stringstream ss;
+  if (m_use_generic_name) {
+    char filename[FILENAME_MAX];
+    sprintf(filename, m_generic_name.c_str(), image_number);
+    ss << filename;
+  } else {
+    ss << m_directory << "/" << m_base_name << std::setfill('0') << std::setw(m_number_of_zero) << image_number << "."
+       << m_extension;
+  }
+
+  return ss.str();
+}
 
 /*!
   Set the main directory name (ie location of the image sequence)
@@ -351,6 +705,36 @@ void vpDiskGrabber::setStep(long step) { m_image_step = step; }
 */
 void vpDiskGrabber::setNumberOfZero(unsigned int noz) { m_number_of_zero = noz; }
 
+/*!
+  Enable the decoding of the images in advance by background threads.
+
+  Each call to acquire() returns the requested image, decoding it if it is
+  not already available, and schedules the decoding of the \e lookahead
+  following images of the sequence considering the current step. When the
+  step changes or when an image is requested out of order, for example after
+  acquire(I, image_number), the images that are no longer expected are
+  discarded. The image buffers are recycled: the buffer of the image passed to
+  acquire() is reused to decode a following image.
+
+  The requested image is the same as without prefetching, and the errors
+  raised while reading it are reported by acquire() as usual. Prefetching
+  requires ViSP to be built with C++11 support, otherwise the images are
+  always decoded by acquire().
+
+  \param lookahead : Number of images decoded in advance. 0 disables
+  prefetching, which is the default.
+  \param nbThreads : Number of decoding threads.
+*/
+void vpDiskGrabber::setPrefetch(unsigned int lookahead, unsigned int nbThreads)
+{
+#if (VISP_CXX_STANDARD >= VISP_CXX_STANDARD_11)
+  delete m_prefetcher;
+#endif
+  m_prefetcher = NULL;
+  m_prefetch_lookahead = lookahead;
+  m_prefetch_threads = std::max(nbThreads, 1u);
+}
+
 void vpDiskGrabber::setGenericName(const std::string &generic_name)
 {
   m_generic_name = generic_name;
@@ -60,7 +60,8 @@ vpVideoReader::vpVideoReader()
     m_capture(), m_frame(), m_lastframe_unknown(false),
 #endif
     m_formatType(FORMAT_UNKNOWN), m_fileName(), m_initFileName(false), m_isOpen(false), m_frameCount(0), m_firstFrame(0), m_lastFrame(0),
-    m_firstFrameIndexIsSet(false), m_lastFrameIndexIsSet(false), m_frameStep(1), m_frameRate(0.)
+    m_firstFrameIndexIsSet(false), m_lastFrameIndexIsSet(false), m_frameStep(1), m_frameRate(0.),
+    m_prefetchLookahead(0), m_prefetchThreads(1)
 {
 }
 
@@ -114,6 +115,24 @@ void vpVideoReader::setFileName(const std::string &filename)
   m_initFileName = true;
 }
 
+/*!
+  Decode the next images of a sequence of images in advance with background
+  threads, see vpDiskGrabber::setPrefetch(). The frames returned by acquire()
+  and getFrame() are unchanged. This setting has no effect on video files.
+
+  \param lookahead : Number of images decoded in advance, 0 to disable
+  prefetching.
+  \param nbThreads : Number of decoding threads.
+*/
+void vpVideoReader::setPrefetch(unsigned int lookahead, unsigned int nbThreads)
+{
+  m_prefetchLookahead = lookahead;
+  m_prefetchThreads = nbThreads;
+  if (m_imSequence != NULL) {
+    m_imSequence->setPrefetch(lookahead, nbThreads);
+  }
+}
+
 /*!
   Open video stream and get first and last frame indexes.
 */
@@ -127,6 +146,7 @@ void vpVideoReader::getProperties()
     m_imSequence = new vpDiskGrabber;
     m_imSequence->setGenericName(m_fileName.c_str());
     m_imSequence->setStep(m_frameStep);
+    m_imSequence->setPrefetch(m_prefetchLookahead, m_prefetchThreads);
     if (m_firstFrameIndexIsSet) {
       m_imSequence->setImageNumber(m_firstFrame);
     }
@@ -383,6 +403,135 @@ void vpVideoReader::acquire(vpImage<unsigned char> &I)
 #endif
 }
 
+/*!
+Sets all the parameters needed to read the sequence of 16 bits depth images.
+
+Grab the first frame and stores it in the image \f$ I \f$.
+
+\param I : The image where the frame is stored.
+
+\exception vpException::ioError : If the file name is not the one of an image
+sequence, since depth images cannot be read from video files.
+*/
+void vpVideoReader::open(vpImage<uint16_t> &I) { openDepth(I); }
+
+/*!
+Sets all the parameters needed to read the sequence of float images.
+
+Grab the first frame and stores it in the image \f$ I \f$.
+
+\param I : The image where the frame is stored.
+
+\exception vpException::ioError : If the file name is not the one of an image
+sequence, since float images cannot be read from video files.
+*/
+void vpVideoReader::open(vpImage<float> &I) { openDepth(I); }
+
+/*!
+Grabs the current (k) 16 bits depth image in the sequence and increments the
+frame counter in order to grab the next image (k+1) during the next use of the
+method. If open() was not called previously, this method opens the video
+reader.
+
+\param I : The image where the frame is stored.
+*/
+void vpVideoReader::acquire(vpImage<uint16_t> &I) { acquireDepth(I); }
+
+/*!
+Grabs the current (k) float image in the sequence and increments the frame
+counter in order to grab the next image (k+1) during the next use of the
+method. If open() was not called previously, this method opens the video
+reader.
+
+\param I : The image where the frame is stored.
+*/
+void vpVideoReader::acquire(vpImage<float> &I) { acquireDepth(I); }
+
+/*!
+Gets the \f$ frame \f$ th 16 bits depth image of the sequence and stores it in
+the image \f$ I \f$.
+
+\param I : The vpImage used to stored the frame.
+\param frame_index : The index of the frame which has to be read.
+
+\return It returns true if the frame could be read. Else it returns false.
+*/
+bool vpVideoReader::getFrame(vpImage<uint16_t> &I, long frame_index) { return getDepthFrame(I, frame_index); }
+
+/*!
+Gets the \f$ frame \f$ th float image of the sequence and stores it in the
+image \f$ I \f$.
+
+\param I : The vpImage used to stored the frame.
+\param frame_index : The index of the frame which has to be read.
+
+\return It returns true if the frame could be read. Else it returns false.
+*/
+bool vpVideoReader::getFrame(vpImage<float> &I, long frame_index) { return getDepthFrame(I, frame_index); }
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+template <class Type> void vpVideoReader::openDepth(vpImage<Type> &I)
+{
+  getProperties();
+
+  if (m_imSequence == NULL) {
+    throw(vpException(vpException::ioError, "Depth images can only be read from a sequence of images"));
+  }
+
+  m_frameCount = m_firstFrame;
+  if (!getDepthFrame(I, m_firstFrame)) {
+    throw(vpException(vpException::ioError, "Could not read the video first frame"));
+  }
+
+  // Rewind to the first frame since open() should not increase the frame
+  // counter
+  m_frameCount = m_firstFrame;
+}
+
+template <class Type> void vpVideoReader::acquireDepth(vpImage<Type> &I)
+{
+  if (!m_isOpen) {
+    openDepth(I);
+  }
+
+  if (m_imSequence == NULL) {
+    throw(vpException(vpException::ioError, "Depth images can only be read from a sequence of images"));
+  }
+
+  m_imSequence->setStep(m_frameStep);
+  m_imSequence->acquire(I);
+  m_frameCount = m_imSequence->getImageNumber();
+  if (m_frameCount + m_frameStep > m_lastFrame) {
+    m_imSequence->setImageNumber(m_frameCount);
+  } else if (m_frameCount + m_frameStep < m_firstFrame) {
+    m_imSequence->setImageNumber(m_frameCount);
+  }
+}
+
+template <class Type> bool vpVideoReader::getDepthFrame(vpImage<Type> &I, long frame_index)
+{
+  if (m_imSequence == NULL) {
+    return false;
+  }
+  try {
+    m_imSequence->acquire(I, frame_index);
+    width = I.getWidth();
+    height = I.getHeight();
+    m_frameCount = m_imSequence->getImageNumber();
+    m_imSequence->setImageNumber(m_frameCount); // to not increment vpDiskGrabber next image
+    if (m_frameCount + m_frameStep > m_lastFrame) {
+      m_imSequence->setImageNumber(m_frameCount);
+    } else if (m_frameCount + m_frameStep < m_firstFrame) {
+      m_imSequence->setImageNumber(m_frameCount);
+    }
+  } catch (...) {
+    vpERROR_TRACE("Couldn't find the %ld th frame", frame_index);
+    return false;
+  }
+  return true;
+}
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
 /*!
 Gets the \f$ frame \f$ th frame and stores it in the image  \f$ I \f$.
 
@@ -584,6 +733,14 @@ vpVideoReader::vpVideoFormatType vpVideoReader::getFormat(const std::string &fil
     return FORMAT_JPEG2000;
   else if (ext.compare(".jp2") == 0)
     return FORMAT_JPEG2000;
+  else if (ext.compare(".PFM") == 0)
+    return FORMAT_PFM;
+  else if (ext.compare(".pfm") == 0)
+    return FORMAT_PFM;
+  else if (ext.compare(".VPD") == 0)
+    return FORMAT_VPD;
+  else if (ext.compare(".vpd") == 0)
+    return FORMAT_VPD;
   else if (ext.compare(".AVI") == 0)
     return FORMAT_AVI;
   else if (ext.compare(".avi") == 0)
@@ -736,7 +893,7 @@ bool vpVideoReader::isImageExtensionSupported() const
   return (m_formatType == FORMAT_PGM || m_formatType == FORMAT_PPM || m_formatType == FORMAT_JPEG ||
           m_formatType == FORMAT_PNG || m_formatType == FORMAT_TIFF || m_formatType == FORMAT_BMP ||
           m_formatType == FORMAT_DIB || m_formatType == FORMAT_PBM || m_formatType == FORMAT_RASTER ||
-          m_formatType == FORMAT_JPEG2000);
+          m_formatType == FORMAT_JPEG2000 || m_formatType == FORMAT_PFM || m_formatType == FORMAT_VPD);
 }
 
 /*!
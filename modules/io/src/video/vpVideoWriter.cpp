@@ -57,7 +57,8 @@ vpVideoWriter::vpVideoWriter()
 #if VISP_HAVE_OPENCV_VERSION >= 0x020100
     writer(), fourcc(0), framerate(0.),
 #endif
-    formatType(FORMAT_UNKNOWN), initFileName(false), isOpen(false), frameCount(0), firstFrame(0), width(0), height(0)
+    formatType(FORMAT_UNKNOWN), initFileName(false), isOpen(false), frameCount(0), firstFrame(0), width(0), height(0),
+    m_asyncThreads(0), m_asyncQueueSize(8), m_asyncWriter(NULL)
 {
   initFileName = false;
   firstFrame = 0;
@@ -76,7 +77,53 @@ vpVideoWriter::vpVideoWriter()
 /*!
   Basic destructor.
 */
-vpVideoWriter::~vpVideoWriter() {}
+vpVideoWriter::~vpVideoWriter()
+{
+  if (m_asyncWriter != NULL) {
+    delete m_asyncWriter;
+  }
+}
+
+/*!
+  Write the images of the sequence in the background. saveFrame() copies the
+  image in a queue and returns, the images being encoded and written by a pool
+  of threads. close() waits until all the images are written.
+
+  It has no effect on video files. The setting is taken into account by the
+  next call to open().
+
+  \param nbThreads : Number of threads encoding and writing the images; 0 to
+  write the images in saveFrame(), which is the default.
+  \param queueSize : Maximum number of images waiting to be written. When the
+  queue is full saveFrame() waits for a free place; the time spent waiting is
+  given by getAsyncWriteStatistics().
+
+  \sa vpAsyncImageWriter
+*/
+void vpVideoWriter::setAsyncWrite(unsigned int nbThreads, unsigned int queueSize)
+{
+  m_asyncThreads = nbThreads;
+  m_asyncQueueSize = queueSize;
+}
+
+/*!
+  Return the statistics of the background writing of the image sequence,
+  that allow to check if saveFrame() had to wait for the images to be
+  written.
+
+  \sa setAsyncWrite()
+*/
+vpAsyncImageWriter::vpStatistics vpVideoWriter::getAsyncWriteStatistics() const
+{
+  if (m_asyncWriter == NULL) {
+    vpAsyncImageWriter::vpStatistics statistics;
+    statistics.nbQueued = statistics.nbWritten = statistics.nbDropped = statistics.nbFailed = 0;
+    statistics.nbBlocked = statistics.maxQueueSize = 0;
+    statistics.blockedTime = 0.;
+    return statistics;
+  }
+  return m_asyncWriter->getStatistics();
+}
 
 /*!
   It enables to set the path and the name of the files which will be saved.
@@ -139,6 +186,13 @@ void vpVideoWriter::open(vpImage<vpRGBa> &I)
   if (formatType == FORMAT_PGM || formatType == FORMAT_PPM || formatType == FORMAT_JPEG || formatType == FORMAT_PNG) {
     width = I.getWidth();
     height = I.getHeight();
+    if (m_asyncWriter != NULL) {
+      delete m_asyncWriter;
+      m_asyncWriter = NULL;
+    }
+    if (m_asyncThreads > 0) {
+      m_asyncWriter = new vpAsyncImageWriter(m_asyncThreads, m_asyncQueueSize);
+    }
   } else if (formatType == FORMAT_AVI || formatType == FORMAT_MPEG || formatType == FORMAT_MPEG4 ||
              formatType == FORMAT_MOV) {
 #if VISP_HAVE_OPENCV_VERSION >= 0x020100
@@ -174,6 +228,13 @@ void vpVideoWriter::open(vpImage<unsigned char> &I)
   if (formatType == FORMAT_PGM || formatType == FORMAT_PPM || formatType == FORMAT_JPEG || formatType == FORMAT_PNG) {
     width = I.getWidth();
     height = I.getHeight();
+    if (m_asyncWriter != NULL) {
+      delete m_asyncWriter;
+      m_asyncWriter = NULL;
+    }
+    if (m_asyncThreads > 0) {
+      m_asyncWriter = new vpAsyncImageWriter(m_asyncThreads, m_asyncQueueSize);
+    }
   } else if (formatType == FORMAT_AVI || formatType == FORMAT_MPEG || formatType == FORMAT_MPEG4 ||
              formatType == FORMAT_MOV) {
 #if VISP_HAVE_OPENCV_VERSION >= 0x020100
@@ -215,7 +276,11 @@ void vpVideoWriter::saveFrame(vpImage<vpRGBa> &I)
 
     sprintf(name, fileName, frameCount);
 
-    vpImageIo::write(I, name);
+    if (m_asyncWriter != NULL) {
+      m_asyncWriter->write(I, name);
+    } else {
+      vpImageIo::write(I, name);
+    }
   } else {
 #if VISP_HAVE_OPENCV_VERSION >= 0x020100
     cv::Mat matFrame;
@@ -248,7 +313,11 @@ void vpVideoWriter::saveFrame(vpImage<unsigned char> &I)
 
     sprintf(name, fileName, frameCount);
 
-    vpImageIo::write(I, name);
+    if (m_asyncWriter != NULL) {
+      m_asyncWriter->write(I, name);
+    } else {
+      vpImageIo::write(I, name);
+    }
   } else {
 #if VISP_HAVE_OPENCV_VERSION >= 0x030000
     cv::Mat matFrame, rgbMatFrame;
@@ -266,8 +335,97 @@ void vpVideoWriter::saveFrame(vpImage<unsigned char> &I)
   frameCount++;
 }
 
+/*!
+  Sets all the parameters needed to write the sequence of 16 bits depth
+  images.
+
+  \param I : One image with the right dimensions.
+
+  \exception vpException::badValue : If the file name is not the one of a
+  sequence of .vpd images.
+*/
+void vpVideoWriter::open(vpImage<uint16_t> &I) { openDepth(I); }
+
+/*!
+  Sets all the parameters needed to write the sequence of float images.
+
+  \param I : One image with the right dimensions.
+
+  \exception vpException::badValue : If the file name is not the one of a
+  sequence of .vpd or .pfm images.
+*/
+void vpVideoWriter::open(vpImage<float> &I) { openDepth(I); }
+
+/*!
+  Saves the 16 bits depth image as an image belonging to the image sequence.
+
+  \param I : The image which has to be saved
+*/
+void vpVideoWriter::saveFrame(vpImage<uint16_t> &I) { saveDepthFrame(I); }
+
+/*!
+  Saves the float image as an image belonging to the image sequence.
+
+  \param I : The image which has to be saved
+*/
+void vpVideoWriter::saveFrame(vpImage<float> &I) { saveDepthFrame(I); }
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+template <class Type> void vpVideoWriter::openDepth(vpImage<Type> &I)
+{
+  if (!initFileName) {
+    vpERROR_TRACE("The generic filename has to be set");
+    throw(vpImageException(vpImageException::noFileNameError, "filename empty"));
+  }
+
+  if (formatType != FORMAT_VPD && formatType != FORMAT_PFM) {
+    throw(vpException(vpException::badValue, "Depth images can only be written in a sequence of images"));
+  }
+
+  width = I.getWidth();
+  height = I.getHeight();
+  if (m_asyncWriter != NULL) {
+    delete m_asyncWriter;
+    m_asyncWriter = NULL;
+  }
+  if (m_asyncThreads > 0) {
+    m_asyncWriter = new vpAsyncImageWriter(m_asyncThreads, m_asyncQueueSize);
+  }
+
+  frameCount = firstFrame;
+
+  isOpen = true;
+}
+
+template <class Type> void vpVideoWriter::saveDepthFrame(vpImage<Type> &I)
+{
+  if (!isOpen) {
+    vpERROR_TRACE("The video has to be open first with the open method");
+    throw(vpException(vpException::notInitialized, "file not yet opened"));
+  }
+
+  char name[FILENAME_MAX];
+
+  sprintf(name, fileName, frameCount);
+
+  if (m_asyncWriter != NULL) {
+    m_asyncWriter->write(I, name);
+  } else {
+    vpImageIo::write(I, name);
+  }
+
+  frameCount++;
+}
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
 /*!
   Deallocates parameters use to write the video or the image sequence.
+
+  When the image sequence is written in the background, waits until all the
+  images are written.
+
+  \exception vpImageException::ioError : If an image written in the
+  background could not be written.
 */
 void vpVideoWriter::close()
 {
@@ -275,6 +433,9 @@ void vpVideoWriter::close()
     vpERROR_TRACE("The video has to be open first with the open method");
     throw(vpException(vpException::notInitialized, "file not yet opened"));
   }
+  if (m_asyncWriter != NULL) {
+    m_asyncWriter->flush();
+  }
 }
 
 /*!
@@ -308,6 +469,14 @@ vpVideoWriter::vpVideoFormatType vpVideoWriter::getFormat(const char *filename)
     return FORMAT_PNG;
   else if (ext.compare(".png") == 0)
     return FORMAT_PNG;
+  else if (ext.compare(".PFM") == 0)
+    return FORMAT_PFM;
+  else if (ext.compare(".pfm") == 0)
+    return FORMAT_PFM;
+  else if (ext.compare(".VPD") == 0)
+    return FORMAT_VPD;
+  else if (ext.compare(".vpd") == 0)
+    return FORMAT_VPD;
   else if (ext.compare(".AVI") == 0)
     return FORMAT_AVI;
   else if (ext.compare(".avi") == 0)
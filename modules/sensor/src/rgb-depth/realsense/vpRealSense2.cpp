@@ -217,6 +217,49 @@ void vpRealSense2::acquire(unsigned char *const data_image, unsigned char *const
   }
 }
 
+/*!
+  Acquire data from RealSense device with the point cloud stored in a
+  contiguous organized vpPointCloud. Contrary to the std::vector<vpColVector>
+  representation, no memory allocation occurs once the point cloud has been
+  acquired a first time.
+
+  \param data_image : Color image buffer or NULL if not wanted.
+  \param data_depth : Depth image buffer or NULL if not wanted.
+  \param pointcloud : Organized point cloud.
+  \param data_infrared : Infrared image buffer or NULL if not wanted.
+  \param align_to : Align to a reference stream or NULL if not wanted.
+  Only depth and color streams can be aligned.
+ */
+void vpRealSense2::acquire(unsigned char *const data_image, unsigned char *const data_depth, vpPointCloud &pointcloud,
+                           unsigned char *const data_infrared, rs2::align *const align_to)
+{
+  auto data = m_pipe->wait_for_frames();
+  if (align_to != NULL) {
+#if (RS2_API_VERSION > ((2 * 10000) + (9 * 100) + 0))
+    data = align_to->process(data);
+#else
+    data = align_to->proccess(data);
+#endif
+  }
+
+  if (data_image != NULL) {
+    auto color_frame = data.get_color_frame();
+    getNativeFrameData(color_frame, data_image);
+  }
+
+  auto depth_frame = data.get_depth_frame();
+  if (data_depth != NULL) {
+    getNativeFrameData(depth_frame, data_depth);
+  }
+
+  getPointcloud(depth_frame, pointcloud);
+
+  if (data_infrared != NULL) {
+    auto infrared_frame = data.first(RS2_STREAM_INFRARED);
+    getNativeFrameData(infrared_frame, data_infrared);
+  }
+}
+
 #if (RS2_API_VERSION > ((2 * 10000) + (31 * 100) + 0))
 /*!
   Acquire timestamped greyscale images from T265 RealSense device at 30Hz.
@@ -854,6 +897,53 @@ void vpRealSense2::getPointcloud(const rs2::depth_frame &depth_frame, std::vecto
 }
 
 
+void vpRealSense2::getPointcloud(const rs2::depth_frame &depth_frame, vpPointCloud &pointcloud)
+{
+  if (m_depthScale <= std::numeric_limits<float>::epsilon()) {
+    std::stringstream ss;
+    ss << "Error, depth scale <= 0: " << m_depthScale;
+    throw vpException(vpException::fatalError, ss.str());
+  }
+
+  auto vf = depth_frame.as<rs2::video_frame>();
+  const int width = vf.get_width();
+  const int height = vf.get_height();
+  if (pointcloud.getStorageType() != vpPointCloud::XYZ_STORAGE || pointcloud.getWidth() != (unsigned int)width ||
+      pointcloud.getHeight() != (unsigned int)height) {
+    pointcloud.resize((unsigned int)height, (unsigned int)width);
+  }
+
+  const uint16_t *p_depth_frame = reinterpret_cast<const uint16_t *>(depth_frame.get_data());
+  const rs2_intrinsics depth_intrinsics = depth_frame.get_profile().as<rs2::video_stream_profile>().get_intrinsics();
+
+  // Multi-threading if OpenMP
+  // Concurrent writes at different locations are safe
+  #pragma omp parallel for schedule(dynamic)
+  for (int i = 0; i < height; i++) {
+    auto depth_pixel_index = i * width;
+
+    for (int j = 0; j < width; j++, depth_pixel_index++) {
+      if (p_depth_frame[depth_pixel_index] == 0) {
+        pointcloud.setPoint((unsigned int)i, (unsigned int)j, m_invalidDepthValue, m_invalidDepthValue,
+                            m_invalidDepthValue);
+        continue;
+      }
+
+      // Get the depth value of the current pixel
+      auto pixels_distance = m_depthScale * p_depth_frame[depth_pixel_index];
+
+      float points[3];
+      const float pixel[] = {(float)j, (float)i};
+      rs2_deproject_pixel_to_point(points, &depth_intrinsics, pixel, pixels_distance);
+
+      if (pixels_distance > m_max_Z)
+        points[0] = points[1] = points[2] = m_invalidDepthValue;
+
+      pointcloud.setPoint((unsigned int)i, (unsigned int)j, points[0], points[1], points[2]);
+    }
+  }
+}
+
 #ifdef VISP_HAVE_PCL
 void vpRealSense2::getPointcloud(const rs2::depth_frame &depth_frame, pcl::PointCloud<pcl::PointXYZ>::Ptr &pointcloud)
 {
@@ -0,0 +1,197 @@
+/****************************************************************************
+ *
+ * ViSP, open source Visual Servoing Platform software.
+ * Copyright (C) 2005 - 2019 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Native KLT (Kanade-Lucas-Tomasi) feature tracker working on vpImage.
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpKltNative.h
+
+  \brief Native KLT (Kanade-Lucas-Tomasi) feature tracker that does not
+  require OpenCV.
+*/
+
+#ifndef vpKltNative_h
+#define vpKltNative_h
+
+#include <vector>
+
+#include <visp3/core/vpColor.h>
+#include <visp3/core/vpConfig.h>
+#include <visp3/core/vpImage.h>
+#include <visp3/core/vpImagePoint.h>
+
+/*!
+  \class vpKltNative
+
+  \ingroup module_klt
+
+  \brief KLT (Kanade-Lucas-Tomasi) feature tracker working directly on
+  vpImage<unsigned char>, without any third-party library.
+
+  Features are detected with the Shi-Tomasi detector (minimal eigenvalue of
+  the gradient covariance matrix, non-maximum suppression, minimal distance
+  and sub-pixel refinement) and tracked with the iterative pyramidal
+  Lucas-Kanade method. The class mirrors the vpKltOpencv interface and uses
+  the same default values, so that both implementations can be exchanged.
+
+  The image pyramids and the Scharr derivatives of the previous frame are
+  kept between two calls to track(): each new image is decimated once, and
+  the memory is reused as long as the image size does not change. Features
+  are tracked in parallel when OpenMP is available, the inner loops being
+  vectorized with SSE2 or NEON.
+
+  Contrary to vpKltOpencv, a feature whose integration window leaves the
+  image at the finest pyramid level is considered as lost.
+
+  \code
+#include <visp3/io/vpImageIo.h>
+#include <visp3/klt/vpKltNative.h>
+
+int main()
+{
+  vpImage<unsigned char> I;
+  vpImageIo::read(I, "image0.pgm");
+
+  vpKltNative tracker;
+  tracker.setMaxFeatures(200);
+  tracker.setWindowSize(10);
+  tracker.setQuality(0.01);
+  tracker.setMinDistance(15);
+  tracker.setPyramidLevels(3);
+  tracker.initTracking(I);
+
+  for (int i = 1; i < 10; i++) {
+    // Acquire a new image
+    tracker.track(I);
+    for (int k = 0; k < tracker.getNbFeatures(); k++) {
+      long id;
+      float x, y;
+      tracker.getFeature(k, id, x, y);
+    }
+  }
+}
+  \endcode
+*/
+class VISP_EXPORT vpKltNative
+{
+public:
+  vpKltNative();
+  vpKltNative(const vpKltNative &copy);
+  virtual ~vpKltNative();
+
+  void addFeature(const float &x, const float &y);
+  void addFeature(const long &id, const float &x, const float &y);
+
+  void display(const vpImage<unsigned char> &I, const vpColor &color = vpColor::red, unsigned int thickness = 1) const;
+  void display(const vpImage<vpRGBa> &I, const vpColor &color = vpColor::red, unsigned int thickness = 1) const;
+
+  //! Get the size of the averaging block used to detect the features.
+  int getBlockSize() const { return m_blockSize; }
+  void getFeature(const int &index, long &id, float &x, float &y) const;
+  std::vector<vpImagePoint> getFeatures() const;
+  //! Get the unique id of each feature.
+  std::vector<long> getFeaturesId() const { return m_pointsId; }
+  //! Get the maximum number of features to track in the image.
+  int getMaxFeatures() const { return m_maxCount; }
+  //! Get the maximum number of Lucas-Kanade iterations per pyramid level.
+  int getMaxIterations() const { return m_maxIter; }
+  //! Get the minimal Euclidean distance between detected corners during
+  //! initialization.
+  double getMinDistance() const { return m_minDistance; }
+  //! Get the minimal eigen value threshold used to reject a point during the tracking.
+  double getMinEigThreshold() const { return m_minEigThreshold; }
+  //! Get the number of current features
+  int getNbFeatures() const { return (int)m_pointsX[1].size(); }
+  //! Get the number of previous features.
+  int getNbPrevFeatures() const { return (int)m_pointsX[0].size(); }
+  //! Get the maximal pyramid level.
+  int getPyramidLevels() const { return m_pyrMaxLevel; }
+  //! Get the parameter characterizing the minimal accepted quality of image
+  //! corners.
+  double getQuality() const { return m_qualityLevel; }
+  //! Get the window size used to track the features.
+  int getWindowSize() const { return m_winSize; }
+
+  void initTracking(const vpImage<unsigned char> &I, const vpImage<unsigned char> *mask = NULL);
+  void initTracking(const vpImage<unsigned char> &I, const std::vector<vpImagePoint> &pts);
+  void initTracking(const vpImage<unsigned char> &I, const std::vector<vpImagePoint> &pts,
+                    const std::vector<long> &ids);
+
+  vpKltNative &operator=(const vpKltNative &copy);
+
+  void setBlockSize(int blockSize);
+  void setInitialGuess(const std::vector<vpImagePoint> &guess_pts);
+  void setInitialGuess(const std::vector<vpImagePoint> &init_pts, const std::vector<vpImagePoint> &guess_pts,
+                       const std::vector<long> &fid);
+  void setMaxFeatures(int maxCount);
+  void setMaxIterations(int maxIter);
+  void setMinDistance(double minDistance);
+  void setMinEigThreshold(double minEigThreshold);
+  void setPyramidLevels(int pyrMaxLevel);
+  void setQuality(double qualityLevel);
+  void setWindowSize(int winSize);
+  void suppressFeature(const int &index);
+  void track(const vpImage<unsigned char> &I);
+
+protected:
+  //! Previous [0] and current [1] keypoint abscissa
+  std::vector<float> m_pointsX[2];
+  //! Previous [0] and current [1] keypoint ordinate
+  std::vector<float> m_pointsY[2];
+  //! Keypoint id
+  std::vector<long> m_pointsId;
+  int m_maxCount;
+  int m_maxIter;
+  double m_epsilon;
+  int m_winSize;
+  double m_qualityLevel;
+  double m_minDistance;
+  double m_minEigThreshold;
+  int m_blockSize;
+  int m_pyrMaxLevel;
+  long m_nextPointsId;
+  bool m_initialGuess;
+  //! Gaussian pyramid of the current image
+  std::vector<vpImage<unsigned char> > m_pyramid;
+  //! Gaussian pyramid of the previous image
+  std::vector<vpImage<unsigned char> > m_prevPyramid;
+  //! Interleaved Scharr derivatives of each level of the previous pyramid
+  std::vector<std::vector<short> > m_prevDeriv;
+
+  void buildPyramid(const vpImage<unsigned char> &I);
+  void detectFeatures(const vpImage<unsigned char> *mask);
+  void refineCorners();
+  void swapPyramids();
+};
+
+#endif
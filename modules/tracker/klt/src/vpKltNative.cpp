@@ -0,0 +1,1316 @@
+/****************************************************************************
+ *
+ * ViSP, open source Visual Servoing Platform software.
+ * Copyright (C) 2005 - 2019 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Native KLT (Kanade-Lucas-Tomasi) feature tracker working on vpImage.
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpKltNative.cpp
+
+  \brief Native KLT (Kanade-Lucas-Tomasi) feature tracker that does not
+  require OpenCV.
+*/
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <sstream>
+
+#include <visp3/core/vpCPUFeatures.h>
+#include <visp3/core/vpDisplay.h>
+#include <visp3/core/vpMath.h>
+#include <visp3/core/vpTrackingException.h>
+#include <visp3/klt/vpKltNative.h>
+
+#if defined __SSE2__ || defined _M_X64 || (defined _M_IX86_FP && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define VISP_HAVE_SSE2 1
+#endif
+
+#define USE_SSE_CODE 1
+#if VISP_HAVE_SSE2 && USE_SSE_CODE
+#define USE_SSE 1
+#else
+#define USE_SSE 0
+#endif
+
+#if defined __ARM_NEON && defined __aarch64__
+#include <arm_neon.h>
+#define VISP_HAVE_NEON 1
+#endif
+
+namespace
+{
+inline int borderReflect101(int p, int len)
+{
+  if (len == 1) {
+    return 0;
+  }
+
+  while (p < 0 || p >= len) {
+    p = p < 0 ? -p : 2 * len - 2 - p;
+  }
+
+  return p;
+}
+
+#if USE_SSE
+inline __m128 loadU8x4(const unsigned char *ptr)
+{
+  int val;
+  memcpy(&val, ptr, sizeof(val));
+  const __m128i zero = _mm_setzero_si128();
+  __m128i v = _mm_unpacklo_epi8(_mm_cvtsi32_si128(val), zero);
+  return _mm_cvtepi32_ps(_mm_unpacklo_epi16(v, zero));
+}
+
+inline float horizontalSum(const __m128 &v)
+{
+  float tmp[4];
+  _mm_storeu_ps(tmp, v);
+  return (tmp[0] + tmp[1]) + (tmp[2] + tmp[3]);
+}
+#elif VISP_HAVE_NEON
+inline float32x4_t loadU8x4(const unsigned char *ptr)
+{
+  uint32_t val;
+  memcpy(&val, ptr, sizeof(val));
+  uint16x8_t v = vmovl_u8(vreinterpret_u8_u32(vdup_n_u32(val)));
+  return vcvtq_f32_u32(vmovl_u16(vget_low_u16(v)));
+}
+#endif
+
+// Gaussian 5x5 smoothing followed by a decimation by two, as cv::pyrDown()
+void pyrDown(const vpImage<unsigned char> &src, vpImage<unsigned char> &dst)
+{
+  const int sw = (int)src.getWidth(), sh = (int)src.getHeight();
+  const int dw = (sw + 1) / 2, dh = (sh + 1) / 2;
+  dst.resize((unsigned int)dh, (unsigned int)dw);
+
+  bool checkSSE2 = vpCPUFeatures::checkSSE2();
+#if !USE_SSE
+  checkSSE2 = false;
+#endif
+
+#ifdef VISP_HAVE_OPENMP
+#pragma omp parallel
+#endif
+  {
+    std::vector<unsigned short> buffer((size_t)sw + 4);
+    unsigned short *row = &buffer[2];
+
+#ifdef VISP_HAVE_OPENMP
+#pragma omp for
+#endif
+    for (int y = 0; y < dh; y++) {
+      const unsigned char *r0 = src.bitmap + borderReflect101(2 * y - 2, sh) * sw;
+      const unsigned char *r1 = src.bitmap + borderReflect101(2 * y - 1, sh) * sw;
+      const unsigned char *r2 = src.bitmap + borderReflect101(2 * y, sh) * sw;
+      const unsigned char *r3 = src.bitmap + borderReflect101(2 * y + 1, sh) * sw;
+      const unsigned char *r4 = src.bitmap + borderReflect101(2 * y + 2, sh) * sw;
+
+      // Vertical [1 4 6 4 1] filter
+      int x = 0;
+      if (checkSSE2) {
+#if USE_SSE
+        const __m128i zero = _mm_setzero_si128();
+        for (; x <= sw - 16; x += 16) {
+          const __m128i v0 = _mm_loadu_si128((const __m128i *)(r0 + x));
+          const __m128i v1 = _mm_loadu_si128((const __m128i *)(r1 + x));
+          const __m128i v2 = _mm_loadu_si128((const __m128i *)(r2 + x));
+          const __m128i v3 = _mm_loadu_si128((const __m128i *)(r3 + x));
+          const __m128i v4 = _mm_loadu_si128((const __m128i *)(r4 + x));
+
+          __m128i c2 = _mm_unpacklo_epi8(v2, zero);
+          __m128i s = _mm_add_epi16(_mm_unpacklo_epi8(v0, zero), _mm_unpacklo_epi8(v4, zero));
+          s = _mm_add_epi16(s, _mm_slli_epi16(_mm_add_epi16(_mm_unpacklo_epi8(v1, zero), _mm_unpacklo_epi8(v3, zero)), 2));
+          s = _mm_add_epi16(s, _mm_add_epi16(_mm_slli_epi16(c2, 2), _mm_slli_epi16(c2, 1)));
+          _mm_storeu_si128((__m128i *)(row + x), s);
+
+          c2 = _mm_unpackhi_epi8(v2, zero);
+          s = _mm_add_epi16(_mm_unpackhi_epi8(v0, zero), _mm_unpackhi_epi8(v4, zero));
+          s = _mm_add_epi16(s, _mm_slli_epi16(_mm_add_epi16(_mm_unpackhi_epi8(v1, zero), _mm_unpackhi_epi8(v3, zero)), 2));
+          s = _mm_add_epi16(s, _mm_add_epi16(_mm_slli_epi16(c2, 2), _mm_slli_epi16(c2, 1)));
+          _mm_storeu_si128((__m128i *)(row + x + 8), s);
+        }
+#endif
+      }
+#if VISP_HAVE_NEON
+      for (; x <= sw - 8; x += 8) {
+        uint16x8_t s = vaddl_u8(vld1_u8(r0 + x), vld1_u8(r4 + x));
+        s = vmlaq_n_u16(s, vaddl_u8(vld1_u8(r1 + x), vld1_u8(r3 + x)), 4);
+        s = vmlaq_n_u16(s, vmovl_u8(vld1_u8(r2 + x)), 6);
+        vst1q_u16(row + x, s);
+      }
+#endif
+      for (; x < sw; x++) {
+        row[x] = (unsigned short)(r0[x] + r4[x] + 4 * (r1[x] + r3[x]) + 6 * r2[x]);
+      }
+
+      row[-2] = row[borderReflect101(-2, sw)];
+      row[-1] = row[borderReflect101(-1, sw)];
+      row[sw] = row[borderReflect101(sw, sw)];
+      row[sw + 1] = row[borderReflect101(sw + 1, sw)];
+
+      // Horizontal [1 4 6 4 1] filter and decimation
+      unsigned char *d = dst.bitmap + y * dw;
+      for (int k = 0; k < dw; k++) {
+        const unsigned short *p = row + 2 * k;
+        d[k] = (unsigned char)((p[-2] + p[2] + 4 * (p[-1] + p[1]) + 6 * p[0] + 128) >> 8);
+      }
+    }
+  }
+}
+
+// Interleaved Scharr derivatives (dx, dy) with reflect 101 border
+void computeScharr(const vpImage<unsigned char> &src, std::vector<short> &deriv)
+{
+  const int w = (int)src.getWidth(), h = (int)src.getHeight();
+  deriv.resize(2 * (size_t)w * (size_t)h);
+
+  bool checkSSE2 = vpCPUFeatures::checkSSE2();
+#if !USE_SSE
+  checkSSE2 = false;
+#endif
+
+#ifdef VISP_HAVE_OPENMP
+#pragma omp parallel
+#endif
+  {
+    std::vector<short> buffer(2 * ((size_t)w + 2));
+    short *trow0 = &buffer[1];
+    short *trow1 = &buffer[(size_t)w + 3];
+
+#ifdef VISP_HAVE_OPENMP
+#pragma omp for
+#endif
+    for (int y = 0; y < h; y++) {
+      const unsigned char *r0 = src.bitmap + borderReflect101(y - 1, h) * w;
+      const unsigned char *r1 = src.bitmap + y * w;
+      const unsigned char *r2 = src.bitmap + borderReflect101(y + 1, h) * w;
+
+      // Vertical pass: [3 10 3] smoothing for dx, [-1 0 1] difference for dy
+      int x = 0;
+      if (checkSSE2) {
+#if USE_SSE
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i three = _mm_set1_epi16(3);
+        const __m128i ten = _mm_set1_epi16(10);
+        for (; x <= w - 8; x += 8) {
+          const __m128i v0 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(r0 + x)), zero);
+          const __m128i v1 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(r1 + x)), zero);
+          const __m128i v2 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(r2 + x)), zero);
+          const __m128i t0 = _mm_add_epi16(_mm_mullo_epi16(_mm_add_epi16(v0, v2), three), _mm_mullo_epi16(v1, ten));
+          _mm_storeu_si128((__m128i *)(trow0 + x), t0);
+          _mm_storeu_si128((__m128i *)(trow1 + x), _mm_sub_epi16(v2, v0));
+        }
+#endif
+      }
+#if VISP_HAVE_NEON
+      for (; x <= w - 8; x += 8) {
+        const int16x8_t v0 = vreinterpretq_s16_u16(vmovl_u8(vld1_u8(r0 + x)));
+        const int16x8_t v1 = vreinterpretq_s16_u16(vmovl_u8(vld1_u8(r1 + x)));
+        const int16x8_t v2 = vreinterpretq_s16_u16(vmovl_u8(vld1_u8(r2 + x)));
+        vst1q_s16(trow0 + x, vmlaq_n_s16(vmulq_n_s16(vaddq_s16(v0, v2), 3), v1, 10));
+        vst1q_s16(trow1 + x, vsubq_s16(v2, v0));
+      }
+#endif
+      for (; x < w; x++) {
+        trow0[x] = (short)(3 * (r0[x] + r2[x]) + 10 * r1[x]);
+        trow1[x] = (short)(r2[x] - r0[x]);
+      }
+
+      trow0[-1] = trow0[borderReflect101(-1, w)];
+      trow0[w] = trow0[borderReflect101(w, w)];
+      trow1[-1] = trow1[borderReflect101(-1, w)];
+      trow1[w] = trow1[borderReflect101(w, w)];
+
+      // Horizontal pass: [-1 0 1] difference for dx, [3 10 3] smoothing for dy
+      short *drow = &deriv[2 * (size_t)y * (size_t)w];
+      x = 0;
+      if (checkSSE2) {
+#if USE_SSE
+        const __m128i three = _mm_set1_epi16(3);
+        const __m128i ten = _mm_set1_epi16(10);
+        for (; x <= w - 8; x += 8) {
+          const __m128i dx = _mm_sub_epi16(_mm_loadu_si128((const __m128i *)(trow0 + x + 1)),
+                                           _mm_loadu_si128((const __m128i *)(trow0 + x - 1)));
+          const __m128i dy = _mm_add_epi16(
+              _mm_mullo_epi16(_mm_add_epi16(_mm_loadu_si128((const __m128i *)(trow1 + x - 1)),
+                                            _mm_loadu_si128((const __m128i *)(trow1 + x + 1))),
+                              three),
+              _mm_mullo_epi16(_mm_loadu_si128((const __m128i *)(trow1 + x)), ten));
+          _mm_storeu_si128((__m128i *)(drow + 2 * x), _mm_unpacklo_epi16(dx, dy));
+          _mm_storeu_si128((__m128i *)(drow + 2 * x + 8), _mm_unpackhi_epi16(dx, dy));
+        }
+#endif
+      }
+#if VISP_HAVE_NEON
+      for (; x <= w - 8; x += 8) {
+        int16x8x2_t d;
+        d.val[0] = vsubq_s16(vld1q_s16(trow0 + x + 1), vld1q_s16(trow0 + x - 1));
+        d.val[1] = vmlaq_n_s16(vmulq_n_s16(vaddq_s16(vld1q_s16(trow1 + x - 1), vld1q_s16(trow1 + x + 1)), 3),
+                               vld1q_s16(trow1 + x), 10);
+        vst2q_s16(drow + 2 * x, d);
+      }
+#endif
+      for (; x < w; x++) {
+        drow[2 * x] = (short)(trow0[x + 1] - trow0[x - 1]);
+        drow[2 * x + 1] = (short)(3 * (trow1[x - 1] + trow1[x + 1]) + 10 * trow1[x]);
+      }
+    }
+  }
+}
+
+// Minimal eigenvalue of the gradient covariance matrix, as cv::cornerMinEigenVal() with a 3x3 Sobel aperture
+void computeMinEigenValues(const vpImage<unsigned char> &I, int blockSize, std::vector<float> &eig)
+{
+  const int w = (int)I.getWidth(), h = (int)I.getHeight();
+  const size_t size = (size_t)w * (size_t)h;
+  const float scale = (float)(1.0 / (4.0 * blockSize * 255.0));
+  const int anchor = blockSize / 2;
+
+  // Horizontally box filtered dx*dx, dx*dy and dy*dy
+  std::vector<float> cov(3 * size);
+  eig.resize(size);
+
+#ifdef VISP_HAVE_OPENMP
+#pragma omp parallel
+#endif
+  {
+    std::vector<float> products(3 * (size_t)w);
+
+#ifdef VISP_HAVE_OPENMP
+#pragma omp for
+#endif
+    for (int y = 0; y < h; y++) {
+      const unsigned char *r0 = I.bitmap + borderReflect101(y - 1, h) * w;
+      const unsigned char *r1 = I.bitmap + y * w;
+      const unsigned char *r2 = I.bitmap + borderReflect101(y + 1, h) * w;
+
+      for (int x = 0; x < w; x++) {
+        const int xm = x > 0 ? x - 1 : borderReflect101(-1, w);
+        const int xp = x < w - 1 ? x + 1 : borderReflect101(w, w);
+        const float dx = scale * ((r0[xp] + 2 * r1[xp] + r2[xp]) - (r0[xm] + 2 * r1[xm] + r2[xm]));
+        const float dy = scale * ((r2[xm] + 2 * r2[x] + r2[xp]) - (r0[xm] + 2 * r0[x] + r0[xp]));
+        products[3 * x] = dx * dx;
+        products[3 * x + 1] = dx * dy;
+        products[3 * x + 2] = dy * dy;
+      }
+
+      float *a = &cov[(size_t)y * w];
+      float *b = a + size;
+      float *c = b + size;
+      for (int x = 0; x < w; x++) {
+        float sa = 0.f, sb = 0.f, sc = 0.f;
+        for (int k = -anchor; k < blockSize - anchor; k++) {
+          const float *p = &products[3 * borderReflect101(x + k, w)];
+          sa += p[0];
+          sb += p[1];
+          sc += p[2];
+        }
+        a[x] = sa;
+        b[x] = sb;
+        c[x] = sc;
+      }
+    }
+  }
+
+  bool checkSSE2 = vpCPUFeatures::checkSSE2();
+#if !USE_SSE
+  checkSSE2 = false;
+#endif
+
+#ifdef VISP_HAVE_OPENMP
+#pragma omp parallel
+#endif
+  {
+    std::vector<float> sums(3 * (size_t)w);
+    float *sa = &sums[0];
+    float *sb = sa + w;
+    float *sc = sb + w;
+
+#ifdef VISP_HAVE_OPENMP
+#pragma omp for
+#endif
+    for (int y = 0; y < h; y++) {
+      std::fill(sums.begin(), sums.end(), 0.f);
+      for (int k = -anchor; k < blockSize - anchor; k++) {
+        const float *a = &cov[(size_t)borderReflect101(y + k, h) * w];
+        const float *b = a + size;
+        const float *c = b + size;
+        for (int x = 0; x < w; x++) {
+          sa[x] += a[x];
+          sb[x] += b[x];
+          sc[x] += c[x];
+        }
+      }
+
+      float *e = &eig[(size_t)y * w];
+      int x = 0;
+      if (checkSSE2) {
+#if USE_SSE
+        const __m128 half = _mm_set1_ps(0.5f);
+        for (; x <= w - 4; x += 4) {
+          const __m128 a = _mm_mul_ps(_mm_loadu_ps(sa + x), half);
+          const __m128 b = _mm_loadu_ps(sb + x);
+          const __m128 c = _mm_mul_ps(_mm_loadu_ps(sc + x), half);
+          const __m128 d = _mm_sub_ps(a, c);
+          const __m128 r = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(d, d), _mm_mul_ps(b, b)));
+          _mm_storeu_ps(e + x, _mm_sub_ps(_mm_add_ps(a, c), r));
+        }
+#endif
+      }
+#if VISP_HAVE_NEON
+      for (; x <= w - 4; x += 4) {
+        const float32x4_t a = vmulq_n_f32(vld1q_f32(sa + x), 0.5f);
+        const float32x4_t b = vld1q_f32(sb + x);
+        const float32x4_t c = vmulq_n_f32(vld1q_f32(sc + x), 0.5f);
+        const float32x4_t d = vsubq_f32(a, c);
+        const float32x4_t r = vsqrtq_f32(vmlaq_f32(vmulq_f32(d, d), b, b));
+        vst1q_f32(e + x, vsubq_f32(vaddq_f32(a, c), r));
+      }
+#endif
+      for (; x < w; x++) {
+        const float a = sa[x] * 0.5f, b = sb[x], c = sc[x] * 0.5f;
+        e[x] = (a + c) - std::sqrt((a - c) * (a - c) + b * b);
+      }
+    }
+  }
+}
+
+struct vpCornerCandidate {
+  float value;
+  int index;
+};
+
+inline bool greaterCorner(const vpCornerCandidate &a, const vpCornerCandidate &b)
+{
+  return a.value > b.value || (a.value == b.value && a.index > b.index);
+}
+
+// Bilinear interpolation with replicated border
+inline float interpolate(const vpImage<unsigned char> &I, float x, float y)
+{
+  const int w = (int)I.getWidth(), h = (int)I.getHeight();
+  const int ix = (int)std::floor(x), iy = (int)std::floor(y);
+  const float a = x - ix, b = y - iy;
+  const int x0 = std::min(std::max(ix, 0), w - 1), x1 = std::min(std::max(ix + 1, 0), w - 1);
+  const int y0 = std::min(std::max(iy, 0), h - 1), y1 = std::min(std::max(iy + 1, 0), h - 1);
+  const unsigned char *p0 = I.bitmap + y0 * w, *p1 = I.bitmap + y1 * w;
+
+  return (1.f - b) * ((1.f - a) * p0[x0] + a * p0[x1]) + b * ((1.f - a) * p1[x0] + a * p1[x1]);
+}
+
+// Image mismatch vector b = sum (J - I) * [Ix Iy] over the integration window
+void computeMismatch(const unsigned char *J, int stride, int winSize, float w00, float w01, float w10, float w11,
+                     const float *Iwin, const float *IxWin, const float *IyWin, float &b1, float &b2, bool checkSSE2)
+{
+  b1 = 0.f;
+  b2 = 0.f;
+
+#if USE_SSE
+  const __m128 vw00 = _mm_set1_ps(w00), vw01 = _mm_set1_ps(w01), vw10 = _mm_set1_ps(w10), vw11 = _mm_set1_ps(w11);
+  __m128 vb1 = _mm_setzero_ps(), vb2 = _mm_setzero_ps();
+#elif VISP_HAVE_NEON
+  float32x4_t vb1 = vdupq_n_f32(0.f), vb2 = vdupq_n_f32(0.f);
+  (void)checkSSE2;
+#else
+  (void)checkSSE2;
+#endif
+
+  for (int y = 0; y < winSize; y++) {
+    const unsigned char *j0 = J + y * stride;
+    const unsigned char *j1 = j0 + stride;
+    const float *Iw = Iwin + y * winSize;
+    const float *Ixw = IxWin + y * winSize;
+    const float *Iyw = IyWin + y * winSize;
+
+    int x = 0;
+#if USE_SSE
+    if (checkSSE2) {
+      for (; x <= winSize - 4; x += 4) {
+        __m128 val = _mm_add_ps(_mm_mul_ps(loadU8x4(j0 + x), vw00), _mm_mul_ps(loadU8x4(j0 + x + 1), vw01));
+        val = _mm_add_ps(val, _mm_add_ps(_mm_mul_ps(loadU8x4(j1 + x), vw10), _mm_mul_ps(loadU8x4(j1 + x + 1), vw11)));
+        const __m128 diff = _mm_sub_ps(val, _mm_loadu_ps(Iw + x));
+        vb1 = _mm_add_ps(vb1, _mm_mul_ps(diff, _mm_loadu_ps(Ixw + x)));
+        vb2 = _mm_add_ps(vb2, _mm_mul_ps(diff, _mm_loadu_ps(Iyw + x)));
+      }
+    }
+#elif VISP_HAVE_NEON
+    for (; x <= winSize - 4; x += 4) {
+      float32x4_t val = vmulq_n_f32(loadU8x4(j0 + x), w00);
+      val = vmlaq_n_f32(val, loadU8x4(j0 + x + 1), w01);
+      val = vmlaq_n_f32(val, loadU8x4(j1 + x), w10);
+      val = vmlaq_n_f32(val, loadU8x4(j1 + x + 1), w11);
+      const float32x4_t diff = vsubq_f32(val, vld1q_f32(Iw + x));
+      vb1 = vmlaq_f32(vb1, diff, vld1q_f32(Ixw + x));
+      vb2 = vmlaq_f32(vb2, diff, vld1q_f32(Iyw + x));
+    }
+#endif
+    for (; x < winSize; x++) {
+      const float diff = w00 * j0[x] + w01 * j0[x + 1] + w10 * j1[x] + w11 * j1[x + 1] - Iw[x];
+      b1 += diff * Ixw[x];
+      b2 += diff * Iyw[x];
+    }
+  }
+
+#if USE_SSE
+  if (checkSSE2) {
+    b1 += horizontalSum(vb1);
+    b2 += horizontalSum(vb2);
+  }
+#elif VISP_HAVE_NEON
+  b1 += vaddvq_f32(vb1);
+  b2 += vaddvq_f32(vb2);
+#endif
+}
+
+// Iterative pyramidal Lucas-Kanade of a single feature (Bouguet's formulation)
+bool trackFeature(const std::vector<vpImage<unsigned char> > &prevPyramid,
+                  const std::vector<std::vector<short> > &prevDeriv, const std::vector<vpImage<unsigned char> > &pyramid,
+                  int maxLevel, int winSize, int maxIter, float epsilon, float minEigThreshold, bool useInitialFlow,
+                  float prevX, float prevY, float &nextX, float &nextY, float *buffer, bool checkSSE2)
+{
+  const float halfWin = (winSize - 1) * 0.5f;
+  const int winArea = winSize * winSize;
+  float *Iwin = buffer;
+  float *IxWin = buffer + winArea;
+  float *IyWin = buffer + 2 * winArea;
+  // Scharr derivatives are 32 times the intensity gradient
+  const float derivScale = 1.f / 32.f;
+  bool status = true;
+
+  for (int level = maxLevel; level >= 0; level--) {
+    const float scale = 1.f / (1 << level);
+    float nx, ny;
+    if (level == maxLevel) {
+      nx = (useInitialFlow ? nextX : prevX) * scale;
+      ny = (useInitialFlow ? nextY : prevY) * scale;
+    } else {
+      nx = nextX * 2.f;
+      ny = nextY * 2.f;
+    }
+    nextX = nx;
+    nextY = ny;
+
+    const vpImage<unsigned char> &I = prevPyramid[(size_t)level];
+    const vpImage<unsigned char> &J = pyramid[(size_t)level];
+    const int w = (int)I.getWidth(), h = (int)I.getHeight();
+
+    const float px = prevX * scale - halfWin, py = prevY * scale - halfWin;
+    const int ipx = (int)std::floor(px), ipy = (int)std::floor(py);
+    if (ipx < 0 || ipy < 0 || ipx + winSize >= w || ipy + winSize >= h) {
+      if (level == 0) {
+        status = false;
+      }
+      continue;
+    }
+
+    float a = px - ipx, b = py - ipy;
+    float w00 = (1.f - a) * (1.f - b), w01 = a * (1.f - b), w10 = (1.f - a) * b, w11 = a * b;
+
+    // Template and gradient at the previous location, and spatial gradient matrix
+    float A11 = 0.f, A12 = 0.f, A22 = 0.f;
+    const unsigned char *src = I.bitmap + ipy * w + ipx;
+    const short *dsrc = &prevDeriv[(size_t)level][2 * ((size_t)ipy * w + ipx)];
+    for (int y = 0, k = 0; y < winSize; y++) {
+      const unsigned char *s0 = src + y * w;
+      const unsigned char *s1 = s0 + w;
+      const short *d0 = dsrc + 2 * y * w;
+      const short *d1 = d0 + 2 * w;
+
+      for (int x = 0; x < winSize; x++, k++) {
+        Iwin[k] = w00 * s0[x] + w01 * s0[x + 1] + w10 * s1[x] + w11 * s1[x + 1];
+        const float ix =
+            derivScale * (w00 * d0[2 * x] + w01 * d0[2 * x + 2] + w10 * d1[2 * x] + w11 * d1[2 * x + 2]);
+        const float iy =
+            derivScale * (w00 * d0[2 * x + 1] + w01 * d0[2 * x + 3] + w10 * d1[2 * x + 1] + w11 * d1[2 * x + 3]);
+        IxWin[k] = ix;
+        IyWin[k] = iy;
+        A11 += ix * ix;
+        A12 += ix * iy;
+        A22 += iy * iy;
+      }
+    }
+
+    // Same normalization as cv::calcOpticalFlowPyrLK() for the minimal eigenvalue threshold
+    const float D = A11 * A22 - A12 * A12;
+    const float minEig =
+        (A22 + A11 - std::sqrt((A11 - A22) * (A11 - A22) + 4.f * A12 * A12)) / (2.f * winArea * 1024.f);
+    if (minEig < minEigThreshold || D / (1024.f * 1024.f) < FLT_EPSILON) {
+      if (level == 0) {
+        status = false;
+      }
+      continue;
+    }
+
+    const float invD = 1.f / D;
+    nx -= halfWin;
+    ny -= halfWin;
+    float prevDeltaX = 0.f, prevDeltaY = 0.f;
+
+    for (int iter = 0; iter < maxIter; iter++) {
+      const int inx = (int)std::floor(nx), iny = (int)std::floor(ny);
+      if (inx < 0 || iny < 0 || inx + winSize >= w || iny + winSize >= h) {
+        if (level == 0) {
+          status = false;
+        }
+        break;
+      }
+
+      a = nx - inx;
+      b = ny - iny;
+      w00 = (1.f - a) * (1.f - b);
+      w01 = a * (1.f - b);
+      w10 = (1.f - a) * b;
+      w11 = a * b;
+
+      float b1, b2;
+      computeMismatch(J.bitmap + iny * w + inx, w, winSize, w00, w01, w10, w11, Iwin, IxWin, IyWin, b1, b2,
+                      checkSSE2);
+
+      const float deltaX = (A12 * b2 - A22 * b1) * invD;
+      const float deltaY = (A12 * b1 - A11 * b2) * invD;
+      nx += deltaX;
+      ny += deltaY;
+      nextX = nx + halfWin;
+      nextY = ny + halfWin;
+
+      if (deltaX * deltaX + deltaY * deltaY <= epsilon) {
+        break;
+      }
+
+      if (iter > 0 && std::fabs(deltaX + prevDeltaX) < 0.01f && std::fabs(deltaY + prevDeltaY) < 0.01f) {
+        nextX -= deltaX * 0.5f;
+        nextY -= deltaY * 0.5f;
+        break;
+      }
+
+      prevDeltaX = deltaX;
+      prevDeltaY = deltaY;
+    }
+  }
+
+  return status;
+}
+} // namespace
+
+/*!
+  Default constructor.
+ */
+vpKltNative::vpKltNative()
+  : m_pointsId(), m_maxCount(500), m_maxIter(20), m_epsilon(0.03), m_winSize(10), m_qualityLevel(0.01),
+    m_minDistance(15), m_minEigThreshold(1e-4), m_blockSize(3), m_pyrMaxLevel(3), m_nextPointsId(0),
+    m_initialGuess(false), m_pyramid(), m_prevPyramid(), m_prevDeriv()
+{
+}
+
+/*!
+  Copy constructor.
+ */
+vpKltNative::vpKltNative(const vpKltNative &copy)
+  : m_pointsId(), m_maxCount(500), m_maxIter(20), m_epsilon(0.03), m_winSize(10), m_qualityLevel(0.01),
+    m_minDistance(15), m_minEigThreshold(1e-4), m_blockSize(3), m_pyrMaxLevel(3), m_nextPointsId(0),
+    m_initialGuess(false), m_pyramid(), m_prevPyramid(), m_prevDeriv()
+{
+  *this = copy;
+}
+
+vpKltNative::~vpKltNative() {}
+
+/*!
+  Copy operator.
+ */
+vpKltNative &vpKltNative::operator=(const vpKltNative &copy)
+{
+  for (size_t i = 0; i < 2; i++) {
+    m_pointsX[i] = copy.m_pointsX[i];
+    m_pointsY[i] = copy.m_pointsY[i];
+  }
+  m_pointsId = copy.m_pointsId;
+  m_maxCount = copy.m_maxCount;
+  m_maxIter = copy.m_maxIter;
+  m_epsilon = copy.m_epsilon;
+  m_winSize = copy.m_winSize;
+  m_qualityLevel = copy.m_qualityLevel;
+  m_minDistance = copy.m_minDistance;
+  m_minEigThreshold = copy.m_minEigThreshold;
+  m_blockSize = copy.m_blockSize;
+  m_pyrMaxLevel = copy.m_pyrMaxLevel;
+  m_nextPointsId = copy.m_nextPointsId;
+  m_initialGuess = copy.m_initialGuess;
+  m_pyramid = copy.m_pyramid;
+  m_prevPyramid = copy.m_prevPyramid;
+  m_prevDeriv = copy.m_prevDeriv;
+
+  return *this;
+}
+
+/*!
+  Add a keypoint at the end of the feature list. The id of the feature is set
+  to ensure that it is unique.
+
+  \param x,y : Coordinates of the feature in the image.
+*/
+void vpKltNative::addFeature(const float &x, const float &y)
+{
+  m_pointsX[1].push_back(x);
+  m_pointsY[1].push_back(y);
+  m_pointsId.push_back(m_nextPointsId++);
+}
+
+/*!
+  Add a keypoint at the end of the feature list.
+
+  \warning This function doesn't ensure that the id of the feature is unique.
+  You should rather use addFeature(const float &, const float &).
+
+  \param id : Feature id. Should be unique
+  \param x,y : Coordinates of the feature in the image.
+*/
+void vpKltNative::addFeature(const long &id, const float &x, const float &y)
+{
+  m_pointsX[1].push_back(x);
+  m_pointsY[1].push_back(y);
+  m_pointsId.push_back(id);
+  if (id >= m_nextPointsId)
+    m_nextPointsId = id + 1;
+}
+
+/*!
+  Build the Gaussian pyramid of the current image, reusing the memory of the
+  previous levels when the image size does not change.
+
+  \param I : Input image.
+*/
+void vpKltNative::buildPyramid(const vpImage<unsigned char> &I)
+{
+  size_t nbLevels = 1;
+  unsigned int w = I.getWidth(), h = I.getHeight();
+  for (int level = 1; level <= m_pyrMaxLevel; level++) {
+    w = (w + 1) / 2;
+    h = (h + 1) / 2;
+    if (w <= (unsigned int)m_winSize || h <= (unsigned int)m_winSize) {
+      break;
+    }
+    nbLevels++;
+  }
+
+  m_pyramid.resize(nbLevels);
+  m_pyramid[0] = I;
+  for (size_t level = 1; level < nbLevels; level++) {
+    pyrDown(m_pyramid[level - 1], m_pyramid[level]);
+  }
+}
+
+/*!
+  Detect Shi-Tomasi corners on the finest level of the current pyramid.
+
+  \param mask : Optional mask. Only pixels with a non zero value are considered.
+*/
+void vpKltNative::detectFeatures(const vpImage<unsigned char> *mask)
+{
+  const vpImage<unsigned char> &I = m_pyramid[0];
+  const int w = (int)I.getWidth(), h = (int)I.getHeight();
+
+  std::vector<float> eig;
+  computeMinEigenValues(I, m_blockSize, eig);
+
+  // As in cv::goodFeaturesToTrack(), the quality threshold is relative to the
+  // strongest corner inside the mask
+  float maxVal = 0.f;
+  for (size_t i = 0; i < eig.size(); i++) {
+    if (mask == NULL || mask->bitmap[i] != 0) {
+      maxVal = std::max(maxVal, eig[i]);
+    }
+  }
+  const float threshold = (float)(maxVal * m_qualityLevel);
+
+  // Non-maximum suppression in a 3x3 neighborhood
+  std::vector<vpCornerCandidate> candidates;
+  for (int y = 1; y < h - 1; y++) {
+    const float *e = &eig[(size_t)y * w];
+    for (int x = 1; x < w - 1; x++) {
+      const float val = e[x];
+      if (val > threshold && val > 0.f && (mask == NULL || (*mask)[y][x] != 0) && val >= e[x - 1] &&
+          val >= e[x + 1] && val >= e[x - w - 1] && val >= e[x - w] && val >= e[x - w + 1] && val >= e[x + w - 1] &&
+          val >= e[x + w] && val >= e[x + w + 1]) {
+        vpCornerCandidate candidate;
+        candidate.value = val;
+        candidate.index = y * w + x;
+        candidates.push_back(candidate);
+      }
+    }
+  }
+  std::sort(candidates.begin(), candidates.end(), greaterCorner);
+
+  const size_t maxCount = m_maxCount > 0 ? (size_t)m_maxCount : candidates.size();
+  if (m_minDistance >= 1) {
+    // Grid of already accepted corners to enforce the minimal distance
+    const int cellSize = vpMath::round(m_minDistance);
+    const int gridWidth = (w + cellSize - 1) / cellSize;
+    const int gridHeight = (h + cellSize - 1) / cellSize;
+    const float minDist2 = (float)(m_minDistance * m_minDistance);
+    std::vector<std::vector<std::pair<float, float> > > grid((size_t)(gridWidth * gridHeight));
+
+    for (size_t i = 0; i < candidates.size() && m_pointsX[1].size() < maxCount; i++) {
+      const float x = (float)(candidates[i].index % w), y = (float)(candidates[i].index / w);
+      const int xCell = (int)x / cellSize, yCell = (int)y / cellSize;
+      const int x1 = std::max(xCell - 1, 0), y1 = std::max(yCell - 1, 0);
+      const int x2 = std::min(xCell + 1, gridWidth - 1), y2 = std::min(yCell + 1, gridHeight - 1);
+
+      bool good = true;
+      for (int yy = y1; yy <= y2 && good; yy++) {
+        for (int xx = x1; xx <= x2 && good; xx++) {
+          const std::vector<std::pair<float, float> > &cell = grid[(size_t)(yy * gridWidth + xx)];
+          for (size_t k = 0; k < cell.size(); k++) {
+            const float dx = x - cell[k].first, dy = y - cell[k].second;
+            if (dx * dx + dy * dy < minDist2) {
+              good = false;
+              break;
+            }
+          }
+        }
+      }
+
+      if (good) {
+        grid[(size_t)(yCell * gridWidth + xCell)].push_back(std::make_pair(x, y));
+        m_pointsX[1].push_back(x);
+        m_pointsY[1].push_back(y);
+      }
+    }
+  } else {
+    for (size_t i = 0; i < candidates.size() && i < maxCount; i++) {
+      m_pointsX[1].push_back((float)(candidates[i].index % w));
+      m_pointsY[1].push_back((float)(candidates[i].index / w));
+    }
+  }
+}
+
+/*!
+  Display features position and id.
+
+  \param I : Image used as background. Display should be initialized on it.
+  \param color : Color used to display the features.
+  \param thickness : Thickness of the drawings.
+*/
+void vpKltNative::display(const vpImage<unsigned char> &I, const vpColor &color, unsigned int thickness) const
+{
+  vpImagePoint ip;
+  for (size_t i = 0; i < m_pointsX[1].size(); i++) {
+    ip.set_u(vpMath::round(m_pointsX[1][i]));
+    ip.set_v(vpMath::round(m_pointsY[1][i]));
+    vpDisplay::displayCross(I, ip, 10, color, thickness);
+
+    std::ostringstream id;
+    id << m_pointsId[i];
+    ip.set_u(vpMath::round(m_pointsX[1][i] + 5));
+    vpDisplay::displayText(I, ip, id.str(), color);
+  }
+}
+
+/*!
+  Display features position and id.
+
+  \param I : Image used as background. Display should be initialized on it.
+  \param color : Color used to display the features.
+  \param thickness : Thickness of the drawings.
+*/
+void vpKltNative::display(const vpImage<vpRGBa> &I, const vpColor &color, unsigned int thickness) const
+{
+  vpImagePoint ip;
+  for (size_t i = 0; i < m_pointsX[1].size(); i++) {
+    ip.set_u(vpMath::round(m_pointsX[1][i]));
+    ip.set_v(vpMath::round(m_pointsY[1][i]));
+    vpDisplay::displayCross(I, ip, 10, color, thickness);
+
+    std::ostringstream id;
+    id << m_pointsId[i];
+    ip.set_u(vpMath::round(m_pointsX[1][i] + 5));
+    vpDisplay::displayText(I, ip, id.str(), color);
+  }
+}
+
+/*!
+  Get the 'index'th feature image coordinates. Beware that
+  getFeature(i,...) may not represent the same feature before and
+  after a tracking iteration (if a feature is lost, features are
+  shifted in the array).
+
+  \param index : Index of feature.
+  \param id : id of the feature.
+  \param x : x coordinate.
+  \param y : y coordinate.
+*/
+void vpKltNative::getFeature(const int &index, long &id, float &x, float &y) const
+{
+  if ((size_t)index >= m_pointsX[1].size()) {
+    throw(vpException(vpException::badValue, "Feature [%d] doesn't exist", index));
+  }
+
+  x = m_pointsX[1][(size_t)index];
+  y = m_pointsY[1][(size_t)index];
+  id = m_pointsId[(size_t)index];
+}
+
+/*!
+  Get the list of current features.
+*/
+std::vector<vpImagePoint> vpKltNative::getFeatures() const
+{
+  std::vector<vpImagePoint> features(m_pointsX[1].size());
+  for (size_t i = 0; i < features.size(); i++) {
+    features[i].set_ij(m_pointsY[1][i], m_pointsX[1][i]);
+  }
+
+  return features;
+}
+
+/*!
+  Initialise the tracking by extracting Shi-Tomasi keypoints on the provided
+  image. The detected corners are refined at sub-pixel accuracy.
+
+  \param I : Grey level image used as input.
+  \param mask : Image mask used to restrict the keypoint detection area.
+  Pixels with a non zero value are considered. If mask is NULL, all the image
+  is considered.
+
+  \exception vpException::dimensionError : If the mask size differs from the
+  image size.
+*/
+void vpKltNative::initTracking(const vpImage<unsigned char> &I, const vpImage<unsigned char> *mask)
+{
+  if (mask != NULL && (mask->getWidth() != I.getWidth() || mask->getHeight() != I.getHeight())) {
+    throw(vpException(vpException::dimensionError, "Mask size (%dx%d) differs from image size (%dx%d)",
+                      mask->getWidth(), mask->getHeight(), I.getWidth(), I.getHeight()));
+  }
+
+  m_initialGuess = false;
+  m_nextPointsId = 0;
+  for (size_t i = 0; i < 2; i++) {
+    m_pointsX[i].clear();
+    m_pointsY[i].clear();
+  }
+  m_pointsId.clear();
+
+  buildPyramid(I);
+  detectFeatures(mask);
+  refineCorners();
+
+  for (size_t i = 0; i < m_pointsX[1].size(); i++) {
+    m_pointsId.push_back(m_nextPointsId++);
+  }
+
+  swapPyramids();
+}
+
+/*!
+  Set the points that will be used as initialization during the next call to
+  track().
+
+  \param I : Input image.
+  \param pts : Vector of points that should be tracked.
+*/
+void vpKltNative::initTracking(const vpImage<unsigned char> &I, const std::vector<vpImagePoint> &pts)
+{
+  initTracking(I, pts, std::vector<long>());
+}
+
+/*!
+  Set the points that will be used as initialization during the next call to
+  track().
+
+  \param I : Input image.
+  \param pts : Vector of points that should be tracked.
+  \param ids : Corresponding point ids. If the size differs from the number of
+  points, new ids are generated.
+*/
+void vpKltNative::initTracking(const vpImage<unsigned char> &I, const std::vector<vpImagePoint> &pts,
+                               const std::vector<long> &ids)
+{
+  m_initialGuess = false;
+  m_pointsX[1].resize(pts.size());
+  m_pointsY[1].resize(pts.size());
+  for (size_t i = 0; i < pts.size(); i++) {
+    m_pointsX[1][i] = (float)pts[i].get_u();
+    m_pointsY[1][i] = (float)pts[i].get_v();
+  }
+  m_pointsId.clear();
+
+  if (ids.size() != pts.size()) {
+    m_nextPointsId = 0;
+    for (size_t i = 0; i < pts.size(); i++)
+      m_pointsId.push_back(m_nextPointsId++);
+  } else {
+    long max = 0;
+    for (size_t i = 0; i < pts.size(); i++) {
+      m_pointsId.push_back(ids[i]);
+      if (ids[i] > max)
+        max = ids[i];
+    }
+    m_nextPointsId = max + 1;
+  }
+
+  buildPyramid(I);
+  swapPyramids();
+}
+
+/*!
+  Refine the location of the detected corners at sub-pixel accuracy, as
+  cv::cornerSubPix() with a (2*winSize+1) x (2*winSize+1) search window.
+*/
+void vpKltNative::refineCorners()
+{
+  const vpImage<unsigned char> &I = m_pyramid[0];
+  const int halfWin = m_winSize;
+  const int winW = 2 * halfWin + 1;
+  const float eps = (float)(m_epsilon * m_epsilon);
+
+  std::vector<float> weights((size_t)(winW * winW));
+  for (int i = 0, k = 0; i < winW; i++) {
+    const float y = (float)(i - halfWin) / halfWin;
+    const float vy = std::exp(-y * y);
+    for (int j = 0; j < winW; j++, k++) {
+      const float x = (float)(j - halfWin) / halfWin;
+      weights[(size_t)k] = vy * std::exp(-x * x);
+    }
+  }
+
+  const int nbPoints = (int)m_pointsX[1].size();
+#ifdef VISP_HAVE_OPENMP
+#pragma omp parallel
+#endif
+  {
+    std::vector<float> patch((size_t)((winW + 2) * (winW + 2)));
+
+#ifdef VISP_HAVE_OPENMP
+#pragma omp for
+#endif
+    for (int n = 0; n < nbPoints; n++) {
+      const float cx = m_pointsX[1][(size_t)n], cy = m_pointsY[1][(size_t)n];
+      float x = cx, y = cy;
+
+      for (int iter = 0; iter < m_maxIter; iter++) {
+        for (int i = 0, k = 0; i < winW + 2; i++) {
+          for (int j = 0; j < winW + 2; j++, k++) {
+            patch[(size_t)k] = interpolate(I, x + j - halfWin - 1, y + i - halfWin - 1);
+          }
+        }
+
+        double a = 0, b = 0, c = 0, bb1 = 0, bb2 = 0;
+        for (int i = 0, k = 0; i < winW; i++) {
+          const float *p = &patch[(size_t)((i + 1) * (winW + 2) + 1)];
+          const double py = i - halfWin;
+          for (int j = 0; j < winW; j++, k++) {
+            const double m = weights[(size_t)k];
+            const double tgx = p[j + 1] - p[j - 1];
+            const double tgy = p[j + winW + 2] - p[j - winW - 2];
+            const double gxx = tgx * tgx * m, gxy = tgx * tgy * m, gyy = tgy * tgy * m;
+            const double px = j - halfWin;
+            a += gxx;
+            b += gxy;
+            c += gyy;
+            bb1 += gxx * px + gxy * py;
+            bb2 += gxy * px + gyy * py;
+          }
+        }
+
+        const double det = a * c - b * b;
+        if (std::fabs(det) <= DBL_EPSILON * DBL_EPSILON) {
+          break;
+        }
+
+        const double scale = 1.0 / det;
+        const float x2 = (float)(x + c * scale * bb1 - b * scale * bb2);
+        const float y2 = (float)(y - b * scale * bb1 + a * scale * bb2);
+        const float err = (x2 - x) * (x2 - x) + (y2 - y) * (y2 - y);
+        x = x2;
+        y = y2;
+        if (x < 0 || x >= I.getWidth() || y < 0 || y >= I.getHeight() || err <= eps) {
+          break;
+        }
+      }
+
+      // Keep the initial location on poor convergence
+      if (std::fabs(x - cx) > halfWin || std::fabs(y - cy) > halfWin) {
+        x = cx;
+        y = cy;
+      }
+      m_pointsX[1][(size_t)n] = x;
+      m_pointsY[1][(size_t)n] = y;
+    }
+  }
+}
+
+/*!
+  Set the size of the averaging block used to detect the features.
+
+  \param blockSize : Size of an average block for computing a derivative
+  covariation matrix over each pixel neighborhood. Default value is set to 3.
+*/
+void vpKltNative::setBlockSize(int blockSize) { m_blockSize = std::max(blockSize, 1); }
+
+/*!
+  Set the points that will be used as initial guess during the next call to
+  track(). The current features are tracked from their current location in
+  the previous image.
+
+  \param guess_pts : Prediction of the new position of the current features.
+  The size of this vector should be the same as the one returned by
+  getNbFeatures(). If this is not the case, an exception is returned.
+*/
+void vpKltNative::setInitialGuess(const std::vector<vpImagePoint> &guess_pts)
+{
+  if (guess_pts.size() != m_pointsX[1].size()) {
+    throw(vpException(vpException::badValue,
+                      "Cannot set initial guess: size feature vector [%d] "
+                      "and guess vector [%d] doesn't match",
+                      m_pointsX[1].size(), guess_pts.size()));
+  }
+
+  m_pointsX[0] = m_pointsX[1];
+  m_pointsY[0] = m_pointsY[1];
+  for (size_t i = 0; i < guess_pts.size(); i++) {
+    m_pointsX[1][i] = (float)guess_pts[i].get_u();
+    m_pointsY[1][i] = (float)guess_pts[i].get_v();
+  }
+  m_initialGuess = true;
+}
+
+/*!
+  Set the points that will be used as initial guess during the next call to
+  track().
+
+  \param init_pts : Location of the features in the previous image.
+  \param guess_pts : Prediction of the new position of the initial points. The
+  size of this vector must be the same as the size of the vector of initial
+  points.
+  \param fid : Identifiers of the initial points.
+*/
+void vpKltNative::setInitialGuess(const std::vector<vpImagePoint> &init_pts,
+                                  const std::vector<vpImagePoint> &guess_pts, const std::vector<long> &fid)
+{
+  if (guess_pts.size() != init_pts.size()) {
+    throw(vpException(vpException::badValue,
+                      "Cannot set initial guess: size init vector [%d] and "
+                      "guess vector [%d] doesn't match",
+                      init_pts.size(), guess_pts.size()));
+  }
+
+  for (size_t i = 0; i < 2; i++) {
+    const std::vector<vpImagePoint> &pts = i == 0 ? init_pts : guess_pts;
+    m_pointsX[i].resize(pts.size());
+    m_pointsY[i].resize(pts.size());
+    for (size_t j = 0; j < pts.size(); j++) {
+      m_pointsX[i][j] = (float)pts[j].get_u();
+      m_pointsY[i][j] = (float)pts[j].get_v();
+    }
+  }
+  m_pointsId = fid;
+  m_initialGuess = true;
+}
+
+/*!
+  Set the maximum number of features to track in the image.
+
+  \param maxCount : Maximum number of features to detect and track. Default
+  value is set to 500.
+*/
+void vpKltNative::setMaxFeatures(int maxCount) { m_maxCount = maxCount; }
+
+/*!
+  Set the maximum number of iterations of the Lucas-Kanade and sub-pixel
+  refinement loops.
+
+  \param maxIter : Maximum number of iterations. Default value is set to 20.
+*/
+void vpKltNative::setMaxIterations(int maxIter) { m_maxIter = maxIter; }
+
+/*!
+  Set the minimal Euclidean distance between detected corners during
+  initialization.
+
+  \param minDistance : Minimal possible Euclidean distance between the
+  detected corners. Default value is set to 15.
+*/
+void vpKltNative::setMinDistance(double minDistance) { m_minDistance = minDistance; }
+
+/*!
+  Set the minimal eigen value threshold used to reject a point during the
+  tracking. The eigen value is normalized as in vpKltOpencv.
+
+  \param minEigThreshold : Minimal eigen value threshold. Default value is set
+  to 1e-4.
+*/
+void vpKltNative::setMinEigThreshold(double minEigThreshold) { m_minEigThreshold = minEigThreshold; }
+
+/*!
+  Set the maximal pyramid level. If the level is zero, then no pyramid is
+  computed for the optical flow.
+
+  \param pyrMaxLevel : 0-based maximal pyramid level number; if set to 0,
+  pyramids are not used (single level), if set to 1, two levels are used, and
+  so on. Default value is set to 3.
+*/
+void vpKltNative::setPyramidLevels(int pyrMaxLevel) { m_pyrMaxLevel = std::max(pyrMaxLevel, 0); }
+
+/*!
+  Set the parameter characterizing the minimal accepted quality of image
+  corners.
+
+  \param qualityLevel : Quality level parameter. Default value is set to 0.01.
+  The parameter value is multiplied by the best corner quality measure, which
+  is the minimal eigenvalue. The corners with the quality measure less than
+  the product are rejected.
+*/
+void vpKltNative::setQuality(double qualityLevel) { m_qualityLevel = qualityLevel; }
+
+/*!
+  Set the window size used to track the features.
+
+  \param winSize : Size of the integration window of the Lucas-Kanade method.
+  The half size of the sub-pixel corner refinement window. Default value is
+  set to 10.
+*/
+void vpKltNative::setWindowSize(int winSize) { m_winSize = std::max(winSize, 2); }
+
+/*!
+  Remove the feature with the given index as parameter.
+
+  \param index : Index of the feature to remove.
+*/
+void vpKltNative::suppressFeature(const int &index)
+{
+  if ((size_t)index >= m_pointsX[1].size()) {
+    throw(vpException(vpException::badValue, "Feature [%d] doesn't exist", index));
+  }
+
+  m_pointsX[1].erase(m_pointsX[1].begin() + index);
+  m_pointsY[1].erase(m_pointsY[1].begin() + index);
+  m_pointsId.erase(m_pointsId.begin() + index);
+}
+
+/*!
+  The current pyramid becomes the previous one and its derivatives are
+  computed for the next call to track().
+*/
+void vpKltNative::swapPyramids()
+{
+  m_pyramid.swap(m_prevPyramid);
+  m_prevDeriv.resize(m_prevPyramid.size());
+  for (size_t level = 0; level < m_prevPyramid.size(); level++) {
+    computeScharr(m_prevPyramid[level], m_prevDeriv[level]);
+  }
+}
+
+/*!
+  Track KLT keypoints using the iterative Lucas-Kanade method with pyramids.
+
+  \param I : Input image.
+
+  \exception vpTrackingException::fatalError : If there is no feature to track.
+  \exception vpException::dimensionError : If the image size differs from the
+  previous one.
+*/
+void vpKltNative::track(const vpImage<unsigned char> &I)
+{
+  if (m_pointsX[1].empty())
+    throw vpTrackingException(vpTrackingException::fatalError, "Not enough key points to track.");
+
+  if (m_prevPyramid.empty()) {
+    buildPyramid(I);
+    swapPyramids();
+  } else if (m_prevPyramid[0].getWidth() != I.getWidth() || m_prevPyramid[0].getHeight() != I.getHeight()) {
+    throw(vpException(vpException::dimensionError, "Image size (%dx%d) differs from previous image size (%dx%d)",
+                      I.getWidth(), I.getHeight(), m_prevPyramid[0].getWidth(), m_prevPyramid[0].getHeight()));
+  }
+
+  const bool useInitialFlow = m_initialGuess;
+  if (m_initialGuess) {
+    m_initialGuess = false;
+  } else {
+    std::swap(m_pointsX[1], m_pointsX[0]);
+    std::swap(m_pointsY[1], m_pointsY[0]);
+    m_pointsX[1].resize(m_pointsX[0].size());
+    m_pointsY[1].resize(m_pointsY[0].size());
+  }
+
+  buildPyramid(I);
+
+  const int maxLevel = (int)std::min(m_pyramid.size(), m_prevPyramid.size()) - 1;
+  const int nbPoints = (int)m_pointsX[0].size();
+  const int winArea = m_winSize * m_winSize;
+  const float epsilon = (float)(m_epsilon * m_epsilon);
+  std::vector<unsigned char> status((size_t)nbPoints);
+  const bool checkSSE2 = vpCPUFeatures::checkSSE2();
+
+#ifdef VISP_HAVE_OPENMP
+#pragma omp parallel
+#endif
+  {
+    std::vector<float> buffer(3 * (size_t)winArea);
+
+#ifdef VISP_HAVE_OPENMP
+#pragma omp for schedule(dynamic, 8)
+#endif
+    for (int i = 0; i < nbPoints; i++) {
+      status[(size_t)i] = trackFeature(m_prevPyramid, m_prevDeriv, m_pyramid, maxLevel, m_winSize, m_maxIter, epsilon,
+                                       (float)m_minEigThreshold, useInitialFlow, m_pointsX[0][(size_t)i],
+                                       m_pointsY[0][(size_t)i], m_pointsX[1][(size_t)i], m_pointsY[1][(size_t)i],
+                                       &buffer[0], checkSSE2)
+                              ? 1
+                              : 0;
+    }
+  }
+
+  // Remove points that are lost
+  size_t nbGood = 0;
+  for (size_t i = 0; i < (size_t)nbPoints; i++) {
+    if (status[i]) {
+      m_pointsX[0][nbGood] = m_pointsX[0][i];
+      m_pointsY[0][nbGood] = m_pointsY[0][i];
+      m_pointsX[1][nbGood] = m_pointsX[1][i];
+      m_pointsY[1][nbGood] = m_pointsY[1][i];
+      m_pointsId[nbGood] = m_pointsId[i];
+      nbGood++;
+    }
+  }
+  for (size_t i = 0; i < 2; i++) {
+    m_pointsX[i].resize(nbGood);
+    m_pointsY[i].resize(nbGood);
+  }
+  m_pointsId.resize(nbGood);
+
+  swapPyramids();
+}
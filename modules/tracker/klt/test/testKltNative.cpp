@@ -0,0 +1,314 @@
+/****************************************************************************
+ *
+ * ViSP, open source Visual Servoing Platform software.
+ * Copyright (C) 2005 - 2019 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test native KLT tracker.
+ *
+ *****************************************************************************/
+
+#include <visp3/core/vpConfig.h>
+
+/*!
+  \example testKltNative.cpp
+
+  \brief Test native pyramidal KLT tracker on synthetic translated images.
+*/
+
+#if defined(VISP_HAVE_CATCH2)
+#define CATCH_CONFIG_RUNNER
+#include <catch.hpp>
+#include <visp3/core/vpUniRand.h>
+#include <visp3/klt/vpKltNative.h>
+
+namespace
+{
+// Non periodic texture made of Gaussian blobs of various sizes, translated by (tx, ty)
+void generateImage(vpImage<unsigned char> &I, double tx, double ty)
+{
+  vpUniRand rng(1234);
+  std::vector<double> u(200), v(200), sigma(200), amplitude(200);
+  for (size_t k = 0; k < u.size(); k++) {
+    u[k] = rng.uniform(-20.0, 340.0);
+    v[k] = rng.uniform(-20.0, 260.0);
+    sigma[k] = rng.uniform(3.0, 15.0);
+    amplitude[k] = rng.uniform(-80.0, 80.0);
+  }
+
+  I.resize(240, 320);
+  for (unsigned int i = 0; i < I.getHeight(); i++) {
+    for (unsigned int j = 0; j < I.getWidth(); j++) {
+      const double x = j - tx, y = i - ty;
+      double val = 128;
+      for (size_t k = 0; k < u.size(); k++) {
+        const double d2 = vpMath::sqr(x - u[k]) + vpMath::sqr(y - v[k]);
+        if (d2 < vpMath::sqr(4 * sigma[k])) {
+          val += amplitude[k] * exp(-d2 / (2 * vpMath::sqr(sigma[k])));
+        }
+      }
+      I[i][j] = static_cast<unsigned char>(std::max(0, std::min(255, vpMath::round(val))));
+    }
+  }
+}
+
+// Features close to the image border may be lost or drift when the texture
+// enters or leaves the image: only most of them are expected to be accurate.
+void checkTranslation(const vpKltNative &klt, const std::vector<float> &x0, const std::vector<float> &y0,
+                      double tx, double ty, double ratio)
+{
+  CHECK(klt.getNbFeatures() >= ratio * x0.size());
+
+  std::vector<double> errors;
+  for (int i = 0; i < klt.getNbFeatures(); i++) {
+    long id;
+    float x, y;
+    klt.getFeature(i, id, x, y);
+    REQUIRE(id >= 0);
+    REQUIRE(static_cast<size_t>(id) < x0.size());
+    errors.push_back(sqrt(vpMath::sqr(x - x0[id] - tx) + vpMath::sqr(y - y0[id] - ty)));
+  }
+  REQUIRE(!errors.empty());
+
+  size_t nbAccurate = 0;
+  for (size_t i = 0; i < errors.size(); i++) {
+    if (errors[i] < 0.25) {
+      nbAccurate++;
+    }
+  }
+  CHECK(nbAccurate >= 0.95 * errors.size());
+  CHECK(vpMath::getMedian(errors) < 0.05);
+}
+
+void initialFeatures(const vpKltNative &klt, std::vector<float> &x0, std::vector<float> &y0)
+{
+  x0.resize(klt.getNbFeatures());
+  y0.resize(klt.getNbFeatures());
+  for (int i = 0; i < klt.getNbFeatures(); i++) {
+    long id;
+    klt.getFeature(i, id, x0[i], y0[i]);
+    REQUIRE(id == i);
+  }
+}
+} // namespace
+
+TEST_CASE("Shi-Tomasi detection", "[klt]")
+{
+  vpImage<unsigned char> I;
+  generateImage(I, 0, 0);
+
+  vpKltNative klt;
+  klt.setMaxFeatures(150);
+  klt.setMinDistance(10);
+  klt.setQuality(0.01);
+  klt.setWindowSize(2);
+  klt.initTracking(I);
+
+  REQUIRE(klt.getNbFeatures() > 50);
+  CHECK(klt.getNbFeatures() <= 150);
+
+  std::vector<vpImagePoint> features = klt.getFeatures();
+  for (size_t i = 0; i < features.size(); i++) {
+    for (size_t j = i + 1; j < features.size(); j++) {
+      // Sub-pixel refinement moves the corners by at most the window size
+      CHECK(vpImagePoint::distance(features[i], features[j]) > 10 - 2 * 2);
+    }
+  }
+
+  SECTION("Mask")
+  {
+    vpImage<unsigned char> mask(I.getHeight(), I.getWidth(), 0);
+    for (unsigned int i = 60; i < 180; i++) {
+      for (unsigned int j = 80; j < 240; j++) {
+        mask[i][j] = 255;
+      }
+    }
+    klt.initTracking(I, &mask);
+    REQUIRE(klt.getNbFeatures() > 10);
+
+    for (int i = 0; i < klt.getNbFeatures(); i++) {
+      long id;
+      float x, y;
+      klt.getFeature(i, id, x, y);
+      CHECK(x > 80 - 1);
+      CHECK(x < 240);
+      CHECK(y > 60 - 1);
+      CHECK(y < 180);
+    }
+
+    vpImage<unsigned char> bad_mask(10, 10, 255);
+    CHECK_THROWS(klt.initTracking(I, &bad_mask));
+  }
+}
+
+TEST_CASE("Pyramidal Lucas-Kanade", "[klt]")
+{
+  vpImage<unsigned char> I0, I1, I2;
+  generateImage(I0, 0, 0);
+
+  vpKltNative klt;
+  klt.setMaxFeatures(200);
+  klt.setMinDistance(8);
+  klt.setWindowSize(11);
+  klt.setPyramidLevels(3);
+  klt.initTracking(I0);
+
+  std::vector<float> x0, y0;
+  initialFeatures(klt, x0, y0);
+  REQUIRE(x0.size() > 50);
+
+  SECTION("Small motion")
+  {
+    generateImage(I1, 1.4, -2.2);
+    klt.track(I1);
+    checkTranslation(klt, x0, y0, 1.4, -2.2, 0.8);
+
+    // The pyramid of I1 is reused as previous pyramid
+    generateImage(I2, 2.9, -3.5);
+    klt.track(I2);
+    checkTranslation(klt, x0, y0, 2.9, -3.5, 0.8);
+  }
+
+  SECTION("Large motion")
+  {
+    generateImage(I1, 9.5, 6.25);
+    klt.track(I1);
+    checkTranslation(klt, x0, y0, 9.5, 6.25, 0.7);
+  }
+
+  SECTION("Initial guess")
+  {
+    generateImage(I1, 23.0, -17.5);
+    std::vector<vpImagePoint> guess = klt.getFeatures();
+    for (size_t i = 0; i < guess.size(); i++) {
+      guess[i] += vpImagePoint(-17, 22.5);
+    }
+    klt.setInitialGuess(guess);
+    klt.track(I1);
+    checkTranslation(klt, x0, y0, 23.0, -17.5, 0.6);
+  }
+
+  SECTION("Copy")
+  {
+    vpKltNative klt_copy(klt);
+    generateImage(I1, -1.7, 0.6);
+    klt.track(I1);
+    klt_copy.track(I1);
+    REQUIRE(klt.getNbFeatures() == klt_copy.getNbFeatures());
+    for (int i = 0; i < klt.getNbFeatures(); i++) {
+      long id, id_copy;
+      float x, y, x_copy, y_copy;
+      klt.getFeature(i, id, x, y);
+      klt_copy.getFeature(i, id_copy, x_copy, y_copy);
+      CHECK(id == id_copy);
+      CHECK(x == Approx(x_copy));
+      CHECK(y == Approx(y_copy));
+    }
+  }
+
+  SECTION("Lost features")
+  {
+    vpImage<unsigned char> I_flat(I0.getHeight(), I0.getWidth(), 128);
+    klt.track(I_flat);
+    CHECK(klt.getNbFeatures() < static_cast<int>(x0.size()));
+    for (int i = 0; i < klt.getNbFeatures(); i++) {
+      long id;
+      float x, y;
+      klt.getFeature(i, id, x, y);
+      CHECK(id >= 0);
+    }
+
+    vpImage<unsigned char> I_small(100, 100);
+    CHECK_THROWS(klt.track(I_small));
+  }
+
+  SECTION("Suppress")
+  {
+    int nb = klt.getNbFeatures();
+    klt.suppressFeature(0);
+    CHECK(klt.getNbFeatures() == nb - 1);
+    CHECK(klt.getFeaturesId()[0] == 1);
+    CHECK_THROWS(klt.suppressFeature(nb));
+  }
+}
+
+TEST_CASE("Tracking from given points", "[klt]")
+{
+  vpImage<unsigned char> I0, I1;
+  generateImage(I0, 0, 0);
+  generateImage(I1, 2.0, 1.0);
+
+  vpKltNative detector;
+  detector.initTracking(I0);
+  std::vector<vpImagePoint> pts = detector.getFeatures();
+  REQUIRE(!pts.empty());
+
+  std::vector<long> ids(pts.size());
+  for (size_t i = 0; i < ids.size(); i++) {
+    ids[i] = static_cast<long>(10 + i);
+  }
+
+  vpKltNative klt;
+  klt.initTracking(I0, pts, ids);
+  CHECK(klt.getNbFeatures() == static_cast<int>(pts.size()));
+  klt.track(I1);
+
+  for (int i = 0; i < klt.getNbFeatures(); i++) {
+    long id;
+    float x, y;
+    klt.getFeature(i, id, x, y);
+    REQUIRE(id >= 10);
+    const vpImagePoint &p0 = pts[static_cast<size_t>(id - 10)];
+    CHECK(x == Approx(p0.get_u() + 2.0).margin(0.25));
+    CHECK(y == Approx(p0.get_v() + 1.0).margin(0.25));
+  }
+
+  klt.addFeature(5.f, 5.f);
+  CHECK(klt.getFeaturesId().back() == static_cast<long>(10 + pts.size()));
+}
+
+int main(int argc, char *argv[])
+{
+  Catch::Session session; // There must be exactly one instance
+
+  // Let Catch (using Clara) parse the command line
+  session.applyCommandLine(argc, argv);
+
+  int numFailed = session.run();
+
+  // numFailed is clamped to 255 as some unices only use the lower 8 bits.
+  // This clamping has already been applied, so just return it here
+  // You can also do any post run clean-up here
+  return numFailed;
+}
+#else
+int main()
+{
+  return 0;
+}
+#endif
@@ -117,6 +117,7 @@ public:
   virtual void track(const pcl::PointCloud<pcl::PointXYZ>::ConstPtr &point_cloud);
 #endif
   virtual void track(const std::vector<vpColVector> &point_cloud, unsigned int width, unsigned int height);
+  virtual void track(const vpPointCloud &point_cloud);
 
 protected:
   //! Set of faces describing the object used only for display with scan line.
@@ -155,6 +156,7 @@ protected:
   virtual void computeVVSInteractionMatrixAndResidu();
   virtual void computeVVSWeights();
   using vpMbTracker::computeVVSWeights;
+  void computeVVSNormalEquations();
 
   virtual void initCircle(const vpPoint &p1, const vpPoint &p2, const vpPoint &p3, double radius,
                           int idFace = 0, const std::string &name = "");
@@ -171,5 +173,6 @@ protected:
 #endif
   void segmentPointCloud(const std::vector<vpColVector> &point_cloud, unsigned int width,
                          unsigned int height);
+  void segmentPointCloud(const vpPointCloud &point_cloud);
 };
 #endif
@@ -76,13 +76,28 @@
   There is also \ref tutorial-detection-object that shows how to initialize the tracker from
   an initial pose provided by a detection algorithm.
 
+  The copy constructor and the assignment operator duplicate the whole tracking
+  state (model, visibility, moving edges, KLT points, depth features, robust
+  weights) without reloading the model. They can be used to save a snapshot
+  of a tracker that tracks well and to restore it after a tracking failure,
+  or to track several pose hypotheses in parallel:
+  \code
+  vpMbGenericTracker snapshot(tracker); // Save the tracking state
+  try {
+    tracker.track(I);
+  } catch (...) {
+    tracker = snapshot;                  // Restore the tracking state
+    tracker.setPose(I, cMo_hypothesis);
+  }
+  \endcode
+
 */
 class VISP_EXPORT vpMbGenericTracker : public vpMbTracker
 {
 public:
   enum vpTrackerType {
     EDGE_TRACKER = 1 << 0, /*!< Model-based tracking using moving edges features. */
-#if defined(VISP_HAVE_MODULE_KLT) && (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
+#if defined(VISP_HAVE_MODULE_KLT)
     KLT_TRACKER = 1 << 1, /*!< Model-based tracking using KLT features. */
 #endif
     DEPTH_NORMAL_TRACKER = 1 << 2, /*!< Model-based tracking using depth normal features. */
@@ -93,9 +108,12 @@ public:
   vpMbGenericTracker(unsigned int nbCameras, int trackerType = EDGE_TRACKER);
   explicit vpMbGenericTracker(const std::vector<int> &trackerTypes);
   vpMbGenericTracker(const std::vector<std::string> &cameraNames, const std::vector<int> &trackerTypes);
+  vpMbGenericTracker(const vpMbGenericTracker &tracker);
 
   virtual ~vpMbGenericTracker();
 
+  vpMbGenericTracker &operator=(const vpMbGenericTracker &tracker);
+
   virtual double computeCurrentProjectionError(const vpImage<unsigned char> &I, const vpHomogeneousMatrix &_cMo,
                                                const vpCameraParameters &_cam);
   virtual double computeCurrentProjectionError(const vpImage<vpRGBa> &I, const vpHomogeneousMatrix &_cMo,
@@ -141,7 +159,7 @@ public:
   virtual vpMbHiddenFaces<vpMbtPolygon> &getFaces();
   virtual vpMbHiddenFaces<vpMbtPolygon> &getFaces(const std::string &cameraName);
 
-#if defined(VISP_HAVE_MODULE_KLT) && (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
+#if defined(VISP_HAVE_MODULE_KLT)
   virtual std::list<vpMbtDistanceCircle *> &getFeaturesCircle();
   virtual std::list<vpMbtDistanceKltCylinder *> &getFeaturesKltCylinder();
   virtual std::list<vpMbtDistanceKltPoints *> &getFeaturesKlt();
@@ -152,16 +170,18 @@ public:
 
   virtual double getGoodMovingEdgesRatioThreshold() const;
 
-#if defined(VISP_HAVE_MODULE_KLT) && (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
+#if defined(VISP_HAVE_MODULE_KLT)
   virtual std::vector<vpImagePoint> getKltImagePoints() const;
   virtual std::map<int, vpImagePoint> getKltImagePointsWithId() const;
 
   virtual unsigned int getKltMaskBorder() const;
   virtual int getKltNbPoints() const;
 
+#if defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100)
   virtual vpKltOpencv getKltOpencv() const;
   virtual void getKltOpencv(vpKltOpencv &klt1, vpKltOpencv &klt2) const;
   virtual void getKltOpencv(std::map<std::string, vpKltOpencv> &mapOfKlts) const;
+#endif
 
 #if (VISP_HAVE_OPENCV_VERSION >= 0x020408)
   virtual std::vector<cv::Point2f> getKltPoints() const;
@@ -277,6 +297,8 @@ public:
   virtual void loadConfigFile(const std::string &configFile);
   virtual void loadConfigFile(const std::string &configFile1, const std::string &configFile2);
   virtual void loadConfigFile(const std::map<std::string, std::string> &mapOfConfigFiles);
+  virtual void loadConfigFile(const vpMbtXmlConfig &config);
+  virtual void loadConfigFile(const std::map<std::string, const vpMbtXmlConfig *> &mapOfConfigs);
 
   virtual void loadModel(const std::string &modelFile, bool verbose = false, const vpHomogeneousMatrix &T=vpHomogeneousMatrix());
   virtual void loadModel(const std::string &modelFile1, const std::string &modelFile2, bool verbose = false,
@@ -362,14 +384,20 @@ public:
   virtual void setNbRayCastingAttemptsForVisibility(const unsigned int &attempts);
 #endif
 
-#if defined(VISP_HAVE_MODULE_KLT) && (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
+#if defined(VISP_HAVE_MODULE_KLT)
   virtual void setKltMaskBorder(const unsigned int &e);
   virtual void setKltMaskBorder(const unsigned int &e1, const unsigned int &e2);
   virtual void setKltMaskBorder(const std::map<std::string, unsigned int> &mapOfErosions);
 
+  virtual void setKltImplementation(const vpMbKltTracker::vpKltImplementationType &type);
+
+  virtual void setKltNative(const vpKltNative &t);
+
+#if defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100)
   virtual void setKltOpencv(const vpKltOpencv &t);
   virtual void setKltOpencv(const vpKltOpencv &t1, const vpKltOpencv &t2);
   virtual void setKltOpencv(const std::map<std::string, vpKltOpencv> &mapOfKlts);
+#endif
 
   virtual void setKltThresholdAcceptation(double th);
 
@@ -382,6 +410,10 @@ public:
   virtual void setMinLineLengthThresh(double minLineLengthThresh, const std::string &name = "");
   virtual void setMinPolygonAreaThresh(double minPolygonAreaThresh, const std::string &name = "");
 
+  virtual void setModelCacheDirectory(const std::string &directory);
+
+  virtual void setModelCacheEnabled(bool enable);
+
   virtual void setMovingEdge(const vpMe &me);
   virtual void setMovingEdge(const vpMe &me1, const vpMe &me2);
   virtual void setMovingEdge(const std::map<std::string, vpMe> &mapOfMe);
@@ -424,7 +456,7 @@ public:
   virtual void setUseDepthDenseTracking(const std::string &name, const bool &useDepthDenseTracking);
   virtual void setUseDepthNormalTracking(const std::string &name, const bool &useDepthNormalTracking);
   virtual void setUseEdgeTracking(const std::string &name, const bool &useEdgeTracking);
-#if defined(VISP_HAVE_MODULE_KLT) && (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
+#if defined(VISP_HAVE_MODULE_KLT)
   virtual void setUseKltTracking(const std::string &name, const bool &useKltTracking);
 #endif
 
@@ -455,6 +487,11 @@ public:
                      std::map<std::string, unsigned int> &mapOfPointCloudWidths,
                      std::map<std::string, unsigned int> &mapOfPointCloudHeights);
 
+  virtual void track(std::map<std::string, const vpImage<unsigned char> *> &mapOfImages,
+                     std::map<std::string, const vpPointCloud *> &mapOfPointClouds);
+  virtual void track(std::map<std::string, const vpImage<vpRGBa> *> &mapOfColorImages,
+                     std::map<std::string, const vpPointCloud *> &mapOfPointClouds);
+
 protected:
   virtual void computeProjectionError();
 
@@ -486,10 +523,12 @@ protected:
                            std::map<std::string, const std::vector<vpColVector> *> &mapOfPointClouds,
                            std::map<std::string, unsigned int> &mapOfPointCloudWidths,
                            std::map<std::string, unsigned int> &mapOfPointCloudHeights);
+  virtual void preTracking(std::map<std::string, const vpImage<unsigned char> *> &mapOfImages,
+                           std::map<std::string, const vpPointCloud *> &mapOfPointClouds);
 
 private:
   class TrackerWrapper : public vpMbEdgeTracker,
-#if defined(VISP_HAVE_MODULE_KLT) && (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
+#if defined(VISP_HAVE_MODULE_KLT)
                          public vpMbKltTracker,
 #endif
                          public vpMbDepthNormalTracker,
@@ -511,6 +550,7 @@ private:
 
     TrackerWrapper();
     explicit TrackerWrapper(int trackerType);
+    TrackerWrapper(const TrackerWrapper &tracker);
 
     virtual ~TrackerWrapper();
 
@@ -535,6 +575,7 @@ private:
     virtual void init(const vpImage<unsigned char> &I);
 
     virtual void loadConfigFile(const std::string &configFile);
+    virtual void loadConfigFile(const vpMbtXmlConfig &config);
 
     virtual void reInitModel(const vpImage<unsigned char> &I, const std::string &cad_name,
                              const vpHomogeneousMatrix &cMo, bool verbose = false,
@@ -601,6 +642,8 @@ private:
 
     virtual void initMbtTracking(const vpImage<unsigned char> *const ptr_I);
 
+    void loadConfig(const std::string &configFile, const vpMbtXmlConfig *config);
+
 #ifdef VISP_HAVE_PCL
     virtual void postTracking(const vpImage<unsigned char> *const ptr_I,
                               const pcl::PointCloud<pcl::PointXYZ>::ConstPtr &point_cloud);
@@ -612,6 +655,7 @@ private:
     virtual void preTracking(const vpImage<unsigned char> *const ptr_I = NULL,
                              const std::vector<vpColVector> *const point_cloud = NULL,
                              const unsigned int pointcloud_width = 0, const unsigned int pointcloud_height = 0);
+    virtual void preTracking(const vpImage<unsigned char> *const ptr_I, const vpPointCloud *const point_cloud);
 
     virtual void reInitModel(const vpImage<unsigned char> * const I, const vpImage<vpRGBa> * const I_color,
                              const std::string &cad_name, const vpHomogeneousMatrix &cMo, bool verbose = false,
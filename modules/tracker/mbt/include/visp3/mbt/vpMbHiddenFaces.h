@@ -326,14 +326,18 @@ template <class PolygonType> vpMbHiddenFaces<PolygonType>::~vpMbHiddenFaces()
 
 /*!
   Copy constructor.
+
+  \note The Ogre context cannot be shared, the copy gets its own context that
+  has to be initialized with initOgre().
 */
 template <class PolygonType>
 vpMbHiddenFaces<PolygonType>::vpMbHiddenFaces(const vpMbHiddenFaces<PolygonType> &copy)
   : Lpol(), nbVisiblePolygon(copy.nbVisiblePolygon), scanlineRender(copy.scanlineRender)
 #ifdef VISP_HAVE_OGRE
     ,
-    ogreBackground(copy.ogreBackground), ogreInitialised(copy.ogreInitialised), nbRayAttempts(copy.nbRayAttempts),
-    ratioVisibleRay(copy.ratioVisibleRay), ogre(NULL), lOgrePolygons(), ogreShowConfigDialog(copy.ogreShowConfigDialog)
+    ogreBackground(copy.ogreBackground), ogreInitialised(false), nbRayAttempts(copy.nbRayAttempts),
+    ratioVisibleRay(copy.ratioVisibleRay), ogre(new vpAROgre()), lOgrePolygons(),
+    ogreShowConfigDialog(copy.ogreShowConfigDialog)
 #endif
 {
   // Copy the list of polygons
@@ -46,13 +46,14 @@
 
 #include <visp3/core/vpConfig.h>
 
-#if defined(VISP_HAVE_MODULE_KLT) && (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
+#if defined(VISP_HAVE_MODULE_KLT)
 
 #include <visp3/core/vpExponentialMap.h>
 #include <visp3/core/vpMeterPixelConversion.h>
 #include <visp3/core/vpPixelMeterConversion.h>
 #include <visp3/core/vpSubColVector.h>
 #include <visp3/core/vpSubMatrix.h>
+#include <visp3/klt/vpKltNative.h>
 #include <visp3/klt/vpKltOpencv.h>
 #include <visp3/mbt/vpMbTracker.h>
 #include <visp3/mbt/vpMbtDistanceCircle.h>
@@ -65,10 +66,16 @@
   \ingroup group_mbt_trackers
   \warning This class is deprecated for user usage. You should rather use the high level
   vpMbGenericTracker class.
-  \warning This class is only available if OpenCV is installed, and used.
 
   \brief Model based tracker using only KLT.
 
+  The KLT points are detected and tracked either with vpKltOpencv, which
+  requires OpenCV, or with vpKltNative that works directly on
+  vpImage<unsigned char> without any third-party library (see
+  setKltImplementation() or the \c use_native tag of the \c klt section of
+  the configuration file). When ViSP is built without OpenCV, vpKltNative is
+  always used.
+
   The \ref tutorial-tracking-mb-deprecated is a good starting point to use this class.
 
   The tracker requires the knowledge of the 3D model that could be provided in
@@ -215,11 +222,18 @@ int main()
 */
 class VISP_EXPORT vpMbKltTracker : public virtual vpMbTracker
 {
+public:
+  //! KLT implementation used to detect and track the points.
+  typedef enum {
+    KLT_OPENCV, ///< Use vpKltOpencv, requires OpenCV.
+    KLT_NATIVE  ///< Use vpKltNative.
+  } vpKltImplementationType;
+
 protected:
 //! Temporary OpenCV image for fast conversion.
 #if (VISP_HAVE_OPENCV_VERSION >= 0x020408)
   cv::Mat cur;
-#else
+#elif defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100)
   IplImage *cur;
 #endif
   //! Initial pose.
@@ -238,8 +252,14 @@ protected:
   //! The estimated displacement of the pose between the current instant and
   //! the initial position.
   vpHomogeneousMatrix ctTc0;
+#if defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100)
   //! Points tracker.
   vpKltOpencv tracker;
+#endif
+  //! Native points tracker.
+  vpKltNative m_kltNative;
+  //! KLT implementation used to detect and track the points.
+  vpKltImplementationType m_kltImplementation;
   //!
   std::list<vpMbtDistanceKltPoints *> kltPolygons;
   //!
@@ -290,7 +310,7 @@ public:
  */
 #if (VISP_HAVE_OPENCV_VERSION >= 0x020408)
   inline std::vector<cv::Point2f> getKltPoints() const { return tracker.getFeatures(); }
-#else
+#elif defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100)
   inline CvPoint2D32f *getKltPoints() { return tracker.getFeatures(); }
 #endif
 
@@ -298,12 +318,28 @@ public:
 
   std::map<int, vpImagePoint> getKltImagePointsWithId() const;
 
+  /*!
+    Get the KLT implementation used to detect and track the points.
+
+    \sa setKltImplementation()
+   */
+  inline vpKltImplementationType getKltImplementation() const { return m_kltImplementation; }
+
+  /*!
+    Get the native klt tracker at the current state.
+
+    \return native klt tracker.
+   */
+  inline const vpKltNative &getKltNative() const { return m_kltNative; }
+
+#if defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100)
   /*!
     Get the klt tracker at the current state.
 
     \return klt tracker.
    */
   inline vpKltOpencv getKltOpencv() const { return tracker; }
+#endif
 
   /*!
     Get the erosion of the mask used on the Model faces.
@@ -317,7 +353,7 @@ public:
 
     \return the number of features
    */
-  inline int getKltNbPoints() const { return tracker.getNbFeatures(); }
+  int getKltNbPoints() const;
 
   /*!
     Get the threshold for the acceptation of a point.
@@ -357,7 +393,13 @@ public:
     faces.getMbScanLineRenderer().setMaskBorder(maskBorder);
   }
 
+  void setKltImplementation(const vpKltImplementationType &type);
+
+  virtual void setKltNative(const vpKltNative &t);
+
+#if defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100)
   virtual void setKltOpencv(const vpKltOpencv &t);
+#endif
 
   /*!
     Set the threshold for the acceptation of a point.
@@ -436,7 +478,7 @@ public:
 
     \return the number of features
    */
-  /* vp_deprecated */ inline int getNbKltPoints() const { return tracker.getNbFeatures(); }
+  /* vp_deprecated */ inline int getNbKltPoints() const { return getKltNbPoints(); }
 
   /*!
     Get the threshold for the acceptation of a point.
@@ -476,6 +518,7 @@ protected:
   virtual void computeVVSInteractionMatrixAndResidu();
 
   virtual std::vector<std::vector<double> > getFeaturesForDisplayKlt();
+  void getKltFeature(int index, long &id, float &x, float &y) const;
 
   virtual void init(const vpImage<unsigned char> &I);
   virtual void initFaceFromCorners(vpMbtPolygon &polygon);
@@ -60,6 +60,7 @@
 #include <visp3/core/vpRGBa.h>
 #include <visp3/core/vpRobust.h>
 #include <visp3/mbt/vpMbHiddenFaces.h>
+#include <visp3/mbt/vpMbtCompiledModel.h>
 #include <visp3/mbt/vpMbtPolygon.h>
 
 #include <visp3/mbt/vpMbtDistanceCircle.h>
@@ -79,6 +80,8 @@
 #include <Inventor/VRMLnodes/SoVRMLIndexedLineSet.h>
 #endif
 
+class vpMbtXmlConfig;
+
 /*!
   \class vpMbTracker
   \ingroup group_mbt_trackers
@@ -177,6 +180,12 @@ protected:
   double minLineLengthThresholdGeneral;
   //! Minimum polygon area threshold for LOD mode (general setting)
   double minPolygonAreaThresholdGeneral;
+  //! If true, CAO models are loaded from and saved to a compiled model cache
+  bool m_useModelCache;
+  //! Directory of the compiled model cache, next to the model file if empty
+  std::string m_modelCacheDirectory;
+  //! Compiled model filled while parsing a CAO model, NULL otherwise
+  vpMbtCompiledModel *m_compiledModel;
   //! Map with [map.first]=parameter_names and [map.second]=type (string,
   //! number or boolean)
   std::map<std::string, std::string> mapOfParameterNames;
@@ -370,6 +379,13 @@ public:
   */
   virtual inline double getNearClippingDistance() const { return distNearClip; }
 
+  /*!
+    Return true if the compiled model cache is used when loading CAO models.
+
+    \sa setModelCacheEnabled()
+  */
+  virtual inline bool getModelCacheEnabled() const { return m_useModelCache; }
+
   /*!
     Get the optimization method used during the tracking.
     0 = Gauss-Newton approach.
@@ -543,6 +559,10 @@ public:
 
   virtual void setMinPolygonAreaThresh(double minPolygonAreaThresh, const std::string &name = "");
 
+  virtual void setModelCacheDirectory(const std::string &directory);
+
+  virtual void setModelCacheEnabled(bool enable);
+
   virtual void setNearClippingDistance(const double &dist);
 
   /*!
@@ -766,6 +786,13 @@ protected:
                   const std::string &polygonName = "", bool useLod = false,
                   double minLineLengthThreshold = 50);
 
+  void addModelCircle(const vpPoint &p1, const vpPoint &p2, const vpPoint &p3, double radius, int &idFace,
+                      const std::string &name, bool useLod, double minPolygonAreaThreshold);
+  void addModelCylinder(const vpPoint &p1, const vpPoint &p2, double radius, int &idFace, const std::string &name,
+                        bool useLod, double minLineLengthThreshold);
+  void addModelFace(const std::vector<vpPoint> &corners, bool fromLines, int &idFace, const std::string &name,
+                    bool useLod, double minPolygonAreaThreshold, double minLineLengthThreshold);
+
   void addProjectionErrorCircle(const vpPoint &P1, const vpPoint &P2, const vpPoint &P3, double r, int idFace = -1,
                                 const std::string &name = "");
   void addProjectionErrorCylinder(const vpPoint &P1, const vpPoint &P2, double r, int idFace = -1, const std::string &name = "");
@@ -783,6 +810,8 @@ protected:
                                  const std::string &polygonName = "", bool useLod = false,
                                  double minLineLengthThreshold = 50);
 
+  void copyProjectionErrorFeatures(const vpMbTracker &tracker);
+
   void createCylinderBBox(const vpPoint &p1, const vpPoint &p2, const double &radius,
                           std::vector<std::vector<vpPoint> > &listFaces);
 
@@ -818,6 +847,9 @@ protected:
 
   vpPoint getGravityCenter(const std::vector<vpPoint> &_pts) const;
 
+  std::string getModelCacheFilename(const std::string &modelFile) const;
+  uint64_t getModelCacheSettingsHash(const vpHomogeneousMatrix &odTo) const;
+
   /*!
     Add a circle to track from its center, 3 points (including the center)
     defining the plane that contain the circle and its radius.
@@ -890,6 +922,8 @@ protected:
   virtual void loadCAOModel(const std::string &modelFile, std::vector<std::string> &vectorOfModelFilename,
                             int &startIdFace, bool verbose = false, bool parent = true,
                             const vpHomogeneousMatrix &T=vpHomogeneousMatrix());
+  void loadCompiledModel(const vpMbtCompiledModel &model, int &startIdFace);
+  void loadProjectionErrorConfig(const std::string &configFile, const vpMbtXmlConfig *config);
 
   void projectionErrorInitMovingEdge(const vpImage<unsigned char> &I, const vpHomogeneousMatrix &_cMo);
   void projectionErrorResetMovingEdges();
@@ -0,0 +1,180 @@
+/****************************************************************************
+ *
+ * ViSP, open source Visual Servoing Platform software.
+ * Copyright (C) 2005 - 2019 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Compiled (binary) CAD model used by the model-based trackers.
+ *
+ *****************************************************************************/
+
+/*!
+ \file vpMbtCompiledModel.h
+ \brief Compiled binary representation of a CAD model.
+*/
+
+#ifndef _vpMbtCompiledModel_h_
+#define _vpMbtCompiledModel_h_
+
+#include <stdint.h> //for uint32_t related types ; works also with >= VS2010 / _MSC_VER >= 1600
+#include <string>
+#include <vector>
+
+#include <visp3/core/vpConfig.h>
+#include <visp3/core/vpPoint.h>
+
+/*!
+  \class vpMbtCompiledModel
+  \ingroup group_mbt_faces
+
+  \brief Compiled binary representation of a CAD model.
+
+  A compiled model stores the primitives resolved while parsing a CAO model
+  file and its included files: the 3D points of the faces and lines expressed
+  in the object frame, the cylinders, the circles, the face names and the
+  level of detail (LOD) settings. Once saved, it can be loaded back without
+  any parsing: on Unix systems the file is memory-mapped and the primitives
+  are read in place.
+
+  The file starts with a versioned header followed by fixed size records,
+  the point coordinates and a string table. It also contains a hash of the
+  content of each source file, and a hash of the settings that were used to
+  resolve the primitives. load() refuses a file whose version, byte order or
+  hashes do not match, so that a stale compiled model is never used.
+
+  The model-based trackers use this class through
+  vpMbTracker::setModelCacheEnabled().
+*/
+class VISP_EXPORT vpMbtCompiledModel
+{
+public:
+  //! Kind of primitive stored in the compiled model.
+  typedef enum {
+    FACE_FROM_LINES = 0,   /*!< Face built from the segments of the model. */
+    FACE_FROM_CORNERS = 1, /*!< Face or single segment built from its corners. */
+    CYLINDER = 2,          /*!< Cylinder defined by two points on its axis. */
+    CIRCLE = 3             /*!< Circle defined by its center and two points on its plane. */
+  } vpPrimitiveType;
+
+  //! Fixed size record describing a primitive.
+  struct vpPrimitive {
+    //! Primitive type, see vpPrimitiveType.
+    uint32_t type;
+    //! Index of the first point of the primitive.
+    uint32_t firstPoint;
+    //! Number of points of the primitive.
+    uint32_t nbPoints;
+    //! Offset of the name in the string table.
+    uint32_t nameOffset;
+    //! Length of the name.
+    uint32_t nameLength;
+    //! Non zero if the LOD is used for this primitive.
+    uint32_t useLod;
+    //! Radius of the cylinders and circles.
+    double radius;
+    //! Minimum polygon area threshold used by the LOD.
+    double minPolygonAreaThreshold;
+    //! Minimum line length threshold used by the LOD.
+    double minLineLengthThreshold;
+  };
+
+  vpMbtCompiledModel();
+  virtual ~vpMbtCompiledModel();
+
+  void addPrimitive(vpPrimitiveType type, const std::vector<vpPoint> &points, double radius, const std::string &name,
+                    bool useLod, double minPolygonAreaThreshold, double minLineLengthThreshold);
+  void addSource(const std::string &filename);
+
+  void clear();
+
+  static uint64_t computeHash(const void *data, size_t size, uint64_t hash = 14695981039346656037ULL);
+  static uint64_t computeFileHash(const std::string &filename);
+
+  /*!
+    Return the number of primitives.
+  */
+  inline unsigned int getNbPrimitives() const { return m_nbPrimitives; }
+  std::string getName(const vpPrimitive &primitive) const;
+  vpPoint getPoint(const vpPrimitive &primitive, unsigned int index) const;
+  void getPoints(const vpPrimitive &primitive, std::vector<vpPoint> &points) const;
+  const vpPrimitive &getPrimitive(unsigned int index) const;
+  /*!
+    Return the hash of the settings used to resolve the primitives.
+  */
+  inline uint64_t getSettingsHash() const { return m_settingsHash; }
+  std::vector<unsigned int> getStatistics() const;
+
+  bool load(const std::string &filename, uint64_t settingsHash);
+  void save(const std::string &filename) const;
+
+  /*!
+    Set the hash of the settings used to resolve the primitives (LOD
+    settings, model transformation).
+  */
+  inline void setSettingsHash(uint64_t settingsHash) { m_settingsHash = settingsHash; }
+  void setStatistics(const std::vector<unsigned int> &statistics);
+
+private:
+  vpMbtCompiledModel(const vpMbtCompiledModel &);            // noncopyable
+  vpMbtCompiledModel &operator=(const vpMbtCompiledModel &); //
+
+  void unmap();
+
+  //! Hash of the settings used to resolve the primitives
+  uint64_t m_settingsHash;
+  //! Number of points, lines, polygon lines, polygon points, cylinders and
+  //! circles declared in the model files
+  std::vector<unsigned int> m_statistics;
+  //! Absolute path of the source files
+  std::vector<std::string> m_sourceNames;
+  //! Content hash of the source files
+  std::vector<uint64_t> m_sourceHashes;
+  //! Primitives built with addPrimitive()
+  std::vector<vpPrimitive> m_primitiveList;
+  //! Point coordinates built with addPrimitive()
+  std::vector<double> m_pointList;
+  //! String table built with addPrimitive()
+  std::string m_stringTable;
+
+  //! Number of primitives
+  unsigned int m_nbPrimitives;
+  //! Primitives of a loaded file
+  const vpPrimitive *m_primitives;
+  //! Point coordinates of a loaded file
+  const double *m_points;
+  //! String table of a loaded file
+  const char *m_strings;
+  //! Memory-mapped file content
+  void *m_mapped;
+  //! Size of the memory-mapped file content
+  size_t m_mappedSize;
+  //! File content when memory mapping is not available
+  std::vector<double> m_buffer;
+};
+
+#endif
@@ -106,16 +106,6 @@ public:
 
   // private:
   //#ifndef DOXYGEN_SHOULD_SKIP_THIS
-  //    vpMbtDistanceCircle(const vpMbtDistanceCircle &)
-  //      : name(), index(0), cam(), me(NULL), wmean(1),
-  //        featureEllipse(), isTrackedCircle(true), meEllipse(NULL),
-  //        circle(NULL), radius(0.), p1(NULL), p2(NULL), p3(NULL),
-  //        L(), error(), nbFeature(0), Reinit(false),
-  //        hiddenface(NULL), index_polygon(-1), isvisible(false)
-  //    {
-  //      throw vpException(vpException::functionNotImplementedError, "Not
-  //      implemented!");
-  //    }
   //    vpMbtDistanceCircle &operator=(const vpMbtDistanceCircle &){
   //      throw vpException(vpException::functionNotImplementedError, "Not
   //      implemented!"); return *this;
@@ -124,6 +114,7 @@ public:
 
 public:
   vpMbtDistanceCircle();
+  vpMbtDistanceCircle(const vpMbtDistanceCircle &ci);
   virtual ~vpMbtDistanceCircle();
 
   void buildFrom(const vpPoint &_p1, const vpPoint &_p2, const vpPoint &_p3, double r);
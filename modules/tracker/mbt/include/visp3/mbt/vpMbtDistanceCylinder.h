@@ -119,17 +119,6 @@ public:
 
   // private:
   //#ifndef DOXYGEN_SHOULD_SKIP_THIS
-  //    vpMbtDistanceCylinder(const vpMbtDistanceCylinder &)
-  //      : name(), index(0), cam(), me(NULL), wmean1(1), wmean2(1),
-  //        featureline1(), featureline2(), isTrackedCylinder(true),
-  //        meline1(NULL), meline2(NULL), cercle1(NULL), cercle2(NULL),
-  //        radius(0), p1(NULL), p2(NULL), L(), error(), nbFeature(0),
-  //        nbFeaturel1(0), nbFeaturel2(0), Reinit(false), c(NULL),
-  //        hiddenface(NULL), index_polygon(-1), isvisible(false)
-  //    {
-  //      throw vpException(vpException::functionNotImplementedError, "Not
-  //      implemented!");
-  //    }
   //    vpMbtDistanceCylinder &operator=(const vpMbtDistanceCylinder &){
   //      throw vpException(vpException::functionNotImplementedError, "Not
   //      implemented!"); return *this;
@@ -138,6 +127,7 @@ public:
 
 public:
   vpMbtDistanceCylinder();
+  vpMbtDistanceCylinder(const vpMbtDistanceCylinder &cy);
   virtual ~vpMbtDistanceCylinder();
 
   void buildFrom(const vpPoint &_p1, const vpPoint &_p2, double r);
@@ -112,17 +112,6 @@ public:
 
   // private:
   //#ifndef DOXYGEN_SHOULD_SKIP_THIS
-  //    vpMbtDistanceLine(const vpMbtDistanceLine &)
-  //      : name(), index(0), cam(), me(NULL), isTrackedLine(true),
-  //      isTrackedLineWithVisibility(true),
-  //        wmean(1), featureline(), poly(), useScanLine(false), meline(),
-  //        line(NULL), p1(NULL), p2(NULL), L(), error(), nbFeature(),
-  //        nbFeatureTotal(0), Reinit(false), hiddenface(NULL),
-  //        Lindex_polygon(), Lindex_polygon_tracked(), isvisible(false)
-  //    {
-  //      throw vpException(vpException::functionNotImplementedError, "Not
-  //      implemented!");
-  //    }
   //    vpMbtDistanceLine &operator=(const vpMbtDistanceLine &){
   //      throw vpException(vpException::functionNotImplementedError, "Not
   //      implemented!"); return *this;
@@ -131,6 +120,7 @@ public:
 
 public:
   vpMbtDistanceLine();
+  vpMbtDistanceLine(const vpMbtDistanceLine &l);
   virtual ~vpMbtDistanceLine();
 
   void addPolygon(const int &index);
@@ -233,6 +223,22 @@ public:
   */
   inline void setMeanWeight(double w_mean) { this->wmean = w_mean; }
 
+  /*!
+    Set the moving edge parameters used by the line and its moving edges.
+    Contrary to setMovingEdge(), the moving edges already tracked are kept.
+
+    \param p_me : Pointer to the moving edge parameters.
+  */
+  inline void setMe(vpMe *p_me)
+  {
+    me = p_me;
+    for (size_t i = 0; i < meline.size(); i++) {
+      if (meline[i] != NULL) {
+        meline[i]->setMe(me);
+      }
+    }
+  }
+
   void setMovingEdge(vpMe *Me);
 
   /*!
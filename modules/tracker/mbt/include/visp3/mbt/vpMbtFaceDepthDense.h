@@ -45,6 +45,7 @@
 #endif
 
 #include <visp3/core/vpPlane.h>
+#include <visp3/core/vpPointCloud.h>
 #include <visp3/mbt/vpMbTracker.h>
 #include <visp3/mbt/vpMbtDistanceLine.h>
 
@@ -82,6 +83,7 @@ public:
   bool m_useScanLine;
 
   vpMbtFaceDepthDense();
+  vpMbtFaceDepthDense(const vpMbtFaceDepthDense &face);
   virtual ~vpMbtFaceDepthDense();
 
   void addLine(vpPoint &p1, vpPoint &p2, vpMbHiddenFaces<vpMbtPolygon> *const faces, int polygon = -1,
@@ -108,8 +110,21 @@ public:
                               , const vpImage<bool> *mask = NULL
   );
 
+  bool computeDesiredFeatures(const vpHomogeneousMatrix &cMo, const vpPointCloud &point_cloud, unsigned int stepX,
+                              unsigned int stepY
+#if DEBUG_DISPLAY_DEPTH_DENSE
+                              ,
+                              vpImage<unsigned char> &debugImage, std::vector<std::vector<vpImagePoint> > &roiPts_vec
+#endif
+                              , const vpImage<bool> *mask = NULL
+  );
+
   void computeInteractionMatrixAndResidu(const vpHomogeneousMatrix &cMo, vpMatrix &L, vpColVector &error);
 
+  void computeNormalEquations(const vpHomogeneousMatrix &cMo, const double *const w, vpMatrix &LTL, vpColVector &LTR);
+
+  void computeResidu(const vpHomogeneousMatrix &cMo, double *const error);
+
   void computeVisibility();
   void computeVisibilityDisplay();
 
@@ -128,7 +143,16 @@ public:
                                                        const vpCameraParameters &cam,
                                                        bool displayFullModel = false);
 
-  inline unsigned int getNbFeatures() const { return (unsigned int)(m_pointCloudFace.size() / 3); }
+  inline unsigned int getNbFeatures() const
+  {
+    return m_pointCloud != NULL ? m_nbSpanFeatures : (unsigned int)(m_pointCloudFace.size() / 3);
+  }
+
+  /*!
+    Return true if the features are streamed from an organized point cloud
+    (see computeNormalEquations() and computeResidu()) instead of being stored.
+  */
+  inline bool isStreamed() const { return m_pointCloud != NULL; }
 
   inline bool isTracked() const { return m_isTrackedDepthDenseFace; }
 
@@ -136,6 +160,8 @@ public:
 
   void setCameraParameters(const vpCameraParameters &camera);
 
+  void setLinesHiddenFaces(vpMbHiddenFaces<vpMbtPolygon> *const faces);
+
   void setScanLineVisibilityTest(bool v);
 
   inline void setDepthDenseFilteringMaxDistance(double maxDistance)
@@ -224,8 +250,27 @@ protected:
   std::vector<double> m_pointCloudFace;
   //! Polygon lines used for scan-line visibility
   std::vector<PolygonLine> m_polygonLines;
+  //! Organized point cloud the features are streamed from, NULL if the
+  //! features are stored in m_pointCloudFace
+  const vpPointCloud *m_pointCloud;
+  //! Scanline spans of the face: (row, first column, last column + 1) triplets
+  std::vector<unsigned int> m_spans;
+  //! Sampling step along the spans
+  unsigned int m_spanStepX;
+  //! Number of valid depth points in the spans
+  unsigned int m_nbSpanFeatures;
+  //! Buffers holding the valid points of the span being processed
+  std::vector<double> m_spanX, m_spanY, m_spanZ;
 
 protected:
+  bool computeBoundingBox(const vpHomogeneousMatrix &cMo, unsigned int width, unsigned int height,
+                          std::vector<vpImagePoint> &roiPts,
+#if DEBUG_DISPLAY_DEPTH_DENSE
+                          std::vector<std::vector<vpImagePoint> > &roiPts_vec,
+#endif
+                          vpPolygon &polygon_2d, unsigned int &top, unsigned int &bottom, unsigned int &left,
+                          unsigned int &right);
+
   void computeROI(const vpHomogeneousMatrix &cMo, unsigned int width, unsigned int height,
                   std::vector<vpImagePoint> &roiPts
 #if DEBUG_DISPLAY_DEPTH_DENSE
@@ -235,6 +280,8 @@ protected:
                   ,
                   double &distanceToFace);
 
+  unsigned int loadSpan(size_t s);
+
   bool samePoint(const vpPoint &P1, const vpPoint &P2) const;
 };
 #endif
@@ -45,6 +45,7 @@
 #endif
 
 #include <visp3/core/vpPlane.h>
+#include <visp3/core/vpPointCloud.h>
 #include <visp3/mbt/vpMbTracker.h>
 #include <visp3/mbt/vpMbtDistanceLine.h>
 
@@ -62,8 +63,10 @@ public:
     ROBUST_FEATURE_ESTIMATION = 0,
     ROBUST_SVD_PLANE_ESTIMATION = 1,
 #ifdef VISP_HAVE_PCL
-    PCL_PLANE_ESTIMATION = 2
+    PCL_PLANE_ESTIMATION = 2,
 #endif
+    ROBUST_MOMENTS_PLANE_ESTIMATION = 3 ///< Same estimation as ROBUST_SVD_PLANE_ESTIMATION
+                                        ///< computed from the point moments
   };
 
   //! Camera intrinsic parameters
@@ -84,6 +87,7 @@ public:
   bool m_useScanLine;
 
   vpMbtFaceDepthNormal();
+  vpMbtFaceDepthNormal(const vpMbtFaceDepthNormal &face);
   virtual ~vpMbtFaceDepthNormal();
 
   void addLine(vpPoint &p1, vpPoint &p2, vpMbHiddenFaces<vpMbtPolygon> *const faces, int polygon = -1,
@@ -110,6 +114,15 @@ public:
                               , const vpImage<bool> *mask = NULL
   );
 
+  bool computeDesiredFeatures(const vpHomogeneousMatrix &cMo, const vpPointCloud &point_cloud,
+                              vpColVector &desired_features, unsigned int stepX, unsigned int stepY
+#if DEBUG_DISPLAY_DEPTH_NORMAL
+                              ,
+                              vpImage<unsigned char> &debugImage, std::vector<std::vector<vpImagePoint> > &roiPts_vec
+#endif
+                              , const vpImage<bool> *mask = NULL
+  );
+
   void computeInteractionMatrix(const vpHomogeneousMatrix &cMo, vpMatrix &L, vpColVector &features);
 
   void computeVisibility();
@@ -161,6 +174,8 @@ public:
     m_pclPlaneEstimationRansacThreshold = threshold;
   }
 
+  void setLinesHiddenFaces(vpMbHiddenFaces<vpMbtPolygon> *const faces);
+
   void setScanLineVisibilityTest(bool v);
 
   inline void setTracked(bool tracked) { m_isTrackedDepthNormalFace = tracked; }
@@ -268,16 +283,31 @@ protected:
   double m_pclPlaneEstimationRansacThreshold;
   //!
   std::vector<PolygonLine> m_polygonLines;
+  //! Plane fitting buffers: point coordinates, residues and weights
+  std::vector<double> m_planeFitX, m_planeFitY, m_planeFitZ, m_planeFitResidues, m_planeFitWeights;
 
 #ifdef VISP_HAVE_PCL
   bool computeDesiredFeaturesPCL(const pcl::PointCloud<pcl::PointXYZ>::ConstPtr &point_cloud_face,
                                  vpColVector &desired_features, vpColVector &desired_normal,
                                  vpColVector &centroid_point);
 #endif
+  template <class PointSource>
+  bool computeDesiredFeaturesFromPoints(const vpHomogeneousMatrix &cMo, unsigned int width, unsigned int height,
+                                        const PointSource &point_cloud, vpColVector &desired_features,
+                                        unsigned int stepX, unsigned int stepY
+#if DEBUG_DISPLAY_DEPTH_NORMAL
+                                        ,
+                                        vpImage<unsigned char> &debugImage,
+                                        std::vector<std::vector<vpImagePoint> > &roiPts_vec
+#endif
+                                        , const vpImage<bool> *mask);
   void computeDesiredFeaturesRobustFeatures(const std::vector<double> &point_cloud_face_custom,
                                             const std::vector<double> &point_cloud_face, const vpHomogeneousMatrix &cMo,
                                             vpColVector &desired_features, vpColVector &desired_normal,
                                             vpColVector &centroid_point);
+  void computeDesiredFeaturesMoments(const std::vector<double> &point_cloud_face, const vpHomogeneousMatrix &cMo,
+                                     vpColVector &desired_features, vpColVector &desired_normal,
+                                     vpColVector &centroid_point);
   void computeDesiredFeaturesSVD(const std::vector<double> &point_cloud_face, const vpHomogeneousMatrix &cMo,
                                  vpColVector &desired_features, vpColVector &desired_normal,
                                  vpColVector &centroid_point);
@@ -297,6 +327,9 @@ protected:
   void estimateFeatures(const std::vector<double> &point_cloud_face, const vpHomogeneousMatrix &cMo,
                         vpColVector &x_estimated, std::vector<double> &weights);
 
+  void estimatePlaneEquationMoments(const std::vector<double> &point_cloud_face, const vpHomogeneousMatrix &cMo,
+                                    vpColVector &plane_equation_estimated, vpColVector &centroid);
+
   void estimatePlaneEquationSVD(const std::vector<double> &point_cloud_face, const vpHomogeneousMatrix &cMo,
                                 vpColVector &plane_equation_estimated, vpColVector &centroid);
 
@@ -0,0 +1,159 @@
+/****************************************************************************
+ *
+ * ViSP, open source Visual Servoing Platform software.
+ * Copyright (C) 2005 - 2019 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Parsed configuration of the model-based trackers.
+ *
+ *****************************************************************************/
+
+/*!
+ \file vpMbtXmlConfig.h
+ \brief Parsed XML configuration of the model-based trackers, that can be
+ shared by several trackers and saved in a binary file.
+*/
+
+#ifndef _vpMbtXmlConfig_h_
+#define _vpMbtXmlConfig_h_
+
+#include <visp3/core/vpConfig.h>
+
+#ifdef VISP_HAVE_PUGIXML
+
+#include <stdint.h> //for uint32_t related types ; works also with >= VS2010 / _MSC_VER >= 1600
+#include <string>
+#include <vector>
+
+/*!
+  \class vpMbtXmlConfig
+  \ingroup group_mbt_xml_parser
+
+  \brief Parsed XML configuration of the model-based trackers.
+
+  The configuration file is read once by parse(), which keeps the elements
+  known by vpMbtXmlGenericParser in a flat array of fixed size records. Each
+  record holds the identifier of the element, resolved once from its name,
+  and the value of its text already converted to the numeric types used by
+  the parser. Applying the configuration with
+  vpMbtXmlGenericParser::parse(const vpMbtXmlConfig &) or
+  vpMbGenericTracker::loadConfigFile(const vpMbtXmlConfig &) thus neither
+  reads a file nor compares element names.
+
+  A configuration is not modified when it is applied, so that the same
+  object can be shared by any number of trackers, including from several
+  threads.
+
+  save() writes the configuration in a binary file that load() reads back
+  without any XML parsing.
+
+  \code
+#include <visp3/mbt/vpMbGenericTracker.h>
+
+int main()
+{
+  vpMbtXmlConfig config;
+  config.parse("cube.xml");
+
+  std::vector<vpMbGenericTracker *> trackers;
+  for (unsigned int i = 0; i < 100; i++) {
+    trackers.push_back(new vpMbGenericTracker(1, vpMbGenericTracker::EDGE_TRACKER));
+    trackers.back()->loadConfigFile(config);
+  }
+  // ...
+}
+  \endcode
+*/
+class VISP_EXPORT vpMbtXmlConfig
+{
+public:
+  //! Fixed size record describing an element of the configuration.
+  struct vpNode {
+    //! Identifier of the element name in vpMbtXmlGenericParser, or -1.
+    int32_t id;
+    //! Offset of the element name in the string table.
+    uint32_t nameOffset;
+    //! Length of the element name.
+    uint32_t nameLength;
+    //! Offset of the element text in the string table.
+    uint32_t textOffset;
+    //! Length of the element text.
+    uint32_t textLength;
+    //! Index of the first child element, or -1.
+    int32_t firstChild;
+    //! Index of the next sibling element, or -1.
+    int32_t nextSibling;
+    //! Text converted to an integer.
+    int32_t asInt;
+    //! Text converted to an unsigned integer.
+    uint32_t asUint;
+    //! Padding, always 0.
+    uint32_t reserved;
+    //! Text converted to a floating point value.
+    double asDouble;
+  };
+
+  vpMbtXmlConfig();
+  explicit vpMbtXmlConfig(const std::string &filename);
+
+  void clear();
+
+  void decode(const unsigned char *data, size_t size);
+
+  /*!
+    Return true if no configuration has been parsed or loaded.
+  */
+  inline bool empty() const { return m_nodes.empty(); }
+
+  void encode(std::vector<unsigned char> &data) const;
+
+  std::string getName(const vpNode &node) const;
+  /*!
+    Return the number of elements of the configuration. The first element is
+    the root element of the file.
+  */
+  inline unsigned int getNbNodes() const { return static_cast<unsigned int>(m_nodes.size()); }
+  const vpNode &getNode(unsigned int index) const;
+  std::string getText(const vpNode &node) const;
+
+  void load(const std::string &filename);
+
+  void parse(const std::string &filename);
+
+  void save(const std::string &filename) const;
+
+private:
+  //! Elements of the configuration, in depth-first order
+  std::vector<vpNode> m_nodes;
+  //! Names and texts of the elements
+  std::string m_stringTable;
+};
+
+#endif
+
+#endif
@@ -48,6 +48,7 @@
 
 #include <visp3/core/vpCameraParameters.h>
 #include <visp3/mbt/vpMbtFaceDepthNormal.h>
+#include <visp3/mbt/vpMbtXmlConfig.h>
 #include <visp3/me/vpMe.h>
 
 /*!
@@ -104,6 +105,7 @@ public:
   double getKltMinDistance() const;
   unsigned int getKltPyramidLevels() const;
   double getKltQuality() const;
+  bool getKltUseNative() const;
   unsigned int getKltWindowSize() const;
 
   bool getLodState() const;
@@ -112,6 +114,8 @@ public:
 
   double getNearClippingDistance() const;
 
+  static int getNodeId(const std::string &name);
+
   void getProjectionErrorMe(vpMe &me) const;
 
   unsigned int getProjectionErrorKernelSize() const;
@@ -120,6 +124,7 @@ public:
   bool hasNearClippingDistance() const;
 
   void parse(const std::string &filename);
+  void parse(const vpMbtXmlConfig &config);
 
   void setAngleAppear(const double &aappear);
   void setAngleDisappear(const double &adisappear);
@@ -147,6 +152,7 @@ public:
   void setKltMinDistance(const double &mD);
   void setKltPyramidLevels(const unsigned int &pL);
   void setKltQuality(const double &q);
+  void setKltUseNative(bool useNative);
   void setKltWindowSize(const unsigned int &w);
 
   void setNearClippingDistance(const double &nclip);
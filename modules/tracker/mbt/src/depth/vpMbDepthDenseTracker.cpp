@@ -240,6 +240,136 @@ void vpMbDepthDenseTracker::computeVVS()
   computeCovarianceMatrixVVS(isoJoIdentity_, m_w_depthDense, cMo_prev, L_true, LVJ_true, m_error_depthDense);
 }
 
+/*!
+  Pose estimation when all the active faces stream their features from an
+  organized point cloud (see vpMbtFaceDepthDense::computeNormalEquations()).
+  Only the residuals and the weights are stored: the interaction matrix is
+  never built and the 6x6 normal equations are directly accumulated per face.
+*/
+void vpMbDepthDenseTracker::computeVVSNormalEquations()
+{
+  double normRes = 0;
+  double normRes_1 = -1;
+  unsigned int iter = 0;
+
+  m_denseDepthNbFeatures = 0;
+  for (std::vector<vpMbtFaceDepthDense *>::const_iterator it = m_depthDenseListOfActiveFaces.begin();
+       it != m_depthDenseListOfActiveFaces.end(); ++it) {
+    m_denseDepthNbFeatures += (*it)->getNbFeatures();
+  }
+
+  m_L_depthDense.resize(0, 0);
+  m_error_depthDense.resize(m_denseDepthNbFeatures, false);
+  m_weightedError_depthDense.resize(0);
+  m_w_depthDense.resize(m_denseDepthNbFeatures, false);
+  m_w_depthDense = 1;
+
+  vpColVector error_prev(m_denseDepthNbFeatures);
+  vpMatrix LTL(6, 6);
+  vpColVector LTR(6), v;
+
+  double mu = m_initialMu;
+  vpHomogeneousMatrix cMo_prev;
+
+  bool isoJoIdentity_ = true;
+  vpVelocityTwistMatrix cVo;
+
+  while (std::fabs(normRes_1 - normRes) > m_stopCriteriaEpsilon && (iter < m_maxIter)) {
+    unsigned int start_index = 0;
+    for (std::vector<vpMbtFaceDepthDense *>::const_iterator it = m_depthDenseListOfActiveFaces.begin();
+         it != m_depthDenseListOfActiveFaces.end(); ++it) {
+      (*it)->computeResidu(m_cMo, m_error_depthDense.data + start_index);
+      start_index += (*it)->getNbFeatures();
+    }
+
+    bool reStartFromLastIncrement = false;
+    computeVVSCheckLevenbergMarquardt(iter, m_error_depthDense, error_prev, cMo_prev, mu, reStartFromLastIncrement);
+
+    if (!reStartFromLastIncrement) {
+      computeVVSWeights();
+
+      LTL = 0;
+      LTR = 0;
+      start_index = 0;
+      for (std::vector<vpMbtFaceDepthDense *>::const_iterator it = m_depthDenseListOfActiveFaces.begin();
+           it != m_depthDenseListOfActiveFaces.end(); ++it) {
+        (*it)->computeNormalEquations(m_cMo, m_w_depthDense.data + start_index, LTL, LTR);
+        start_index += (*it)->getNbFeatures();
+      }
+
+      cVo.buildFrom(m_cMo);
+
+      // Compute DoF only once
+      if (iter == 0) {
+        isoJoIdentity_ = true;
+        oJo.eye();
+
+        // The kernel of L cVo is the kernel of (L cVo)^T (L cVo), whose
+        // singular values are the squared singular values of L cVo
+        vpMatrix K; // kernel
+        unsigned int rank = (vpMatrix(cVo).t() * LTL * cVo).kernel(K, 1e-12);
+        if (rank == 0) {
+          throw vpException(vpException::fatalError, "Rank=0, cannot estimate the pose !");
+        }
+
+        if (rank != 6) {
+          vpMatrix I; // Identity
+          I.eye(6);
+          oJo = I - K.AtA();
+
+          isoJoIdentity_ = false;
+        }
+      }
+
+      double num = 0.0, den = 0.0;
+      for (unsigned int i = 0; i < m_denseDepthNbFeatures; i++) {
+        // Compute stop criteria
+        num += m_w_depthDense[i] * vpMath::sqr(m_error_depthDense[i]);
+        den += m_w_depthDense[i];
+      }
+
+      vpMatrix J;
+      if (!isoJoIdentity_) {
+        J = cVo * oJo;
+        LTL = J.t() * LTL * J;
+        LTR = J.t() * LTR;
+      }
+
+      switch (m_optimizationMethod) {
+      case vpMbTracker::LEVENBERG_MARQUARDT_OPT: {
+        vpMatrix LMA(6, 6);
+        LMA.eye();
+        vpMatrix LTLmuI = LTL + (LMA * mu);
+        v = -m_lambda * LTLmuI.pseudoInverse(LTLmuI.getRows() * std::numeric_limits<double>::epsilon()) * LTR;
+
+        if (iter != 0)
+          mu /= 10.0;
+
+        error_prev = m_error_depthDense;
+        break;
+      }
+
+      case vpMbTracker::GAUSS_NEWTON_OPT:
+      default:
+        v = -m_lambda * LTL.pseudoInverse(LTL.getRows() * std::numeric_limits<double>::epsilon()) * LTR;
+        break;
+      }
+
+      if (!isoJoIdentity_) {
+        v = cVo * v;
+      }
+
+      cMo_prev = m_cMo;
+      m_cMo = vpExponentialMap::direct(v).inverse() * m_cMo;
+
+      normRes_1 = normRes;
+      normRes = sqrt(num / den);
+    }
+
+    iter++;
+  }
+}
+
 void vpMbDepthDenseTracker::computeVVSInit()
 {
   m_denseDepthNbFeatures = 0;
@@ -656,6 +786,62 @@ void vpMbDepthDenseTracker::segmentPointCloud(const std::vector<vpColVector> &po
 #endif
 }
 
+void vpMbDepthDenseTracker::segmentPointCloud(const vpPointCloud &point_cloud)
+{
+  m_depthDenseListOfActiveFaces.clear();
+
+#if DEBUG_DISPLAY_DEPTH_DENSE
+  if (!m_debugDisp_depthDense->isInitialised()) {
+    m_debugImage_depthDense.resize(point_cloud.getHeight(), point_cloud.getWidth());
+    m_debugDisp_depthDense->init(m_debugImage_depthDense, 50, 0, "Debug display dense depth tracker");
+  }
+
+  m_debugImage_depthDense = 0;
+  std::vector<std::vector<vpImagePoint> > roiPts_vec;
+#endif
+
+  for (std::vector<vpMbtFaceDepthDense *>::iterator it = m_depthDenseFaces.begin();
+       it != m_depthDenseFaces.end(); ++it) {
+    vpMbtFaceDepthDense *face = *it;
+
+    if (face->isVisible() && face->isTracked()) {
+#if DEBUG_DISPLAY_DEPTH_DENSE
+      std::vector<std::vector<vpImagePoint> > roiPts_vec_;
+#endif
+      if (face->computeDesiredFeatures(m_cMo, point_cloud, m_depthDenseSamplingStepX, m_depthDenseSamplingStepY
+#if DEBUG_DISPLAY_DEPTH_DENSE
+                                       ,
+                                       m_debugImage_depthDense, roiPts_vec_
+#endif
+                                       , m_mask
+                                       )) {
+        m_depthDenseListOfActiveFaces.push_back(*it);
+
+#if DEBUG_DISPLAY_DEPTH_DENSE
+        roiPts_vec.insert(roiPts_vec.end(), roiPts_vec_.begin(), roiPts_vec_.end());
+#endif
+      }
+    }
+  }
+
+#if DEBUG_DISPLAY_DEPTH_DENSE
+  vpDisplay::display(m_debugImage_depthDense);
+
+  for (size_t i = 0; i < roiPts_vec.size(); i++) {
+    if (roiPts_vec[i].empty())
+      continue;
+
+    for (size_t j = 0; j < roiPts_vec[i].size() - 1; j++) {
+      vpDisplay::displayLine(m_debugImage_depthDense, roiPts_vec[i][j], roiPts_vec[i][j + 1], vpColor::red, 2);
+    }
+    vpDisplay::displayLine(m_debugImage_depthDense, roiPts_vec[i][0], roiPts_vec[i][roiPts_vec[i].size() - 1],
+                           vpColor::red, 2);
+  }
+
+  vpDisplay::flush(m_debugImage_depthDense);
+#endif
+}
+
 void vpMbDepthDenseTracker::setOgreVisibilityTest(const bool &v)
 {
   vpMbTracker::setOgreVisibilityTest(v);
@@ -741,6 +927,20 @@ void vpMbDepthDenseTracker::track(const std::vector<vpColVector> &point_cloud, u
   computeVisibility(width, height);
 }
 
+void vpMbDepthDenseTracker::track(const vpPointCloud &point_cloud)
+{
+  segmentPointCloud(point_cloud);
+
+  // The covariance estimation needs the full interaction matrix
+  if (computeCovariance) {
+    computeVVS();
+  } else {
+    computeVVSNormalEquations();
+  }
+
+  computeVisibility(point_cloud.getWidth(), point_cloud.getHeight());
+}
+
 void vpMbDepthDenseTracker::initCircle(const vpPoint & /*p1*/, const vpPoint & /*p2*/, const vpPoint & /*p3*/,
                                        double /*radius*/, int /*idFace*/, const std::string & /*name*/)
 {
@@ -584,71 +584,64 @@ void vpMbDepthNormalTracker::setUseDepthNormalTracking(const std::string &name,
 
 void vpMbDepthNormalTracker::testTracking() {}
 
+namespace
+{
+// Desired features of a face for each type of point cloud, so that the faces
+// are segmented by vpMbDepthNormalTracker::segmentFaces() whatever the input
 #ifdef VISP_HAVE_PCL
-void vpMbDepthNormalTracker::segmentPointCloud(const pcl::PointCloud<pcl::PointXYZ>::ConstPtr &point_cloud)
+bool computeFaceDesiredFeatures(vpMbtFaceDepthNormal *face, const vpHomogeneousMatrix &cMo,
+                                const pcl::PointCloud<pcl::PointXYZ>::ConstPtr &point_cloud, unsigned int width,
+                                unsigned int height, vpColVector &desired_features, unsigned int stepX,
+                                unsigned int stepY,
+#if DEBUG_DISPLAY_DEPTH_NORMAL
+                                vpImage<unsigned char> &debugImage,
+                                std::vector<std::vector<vpImagePoint> > &roiPts_vec,
+#endif
+                                const vpImage<bool> *mask)
 {
-  m_depthNormalListOfActiveFaces.clear();
-  m_depthNormalListOfDesiredFeatures.clear();
-
+  return face->computeDesiredFeatures(cMo, width, height, point_cloud, desired_features, stepX, stepY,
 #if DEBUG_DISPLAY_DEPTH_NORMAL
-  if (!m_debugDisp_depthNormal->isInitialised()) {
-    m_debugImage_depthNormal.resize(point_cloud->height, point_cloud->width);
-    m_debugDisp_depthNormal->init(m_debugImage_depthNormal, 50, 0, "Debug display normal depth tracker");
-  }
-
-  m_debugImage_depthNormal = 0;
-  std::vector<std::vector<vpImagePoint> > roiPts_vec;
+                                      debugImage, roiPts_vec,
+#endif
+                                      mask);
+}
 #endif
 
-  for (std::vector<vpMbtFaceDepthNormal *>::iterator it = m_depthNormalFaces.begin(); it != m_depthNormalFaces.end();
-       ++it) {
-    vpMbtFaceDepthNormal *face = *it;
-
-    if (face->isVisible() && face->isTracked()) {
-      vpColVector desired_features;
-
+bool computeFaceDesiredFeatures(vpMbtFaceDepthNormal *face, const vpHomogeneousMatrix &cMo,
+                                const std::vector<vpColVector> &point_cloud, unsigned int width, unsigned int height,
+                                vpColVector &desired_features, unsigned int stepX, unsigned int stepY,
 #if DEBUG_DISPLAY_DEPTH_NORMAL
-      std::vector<std::vector<vpImagePoint> > roiPts_vec_;
+                                vpImage<unsigned char> &debugImage,
+                                std::vector<std::vector<vpImagePoint> > &roiPts_vec,
 #endif
-      if (face->computeDesiredFeatures(m_cMo, point_cloud->width, point_cloud->height, point_cloud, desired_features,
-                                       m_depthNormalSamplingStepX, m_depthNormalSamplingStepY
+                                const vpImage<bool> *mask)
+{
+  return face->computeDesiredFeatures(cMo, width, height, point_cloud, desired_features, stepX, stepY,
 #if DEBUG_DISPLAY_DEPTH_NORMAL
-                                       ,
-                                       m_debugImage_depthNormal, roiPts_vec_
+                                      debugImage, roiPts_vec,
 #endif
-                                       , m_mask
-                                       )) {
-        m_depthNormalListOfDesiredFeatures.push_back(desired_features);
-        m_depthNormalListOfActiveFaces.push_back(face);
+                                      mask);
+}
 
+bool computeFaceDesiredFeatures(vpMbtFaceDepthNormal *face, const vpHomogeneousMatrix &cMo,
+                                const vpPointCloud &point_cloud, unsigned int, unsigned int,
+                                vpColVector &desired_features, unsigned int stepX, unsigned int stepY,
 #if DEBUG_DISPLAY_DEPTH_NORMAL
-        roiPts_vec.insert(roiPts_vec.end(), roiPts_vec_.begin(), roiPts_vec_.end());
+                                vpImage<unsigned char> &debugImage,
+                                std::vector<std::vector<vpImagePoint> > &roiPts_vec,
 #endif
-      }
-    }
-  }
-
+                                const vpImage<bool> *mask)
+{
+  return face->computeDesiredFeatures(cMo, point_cloud, desired_features, stepX, stepY,
 #if DEBUG_DISPLAY_DEPTH_NORMAL
-  vpDisplay::display(m_debugImage_depthNormal);
-
-  for (size_t i = 0; i < roiPts_vec.size(); i++) {
-    if (roiPts_vec[i].empty())
-      continue;
-
-    for (size_t j = 0; j < roiPts_vec[i].size() - 1; j++) {
-      vpDisplay::displayLine(m_debugImage_depthNormal, roiPts_vec[i][j], roiPts_vec[i][j + 1], vpColor::red, 2);
-    }
-    vpDisplay::displayLine(m_debugImage_depthNormal, roiPts_vec[i][0], roiPts_vec[i][roiPts_vec[i].size() - 1],
-                           vpColor::red, 2);
-  }
-
-  vpDisplay::flush(m_debugImage_depthNormal);
+                                      debugImage, roiPts_vec,
 #endif
+                                      mask);
+}
 }
-#endif
 
-void vpMbDepthNormalTracker::segmentPointCloud(const std::vector<vpColVector> &point_cloud, unsigned int width,
-                                               unsigned int height)
+template <class PointCloudType>
+void vpMbDepthNormalTracker::segmentFaces(const PointCloudType &point_cloud, unsigned int width, unsigned int height)
 {
   m_depthNormalListOfActiveFaces.clear();
   m_depthNormalListOfDesiredFeatures.clear();
@@ -663,27 +656,29 @@ void vpMbDepthNormalTracker::segmentPointCloud(const std::vector<vpColVector> &p
   std::vector<std::vector<vpImagePoint> > roiPts_vec;
 #endif
 
-  for (std::vector<vpMbtFaceDepthNormal *>::iterator it = m_depthNormalFaces.begin(); it != m_depthNormalFaces.end();
-       ++it) {
-    vpMbtFaceDepthNormal *face = *it;
+  // The faces are independent and can be processed in parallel
+  std::vector<vpColVector> desired_features(m_depthNormalFaces.size());
+  std::vector<unsigned char> is_active(m_depthNormalFaces.size(), 0);
+
+#if defined(VISP_HAVE_OPENMP) && !DEBUG_DISPLAY_DEPTH_NORMAL
+#pragma omp parallel for schedule(dynamic)
+#endif
+  for (int i = 0; i < static_cast<int>(m_depthNormalFaces.size()); i++) {
+    vpMbtFaceDepthNormal *face = m_depthNormalFaces[i];
 
     if (face->isVisible() && face->isTracked()) {
-      vpColVector desired_features;
 
 #if DEBUG_DISPLAY_DEPTH_NORMAL
       std::vector<std::vector<vpImagePoint> > roiPts_vec_;
 #endif
 
-      if (face->computeDesiredFeatures(m_cMo, width, height, point_cloud, desired_features, m_depthNormalSamplingStepX,
-                                       m_depthNormalSamplingStepY
+      if (computeFaceDesiredFeatures(face, m_cMo, point_cloud, width, height, desired_features[i],
+                                     m_depthNormalSamplingStepX, m_depthNormalSamplingStepY,
 #if DEBUG_DISPLAY_DEPTH_NORMAL
-                                       ,
-                                       m_debugImage_depthNormal, roiPts_vec_
+                                     m_debugImage_depthNormal, roiPts_vec_,
 #endif
-                                       , m_mask
-                                       )) {
-        m_depthNormalListOfDesiredFeatures.push_back(desired_features);
-        m_depthNormalListOfActiveFaces.push_back(face);
+                                     m_mask)) {
+        is_active[i] = 1;
 
 #if DEBUG_DISPLAY_DEPTH_NORMAL
         roiPts_vec.insert(roiPts_vec.end(), roiPts_vec_.begin(), roiPts_vec_.end());
@@ -692,6 +687,13 @@ void vpMbDepthNormalTracker::segmentPointCloud(const std::vector<vpColVector> &p
     }
   }
 
+  for (size_t i = 0; i < m_depthNormalFaces.size(); i++) {
+    if (is_active[i]) {
+      m_depthNormalListOfDesiredFeatures.push_back(desired_features[i]);
+      m_depthNormalListOfActiveFaces.push_back(m_depthNormalFaces[i]);
+    }
+  }
+
 #if DEBUG_DISPLAY_DEPTH_NORMAL
   vpDisplay::display(m_debugImage_depthNormal);
 
@@ -710,6 +712,24 @@ void vpMbDepthNormalTracker::segmentPointCloud(const std::vector<vpColVector> &p
 #endif
 }
 
+#ifdef VISP_HAVE_PCL
+void vpMbDepthNormalTracker::segmentPointCloud(const pcl::PointCloud<pcl::PointXYZ>::ConstPtr &point_cloud)
+{
+  segmentFaces(point_cloud, point_cloud->width, point_cloud->height);
+}
+#endif
+
+void vpMbDepthNormalTracker::segmentPointCloud(const std::vector<vpColVector> &point_cloud, unsigned int width,
+                                               unsigned int height)
+{
+  segmentFaces(point_cloud, width, height);
+}
+
+void vpMbDepthNormalTracker::segmentPointCloud(const vpPointCloud &point_cloud)
+{
+  segmentFaces(point_cloud, point_cloud.getWidth(), point_cloud.getHeight());
+}
+
 void vpMbDepthNormalTracker::setCameraParameters(const vpCameraParameters &cam)
 {
   m_cam = cam;
@@ -815,6 +835,15 @@ void vpMbDepthNormalTracker::track(const std::vector<vpColVector> &point_cloud,
   computeVisibility(width, height);
 }
 
+void vpMbDepthNormalTracker::track(const vpPointCloud &point_cloud)
+{
+  segmentPointCloud(point_cloud);
+
+  computeVVS();
+
+  computeVisibility(point_cloud.getWidth(), point_cloud.getHeight());
+}
+
 void vpMbDepthNormalTracker::initCircle(const vpPoint & /*p1*/, const vpPoint & /*p2*/, const vpPoint & /*p3*/,
                                         double /*radius*/, int /*idFace*/, const std::string & /*name*/)
 {
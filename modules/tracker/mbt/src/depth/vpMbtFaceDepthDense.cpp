@@ -33,6 +33,8 @@
  *
  *****************************************************************************/
 
+#include <algorithm>
+
 #include <visp3/core/vpCPUFeatures.h>
 #include <visp3/mbt/vpMbtFaceDepthDense.h>
 
@@ -52,15 +54,241 @@
 #define USE_SSE 0
 #endif
 
+#if defined __AVX__
+#include <immintrin.h>
+#define VISP_HAVE_AVX 1
+#endif
+
+#if defined __ARM_NEON && defined __aarch64__
+#include <arm_neon.h>
+#define VISP_HAVE_NEON 1
+#endif
+
+namespace
+{
+// Point-to-plane residuals: r = n.P + D
+void computeResiduals(const double *X, const double *Y, const double *Z, unsigned int n, double nx, double ny,
+                      double nz, double D, double *r)
+{
+  unsigned int k = 0;
+
+#if VISP_HAVE_AVX
+  if (vpCPUFeatures::checkAVX()) {
+    const __m256d vnx = _mm256_set1_pd(nx);
+    const __m256d vny = _mm256_set1_pd(ny);
+    const __m256d vnz = _mm256_set1_pd(nz);
+    const __m256d vD = _mm256_set1_pd(D);
+
+    for (; k + 4 <= n; k += 4) {
+      __m256d res = _mm256_add_pd(vD, _mm256_mul_pd(vnx, _mm256_loadu_pd(X + k)));
+      res = _mm256_add_pd(res, _mm256_mul_pd(vny, _mm256_loadu_pd(Y + k)));
+      res = _mm256_add_pd(res, _mm256_mul_pd(vnz, _mm256_loadu_pd(Z + k)));
+      _mm256_storeu_pd(r + k, res);
+    }
+
+    _mm256_zeroupper();
+  }
+#endif
+
+#if USE_SSE
+  if (vpCPUFeatures::checkSSE2()) {
+    const __m128d vnx = _mm_set1_pd(nx);
+    const __m128d vny = _mm_set1_pd(ny);
+    const __m128d vnz = _mm_set1_pd(nz);
+    const __m128d vD = _mm_set1_pd(D);
+
+    for (; k + 2 <= n; k += 2) {
+      __m128d res = _mm_add_pd(vD, _mm_mul_pd(vnx, _mm_loadu_pd(X + k)));
+      res = _mm_add_pd(res, _mm_mul_pd(vny, _mm_loadu_pd(Y + k)));
+      res = _mm_add_pd(res, _mm_mul_pd(vnz, _mm_loadu_pd(Z + k)));
+      _mm_storeu_pd(r + k, res);
+    }
+  }
+#elif VISP_HAVE_NEON
+  const float64x2_t vnx = vdupq_n_f64(nx);
+  const float64x2_t vny = vdupq_n_f64(ny);
+  const float64x2_t vnz = vdupq_n_f64(nz);
+  const float64x2_t vD = vdupq_n_f64(D);
+
+  for (; k + 2 <= n; k += 2) {
+    float64x2_t res = vfmaq_f64(vD, vnx, vld1q_f64(X + k));
+    res = vfmaq_f64(res, vny, vld1q_f64(Y + k));
+    res = vfmaq_f64(res, vnz, vld1q_f64(Z + k));
+    vst1q_f64(r + k, res);
+  }
+#endif
+
+  for (; k < n; k++) {
+    r[k] = nx * X[k] + ny * Y[k] + nz * Z[k] + D;
+  }
+}
+
+// Weighted moments of the points, the weights being squared as in (WL)^T (WL):
+// m = [sum w^2, sum w^2 X, sum w^2 Y, sum w^2 Z, sum w^2 XX, sum w^2 XY, sum w^2 XZ, sum w^2 YY, sum w^2 YZ,
+// sum w^2 ZZ]
+void accumulateMoments(const double *X, const double *Y, const double *Z, const double *w, unsigned int n,
+                       double *m)
+{
+  unsigned int k = 0;
+
+#if VISP_HAVE_AVX
+  if (vpCPUFeatures::checkAVX()) {
+    __m256d acc[10];
+    for (int l = 0; l < 10; l++) {
+      acc[l] = _mm256_setzero_pd();
+    }
+
+    for (; k + 4 <= n; k += 4) {
+      const __m256d vw = _mm256_loadu_pd(w + k);
+      const __m256d vx = _mm256_loadu_pd(X + k);
+      const __m256d vy = _mm256_loadu_pd(Y + k);
+      const __m256d vz = _mm256_loadu_pd(Z + k);
+      const __m256d w2 = _mm256_mul_pd(vw, vw);
+      const __m256d wx = _mm256_mul_pd(w2, vx);
+      const __m256d wy = _mm256_mul_pd(w2, vy);
+      const __m256d wz = _mm256_mul_pd(w2, vz);
+
+      acc[0] = _mm256_add_pd(acc[0], w2);
+      acc[1] = _mm256_add_pd(acc[1], wx);
+      acc[2] = _mm256_add_pd(acc[2], wy);
+      acc[3] = _mm256_add_pd(acc[3], wz);
+      acc[4] = _mm256_add_pd(acc[4], _mm256_mul_pd(wx, vx));
+      acc[5] = _mm256_add_pd(acc[5], _mm256_mul_pd(wx, vy));
+      acc[6] = _mm256_add_pd(acc[6], _mm256_mul_pd(wx, vz));
+      acc[7] = _mm256_add_pd(acc[7], _mm256_mul_pd(wy, vy));
+      acc[8] = _mm256_add_pd(acc[8], _mm256_mul_pd(wy, vz));
+      acc[9] = _mm256_add_pd(acc[9], _mm256_mul_pd(wz, vz));
+    }
+
+    double tmp[4];
+    for (int l = 0; l < 10; l++) {
+      _mm256_storeu_pd(tmp, acc[l]);
+      m[l] += tmp[0] + tmp[1] + tmp[2] + tmp[3];
+    }
+
+    _mm256_zeroupper();
+  }
+#endif
+
+#if USE_SSE
+  if (vpCPUFeatures::checkSSE2()) {
+    __m128d acc[10];
+    for (int l = 0; l < 10; l++) {
+      acc[l] = _mm_setzero_pd();
+    }
+
+    for (; k + 2 <= n; k += 2) {
+      const __m128d vw = _mm_loadu_pd(w + k);
+      const __m128d vx = _mm_loadu_pd(X + k);
+      const __m128d vy = _mm_loadu_pd(Y + k);
+      const __m128d vz = _mm_loadu_pd(Z + k);
+      const __m128d w2 = _mm_mul_pd(vw, vw);
+      const __m128d wx = _mm_mul_pd(w2, vx);
+      const __m128d wy = _mm_mul_pd(w2, vy);
+      const __m128d wz = _mm_mul_pd(w2, vz);
+
+      acc[0] = _mm_add_pd(acc[0], w2);
+      acc[1] = _mm_add_pd(acc[1], wx);
+      acc[2] = _mm_add_pd(acc[2], wy);
+      acc[3] = _mm_add_pd(acc[3], wz);
+      acc[4] = _mm_add_pd(acc[4], _mm_mul_pd(wx, vx));
+      acc[5] = _mm_add_pd(acc[5], _mm_mul_pd(wx, vy));
+      acc[6] = _mm_add_pd(acc[6], _mm_mul_pd(wx, vz));
+      acc[7] = _mm_add_pd(acc[7], _mm_mul_pd(wy, vy));
+      acc[8] = _mm_add_pd(acc[8], _mm_mul_pd(wy, vz));
+      acc[9] = _mm_add_pd(acc[9], _mm_mul_pd(wz, vz));
+    }
+
+    double tmp[2];
+    for (int l = 0; l < 10; l++) {
+      _mm_storeu_pd(tmp, acc[l]);
+      m[l] += tmp[0] + tmp[1];
+    }
+  }
+#elif VISP_HAVE_NEON
+  float64x2_t acc[10];
+  for (int l = 0; l < 10; l++) {
+    acc[l] = vdupq_n_f64(0.0);
+  }
+
+  for (; k + 2 <= n; k += 2) {
+    const float64x2_t vw = vld1q_f64(w + k);
+    const float64x2_t vx = vld1q_f64(X + k);
+    const float64x2_t vy = vld1q_f64(Y + k);
+    const float64x2_t vz = vld1q_f64(Z + k);
+    const float64x2_t w2 = vmulq_f64(vw, vw);
+    const float64x2_t wx = vmulq_f64(w2, vx);
+    const float64x2_t wy = vmulq_f64(w2, vy);
+    const float64x2_t wz = vmulq_f64(w2, vz);
+
+    acc[0] = vaddq_f64(acc[0], w2);
+    acc[1] = vaddq_f64(acc[1], wx);
+    acc[2] = vaddq_f64(acc[2], wy);
+    acc[3] = vaddq_f64(acc[3], wz);
+    acc[4] = vfmaq_f64(acc[4], wx, vx);
+    acc[5] = vfmaq_f64(acc[5], wx, vy);
+    acc[6] = vfmaq_f64(acc[6], wx, vz);
+    acc[7] = vfmaq_f64(acc[7], wy, vy);
+    acc[8] = vfmaq_f64(acc[8], wy, vz);
+    acc[9] = vfmaq_f64(acc[9], wz, vz);
+  }
+
+  for (int l = 0; l < 10; l++) {
+    m[l] += vaddvq_f64(acc[l]);
+  }
+#endif
+
+  for (; k < n; k++) {
+    const double w2 = w[k] * w[k];
+    const double wx = w2 * X[k], wy = w2 * Y[k], wz = w2 * Z[k];
+    m[0] += w2;
+    m[1] += wx;
+    m[2] += wy;
+    m[3] += wz;
+    m[4] += wx * X[k];
+    m[5] += wx * Y[k];
+    m[6] += wx * Z[k];
+    m[7] += wy * Y[k];
+    m[8] += wy * Z[k];
+    m[9] += wz * Z[k];
+  }
+}
+} // namespace
+
 vpMbtFaceDepthDense::vpMbtFaceDepthDense()
   : m_cam(), m_clippingFlag(vpPolygon3D::NO_CLIPPING), m_distFarClip(100), m_distNearClip(0.001), m_hiddenFace(NULL),
     m_planeObject(), m_polygon(NULL), m_useScanLine(false),
     m_depthDenseFilteringMethod(DEPTH_OCCUPANCY_RATIO_FILTERING), m_depthDenseFilteringMaxDist(3.0),
     m_depthDenseFilteringMinDist(0.8), m_depthDenseFilteringOccupancyRatio(0.3), m_isTrackedDepthDenseFace(true),
-    m_isVisible(false), m_listOfFaceLines(), m_planeCamera(), m_pointCloudFace(), m_polygonLines()
+    m_isVisible(false), m_listOfFaceLines(), m_planeCamera(), m_pointCloudFace(), m_polygonLines(), m_pointCloud(NULL),
+    m_spans(), m_spanStepX(1), m_nbSpanFeatures(0), m_spanX(), m_spanY(), m_spanZ()
 {
 }
 
+/*!
+  Copy constructor. The face lines are duplicated, the polygon and the hidden
+  faces are shared with \e face.
+
+  \param face : Face to copy.
+*/
+vpMbtFaceDepthDense::vpMbtFaceDepthDense(const vpMbtFaceDepthDense &face)
+  : m_cam(face.m_cam), m_clippingFlag(face.m_clippingFlag), m_distFarClip(face.m_distFarClip),
+    m_distNearClip(face.m_distNearClip), m_hiddenFace(face.m_hiddenFace), m_planeObject(face.m_planeObject),
+    m_polygon(face.m_polygon), m_useScanLine(face.m_useScanLine),
+    m_depthDenseFilteringMethod(face.m_depthDenseFilteringMethod),
+    m_depthDenseFilteringMaxDist(face.m_depthDenseFilteringMaxDist),
+    m_depthDenseFilteringMinDist(face.m_depthDenseFilteringMinDist),
+    m_depthDenseFilteringOccupancyRatio(face.m_depthDenseFilteringOccupancyRatio),
+    m_isTrackedDepthDenseFace(face.m_isTrackedDepthDenseFace), m_isVisible(face.m_isVisible), m_listOfFaceLines(),
+    m_planeCamera(face.m_planeCamera), m_pointCloudFace(face.m_pointCloudFace), m_polygonLines(face.m_polygonLines),
+    m_pointCloud(face.m_pointCloud), m_spans(face.m_spans), m_spanStepX(face.m_spanStepX),
+    m_nbSpanFeatures(face.m_nbSpanFeatures), m_spanX(), m_spanY(), m_spanZ()
+{
+  for (size_t i = 0; i < face.m_listOfFaceLines.size(); i++) {
+    m_listOfFaceLines.push_back(new vpMbtDistanceLine(*face.m_listOfFaceLines[i]));
+  }
+}
+
 vpMbtFaceDepthDense::~vpMbtFaceDepthDense()
 {
   for (size_t i = 0; i < m_listOfFaceLines.size(); i++) {
@@ -141,25 +369,21 @@ void vpMbtFaceDepthDense::addLine(vpPoint &P1, vpPoint &P2, vpMbHiddenFaces<vpMb
   }
 }
 
-#ifdef VISP_HAVE_PCL
-bool vpMbtFaceDepthDense::computeDesiredFeatures(const vpHomogeneousMatrix &cMo,
-                                                 const pcl::PointCloud<pcl::PointXYZ>::ConstPtr &point_cloud,
-                                                 unsigned int stepX, unsigned int stepY
+/*!
+  Compute the region of interest of the face and its bounding box clipped to
+  the \e width x \e height image.
+
+  \return false if the face is not visible or is filtered out because of its
+  distance to the camera, true otherwise.
+*/
+bool vpMbtFaceDepthDense::computeBoundingBox(const vpHomogeneousMatrix &cMo, unsigned int width, unsigned int height,
+                                             std::vector<vpImagePoint> &roiPts,
 #if DEBUG_DISPLAY_DEPTH_DENSE
-                                                 ,
-                                                 vpImage<unsigned char> &debugImage,
-                                                 std::vector<std::vector<vpImagePoint> > &roiPts_vec
+                                             std::vector<std::vector<vpImagePoint> > &roiPts_vec,
 #endif
-                                                 , const vpImage<bool> *mask
-)
+                                             vpPolygon &polygon_2d, unsigned int &top, unsigned int &bottom,
+                                             unsigned int &left, unsigned int &right)
 {
-  unsigned int width = point_cloud->width, height = point_cloud->height;
-  m_pointCloudFace.clear();
-
-  if (point_cloud->width == 0 || point_cloud->height == 0)
-    return false;
-
-  std::vector<vpImagePoint> roiPts;
   double distanceToFace;
   computeROI(cMo, width, height, roiPts
 #if DEBUG_DISPLAY_DEPTH_DENSE
@@ -181,24 +405,48 @@ bool vpMbtFaceDepthDense::computeDesiredFeatures(const vpHomogeneousMatrix &cMo,
     return false;
   }
 
-  vpPolygon polygon_2d(roiPts);
+  polygon_2d.buildFrom(roiPts);
   vpRect bb = polygon_2d.getBoundingBox();
 
-  unsigned int top = (unsigned int)std::max(0.0, bb.getTop());
-  unsigned int bottom = (unsigned int)std::min((double)height, std::max(0.0, bb.getBottom()));
-  unsigned int left = (unsigned int)std::max(0.0, bb.getLeft());
-  unsigned int right = (unsigned int)std::min((double)width, std::max(0.0, bb.getRight()));
+  top = (unsigned int)std::max(0.0, bb.getTop());
+  bottom = (unsigned int)std::min((double)height, std::max(0.0, bb.getBottom()));
+  left = (unsigned int)std::max(0.0, bb.getLeft());
+  right = (unsigned int)std::min((double)width, std::max(0.0, bb.getRight()));
 
-  bb.setTop(top);
-  bb.setBottom(bottom);
-  bb.setLeft(left);
-  bb.setRight(right);
+  return left < right && top < bottom;
+}
 
-  if (bb.getHeight() < 0 || bb.getWidth() < 0) {
+#ifdef VISP_HAVE_PCL
+bool vpMbtFaceDepthDense::computeDesiredFeatures(const vpHomogeneousMatrix &cMo,
+                                                 const pcl::PointCloud<pcl::PointXYZ>::ConstPtr &point_cloud,
+                                                 unsigned int stepX, unsigned int stepY
+#if DEBUG_DISPLAY_DEPTH_DENSE
+                                                 ,
+                                                 vpImage<unsigned char> &debugImage,
+                                                 std::vector<std::vector<vpImagePoint> > &roiPts_vec
+#endif
+                                                 , const vpImage<bool> *mask
+)
+{
+  unsigned int width = point_cloud->width, height = point_cloud->height;
+  m_pointCloudFace.clear();
+  m_pointCloud = NULL;
+
+  if (point_cloud->width == 0 || point_cloud->height == 0)
+    return false;
+
+  std::vector<vpImagePoint> roiPts;
+  vpPolygon polygon_2d;
+  unsigned int top = 0, bottom = 0, left = 0, right = 0;
+  if (!computeBoundingBox(cMo, width, height, roiPts,
+#if DEBUG_DISPLAY_DEPTH_DENSE
+                          roiPts_vec,
+#endif
+                          polygon_2d, top, bottom, left, right)) {
     return false;
   }
 
-  m_pointCloudFace.reserve((size_t)(bb.getWidth() * bb.getHeight()));
+  m_pointCloudFace.reserve((size_t)(right - left) * (bottom - top));
 
   bool checkSSE2 = vpCPUFeatures::checkSSE2();
 #if !USE_SSE
@@ -282,46 +530,23 @@ bool vpMbtFaceDepthDense::computeDesiredFeatures(const vpHomogeneousMatrix &cMo,
 )
 {
   m_pointCloudFace.clear();
+  m_pointCloud = NULL;
 
   if (width == 0 || height == 0)
     return 0;
 
   std::vector<vpImagePoint> roiPts;
-  double distanceToFace;
-  computeROI(cMo, width, height, roiPts
+  vpPolygon polygon_2d;
+  unsigned int top = 0, bottom = 0, left = 0, right = 0;
+  if (!computeBoundingBox(cMo, width, height, roiPts,
 #if DEBUG_DISPLAY_DEPTH_DENSE
-             ,
-             roiPts_vec
-#endif
-             ,
-             distanceToFace);
-
-  if (roiPts.size() <= 2) {
-#ifndef NDEBUG
-    std::cerr << "Error: roiPts.size() <= 2 in computeDesiredFeatures" << std::endl;
+                          roiPts_vec,
 #endif
+                          polygon_2d, top, bottom, left, right)) {
     return false;
   }
 
-  if (((m_depthDenseFilteringMethod & MAX_DISTANCE_FILTERING) && distanceToFace > m_depthDenseFilteringMaxDist) ||
-      ((m_depthDenseFilteringMethod & MIN_DISTANCE_FILTERING) && distanceToFace < m_depthDenseFilteringMinDist)) {
-    return false;
-  }
-
-  vpPolygon polygon_2d(roiPts);
-  vpRect bb = polygon_2d.getBoundingBox();
-
-  unsigned int top = (unsigned int)std::max(0.0, bb.getTop());
-  unsigned int bottom = (unsigned int)std::min((double)height, std::max(0.0, bb.getBottom()));
-  unsigned int left = (unsigned int)std::max(0.0, bb.getLeft());
-  unsigned int right = (unsigned int)std::min((double)width, std::max(0.0, bb.getRight()));
-
-  bb.setTop(top);
-  bb.setBottom(bottom);
-  bb.setLeft(left);
-  bb.setRight(right);
-
-  m_pointCloudFace.reserve((size_t)(bb.getWidth() * bb.getHeight()));
+  m_pointCloudFace.reserve((size_t)(right - left) * (bottom - top));
 
   bool checkSSE2 = vpCPUFeatures::checkSSE2();
 #if !USE_SSE
@@ -392,6 +617,124 @@ bool vpMbtFaceDepthDense::computeDesiredFeatures(const vpHomogeneousMatrix &cMo,
   return true;
 }
 
+/*!
+  Rasterize the face polygon into scanline spans over the organized point
+  cloud. Contrary to the other computeDesiredFeatures() methods, the 3D points
+  are not copied: only the spans are kept and the point cloud is read again
+  by computeResidu(), computeNormalEquations() and
+  computeInteractionMatrixAndResidu().
+
+  \warning The point cloud must thus remain valid until the pose has been
+  estimated.
+*/
+bool vpMbtFaceDepthDense::computeDesiredFeatures(const vpHomogeneousMatrix &cMo, const vpPointCloud &point_cloud,
+                                                 unsigned int stepX, unsigned int stepY
+#if DEBUG_DISPLAY_DEPTH_DENSE
+                                                 ,
+                                                 vpImage<unsigned char> &debugImage,
+                                                 std::vector<std::vector<vpImagePoint> > &roiPts_vec
+#endif
+                                                 , const vpImage<bool> *mask
+)
+{
+  unsigned int width = point_cloud.getWidth(), height = point_cloud.getHeight();
+  m_pointCloudFace.clear();
+  m_pointCloud = NULL;
+  m_spans.clear();
+  m_nbSpanFeatures = 0;
+
+  if (width == 0 || height == 0)
+    return false;
+
+  std::vector<vpImagePoint> roiPts;
+  vpPolygon polygon_2d;
+  unsigned int top = 0, bottom = 0, left = 0, right = 0;
+  if (!computeBoundingBox(cMo, width, height, roiPts,
+#if DEBUG_DISPLAY_DEPTH_DENSE
+                          roiPts_vec,
+#endif
+                          polygon_2d, top, bottom, left, right)) {
+    return false;
+  }
+
+  m_spanStepX = stepX;
+  m_spanX.resize((right - left + stepX - 1) / stepX);
+  m_spanY.resize(m_spanX.size());
+  m_spanZ.resize(m_spanX.size());
+
+  const vpImage<int> *primitiveIDs = m_useScanLine ? &m_hiddenFace->getMbScanLineRenderer().getPrimitiveIDs() : NULL;
+  std::vector<double> crossings;
+  int totalTheoreticalPoints = 0, totalPoints = 0;
+  for (unsigned int i = top; i < bottom; i += stepY) {
+    // Intervals of the row inside the face, with the same even-odd rule than
+    // vpPolygon::isInside(): a column j is inside if crossings[2k] < j <= crossings[2k+1]
+    crossings.clear();
+    if (m_useScanLine) {
+      crossings.push_back(left - 1.0);
+      crossings.push_back(right - 1.0);
+    } else {
+      for (size_t k = 0, l = roiPts.size() - 1; k < roiPts.size(); l = k++) {
+        double vk = roiPts[k].get_i(), vl = roiPts[l].get_i();
+        if ((vk < i && vl >= i) || (vl < i && vk >= i)) {
+          crossings.push_back(roiPts[k].get_j() + (i - vk) * (roiPts[l].get_j() - roiPts[k].get_j()) / (vl - vk));
+        }
+      }
+      std::sort(crossings.begin(), crossings.end());
+    }
+
+    for (size_t k = 0; k + 1 < crossings.size(); k += 2) {
+      // First and last sampled columns of the interval
+      double first = std::max((double)left, std::floor(crossings[k]) + 1.0);
+      unsigned int j = left + (unsigned int)std::ceil((first - left) / stepX) * stepX;
+      unsigned int end = (unsigned int)std::min((double)right, std::floor(crossings[k + 1]) + 1.0);
+
+      bool inSpan = false;
+      for (; j < end; j += stepX) {
+        bool inside = true;
+        if (m_useScanLine) {
+          inside = i < primitiveIDs->getHeight() && j < primitiveIDs->getWidth() &&
+                   (*primitiveIDs)[i][j] == m_polygon->getIndex();
+        }
+
+        if (inside) {
+          totalTheoreticalPoints++;
+        }
+
+        inside = inside && vpMeTracker::inMask(mask, i, j);
+        if (inside) {
+          if (!inSpan) {
+            inSpan = true;
+            m_spans.push_back(i);
+            m_spans.push_back(j);
+            m_spans.push_back(j);
+          }
+          m_spans.back() = j + 1;
+
+          if (point_cloud.getZ(i, j) > 0) {
+            totalPoints++;
+#if DEBUG_DISPLAY_DEPTH_DENSE
+            debugImage[i][j] = 255;
+#endif
+          }
+        } else {
+          inSpan = false;
+        }
+      }
+    }
+  }
+
+  if (totalPoints == 0 || ((m_depthDenseFilteringMethod & DEPTH_OCCUPANCY_RATIO_FILTERING) &&
+                           totalPoints / (double)totalTheoreticalPoints < m_depthDenseFilteringOccupancyRatio)) {
+    m_spans.clear();
+    return false;
+  }
+
+  m_pointCloud = &point_cloud;
+  m_nbSpanFeatures = (unsigned int)totalPoints;
+
+  return true;
+}
+
 void vpMbtFaceDepthDense::computeVisibility() { m_isVisible = m_polygon->isVisible(); }
 
 void vpMbtFaceDepthDense::computeVisibilityDisplay()
@@ -430,7 +773,7 @@ void vpMbtFaceDepthDense::computeVisibilityDisplay()
 void vpMbtFaceDepthDense::computeInteractionMatrixAndResidu(const vpHomogeneousMatrix &cMo, vpMatrix &L,
                                                             vpColVector &error)
 {
-  if (m_pointCloudFace.empty()) {
+  if (getNbFeatures() == 0) {
     L.resize(0, 0);
     error.resize(0);
     return;
@@ -448,6 +791,25 @@ void vpMbtFaceDepthDense::computeInteractionMatrixAndResidu(const vpHomogeneousM
   double nz = m_planeCamera.getC();
   double D = m_planeCamera.getD();
 
+  if (m_pointCloud != NULL) {
+    unsigned int idx = 0;
+    for (size_t s = 0; s < m_spans.size(); s += 3) {
+      unsigned int n = loadSpan(s);
+      computeResiduals(&m_spanX[0], &m_spanY[0], &m_spanZ[0], n, nx, ny, nz, D, error.data + idx);
+
+      for (unsigned int k = 0; k < n; k++, idx++) {
+        L[idx][0] = nx;
+        L[idx][1] = ny;
+        L[idx][2] = nz;
+        L[idx][3] = (nz * m_spanY[k]) - (ny * m_spanZ[k]);
+        L[idx][4] = (nx * m_spanZ[k]) - (nz * m_spanX[k]);
+        L[idx][5] = (ny * m_spanX[k]) - (nx * m_spanY[k]);
+      }
+    }
+
+    return;
+  }
+
   bool checkSSE2 = vpCPUFeatures::checkSSE2();
 #if !USE_SSE
   checkSSE2 = false;
@@ -579,6 +941,121 @@ void vpMbtFaceDepthDense::computeInteractionMatrixAndResidu(const vpHomogeneousM
   }
 }
 
+/*!
+  Compute the 6x6 normal equations contribution of the face,
+  \f$ \mathbf{L}^T \mathbf{W}^2 \mathbf{L} \f$ and
+  \f$ \mathbf{L}^T \mathbf{W}^2 \mathbf{e} \f$, streaming the depth points from
+  the scanline spans computed by
+  computeDesiredFeatures(const vpHomogeneousMatrix &, const vpPointCloud &, unsigned int, unsigned int, const vpImage<bool> *).
+
+  Since the interaction matrix rows only depend on the point coordinates for a
+  given plane, the contribution is obtained from the weighted first and second
+  order moments of the points, accumulated in a single pass.
+
+  \param cMo : Current pose.
+  \param w : Robust weights of the face features, in the same order as the
+  residuals given by computeResidu().
+  \param LTL : 6x6 matrix the contribution is added to.
+  \param LTR : 6-dim vector the contribution is added to.
+*/
+void vpMbtFaceDepthDense::computeNormalEquations(const vpHomogeneousMatrix &cMo, const double *const w, vpMatrix &LTL,
+                                                 vpColVector &LTR)
+{
+  if (m_pointCloud == NULL) {
+    return;
+  }
+
+  // Transform the plane equation for the current pose
+  m_planeCamera = m_planeObject;
+  m_planeCamera.changeFrame(cMo);
+
+  const double normal[3] = {m_planeCamera.getA(), m_planeCamera.getB(), m_planeCamera.getC()};
+  const double D = m_planeCamera.getD();
+
+  double m[10] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+  unsigned int idx = 0;
+  for (size_t s = 0; s < m_spans.size(); s += 3) {
+    unsigned int n = loadSpan(s);
+    accumulateMoments(&m_spanX[0], &m_spanY[0], &m_spanZ[0], w + idx, n, m);
+    idx += n;
+  }
+
+  // Rotational part of the interaction matrix: P x n = M P
+  const double M[3][3] = {{0, normal[2], -normal[1]}, {-normal[2], 0, normal[0]}, {normal[1], -normal[0], 0}};
+  const double S1[3] = {m[1], m[2], m[3]};
+  const double S2[3][3] = {{m[4], m[5], m[6]}, {m[5], m[7], m[8]}, {m[6], m[8], m[9]}};
+
+  double MS1[3], MS2[3][3], S2n_DS1[3];
+  double R0 = D * m[0];
+  for (unsigned int i = 0; i < 3; i++) {
+    MS1[i] = 0;
+    S2n_DS1[i] = D * S1[i];
+    for (unsigned int k = 0; k < 3; k++) {
+      MS1[i] += M[i][k] * S1[k];
+      S2n_DS1[i] += S2[i][k] * normal[k];
+    }
+
+    for (unsigned int j = 0; j < 3; j++) {
+      MS2[i][j] = 0;
+      for (unsigned int k = 0; k < 3; k++) {
+        MS2[i][j] += M[i][k] * S2[k][j];
+      }
+    }
+
+    R0 += normal[i] * S1[i];
+  }
+
+  for (unsigned int i = 0; i < 3; i++) {
+    for (unsigned int j = 0; j < 3; j++) {
+      LTL[i][j] += m[0] * normal[i] * normal[j];
+      LTL[i][j + 3] += normal[i] * MS1[j];
+      LTL[j + 3][i] += normal[i] * MS1[j];
+
+      double MS2MT = 0;
+      for (unsigned int k = 0; k < 3; k++) {
+        MS2MT += MS2[i][k] * M[j][k];
+      }
+      LTL[i + 3][j + 3] += MS2MT;
+    }
+
+    double MS2n_DS1 = 0;
+    for (unsigned int k = 0; k < 3; k++) {
+      MS2n_DS1 += M[i][k] * S2n_DS1[k];
+    }
+
+    LTR[i] += normal[i] * R0;
+    LTR[i + 3] += MS2n_DS1;
+  }
+}
+
+/*!
+  Compute the point-to-plane residuals of the face, streaming the depth points
+  from the scanline spans. The \e error buffer must hold getNbFeatures()
+  values.
+*/
+void vpMbtFaceDepthDense::computeResidu(const vpHomogeneousMatrix &cMo, double *const error)
+{
+  if (m_pointCloud == NULL) {
+    return;
+  }
+
+  // Transform the plane equation for the current pose
+  m_planeCamera = m_planeObject;
+  m_planeCamera.changeFrame(cMo);
+
+  double nx = m_planeCamera.getA();
+  double ny = m_planeCamera.getB();
+  double nz = m_planeCamera.getC();
+  double D = m_planeCamera.getD();
+
+  unsigned int idx = 0;
+  for (size_t s = 0; s < m_spans.size(); s += 3) {
+    unsigned int n = loadSpan(s);
+    computeResiduals(&m_spanX[0], &m_spanY[0], &m_spanZ[0], n, nx, ny, nz, D, error + idx);
+    idx += n;
+  }
+}
+
 void vpMbtFaceDepthDense::computeROI(const vpHomogeneousMatrix &cMo, unsigned int width,
                                      unsigned int height, std::vector<vpImagePoint> &roiPts
 #if DEBUG_DISPLAY_DEPTH_DENSE
@@ -756,6 +1233,28 @@ std::vector<std::vector<double> > vpMbtFaceDepthDense::getModelForDisplay(unsign
   return models;
 }
 
+/*!
+  Load the valid depth points of a scanline span into the span buffers.
+
+  \param s : Index of the span in m_spans.
+  \return The number of valid points.
+*/
+unsigned int vpMbtFaceDepthDense::loadSpan(size_t s)
+{
+  unsigned int i = m_spans[s], n = 0;
+  float X = 0, Y = 0, Z = 0;
+  for (unsigned int j = m_spans[s + 1]; j < m_spans[s + 2]; j += m_spanStepX) {
+    if (m_pointCloud->getPoint(i, j, X, Y, Z)) {
+      m_spanX[n] = X;
+      m_spanY[n] = Y;
+      m_spanZ[n] = Z;
+      n++;
+    }
+  }
+
+  return n;
+}
+
 /*!
   Check if two vpPoints are similar.
 
@@ -788,6 +1287,19 @@ void vpMbtFaceDepthDense::setCameraParameters(const vpCameraParameters &camera)
   }
 }
 
+/*!
+  Set the hidden faces used to test the visibility of the face lines.
+
+  \param faces : Pointer to the hidden faces.
+*/
+void vpMbtFaceDepthDense::setLinesHiddenFaces(vpMbHiddenFaces<vpMbtPolygon> *const faces)
+{
+  for (std::vector<vpMbtDistanceLine *>::const_iterator it = m_listOfFaceLines.begin(); it != m_listOfFaceLines.end();
+       ++it) {
+    (*it)->hiddenface = faces;
+  }
+}
+
 void vpMbtFaceDepthDense::setScanLineVisibilityTest(bool v)
 {
   m_useScanLine = v;
@@ -55,6 +55,355 @@
 #define USE_SSE 0
 #endif
 
+#if defined __AVX__
+#include <immintrin.h>
+#define VISP_HAVE_AVX 1
+#endif
+
+#if defined __ARM_NEON && defined __aarch64__
+#include <arm_neon.h>
+#define VISP_HAVE_NEON 1
+#endif
+
+namespace
+{
+// Distances of the points to the plane A X + B Y + C Z + D = 0, with (A, B, C) a unit vector.
+// Return the sum of the weighted distances.
+double computePlaneResidues(const double *X, const double *Y, const double *Z, const double *w, size_t n, double A,
+                            double B, double C, double D, double *r)
+{
+  size_t k = 0;
+  double sum = 0.0;
+
+#if VISP_HAVE_AVX
+  if (vpCPUFeatures::checkAVX()) {
+    const __m256d vA = _mm256_set1_pd(A);
+    const __m256d vB = _mm256_set1_pd(B);
+    const __m256d vC = _mm256_set1_pd(C);
+    const __m256d vD = _mm256_set1_pd(D);
+    const __m256d sign_mask = _mm256_set1_pd(-0.0);
+    __m256d vsum = _mm256_setzero_pd();
+
+    for (; k + 4 <= n; k += 4) {
+      __m256d res = _mm256_add_pd(vD, _mm256_mul_pd(vA, _mm256_loadu_pd(X + k)));
+      res = _mm256_add_pd(res, _mm256_mul_pd(vB, _mm256_loadu_pd(Y + k)));
+      res = _mm256_add_pd(res, _mm256_mul_pd(vC, _mm256_loadu_pd(Z + k)));
+      res = _mm256_andnot_pd(sign_mask, res);
+      _mm256_storeu_pd(r + k, res);
+      vsum = _mm256_add_pd(vsum, _mm256_mul_pd(res, _mm256_loadu_pd(w + k)));
+    }
+
+    double tmp[4];
+    _mm256_storeu_pd(tmp, vsum);
+    sum += tmp[0] + tmp[1] + tmp[2] + tmp[3];
+
+    _mm256_zeroupper();
+  }
+#endif
+
+#if USE_SSE
+  if (vpCPUFeatures::checkSSE2()) {
+    const __m128d vA = _mm_set1_pd(A);
+    const __m128d vB = _mm_set1_pd(B);
+    const __m128d vC = _mm_set1_pd(C);
+    const __m128d vD = _mm_set1_pd(D);
+    const __m128d sign_mask = _mm_set1_pd(-0.0);
+    __m128d vsum = _mm_setzero_pd();
+
+    for (; k + 2 <= n; k += 2) {
+      __m128d res = _mm_add_pd(vD, _mm_mul_pd(vA, _mm_loadu_pd(X + k)));
+      res = _mm_add_pd(res, _mm_mul_pd(vB, _mm_loadu_pd(Y + k)));
+      res = _mm_add_pd(res, _mm_mul_pd(vC, _mm_loadu_pd(Z + k)));
+      res = _mm_andnot_pd(sign_mask, res);
+      _mm_storeu_pd(r + k, res);
+      vsum = _mm_add_pd(vsum, _mm_mul_pd(res, _mm_loadu_pd(w + k)));
+    }
+
+    double tmp[2];
+    _mm_storeu_pd(tmp, vsum);
+    sum += tmp[0] + tmp[1];
+  }
+#elif VISP_HAVE_NEON
+  const float64x2_t vA = vdupq_n_f64(A);
+  const float64x2_t vB = vdupq_n_f64(B);
+  const float64x2_t vC = vdupq_n_f64(C);
+  const float64x2_t vD = vdupq_n_f64(D);
+  float64x2_t vsum = vdupq_n_f64(0.0);
+
+  for (; k + 2 <= n; k += 2) {
+    float64x2_t res = vfmaq_f64(vD, vA, vld1q_f64(X + k));
+    res = vfmaq_f64(res, vB, vld1q_f64(Y + k));
+    res = vabsq_f64(vfmaq_f64(res, vC, vld1q_f64(Z + k)));
+    vst1q_f64(r + k, res);
+    vsum = vfmaq_f64(vsum, res, vld1q_f64(w + k));
+  }
+
+  sum += vaddvq_f64(vsum);
+#endif
+
+  for (; k < n; k++) {
+    r[k] = std::fabs(A * X[k] + B * Y[k] + C * Z[k] + D);
+    sum += w[k] * r[k];
+  }
+
+  return sum;
+}
+
+// Weighted moments of the points:
+// m = [sum w, sum w X, sum w Y, sum w Z, sum w^2, sum w^2 X, sum w^2 Y, sum w^2 Z,
+// sum w^2 XX, sum w^2 XY, sum w^2 XZ, sum w^2 YY, sum w^2 YZ, sum w^2 ZZ]
+void computePlaneMoments(const double *X, const double *Y, const double *Z, const double *w, size_t n, double *m)
+{
+  size_t k = 0;
+  for (int l = 0; l < 14; l++) {
+    m[l] = 0.0;
+  }
+
+#if VISP_HAVE_AVX
+  if (vpCPUFeatures::checkAVX()) {
+    __m256d acc[14];
+    for (int l = 0; l < 14; l++) {
+      acc[l] = _mm256_setzero_pd();
+    }
+
+    for (; k + 4 <= n; k += 4) {
+      const __m256d vw = _mm256_loadu_pd(w + k);
+      const __m256d vx = _mm256_loadu_pd(X + k);
+      const __m256d vy = _mm256_loadu_pd(Y + k);
+      const __m256d vz = _mm256_loadu_pd(Z + k);
+      const __m256d w2 = _mm256_mul_pd(vw, vw);
+      const __m256d w2x = _mm256_mul_pd(w2, vx);
+      const __m256d w2y = _mm256_mul_pd(w2, vy);
+      const __m256d w2z = _mm256_mul_pd(w2, vz);
+
+      acc[0] = _mm256_add_pd(acc[0], vw);
+      acc[1] = _mm256_add_pd(acc[1], _mm256_mul_pd(vw, vx));
+      acc[2] = _mm256_add_pd(acc[2], _mm256_mul_pd(vw, vy));
+      acc[3] = _mm256_add_pd(acc[3], _mm256_mul_pd(vw, vz));
+      acc[4] = _mm256_add_pd(acc[4], w2);
+      acc[5] = _mm256_add_pd(acc[5], w2x);
+      acc[6] = _mm256_add_pd(acc[6], w2y);
+      acc[7] = _mm256_add_pd(acc[7], w2z);
+      acc[8] = _mm256_add_pd(acc[8], _mm256_mul_pd(w2x, vx));
+      acc[9] = _mm256_add_pd(acc[9], _mm256_mul_pd(w2x, vy));
+      acc[10] = _mm256_add_pd(acc[10], _mm256_mul_pd(w2x, vz));
+      acc[11] = _mm256_add_pd(acc[11], _mm256_mul_pd(w2y, vy));
+      acc[12] = _mm256_add_pd(acc[12], _mm256_mul_pd(w2y, vz));
+      acc[13] = _mm256_add_pd(acc[13], _mm256_mul_pd(w2z, vz));
+    }
+
+    double tmp[4];
+    for (int l = 0; l < 14; l++) {
+      _mm256_storeu_pd(tmp, acc[l]);
+      m[l] += tmp[0] + tmp[1] + tmp[2] + tmp[3];
+    }
+
+    _mm256_zeroupper();
+  }
+#endif
+
+#if USE_SSE
+  if (vpCPUFeatures::checkSSE2()) {
+    __m128d acc[14];
+    for (int l = 0; l < 14; l++) {
+      acc[l] = _mm_setzero_pd();
+    }
+
+    for (; k + 2 <= n; k += 2) {
+      const __m128d vw = _mm_loadu_pd(w + k);
+      const __m128d vx = _mm_loadu_pd(X + k);
+      const __m128d vy = _mm_loadu_pd(Y + k);
+      const __m128d vz = _mm_loadu_pd(Z + k);
+      const __m128d w2 = _mm_mul_pd(vw, vw);
+      const __m128d w2x = _mm_mul_pd(w2, vx);
+      const __m128d w2y = _mm_mul_pd(w2, vy);
+      const __m128d w2z = _mm_mul_pd(w2, vz);
+
+      acc[0] = _mm_add_pd(acc[0], vw);
+      acc[1] = _mm_add_pd(acc[1], _mm_mul_pd(vw, vx));
+      acc[2] = _mm_add_pd(acc[2], _mm_mul_pd(vw, vy));
+      acc[3] = _mm_add_pd(acc[3], _mm_mul_pd(vw, vz));
+      acc[4] = _mm_add_pd(acc[4], w2);
+      acc[5] = _mm_add_pd(acc[5], w2x);
+      acc[6] = _mm_add_pd(acc[6], w2y);
+      acc[7] = _mm_add_pd(acc[7], w2z);
+      acc[8] = _mm_add_pd(acc[8], _mm_mul_pd(w2x, vx));
+      acc[9] = _mm_add_pd(acc[9], _mm_mul_pd(w2x, vy));
+      acc[10] = _mm_add_pd(acc[10], _mm_mul_pd(w2x, vz));
+      acc[11] = _mm_add_pd(acc[11], _mm_mul_pd(w2y, vy));
+      acc[12] = _mm_add_pd(acc[12], _mm_mul_pd(w2y, vz));
+      acc[13] = _mm_add_pd(acc[13], _mm_mul_pd(w2z, vz));
+    }
+
+    double tmp[2];
+    for (int l = 0; l < 14; l++) {
+      _mm_storeu_pd(tmp, acc[l]);
+      m[l] += tmp[0] + tmp[1];
+    }
+  }
+#elif VISP_HAVE_NEON
+  float64x2_t acc[14];
+  for (int l = 0; l < 14; l++) {
+    acc[l] = vdupq_n_f64(0.0);
+  }
+
+  for (; k + 2 <= n; k += 2) {
+    const float64x2_t vw = vld1q_f64(w + k);
+    const float64x2_t vx = vld1q_f64(X + k);
+    const float64x2_t vy = vld1q_f64(Y + k);
+    const float64x2_t vz = vld1q_f64(Z + k);
+    const float64x2_t w2 = vmulq_f64(vw, vw);
+    const float64x2_t w2x = vmulq_f64(w2, vx);
+    const float64x2_t w2y = vmulq_f64(w2, vy);
+    const float64x2_t w2z = vmulq_f64(w2, vz);
+
+    acc[0] = vaddq_f64(acc[0], vw);
+    acc[1] = vfmaq_f64(acc[1], vw, vx);
+    acc[2] = vfmaq_f64(acc[2], vw, vy);
+    acc[3] = vfmaq_f64(acc[3], vw, vz);
+    acc[4] = vaddq_f64(acc[4], w2);
+    acc[5] = vaddq_f64(acc[5], w2x);
+    acc[6] = vaddq_f64(acc[6], w2y);
+    acc[7] = vaddq_f64(acc[7], w2z);
+    acc[8] = vfmaq_f64(acc[8], w2x, vx);
+    acc[9] = vfmaq_f64(acc[9], w2x, vy);
+    acc[10] = vfmaq_f64(acc[10], w2x, vz);
+    acc[11] = vfmaq_f64(acc[11], w2y, vy);
+    acc[12] = vfmaq_f64(acc[12], w2y, vz);
+    acc[13] = vfmaq_f64(acc[13], w2z, vz);
+  }
+
+  for (int l = 0; l < 14; l++) {
+    m[l] += vaddvq_f64(acc[l]);
+  }
+#endif
+
+  for (; k < n; k++) {
+    const double w2 = w[k] * w[k];
+    const double w2x = w2 * X[k], w2y = w2 * Y[k], w2z = w2 * Z[k];
+    m[0] += w[k];
+    m[1] += w[k] * X[k];
+    m[2] += w[k] * Y[k];
+    m[3] += w[k] * Z[k];
+    m[4] += w2;
+    m[5] += w2x;
+    m[6] += w2y;
+    m[7] += w2z;
+    m[8] += w2x * X[k];
+    m[9] += w2x * Y[k];
+    m[10] += w2x * Z[k];
+    m[11] += w2y * Y[k];
+    m[12] += w2y * Z[k];
+    m[13] += w2z * Z[k];
+  }
+}
+
+// Unit eigenvector associated to the smallest eigenvalue of a 3x3 symmetric matrix, using the closed-form
+// eigenvalues of O. K. Smith, "Eigenvalues of a symmetric 3 x 3 matrix", 1961.
+// Return false when the eigenvalue is not simple.
+bool computeSmallestEigenVector(const double J[3][3], double normal[3])
+{
+  const double p1 = J[0][1] * J[0][1] + J[0][2] * J[0][2] + J[1][2] * J[1][2];
+  const double q = (J[0][0] + J[1][1] + J[2][2]) / 3.0;
+  const double p2 = (J[0][0] - q) * (J[0][0] - q) + (J[1][1] - q) * (J[1][1] - q) + (J[2][2] - q) * (J[2][2] - q) +
+                    2.0 * p1;
+  const double p = sqrt(p2 / 6.0);
+  if (p <= std::numeric_limits<double>::epsilon() * std::fabs(q)) {
+    return false;
+  }
+
+  double B[3][3];
+  for (unsigned int i = 0; i < 3; i++) {
+    for (unsigned int j = 0; j < 3; j++) {
+      B[i][j] = (J[i][j] - (i == j ? q : 0.0)) / p;
+    }
+  }
+
+  double r = (B[0][0] * (B[1][1] * B[2][2] - B[1][2] * B[2][1]) - B[0][1] * (B[1][0] * B[2][2] - B[1][2] * B[2][0]) +
+              B[0][2] * (B[1][0] * B[2][1] - B[1][1] * B[2][0])) /
+             2.0;
+  r = std::max(-1.0, std::min(1.0, r));
+  const double phi = acos(r) / 3.0;
+  const double lambda = q + 2.0 * p * cos(phi + 2.0 * M_PI / 3.0);
+
+  // The eigenvector is orthogonal to the rows of J - lambda I
+  double rows[3][3];
+  for (unsigned int i = 0; i < 3; i++) {
+    for (unsigned int j = 0; j < 3; j++) {
+      rows[i][j] = J[i][j] - (i == j ? lambda : 0.0);
+    }
+  }
+
+  double best_norm = 0.0;
+  for (unsigned int i = 0; i < 3; i++) {
+    const double *a = rows[i], *b = rows[(i + 1) % 3];
+    double c[3] = {a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2], a[0] * b[1] - a[1] * b[0]};
+    double norm = c[0] * c[0] + c[1] * c[1] + c[2] * c[2];
+    if (norm > best_norm) {
+      best_norm = norm;
+      normal[0] = c[0];
+      normal[1] = c[1];
+      normal[2] = c[2];
+    }
+  }
+
+  // Double eigenvalue: all the rows are colinear
+  if (best_norm <= 1e-12 * p2 * p2) {
+    return false;
+  }
+
+  best_norm = sqrt(best_norm);
+  normal[0] /= best_norm;
+  normal[1] /= best_norm;
+  normal[2] /= best_norm;
+
+  return true;
+}
+
+// Point accessor over a point cloud stored as a vector of vpColVector
+class vpColVectorPoints
+{
+public:
+  vpColVectorPoints(const std::vector<vpColVector> &point_cloud, unsigned int width)
+    : m_pointCloud(point_cloud), m_width(width)
+  {
+  }
+
+  bool getPoint(unsigned int i, unsigned int j, double &X, double &Y, double &Z) const
+  {
+    const vpColVector &point = m_pointCloud[i * m_width + j];
+    X = point[0];
+    Y = point[1];
+    Z = point[2];
+    return Z > 0;
+  }
+
+private:
+  const std::vector<vpColVector> &m_pointCloud;
+  unsigned int m_width;
+};
+
+// Point accessor over a vpPointCloud
+class vpPointCloudPoints
+{
+public:
+  explicit vpPointCloudPoints(const vpPointCloud &point_cloud) : m_pointCloud(point_cloud) {}
+
+  bool getPoint(unsigned int i, unsigned int j, double &X, double &Y, double &Z) const
+  {
+    float x = 0, y = 0, z = 0;
+    bool valid = m_pointCloud.getPoint(i, j, x, y, z);
+    X = x;
+    Y = y;
+    Z = z;
+    return valid;
+  }
+
+private:
+  const vpPointCloud &m_pointCloud;
+};
+} // namespace
+
 vpMbtFaceDepthNormal::vpMbtFaceDepthNormal()
   : m_cam(), m_clippingFlag(vpPolygon3D::NO_CLIPPING), m_distFarClip(100), m_distNearClip(0.001), m_hiddenFace(NULL),
     m_planeObject(), m_polygon(NULL), m_useScanLine(false), m_faceActivated(false),
@@ -62,10 +411,35 @@ vpMbtFaceDepthNormal::vpMbtFaceDepthNormal()
     m_featureEstimationMethod(ROBUST_FEATURE_ESTIMATION), m_isTrackedDepthNormalFace(true), m_isVisible(false),
     m_listOfFaceLines(), m_planeCamera(),
     m_pclPlaneEstimationMethod(2), // SAC_MSAC, see pcl/sample_consensus/method_types.h
-    m_pclPlaneEstimationRansacMaxIter(200), m_pclPlaneEstimationRansacThreshold(0.001), m_polygonLines()
+    m_pclPlaneEstimationRansacMaxIter(200), m_pclPlaneEstimationRansacThreshold(0.001), m_polygonLines(),
+    m_planeFitX(), m_planeFitY(), m_planeFitZ(), m_planeFitResidues(), m_planeFitWeights()
 {
 }
 
+/*!
+  Copy constructor. The face lines are duplicated, the polygon and the hidden
+  faces are shared with \e face.
+
+  \param face : Face to copy.
+*/
+vpMbtFaceDepthNormal::vpMbtFaceDepthNormal(const vpMbtFaceDepthNormal &face)
+  : m_cam(face.m_cam), m_clippingFlag(face.m_clippingFlag), m_distFarClip(face.m_distFarClip),
+    m_distNearClip(face.m_distNearClip), m_hiddenFace(face.m_hiddenFace), m_planeObject(face.m_planeObject),
+    m_polygon(face.m_polygon), m_useScanLine(face.m_useScanLine), m_faceActivated(face.m_faceActivated),
+    m_faceCentroidMethod(face.m_faceCentroidMethod), m_faceDesiredCentroid(face.m_faceDesiredCentroid),
+    m_faceDesiredNormal(face.m_faceDesiredNormal), m_featureEstimationMethod(face.m_featureEstimationMethod),
+    m_isTrackedDepthNormalFace(face.m_isTrackedDepthNormalFace), m_isVisible(face.m_isVisible), m_listOfFaceLines(),
+    m_planeCamera(face.m_planeCamera), m_pclPlaneEstimationMethod(face.m_pclPlaneEstimationMethod),
+    m_pclPlaneEstimationRansacMaxIter(face.m_pclPlaneEstimationRansacMaxIter),
+    m_pclPlaneEstimationRansacThreshold(face.m_pclPlaneEstimationRansacThreshold),
+    m_polygonLines(face.m_polygonLines), m_planeFitX(), m_planeFitY(), m_planeFitZ(), m_planeFitResidues(),
+    m_planeFitWeights()
+{
+  for (size_t i = 0; i < face.m_listOfFaceLines.size(); i++) {
+    m_listOfFaceLines.push_back(new vpMbtDistanceLine(*face.m_listOfFaceLines[i]));
+  }
+}
+
 vpMbtFaceDepthNormal::~vpMbtFaceDepthNormal()
 {
   for (size_t i = 0; i < m_listOfFaceLines.size(); i++) {
@@ -202,7 +576,8 @@ bool vpMbtFaceDepthNormal::computeDesiredFeatures(const vpHomogeneousMatrix &cMo
   if (m_featureEstimationMethod == ROBUST_FEATURE_ESTIMATION) {
     point_cloud_face_custom.reserve((size_t)(3 * bb.getWidth() * bb.getHeight()));
     point_cloud_face_vec.reserve((size_t)(3 * bb.getWidth() * bb.getHeight()));
-  } else if (m_featureEstimationMethod == ROBUST_SVD_PLANE_ESTIMATION) {
+  } else if (m_featureEstimationMethod == ROBUST_SVD_PLANE_ESTIMATION ||
+             m_featureEstimationMethod == ROBUST_MOMENTS_PLANE_ESTIMATION) {
     point_cloud_face_vec.reserve((size_t)(3 * bb.getWidth() * bb.getHeight()));
   } else if (m_featureEstimationMethod == PCL_PLANE_ESTIMATION) {
     point_cloud_face->reserve((size_t)(bb.getWidth() * bb.getHeight()));
@@ -228,6 +603,7 @@ bool vpMbtFaceDepthNormal::computeDesiredFeatures(const vpHomogeneousMatrix &cMo
         if (m_featureEstimationMethod == PCL_PLANE_ESTIMATION) {
           point_cloud_face->push_back((*point_cloud)(j, i));
         } else if (m_featureEstimationMethod == ROBUST_SVD_PLANE_ESTIMATION ||
+                   m_featureEstimationMethod == ROBUST_MOMENTS_PLANE_ESTIMATION ||
                    m_featureEstimationMethod == ROBUST_FEATURE_ESTIMATION) {
           point_cloud_face_vec.push_back((*point_cloud)(j, i).x);
           point_cloud_face_vec.push_back((*point_cloud)(j, i).y);
@@ -292,6 +668,8 @@ bool vpMbtFaceDepthNormal::computeDesiredFeatures(const vpHomogeneousMatrix &cMo
     }
   } else if (m_featureEstimationMethod == ROBUST_SVD_PLANE_ESTIMATION) {
     computeDesiredFeaturesSVD(point_cloud_face_vec, cMo, desired_features, desired_normal, centroid_point);
+  } else if (m_featureEstimationMethod == ROBUST_MOMENTS_PLANE_ESTIMATION) {
+    computeDesiredFeaturesMoments(point_cloud_face_vec, cMo, desired_features, desired_normal, centroid_point);
   } else if (m_featureEstimationMethod == ROBUST_FEATURE_ESTIMATION) {
     computeDesiredFeaturesRobustFeatures(point_cloud_face_custom, point_cloud_face_vec, cMo, desired_features,
                                          desired_normal, centroid_point);
@@ -307,17 +685,22 @@ bool vpMbtFaceDepthNormal::computeDesiredFeatures(const vpHomogeneousMatrix &cMo
 }
 #endif
 
-bool vpMbtFaceDepthNormal::computeDesiredFeatures(const vpHomogeneousMatrix &cMo, unsigned int width,
-                                                  unsigned int height,
-                                                  const std::vector<vpColVector> &point_cloud,
-                                                  vpColVector &desired_features, unsigned int stepX,
-                                                  unsigned int stepY
+/*!
+  Compute the desired features from the 3D points of \e point_cloud inside the
+  face. PointSource provides the points with
+  getPoint(i, j, X, Y, Z), returning false if the point is not valid.
+*/
+template <class PointSource>
+bool vpMbtFaceDepthNormal::computeDesiredFeaturesFromPoints(const vpHomogeneousMatrix &cMo, unsigned int width,
+                                                            unsigned int height, const PointSource &point_cloud,
+                                                            vpColVector &desired_features, unsigned int stepX,
+                                                            unsigned int stepY
 #if DEBUG_DISPLAY_DEPTH_NORMAL
-                                                  ,
-                                                  vpImage<unsigned char> &debugImage,
-                                                  std::vector<std::vector<vpImagePoint> > &roiPts_vec
+                                                            ,
+                                                            vpImage<unsigned char> &debugImage,
+                                                            std::vector<std::vector<vpImagePoint> > &roiPts_vec
 #endif
-                                                  , const vpImage<bool> *mask
+                                                            , const vpImage<bool> *mask
 )
 {
   m_faceActivated = false;
@@ -372,17 +755,18 @@ bool vpMbtFaceDepthNormal::computeDesiredFeatures(const vpHomogeneousMatrix &cMo
 #endif
 
   double x = 0.0, y = 0.0;
+  double X = 0.0, Y = 0.0, Z = 0.0;
   for (unsigned int i = top; i < bottom; i += stepY) {
     for (unsigned int j = left; j < right; j += stepX) {
-      if (vpMeTracker::inMask(mask, i, j) && point_cloud[i * width + j][2] > 0 &&
+      if (vpMeTracker::inMask(mask, i, j) && point_cloud.getPoint(i, j, X, Y, Z) &&
           (m_useScanLine ? (i < m_hiddenFace->getMbScanLineRenderer().getPrimitiveIDs().getHeight() &&
                             j < m_hiddenFace->getMbScanLineRenderer().getPrimitiveIDs().getWidth() &&
                             m_hiddenFace->getMbScanLineRenderer().getPrimitiveIDs()[i][j] == m_polygon->getIndex())
                          : polygon_2d.isInside(vpImagePoint(i, j)))) {
         // Add point
-        point_cloud_face.push_back(point_cloud[i * width + j][0]);
-        point_cloud_face.push_back(point_cloud[i * width + j][1]);
-        point_cloud_face.push_back(point_cloud[i * width + j][2]);
+        point_cloud_face.push_back(X);
+        point_cloud_face.push_back(Y);
+        point_cloud_face.push_back(Z);
 
         if (m_featureEstimationMethod == ROBUST_FEATURE_ESTIMATION) {
           // Add point for custom method for plane equation estimation
@@ -394,7 +778,7 @@ bool vpMbtFaceDepthNormal::computeDesiredFeatures(const vpHomogeneousMatrix &cMo
               push = true;
               prev_x = x;
               prev_y = y;
-              prev_z = point_cloud[i * width + j][2];
+              prev_z = Z;
             } else {
               push = false;
               point_cloud_face_custom.push_back(prev_x);
@@ -404,13 +788,13 @@ bool vpMbtFaceDepthNormal::computeDesiredFeatures(const vpHomogeneousMatrix &cMo
               point_cloud_face_custom.push_back(y);
 
               point_cloud_face_custom.push_back(prev_z);
-              point_cloud_face_custom.push_back(point_cloud[i * width + j][2]);
+              point_cloud_face_custom.push_back(Z);
             }
 #endif
           } else {
             point_cloud_face_custom.push_back(x);
             point_cloud_face_custom.push_back(y);
-            point_cloud_face_custom.push_back(point_cloud[i * width + j][2]);
+            point_cloud_face_custom.push_back(Z);
           }
         }
 
@@ -451,6 +835,8 @@ bool vpMbtFaceDepthNormal::computeDesiredFeatures(const vpHomogeneousMatrix &cMo
 #endif
       if (m_featureEstimationMethod == ROBUST_SVD_PLANE_ESTIMATION) {
     computeDesiredFeaturesSVD(point_cloud_face, cMo, desired_features, desired_normal, centroid_point);
+  } else if (m_featureEstimationMethod == ROBUST_MOMENTS_PLANE_ESTIMATION) {
+    computeDesiredFeaturesMoments(point_cloud_face, cMo, desired_features, desired_normal, centroid_point);
   } else if (m_featureEstimationMethod == ROBUST_FEATURE_ESTIMATION) {
     computeDesiredFeaturesRobustFeatures(point_cloud_face_custom, point_cloud_face, cMo, desired_features,
                                          desired_normal, centroid_point);
@@ -465,6 +851,48 @@ bool vpMbtFaceDepthNormal::computeDesiredFeatures(const vpHomogeneousMatrix &cMo
   return true;
 }
 
+bool vpMbtFaceDepthNormal::computeDesiredFeatures(const vpHomogeneousMatrix &cMo, unsigned int width,
+                                                  unsigned int height,
+                                                  const std::vector<vpColVector> &point_cloud,
+                                                  vpColVector &desired_features, unsigned int stepX,
+                                                  unsigned int stepY
+#if DEBUG_DISPLAY_DEPTH_NORMAL
+                                                  ,
+                                                  vpImage<unsigned char> &debugImage,
+                                                  std::vector<std::vector<vpImagePoint> > &roiPts_vec
+#endif
+                                                  , const vpImage<bool> *mask
+)
+{
+  return computeDesiredFeaturesFromPoints(cMo, width, height, vpColVectorPoints(point_cloud, width), desired_features,
+                                          stepX, stepY
+#if DEBUG_DISPLAY_DEPTH_NORMAL
+                                          ,
+                                          debugImage, roiPts_vec
+#endif
+                                          , mask);
+}
+
+bool vpMbtFaceDepthNormal::computeDesiredFeatures(const vpHomogeneousMatrix &cMo, const vpPointCloud &point_cloud,
+                                                  vpColVector &desired_features, unsigned int stepX,
+                                                  unsigned int stepY
+#if DEBUG_DISPLAY_DEPTH_NORMAL
+                                                  ,
+                                                  vpImage<unsigned char> &debugImage,
+                                                  std::vector<std::vector<vpImagePoint> > &roiPts_vec
+#endif
+                                                  , const vpImage<bool> *mask
+)
+{
+  return computeDesiredFeaturesFromPoints(cMo, point_cloud.getWidth(), point_cloud.getHeight(),
+                                          vpPointCloudPoints(point_cloud), desired_features, stepX, stepY
+#if DEBUG_DISPLAY_DEPTH_NORMAL
+                                          ,
+                                          debugImage, roiPts_vec
+#endif
+                                          , mask);
+}
+
 #ifdef VISP_HAVE_PCL
 bool vpMbtFaceDepthNormal::computeDesiredFeaturesPCL(const pcl::PointCloud<pcl::PointXYZ>::ConstPtr &point_cloud_face,
                                                      vpColVector &desired_features, vpColVector &desired_normal,
@@ -561,6 +989,23 @@ void vpMbtFaceDepthNormal::computeDesiredFeaturesRobustFeatures(const std::vecto
                           desired_normal);
 }
 
+void vpMbtFaceDepthNormal::computeDesiredFeaturesMoments(const std::vector<double> &point_cloud_face,
+                                                         const vpHomogeneousMatrix &cMo,
+                                                         vpColVector &desired_features, vpColVector &desired_normal,
+                                                         vpColVector &centroid_point)
+{
+  vpColVector plane_equation;
+  estimatePlaneEquationMoments(point_cloud_face, cMo, plane_equation, centroid_point);
+
+  desired_features.resize(3, false);
+  desired_features[0] = -plane_equation[0] / plane_equation[3];
+  desired_features[1] = -plane_equation[1] / plane_equation[3];
+  desired_features[2] = -plane_equation[2] / plane_equation[3];
+
+  computeNormalVisibility(-desired_features[0], -desired_features[1], -desired_features[2], centroid_point,
+                          desired_normal);
+}
+
 void vpMbtFaceDepthNormal::computeDesiredFeaturesSVD(const std::vector<double> &point_cloud_face,
                                                      const vpHomogeneousMatrix &cMo, vpColVector &desired_features,
                                                      vpColVector &desired_normal, vpColVector &centroid_point)
@@ -1357,6 +1802,134 @@ void vpMbtFaceDepthNormal::estimateFeatures(const std::vector<double> &point_clo
   x_estimated[2] = C;
 }
 
+/*!
+  Robust plane estimation giving the same result than
+  estimatePlaneEquationSVD() without building the N x 3 data matrix: at each
+  reweighting iteration, the weighted first and second order moments of the
+  points are accumulated in a single pass, from which the weighted centroid and
+  the 3x3 scatter matrix are obtained. The plane normal is then the eigenvector
+  associated to the smallest eigenvalue of the scatter matrix, computed in
+  closed form.
+*/
+void vpMbtFaceDepthNormal::estimatePlaneEquationMoments(const std::vector<double> &point_cloud_face,
+                                                        const vpHomogeneousMatrix &cMo,
+                                                        vpColVector &plane_equation_estimated, vpColVector &centroid)
+{
+  unsigned int max_iter = 10;
+  double prev_error = 1e3;
+  double error = 1e3 - 1;
+
+  // Structure of arrays for the SIMD passes
+  const size_t nb_points = point_cloud_face.size() / 3;
+  m_planeFitX.resize(nb_points);
+  m_planeFitY.resize(nb_points);
+  m_planeFitZ.resize(nb_points);
+  m_planeFitResidues.resize(nb_points);
+  m_planeFitWeights.assign(nb_points, 1.0);
+  for (size_t i = 0; i < nb_points; i++) {
+    m_planeFitX[i] = point_cloud_face[3 * i];
+    m_planeFitY[i] = point_cloud_face[3 * i + 1];
+    m_planeFitZ[i] = point_cloud_face[3 * i + 2];
+  }
+
+  const double *X = &m_planeFitX[0], *Y = &m_planeFitY[0], *Z = &m_planeFitZ[0];
+  double *residues = &m_planeFitResidues[0], *weights = &m_planeFitWeights[0];
+  vpMbtTukeyEstimator<double> tukey;
+  double normal[3] = {0, 0, 0};
+  double m[14];
+  plane_equation_estimated.resize(4, false);
+
+  for (unsigned int iter = 0; iter < max_iter && std::fabs(error - prev_error) > 1e-6; iter++) {
+    if (iter == 0) {
+      // Transform the plane equation for the current pose
+      m_planeCamera = m_planeObject;
+      m_planeCamera.changeFrame(cMo);
+
+      double norm = sqrt(m_planeCamera.getA() * m_planeCamera.getA() + m_planeCamera.getB() * m_planeCamera.getB() +
+                         m_planeCamera.getC() * m_planeCamera.getC());
+
+      // Compute distance point to estimated plane
+      computePlaneResidues(X, Y, Z, weights, nb_points, m_planeCamera.getA() / norm, m_planeCamera.getB() / norm,
+                           m_planeCamera.getC() / norm, m_planeCamera.getD() / norm, residues);
+    }
+
+    tukey.MEstimator(m_planeFitResidues, m_planeFitWeights, 1e-4);
+
+    // Weighted centroid and scatter matrix sum w^2 (P - c) (P - c)^T
+    computePlaneMoments(X, Y, Z, weights, nb_points, m);
+    const double total_w = m[0];
+    const double c[3] = {m[1] / total_w, m[2] / total_w, m[3] / total_w};
+    const double S1[3] = {m[5], m[6], m[7]};
+    const double S2[3][3] = {{m[8], m[9], m[10]}, {m[9], m[11], m[12]}, {m[10], m[12], m[13]}};
+
+    double J[3][3];
+    for (unsigned int i = 0; i < 3; i++) {
+      for (unsigned int j = 0; j < 3; j++) {
+        J[i][j] = S2[i][j] - c[i] * S1[j] - S1[i] * c[j] + m[4] * c[i] * c[j];
+      }
+    }
+
+    if (!computeSmallestEigenVector(J, normal)) {
+      // Degenerated point distribution, rely on the SVD
+      vpMatrix J_(3, 3);
+      for (unsigned int i = 0; i < 3; i++) {
+        for (unsigned int j = 0; j < 3; j++) {
+          J_[i][j] = J[i][j];
+        }
+      }
+
+      vpColVector W;
+      vpMatrix V;
+      J_.svd(W, V);
+
+      unsigned int indexSmallestSv = 0;
+      for (unsigned int i = 1; i < W.size(); i++) {
+        if (W[i] < W[indexSmallestSv]) {
+          indexSmallestSv = i;
+        }
+      }
+
+      for (unsigned int i = 0; i < 3; i++) {
+        normal[i] = V[i][indexSmallestSv];
+      }
+    }
+
+    // Compute plane equation
+    double A = normal[0], B = normal[1], C = normal[2];
+    double D = -(A * c[0] + B * c[1] + C * c[2]);
+
+    // Update plane equation
+    plane_equation_estimated[0] = A;
+    plane_equation_estimated[1] = B;
+    plane_equation_estimated[2] = C;
+    plane_equation_estimated[3] = D;
+
+    // Compute error points to estimated plane
+    prev_error = error;
+    error = computePlaneResidues(X, Y, Z, weights, nb_points, A, B, C, D, residues) / total_w;
+  }
+
+  // Update final weights
+  tukey.MEstimator(m_planeFitResidues, m_planeFitWeights, 1e-4);
+
+  // Update final centroid
+  computePlaneMoments(X, Y, Z, weights, nb_points, m);
+  centroid.resize(3, false);
+  centroid[0] = m[1] / m[0];
+  centroid[1] = m[2] / m[0];
+  centroid[2] = m[3] / m[0];
+
+  // Compute final plane equation
+  double A = normal[0], B = normal[1], C = normal[2];
+  double D = -(A * centroid[0] + B * centroid[1] + C * centroid[2]);
+
+  // Update final plane equation
+  plane_equation_estimated[0] = A;
+  plane_equation_estimated[1] = B;
+  plane_equation_estimated[2] = C;
+  plane_equation_estimated[3] = D;
+}
+
 void vpMbtFaceDepthNormal::estimatePlaneEquationSVD(const std::vector<double> &point_cloud_face,
                                                     const vpHomogeneousMatrix &cMo,
                                                     vpColVector &plane_equation_estimated, vpColVector &centroid)
@@ -1644,6 +2217,19 @@ void vpMbtFaceDepthNormal::setCameraParameters(const vpCameraParameters &camera)
   }
 }
 
+/*!
+  Set the hidden faces used to test the visibility of the face lines.
+
+  \param faces : Pointer to the hidden faces.
+*/
+void vpMbtFaceDepthNormal::setLinesHiddenFaces(vpMbHiddenFaces<vpMbtPolygon> *const faces)
+{
+  for (std::vector<vpMbtDistanceLine *>::const_iterator it = m_listOfFaceLines.begin(); it != m_listOfFaceLines.end();
+       ++it) {
+    (*it)->hiddenface = faces;
+  }
+}
+
 void vpMbtFaceDepthNormal::setScanLineVisibilityTest(bool v)
 {
   m_useScanLine = v;
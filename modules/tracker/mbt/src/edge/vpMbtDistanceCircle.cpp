@@ -65,6 +65,31 @@ vpMbtDistanceCircle::vpMbtDistanceCircle()
 {
 }
 
+/*!
+  Copy constructor. The geometric primitives and the moving edges are
+  duplicated while the moving edge parameters and the hidden faces are shared
+  with \e ci.
+
+  \param ci : Circle to copy.
+*/
+vpMbtDistanceCircle::vpMbtDistanceCircle(const vpMbtDistanceCircle &ci)
+  : name(ci.name), index(ci.index), cam(ci.cam), me(ci.me), wmean(ci.wmean), featureEllipse(ci.featureEllipse),
+    isTrackedCircle(ci.isTrackedCircle), meEllipse(NULL), circle(NULL), radius(ci.radius), p1(NULL), p2(NULL),
+    p3(NULL), L(ci.L), error(ci.error), nbFeature(ci.nbFeature), Reinit(ci.Reinit), hiddenface(ci.hiddenface),
+    index_polygon(ci.index_polygon), isvisible(ci.isvisible)
+{
+  if (ci.meEllipse != NULL)
+    meEllipse = new vpMbtMeEllipse(*ci.meEllipse);
+  if (ci.circle != NULL)
+    circle = new vpCircle(*ci.circle);
+  if (ci.p1 != NULL)
+    p1 = new vpPoint(*ci.p1);
+  if (ci.p2 != NULL)
+    p2 = new vpPoint(*ci.p2);
+  if (ci.p3 != NULL)
+    p3 = new vpPoint(*ci.p3);
+}
+
 /*!
   Basic destructor useful to deallocate the memory.
 */
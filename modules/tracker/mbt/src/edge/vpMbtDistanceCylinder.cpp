@@ -69,6 +69,36 @@ vpMbtDistanceCylinder::vpMbtDistanceCylinder()
 {
 }
 
+/*!
+  Copy constructor. The geometric primitives and the moving edges are
+  duplicated while the moving edge parameters and the hidden faces are shared
+  with \e cy.
+
+  \param cy : Cylinder to copy.
+*/
+vpMbtDistanceCylinder::vpMbtDistanceCylinder(const vpMbtDistanceCylinder &cy)
+  : name(cy.name), index(cy.index), cam(cy.cam), me(cy.me), wmean1(cy.wmean1), wmean2(cy.wmean2),
+    featureline1(cy.featureline1), featureline2(cy.featureline2), isTrackedCylinder(cy.isTrackedCylinder),
+    meline1(NULL), meline2(NULL), cercle1(NULL), cercle2(NULL), radius(cy.radius), p1(NULL), p2(NULL), L(cy.L),
+    error(cy.error), nbFeature(cy.nbFeature), nbFeaturel1(cy.nbFeaturel1), nbFeaturel2(cy.nbFeaturel2),
+    Reinit(cy.Reinit), c(NULL), hiddenface(cy.hiddenface), index_polygon(cy.index_polygon), isvisible(cy.isvisible)
+{
+  if (cy.meline1 != NULL)
+    meline1 = new vpMbtMeLine(*cy.meline1);
+  if (cy.meline2 != NULL)
+    meline2 = new vpMbtMeLine(*cy.meline2);
+  if (cy.cercle1 != NULL)
+    cercle1 = new vpCircle(*cy.cercle1);
+  if (cy.cercle2 != NULL)
+    cercle2 = new vpCircle(*cy.cercle2);
+  if (cy.p1 != NULL)
+    p1 = new vpPoint(*cy.p1);
+  if (cy.p2 != NULL)
+    p2 = new vpPoint(*cy.p2);
+  if (cy.c != NULL)
+    c = new vpCylinder(*cy.c);
+}
+
 /*!
   Basic destructor useful to deallocate the memory.
 */
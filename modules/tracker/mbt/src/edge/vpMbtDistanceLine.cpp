@@ -63,6 +63,32 @@ vpMbtDistanceLine::vpMbtDistanceLine()
 {
 }
 
+/*!
+  Copy constructor. The line and the moving edges are duplicated while the
+  moving edge parameters and the hidden faces are shared with \e l.
+
+  \param l : Line to copy.
+*/
+vpMbtDistanceLine::vpMbtDistanceLine(const vpMbtDistanceLine &l)
+  : name(l.name), index(l.index), cam(l.cam), me(l.me), isTrackedLine(l.isTrackedLine),
+    isTrackedLineWithVisibility(l.isTrackedLineWithVisibility), wmean(l.wmean), featureline(l.featureline),
+    poly(l.poly), useScanLine(l.useScanLine), meline(), line(NULL), p1(NULL), p2(NULL), L(l.L), error(l.error),
+    nbFeature(l.nbFeature), nbFeatureTotal(l.nbFeatureTotal), Reinit(l.Reinit), hiddenface(l.hiddenface),
+    Lindex_polygon(l.Lindex_polygon), Lindex_polygon_tracked(l.Lindex_polygon_tracked), isvisible(l.isvisible)
+{
+  if (l.line != NULL) {
+    line = new vpLine(*l.line);
+  }
+  if (l.p1 != NULL) {
+    p1 = &poly.p[0];
+    p2 = &poly.p[1];
+  }
+
+  for (size_t i = 0; i < l.meline.size(); i++) {
+    meline.push_back(l.meline[i] != NULL ? new vpMbtMeLine(*l.meline[i]) : NULL);
+  }
+}
+
 /*!
   Basic destructor useful to deallocate the memory.
 */
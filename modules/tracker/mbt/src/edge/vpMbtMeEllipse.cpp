@@ -76,6 +76,7 @@ vpMbtMeEllipse::vpMbtMeEllipse(const vpMbtMeEllipse &meellipse)
   mu20 = meellipse.mu20;
   mu02 = meellipse.mu02;
 
+  thresholdWeight = meellipse.thresholdWeight;
   expecteddensity = meellipse.expecteddensity;
 }
 
@@ -45,7 +45,7 @@
 #include <visp3/mbt/vpMbEdgeKltTracker.h>
 #include <visp3/mbt/vpMbtXmlGenericParser.h>
 
-#if defined(VISP_HAVE_MODULE_KLT) && (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
+#if defined(VISP_HAVE_MODULE_KLT)
 
 vpMbEdgeKltTracker::vpMbEdgeKltTracker()
   : m_thresholdKLT(2.), m_thresholdMBT(2.), m_maxIterKlt(30), m_w_mbt(), m_w_klt(), m_error_hybrid(), m_w_hybrid()
@@ -269,6 +269,7 @@ not found or wrong format for the data).
     <harris>0.02</harris>
     <size_block>3</size_block>
     <pyramid_lvl>3</pyramid_lvl>
+    <use_native>0</use_native>
   </klt>
 </conf>
   \endcode
@@ -295,6 +296,7 @@ void vpMbEdgeKltTracker::loadConfigFile(const std::string &configFile)
   xmlp.setKltBlockSize(3);
   xmlp.setKltPyramidLevels(3);
   xmlp.setKltMaskBorder(maskBorder);
+  xmlp.setKltUseNative(m_kltImplementation == KLT_NATIVE);
 
   try {
     std::cout << " *********** Parsing XML for Mb Edge KLT Tracker ************ " << std::endl;
@@ -337,6 +339,7 @@ void vpMbEdgeKltTracker::loadConfigFile(const std::string &configFile)
   xmlp.getEdgeMe(meParser);
   vpMbEdgeTracker::setMovingEdge(meParser);
 
+#if defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100)
   tracker.setMaxFeatures((int)xmlp.getKltMaxFeatures());
   tracker.setWindowSize((int)xmlp.getKltWindowSize());
   tracker.setQuality(xmlp.getKltQuality());
@@ -344,6 +347,14 @@ void vpMbEdgeKltTracker::loadConfigFile(const std::string &configFile)
   tracker.setHarrisFreeParameter(xmlp.getKltHarrisParam());
   tracker.setBlockSize((int)xmlp.getKltBlockSize());
   tracker.setPyramidLevels((int)xmlp.getKltPyramidLevels());
+  m_kltImplementation = xmlp.getKltUseNative() ? KLT_NATIVE : KLT_OPENCV;
+#endif
+  m_kltNative.setMaxFeatures((int)xmlp.getKltMaxFeatures());
+  m_kltNative.setWindowSize((int)xmlp.getKltWindowSize());
+  m_kltNative.setQuality(xmlp.getKltQuality());
+  m_kltNative.setMinDistance(xmlp.getKltMinDistance());
+  m_kltNative.setBlockSize((int)xmlp.getKltBlockSize());
+  m_kltNative.setPyramidLevels((int)xmlp.getKltPyramidLevels());
   maskBorder = xmlp.getKltMaskBorder();
 
   // if(useScanLine)
@@ -1385,7 +1396,7 @@ void vpMbEdgeKltTracker::reInitModel(const vpImage<unsigned char> &I, const std:
                                      const vpHomogeneousMatrix &T)
 {
   // Reinit klt
-  #if (VISP_HAVE_OPENCV_VERSION < 0x020408)
+  #if defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100) && (VISP_HAVE_OPENCV_VERSION < 0x020408)
     if (cur != NULL) {
       cvReleaseImage(&cur);
       cur = NULL;
@@ -43,7 +43,7 @@
 #include <visp3/mbt/vpMbKltTracker.h>
 #include <visp3/mbt/vpMbtXmlGenericParser.h>
 
-#if defined(VISP_HAVE_MODULE_KLT) && (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
+#if defined(VISP_HAVE_MODULE_KLT)
 
 #if defined(__APPLE__) && defined(__MACH__) // Apple OSX and iOS (Darwin)
 #include <TargetConditionals.h>             // To detect OSX or IOS using TARGET_OS_IPHONE or TARGET_OS_IOS macro
@@ -53,13 +53,19 @@ vpMbKltTracker::vpMbKltTracker()
   :
 #if (VISP_HAVE_OPENCV_VERSION >= 0x020408)
     cur(),
-#else
+#elif defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100)
     cur(NULL),
 #endif
-    c0Mo(), firstInitialisation(true), maskBorder(5), threshold_outlier(0.5), percentGood(0.6), ctTc0(), tracker(),
+    c0Mo(), firstInitialisation(true), maskBorder(5), threshold_outlier(0.5), percentGood(0.6), ctTc0(),
+#if defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100)
+    tracker(), m_kltNative(), m_kltImplementation(KLT_OPENCV),
+#else
+    m_kltNative(), m_kltImplementation(KLT_NATIVE),
+#endif
     kltPolygons(), kltCylinders(), circles_disp(), m_nbInfos(0), m_nbFaceUsed(0), m_L_klt(), m_error_klt(), m_w_klt(),
     m_weightedError_klt(), m_robust_klt(), m_featuresToBeDisplayedKlt()
 {
+#if defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100)
   tracker.setTrackerId(1);
   tracker.setUseHarris(1);
   tracker.setMaxFeatures(10000);
@@ -69,6 +75,14 @@ vpMbKltTracker::vpMbKltTracker()
   tracker.setHarrisFreeParameter(0.01);
   tracker.setBlockSize(3);
   tracker.setPyramidLevels(3);
+#endif
+
+  m_kltNative.setMaxFeatures(10000);
+  m_kltNative.setWindowSize(5);
+  m_kltNative.setQuality(0.01);
+  m_kltNative.setMinDistance(5);
+  m_kltNative.setBlockSize(3);
+  m_kltNative.setPyramidLevels(3);
 
 #ifdef VISP_HAVE_OGRE
   faces.getOgreContext()->setWindowName("MBT Klt");
@@ -84,7 +98,7 @@ vpMbKltTracker::vpMbKltTracker()
 */
 vpMbKltTracker::~vpMbKltTracker()
 {
-#if (VISP_HAVE_OPENCV_VERSION < 0x020408)
+#if defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100) && (VISP_HAVE_OPENCV_VERSION < 0x020408)
   if (cur != NULL) {
     cvReleaseImage(&cur);
     cur = NULL;
@@ -158,8 +172,6 @@ void vpMbKltTracker::reinit(const vpImage<unsigned char> &I)
   c0Mo = m_cMo;
   ctTc0.eye();
 
-  vpImageConvert::convert(I, cur);
-
   m_cam.computeFov(I.getWidth(), I.getHeight());
 
   if (useScanLine) {
@@ -167,18 +179,13 @@ void vpMbKltTracker::reinit(const vpImage<unsigned char> &I)
     faces.computeScanLineRender(m_cam, I.getWidth(), I.getHeight());
   }
 
-// mask
-#if (VISP_HAVE_OPENCV_VERSION >= 0x020408)
-  cv::Mat mask((int)I.getRows(), (int)I.getCols(), CV_8UC1, cv::Scalar(0));
-#else
-  IplImage *mask = cvCreateImage(cvSize((int)I.getWidth(), (int)I.getHeight()), IPL_DEPTH_8U, 1);
-  cvZero(mask);
-#endif
+  // mask
+  vpImage<unsigned char> mask(I.getHeight(), I.getWidth(), 0);
 
   vpMbtDistanceKltPoints *kltpoly;
   vpMbtDistanceKltCylinder *kltPolyCylinder;
   if (useScanLine) {
-    vpImageConvert::convert(faces.getMbScanLineRenderer().getMask(), mask);
+    mask = faces.getMbScanLineRenderer().getMask();
   } else {
     unsigned char val = 255 /* - i*15*/;
     for (std::list<vpMbtDistanceKltPoints *>::const_iterator it = kltPolygons.begin(); it != kltPolygons.end(); ++it) {
@@ -209,7 +216,25 @@ void vpMbKltTracker::reinit(const vpImage<unsigned char> &I)
     }
   }
 
-  tracker.initTracking(cur, mask);
+  if (m_kltImplementation == KLT_NATIVE) {
+    m_kltNative.initTracking(I, &mask);
+  }
+#if (VISP_HAVE_OPENCV_VERSION >= 0x020408)
+  else {
+    vpImageConvert::convert(I, cur);
+    // Wrap the mask without copy
+    cv::Mat cvMask((int)mask.getRows(), (int)mask.getCols(), CV_8UC1, mask.bitmap);
+    tracker.initTracking(cur, cvMask);
+  }
+#elif defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100)
+  else {
+    vpImageConvert::convert(I, cur);
+    IplImage *cvMask = NULL;
+    vpImageConvert::convert(mask, cvMask);
+    tracker.initTracking(cur, cvMask);
+    cvReleaseImage(&cvMask);
+  }
+#endif
   //  tracker.track(cur); // AY: Not sure to be usefull but makes sure that
   //  the points are valid for tracking and avoid too fast reinitialisations.
   //  vpCTRACE << "init klt. detected " << tracker.getNbFeatures() << "
@@ -218,7 +243,14 @@ void vpMbKltTracker::reinit(const vpImage<unsigned char> &I)
   for (std::list<vpMbtDistanceKltPoints *>::const_iterator it = kltPolygons.begin(); it != kltPolygons.end(); ++it) {
     kltpoly = *it;
     if (kltpoly->polygon->isVisible() && kltpoly->isTracked() && kltpoly->polygon->getNbPoint() > 2) {
-      kltpoly->init(tracker, m_mask);
+      if (m_kltImplementation == KLT_NATIVE) {
+        kltpoly->init(m_kltNative, m_mask);
+      }
+#if defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100)
+      else {
+        kltpoly->init(tracker, m_mask);
+      }
+#endif
     }
   }
 
@@ -226,13 +258,17 @@ void vpMbKltTracker::reinit(const vpImage<unsigned char> &I)
        ++it) {
     kltPolyCylinder = *it;
 
-    if (kltPolyCylinder->isTracked())
-      kltPolyCylinder->init(tracker, m_cMo);
-  }
-
-#if (VISP_HAVE_OPENCV_VERSION < 0x020408)
-  cvReleaseImage(&mask);
+    if (kltPolyCylinder->isTracked()) {
+      if (m_kltImplementation == KLT_NATIVE) {
+        kltPolyCylinder->init(m_kltNative, m_cMo);
+      }
+#if defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100)
+      else {
+        kltPolyCylinder->init(tracker, m_cMo);
+      }
 #endif
+    }
+  }
 }
 
 /*!
@@ -243,7 +279,7 @@ void vpMbKltTracker::resetTracker()
 {
   m_cMo.eye();
 
-#if (VISP_HAVE_OPENCV_VERSION < 0x020408)
+#if defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100) && (VISP_HAVE_OPENCV_VERSION < 0x020408)
   if (cur != NULL) {
     cvReleaseImage(&cur);
     cur = NULL;
@@ -285,6 +321,7 @@ void vpMbKltTracker::resetTracker()
   firstInitialisation = true;
   computeCovariance = false;
 
+#if defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100)
   tracker.setTrackerId(1);
   tracker.setUseHarris(1);
 
@@ -295,6 +332,14 @@ void vpMbKltTracker::resetTracker()
   tracker.setHarrisFreeParameter(0.01);
   tracker.setBlockSize(3);
   tracker.setPyramidLevels(3);
+#endif
+
+  m_kltNative.setMaxFeatures(10000);
+  m_kltNative.setWindowSize(5);
+  m_kltNative.setQuality(0.01);
+  m_kltNative.setMinDistance(5);
+  m_kltNative.setBlockSize(3);
+  m_kltNative.setPyramidLevels(3);
 
   angleAppears = vpMath::rad(89);
   angleDisappears = vpMath::rad(89);
@@ -330,10 +375,10 @@ void vpMbKltTracker::resetTracker()
 std::vector<vpImagePoint> vpMbKltTracker::getKltImagePoints() const
 {
   std::vector<vpImagePoint> kltPoints;
-  for (unsigned int i = 0; i < static_cast<unsigned int>(tracker.getNbFeatures()); i++) {
+  for (unsigned int i = 0; i < static_cast<unsigned int>(getKltNbPoints()); i++) {
     long id;
     float x_tmp, y_tmp;
-    tracker.getFeature((int)i, id, x_tmp, y_tmp);
+    getKltFeature((int)i, id, x_tmp, y_tmp);
     kltPoints.push_back(vpImagePoint(y_tmp, x_tmp));
   }
 
@@ -351,10 +396,10 @@ std::vector<vpImagePoint> vpMbKltTracker::getKltImagePoints() const
 std::map<int, vpImagePoint> vpMbKltTracker::getKltImagePointsWithId() const
 {
   std::map<int, vpImagePoint> kltPoints;
-  for (unsigned int i = 0; i < static_cast<unsigned int>(tracker.getNbFeatures()); i++) {
+  for (unsigned int i = 0; i < static_cast<unsigned int>(getKltNbPoints()); i++) {
     long id;
     float x_tmp, y_tmp;
-    tracker.getFeature((int)i, id, x_tmp, y_tmp);
+    getKltFeature((int)i, id, x_tmp, y_tmp);
 #if TARGET_OS_IPHONE
     kltPoints[(int)id] = vpImagePoint(y_tmp, x_tmp);
 #else
@@ -366,7 +411,77 @@ std::map<int, vpImagePoint> vpMbKltTracker::getKltImagePointsWithId() const
 }
 
 /*!
-  Set the new value of the klt tracker.
+  Get the feature at the given index from the KLT implementation in use.
+
+  \param index : Index of the feature.
+  \param id : Id of the feature.
+  \param x : Abscissa of the feature.
+  \param y : Ordinate of the feature.
+*/
+void vpMbKltTracker::getKltFeature(int index, long &id, float &x, float &y) const
+{
+#if defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100)
+  if (m_kltImplementation == KLT_OPENCV) {
+    tracker.getFeature(index, id, x, y);
+    return;
+  }
+#endif
+  m_kltNative.getFeature(index, id, x, y);
+}
+
+/*!
+  Get the current number of klt points.
+
+  \return the number of features
+*/
+int vpMbKltTracker::getKltNbPoints() const
+{
+#if defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100)
+  if (m_kltImplementation == KLT_OPENCV) {
+    return tracker.getNbFeatures();
+  }
+#endif
+  return m_kltNative.getNbFeatures();
+}
+
+/*!
+  Select the KLT implementation used to detect and track the points. The
+  tracker has to be initialized again after a change of implementation.
+
+  \param type : KLT_OPENCV to use vpKltOpencv, KLT_NATIVE to use vpKltNative.
+
+  \exception vpException::badValue : If KLT_OPENCV is requested while ViSP is
+  not built with OpenCV.
+*/
+void vpMbKltTracker::setKltImplementation(const vpKltImplementationType &type)
+{
+#if !(defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
+  if (type == KLT_OPENCV) {
+    throw vpException(vpException::badValue, "Cannot use OpenCV KLT implementation: OpenCV is not available");
+  }
+#endif
+  m_kltImplementation = type;
+}
+
+/*!
+  Set the new value of the native klt tracker.
+
+  \param t : Klt tracker containing the new values.
+*/
+void vpMbKltTracker::setKltNative(const vpKltNative &t)
+{
+  m_kltNative.setMaxFeatures(t.getMaxFeatures());
+  m_kltNative.setWindowSize(t.getWindowSize());
+  m_kltNative.setQuality(t.getQuality());
+  m_kltNative.setMinDistance(t.getMinDistance());
+  m_kltNative.setBlockSize(t.getBlockSize());
+  m_kltNative.setPyramidLevels(t.getPyramidLevels());
+}
+
+#if defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100)
+/*!
+  Set the new value of the klt tracker. The parameters are also applied to
+  the native klt tracker.
 
   \param t : Klt tracker containing the new values.
 */
@@ -379,7 +494,15 @@ void vpMbKltTracker::setKltOpencv(const vpKltOpencv &t)
   tracker.setHarrisFreeParameter(t.getHarrisFreeParameter());
   tracker.setBlockSize(t.getBlockSize());
   tracker.setPyramidLevels(t.getPyramidLevels());
+
+  m_kltNative.setMaxFeatures(t.getMaxFeatures());
+  m_kltNative.setWindowSize(t.getWindowSize());
+  m_kltNative.setQuality(t.getQuality());
+  m_kltNative.setMinDistance(t.getMinDistance());
+  m_kltNative.setBlockSize(t.getBlockSize());
+  m_kltNative.setPyramidLevels(t.getPyramidLevels());
 }
+#endif
 
 /*!
   Set the camera parameters.
@@ -427,26 +550,9 @@ void vpMbKltTracker::setPose(const vpImage<unsigned char> * const I, const vpIma
   } else {
     vpMbtDistanceKltPoints *kltpoly;
 
-#if (VISP_HAVE_OPENCV_VERSION >= 0x020408)
-    std::vector<cv::Point2f> init_pts;
+    std::vector<vpImagePoint> init_pts;
     std::vector<long> init_ids;
-    std::vector<cv::Point2f> guess_pts;
-#else
-    unsigned int nbp = 0;
-    for (std::list<vpMbtDistanceKltPoints *>::const_iterator it = kltPolygons.begin(); it != kltPolygons.end(); ++it) {
-      kltpoly = *it;
-      if (kltpoly->polygon->isVisible() && kltpoly->polygon->getNbPoint() > 2)
-        nbp += (*it)->getCurrentNumberPoints();
-    }
-
-    CvPoint2D32f *init_pts = NULL;
-    init_pts = (CvPoint2D32f *)cvAlloc(tracker.getMaxFeatures() * sizeof(init_pts[0]));
-    long *init_ids = (long *)cvAlloc((unsigned int)tracker.getMaxFeatures() * sizeof(long));
-    unsigned int iter_pts = 0;
-
-    CvPoint2D32f *guess_pts = NULL;
-    guess_pts = (CvPoint2D32f *)cvAlloc(tracker.getMaxFeatures() * sizeof(guess_pts[0]));
-#endif
+    std::vector<vpImagePoint> guess_pts;
 
     vpHomogeneousMatrix cdMc = cdMo * m_cMo.inverse();
     vpHomogeneousMatrix cMcd = cdMc.inverse();
@@ -486,7 +592,6 @@ void vpMbKltTracker::setPose(const vpImage<unsigned char> * const I, const vpIma
         std::map<int, vpImagePoint>::const_iterator iter = kltpoly->getCurrentPoints().begin();
         // nbCur+= (unsigned int)kltpoly->getCurrentPoints().size();
         for (; iter != kltpoly->getCurrentPoints().end(); ++iter) {
-#if (VISP_HAVE_OPENCV_VERSION >= 0x020408)
 #if TARGET_OS_IPHONE
           if (std::find(init_ids.begin(), init_ids.end(), (long)(kltpoly->getCurrentPointsInd())[(int)iter->first]) !=
               init_ids.end())
@@ -499,26 +604,18 @@ void vpMbKltTracker::setPose(const vpImage<unsigned char> * const I, const vpIma
             // vpMbtDistanceKltPoints due to possible overlapping faces)
             continue;
           }
-#endif
 
           vpColVector cdp(3);
           cdp[0] = iter->second.get_j();
           cdp[1] = iter->second.get_i();
           cdp[2] = 1.0;
 
-#if (VISP_HAVE_OPENCV_VERSION >= 0x020408)
-          cv::Point2f p((float)cdp[0], (float)cdp[1]);
-          init_pts.push_back(p);
+          init_pts.push_back(iter->second);
 #if TARGET_OS_IPHONE
           init_ids.push_back((size_t)(kltpoly->getCurrentPointsInd())[(int)iter->first]);
 #else
           init_ids.push_back((size_t)(kltpoly->getCurrentPointsInd())[(size_t)iter->first]);
 #endif
-#else
-          init_pts[iter_pts].x = (float)cdp[0];
-          init_pts[iter_pts].y = (float)cdp[1];
-          init_ids[iter_pts] = (kltpoly->getCurrentPointsInd())[(size_t)iter->first];
-#endif
 
           double p_mu_t_2 = cdp[0] * cdGc[2][0] + cdp[1] * cdGc[2][1] + cdGc[2][2];
 
@@ -531,40 +628,55 @@ void vpMbKltTracker::setPose(const vpImage<unsigned char> * const I, const vpIma
           cdp[0] = (cdp[0] * cdGc[0][0] + cdp[1] * cdGc[0][1] + cdGc[0][2]) / p_mu_t_2;
           cdp[1] = (cdp[0] * cdGc[1][0] + cdp[1] * cdGc[1][1] + cdGc[1][2]) / p_mu_t_2;
 
-// Set value to the KLT tracker
-#if (VISP_HAVE_OPENCV_VERSION >= 0x020408)
-          cv::Point2f p_guess((float)cdp[0], (float)cdp[1]);
-          guess_pts.push_back(p_guess);
-#else
-          guess_pts[iter_pts].x = (float)cdp[0];
-          guess_pts[iter_pts++].y = (float)cdp[1];
-#endif
+          // Set value to the KLT tracker
+          guess_pts.push_back(vpImagePoint(cdp[1], cdp[0]));
         }
       }
     }
 
-    if (I) {
-      vpImageConvert::convert(*I, cur);
-    } else {
-      vpImageConvert::convert(m_I, cur);
+    if (m_kltImplementation == KLT_NATIVE) {
+      m_kltNative.setInitialGuess(init_pts, guess_pts, init_ids);
     }
-
 #if (VISP_HAVE_OPENCV_VERSION >= 0x020408)
-    tracker.setInitialGuess(init_pts, guess_pts, init_ids);
-#else
-    tracker.setInitialGuess(&init_pts, &guess_pts, init_ids, iter_pts);
+    else {
+      if (I) {
+        vpImageConvert::convert(*I, cur);
+      } else {
+        vpImageConvert::convert(m_I, cur);
+      }
 
-    if (init_pts)
-      cvFree(&init_pts);
-    init_pts = NULL;
+      std::vector<cv::Point2f> init_pts_cv(init_pts.size()), guess_pts_cv(guess_pts.size());
+      for (size_t i = 0; i < init_pts.size(); i++) {
+        init_pts_cv[i] = cv::Point2f((float)init_pts[i].get_u(), (float)init_pts[i].get_v());
+        guess_pts_cv[i] = cv::Point2f((float)guess_pts[i].get_u(), (float)guess_pts[i].get_v());
+      }
+      tracker.setInitialGuess(init_pts_cv, guess_pts_cv, init_ids);
+    }
+#elif defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100)
+    else {
+      if (I) {
+        vpImageConvert::convert(*I, cur);
+      } else {
+        vpImageConvert::convert(m_I, cur);
+      }
 
-    if (guess_pts)
-      cvFree(&guess_pts);
-    guess_pts = NULL;
+      int nbp = (int)init_pts.size();
+      CvPoint2D32f *init_pts_cv = (CvPoint2D32f *)cvAlloc((size_t)std::max(nbp, 1) * sizeof(CvPoint2D32f));
+      CvPoint2D32f *guess_pts_cv = (CvPoint2D32f *)cvAlloc((size_t)std::max(nbp, 1) * sizeof(CvPoint2D32f));
+      long *init_ids_cv = (long *)cvAlloc((size_t)std::max(nbp, 1) * sizeof(long));
+      for (int i = 0; i < nbp; i++) {
+        init_pts_cv[i].x = (float)init_pts[(size_t)i].get_u();
+        init_pts_cv[i].y = (float)init_pts[(size_t)i].get_v();
+        guess_pts_cv[i].x = (float)guess_pts[(size_t)i].get_u();
+        guess_pts_cv[i].y = (float)guess_pts[(size_t)i].get_v();
+        init_ids_cv[i] = init_ids[(size_t)i];
+      }
+      tracker.setInitialGuess(&init_pts_cv, &guess_pts_cv, init_ids_cv, nbp);
 
-    if (init_ids)
-      cvFree(&init_ids);
-    init_ids = NULL;
+      cvFree(&init_pts_cv);
+      cvFree(&guess_pts_cv);
+      cvFree(&init_ids_cv);
+    }
 #endif
 
     bool reInitialisation = false;
@@ -601,7 +713,14 @@ void vpMbKltTracker::setPose(const vpImage<unsigned char> * const I, const vpIma
       kltpoly = *it;
       if (kltpoly->polygon->isVisible() && kltpoly->polygon->getNbPoint() > 2) {
         kltpoly->polygon->computePolygonClipped(m_cam);
-        kltpoly->init(tracker, m_mask);
+        if (m_kltImplementation == KLT_NATIVE) {
+          kltpoly->init(m_kltNative, m_mask);
+        }
+#if defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100)
+        else {
+          kltpoly->init(tracker, m_mask);
+        }
+#endif
       }
     }
 
@@ -678,8 +797,16 @@ void vpMbKltTracker::initFaceFromLines(vpMbtPolygon &polygon)
 */
 void vpMbKltTracker::preTracking(const vpImage<unsigned char> &I)
 {
-  vpImageConvert::convert(I, cur);
-  tracker.track(cur);
+  if (m_kltImplementation == KLT_NATIVE) {
+    // No conversion: the native tracker works directly on the ViSP image
+    m_kltNative.track(I);
+  }
+#if defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100)
+  else {
+    vpImageConvert::convert(I, cur);
+    tracker.track(cur);
+  }
+#endif
 
   m_nbInfos = 0;
   m_nbFaceUsed = 0;
@@ -687,7 +814,14 @@ void vpMbKltTracker::preTracking(const vpImage<unsigned char> &I)
   for (std::list<vpMbtDistanceKltPoints *>::const_iterator it = kltPolygons.begin(); it != kltPolygons.end(); ++it) {
     vpMbtDistanceKltPoints *kltpoly = *it;
     if (kltpoly->polygon->isVisible() && kltpoly->isTracked() && kltpoly->polygon->getNbPoint() > 2) {
-      kltpoly->computeNbDetectedCurrent(tracker, m_mask);
+      if (m_kltImplementation == KLT_NATIVE) {
+        kltpoly->computeNbDetectedCurrent(m_kltNative, m_mask);
+      }
+#if defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100)
+      else {
+        kltpoly->computeNbDetectedCurrent(tracker, m_mask);
+      }
+#endif
       //       faces[i]->ransac();
       if (kltpoly->hasEnoughPoints()) {
         m_nbInfos += kltpoly->getCurrentNumberPoints();
@@ -701,7 +835,14 @@ void vpMbKltTracker::preTracking(const vpImage<unsigned char> &I)
     vpMbtDistanceKltCylinder *kltPolyCylinder = *it;
 
     if (kltPolyCylinder->isTracked()) {
-      kltPolyCylinder->computeNbDetectedCurrent(tracker);
+      if (m_kltImplementation == KLT_NATIVE) {
+        kltPolyCylinder->computeNbDetectedCurrent(m_kltNative);
+      }
+#if defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100)
+      else {
+        kltPolyCylinder->computeNbDetectedCurrent(tracker);
+      }
+#endif
       if (kltPolyCylinder->hasEnoughPoints()) {
         m_nbInfos += kltPolyCylinder->getCurrentNumberPoints();
         m_nbFaceUsed++;
@@ -999,6 +1140,7 @@ not found or wrong format for the data).
     <harris>0.02</harris>
     <size_block>3</size_block>
     <pyramid_lvl>3</pyramid_lvl>
+    <use_native>0</use_native>
   </klt>
 </conf>
   \endcode
@@ -1019,6 +1161,7 @@ void vpMbKltTracker::loadConfigFile(const std::string &configFile)
   xmlp.setKltBlockSize(3);
   xmlp.setKltPyramidLevels(3);
   xmlp.setKltMaskBorder(maskBorder);
+  xmlp.setKltUseNative(m_kltImplementation == KLT_NATIVE);
   xmlp.setAngleAppear(vpMath::deg(angleAppears));
   xmlp.setAngleDisappear(vpMath::deg(angleDisappears));
 
@@ -1034,6 +1177,7 @@ void vpMbKltTracker::loadConfigFile(const std::string &configFile)
   xmlp.getCameraParameters(camera);
   setCameraParameters(camera);
 
+#if defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100)
   tracker.setMaxFeatures((int)xmlp.getKltMaxFeatures());
   tracker.setWindowSize((int)xmlp.getKltWindowSize());
   tracker.setQuality(xmlp.getKltQuality());
@@ -1041,6 +1185,14 @@ void vpMbKltTracker::loadConfigFile(const std::string &configFile)
   tracker.setHarrisFreeParameter(xmlp.getKltHarrisParam());
   tracker.setBlockSize((int)xmlp.getKltBlockSize());
   tracker.setPyramidLevels((int)xmlp.getKltPyramidLevels());
+  m_kltImplementation = xmlp.getKltUseNative() ? KLT_NATIVE : KLT_OPENCV;
+#endif
+  m_kltNative.setMaxFeatures((int)xmlp.getKltMaxFeatures());
+  m_kltNative.setWindowSize((int)xmlp.getKltWindowSize());
+  m_kltNative.setQuality(xmlp.getKltQuality());
+  m_kltNative.setMinDistance(xmlp.getKltMinDistance());
+  m_kltNative.setBlockSize((int)xmlp.getKltBlockSize());
+  m_kltNative.setPyramidLevels((int)xmlp.getKltPyramidLevels());
   maskBorder = xmlp.getKltMaskBorder();
   angleAppears = vpMath::rad(xmlp.getAngleAppear());
   angleDisappears = vpMath::rad(xmlp.getAngleDisappear());
@@ -1398,7 +1550,7 @@ void vpMbKltTracker::reInitModel(const vpImage<unsigned char> &I, const std::str
 {
   m_cMo.eye();
 
-#if (VISP_HAVE_OPENCV_VERSION < 0x020408)
+#if defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100) && (VISP_HAVE_OPENCV_VERSION < 0x020408)
   if (cur != NULL) {
     cvReleaseImage(&cur);
     cur = NULL;
@@ -36,11 +36,12 @@
  *
  *****************************************************************************/
 
+#include <visp3/core/vpImageConvert.h>
 #include <visp3/core/vpPolygon.h>
 #include <visp3/mbt/vpMbtDistanceKltCylinder.h>
 #include <visp3/mbt/vpMbtDistanceKltPoints.h>
 
-#if defined(VISP_HAVE_MODULE_KLT) && (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
+#if defined(VISP_HAVE_MODULE_KLT)
 
 #if defined(VISP_HAVE_CLIPPER)
 #include <clipper.hpp> // clipper private library
@@ -95,15 +96,8 @@ void vpMbtDistanceKltCylinder::buildFrom(const vpPoint &p1, const vpPoint &p2, c
                                (p1.get_oY() + p2.get_oY()) / 2.0, (p1.get_oZ() + p2.get_oZ()) / 2.0, r);
 }
 
-/*!
-  Initialise the cylinder to track. All the points in the map, representing
-  all the map detected in the image, are parsed in order to extract the id of
-  the points that are indeed in the face.
-
-  \param _tracker : ViSP OpenCV KLT Tracker.
-  \param cMo : Pose of the object in the camera frame at initialization.
-*/
-void vpMbtDistanceKltCylinder::init(const vpKltOpencv &_tracker, const vpHomogeneousMatrix &cMo)
+template <class KltTracker>
+void vpMbtDistanceKltCylinder::initImpl(const KltTracker &_tracker, const vpHomogeneousMatrix &cMo)
 {
   c0Mo = cMo;
   cylinder.changeFrame(cMo);
@@ -185,15 +179,8 @@ void vpMbtDistanceKltCylinder::init(const vpKltOpencv &_tracker, const vpHomogen
   // std::endl;
 }
 
-/*!
-  compute the number of point in this instanciation of the tracker that
-  corresponds to the points of the cylinder
-
-  \param _tracker : the KLT tracker
-  \return the number of points that are tracked in this face and in this
-  instanciation of the tracker
-*/
-unsigned int vpMbtDistanceKltCylinder::computeNbDetectedCurrent(const vpKltOpencv &_tracker)
+template <class KltTracker>
+unsigned int vpMbtDistanceKltCylinder::computeNbDetectedCurrentImpl(const KltTracker &_tracker)
 {
   long id;
   float x, y;
@@ -223,6 +210,60 @@ unsigned int vpMbtDistanceKltCylinder::computeNbDetectedCurrent(const vpKltOpenc
   return nbPointsCur;
 }
 
+/*!
+  Initialise the cylinder to track. All the points in the map, representing
+  all the map detected in the image, are parsed in order to extract the id of
+  the points that are indeed in the face.
+
+  \param _tracker : ViSP native KLT Tracker.
+  \param cMo : Pose of the object in the camera frame at initialization.
+*/
+void vpMbtDistanceKltCylinder::init(const vpKltNative &_tracker, const vpHomogeneousMatrix &cMo)
+{
+  initImpl(_tracker, cMo);
+}
+
+/*!
+  compute the number of point in this instanciation of the tracker that
+  corresponds to the points of the cylinder
+
+  \param _tracker : the native KLT tracker
+  \return the number of points that are tracked in this face and in this
+  instanciation of the tracker
+*/
+unsigned int vpMbtDistanceKltCylinder::computeNbDetectedCurrent(const vpKltNative &_tracker)
+{
+  return computeNbDetectedCurrentImpl(_tracker);
+}
+
+#if defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100)
+/*!
+  Initialise the cylinder to track. All the points in the map, representing
+  all the map detected in the image, are parsed in order to extract the id of
+  the points that are indeed in the face.
+
+  \param _tracker : ViSP OpenCV KLT Tracker.
+  \param cMo : Pose of the object in the camera frame at initialization.
+*/
+void vpMbtDistanceKltCylinder::init(const vpKltOpencv &_tracker, const vpHomogeneousMatrix &cMo)
+{
+  initImpl(_tracker, cMo);
+}
+
+/*!
+  compute the number of point in this instanciation of the tracker that
+  corresponds to the points of the cylinder
+
+  \param _tracker : the KLT tracker
+  \return the number of points that are tracked in this face and in this
+  instanciation of the tracker
+*/
+unsigned int vpMbtDistanceKltCylinder::computeNbDetectedCurrent(const vpKltOpencv &_tracker)
+{
+  return computeNbDetectedCurrentImpl(_tracker);
+}
+#endif
+
 /*!
   This method removes the outliers. A point is considered as outlier when its
   associated weight is below a given threshold (threshold_outlier).
@@ -373,21 +414,10 @@ bool vpMbtDistanceKltCylinder::isTrackedFeature(int _id)
   \param shiftBorder : Optionnal shift for the border in pixel (sort of
   built-in erosion) to avoid to consider pixels near the limits of the face.
 */
-void vpMbtDistanceKltCylinder::updateMask(
-#if (VISP_HAVE_OPENCV_VERSION >= 0x020408)
-    cv::Mat &mask,
-#else
-    IplImage *mask,
-#endif
-    unsigned char nb, unsigned int shiftBorder)
+void vpMbtDistanceKltCylinder::updateMask(vpImage<unsigned char> &mask, unsigned char nb, unsigned int shiftBorder)
 {
-#if (VISP_HAVE_OPENCV_VERSION >= 0x020408)
-  int width = mask.cols;
-  int height = mask.rows;
-#else
-  int width = mask->width;
-  int height = mask->height;
-#endif
+  int width = (int)mask.getWidth();
+  int height = (int)mask.getHeight();
 
   for (unsigned int kc = 0; kc < listIndicesCylinderBBox.size(); kc++) {
     if ((*hiddenface)[(unsigned int)listIndicesCylinderBBox[kc]]->isVisible() &&
@@ -464,9 +494,9 @@ void vpMbtDistanceKltCylinder::updateMask(
         j_max = width;
       }
 
-#if (VISP_HAVE_OPENCV_VERSION >= 0x020408)
       for (int i = i_min; i < i_max; i++) {
         double i_d = (double)i;
+        unsigned char *ptrData = mask[i];
 
         for (int j = j_min; j < j_max; j++) {
           double j_d = (double)j;
@@ -474,7 +504,7 @@ void vpMbtDistanceKltCylinder::updateMask(
 #if defined(VISP_HAVE_CLIPPER)
           imPt.set_ij(i_d, j_d);
           if (polygon_test.isInside(imPt)) {
-            mask.ptr<uchar>(i)[j] = nb;
+            ptrData[j] = nb;
           }
 #else
           if (shiftBorder != 0) {
@@ -483,47 +513,62 @@ void vpMbtDistanceKltCylinder::updateMask(
                 vpPolygon::isInside(roi, i_d - shiftBorder_d, j_d + shiftBorder_d) &&
                 vpPolygon::isInside(roi, i_d + shiftBorder_d, j_d - shiftBorder_d) &&
                 vpPolygon::isInside(roi, i_d - shiftBorder_d, j_d - shiftBorder_d)) {
-              mask.at<unsigned char>(i, j) = nb;
+              ptrData[j] = nb;
             }
           } else {
             if (vpPolygon::isInside(roi, i, j)) {
-              mask.at<unsigned char>(i, j) = nb;
+              ptrData[j] = nb;
             }
           }
 #endif
         }
       }
-#else
-      unsigned char *ptrData = (unsigned char *)mask->imageData + i_min * mask->widthStep + j_min;
-      for (int i = i_min; i < i_max; i++) {
-        double i_d = (double)i;
-        for (int j = j_min; j < j_max; j++) {
-          double j_d = (double)j;
-          if (shiftBorder != 0) {
-            if (vpPolygon::isInside(roi, i_d, j_d) &&
-                vpPolygon::isInside(roi, i_d + shiftBorder_d, j_d + shiftBorder_d) &&
-                vpPolygon::isInside(roi, i_d - shiftBorder_d, j_d + shiftBorder_d) &&
-                vpPolygon::isInside(roi, i_d + shiftBorder_d, j_d - shiftBorder_d) &&
-                vpPolygon::isInside(roi, i_d - shiftBorder_d, j_d - shiftBorder_d)) {
-              *(ptrData++) = nb;
-            } else {
-              ptrData++;
-            }
-          } else {
-            if (vpPolygon::isInside(roi, i, j)) {
-              *(ptrData++) = nb;
-            } else {
-              ptrData++;
-            }
-          }
-        }
-        ptrData += mask->widthStep - j_max + j_min;
-      }
-#endif
     }
   }
 }
 
+#if (VISP_HAVE_OPENCV_VERSION >= 0x020408)
+/*!
+  Modification of all the pixels that are in the roi to the value of _nb (
+  default is 255).
+
+  \param mask : the mask to update (0, not in the object, _nb otherwise).
+  \param nb : Optionnal value to set to the pixels included in the face.
+  \param shiftBorder : Optionnal shift for the border in pixel (sort of
+  built-in erosion) to avoid to consider pixels near the limits of the face.
+*/
+void vpMbtDistanceKltCylinder::updateMask(cv::Mat &mask, unsigned char nb, unsigned int shiftBorder)
+{
+  if (mask.isContinuous()) {
+    // Work directly on the OpenCV buffer
+    vpImage<unsigned char> I_mask(mask.ptr<unsigned char>(0), (unsigned int)mask.rows, (unsigned int)mask.cols, false);
+    updateMask(I_mask, nb, shiftBorder);
+  } else {
+    vpImage<unsigned char> I_mask;
+    vpImageConvert::convert(mask, I_mask);
+    updateMask(I_mask, nb, shiftBorder);
+    cv::Mat(mask.rows, mask.cols, CV_8UC1, I_mask.bitmap).copyTo(mask);
+  }
+}
+#elif defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100)
+/*!
+  Modification of all the pixels that are in the roi to the value of _nb (
+  default is 255).
+
+  \param mask : the mask to update (0, not in the object, _nb otherwise).
+  \param nb : Optionnal value to set to the pixels included in the face.
+  \param shiftBorder : Optionnal shift for the border in pixel (sort of
+  built-in erosion) to avoid to consider pixels near the limits of the face.
+*/
+void vpMbtDistanceKltCylinder::updateMask(IplImage *mask, unsigned char nb, unsigned int shiftBorder)
+{
+  vpImage<unsigned char> I_mask;
+  vpImageConvert::convert(mask, I_mask);
+  updateMask(I_mask, nb, shiftBorder);
+  vpImageConvert::convert(I_mask, mask);
+}
+#endif
+
 /*!
   Display the primitives tracked for the cylinder.
 
@@ -37,11 +37,12 @@
  *
  *****************************************************************************/
 
+#include <visp3/core/vpImageConvert.h>
 #include <visp3/core/vpPolygon.h>
 #include <visp3/mbt/vpMbtDistanceKltPoints.h>
 #include <visp3/me/vpMeTracker.h>
 
-#if defined(VISP_HAVE_MODULE_KLT) && (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
+#if defined(VISP_HAVE_MODULE_KLT)
 
 #if defined(VISP_HAVE_CLIPPER)
 #include <clipper.hpp> // clipper private library
@@ -69,15 +70,7 @@ vpMbtDistanceKltPoints::vpMbtDistanceKltPoints()
 */
 vpMbtDistanceKltPoints::~vpMbtDistanceKltPoints() {}
 
-/*!
-  Initialise the face to track. All the points in the map, representing all
-  the map detected in the image, are parsed in order to extract the id of the
-  points that are indeed in the face.
-
-  \param _tracker : ViSP OpenCV KLT Tracker.
-  \param mask: Mask image or NULL if not wanted. Mask values that are set to true are considered in the tracking. To disable a pixel, set false.
-*/
-void vpMbtDistanceKltPoints::init(const vpKltOpencv &_tracker, const vpImage<bool> *mask)
+template <class KltTracker> void vpMbtDistanceKltPoints::initImpl(const KltTracker &_tracker, const vpImage<bool> *mask)
 {
   // extract ids of the points in the face
   nbPointsInit = 0;
@@ -141,16 +134,8 @@ void vpMbtDistanceKltPoints::init(const vpKltOpencv &_tracker, const vpImage<boo
   invd0 = 1.0 / d0;
 }
 
-/*!
-  compute the number of point in this instanciation of the tracker that
-  corresponds to the points of the face
-
-  \param _tracker : the KLT tracker
-  \return the number of points that are tracked in this face and in this
-  instanciation of the tracker
-  \param mask: Mask image or NULL if not wanted. Mask values that are set to true are considered in the tracking. To disable a pixel, set false.
-*/
-unsigned int vpMbtDistanceKltPoints::computeNbDetectedCurrent(const vpKltOpencv &_tracker, const vpImage<bool> *mask)
+template <class KltTracker>
+unsigned int vpMbtDistanceKltPoints::computeNbDetectedCurrentImpl(const KltTracker &_tracker, const vpImage<bool> *mask)
 {
   long id;
   float x, y;
@@ -181,6 +166,56 @@ unsigned int vpMbtDistanceKltPoints::computeNbDetectedCurrent(const vpKltOpencv
   return nbPointsCur;
 }
 
+/*!
+  Initialise the face to track. All the points in the map, representing all
+  the map detected in the image, are parsed in order to extract the id of the
+  points that are indeed in the face.
+
+  \param _tracker : ViSP native KLT Tracker.
+  \param mask: Mask image or NULL if not wanted. Mask values that are set to true are considered in the tracking. To disable a pixel, set false.
+*/
+void vpMbtDistanceKltPoints::init(const vpKltNative &_tracker, const vpImage<bool> *mask) { initImpl(_tracker, mask); }
+
+/*!
+  compute the number of point in this instanciation of the tracker that
+  corresponds to the points of the face
+
+  \param _tracker : the native KLT tracker
+  \return the number of points that are tracked in this face and in this
+  instanciation of the tracker
+  \param mask: Mask image or NULL if not wanted. Mask values that are set to true are considered in the tracking. To disable a pixel, set false.
+*/
+unsigned int vpMbtDistanceKltPoints::computeNbDetectedCurrent(const vpKltNative &_tracker, const vpImage<bool> *mask)
+{
+  return computeNbDetectedCurrentImpl(_tracker, mask);
+}
+
+#if defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100)
+/*!
+  Initialise the face to track. All the points in the map, representing all
+  the map detected in the image, are parsed in order to extract the id of the
+  points that are indeed in the face.
+
+  \param _tracker : ViSP OpenCV KLT Tracker.
+  \param mask: Mask image or NULL if not wanted. Mask values that are set to true are considered in the tracking. To disable a pixel, set false.
+*/
+void vpMbtDistanceKltPoints::init(const vpKltOpencv &_tracker, const vpImage<bool> *mask) { initImpl(_tracker, mask); }
+
+/*!
+  compute the number of point in this instanciation of the tracker that
+  corresponds to the points of the face
+
+  \param _tracker : the KLT tracker
+  \return the number of points that are tracked in this face and in this
+  instanciation of the tracker
+  \param mask: Mask image or NULL if not wanted. Mask values that are set to true are considered in the tracking. To disable a pixel, set false.
+*/
+unsigned int vpMbtDistanceKltPoints::computeNbDetectedCurrent(const vpKltOpencv &_tracker, const vpImage<bool> *mask)
+{
+  return computeNbDetectedCurrentImpl(_tracker, mask);
+}
+#endif
+
 /*!
   Compute the interaction matrix and the residu vector for the face.
   The method assumes that these two objects are properly sized in order to be
@@ -351,21 +386,10 @@ bool vpMbtDistanceKltPoints::isTrackedFeature(int _id)
   \param shiftBorder : Optionnal shift for the border in pixel (sort of
   built-in erosion) to avoid to consider pixels near the limits of the face.
 */
-void vpMbtDistanceKltPoints::updateMask(
-#if (VISP_HAVE_OPENCV_VERSION >= 0x020408)
-    cv::Mat &mask,
-#else
-    IplImage *mask,
-#endif
-    unsigned char nb, unsigned int shiftBorder)
+void vpMbtDistanceKltPoints::updateMask(vpImage<unsigned char> &mask, unsigned char nb, unsigned int shiftBorder)
 {
-#if (VISP_HAVE_OPENCV_VERSION >= 0x020408)
-  int width = mask.cols;
-  int height = mask.rows;
-#else
-  int width = mask->width;
-  int height = mask->height;
-#endif
+  int width = (int)mask.getWidth();
+  int height = (int)mask.getHeight();
 
   int i_min, i_max, j_min, j_max;
   std::vector<vpImagePoint> roi;
@@ -440,9 +464,9 @@ void vpMbtDistanceKltPoints::updateMask(
     j_max = width;
   }
 
-#if (VISP_HAVE_OPENCV_VERSION >= 0x020408)
   for (int i = i_min; i < i_max; i++) {
     double i_d = (double)i;
+    unsigned char *ptrData = mask[i];
 
     for (int j = j_min; j < j_max; j++) {
       double j_d = (double)j;
@@ -450,7 +474,7 @@ void vpMbtDistanceKltPoints::updateMask(
 #if defined(VISP_HAVE_CLIPPER)
       imPt.set_ij(i_d, j_d);
       if (polygon_test.isInside(imPt)) {
-        mask.ptr<uchar>(i)[j] = nb;
+        ptrData[j] = nb;
       }
 #else
       if (shiftBorder != 0) {
@@ -458,43 +482,59 @@ void vpMbtDistanceKltPoints::updateMask(
             vpPolygon::isInside(roi, i_d - shiftBorder_d, j_d + shiftBorder_d) &&
             vpPolygon::isInside(roi, i_d + shiftBorder_d, j_d - shiftBorder_d) &&
             vpPolygon::isInside(roi, i_d - shiftBorder_d, j_d - shiftBorder_d)) {
-          mask.at<unsigned char>(i, j) = nb;
+          ptrData[j] = nb;
         }
       } else {
         if (vpPolygon::isInside(roi, i, j)) {
-          mask.at<unsigned char>(i, j) = nb;
+          ptrData[j] = nb;
         }
       }
 #endif
     }
   }
-#else
-  unsigned char *ptrData = (unsigned char *)mask->imageData + i_min * mask->widthStep + j_min;
-  for (int i = i_min; i < i_max; i++) {
-    double i_d = (double)i;
-    for (int j = j_min; j < j_max; j++) {
-      double j_d = (double)j;
-      if (shiftBorder != 0) {
-        if (vpPolygon::isInside(roi, i_d, j_d) && vpPolygon::isInside(roi, i_d + shiftBorder_d, j_d + shiftBorder_d) &&
-            vpPolygon::isInside(roi, i_d - shiftBorder_d, j_d + shiftBorder_d) &&
-            vpPolygon::isInside(roi, i_d + shiftBorder_d, j_d - shiftBorder_d) &&
-            vpPolygon::isInside(roi, i_d - shiftBorder_d, j_d - shiftBorder_d)) {
-          *(ptrData++) = nb;
-        } else {
-          ptrData++;
-        }
-      } else {
-        if (vpPolygon::isInside(roi, i, j)) {
-          *(ptrData++) = nb;
-        } else {
-          ptrData++;
-        }
-      }
-    }
-    ptrData += mask->widthStep - j_max + j_min;
+}
+
+#if (VISP_HAVE_OPENCV_VERSION >= 0x020408)
+/*!
+  Modification of all the pixels that are in the roi to the value of _nb (
+  default is 255).
+
+  \param mask : the mask to update (0, not in the object, _nb otherwise).
+  \param nb : Optionnal value to set to the pixels included in the face.
+  \param shiftBorder : Optionnal shift for the border in pixel (sort of
+  built-in erosion) to avoid to consider pixels near the limits of the face.
+*/
+void vpMbtDistanceKltPoints::updateMask(cv::Mat &mask, unsigned char nb, unsigned int shiftBorder)
+{
+  if (mask.isContinuous()) {
+    // Work directly on the OpenCV buffer
+    vpImage<unsigned char> I_mask(mask.ptr<unsigned char>(0), (unsigned int)mask.rows, (unsigned int)mask.cols, false);
+    updateMask(I_mask, nb, shiftBorder);
+  } else {
+    vpImage<unsigned char> I_mask;
+    vpImageConvert::convert(mask, I_mask);
+    updateMask(I_mask, nb, shiftBorder);
+    cv::Mat(mask.rows, mask.cols, CV_8UC1, I_mask.bitmap).copyTo(mask);
   }
-#endif
 }
+#elif defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100)
+/*!
+  Modification of all the pixels that are in the roi to the value of _nb (
+  default is 255).
+
+  \param mask : the mask to update (0, not in the object, _nb otherwise).
+  \param nb : Optionnal value to set to the pixels included in the face.
+  \param shiftBorder : Optionnal shift for the border in pixel (sort of
+  built-in erosion) to avoid to consider pixels near the limits of the face.
+*/
+void vpMbtDistanceKltPoints::updateMask(IplImage *mask, unsigned char nb, unsigned int shiftBorder)
+{
+  vpImage<unsigned char> I_mask;
+  vpImageConvert::convert(mask, I_mask);
+  updateMask(I_mask, nb, shiftBorder);
+  vpImageConvert::convert(I_mask, mask);
+}
+#endif
 
 /*!
   This method removes the outliers. A point is considered as outlier when its
@@ -35,6 +35,8 @@
 
 #include <visp3/mbt/vpMbGenericTracker.h>
 
+#include <algorithm>
+
 #include <visp3/core/vpDisplay.h>
 #include <visp3/core/vpExponentialMap.h>
 #include <visp3/core/vpTrackingException.h>
@@ -52,7 +54,7 @@ vpMbGenericTracker::vpMbGenericTracker()
   // Add default ponderation between each feature type
   m_mapOfFeatureFactors[EDGE_TRACKER] = 1.0;
 
-#if defined(VISP_HAVE_MODULE_KLT) && (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
+#if defined(VISP_HAVE_MODULE_KLT)
   m_mapOfFeatureFactors[KLT_TRACKER] = 1.0;
 #endif
 
@@ -88,7 +90,7 @@ vpMbGenericTracker::vpMbGenericTracker(unsigned int nbCameras, int trackerType)
   // Add default ponderation between each feature type
   m_mapOfFeatureFactors[EDGE_TRACKER] = 1.0;
 
-#if defined(VISP_HAVE_MODULE_KLT) && (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
+#if defined(VISP_HAVE_MODULE_KLT)
   m_mapOfFeatureFactors[KLT_TRACKER] = 1.0;
 #endif
 
@@ -126,7 +128,7 @@ vpMbGenericTracker::vpMbGenericTracker(const std::vector<int> &trackerTypes)
   // Add default ponderation between each feature type
   m_mapOfFeatureFactors[EDGE_TRACKER] = 1.0;
 
-#if defined(VISP_HAVE_MODULE_KLT) && (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
+#if defined(VISP_HAVE_MODULE_KLT)
   m_mapOfFeatureFactors[KLT_TRACKER] = 1.0;
 #endif
 
@@ -157,7 +159,7 @@ vpMbGenericTracker::vpMbGenericTracker(const std::vector<std::string> &cameraNam
   // Add default ponderation between each feature type
   m_mapOfFeatureFactors[EDGE_TRACKER] = 1.0;
 
-#if defined(VISP_HAVE_MODULE_KLT) && (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
+#if defined(VISP_HAVE_MODULE_KLT)
   m_mapOfFeatureFactors[KLT_TRACKER] = 1.0;
 #endif
 
@@ -165,6 +167,30 @@ vpMbGenericTracker::vpMbGenericTracker(const std::vector<std::string> &cameraNam
   m_mapOfFeatureFactors[DEPTH_DENSE_TRACKER] = 1.0;
 }
 
+/*!
+  Copy constructor. The trackers of all the cameras are duplicated with their
+  model and their current tracking state, the model file is not parsed again.
+
+  \param tracker : Tracker to copy.
+
+  \note With Ogre visibility test, the Ogre context of the copy is initialized
+  at the next call to init() or initFromPose().
+*/
+vpMbGenericTracker::vpMbGenericTracker(const vpMbGenericTracker &tracker)
+  : vpMbTracker(tracker), m_error(tracker.m_error), m_L(tracker.m_L),
+    m_mapOfCameraTransformationMatrix(tracker.m_mapOfCameraTransformationMatrix),
+    m_mapOfFeatureFactors(tracker.m_mapOfFeatureFactors), m_mapOfTrackers(),
+    m_percentageGdPt(tracker.m_percentageGdPt), m_referenceCameraName(tracker.m_referenceCameraName),
+    m_thresholdOutlier(tracker.m_thresholdOutlier), m_w(tracker.m_w), m_weightedError(tracker.m_weightedError)
+{
+  copyProjectionErrorFeatures(tracker);
+
+  for (std::map<std::string, TrackerWrapper *>::const_iterator it = tracker.m_mapOfTrackers.begin();
+       it != tracker.m_mapOfTrackers.end(); ++it) {
+    m_mapOfTrackers[it->first] = new TrackerWrapper(*it->second);
+  }
+}
+
 vpMbGenericTracker::~vpMbGenericTracker()
 {
   for (std::map<std::string, TrackerWrapper *>::iterator it = m_mapOfTrackers.begin(); it != m_mapOfTrackers.end();
@@ -174,6 +200,55 @@ vpMbGenericTracker::~vpMbGenericTracker()
   }
 }
 
+/*!
+  Copy assignment operator. Restore the model and the tracking state of all
+  the cameras from \e tracker, the model file is not parsed again.
+
+  \param tracker : Tracker to copy.
+*/
+vpMbGenericTracker &vpMbGenericTracker::operator=(const vpMbGenericTracker &tracker)
+{
+  if (this == &tracker) {
+    return *this;
+  }
+
+  for (std::map<std::string, TrackerWrapper *>::iterator it = m_mapOfTrackers.begin(); it != m_mapOfTrackers.end();
+       ++it) {
+    delete it->second;
+  }
+  m_mapOfTrackers.clear();
+
+  for (size_t i = 0; i < m_projectionErrorLines.size(); i++) {
+    delete m_projectionErrorLines[i];
+  }
+  for (size_t i = 0; i < m_projectionErrorCylinders.size(); i++) {
+    delete m_projectionErrorCylinders[i];
+  }
+  for (size_t i = 0; i < m_projectionErrorCircles.size(); i++) {
+    delete m_projectionErrorCircles[i];
+  }
+
+  vpMbTracker::operator=(tracker);
+  copyProjectionErrorFeatures(tracker);
+
+  m_error = tracker.m_error;
+  m_L = tracker.m_L;
+  m_mapOfCameraTransformationMatrix = tracker.m_mapOfCameraTransformationMatrix;
+  m_mapOfFeatureFactors = tracker.m_mapOfFeatureFactors;
+  m_percentageGdPt = tracker.m_percentageGdPt;
+  m_referenceCameraName = tracker.m_referenceCameraName;
+  m_thresholdOutlier = tracker.m_thresholdOutlier;
+  m_w = tracker.m_w;
+  m_weightedError = tracker.m_weightedError;
+
+  for (std::map<std::string, TrackerWrapper *>::const_iterator it = tracker.m_mapOfTrackers.begin();
+       it != tracker.m_mapOfTrackers.end(); ++it) {
+    m_mapOfTrackers[it->first] = new TrackerWrapper(*it->second);
+  }
+
+  return *this;
+}
+
 /*!
   Compute projection error given an input image and camera pose, parameters.
   This projection error uses locations sampled exactly where the model is projected using the camera pose
@@ -307,7 +382,7 @@ void vpMbGenericTracker::computeVVS(std::map<std::string, const vpImage<unsigned
   }
 
   double factorEdge = m_mapOfFeatureFactors[EDGE_TRACKER];
-#if defined(VISP_HAVE_MODULE_KLT) && (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
+#if defined(VISP_HAVE_MODULE_KLT)
   double factorKlt = m_mapOfFeatureFactors[KLT_TRACKER];
 #endif
   double factorDepth = m_mapOfFeatureFactors[DEPTH_NORMAL_TRACKER];
@@ -325,7 +400,7 @@ void vpMbGenericTracker::computeVVS(std::map<std::string, const vpImage<unsigned
 
         tracker->m_cMo = m_mapOfCameraTransformationMatrix[it->first] * cMo_prev;
 
-#if defined(VISP_HAVE_MODULE_KLT) && (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
+#if defined(VISP_HAVE_MODULE_KLT)
         vpHomogeneousMatrix c_curr_tTc_curr0 =
             m_mapOfCameraTransformationMatrix[it->first] * cMo_prev * tracker->c0Mo.inverse();
         tracker->ctTc0 = c_curr_tTc_curr0;
@@ -399,7 +474,7 @@ void vpMbGenericTracker::computeVVS(std::map<std::string, const vpImage<unsigned
           start_index += tracker->m_error_edge.getRows();
         }
 
-#if defined(VISP_HAVE_MODULE_KLT) && (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
+#if defined(VISP_HAVE_MODULE_KLT)
         if (tracker->m_trackerType & KLT_TRACKER) {
           for (unsigned int i = 0; i < tracker->m_error_klt.getRows(); i++) {
             double wi = tracker->m_w_klt[i] * factorKlt;
@@ -462,7 +537,7 @@ void vpMbGenericTracker::computeVVS(std::map<std::string, const vpImage<unsigned
 
       m_cMo = vpExponentialMap::direct(v).inverse() * m_cMo;
 
-#if defined(VISP_HAVE_MODULE_KLT) && (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
+#if defined(VISP_HAVE_MODULE_KLT)
       for (std::map<std::string, TrackerWrapper *>::const_iterator it = m_mapOfTrackers.begin();
            it != m_mapOfTrackers.end(); ++it) {
         TrackerWrapper *tracker = it->second;
@@ -539,7 +614,7 @@ void vpMbGenericTracker::computeVVSInteractionMatrixAndResidu(
     TrackerWrapper *tracker = it->second;
 
     tracker->m_cMo = m_mapOfCameraTransformationMatrix[it->first] * m_cMo;
-#if defined(VISP_HAVE_MODULE_KLT) && (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
+#if defined(VISP_HAVE_MODULE_KLT)
     vpHomogeneousMatrix c_curr_tTc_curr0 = m_mapOfCameraTransformationMatrix[it->first] * m_cMo * tracker->c0Mo.inverse();
     tracker->ctTc0 = c_curr_tTc_curr0;
 #endif
@@ -903,7 +978,7 @@ vpMbHiddenFaces<vpMbtPolygon> &vpMbGenericTracker::getFaces(const std::string &c
   return faces;
 }
 
-#if defined(VISP_HAVE_MODULE_KLT) && (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
+#if defined(VISP_HAVE_MODULE_KLT)
 /*!
   Return the address of the circle feature list for the reference camera.
 */
@@ -1033,7 +1108,7 @@ void vpMbGenericTracker::getFeaturesForDisplay(std::map<std::string, std::vector
 */
 double vpMbGenericTracker::getGoodMovingEdgesRatioThreshold() const { return m_percentageGdPt; }
 
-#if defined(VISP_HAVE_MODULE_KLT) && (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
+#if defined(VISP_HAVE_MODULE_KLT)
 /*!
   Get the current list of KLT points for the reference camera.
 
@@ -1112,6 +1187,7 @@ int vpMbGenericTracker::getKltNbPoints() const
   return 0;
 }
 
+#if defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100)
 /*!
   Get the klt tracker at the current state for the reference camera.
 
@@ -1169,6 +1245,7 @@ void vpMbGenericTracker::getKltOpencv(std::map<std::string, vpKltOpencv> &mapOfK
     mapOfKlts[it->first] = tracker->getKltOpencv();
   }
 }
+#endif
 
 #if (VISP_HAVE_OPENCV_VERSION >= 0x020408)
 /*!
@@ -2865,6 +2942,73 @@ void vpMbGenericTracker::loadConfigFile(const std::map<std::string, std::string>
   }
 }
 
+/*!
+  Load a configuration parsed once by vpMbtXmlConfig, for all the cameras.
+  Contrary to loadConfigFile(const std::string &), no file is read, so that a
+  single configuration can be shared by many trackers.
+
+  \throw vpException::notInitialized if the configuration is empty.
+
+  \param config : Parsed configuration.
+*/
+void vpMbGenericTracker::loadConfigFile(const vpMbtXmlConfig &config)
+{
+  for (std::map<std::string, TrackerWrapper *>::const_iterator it = m_mapOfTrackers.begin();
+       it != m_mapOfTrackers.end(); ++it) {
+    TrackerWrapper *tracker = it->second;
+    tracker->loadConfigFile(config);
+  }
+
+  if (m_mapOfTrackers.find(m_referenceCameraName) == m_mapOfTrackers.end()) {
+    throw vpException(vpException::fatalError, "Cannot find the reference camera:  %s!", m_referenceCameraName.c_str());
+  }
+
+  m_mapOfTrackers[m_referenceCameraName]->getCameraParameters(m_cam);
+  this->angleAppears = m_mapOfTrackers[m_referenceCameraName]->getAngleAppear();
+  this->angleDisappears = m_mapOfTrackers[m_referenceCameraName]->getAngleDisappear();
+  this->clippingFlag = m_mapOfTrackers[m_referenceCameraName]->getClipping();
+}
+
+/*!
+  Load configurations parsed once by vpMbtXmlConfig.
+
+  \throw vpException::notInitialized if a configuration is empty.
+
+  \param mapOfConfigs : Map of parsed configurations.
+
+  \note Configurations must be supplied for all the cameras.
+*/
+void vpMbGenericTracker::loadConfigFile(const std::map<std::string, const vpMbtXmlConfig *> &mapOfConfigs)
+{
+  for (std::map<std::string, TrackerWrapper *>::const_iterator it_tracker = m_mapOfTrackers.begin();
+       it_tracker != m_mapOfTrackers.end(); ++it_tracker) {
+    TrackerWrapper *tracker = it_tracker->second;
+
+    std::map<std::string, const vpMbtXmlConfig *>::const_iterator it_config = mapOfConfigs.find(it_tracker->first);
+    if (it_config != mapOfConfigs.end() && it_config->second != NULL) {
+      tracker->loadConfigFile(*it_config->second);
+    } else {
+      throw vpException(vpTrackingException::initializationError, "Missing configuration for camera: %s!",
+                        it_tracker->first.c_str());
+    }
+  }
+
+  // Set the reference camera parameters
+  std::map<std::string, TrackerWrapper *>::iterator it = m_mapOfTrackers.find(m_referenceCameraName);
+  if (it != m_mapOfTrackers.end()) {
+    TrackerWrapper *tracker = it->second;
+    tracker->getCameraParameters(m_cam);
+
+    // Set clipping
+    this->clippingFlag = tracker->getClipping();
+    this->angleAppears = tracker->getAngleAppear();
+    this->angleDisappears = tracker->getAngleDisappear();
+  } else {
+    throw vpException(vpTrackingException::initializationError, "The reference camera: %s does not exist!",
+                      m_referenceCameraName.c_str());
+  }
+}
+
 /*!
   Load a 3D model from the file in parameter. This file must either be a vrml
   file (.wrl) or a CAO file (.cao). CAO format is described in the
@@ -3032,6 +3176,16 @@ void vpMbGenericTracker::preTracking(std::map<std::string, const vpImage<unsigne
   }
 }
 
+void vpMbGenericTracker::preTracking(std::map<std::string, const vpImage<unsigned char> *> &mapOfImages,
+                                     std::map<std::string, const vpPointCloud *> &mapOfPointClouds)
+{
+  for (std::map<std::string, TrackerWrapper *>::const_iterator it = m_mapOfTrackers.begin();
+       it != m_mapOfTrackers.end(); ++it) {
+    TrackerWrapper *tracker = it->second;
+    tracker->preTracking(mapOfImages[it->first], mapOfPointClouds[it->first]);
+  }
+}
+
 /*!
   Re-initialize the model used by the tracker.
 
@@ -3379,7 +3533,7 @@ void vpMbGenericTracker::resetTracker()
   // Reset default ponderation between each feature type
   m_mapOfFeatureFactors[EDGE_TRACKER] = 1.0;
 
-#if defined(VISP_HAVE_MODULE_KLT) && (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
+#if defined(VISP_HAVE_MODULE_KLT)
   m_mapOfFeatureFactors[KLT_TRACKER] = 1.0;
 #endif
 
@@ -4105,7 +4259,42 @@ void vpMbGenericTracker::setNbRayCastingAttemptsForVisibility(const unsigned int
 }
 #endif
 
-#if defined(VISP_HAVE_MODULE_KLT) && (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
+#if defined(VISP_HAVE_MODULE_KLT)
+/*!
+  Select the KLT implementation used by all the cameras to detect and track
+  the points. The tracker has to be initialized again after a change of
+  implementation.
+
+  \param type : vpMbKltTracker::KLT_OPENCV to use vpKltOpencv,
+  vpMbKltTracker::KLT_NATIVE to use vpKltNative.
+
+  \exception vpException::badValue : If vpMbKltTracker::KLT_OPENCV is
+  requested while ViSP is not built with OpenCV.
+*/
+void vpMbGenericTracker::setKltImplementation(const vpMbKltTracker::vpKltImplementationType &type)
+{
+  for (std::map<std::string, TrackerWrapper *>::const_iterator it = m_mapOfTrackers.begin();
+       it != m_mapOfTrackers.end(); ++it) {
+    TrackerWrapper *tracker = it->second;
+    tracker->setKltImplementation(type);
+  }
+}
+
+/*!
+  Set the new value of the native klt tracker for all the cameras.
+
+  \param t : Klt tracker containing the new values.
+*/
+void vpMbGenericTracker::setKltNative(const vpKltNative &t)
+{
+  for (std::map<std::string, TrackerWrapper *>::const_iterator it = m_mapOfTrackers.begin();
+       it != m_mapOfTrackers.end(); ++it) {
+    TrackerWrapper *tracker = it->second;
+    tracker->setKltNative(t);
+  }
+}
+
+#if defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100)
 /*!
   Set the new value of the klt tracker.
 
@@ -4160,6 +4349,7 @@ void vpMbGenericTracker::setKltOpencv(const std::map<std::string, vpKltOpencv> &
     }
   }
 }
+#endif
 
 /*!
   Set the threshold for the acceptation of a point.
@@ -4201,7 +4391,7 @@ void vpMbGenericTracker::setLod(bool useLod, const std::string &name)
   }
 }
 
-#if defined(VISP_HAVE_MODULE_KLT) && (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
+#if defined(VISP_HAVE_MODULE_KLT)
 /*!
   Set the erosion of the mask used on the Model faces.
 
@@ -4316,6 +4506,49 @@ void vpMbGenericTracker::setMinPolygonAreaThresh(double minPolygonAreaThresh, co
   }
 }
 
+/*!
+  Set the directory where the compiled models are stored when the compiled
+  model cache is enabled.
+
+  \param directory : Directory of the compiled model cache.
+
+  \sa vpMbTracker::setModelCacheDirectory()
+
+  \note This function will set the new parameter for all the cameras.
+*/
+void vpMbGenericTracker::setModelCacheDirectory(const std::string &directory)
+{
+  vpMbTracker::setModelCacheDirectory(directory);
+
+  for (std::map<std::string, TrackerWrapper *>::const_iterator it = m_mapOfTrackers.begin();
+       it != m_mapOfTrackers.end(); ++it) {
+    TrackerWrapper *tracker = it->second;
+    tracker->setModelCacheDirectory(directory);
+  }
+}
+
+/*!
+  Enable or disable the compiled model cache used by loadModel() for CAO
+  models. When several cameras use the same model, the model is compiled by
+  the first camera and loaded from the compiled model by the others.
+
+  \param enable : True to use the compiled model cache.
+
+  \sa vpMbTracker::setModelCacheEnabled()
+
+  \note This function will set the new parameter for all the cameras.
+*/
+void vpMbGenericTracker::setModelCacheEnabled(bool enable)
+{
+  vpMbTracker::setModelCacheEnabled(enable);
+
+  for (std::map<std::string, TrackerWrapper *>::const_iterator it = m_mapOfTrackers.begin();
+       it != m_mapOfTrackers.end(); ++it) {
+    TrackerWrapper *tracker = it->second;
+    tracker->setModelCacheEnabled(enable);
+  }
+}
+
 /*!
   Set the moving edge parameters.
 
@@ -4969,7 +5202,7 @@ void vpMbGenericTracker::setUseEdgeTracking(const std::string &name, const bool
   }
 }
 
-#if defined(VISP_HAVE_MODULE_KLT) && (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
+#if defined(VISP_HAVE_MODULE_KLT)
 /*!
   Set if the polygon that has the given name has to be considered during
   the tracking phase.
@@ -5161,7 +5394,7 @@ void vpMbGenericTracker::track(std::map<std::string, const vpImage<unsigned char
     TrackerWrapper *tracker = it->second;
 
     if ((tracker->m_trackerType & (EDGE_TRACKER |
-#if defined(VISP_HAVE_MODULE_KLT) && (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
+#if defined(VISP_HAVE_MODULE_KLT)
                                    KLT_TRACKER |
 #endif
                                    DEPTH_NORMAL_TRACKER | DEPTH_DENSE_TRACKER)) == 0) {
@@ -5169,7 +5402,7 @@ void vpMbGenericTracker::track(std::map<std::string, const vpImage<unsigned char
     }
 
     if (tracker->m_trackerType & (EDGE_TRACKER
-#if defined(VISP_HAVE_MODULE_KLT) && (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
+#if defined(VISP_HAVE_MODULE_KLT)
                                   | KLT_TRACKER
 #endif
                                   ) &&
@@ -5205,7 +5438,7 @@ void vpMbGenericTracker::track(std::map<std::string, const vpImage<unsigned char
     tracker->postTracking(mapOfImages[it->first], mapOfPointClouds[it->first]);
 
     if (displayFeatures) {
-#if defined(VISP_HAVE_MODULE_KLT) && (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
+#if defined(VISP_HAVE_MODULE_KLT)
       if (tracker->m_trackerType & KLT_TRACKER) {
         tracker->m_featuresToBeDisplayedKlt = tracker->getFeaturesForDisplayKlt();
       }
@@ -5237,7 +5470,7 @@ void vpMbGenericTracker::track(std::map<std::string, const vpImage<vpRGBa> *> &m
     TrackerWrapper *tracker = it->second;
 
     if ((tracker->m_trackerType & (EDGE_TRACKER |
-#if defined(VISP_HAVE_MODULE_KLT) && (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
+#if defined(VISP_HAVE_MODULE_KLT)
                                    KLT_TRACKER |
 #endif
                                    DEPTH_NORMAL_TRACKER | DEPTH_DENSE_TRACKER)) == 0) {
@@ -5245,13 +5478,13 @@ void vpMbGenericTracker::track(std::map<std::string, const vpImage<vpRGBa> *> &m
     }
 
     if (tracker->m_trackerType & (EDGE_TRACKER
-#if defined(VISP_HAVE_MODULE_KLT) && (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
+#if defined(VISP_HAVE_MODULE_KLT)
                                   | KLT_TRACKER
 #endif
                                   ) && mapOfImages[it->first] == NULL) {
       throw vpException(vpException::fatalError, "Image pointer is NULL!");
     } else if (tracker->m_trackerType & (EDGE_TRACKER
-#if defined(VISP_HAVE_MODULE_KLT) && (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
+#if defined(VISP_HAVE_MODULE_KLT)
                                   | KLT_TRACKER
 #endif
                                   ) && mapOfImages[it->first] != NULL) {
@@ -5287,7 +5520,7 @@ void vpMbGenericTracker::track(std::map<std::string, const vpImage<vpRGBa> *> &m
     tracker->postTracking(mapOfImages[it->first], mapOfPointClouds[it->first]);
 
     if (displayFeatures) {
-#if defined(VISP_HAVE_MODULE_KLT) && (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
+#if defined(VISP_HAVE_MODULE_KLT)
       if (tracker->m_trackerType & KLT_TRACKER) {
         tracker->m_featuresToBeDisplayedKlt = tracker->getFeaturesForDisplayKlt();
       }
@@ -5323,7 +5556,7 @@ void vpMbGenericTracker::track(std::map<std::string, const vpImage<unsigned char
     TrackerWrapper *tracker = it->second;
 
     if ((tracker->m_trackerType & (EDGE_TRACKER |
-#if defined(VISP_HAVE_MODULE_KLT) && (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
+#if defined(VISP_HAVE_MODULE_KLT)
                                    KLT_TRACKER |
 #endif
                                    DEPTH_NORMAL_TRACKER | DEPTH_DENSE_TRACKER)) == 0) {
@@ -5331,7 +5564,7 @@ void vpMbGenericTracker::track(std::map<std::string, const vpImage<unsigned char
     }
 
     if (tracker->m_trackerType & (EDGE_TRACKER
-#if defined(VISP_HAVE_MODULE_KLT) && (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
+#if defined(VISP_HAVE_MODULE_KLT)
                                   | KLT_TRACKER
 #endif
                                   ) &&
@@ -5367,7 +5600,84 @@ void vpMbGenericTracker::track(std::map<std::string, const vpImage<unsigned char
     tracker->postTracking(mapOfImages[it->first], mapOfPointCloudWidths[it->first], mapOfPointCloudHeights[it->first]);
 
     if (displayFeatures) {
-#if defined(VISP_HAVE_MODULE_KLT) && (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
+#if defined(VISP_HAVE_MODULE_KLT)
+      if (tracker->m_trackerType & KLT_TRACKER) {
+        tracker->m_featuresToBeDisplayedKlt = tracker->getFeaturesForDisplayKlt();
+      }
+#endif
+
+      if (tracker->m_trackerType & DEPTH_NORMAL_TRACKER) {
+        tracker->m_featuresToBeDisplayedDepthNormal = tracker->getFeaturesForDisplayDepthNormal();
+      }
+    }
+  }
+
+  computeProjectionError();
+}
+
+/*!
+  Realize the tracking of the object in the image.
+
+  \throw vpException : if the tracking is supposed to have failed
+
+  \param mapOfImages : Map of images.
+  \param mapOfPointClouds : Map of organized pointclouds.
+*/
+void vpMbGenericTracker::track(std::map<std::string, const vpImage<unsigned char> *> &mapOfImages,
+                               std::map<std::string, const vpPointCloud *> &mapOfPointClouds)
+{
+  for (std::map<std::string, TrackerWrapper *>::const_iterator it = m_mapOfTrackers.begin();
+       it != m_mapOfTrackers.end(); ++it) {
+    TrackerWrapper *tracker = it->second;
+
+    if ((tracker->m_trackerType & (EDGE_TRACKER |
+#if defined(VISP_HAVE_MODULE_KLT)
+                                   KLT_TRACKER |
+#endif
+                                   DEPTH_NORMAL_TRACKER | DEPTH_DENSE_TRACKER)) == 0) {
+      throw vpException(vpException::fatalError, "Bad tracker type: %d", tracker->m_trackerType);
+    }
+
+    if (tracker->m_trackerType & (EDGE_TRACKER
+#if defined(VISP_HAVE_MODULE_KLT)
+                                  | KLT_TRACKER
+#endif
+                                  ) &&
+        mapOfImages[it->first] == NULL) {
+      throw vpException(vpException::fatalError, "Image pointer is NULL!");
+    }
+
+    if (tracker->m_trackerType & (DEPTH_NORMAL_TRACKER | DEPTH_DENSE_TRACKER) &&
+        (mapOfPointClouds[it->first] == NULL)) {
+      throw vpException(vpException::fatalError, "Pointcloud is NULL!");
+    }
+  }
+
+  preTracking(mapOfImages, mapOfPointClouds);
+
+  try {
+    computeVVS(mapOfImages);
+  } catch (...) {
+    covarianceMatrix = -1;
+    throw; // throw the original exception
+  }
+
+  testTracking();
+
+  for (std::map<std::string, TrackerWrapper *>::const_iterator it = m_mapOfTrackers.begin();
+       it != m_mapOfTrackers.end(); ++it) {
+    TrackerWrapper *tracker = it->second;
+
+    if (tracker->m_trackerType & EDGE_TRACKER && displayFeatures) {
+      tracker->m_featuresToBeDisplayedEdge = tracker->getFeaturesForDisplayEdge();
+    }
+
+    const vpPointCloud *point_cloud = mapOfPointClouds[it->first];
+    tracker->postTracking(mapOfImages[it->first], point_cloud != NULL ? point_cloud->getWidth() : 0,
+                          point_cloud != NULL ? point_cloud->getHeight() : 0);
+
+    if (displayFeatures) {
+#if defined(VISP_HAVE_MODULE_KLT)
       if (tracker->m_trackerType & KLT_TRACKER) {
         tracker->m_featuresToBeDisplayedKlt = tracker->getFeaturesForDisplayKlt();
       }
@@ -5403,7 +5713,7 @@ void vpMbGenericTracker::track(std::map<std::string, const vpImage<vpRGBa> *> &m
     TrackerWrapper *tracker = it->second;
 
     if ((tracker->m_trackerType & (EDGE_TRACKER |
-#if defined(VISP_HAVE_MODULE_KLT) && (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
+#if defined(VISP_HAVE_MODULE_KLT)
                                    KLT_TRACKER |
 #endif
                                    DEPTH_NORMAL_TRACKER | DEPTH_DENSE_TRACKER)) == 0) {
@@ -5411,13 +5721,13 @@ void vpMbGenericTracker::track(std::map<std::string, const vpImage<vpRGBa> *> &m
     }
 
     if (tracker->m_trackerType & (EDGE_TRACKER
-#if defined(VISP_HAVE_MODULE_KLT) && (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
+#if defined(VISP_HAVE_MODULE_KLT)
                                   | KLT_TRACKER
 #endif
                                   ) && mapOfColorImages[it->first] == NULL) {
       throw vpException(vpException::fatalError, "Image pointer is NULL!");
     } else if (tracker->m_trackerType & (EDGE_TRACKER
-#if defined(VISP_HAVE_MODULE_KLT) && (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
+#if defined(VISP_HAVE_MODULE_KLT)
                                   | KLT_TRACKER
 #endif
                                   ) && mapOfColorImages[it->first] != NULL) {
@@ -5453,7 +5763,7 @@ void vpMbGenericTracker::track(std::map<std::string, const vpImage<vpRGBa> *> &m
     tracker->postTracking(mapOfImages[it->first], mapOfPointCloudWidths[it->first], mapOfPointCloudHeights[it->first]);
 
     if (displayFeatures) {
-#if defined(VISP_HAVE_MODULE_KLT) && (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
+#if defined(VISP_HAVE_MODULE_KLT)
       if (tracker->m_trackerType & KLT_TRACKER) {
         tracker->m_featuresToBeDisplayedKlt = tracker->getFeaturesForDisplayKlt();
       }
@@ -5468,6 +5778,39 @@ void vpMbGenericTracker::track(std::map<std::string, const vpImage<vpRGBa> *> &m
   computeProjectionError();
 }
 
+/*!
+  Realize the tracking of the object in the image.
+
+  \throw vpException : if the tracking is supposed to have failed
+
+  \param mapOfColorImages : Map of images.
+  \param mapOfPointClouds : Map of organized pointclouds.
+*/
+void vpMbGenericTracker::track(std::map<std::string, const vpImage<vpRGBa> *> &mapOfColorImages,
+                               std::map<std::string, const vpPointCloud *> &mapOfPointClouds)
+{
+  std::map<std::string, const vpImage<unsigned char> *> mapOfImages;
+  for (std::map<std::string, TrackerWrapper *>::const_iterator it = m_mapOfTrackers.begin();
+       it != m_mapOfTrackers.end(); ++it) {
+    TrackerWrapper *tracker = it->second;
+
+    if (tracker->m_trackerType & (EDGE_TRACKER
+#if defined(VISP_HAVE_MODULE_KLT)
+                                  | KLT_TRACKER
+#endif
+                                  )) {
+      if (mapOfColorImages[it->first] == NULL) {
+        throw vpException(vpException::fatalError, "Image pointer is NULL!");
+      }
+
+      vpImageConvert::convert(*mapOfColorImages[it->first], tracker->m_I);
+      mapOfImages[it->first] = &tracker->m_I; // update grayscale image buffer
+    }
+  }
+
+  track(mapOfImages, mapOfPointClouds);
+}
+
 /** TrackerWrapper **/
 vpMbGenericTracker::TrackerWrapper::TrackerWrapper()
   : m_error(), m_L(), m_trackerType(EDGE_TRACKER), m_w(), m_weightedError()
@@ -5486,7 +5829,7 @@ vpMbGenericTracker::TrackerWrapper::TrackerWrapper(int trackerType)
   : m_error(), m_L(), m_trackerType(trackerType), m_w(), m_weightedError()
 {
   if ((m_trackerType & (EDGE_TRACKER |
-#if defined(VISP_HAVE_MODULE_KLT) && (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
+#if defined(VISP_HAVE_MODULE_KLT)
                         KLT_TRACKER |
 #endif
                         DEPTH_NORMAL_TRACKER | DEPTH_DENSE_TRACKER)) == 0) {
@@ -5503,6 +5846,122 @@ vpMbGenericTracker::TrackerWrapper::TrackerWrapper(int trackerType)
 #endif
 }
 
+vpMbGenericTracker::TrackerWrapper::TrackerWrapper(const TrackerWrapper &tracker)
+  : vpMbTracker(tracker), vpMbEdgeTracker(tracker),
+#if defined(VISP_HAVE_MODULE_KLT)
+    vpMbKltTracker(tracker),
+#endif
+    vpMbDepthNormalTracker(tracker), vpMbDepthDenseTracker(tracker), m_error(tracker.m_error), m_L(tracker.m_L),
+    m_trackerType(tracker.m_trackerType), m_w(tracker.m_w), m_weightedError(tracker.m_weightedError)
+{
+  // The member-wise copies of the base classes still share the features with
+  // tracker: duplicate them and bind them to the faces and moving edge
+  // parameters of this tracker
+  copyProjectionErrorFeatures(tracker);
+
+  std::map<const vpMbtPolygon *, vpMbtPolygon *> mapOfPolygons;
+  for (unsigned int i = 0; i < tracker.faces.size(); i++) {
+    mapOfPolygons[tracker.faces[i]] = faces[i];
+  }
+
+  Ipyramid.clear();
+  for (unsigned int i = 0; i < lines.size(); i++) {
+    lines[i].clear();
+    for (std::list<vpMbtDistanceLine *>::const_iterator it = tracker.lines[i].begin(); it != tracker.lines[i].end();
+         ++it) {
+      vpMbtDistanceLine *l = new vpMbtDistanceLine(**it);
+      l->setMe(&me);
+      l->hiddenface = &faces;
+      lines[i].push_back(l);
+    }
+
+    cylinders[i].clear();
+    for (std::list<vpMbtDistanceCylinder *>::const_iterator it = tracker.cylinders[i].begin();
+         it != tracker.cylinders[i].end(); ++it) {
+      vpMbtDistanceCylinder *cy = new vpMbtDistanceCylinder(**it);
+      cy->setMovingEdge(&me);
+      cy->hiddenface = &faces;
+      cylinders[i].push_back(cy);
+    }
+
+    circles[i].clear();
+    for (std::list<vpMbtDistanceCircle *>::const_iterator it = tracker.circles[i].begin();
+         it != tracker.circles[i].end(); ++it) {
+      vpMbtDistanceCircle *ci = new vpMbtDistanceCircle(**it);
+      ci->setMovingEdge(&me);
+      ci->hiddenface = &faces;
+      circles[i].push_back(ci);
+    }
+  }
+
+#if defined(VISP_HAVE_MODULE_KLT)
+#if (VISP_HAVE_OPENCV_VERSION >= 0x020408)
+  cur = tracker.cur.clone();
+#elif defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100)
+  cur = (tracker.cur != NULL) ? cvCloneImage(tracker.cur) : NULL;
+#endif
+
+  kltPolygons.clear();
+  for (std::list<vpMbtDistanceKltPoints *>::const_iterator it = tracker.kltPolygons.begin();
+       it != tracker.kltPolygons.end(); ++it) {
+    vpMbtDistanceKltPoints *kltpoly = new vpMbtDistanceKltPoints(**it);
+    kltpoly->polygon = mapOfPolygons[kltpoly->polygon];
+    kltpoly->hiddenface = &faces;
+    kltPolygons.push_back(kltpoly);
+  }
+
+  kltCylinders.clear();
+  for (std::list<vpMbtDistanceKltCylinder *>::const_iterator it = tracker.kltCylinders.begin();
+       it != tracker.kltCylinders.end(); ++it) {
+    vpMbtDistanceKltCylinder *kltPolyCylinder = new vpMbtDistanceKltCylinder(**it);
+    kltPolyCylinder->hiddenface = &faces;
+    kltCylinders.push_back(kltPolyCylinder);
+  }
+
+  circles_disp.clear();
+  for (std::list<vpMbtDistanceCircle *>::const_iterator it = tracker.circles_disp.begin();
+       it != tracker.circles_disp.end(); ++it) {
+    vpMbtDistanceCircle *ci = new vpMbtDistanceCircle(**it);
+    ci->hiddenface = &faces;
+    circles_disp.push_back(ci);
+  }
+#endif
+
+  m_depthNormalFaces.clear();
+  for (size_t i = 0; i < tracker.m_depthNormalFaces.size(); i++) {
+    vpMbtFaceDepthNormal *normal_face = new vpMbtFaceDepthNormal(*tracker.m_depthNormalFaces[i]);
+    normal_face->m_hiddenFace = &faces;
+    normal_face->m_polygon = mapOfPolygons[normal_face->m_polygon];
+    normal_face->setLinesHiddenFaces(&m_depthNormalHiddenFacesDisplay);
+    m_depthNormalFaces.push_back(normal_face);
+  }
+
+  m_depthNormalListOfActiveFaces.clear();
+  for (size_t i = 0; i < tracker.m_depthNormalListOfActiveFaces.size(); i++) {
+    size_t index = (size_t)(std::find(tracker.m_depthNormalFaces.begin(), tracker.m_depthNormalFaces.end(),
+                                      tracker.m_depthNormalListOfActiveFaces[i]) -
+                            tracker.m_depthNormalFaces.begin());
+    m_depthNormalListOfActiveFaces.push_back(m_depthNormalFaces[index]);
+  }
+
+  m_depthDenseFaces.clear();
+  for (size_t i = 0; i < tracker.m_depthDenseFaces.size(); i++) {
+    vpMbtFaceDepthDense *dense_face = new vpMbtFaceDepthDense(*tracker.m_depthDenseFaces[i]);
+    dense_face->m_hiddenFace = &faces;
+    dense_face->m_polygon = mapOfPolygons[dense_face->m_polygon];
+    dense_face->setLinesHiddenFaces(&m_depthDenseHiddenFacesDisplay);
+    m_depthDenseFaces.push_back(dense_face);
+  }
+
+  m_depthDenseListOfActiveFaces.clear();
+  for (size_t i = 0; i < tracker.m_depthDenseListOfActiveFaces.size(); i++) {
+    size_t index = (size_t)(std::find(tracker.m_depthDenseFaces.begin(), tracker.m_depthDenseFaces.end(),
+                                      tracker.m_depthDenseListOfActiveFaces[i]) -
+                            tracker.m_depthDenseFaces.begin());
+    m_depthDenseListOfActiveFaces.push_back(m_depthDenseFaces[index]);
+  }
+}
+
 vpMbGenericTracker::TrackerWrapper::~TrackerWrapper() { }
 
 // Implemented only for debugging purposes: use TrackerWrapper as a standalone tracker
@@ -5519,7 +5978,7 @@ void vpMbGenericTracker::TrackerWrapper::computeVVS(const vpImage<unsigned char>
   unsigned int iter = 0;
 
   double factorEdge = 1.0;
-#if defined(VISP_HAVE_MODULE_KLT) && (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
+#if defined(VISP_HAVE_MODULE_KLT)
   double factorKlt = 1.0;
 #endif
   double factorDepth = 1.0;
@@ -5531,7 +5990,7 @@ void vpMbGenericTracker::TrackerWrapper::computeVVS(const vpImage<unsigned char>
 
   double mu = m_initialMu;
   vpHomogeneousMatrix cMo_prev;
-#if defined(VISP_HAVE_MODULE_KLT) && (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
+#if defined(VISP_HAVE_MODULE_KLT)
   vpHomogeneousMatrix ctTc0_Prev; // Only for KLT
 #endif
   bool isoJoIdentity_ = true;
@@ -5541,7 +6000,7 @@ void vpMbGenericTracker::TrackerWrapper::computeVVS(const vpImage<unsigned char>
   vpMatrix L_true, LVJ_true;
 
   unsigned int nb_edge_features = m_error_edge.getRows();
-#if defined(VISP_HAVE_MODULE_KLT) && (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
+#if defined(VISP_HAVE_MODULE_KLT)
   unsigned int nb_klt_features = m_error_klt.getRows();
 #endif
   unsigned int nb_depth_features = m_error_depthNormal.getRows();
@@ -5553,7 +6012,7 @@ void vpMbGenericTracker::TrackerWrapper::computeVVS(const vpImage<unsigned char>
     bool reStartFromLastIncrement = false;
     computeVVSCheckLevenbergMarquardt(iter, m_error, error_prev, cMo_prev, mu, reStartFromLastIncrement);
 
-#if defined(VISP_HAVE_MODULE_KLT) && (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
+#if defined(VISP_HAVE_MODULE_KLT)
     if (reStartFromLastIncrement) {
       if (m_trackerType & KLT_TRACKER) {
         ctTc0 = ctTc0_Prev;
@@ -5623,7 +6082,7 @@ void vpMbGenericTracker::TrackerWrapper::computeVVS(const vpImage<unsigned char>
         start_index += nb_edge_features;
       }
 
-#if defined(VISP_HAVE_MODULE_KLT) && (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
+#if defined(VISP_HAVE_MODULE_KLT)
       if (m_trackerType & KLT_TRACKER) {
         for (unsigned int i = 0; i < nb_klt_features; i++) {
           double wi = m_w_klt[i] * factorKlt;
@@ -5679,7 +6138,7 @@ void vpMbGenericTracker::TrackerWrapper::computeVVS(const vpImage<unsigned char>
       computeVVSPoseEstimation(isoJoIdentity_, iter, m_L, LTL, m_weightedError, m_error, error_prev, LTR, mu, v);
 
       cMo_prev = m_cMo;
-#if defined(VISP_HAVE_MODULE_KLT) && (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
+#if defined(VISP_HAVE_MODULE_KLT)
       if (m_trackerType & KLT_TRACKER) {
         ctTc0_Prev = ctTc0;
       }
@@ -5687,7 +6146,7 @@ void vpMbGenericTracker::TrackerWrapper::computeVVS(const vpImage<unsigned char>
 
       m_cMo = vpExponentialMap::direct(v).inverse() * m_cMo;
 
-#if defined(VISP_HAVE_MODULE_KLT) && (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
+#if defined(VISP_HAVE_MODULE_KLT)
       if (m_trackerType & KLT_TRACKER) {
         ctTc0 = vpExponentialMap::direct(v).inverse() * ctTc0;
       }
@@ -5729,7 +6188,7 @@ void vpMbGenericTracker::TrackerWrapper::computeVVSInit(const vpImage<unsigned c
     m_w_edge.clear();
   }
 
-#if defined(VISP_HAVE_MODULE_KLT) && (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
+#if defined(VISP_HAVE_MODULE_KLT)
   if (m_trackerType & KLT_TRACKER) {
     vpMbKltTracker::computeVVSInit();
     nbFeatures += m_error_klt.getRows();
@@ -5783,7 +6242,7 @@ void vpMbGenericTracker::TrackerWrapper::computeVVSInteractionMatrixAndResidu(co
     vpMbEdgeTracker::computeVVSInteractionMatrixAndResidu(*ptr_I);
   }
 
-#if defined(VISP_HAVE_MODULE_KLT) && (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
+#if defined(VISP_HAVE_MODULE_KLT)
   if (m_trackerType & KLT_TRACKER) {
     vpMbKltTracker::computeVVSInteractionMatrixAndResidu();
   }
@@ -5805,7 +6264,7 @@ void vpMbGenericTracker::TrackerWrapper::computeVVSInteractionMatrixAndResidu(co
     start_index += m_error_edge.getRows();
   }
 
-#if defined(VISP_HAVE_MODULE_KLT) && (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
+#if defined(VISP_HAVE_MODULE_KLT)
   if (m_trackerType & KLT_TRACKER) {
     m_L.insert(m_L_klt, start_index, 0);
     m_error.insert(start_index, m_error_klt);
@@ -5840,7 +6299,7 @@ void vpMbGenericTracker::TrackerWrapper::computeVVSWeights()
     start_index += m_w_edge.getRows();
   }
 
-#if defined(VISP_HAVE_MODULE_KLT) && (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
+#if defined(VISP_HAVE_MODULE_KLT)
   if (m_trackerType & KLT_TRACKER) {
     vpMbTracker::computeVVSWeights(m_robust_klt, m_error_klt, m_w_klt);
     m_w.insert(start_index, m_w_klt);
@@ -5936,7 +6395,7 @@ void vpMbGenericTracker::TrackerWrapper::display(const vpImage<unsigned char> &I
 
 #ifdef VISP_HAVE_OGRE
   if ((m_trackerType & EDGE_TRACKER)
-    #if defined(VISP_HAVE_MODULE_KLT) && (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
+    #if defined(VISP_HAVE_MODULE_KLT)
       || (m_trackerType & KLT_TRACKER)
     #endif
       ) {
@@ -6016,7 +6475,7 @@ void vpMbGenericTracker::TrackerWrapper::display(const vpImage<vpRGBa> &I, const
 
 #ifdef VISP_HAVE_OGRE
   if ((m_trackerType & EDGE_TRACKER)
-    #if defined(VISP_HAVE_MODULE_KLT) && (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
+    #if defined(VISP_HAVE_MODULE_KLT)
       || (m_trackerType & KLT_TRACKER)
     #endif
       ) {
@@ -6035,7 +6494,7 @@ std::vector<std::vector<double> > vpMbGenericTracker::TrackerWrapper::getFeature
     features.insert(features.end(), m_featuresToBeDisplayedEdge.begin(), m_featuresToBeDisplayedEdge.end());
   }
 
-#if defined(VISP_HAVE_MODULE_KLT) && (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
+#if defined(VISP_HAVE_MODULE_KLT)
   if (m_trackerType & KLT_TRACKER) {
     //m_featuresToBeDisplayedKlt updated after postTracking()
     features.insert(features.end(), m_featuresToBeDisplayedKlt.begin(), m_featuresToBeDisplayedKlt.end());
@@ -6061,7 +6520,7 @@ std::vector<std::vector<double> > vpMbGenericTracker::TrackerWrapper::getModelFo
   if (m_trackerType == EDGE_TRACKER) {
     models = vpMbEdgeTracker::getModelForDisplay(width, height, cMo, cam, displayFullModel);
   }
-#if defined(VISP_HAVE_MODULE_KLT) && (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
+#if defined(VISP_HAVE_MODULE_KLT)
   else if (m_trackerType == KLT_TRACKER) {
     models = vpMbKltTracker::getModelForDisplay(width, height, cMo, cam, displayFullModel);
   }
@@ -6123,7 +6582,7 @@ void vpMbGenericTracker::TrackerWrapper::init(const vpImage<unsigned char> &I)
     faces.computeScanLineRender(m_cam, I.getWidth(), I.getHeight());
   }
 
-#if defined(VISP_HAVE_MODULE_KLT) && (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
+#if defined(VISP_HAVE_MODULE_KLT)
   if (m_trackerType & KLT_TRACKER)
     vpMbKltTracker::reinit(I);
 #endif
@@ -6150,7 +6609,7 @@ void vpMbGenericTracker::TrackerWrapper::initCircle(const vpPoint &p1, const vpP
   if (m_trackerType & EDGE_TRACKER)
     vpMbEdgeTracker::initCircle(p1, p2, p3, radius, idFace, name);
 
-#if defined(VISP_HAVE_MODULE_KLT) && (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
+#if defined(VISP_HAVE_MODULE_KLT)
   if (m_trackerType & KLT_TRACKER)
     vpMbKltTracker::initCircle(p1, p2, p3, radius, idFace, name);
 #endif
@@ -6162,7 +6621,7 @@ void vpMbGenericTracker::TrackerWrapper::initCylinder(const vpPoint &p1, const v
   if (m_trackerType & EDGE_TRACKER)
     vpMbEdgeTracker::initCylinder(p1, p2, radius, idFace, name);
 
-#if defined(VISP_HAVE_MODULE_KLT) && (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
+#if defined(VISP_HAVE_MODULE_KLT)
   if (m_trackerType & KLT_TRACKER)
     vpMbKltTracker::initCylinder(p1, p2, radius, idFace, name);
 #endif
@@ -6173,7 +6632,7 @@ void vpMbGenericTracker::TrackerWrapper::initFaceFromCorners(vpMbtPolygon &polyg
   if (m_trackerType & EDGE_TRACKER)
     vpMbEdgeTracker::initFaceFromCorners(polygon);
 
-#if defined(VISP_HAVE_MODULE_KLT) && (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
+#if defined(VISP_HAVE_MODULE_KLT)
   if (m_trackerType & KLT_TRACKER)
     vpMbKltTracker::initFaceFromCorners(polygon);
 #endif
@@ -6190,7 +6649,7 @@ void vpMbGenericTracker::TrackerWrapper::initFaceFromLines(vpMbtPolygon &polygon
   if (m_trackerType & EDGE_TRACKER)
     vpMbEdgeTracker::initFaceFromLines(polygon);
 
-#if defined(VISP_HAVE_MODULE_KLT) && (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
+#if defined(VISP_HAVE_MODULE_KLT)
   if (m_trackerType & KLT_TRACKER)
     vpMbKltTracker::initFaceFromLines(polygon);
 #endif
@@ -6211,9 +6670,19 @@ void vpMbGenericTracker::TrackerWrapper::initMbtTracking(const vpImage<unsigned
 }
 
 void vpMbGenericTracker::TrackerWrapper::loadConfigFile(const std::string &configFile)
+{
+  loadConfig(configFile, NULL);
+}
+
+void vpMbGenericTracker::TrackerWrapper::loadConfigFile(const vpMbtXmlConfig &config)
+{
+  loadConfig("", &config);
+}
+
+void vpMbGenericTracker::TrackerWrapper::loadConfig(const std::string &configFile, const vpMbtXmlConfig *config)
 {
   // Load projection error config
-  vpMbTracker::loadConfigFile(configFile);
+  loadProjectionErrorConfig(configFile, config);
 
 #ifdef VISP_HAVE_PUGIXML
   vpMbtXmlGenericParser xmlp((vpMbtXmlGenericParser::vpParserType)m_trackerType);
@@ -6233,8 +6702,9 @@ void vpMbGenericTracker::TrackerWrapper::loadConfigFile(const std::string &confi
   xmlp.setKltHarrisParam(0.01);
   xmlp.setKltBlockSize(3);
   xmlp.setKltPyramidLevels(3);
-#if defined(VISP_HAVE_MODULE_KLT) && (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
+#if defined(VISP_HAVE_MODULE_KLT)
   xmlp.setKltMaskBorder(maskBorder);
+  xmlp.setKltUseNative(m_kltImplementation == KLT_NATIVE);
 #endif
 
   // Depth normal
@@ -6255,7 +6725,7 @@ void vpMbGenericTracker::TrackerWrapper::loadConfigFile(const std::string &confi
     std::vector<std::string> tracker_names;
     if (m_trackerType & EDGE_TRACKER)
       tracker_names.push_back("Edge");
-#if defined(VISP_HAVE_MODULE_KLT) && (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
+#if defined(VISP_HAVE_MODULE_KLT)
     if (m_trackerType & KLT_TRACKER)
       tracker_names.push_back("Klt");
 #endif
@@ -6272,10 +6742,16 @@ void vpMbGenericTracker::TrackerWrapper::loadConfigFile(const std::string &confi
     }
 
     std::cout << "Model-Based Tracker ************ " << std::endl;
-    xmlp.parse(configFile);
+    if (config == NULL) {
+      xmlp.parse(configFile);
+    }
   } catch (...) {
     throw vpException(vpException::ioError, "Can't open XML file \"%s\"\n ", configFile.c_str());
   }
+  // The errors of a parsed configuration are reported as they are
+  if (config != NULL) {
+    xmlp.parse(*config);
+  }
 
   vpCameraParameters camera;
   xmlp.getCameraParameters(camera);
@@ -6312,7 +6788,8 @@ void vpMbGenericTracker::TrackerWrapper::loadConfigFile(const std::string &confi
   vpMbEdgeTracker::setMovingEdge(meParser);
 
 // KLT
-#if defined(VISP_HAVE_MODULE_KLT) && (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
+#if defined(VISP_HAVE_MODULE_KLT)
+#if defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100)
   tracker.setMaxFeatures((int)xmlp.getKltMaxFeatures());
   tracker.setWindowSize((int)xmlp.getKltWindowSize());
   tracker.setQuality(xmlp.getKltQuality());
@@ -6320,6 +6797,14 @@ void vpMbGenericTracker::TrackerWrapper::loadConfigFile(const std::string &confi
   tracker.setHarrisFreeParameter(xmlp.getKltHarrisParam());
   tracker.setBlockSize((int)xmlp.getKltBlockSize());
   tracker.setPyramidLevels((int)xmlp.getKltPyramidLevels());
+  m_kltImplementation = xmlp.getKltUseNative() ? KLT_NATIVE : KLT_OPENCV;
+#endif
+  m_kltNative.setMaxFeatures((int)xmlp.getKltMaxFeatures());
+  m_kltNative.setWindowSize((int)xmlp.getKltWindowSize());
+  m_kltNative.setQuality(xmlp.getKltQuality());
+  m_kltNative.setMinDistance(xmlp.getKltMinDistance());
+  m_kltNative.setBlockSize((int)xmlp.getKltBlockSize());
+  m_kltNative.setPyramidLevels((int)xmlp.getKltPyramidLevels());
   maskBorder = xmlp.getKltMaskBorder();
 
   // if(useScanLine)
@@ -6336,6 +6821,7 @@ void vpMbGenericTracker::TrackerWrapper::loadConfigFile(const std::string &confi
   // Depth dense
   setDepthDenseSamplingStep(xmlp.getDepthDenseSamplingStepX(), xmlp.getDepthDenseSamplingStepY());
 #else
+  (void)config;
   std::cerr << "pugixml third-party is not properly built to read config file: " << configFile << std::endl;
 #endif
 }
@@ -6344,7 +6830,7 @@ void vpMbGenericTracker::TrackerWrapper::loadConfigFile(const std::string &confi
 void vpMbGenericTracker::TrackerWrapper::postTracking(const vpImage<unsigned char> *const ptr_I,
                                                       const pcl::PointCloud<pcl::PointXYZ>::ConstPtr &point_cloud)
 {
-#if defined(VISP_HAVE_MODULE_KLT) && (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
+#if defined(VISP_HAVE_MODULE_KLT)
   // KLT
   if (m_trackerType & KLT_TRACKER) {
     if (vpMbKltTracker::postTracking(*ptr_I, m_w_klt)) {
@@ -6398,7 +6884,7 @@ void vpMbGenericTracker::TrackerWrapper::preTracking(const vpImage<unsigned char
     }
   }
 
-#if defined(VISP_HAVE_MODULE_KLT) && (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
+#if defined(VISP_HAVE_MODULE_KLT)
   if (m_trackerType & KLT_TRACKER) {
     try {
       vpMbKltTracker::preTracking(*ptr_I);
@@ -6433,7 +6919,7 @@ void vpMbGenericTracker::TrackerWrapper::postTracking(const vpImage<unsigned cha
                                                       const unsigned int pointcloud_width,
                                                       const unsigned int pointcloud_height)
 {
-#if defined(VISP_HAVE_MODULE_KLT) && (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
+#if defined(VISP_HAVE_MODULE_KLT)
   // KLT
   if (m_trackerType & KLT_TRACKER) {
     if (vpMbKltTracker::postTracking(*ptr_I, m_w_klt)) {
@@ -6489,7 +6975,7 @@ void vpMbGenericTracker::TrackerWrapper::preTracking(const vpImage<unsigned char
     }
   }
 
-#if defined(VISP_HAVE_MODULE_KLT) && (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
+#if defined(VISP_HAVE_MODULE_KLT)
   if (m_trackerType & KLT_TRACKER) {
     try {
       vpMbKltTracker::preTracking(*ptr_I);
@@ -6519,6 +7005,48 @@ void vpMbGenericTracker::TrackerWrapper::preTracking(const vpImage<unsigned char
   }
 }
 
+void vpMbGenericTracker::TrackerWrapper::preTracking(const vpImage<unsigned char> * const ptr_I,
+                                                     const vpPointCloud * const point_cloud)
+{
+  if (m_trackerType & EDGE_TRACKER) {
+    try {
+      vpMbEdgeTracker::trackMovingEdge(*ptr_I);
+    } catch (...) {
+      std::cerr << "Error in moving edge tracking" << std::endl;
+      throw;
+    }
+  }
+
+#if defined(VISP_HAVE_MODULE_KLT)
+  if (m_trackerType & KLT_TRACKER) {
+    try {
+      vpMbKltTracker::preTracking(*ptr_I);
+    } catch (const vpException &e) {
+      std::cerr << "Error in KLT tracking: " << e.what() << std::endl;
+      throw;
+    }
+  }
+#endif
+
+  if (m_trackerType & DEPTH_NORMAL_TRACKER) {
+    try {
+      vpMbDepthNormalTracker::segmentPointCloud(*point_cloud);
+    } catch (...) {
+      std::cerr << "Error in Depth tracking" << std::endl;
+      throw;
+    }
+  }
+
+  if (m_trackerType & DEPTH_DENSE_TRACKER) {
+    try {
+      vpMbDepthDenseTracker::segmentPointCloud(*point_cloud);
+    } catch (...) {
+      std::cerr << "Error in Depth dense tracking" << std::endl;
+      throw;
+    }
+  }
+}
+
 void vpMbGenericTracker::TrackerWrapper::reInitModel(const vpImage<unsigned char> * const I, const vpImage<vpRGBa> * const I_color,
                                                      const std::string &cad_name, const vpHomogeneousMatrix &cMo, bool verbose,
                                                      const vpHomogeneousMatrix &T)
@@ -6566,8 +7094,8 @@ void vpMbGenericTracker::TrackerWrapper::reInitModel(const vpImage<unsigned char
   nbvisiblepolygone = 0;
 
 // KLT
-#if defined(VISP_HAVE_MODULE_KLT) && (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
-#if (VISP_HAVE_OPENCV_VERSION < 0x020408)
+#if defined(VISP_HAVE_MODULE_KLT)
+#if defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100) && (VISP_HAVE_OPENCV_VERSION < 0x020408)
   if (cur != NULL) {
     cvReleaseImage(&cur);
     cur = NULL;
@@ -6649,7 +7177,7 @@ void vpMbGenericTracker::TrackerWrapper::reInitModel(const vpImage<vpRGBa> &I_co
 void vpMbGenericTracker::TrackerWrapper::resetTracker()
 {
   vpMbEdgeTracker::resetTracker();
-#if defined(VISP_HAVE_MODULE_KLT) && (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
+#if defined(VISP_HAVE_MODULE_KLT)
   vpMbKltTracker::resetTracker();
 #endif
   vpMbDepthNormalTracker::resetTracker();
@@ -6661,7 +7189,7 @@ void vpMbGenericTracker::TrackerWrapper::setCameraParameters(const vpCameraParam
   m_cam = cam;
 
   vpMbEdgeTracker::setCameraParameters(m_cam);
-#if defined(VISP_HAVE_MODULE_KLT) && (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
+#if defined(VISP_HAVE_MODULE_KLT)
   vpMbKltTracker::setCameraParameters(m_cam);
 #endif
   vpMbDepthNormalTracker::setCameraParameters(m_cam);
@@ -6699,7 +7227,7 @@ void vpMbGenericTracker::TrackerWrapper::setPose(const vpImage<unsigned char> *
     vpImageConvert::convert(*I_color, m_I);
   }
 
-#if defined(VISP_HAVE_MODULE_KLT) && (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
+#if defined(VISP_HAVE_MODULE_KLT)
   if (m_trackerType & KLT_TRACKER) {
     performKltSetPose = true;
 
@@ -6771,7 +7299,7 @@ void vpMbGenericTracker::TrackerWrapper::setProjectionErrorComputation(const boo
 void vpMbGenericTracker::TrackerWrapper::setScanLineVisibilityTest(const bool &v)
 {
   vpMbEdgeTracker::setScanLineVisibilityTest(v);
-#if defined(VISP_HAVE_MODULE_KLT) && (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
+#if defined(VISP_HAVE_MODULE_KLT)
   vpMbKltTracker::setScanLineVisibilityTest(v);
 #endif
   vpMbDepthNormalTracker::setScanLineVisibilityTest(v);
@@ -6781,7 +7309,7 @@ void vpMbGenericTracker::TrackerWrapper::setScanLineVisibilityTest(const bool &v
 void vpMbGenericTracker::TrackerWrapper::setTrackerType(int type)
 {
   if ((type & (EDGE_TRACKER |
-#if defined(VISP_HAVE_MODULE_KLT) && (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
+#if defined(VISP_HAVE_MODULE_KLT)
                KLT_TRACKER |
 #endif
                DEPTH_NORMAL_TRACKER | DEPTH_DENSE_TRACKER)) == 0) {
@@ -6805,7 +7333,7 @@ void vpMbGenericTracker::TrackerWrapper::track(const vpImage<unsigned char> &
 )
 {
   if ((m_trackerType & (EDGE_TRACKER
-#if defined(VISP_HAVE_MODULE_KLT) && (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
+#if defined(VISP_HAVE_MODULE_KLT)
                         | KLT_TRACKER
 #endif
                         )) == 0) {
@@ -6828,7 +7356,7 @@ void vpMbGenericTracker::TrackerWrapper::track(const vpImage<unsigned char> *con
                                                const pcl::PointCloud<pcl::PointXYZ>::ConstPtr &point_cloud)
 {
   if ((m_trackerType & (EDGE_TRACKER |
-#if defined(VISP_HAVE_MODULE_KLT) && (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
+#if defined(VISP_HAVE_MODULE_KLT)
                         KLT_TRACKER |
 #endif
                         DEPTH_NORMAL_TRACKER | DEPTH_DENSE_TRACKER)) == 0) {
@@ -6837,7 +7365,7 @@ void vpMbGenericTracker::TrackerWrapper::track(const vpImage<unsigned char> *con
   }
 
   if (m_trackerType & (EDGE_TRACKER
-#if defined(VISP_HAVE_MODULE_KLT) && (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
+#if defined(VISP_HAVE_MODULE_KLT)
                        | KLT_TRACKER
 #endif
                        ) &&
@@ -597,7 +597,7 @@ void vpMbScanLine::queryLineVisibility(const vpPoint &a, const vpPoint &b,
   const int _v0 = (std::max)(0, int(std::ceil(*v0)));
   const int _v1 = (std::min)((int)(size - 1), (int)(std::ceil(*v1) - 1));
 
-  const std::set<int> &visible_samples = visibility_samples[edge];
+  const std::set<int> &visible_samples = visibility_samples.find(edge)->second;
   int last = _v0;
   vpPoint line_start;
   vpPoint line_end;
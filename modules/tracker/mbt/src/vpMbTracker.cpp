@@ -46,6 +46,7 @@
 #include <algorithm>
 #include <iostream>
 #include <limits>
+#include <sstream>
 
 #include <visp3/core/vpColVector.h>
 #include <visp3/core/vpDisplay.h>
@@ -144,7 +145,8 @@ vpMbTracker::vpMbTracker()
     angleDisappears(vpMath::rad(89)), distNearClip(0.001), distFarClip(100), clippingFlag(vpPolygon3D::NO_CLIPPING),
     useOgre(false), ogreShowConfigDialog(false), useScanLine(false), nbPoints(0), nbLines(0), nbPolygonLines(0),
     nbPolygonPoints(0), nbCylinders(0), nbCircles(0), useLodGeneral(false), applyLodSettingInConfig(false),
-    minLineLengthThresholdGeneral(50.0), minPolygonAreaThresholdGeneral(2500.0), mapOfParameterNames(),
+    minLineLengthThresholdGeneral(50.0), minPolygonAreaThresholdGeneral(2500.0), m_useModelCache(false),
+    m_modelCacheDirectory(), m_compiledModel(NULL), mapOfParameterNames(),
     m_computeInteraction(true), m_lambda(1.0), m_maxIter(30), m_stopCriteriaEpsilon(1e-8), m_initialMu(0.01),
     m_projectionErrorLines(), m_projectionErrorCylinders(), m_projectionErrorCircles(),
     m_projectionErrorFaces(), m_projectionErrorOgreShowConfigDialog(false),
@@ -187,6 +189,45 @@ vpMbTracker::~vpMbTracker() {
   }
 }
 
+/*!
+  Duplicate the features used to compute the projection error. This function
+  has to be called after a member-wise copy of \e tracker, the projection error
+  lines, cylinders and circles of the current tracker being still shared with
+  \e tracker. The copies are bound to the projection error faces and moving
+  edge parameters of the current tracker.
+
+  \param tracker : Tracker the features are copied from.
+*/
+void vpMbTracker::copyProjectionErrorFeatures(const vpMbTracker &tracker)
+{
+  m_projectionErrorLines.clear();
+  for (std::vector<vpMbtDistanceLine *>::const_iterator it = tracker.m_projectionErrorLines.begin();
+       it != tracker.m_projectionErrorLines.end(); ++it) {
+    vpMbtDistanceLine *l = new vpMbtDistanceLine(**it);
+    l->setMe(&m_projectionErrorMe);
+    l->hiddenface = &m_projectionErrorFaces;
+    m_projectionErrorLines.push_back(l);
+  }
+
+  m_projectionErrorCylinders.clear();
+  for (std::vector<vpMbtDistanceCylinder *>::const_iterator it = tracker.m_projectionErrorCylinders.begin();
+       it != tracker.m_projectionErrorCylinders.end(); ++it) {
+    vpMbtDistanceCylinder *cy = new vpMbtDistanceCylinder(**it);
+    cy->setMovingEdge(&m_projectionErrorMe);
+    cy->hiddenface = &m_projectionErrorFaces;
+    m_projectionErrorCylinders.push_back(cy);
+  }
+
+  m_projectionErrorCircles.clear();
+  for (std::vector<vpMbtDistanceCircle *>::const_iterator it = tracker.m_projectionErrorCircles.begin();
+       it != tracker.m_projectionErrorCircles.end(); ++it) {
+    vpMbtDistanceCircle *ci = new vpMbtDistanceCircle(**it);
+    ci->setMovingEdge(&m_projectionErrorMe);
+    ci->hiddenface = &m_projectionErrorFaces;
+    m_projectionErrorCircles.push_back(ci);
+  }
+}
+
 #ifdef VISP_HAVE_MODULE_GUI
 void vpMbTracker::initClick(const vpImage<unsigned char> * const I, const vpImage<vpRGBa> * const I_color,
                             const std::string &initFile, bool displayHelp, const vpHomogeneousMatrix &T)
@@ -1462,6 +1503,8 @@ is not wrl or cao.
 CAO model files which include other CAO model files.
   \param odTo : optional transformation matrix (currently only for .cao) to transform
   3D points expressed in the original object frame to the desired object frame.
+
+  \sa setModelCacheEnabled() to load CAO models from a compiled model cache.
 */
 void vpMbTracker::loadModel(const std::string &modelFile, bool verbose, const vpHomogeneousMatrix &odTo)
 {
@@ -1479,7 +1522,47 @@ void vpMbTracker::loadModel(const std::string &modelFile, bool verbose, const vp
       nbPolygonPoints = 0;
       nbCylinders = 0;
       nbCircles = 0;
-      loadCAOModel(modelFile, vectorOfModelFilename, startIdFace, verbose, true, odTo);
+      if (m_useModelCache) {
+        std::string cacheFile = getModelCacheFilename(modelFile);
+        uint64_t settingsHash = getModelCacheSettingsHash(odTo);
+        vpMbtCompiledModel compiledModel;
+        if (compiledModel.load(cacheFile, settingsHash)) {
+          if (verbose) {
+            std::cout << "Compiled model file : " << cacheFile << std::endl;
+          }
+          loadCompiledModel(compiledModel, startIdFace);
+        } else {
+          // Record the primitives while parsing, then save them for the next loads
+          compiledModel.setSettingsHash(settingsHash);
+          m_compiledModel = &compiledModel;
+          try {
+            loadCAOModel(modelFile, vectorOfModelFilename, startIdFace, verbose, true, odTo);
+          } catch (...) {
+            m_compiledModel = NULL;
+            throw;
+          }
+          m_compiledModel = NULL;
+
+          std::vector<unsigned int> statistics;
+          statistics.push_back(nbPoints);
+          statistics.push_back(nbLines);
+          statistics.push_back(nbPolygonLines);
+          statistics.push_back(nbPolygonPoints);
+          statistics.push_back(nbCylinders);
+          statistics.push_back(nbCircles);
+          compiledModel.setStatistics(statistics);
+          try {
+            if (!m_modelCacheDirectory.empty() && !vpIoTools::checkDirectory(m_modelCacheDirectory)) {
+              vpIoTools::makeDirectory(m_modelCacheDirectory);
+            }
+            compiledModel.save(cacheFile);
+          } catch (const vpException &e) {
+            std::cerr << "Cannot save the compiled model: " << e.getStringMessage() << std::endl;
+          }
+        }
+      } else {
+        loadCAOModel(modelFile, vectorOfModelFilename, startIdFace, verbose, true, odTo);
+      }
     } else if ((*(it - 1) == 'l' && *(it - 2) == 'r' && *(it - 3) == 'w' && *(it - 4) == '.') ||
                (*(it - 1) == 'L' && *(it - 2) == 'R' && *(it - 3) == 'W' && *(it - 4) == '.')) {
       loadVRMLModel(modelFile);
@@ -1702,6 +1785,9 @@ void vpMbTracker::loadCAOModel(const std::string &modelFile, std::vector<std::st
     std::cout << "Model file : " << modelFile << std::endl;
   }
   vectorOfModelFilename.push_back(modelFile);
+  if (m_compiledModel != NULL) {
+    m_compiledModel->addSource(modelFile);
+  }
 
   try {
     char c;
@@ -2024,11 +2110,7 @@ void vpMbTracker::loadCAOModel(const std::string &modelFile, std::vector<std::st
         useLod = vpIoTools::parseBoolean(mapOfParams["useLod"]);
       }
 
-      addPolygon(corners, idFace, polygonName, useLod, minPolygonAreaThreshold, minLineLengthThresholdGeneral);
-      initFaceFromLines(*(faces.getPolygon().back())); // Init from the last polygon that was added
-
-      addProjectionErrorPolygon(corners, idFace++, polygonName, useLod, minPolygonAreaThreshold, minLineLengthThresholdGeneral);
-      initProjectionErrorFaceFromLines(*(m_projectionErrorFaces.getPolygon().back()));
+      addModelFace(corners, true, idFace, polygonName, useLod, minPolygonAreaThreshold, minLineLengthThresholdGeneral);
     }
 
     // Add the segments which were not already added in the face segment case
@@ -2036,13 +2118,8 @@ void vpMbTracker::loadCAOModel(const std::string &modelFile, std::vector<std::st
          it != segmentTemporaryMap.end(); ++it) {
       if (std::find(faceSegmentKeyVector.begin(), faceSegmentKeyVector.end(), it->first) ==
           faceSegmentKeyVector.end()) {
-        addPolygon(it->second.extremities, idFace, it->second.name, it->second.useLod, minPolygonAreaThresholdGeneral,
-                   it->second.minLineLengthThresh);
-        initFaceFromCorners(*(faces.getPolygon().back())); // Init from the last polygon that was added
-
-        addProjectionErrorPolygon(it->second.extremities, idFace++, it->second.name, it->second.useLod, minPolygonAreaThresholdGeneral,
-                                  it->second.minLineLengthThresh);
-        initProjectionErrorFaceFromCorners(*(m_projectionErrorFaces.getPolygon().back()));
+        addModelFace(it->second.extremities, false, idFace, it->second.name, it->second.useLod,
+                     minPolygonAreaThresholdGeneral, it->second.minLineLengthThresh);
       }
     }
 
@@ -2100,11 +2177,7 @@ void vpMbTracker::loadCAOModel(const std::string &modelFile, std::vector<std::st
         useLod = vpIoTools::parseBoolean(mapOfParams["useLod"]);
       }
 
-      addPolygon(corners, idFace, polygonName, useLod, minPolygonAreaThreshold, minLineLengthThresholdGeneral);
-      initFaceFromCorners(*(faces.getPolygon().back())); // Init from the last polygon that was added
-
-      addProjectionErrorPolygon(corners, idFace++, polygonName, useLod, minPolygonAreaThreshold, minLineLengthThresholdGeneral);
-      initProjectionErrorFaceFromCorners(*(m_projectionErrorFaces.getPolygon().back()));
+      addModelFace(corners, false, idFace, polygonName, useLod, minPolygonAreaThreshold, minLineLengthThresholdGeneral);
     }
 
     //////////////////////////Read the cylinder declaration part//////////////////////////
@@ -2161,21 +2234,8 @@ void vpMbTracker::loadCAOModel(const std::string &modelFile, std::vector<std::st
           useLod = vpIoTools::parseBoolean(mapOfParams["useLod"]);
         }
 
-        int idRevolutionAxis = idFace;
-        addPolygon(caoPoints[indexP1], caoPoints[indexP2], idFace, polygonName, useLod, minLineLengthThreshold);
-
-        addProjectionErrorPolygon(caoPoints[indexP1], caoPoints[indexP2], idFace++, polygonName, useLod, minLineLengthThreshold);
-
-        std::vector<std::vector<vpPoint> > listFaces;
-        createCylinderBBox(caoPoints[indexP1], caoPoints[indexP2], radius, listFaces);
-        addPolygon(listFaces, idFace, polygonName, useLod, minLineLengthThreshold);
-
-        initCylinder(caoPoints[indexP1], caoPoints[indexP2], radius, idRevolutionAxis, polygonName);
-
-        addProjectionErrorPolygon(listFaces, idFace, polygonName, useLod, minLineLengthThreshold);
-        initProjectionErrorCylinder(caoPoints[indexP1], caoPoints[indexP2], radius, idRevolutionAxis, polygonName);
-
-        idFace += 4;
+        addModelCylinder(caoPoints[indexP1], caoPoints[indexP2], radius, idFace, polygonName, useLod,
+                         minLineLengthThreshold);
       }
 
     } catch (...) {
@@ -2238,14 +2298,8 @@ void vpMbTracker::loadCAOModel(const std::string &modelFile, std::vector<std::st
           useLod = vpIoTools::parseBoolean(mapOfParams["useLod"]);
         }
 
-        addPolygon(caoPoints[indexP1], caoPoints[indexP2], caoPoints[indexP3], radius, idFace, polygonName, useLod,
-                   minPolygonAreaThreshold);
-
-        initCircle(caoPoints[indexP1], caoPoints[indexP2], caoPoints[indexP3], radius, idFace, polygonName);
-
-        addProjectionErrorPolygon(caoPoints[indexP1], caoPoints[indexP2], caoPoints[indexP3], radius, idFace, polygonName, useLod,
-                                  minPolygonAreaThreshold);
-        initProjectionErrorCircle(caoPoints[indexP1], caoPoints[indexP2], caoPoints[indexP3], radius, idFace++, polygonName);
+        addModelCircle(caoPoints[indexP1], caoPoints[indexP2], caoPoints[indexP3], radius, idFace, polygonName, useLod,
+                       minPolygonAreaThreshold);
       }
 
     } catch (...) {
@@ -2285,6 +2339,207 @@ void vpMbTracker::loadCAOModel(const std::string &modelFile, std::vector<std::st
   }
 }
 
+/*!
+  Add a face or a single segment of the CAD model, and the corresponding
+  projection error face. The face is recorded in the compiled model when a
+  CAO model is being compiled.
+
+  \param corners : Corners of the face, or extremities of the segment.
+  \param fromLines : True if the face is described by segments, in which
+  case initFaceFromLines() is used instead of initFaceFromCorners().
+  \param idFace : Id of the face, incremented.
+  \param name : Name of the face.
+  \param useLod : True if the LOD is used for this face.
+  \param minPolygonAreaThreshold : Minimum polygon area threshold of the LOD.
+  \param minLineLengthThreshold : Minimum line length threshold of the LOD.
+*/
+void vpMbTracker::addModelFace(const std::vector<vpPoint> &corners, bool fromLines, int &idFace,
+                               const std::string &name, bool useLod, double minPolygonAreaThreshold,
+                               double minLineLengthThreshold)
+{
+  if (m_compiledModel != NULL) {
+    m_compiledModel->addPrimitive(fromLines ? vpMbtCompiledModel::FACE_FROM_LINES
+                                            : vpMbtCompiledModel::FACE_FROM_CORNERS,
+                                  corners, 0.0, name, useLod, minPolygonAreaThreshold, minLineLengthThreshold);
+  }
+
+  addPolygon(corners, idFace, name, useLod, minPolygonAreaThreshold, minLineLengthThreshold);
+  addProjectionErrorPolygon(corners, idFace++, name, useLod, minPolygonAreaThreshold, minLineLengthThreshold);
+  if (fromLines) {
+    initFaceFromLines(*(faces.getPolygon().back())); // Init from the last polygon that was added
+    initProjectionErrorFaceFromLines(*(m_projectionErrorFaces.getPolygon().back()));
+  } else {
+    initFaceFromCorners(*(faces.getPolygon().back())); // Init from the last polygon that was added
+    initProjectionErrorFaceFromCorners(*(m_projectionErrorFaces.getPolygon().back()));
+  }
+}
+
+/*!
+  Add a cylinder of the CAD model with its bounding box faces, and the
+  corresponding projection error features. The cylinder is recorded in the
+  compiled model when a CAO model is being compiled.
+
+  \param p1 : First point on the axis.
+  \param p2 : Second point on the axis.
+  \param radius : Radius of the cylinder.
+  \param idFace : Id of the revolution axis face, incremented by 5.
+  \param name : Name of the cylinder.
+  \param useLod : True if the LOD is used for this cylinder.
+  \param minLineLengthThreshold : Minimum line length threshold of the LOD.
+*/
+void vpMbTracker::addModelCylinder(const vpPoint &p1, const vpPoint &p2, double radius, int &idFace,
+                                   const std::string &name, bool useLod, double minLineLengthThreshold)
+{
+  if (m_compiledModel != NULL) {
+    std::vector<vpPoint> points;
+    points.push_back(p1);
+    points.push_back(p2);
+    m_compiledModel->addPrimitive(vpMbtCompiledModel::CYLINDER, points, radius, name, useLod,
+                                  minPolygonAreaThresholdGeneral, minLineLengthThreshold);
+  }
+
+  int idRevolutionAxis = idFace;
+  addPolygon(p1, p2, idFace, name, useLod, minLineLengthThreshold);
+
+  addProjectionErrorPolygon(p1, p2, idFace++, name, useLod, minLineLengthThreshold);
+
+  std::vector<std::vector<vpPoint> > listFaces;
+  createCylinderBBox(p1, p2, radius, listFaces);
+  addPolygon(listFaces, idFace, name, useLod, minLineLengthThreshold);
+
+  initCylinder(p1, p2, radius, idRevolutionAxis, name);
+
+  addProjectionErrorPolygon(listFaces, idFace, name, useLod, minLineLengthThreshold);
+  initProjectionErrorCylinder(p1, p2, radius, idRevolutionAxis, name);
+
+  idFace += 4;
+}
+
+/*!
+  Add a circle of the CAD model and the corresponding projection error
+  features. The circle is recorded in the compiled model when a CAO model is
+  being compiled.
+
+  \param p1 : Center of the circle.
+  \param p2 : A point on the plane containing the circle.
+  \param p3 : An other point on the plane containing the circle.
+  \param radius : Radius of the circle.
+  \param idFace : Id of the face, incremented.
+  \param name : Name of the circle.
+  \param useLod : True if the LOD is used for this circle.
+  \param minPolygonAreaThreshold : Minimum polygon area threshold of the LOD.
+*/
+void vpMbTracker::addModelCircle(const vpPoint &p1, const vpPoint &p2, const vpPoint &p3, double radius, int &idFace,
+                                 const std::string &name, bool useLod, double minPolygonAreaThreshold)
+{
+  if (m_compiledModel != NULL) {
+    std::vector<vpPoint> points;
+    points.push_back(p1);
+    points.push_back(p2);
+    points.push_back(p3);
+    m_compiledModel->addPrimitive(vpMbtCompiledModel::CIRCLE, points, radius, name, useLod, minPolygonAreaThreshold,
+                                  minLineLengthThresholdGeneral);
+  }
+
+  addPolygon(p1, p2, p3, radius, idFace, name, useLod, minPolygonAreaThreshold);
+
+  initCircle(p1, p2, p3, radius, idFace, name);
+
+  addProjectionErrorPolygon(p1, p2, p3, radius, idFace, name, useLod, minPolygonAreaThreshold);
+  initProjectionErrorCircle(p1, p2, p3, radius, idFace++, name);
+}
+
+/*!
+  Add the primitives of a compiled model, in the order they were found when
+  the CAO model was parsed.
+
+  \param model : The compiled model.
+  \param startIdFace : Current Id of the face, updated.
+*/
+void vpMbTracker::loadCompiledModel(const vpMbtCompiledModel &model, int &startIdFace)
+{
+  int idFace = startIdFace;
+  std::vector<vpPoint> points;
+  for (unsigned int i = 0; i < model.getNbPrimitives(); i++) {
+    const vpMbtCompiledModel::vpPrimitive &primitive = model.getPrimitive(i);
+    std::string name = model.getName(primitive);
+    bool useLod = primitive.useLod != 0;
+    model.getPoints(primitive, points);
+
+    switch (primitive.type) {
+    case vpMbtCompiledModel::FACE_FROM_LINES:
+    case vpMbtCompiledModel::FACE_FROM_CORNERS:
+      addModelFace(points, primitive.type == vpMbtCompiledModel::FACE_FROM_LINES, idFace, name, useLod,
+                   primitive.minPolygonAreaThreshold, primitive.minLineLengthThreshold);
+      break;
+
+    case vpMbtCompiledModel::CYLINDER:
+      addModelCylinder(points[0], points[1], primitive.radius, idFace, name, useLod, primitive.minLineLengthThreshold);
+      break;
+
+    case vpMbtCompiledModel::CIRCLE:
+      addModelCircle(points[0], points[1], points[2], primitive.radius, idFace, name, useLod,
+                     primitive.minPolygonAreaThreshold);
+      break;
+
+    default:
+      throw vpException(vpException::badValue, "Unknown primitive type in compiled model");
+    }
+  }
+  startIdFace = idFace;
+
+  std::vector<unsigned int> statistics = model.getStatistics();
+  nbPoints = statistics[0];
+  nbLines = statistics[1];
+  nbPolygonLines = statistics[2];
+  nbPolygonPoints = statistics[3];
+  nbCylinders = statistics[4];
+  nbCircles = statistics[5];
+  std::cout << "> " << nbPoints << " points" << std::endl;
+  std::cout << "> " << nbLines << " lines" << std::endl;
+  std::cout << "> " << nbPolygonLines << " polygon lines" << std::endl;
+  std::cout << "> " << nbPolygonPoints << " polygon points" << std::endl;
+  std::cout << "> " << nbCylinders << " cylinders" << std::endl;
+  std::cout << "> " << nbCircles << " circles" << std::endl;
+}
+
+/*!
+  Return the path of the compiled model associated to a CAO model file.
+
+  \param modelFile : The CAO model file.
+*/
+std::string vpMbTracker::getModelCacheFilename(const std::string &modelFile) const
+{
+  if (m_modelCacheDirectory.empty()) {
+    return modelFile + ".bin";
+  }
+
+  // Distinguish the models with the same name in different directories
+  std::string absolutePath = vpIoTools::getAbsolutePathname(modelFile);
+  std::stringstream ss;
+  ss << vpIoTools::getNameWE(modelFile) << "_" << std::hex
+     << vpMbtCompiledModel::computeHash(absolutePath.c_str(), absolutePath.size()) << ".bin";
+
+  return vpIoTools::createFilePath(m_modelCacheDirectory, ss.str());
+}
+
+/*!
+  Return the hash of the settings that change the primitives resolved when
+  parsing a CAO model: the LOD general settings and the model transformation.
+
+  \param odTo : Transformation applied to the model points.
+*/
+uint64_t vpMbTracker::getModelCacheSettingsHash(const vpHomogeneousMatrix &odTo) const
+{
+  uint64_t hash = vpMbtCompiledModel::computeHash(odTo.data, odTo.size() * sizeof(double));
+  unsigned char flags[2] = {static_cast<unsigned char>(useLodGeneral), static_cast<unsigned char>(applyLodSettingInConfig)};
+  hash = vpMbtCompiledModel::computeHash(flags, sizeof(flags), hash);
+  hash = vpMbtCompiledModel::computeHash(&minLineLengthThresholdGeneral, sizeof(double), hash);
+  hash = vpMbtCompiledModel::computeHash(&minPolygonAreaThresholdGeneral, sizeof(double), hash);
+
+  return hash;
+}
+
 #ifdef VISP_HAVE_COIN3D
 /*!
   Extract a VRML object Group.
@@ -2781,6 +3036,35 @@ void vpMbTracker::setMinPolygonAreaThresh(double minPolygonAreaThresh, const std
   }
 }
 
+/*!
+  Set the directory where the compiled models are stored when the compiled
+  model cache is enabled. The directory is created if needed. By default the
+  directory is empty and a compiled model is stored next to its CAO model
+  file, with the additional \e .bin extension.
+
+  \param directory : Directory of the compiled model cache.
+
+  \sa setModelCacheEnabled()
+*/
+void vpMbTracker::setModelCacheDirectory(const std::string &directory) { m_modelCacheDirectory = directory; }
+
+/*!
+  Enable or disable the compiled model cache used by loadModel() for CAO
+  models.
+
+  When enabled, the first call to loadModel() parses the CAO model file and
+  its included files, and saves the resolved polygons, lines, cylinders,
+  circles, face names and LOD settings in a binary vpMbtCompiledModel. The
+  next calls load the compiled model instead, without any parsing. A compiled
+  model is discarded and rebuilt when the content of one of the CAO files,
+  the LOD settings or the model transformation changed.
+
+  \param enable : True to use the compiled model cache.
+
+  \sa setModelCacheDirectory()
+*/
+void vpMbTracker::setModelCacheEnabled(bool enable) { m_useModelCache = enable; }
+
 /*!
   Set the near distance for clipping.
 
@@ -3782,18 +4066,32 @@ void vpMbTracker::projectionErrorInitMovingEdge(const vpImage<unsigned char> &I,
   }
 }
 
-void vpMbTracker::loadConfigFile(const std::string &configFile)
+void vpMbTracker::loadConfigFile(const std::string &configFile) { loadProjectionErrorConfig(configFile, NULL); }
+
+/*!
+  Load the projection error parameters from an XML config file, or from a
+  configuration already parsed by vpMbtXmlConfig.
+
+  \param configFile : An xml config file to parse, used when \e config is NULL.
+  \param config : Parsed configuration, or NULL.
+*/
+void vpMbTracker::loadProjectionErrorConfig(const std::string &configFile, const vpMbtXmlConfig *config)
 {
 #ifdef VISP_HAVE_PUGIXML
   vpMbtXmlGenericParser xmlp(vpMbtXmlGenericParser::PROJECTION_ERROR_PARSER);
   xmlp.setProjectionErrorMe(m_projectionErrorMe);
   xmlp.setProjectionErrorKernelSize(m_projectionErrorKernelSize);
 
-  try {
-    std::cout << " *********** Parsing XML for ME projection error ************ " << std::endl;
-    xmlp.parse(configFile);
-  } catch (...) {
-    throw vpException(vpException::ioError, "Cannot open XML file \"%s\"", configFile.c_str());
+  std::cout << " *********** Parsing XML for ME projection error ************ " << std::endl;
+  if (config != NULL) {
+    // The errors of a parsed configuration are reported as they are
+    xmlp.parse(*config);
+  } else {
+    try {
+      xmlp.parse(configFile);
+    } catch (...) {
+      throw vpException(vpException::ioError, "Cannot open XML file \"%s\"", configFile.c_str());
+    }
   }
 
   vpMe meParser;
@@ -3803,6 +4101,7 @@ void vpMbTracker::loadConfigFile(const std::string &configFile)
   setProjectionErrorKernelSize(xmlp.getProjectionErrorKernelSize());
 
 #else
+  (void)config;
   std::cerr << "pugixml third-party is not properly built to read config file: " << configFile << std::endl;
 #endif
 }
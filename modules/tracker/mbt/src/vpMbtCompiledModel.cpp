@@ -0,0 +1,528 @@
+/****************************************************************************
+ *
+ * ViSP, open source Visual Servoing Platform software.
+ * Copyright (C) 2005 - 2019 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Compiled (binary) CAD model used by the model-based trackers.
+ *
+ *****************************************************************************/
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#include <visp3/core/vpException.h>
+#include <visp3/core/vpIoTools.h>
+#include <visp3/mbt/vpMbtCompiledModel.h>
+
+#if !defined(_WIN32) && (defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))) // UNIX
+#define VP_MBT_COMPILED_MODEL_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+namespace
+{
+const char compiledModelMagic[8] = {'V', 'P', 'M', 'B', 'T', 'C', 'M', '\0'};
+// Increase when the layout of the file changes
+const uint32_t compiledModelVersion = 1;
+// Written in native byte order, used to detect a file produced on a machine
+// with a different endianness
+const uint32_t compiledModelByteOrder = 0x01020304;
+const unsigned int compiledModelNbStatistics = 6;
+
+struct vpCompiledModelHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t byteOrder;
+  uint64_t settingsHash;
+  uint32_t statistics[compiledModelNbStatistics];
+  uint32_t nbSources;
+  uint32_t nbPrimitives;
+  uint64_t nbPointValues;
+  uint64_t stringTableSize;
+  uint64_t fileSize;
+};
+
+struct vpCompiledModelSource {
+  uint64_t hash;
+  uint64_t nameOffset;
+  uint64_t nameLength;
+};
+
+uint64_t expectedFileSize(const vpCompiledModelHeader &header)
+{
+  return sizeof(vpCompiledModelHeader) + header.nbSources * sizeof(vpCompiledModelSource) +
+         header.nbPrimitives * sizeof(vpMbtCompiledModel::vpPrimitive) + header.nbPointValues * sizeof(double) +
+         header.stringTableSize;
+}
+
+// Check that the sections given by the header fill the file, without overflowing on corrupted sizes
+bool hasExpectedFileSize(const vpCompiledModelHeader &header, uint64_t size)
+{
+  if (header.nbPointValues > size / sizeof(double))
+    return false;
+  const uint64_t sectionSizes[] = {sizeof(vpCompiledModelHeader),
+                                   header.nbSources * static_cast<uint64_t>(sizeof(vpCompiledModelSource)),
+                                   header.nbPrimitives * static_cast<uint64_t>(sizeof(vpMbtCompiledModel::vpPrimitive)),
+                                   header.nbPointValues * sizeof(double), header.stringTableSize};
+  for (size_t i = 0; i < sizeof(sectionSizes) / sizeof(sectionSizes[0]); i++) {
+    if (sectionSizes[i] > size)
+      return false;
+    size -= sectionSizes[i];
+  }
+  return size == 0;
+}
+
+// Check that a range lies in a table, without overflowing on corrupted offsets
+bool isInTable(uint64_t offset, uint64_t length, uint64_t tableSize)
+{
+  return length <= tableSize && offset <= tableSize - length;
+}
+}
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+/*!
+  Default constructor that creates an empty compiled model.
+*/
+vpMbtCompiledModel::vpMbtCompiledModel()
+  : m_settingsHash(0), m_statistics(compiledModelNbStatistics, 0), m_sourceNames(), m_sourceHashes(),
+    m_primitiveList(), m_pointList(), m_stringTable(), m_nbPrimitives(0), m_primitives(NULL), m_points(NULL),
+    m_strings(NULL), m_mapped(NULL), m_mappedSize(0), m_buffer()
+{
+}
+
+/*!
+  Destructor. Unmap the loaded file if any.
+*/
+vpMbtCompiledModel::~vpMbtCompiledModel() { unmap(); }
+
+/*!
+  Append a primitive to the compiled model.
+
+  \param type : Type of the primitive.
+  \param points : 3D points of the primitive expressed in the object frame:
+  the corners of a face, the two points on the axis of a cylinder, or the
+  center and the two points on the plane of a circle.
+  \param radius : Radius of a cylinder or a circle, unused otherwise.
+  \param name : Name of the primitive.
+  \param useLod : True if the LOD is used for this primitive.
+  \param minPolygonAreaThreshold : Minimum polygon area threshold of the LOD.
+  \param minLineLengthThreshold : Minimum line length threshold of the LOD.
+*/
+void vpMbtCompiledModel::addPrimitive(vpPrimitiveType type, const std::vector<vpPoint> &points, double radius,
+                                      const std::string &name, bool useLod, double minPolygonAreaThreshold,
+                                      double minLineLengthThreshold)
+{
+  if (m_mapped != NULL || !m_buffer.empty()) {
+    throw vpException(vpException::fatalError, "Cannot add a primitive to a loaded compiled model");
+  }
+
+  vpPrimitive primitive;
+  primitive.type = static_cast<uint32_t>(type);
+  primitive.firstPoint = static_cast<uint32_t>(m_pointList.size() / 3);
+  primitive.nbPoints = static_cast<uint32_t>(points.size());
+  primitive.nameOffset = static_cast<uint32_t>(m_stringTable.size());
+  primitive.nameLength = static_cast<uint32_t>(name.size());
+  primitive.useLod = useLod ? 1 : 0;
+  primitive.radius = radius;
+  primitive.minPolygonAreaThreshold = minPolygonAreaThreshold;
+  primitive.minLineLengthThreshold = minLineLengthThreshold;
+
+  for (std::vector<vpPoint>::const_iterator it = points.begin(); it != points.end(); ++it) {
+    m_pointList.push_back(it->get_oX());
+    m_pointList.push_back(it->get_oY());
+    m_pointList.push_back(it->get_oZ());
+  }
+  m_stringTable += name;
+  m_primitiveList.push_back(primitive);
+
+  m_nbPrimitives = static_cast<unsigned int>(m_primitiveList.size());
+  m_primitives = &m_primitiveList[0];
+  m_points = m_pointList.empty() ? NULL : &m_pointList[0];
+  m_strings = m_stringTable.c_str();
+}
+
+/*!
+  Register a source file of the model. The hash of its content is stored in
+  the compiled model, and checked by load().
+
+  \param filename : Path to the source file.
+
+  \throw vpException::ioError if the file cannot be read.
+*/
+void vpMbtCompiledModel::addSource(const std::string &filename)
+{
+  std::string path = vpIoTools::getAbsolutePathname(filename);
+  m_sourceNames.push_back(path);
+  m_sourceHashes.push_back(computeFileHash(path));
+}
+
+/*!
+  Remove all the primitives and sources and unmap the loaded file if any.
+*/
+void vpMbtCompiledModel::clear()
+{
+  unmap();
+  m_settingsHash = 0;
+  m_statistics.assign(compiledModelNbStatistics, 0);
+  m_sourceNames.clear();
+  m_sourceHashes.clear();
+  m_primitiveList.clear();
+  m_pointList.clear();
+  m_stringTable.clear();
+  m_nbPrimitives = 0;
+  m_primitives = NULL;
+  m_points = NULL;
+  m_strings = NULL;
+}
+
+/*!
+  Compute the 64 bits FNV-1a hash of a memory block.
+
+  \param data : Pointer to the data.
+  \param size : Size of the data in bytes.
+  \param hash : Previous hash value, allows to hash data by chunks.
+
+  \return The updated hash value.
+*/
+uint64_t vpMbtCompiledModel::computeHash(const void *data, size_t size, uint64_t hash)
+{
+  const unsigned char *bytes = static_cast<const unsigned char *>(data);
+  for (size_t i = 0; i < size; i++) {
+    hash ^= bytes[i];
+    hash *= 1099511628211ULL;
+  }
+
+  return hash;
+}
+
+/*!
+  Compute the 64 bits FNV-1a hash of the content of a file.
+
+  \param filename : Path to the file.
+
+  \return The hash value.
+
+  \throw vpException::ioError if the file cannot be read.
+*/
+uint64_t vpMbtCompiledModel::computeFileHash(const std::string &filename)
+{
+  std::ifstream file(filename.c_str(), std::ios::in | std::ios::binary);
+  if (!file.is_open()) {
+    throw vpException(vpException::ioError, "Cannot read file: %s", filename.c_str());
+  }
+
+  uint64_t hash = computeHash(NULL, 0);
+  std::vector<char> chunk(1 << 16);
+  while (file) {
+    file.read(&chunk[0], static_cast<std::streamsize>(chunk.size()));
+    hash = computeHash(&chunk[0], static_cast<size_t>(file.gcount()), hash);
+  }
+
+  return hash;
+}
+
+/*!
+  Return the name of a primitive.
+*/
+std::string vpMbtCompiledModel::getName(const vpPrimitive &primitive) const
+{
+  return std::string(m_strings + primitive.nameOffset, primitive.nameLength);
+}
+
+/*!
+  Return a point of a primitive.
+
+  \param primitive : The primitive.
+  \param index : Index of the point, lower than \e primitive.nbPoints.
+*/
+vpPoint vpMbtCompiledModel::getPoint(const vpPrimitive &primitive, unsigned int index) const
+{
+  const double *coords = m_points + 3 * (primitive.firstPoint + index);
+  vpPoint pt;
+  pt.setWorldCoordinates(coords[0], coords[1], coords[2]);
+
+  return pt;
+}
+
+/*!
+  Return all the points of a primitive.
+
+  \param primitive : The primitive.
+  \param points : The points of the primitive.
+*/
+void vpMbtCompiledModel::getPoints(const vpPrimitive &primitive, std::vector<vpPoint> &points) const
+{
+  points.resize(primitive.nbPoints);
+  for (unsigned int i = 0; i < primitive.nbPoints; i++) {
+    points[i] = getPoint(primitive, i);
+  }
+}
+
+/*!
+  Return a primitive.
+
+  \param index : Index of the primitive, lower than getNbPrimitives().
+*/
+const vpMbtCompiledModel::vpPrimitive &vpMbtCompiledModel::getPrimitive(unsigned int index) const
+{
+  if (index >= m_nbPrimitives) {
+    throw vpException(vpException::dimensionError, "Primitive index %d out of range", index);
+  }
+
+  return m_primitives[index];
+}
+
+/*!
+  Return the number of points, lines, polygon lines, polygon points,
+  cylinders and circles declared in the model files.
+*/
+std::vector<unsigned int> vpMbtCompiledModel::getStatistics() const { return m_statistics; }
+
+/*!
+  Load a compiled model. The primitives are read in place from the
+  memory-mapped file when memory mapping is available.
+
+  \param filename : Path to the compiled model.
+  \param settingsHash : Hash of the current settings, compared to the one
+  stored in the file.
+
+  \return True if the compiled model was loaded, false if the file does not
+  exist, is corrupted, was produced by an other version or on a machine with
+  a different byte order, or if the settings or one of the source files
+  changed since it was saved.
+*/
+bool vpMbtCompiledModel::load(const std::string &filename, uint64_t settingsHash)
+{
+  clear();
+
+  const char *data = NULL;
+  size_t size = 0;
+#if defined(VP_MBT_COMPILED_MODEL_MMAP)
+  int fd = open(filename.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(vpCompiledModelHeader))) {
+    close(fd);
+    return false;
+  }
+  size = static_cast<size_t>(st.st_size);
+  void *mapped = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (mapped == MAP_FAILED) {
+    return false;
+  }
+  m_mapped = mapped;
+  m_mappedSize = size;
+  data = static_cast<const char *>(mapped);
+#else
+  std::ifstream file(filename.c_str(), std::ios::in | std::ios::binary | std::ios::ate);
+  if (!file.is_open()) {
+    return false;
+  }
+  size = static_cast<size_t>(file.tellg());
+  if (size < sizeof(vpCompiledModelHeader)) {
+    return false;
+  }
+  // Use a buffer of double to keep the records aligned
+  m_buffer.resize((size + sizeof(double) - 1) / sizeof(double));
+  file.seekg(0, std::ios::beg);
+  file.read(reinterpret_cast<char *>(&m_buffer[0]), static_cast<std::streamsize>(size));
+  if (!file) {
+    clear();
+    return false;
+  }
+  data = reinterpret_cast<const char *>(&m_buffer[0]);
+#endif
+
+  const vpCompiledModelHeader *header = reinterpret_cast<const vpCompiledModelHeader *>(data);
+  if (std::memcmp(header->magic, compiledModelMagic, sizeof(compiledModelMagic)) != 0 ||
+      header->version != compiledModelVersion || header->byteOrder != compiledModelByteOrder ||
+      header->settingsHash != settingsHash || header->fileSize != size || !hasExpectedFileSize(*header, size)) {
+    clear();
+    return false;
+  }
+
+  const vpCompiledModelSource *sources =
+      reinterpret_cast<const vpCompiledModelSource *>(data + sizeof(vpCompiledModelHeader));
+  const vpPrimitive *primitives = reinterpret_cast<const vpPrimitive *>(sources + header->nbSources);
+  const double *points = reinterpret_cast<const double *>(primitives + header->nbPrimitives);
+  const char *strings = reinterpret_cast<const char *>(points + header->nbPointValues);
+
+  // Invalidate the compiled model when a source file changed
+  for (uint32_t i = 0; i < header->nbSources; i++) {
+    if (!isInTable(sources[i].nameOffset, sources[i].nameLength, header->stringTableSize)) {
+      clear();
+      return false;
+    }
+    std::string sourceName(strings + sources[i].nameOffset, static_cast<size_t>(sources[i].nameLength));
+    try {
+      if (computeFileHash(sourceName) != sources[i].hash) {
+        clear();
+        return false;
+      }
+    } catch (const vpException &) {
+      clear();
+      return false;
+    }
+    m_sourceNames.push_back(sourceName);
+    m_sourceHashes.push_back(sources[i].hash);
+  }
+
+  for (uint32_t i = 0; i < header->nbPrimitives; i++) {
+    const vpPrimitive &primitive = primitives[i];
+    if (primitive.type > CIRCLE || (primitive.type == CYLINDER && primitive.nbPoints != 2) ||
+        (primitive.type == CIRCLE && primitive.nbPoints != 3) ||
+        !isInTable(3 * static_cast<uint64_t>(primitive.firstPoint), 3 * static_cast<uint64_t>(primitive.nbPoints),
+                   header->nbPointValues) ||
+        !isInTable(primitive.nameOffset, primitive.nameLength, header->stringTableSize)) {
+      clear();
+      return false;
+    }
+  }
+
+  m_settingsHash = header->settingsHash;
+  m_statistics.assign(header->statistics, header->statistics + compiledModelNbStatistics);
+  m_nbPrimitives = header->nbPrimitives;
+  m_primitives = primitives;
+  m_points = points;
+  m_strings = strings;
+
+  return true;
+}
+
+/*!
+  Save the compiled model. The file is first written to a temporary file
+  which is then renamed, so that a concurrent load() never sees a partially
+  written file.
+
+  \param filename : Path to the compiled model.
+
+  \throw vpException::ioError if the file cannot be written.
+*/
+void vpMbtCompiledModel::save(const std::string &filename) const
+{
+  uint64_t nbPointValues = 0;
+  size_t stringTableSize = 0;
+  for (unsigned int i = 0; i < m_nbPrimitives; i++) {
+    nbPointValues =
+        std::max(nbPointValues, 3 * (static_cast<uint64_t>(m_primitives[i].firstPoint) + m_primitives[i].nbPoints));
+    stringTableSize = std::max(stringTableSize, static_cast<size_t>(m_primitives[i].nameOffset) + m_primitives[i].nameLength);
+  }
+
+  std::string strings(m_strings != NULL ? m_strings : "", stringTableSize);
+  std::vector<vpCompiledModelSource> sources(m_sourceNames.size());
+  for (size_t i = 0; i < m_sourceNames.size(); i++) {
+    sources[i].hash = m_sourceHashes[i];
+    sources[i].nameOffset = strings.size();
+    sources[i].nameLength = m_sourceNames[i].size();
+    strings += m_sourceNames[i];
+  }
+
+  vpCompiledModelHeader header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, compiledModelMagic, sizeof(compiledModelMagic));
+  header.version = compiledModelVersion;
+  header.byteOrder = compiledModelByteOrder;
+  header.settingsHash = m_settingsHash;
+  for (unsigned int i = 0; i < compiledModelNbStatistics; i++) {
+    header.statistics[i] = m_statistics[i];
+  }
+  header.nbSources = static_cast<uint32_t>(sources.size());
+  header.nbPrimitives = m_nbPrimitives;
+  header.nbPointValues = nbPointValues;
+  header.stringTableSize = strings.size();
+  header.fileSize = expectedFileSize(header);
+
+  std::string tmpFilename = filename + ".tmp";
+  {
+    std::ofstream file(tmpFilename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+      throw vpException(vpException::ioError, "Cannot write compiled model: %s", tmpFilename.c_str());
+    }
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    if (!sources.empty()) {
+      file.write(reinterpret_cast<const char *>(&sources[0]),
+                 static_cast<std::streamsize>(sources.size() * sizeof(vpCompiledModelSource)));
+    }
+    if (m_nbPrimitives > 0) {
+      file.write(reinterpret_cast<const char *>(m_primitives),
+                 static_cast<std::streamsize>(m_nbPrimitives * sizeof(vpPrimitive)));
+    }
+    if (nbPointValues > 0) {
+      file.write(reinterpret_cast<const char *>(m_points), static_cast<std::streamsize>(nbPointValues * sizeof(double)));
+    }
+    file.write(strings.c_str(), static_cast<std::streamsize>(strings.size()));
+    if (!file) {
+      file.close();
+      std::remove(tmpFilename.c_str());
+      throw vpException(vpException::ioError, "Cannot write compiled model: %s", tmpFilename.c_str());
+    }
+  }
+
+#if defined(_WIN32)
+  std::remove(filename.c_str());
+#endif
+  if (std::rename(tmpFilename.c_str(), filename.c_str()) != 0) {
+    std::remove(tmpFilename.c_str());
+    throw vpException(vpException::ioError, "Cannot write compiled model: %s", filename.c_str());
+  }
+}
+
+/*!
+  Set the number of points, lines, polygon lines, polygon points, cylinders
+  and circles declared in the model files.
+*/
+void vpMbtCompiledModel::setStatistics(const std::vector<unsigned int> &statistics)
+{
+  if (statistics.size() != compiledModelNbStatistics) {
+    throw vpException(vpException::dimensionError, "Compiled model statistics must have %d elements",
+                      compiledModelNbStatistics);
+  }
+  m_statistics = statistics;
+}
+
+void vpMbtCompiledModel::unmap()
+{
+#if defined(VP_MBT_COMPILED_MODEL_MMAP)
+  if (m_mapped != NULL) {
+    munmap(m_mapped, m_mappedSize);
+  }
+#endif
+  m_mapped = NULL;
+  m_mappedSize = 0;
+  m_buffer.clear();
+}
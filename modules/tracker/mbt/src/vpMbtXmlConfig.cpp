@@ -0,0 +1,340 @@
+/****************************************************************************
+ *
+ * ViSP, open source Visual Servoing Platform software.
+ * Copyright (C) 2005 - 2019 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Parsed configuration of the model-based trackers.
+ *
+ *****************************************************************************/
+
+#include <visp3/core/vpConfig.h>
+
+#ifdef VISP_HAVE_PUGIXML
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#include <visp3/core/vpException.h>
+#include <visp3/mbt/vpMbtXmlConfig.h>
+#include <visp3/mbt/vpMbtXmlGenericParser.h>
+
+#include <pugixml.hpp>
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+namespace
+{
+const char xmlConfigMagic[8] = {'V', 'P', 'M', 'B', 'T', 'X', 'C', '\0'};
+// Increase when the layout of the file changes
+const uint32_t xmlConfigVersion = 1;
+// Written in native byte order, used to detect a file produced on a machine
+// with a different endianness
+const uint32_t xmlConfigByteOrder = 0x01020304;
+
+struct vpXmlConfigHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t byteOrder;
+  uint32_t nbNodes;
+  uint32_t reserved;
+  uint64_t stringTableSize;
+  uint64_t fileSize;
+};
+
+uint64_t expectedFileSize(const vpXmlConfigHeader &header)
+{
+  return sizeof(vpXmlConfigHeader) + static_cast<uint64_t>(header.nbNodes) * sizeof(vpMbtXmlConfig::vpNode) +
+         header.stringTableSize;
+}
+
+uint32_t appendString(std::string &table, const char *str)
+{
+  uint32_t offset = static_cast<uint32_t>(table.size());
+  table += str;
+  return offset;
+}
+
+// Append an element and the elements known by the parser below it, in
+// depth-first order. Return the index of the element.
+int32_t appendNode(const pugi::xml_node &node, std::vector<vpMbtXmlConfig::vpNode> &nodes, std::string &table)
+{
+  vpMbtXmlConfig::vpNode record;
+  std::memset(&record, 0, sizeof(record));
+  record.id = vpMbtXmlGenericParser::getNodeId(node.name());
+  record.nameOffset = appendString(table, node.name());
+  record.nameLength = static_cast<uint32_t>(table.size()) - record.nameOffset;
+  record.textOffset = appendString(table, node.text().as_string());
+  record.textLength = static_cast<uint32_t>(table.size()) - record.textOffset;
+  record.firstChild = -1;
+  record.nextSibling = -1;
+  record.asInt = node.text().as_int();
+  record.asUint = node.text().as_uint();
+  record.asDouble = node.text().as_double();
+
+  int32_t index = static_cast<int32_t>(nodes.size());
+  nodes.push_back(record);
+
+  int32_t previous = -1;
+  for (pugi::xml_node child = node.first_child(); child; child = child.next_sibling()) {
+    // The parser only reads the elements whose name it knows
+    if (child.type() != pugi::node_element || vpMbtXmlGenericParser::getNodeId(child.name()) < 0) {
+      continue;
+    }
+    int32_t childIndex = appendNode(child, nodes, table);
+    if (previous < 0) {
+      nodes[static_cast<size_t>(index)].firstChild = childIndex;
+    } else {
+      nodes[static_cast<size_t>(previous)].nextSibling = childIndex;
+    }
+    previous = childIndex;
+  }
+
+  return index;
+}
+} // namespace
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+/*!
+  Default constructor that creates an empty configuration.
+*/
+vpMbtXmlConfig::vpMbtXmlConfig() : m_nodes(), m_stringTable() {}
+
+/*!
+  Create a configuration from an XML configuration file.
+
+  \param filename : XML configuration file of the model-based tracker.
+
+  \sa parse()
+*/
+vpMbtXmlConfig::vpMbtXmlConfig(const std::string &filename) : m_nodes(), m_stringTable() { parse(filename); }
+
+/*!
+  Remove all the elements of the configuration.
+*/
+void vpMbtXmlConfig::clear()
+{
+  m_nodes.clear();
+  m_stringTable.clear();
+}
+
+/*!
+  Decode a configuration encoded by encode().
+
+  \param data : Encoded configuration.
+  \param size : Size in bytes of the encoded configuration.
+
+  \exception vpException::badValue : If the data is not a valid encoded
+  configuration, or has been encoded by another version of ViSP or on a
+  machine with a different byte order.
+*/
+void vpMbtXmlConfig::decode(const unsigned char *data, size_t size)
+{
+  clear();
+
+  vpXmlConfigHeader header;
+  if (size < sizeof(header)) {
+    throw vpException(vpException::badValue, "Invalid tracker configuration: truncated data");
+  }
+  std::memcpy(&header, data, sizeof(header));
+  if (std::memcmp(header.magic, xmlConfigMagic, sizeof(xmlConfigMagic)) != 0 || header.version != xmlConfigVersion ||
+      header.byteOrder != xmlConfigByteOrder) {
+    throw vpException(vpException::badValue, "Invalid tracker configuration: bad header");
+  }
+  if (header.fileSize != size || expectedFileSize(header) != size) {
+    throw vpException(vpException::badValue, "Invalid tracker configuration: bad size");
+  }
+
+  std::vector<vpNode> nodes(header.nbNodes);
+  if (header.nbNodes > 0) {
+    std::memcpy(&nodes[0], data + sizeof(header), header.nbNodes * sizeof(vpNode));
+  }
+  std::string strings(reinterpret_cast<const char *>(data) + sizeof(header) + header.nbNodes * sizeof(vpNode),
+                      static_cast<size_t>(header.stringTableSize));
+
+  // The links always point forward, so that a corrupted file can't make the
+  // parser loop
+  const int32_t nbNodes = static_cast<int32_t>(header.nbNodes);
+  for (int32_t i = 0; i < nbNodes; i++) {
+    vpNode &node = nodes[static_cast<size_t>(i)];
+    if (static_cast<uint64_t>(node.nameOffset) + node.nameLength > header.stringTableSize ||
+        static_cast<uint64_t>(node.textOffset) + node.textLength > header.stringTableSize ||
+        (node.firstChild != -1 && (node.firstChild <= i || node.firstChild >= nbNodes)) ||
+        (node.nextSibling != -1 && (node.nextSibling <= i || node.nextSibling >= nbNodes))) {
+      throw vpException(vpException::badValue, "Invalid tracker configuration: bad element %d", i);
+    }
+    // The identifiers may change between two versions of ViSP
+    node.id = vpMbtXmlGenericParser::getNodeId(strings.substr(node.nameOffset, node.nameLength));
+  }
+
+  m_nodes.swap(nodes);
+  m_stringTable.swap(strings);
+}
+
+/*!
+  Encode the configuration in a binary buffer, that can be decoded by
+  decode() on a machine with the same byte order.
+
+  \param data : Encoded configuration.
+*/
+void vpMbtXmlConfig::encode(std::vector<unsigned char> &data) const
+{
+  vpXmlConfigHeader header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, xmlConfigMagic, sizeof(xmlConfigMagic));
+  header.version = xmlConfigVersion;
+  header.byteOrder = xmlConfigByteOrder;
+  header.nbNodes = static_cast<uint32_t>(m_nodes.size());
+  header.stringTableSize = m_stringTable.size();
+  header.fileSize = expectedFileSize(header);
+
+  data.resize(static_cast<size_t>(header.fileSize));
+  std::memcpy(&data[0], &header, sizeof(header));
+  if (!m_nodes.empty()) {
+    std::memcpy(&data[sizeof(header)], &m_nodes[0], m_nodes.size() * sizeof(vpNode));
+  }
+  if (!m_stringTable.empty()) {
+    std::memcpy(&data[sizeof(header) + m_nodes.size() * sizeof(vpNode)], m_stringTable.c_str(), m_stringTable.size());
+  }
+}
+
+/*!
+  Return the name of an element.
+*/
+std::string vpMbtXmlConfig::getName(const vpNode &node) const
+{
+  return m_stringTable.substr(node.nameOffset, node.nameLength);
+}
+
+/*!
+  Return an element of the configuration.
+
+  \param index : Index of the element, lower than getNbNodes().
+*/
+const vpMbtXmlConfig::vpNode &vpMbtXmlConfig::getNode(unsigned int index) const
+{
+  if (index >= m_nodes.size()) {
+    throw vpException(vpException::dimensionError, "Out of range element index: %u", index);
+  }
+  return m_nodes[index];
+}
+
+/*!
+  Return the text of an element.
+*/
+std::string vpMbtXmlConfig::getText(const vpNode &node) const
+{
+  return m_stringTable.substr(node.textOffset, node.textLength);
+}
+
+/*!
+  Load a configuration saved by save().
+
+  \param filename : Binary configuration file.
+
+  \exception vpException::ioError : If the file can't be read.
+  \exception vpException::badValue : If the file is not a valid configuration.
+*/
+void vpMbtXmlConfig::load(const std::string &filename)
+{
+  std::ifstream file(filename.c_str(), std::ios::in | std::ios::binary | std::ios::ate);
+  if (!file.is_open()) {
+    throw vpException(vpException::ioError, "Cannot open tracker configuration: %s", filename.c_str());
+  }
+  std::vector<unsigned char> data(static_cast<size_t>(file.tellg()));
+  file.seekg(0, std::ios::beg);
+  if (!data.empty()) {
+    file.read(reinterpret_cast<char *>(&data[0]), static_cast<std::streamsize>(data.size()));
+  }
+  if (!file || data.empty()) {
+    throw vpException(vpException::ioError, "Cannot read tracker configuration: %s", filename.c_str());
+  }
+  decode(&data[0], data.size());
+}
+
+/*!
+  Parse an XML configuration file of the model-based tracker.
+
+  \param filename : XML configuration file.
+
+  \exception vpException::ioError : If the file can't be opened or parsed.
+*/
+void vpMbtXmlConfig::parse(const std::string &filename)
+{
+  pugi::xml_document doc;
+  if (!doc.load_file(filename.c_str())) {
+    throw vpException(vpException::ioError, "Cannot open file: %s", filename.c_str());
+  }
+
+  std::vector<vpNode> nodes;
+  std::string strings;
+  appendNode(doc.document_element(), nodes, strings);
+  m_nodes.swap(nodes);
+  m_stringTable.swap(strings);
+}
+
+/*!
+  Save the configuration in a binary file, that can be read by load() on a
+  machine with the same byte order.
+
+  \param filename : Binary configuration file.
+
+  \exception vpException::ioError : If the file can't be written.
+*/
+void vpMbtXmlConfig::save(const std::string &filename) const
+{
+  std::vector<unsigned char> data;
+  encode(data);
+
+  std::string tmpFilename = filename + ".tmp";
+  {
+    std::ofstream file(tmpFilename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+      throw vpException(vpException::ioError, "Cannot write tracker configuration: %s", tmpFilename.c_str());
+    }
+    file.write(reinterpret_cast<const char *>(&data[0]), static_cast<std::streamsize>(data.size()));
+    if (!file) {
+      file.close();
+      std::remove(tmpFilename.c_str());
+      throw vpException(vpException::ioError, "Cannot write tracker configuration: %s", tmpFilename.c_str());
+    }
+  }
+
+#if defined(_WIN32)
+  std::remove(filename.c_str());
+#endif
+  if (std::rename(tmpFilename.c_str(), filename.c_str()) != 0) {
+    std::remove(tmpFilename.c_str());
+    throw vpException(vpException::ioError, "Cannot write tracker configuration: %s", filename.c_str());
+  }
+}
+
+#elif !defined(VISP_BUILD_SHARED_LIBS)
+// Work arround to avoid warning: libvisp_mbt.a(vpMbtXmlConfig.cpp.o) has no symbols
+void dummy_vpMbtXmlConfig(){};
+#endif
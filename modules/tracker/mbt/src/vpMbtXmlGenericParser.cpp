@@ -40,11 +40,68 @@
 #include <map>
 #include <clocale>
 
+#include <visp3/mbt/vpMbtXmlConfig.h>
 #include <visp3/mbt/vpMbtXmlGenericParser.h>
 
 #include <pugixml.hpp>
 
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
+namespace
+{
+// Element of an XML document, whose identifier is looked up by name
+class vpDomNode
+{
+public:
+  vpDomNode(const pugi::xml_node &node, const std::map<std::string, int> *nodeMap) : m_node(node), m_nodeMap(nodeMap)
+  {
+  }
+
+  bool empty() const { return m_node.empty(); }
+  vpDomNode first_child() const { return vpDomNode(m_node.first_child(), m_nodeMap); }
+  int id() const
+  {
+    std::map<std::string, int>::const_iterator iter_data = m_nodeMap->find(m_node.name());
+    return iter_data != m_nodeMap->end() ? iter_data->second : -1;
+  }
+  bool isElement() const { return m_node.type() == pugi::node_element; }
+  vpDomNode next_sibling() const { return vpDomNode(m_node.next_sibling(), m_nodeMap); }
+
+  double as_double() const { return m_node.text().as_double(); }
+  int as_int() const { return m_node.text().as_int(); }
+  std::string as_string() const { return m_node.text().as_string(); }
+  unsigned int as_uint() const { return m_node.text().as_uint(); }
+
+private:
+  pugi::xml_node m_node;
+  const std::map<std::string, int> *m_nodeMap;
+};
+
+// Element of a parsed configuration, whose identifier and values are
+// already resolved
+class vpConfigNode
+{
+public:
+  vpConfigNode(const vpMbtXmlConfig *config, int index) : m_config(config), m_index(index) {}
+
+  bool empty() const { return m_index < 0; }
+  vpConfigNode first_child() const { return vpConfigNode(m_config, node().firstChild); }
+  int id() const { return node().id; }
+  bool isElement() const { return true; }
+  vpConfigNode next_sibling() const { return vpConfigNode(m_config, node().nextSibling); }
+
+  double as_double() const { return node().asDouble; }
+  int as_int() const { return node().asInt; }
+  std::string as_string() const { return m_config->getText(node()); }
+  unsigned int as_uint() const { return node().asUint; }
+
+private:
+  const vpMbtXmlConfig::vpNode &node() const { return m_config->getNode(static_cast<unsigned int>(m_index)); }
+
+  const vpMbtXmlConfig *m_config;
+  int m_index;
+};
+} // namespace
+
 class vpMbtXmlGenericParser::Impl
 {
 public:
@@ -61,7 +118,7 @@ public:
         m_ecm(),
         //<klt>
         m_kltMaskBorder(0), m_kltMaxFeatures(0), m_kltWinSize(0), m_kltQualityValue(0.), m_kltMinDist(0.),
-        m_kltHarrisParam(0.), m_kltBlockSize(0), m_kltPyramidLevels(0),
+        m_kltHarrisParam(0.), m_kltBlockSize(0), m_kltPyramidLevels(0), m_kltUseNative(false),
         //<depth_normal>
         m_depthNormalFeatureEstimationMethod(vpMbtFaceDepthNormal::ROBUST_FEATURE_ESTIMATION),
         m_depthNormalPclPlaneEstimationMethod(2), m_depthNormalPclPlaneEstimationRansacMaxIter(200),
@@ -82,6 +139,25 @@ public:
       throw vpException(vpException::ioError, "Cannot open file: %s", filename.c_str());
     }
 
+    read_root(vpDomNode(doc.document_element(), &m_nodeMap));
+  }
+
+  void parse(const vpMbtXmlConfig &config)
+  {
+    if (config.empty()) {
+      throw vpException(vpException::notInitialized, "The tracker configuration is empty");
+    }
+
+    read_root(vpConfigNode(&config, 0));
+  }
+
+  /*!
+    Read the root element of the configuration.
+
+    \param root_node : Root element.
+  */
+  template <class Node> void read_root(const Node &root_node)
+  {
     bool camera_node = false;
     bool face_node = false;
     bool ecm_node = false;
@@ -91,12 +167,11 @@ public:
     bool depth_dense_node = false;
     bool projection_error_node = false;
 
-    pugi::xml_node root_node = doc.document_element();
-    for (pugi::xml_node dataNode = root_node.first_child(); dataNode; dataNode = dataNode.next_sibling()) {
-      if (dataNode.type() == pugi::node_element) {
-        std::map<std::string, int>::const_iterator iter_data = m_nodeMap.find(dataNode.name());
-        if (iter_data != m_nodeMap.end()) {
-          switch (iter_data->second) {
+    for (Node dataNode = root_node.first_child(); !dataNode.empty(); dataNode = dataNode.next_sibling()) {
+      if (dataNode.isElement()) {
+        const int id = dataNode.id();
+        if (id >= 0) {
+          switch (id) {
           case camera:
             if (m_parserType != PROJECTION_ERROR_PARSER) {
               read_camera(dataNode);
@@ -209,6 +284,7 @@ public:
         std::cout << "klt : Harris Parameter : " << m_kltHarrisParam << " (default)" << std::endl;
         std::cout << "klt : Block Size : " << m_kltBlockSize << " (default)" << std::endl;
         std::cout << "klt : Pyramid Levels : " << m_kltPyramidLevels << " (default)" << std::endl;
+        std::cout << "klt : Use Native : " << m_kltUseNative << " (default)" << std::endl;
       }
 
       if (!depth_normal_node && (m_parserType & DEPTH_NORMAL_PARSER)) {
@@ -236,7 +312,7 @@ public:
 
     \param node : Pointer to the node of the camera information.
   */
-  void read_camera(const pugi::xml_node &node)
+  template <class Node> void read_camera(const Node &node)
   {
     bool u0_node = false;
     bool v0_node = false;
@@ -249,28 +325,28 @@ public:
     double d_px = m_cam.get_px();
     double d_py = m_cam.get_py();
 
-    for (pugi::xml_node dataNode = node.first_child(); dataNode; dataNode = dataNode.next_sibling()) {
-      if (dataNode.type() == pugi::node_element) {
-        std::map<std::string, int>::const_iterator iter_data = m_nodeMap.find(dataNode.name());
-        if (iter_data != m_nodeMap.end()) {
-          switch (iter_data->second) {
+    for (Node dataNode = node.first_child(); !dataNode.empty(); dataNode = dataNode.next_sibling()) {
+      if (dataNode.isElement()) {
+        const int id = dataNode.id();
+        if (id >= 0) {
+          switch (id) {
           case u0:
-            d_u0 = dataNode.text().as_double();
+            d_u0 = dataNode.as_double();
             u0_node = true;
             break;
 
           case v0:
-            d_v0 = dataNode.text().as_double();
+            d_v0 = dataNode.as_double();
             v0_node = true;
             break;
 
           case px:
-            d_px = dataNode.text().as_double();
+            d_px = dataNode.as_double();
             px_node = true;
             break;
 
           case py:
-            d_py = dataNode.text().as_double();
+            d_py = dataNode.as_double();
             py_node = true;
             break;
 
@@ -309,20 +385,20 @@ public:
 
     \param node : Pointer to the node information.
   */
-  void read_depth_normal(const pugi::xml_node &node)
+  template <class Node> void read_depth_normal(const Node &node)
   {
     bool feature_estimation_method_node = false;
     bool PCL_plane_estimation_node = false;
     bool sampling_step_node = false;
 
-    for (pugi::xml_node dataNode = node.first_child(); dataNode; dataNode = dataNode.next_sibling()) {
-      if (dataNode.type() == pugi::node_element) {
-        std::map<std::string, int>::const_iterator iter_data = m_nodeMap.find(dataNode.name());
-        if (iter_data != m_nodeMap.end()) {
-          switch (iter_data->second) {
+    for (Node dataNode = node.first_child(); !dataNode.empty(); dataNode = dataNode.next_sibling()) {
+      if (dataNode.isElement()) {
+        const int id = dataNode.id();
+        if (id >= 0) {
+          switch (id) {
           case feature_estimation_method:
             m_depthNormalFeatureEstimationMethod =
-                (vpMbtFaceDepthNormal::vpFeatureEstimationType)dataNode.text().as_int();
+                (vpMbtFaceDepthNormal::vpFeatureEstimationType)dataNode.as_int();
             feature_estimation_method_node = true;
             break;
 
@@ -369,29 +445,29 @@ public:
 
     \param node : Pointer to the node information.
   */
-  void read_depth_normal_PCL(const pugi::xml_node &node)
+  template <class Node> void read_depth_normal_PCL(const Node &node)
   {
     bool PCL_plane_estimation_method_node = false;
     bool PCL_plane_estimation_ransac_max_iter_node = false;
     bool PCL_plane_estimation_ransac_threshold_node = false;
 
-    for (pugi::xml_node dataNode = node.first_child(); dataNode; dataNode = dataNode.next_sibling()) {
-      if (dataNode.type() == pugi::node_element) {
-        std::map<std::string, int>::const_iterator iter_data = m_nodeMap.find(dataNode.name());
-        if (iter_data != m_nodeMap.end()) {
-          switch (iter_data->second) {
+    for (Node dataNode = node.first_child(); !dataNode.empty(); dataNode = dataNode.next_sibling()) {
+      if (dataNode.isElement()) {
+        const int id = dataNode.id();
+        if (id >= 0) {
+          switch (id) {
           case PCL_plane_estimation_method:
-            m_depthNormalPclPlaneEstimationMethod = dataNode.text().as_int();
+            m_depthNormalPclPlaneEstimationMethod = dataNode.as_int();
             PCL_plane_estimation_method_node = true;
             break;
 
           case PCL_plane_estimation_ransac_max_iter:
-            m_depthNormalPclPlaneEstimationRansacMaxIter = dataNode.text().as_int();
+            m_depthNormalPclPlaneEstimationRansacMaxIter = dataNode.as_int();
             PCL_plane_estimation_ransac_max_iter_node = true;
             break;
 
           case PCL_plane_estimation_ransac_threshold:
-            m_depthNormalPclPlaneEstimationRansacThreshold = dataNode.text().as_double();
+            m_depthNormalPclPlaneEstimationRansacThreshold = dataNode.as_double();
             PCL_plane_estimation_ransac_threshold_node = true;
             break;
 
@@ -429,23 +505,23 @@ public:
 
     \param node : Pointer to the node information.
   */
-  void read_depth_normal_sampling_step(const pugi::xml_node &node)
+  template <class Node> void read_depth_normal_sampling_step(const Node &node)
   {
     bool sampling_step_X_node = false;
     bool sampling_step_Y_node = false;
 
-    for (pugi::xml_node dataNode = node.first_child(); dataNode; dataNode = dataNode.next_sibling()) {
-      if (dataNode.type() == pugi::node_element) {
-        std::map<std::string, int>::const_iterator iter_data = m_nodeMap.find(dataNode.name());
-        if (iter_data != m_nodeMap.end()) {
-          switch (iter_data->second) {
+    for (Node dataNode = node.first_child(); !dataNode.empty(); dataNode = dataNode.next_sibling()) {
+      if (dataNode.isElement()) {
+        const int id = dataNode.id();
+        if (id >= 0) {
+          switch (id) {
           case depth_sampling_step_X:
-            m_depthNormalSamplingStepX = dataNode.text().as_uint();
+            m_depthNormalSamplingStepX = dataNode.as_uint();
             sampling_step_X_node = true;
             break;
 
           case depth_sampling_step_Y:
-            m_depthNormalSamplingStepY = dataNode.text().as_uint();
+            m_depthNormalSamplingStepY = dataNode.as_uint();
             sampling_step_Y_node = true;
             break;
 
@@ -472,15 +548,15 @@ public:
 
     \param node : Pointer to the node of the ecm information.
   */
-  void read_depth_dense(const pugi::xml_node &node)
+  template <class Node> void read_depth_dense(const Node &node)
   {
     bool sampling_step_node = false;
 
-    for (pugi::xml_node dataNode = node.first_child(); dataNode; dataNode = dataNode.next_sibling()) {
-      if (dataNode.type() == pugi::node_element) {
-        std::map<std::string, int>::const_iterator iter_data = m_nodeMap.find(dataNode.name());
-        if (iter_data != m_nodeMap.end()) {
-          switch (iter_data->second) {
+    for (Node dataNode = node.first_child(); !dataNode.empty(); dataNode = dataNode.next_sibling()) {
+      if (dataNode.isElement()) {
+        const int id = dataNode.id();
+        if (id >= 0) {
+          switch (id) {
           case depth_dense_sampling_step:
             read_depth_dense_sampling_step(dataNode);
             sampling_step_node = true;
@@ -504,23 +580,23 @@ public:
 
     \param node : Pointer to the node of the range information.
   */
-  void read_depth_dense_sampling_step(const pugi::xml_node &node)
+  template <class Node> void read_depth_dense_sampling_step(const Node &node)
   {
     bool sampling_step_X_node = false;
     bool sampling_step_Y_node = false;
 
-    for (pugi::xml_node dataNode = node.first_child(); dataNode; dataNode = dataNode.next_sibling()) {
-      if (dataNode.type() == pugi::node_element) {
-        std::map<std::string, int>::const_iterator iter_data = m_nodeMap.find(dataNode.name());
-        if (iter_data != m_nodeMap.end()) {
-          switch (iter_data->second) {
+    for (Node dataNode = node.first_child(); !dataNode.empty(); dataNode = dataNode.next_sibling()) {
+      if (dataNode.isElement()) {
+        const int id = dataNode.id();
+        if (id >= 0) {
+          switch (id) {
           case depth_dense_sampling_step_X:
-            m_depthDenseSamplingStepX = dataNode.text().as_uint();
+            m_depthDenseSamplingStepX = dataNode.as_uint();
             sampling_step_X_node = true;
             break;
 
           case depth_dense_sampling_step_Y:
-            m_depthDenseSamplingStepY = dataNode.text().as_uint();
+            m_depthDenseSamplingStepY = dataNode.as_uint();
             sampling_step_Y_node = true;
             break;
 
@@ -547,18 +623,18 @@ public:
 
     \param node : Pointer to the node of the ecm information.
   */
-  void read_ecm(const pugi::xml_node &node)
+  template <class Node> void read_ecm(const Node &node)
   {
     bool mask_node = false;
     bool range_node = false;
     bool contrast_node = false;
     bool sample_node = false;
 
-    for (pugi::xml_node dataNode = node.first_child(); dataNode; dataNode = dataNode.next_sibling()) {
-      if (dataNode.type() == pugi::node_element) {
-        std::map<std::string, int>::const_iterator iter_data = m_nodeMap.find(dataNode.name());
-        if (iter_data != m_nodeMap.end()) {
-          switch (iter_data->second) {
+    for (Node dataNode = node.first_child(); !dataNode.empty(); dataNode = dataNode.next_sibling()) {
+      if (dataNode.isElement()) {
+        const int id = dataNode.id();
+        if (id >= 0) {
+          switch (id) {
           case mask:
             read_ecm_mask(dataNode);
             mask_node = true;
@@ -611,7 +687,7 @@ public:
 
     \param node : Pointer to the node of the contrast information.
   */
-  void read_ecm_contrast(const pugi::xml_node &node)
+  template <class Node> void read_ecm_contrast(const Node &node)
   {
     bool edge_threshold_node = false;
     bool mu1_node = false;
@@ -622,23 +698,23 @@ public:
     double d_mu1 = m_ecm.getMu1();
     double d_mu2 = m_ecm.getMu2();
 
-    for (pugi::xml_node dataNode = node.first_child(); dataNode; dataNode = dataNode.next_sibling()) {
-      if (dataNode.type() == pugi::node_element) {
-        std::map<std::string, int>::const_iterator iter_data = m_nodeMap.find(dataNode.name());
-        if (iter_data != m_nodeMap.end()) {
-          switch (iter_data->second) {
+    for (Node dataNode = node.first_child(); !dataNode.empty(); dataNode = dataNode.next_sibling()) {
+      if (dataNode.isElement()) {
+        const int id = dataNode.id();
+        if (id >= 0) {
+          switch (id) {
           case edge_threshold:
-            d_edge_threshold = dataNode.text().as_double();
+            d_edge_threshold = dataNode.as_double();
             edge_threshold_node = true;
             break;
 
           case mu1:
-            d_mu1 = dataNode.text().as_double();
+            d_mu1 = dataNode.as_double();
             mu1_node = true;
             break;
 
           case mu2:
-            d_mu2 = dataNode.text().as_double();
+            d_mu2 = dataNode.as_double();
             mu2_node = true;
             break;
 
@@ -674,7 +750,7 @@ public:
 
     \param node : Pointer to the node of the mask information.
   */
-  void read_ecm_mask(const pugi::xml_node &node)
+  template <class Node> void read_ecm_mask(const Node &node)
   {
     bool size_node = false;
     bool nb_mask_node = false;
@@ -683,18 +759,18 @@ public:
     unsigned int d_size = m_ecm.getMaskSize();
     unsigned int d_nb_mask = m_ecm.getMaskNumber();
 
-    for (pugi::xml_node dataNode = node.first_child(); dataNode; dataNode = dataNode.next_sibling()) {
-      if (dataNode.type() == pugi::node_element) {
-        std::map<std::string, int>::const_iterator iter_data = m_nodeMap.find(dataNode.name());
-        if (iter_data != m_nodeMap.end()) {
-          switch (iter_data->second) {
+    for (Node dataNode = node.first_child(); !dataNode.empty(); dataNode = dataNode.next_sibling()) {
+      if (dataNode.isElement()) {
+        const int id = dataNode.id();
+        if (id >= 0) {
+          switch (id) {
           case size:
-            d_size = dataNode.text().as_uint();
+            d_size = dataNode.as_uint();
             size_node = true;
             break;
 
           case nb_mask:
-            d_nb_mask = dataNode.text().as_uint();
+            d_nb_mask = dataNode.as_uint();
             nb_mask_node = true;
             break;
 
@@ -730,20 +806,20 @@ public:
 
     \param node : Pointer to the node of the range information.
   */
-  void read_ecm_range(const pugi::xml_node &node)
+  template <class Node> void read_ecm_range(const Node &node)
   {
     bool tracking_node = false;
 
     // current data values.
     unsigned int m_range_tracking = m_ecm.getRange();
 
-    for (pugi::xml_node dataNode = node.first_child(); dataNode; dataNode = dataNode.next_sibling()) {
-      if (dataNode.type() == pugi::node_element) {
-        std::map<std::string, int>::const_iterator iter_data = m_nodeMap.find(dataNode.name());
-        if (iter_data != m_nodeMap.end()) {
-          switch (iter_data->second) {
+    for (Node dataNode = node.first_child(); !dataNode.empty(); dataNode = dataNode.next_sibling()) {
+      if (dataNode.isElement()) {
+        const int id = dataNode.id();
+        if (id >= 0) {
+          switch (id) {
           case tracking:
-            m_range_tracking = dataNode.text().as_uint();
+            m_range_tracking = dataNode.as_uint();
             tracking_node = true;
             break;
 
@@ -767,20 +843,20 @@ public:
 
     \param node : Pointer to the node of the sample information.
   */
-  void read_ecm_sample(const pugi::xml_node &node)
+  template <class Node> void read_ecm_sample(const Node &node)
   {
     bool step_node = false;
 
     // current data values.
     double d_stp = m_ecm.getSampleStep();
 
-    for (pugi::xml_node dataNode = node.first_child(); dataNode; dataNode = dataNode.next_sibling()) {
-      if (dataNode.type() == pugi::node_element) {
-        std::map<std::string, int>::const_iterator iter_data = m_nodeMap.find(dataNode.name());
-        if (iter_data != m_nodeMap.end()) {
-          switch (iter_data->second) {
+    for (Node dataNode = node.first_child(); !dataNode.empty(); dataNode = dataNode.next_sibling()) {
+      if (dataNode.isElement()) {
+        const int id = dataNode.id();
+        if (id >= 0) {
+          switch (id) {
           case step:
-            d_stp = dataNode.text().as_int();
+            d_stp = dataNode.as_int();
             step_node = true;
             break;
 
@@ -804,7 +880,7 @@ public:
 
     \param node : Pointer to the node of the camera information.
   */
-  void read_face(const pugi::xml_node &node)
+  template <class Node> void read_face(const Node &node)
   {
     bool angle_appear_node = false;
     bool angle_disappear_node = false;
@@ -814,35 +890,35 @@ public:
     m_hasNearClipping = false;
     m_hasFarClipping = false;
 
-    for (pugi::xml_node dataNode = node.first_child(); dataNode; dataNode = dataNode.next_sibling()) {
-      if (dataNode.type() == pugi::node_element) {
-        std::map<std::string, int>::const_iterator iter_data = m_nodeMap.find(dataNode.name());
-        if (iter_data != m_nodeMap.end()) {
-          switch (iter_data->second) {
+    for (Node dataNode = node.first_child(); !dataNode.empty(); dataNode = dataNode.next_sibling()) {
+      if (dataNode.isElement()) {
+        const int id = dataNode.id();
+        if (id >= 0) {
+          switch (id) {
           case angle_appear:
-            m_angleAppear = dataNode.text().as_double();
+            m_angleAppear = dataNode.as_double();
             angle_appear_node = true;
             break;
 
           case angle_disappear:
-            m_angleDisappear = dataNode.text().as_double();
+            m_angleDisappear = dataNode.as_double();
             angle_disappear_node = true;
             break;
 
           case near_clipping:
-            m_nearClipping = dataNode.text().as_double();
+            m_nearClipping = dataNode.as_double();
             m_hasNearClipping = true;
             near_clipping_node = true;
             break;
 
           case far_clipping:
-            m_farClipping = dataNode.text().as_double();
+            m_farClipping = dataNode.as_double();
             m_hasFarClipping = true;
             far_clipping_node = true;
             break;
 
           case fov_clipping:
-            if (dataNode.text().as_int())
+            if (dataNode.as_int())
               m_fovClipping = true;
             else
               m_fovClipping = false;
@@ -885,7 +961,7 @@ public:
 
     \param node : Pointer to the node of the camera information.
   */
-  void read_klt(const pugi::xml_node &node)
+  template <class Node> void read_klt(const Node &node)
   {
     bool mask_border_node = false;
     bool max_features_node = false;
@@ -895,52 +971,58 @@ public:
     bool harris_node = false;
     bool size_block_node = false;
     bool pyramid_lvl_node = false;
+    bool use_native_node = false;
 
-    for (pugi::xml_node dataNode = node.first_child(); dataNode; dataNode = dataNode.next_sibling()) {
-      if (dataNode.type() == pugi::node_element) {
-        std::map<std::string, int>::const_iterator iter_data = m_nodeMap.find(dataNode.name());
-        if (iter_data != m_nodeMap.end()) {
-          switch (iter_data->second) {
+    for (Node dataNode = node.first_child(); !dataNode.empty(); dataNode = dataNode.next_sibling()) {
+      if (dataNode.isElement()) {
+        const int id = dataNode.id();
+        if (id >= 0) {
+          switch (id) {
           case mask_border:
-            m_kltMaskBorder = dataNode.text().as_uint();
+            m_kltMaskBorder = dataNode.as_uint();
             mask_border_node = true;
             break;
 
           case max_features:
-            m_kltMaxFeatures = dataNode.text().as_uint();
+            m_kltMaxFeatures = dataNode.as_uint();
             max_features_node = true;
             break;
 
           case window_size:
-            m_kltWinSize = dataNode.text().as_uint();
+            m_kltWinSize = dataNode.as_uint();
             window_size_node = true;
             break;
 
           case quality:
-            m_kltQualityValue = dataNode.text().as_double();
+            m_kltQualityValue = dataNode.as_double();
             quality_node = true;
             break;
 
           case min_distance:
-            m_kltMinDist = dataNode.text().as_double();
+            m_kltMinDist = dataNode.as_double();
             min_distance_node = true;
             break;
 
           case harris:
-            m_kltHarrisParam = dataNode.text().as_double();
+            m_kltHarrisParam = dataNode.as_double();
             harris_node = true;
             break;
 
           case size_block:
-            m_kltBlockSize = dataNode.text().as_uint();
+            m_kltBlockSize = dataNode.as_uint();
             size_block_node = true;
             break;
 
           case pyramid_lvl:
-            m_kltPyramidLevels = dataNode.text().as_uint();
+            m_kltPyramidLevels = dataNode.as_uint();
             pyramid_lvl_node = true;
             break;
 
+          case use_native:
+            m_kltUseNative = (dataNode.as_int() != 0);
+            use_native_node = true;
+            break;
+
           default:
             break;
           }
@@ -987,31 +1069,36 @@ public:
       std::cout << "klt : Pyramid Levels : " << m_kltPyramidLevels << " (default)" << std::endl;
     else
       std::cout << "klt : Pyramid Levels : " << m_kltPyramidLevels << std::endl;
+
+    if (!use_native_node)
+      std::cout << "klt : Use Native : " << m_kltUseNative << " (default)" << std::endl;
+    else
+      std::cout << "klt : Use Native : " << m_kltUseNative << std::endl;
   }
 
-  void read_lod(const pugi::xml_node &node)
+  template <class Node> void read_lod(const Node &node)
   {
     bool use_lod_node = false;
     bool min_line_length_threshold_node = false;
     bool min_polygon_area_threshold_node = false;
 
-    for (pugi::xml_node dataNode = node.first_child(); dataNode; dataNode = dataNode.next_sibling()) {
-      if (dataNode.type() == pugi::node_element) {
-        std::map<std::string, int>::const_iterator iter_data = m_nodeMap.find(dataNode.name());
-        if (iter_data != m_nodeMap.end()) {
-          switch (iter_data->second) {
+    for (Node dataNode = node.first_child(); !dataNode.empty(); dataNode = dataNode.next_sibling()) {
+      if (dataNode.isElement()) {
+        const int id = dataNode.id();
+        if (id >= 0) {
+          switch (id) {
           case use_lod:
-            m_useLod = (dataNode.text().as_int() != 0);
+            m_useLod = (dataNode.as_int() != 0);
             use_lod_node = true;
             break;
 
           case min_line_length_threshold:
-            m_minLineLengthThreshold = dataNode.text().as_double();
+            m_minLineLengthThreshold = dataNode.as_double();
             min_line_length_threshold_node = true;
             break;
 
           case min_polygon_area_threshold:
-            m_minPolygonAreaThreshold = dataNode.text().as_double();
+            m_minPolygonAreaThreshold = dataNode.as_double();
             min_polygon_area_threshold_node = true;
             break;
 
@@ -1038,7 +1125,7 @@ public:
       std::cout << "lod : min polygon area threshold : " << m_minPolygonAreaThreshold << std::endl;
   }
 
-  void read_projection_error(const pugi::xml_node &node)
+  template <class Node> void read_projection_error(const Node &node)
   {
     bool step_node = false;
     bool kernel_size_node = false;
@@ -1047,18 +1134,18 @@ public:
     double d_stp = m_projectionErrorMe.getSampleStep();
     std::string kernel_size_str;
 
-    for (pugi::xml_node dataNode = node.first_child(); dataNode; dataNode = dataNode.next_sibling()) {
-      if (dataNode.type() == pugi::node_element) {
-        std::map<std::string, int>::const_iterator iter_data = m_nodeMap.find(dataNode.name());
-        if (iter_data != m_nodeMap.end()) {
-          switch (iter_data->second) {
+    for (Node dataNode = node.first_child(); !dataNode.empty(); dataNode = dataNode.next_sibling()) {
+      if (dataNode.isElement()) {
+        const int id = dataNode.id();
+        if (id >= 0) {
+          switch (id) {
           case projection_error_sample_step:
-            d_stp = dataNode.text().as_int();
+            d_stp = dataNode.as_int();
             step_node = true;
             break;
 
           case projection_error_kernel_size:
-            kernel_size_str = dataNode.text().as_string();
+            kernel_size_str = dataNode.as_string();
             kernel_size_node = true;
             break;
 
@@ -1106,7 +1193,7 @@ public:
 
     \param node : Pointer to the node of the sample information.
   */
-  void read_sample_deprecated(const pugi::xml_node &node)
+  template <class Node> void read_sample_deprecated(const Node &node)
   {
     bool step_node = false;
     // bool nb_sample_node = false;
@@ -1114,13 +1201,13 @@ public:
     // current data values.
     double d_stp = m_ecm.getSampleStep();
 
-    for (pugi::xml_node dataNode = node.first_child(); dataNode; dataNode = dataNode.next_sibling()) {
-      if (dataNode.type() == pugi::node_element) {
-        std::map<std::string, int>::const_iterator iter_data = m_nodeMap.find(dataNode.name());
-        if (iter_data != m_nodeMap.end()) {
-          switch (iter_data->second) {
+    for (Node dataNode = node.first_child(); !dataNode.empty(); dataNode = dataNode.next_sibling()) {
+      if (dataNode.isElement()) {
+        const int id = dataNode.id();
+        if (id >= 0) {
+          switch (id) {
           case step:
-            d_stp = dataNode.text().as_int();
+            d_stp = dataNode.as_int();
             step_node = true;
             break;
 
@@ -1145,6 +1232,12 @@ public:
   double getAngleAppear() const { return m_angleAppear; }
   double getAngleDisappear() const { return m_angleDisappear; }
 
+  int getNodeId(const std::string &name) const
+  {
+    std::map<std::string, int>::const_iterator iter_data = m_nodeMap.find(name);
+    return iter_data != m_nodeMap.end() ? iter_data->second : -1;
+  }
+
   void getCameraParameters(vpCameraParameters &cam) const { cam = m_cam; }
 
   void getEdgeMe(vpMe &moving_edge) const { moving_edge = m_ecm; }
@@ -1179,6 +1272,7 @@ public:
   unsigned int getKltPyramidLevels() const { return m_kltPyramidLevels; }
   double getKltQuality() const { return m_kltQualityValue; }
   unsigned int getKltWindowSize() const { return m_kltWinSize; }
+  bool getKltUseNative() const { return m_kltUseNative; }
 
   bool getLodState() const { return m_useLod; }
   double getLodMinLineLengthThreshold() const { return m_minLineLengthThreshold; }
@@ -1230,6 +1324,7 @@ public:
   void setKltPyramidLevels(const unsigned int &pL) { m_kltPyramidLevels = pL; }
   void setKltQuality(const double &q) { m_kltQualityValue = q; }
   void setKltWindowSize(const unsigned int &w) { m_kltWinSize = w; }
+  void setKltUseNative(bool useNative) { m_kltUseNative = useNative; }
 
   void setNearClippingDistance(const double &nclip) { m_nearClipping = nclip; }
 
@@ -1282,6 +1377,8 @@ protected:
   unsigned int m_kltBlockSize;
   //! Number of pyramid levels
   unsigned int m_kltPyramidLevels;
+  //! Use the native KLT implementation instead of the OpenCV one
+  bool m_kltUseNative;
   // Depth normal
   //! Feature estimation method
   vpMbtFaceDepthNormal::vpFeatureEstimationType m_depthNormalFeatureEstimationMethod;
@@ -1352,6 +1449,7 @@ protected:
     harris,
     size_block,
     pyramid_lvl,
+    use_native,
     //<depth_normal>
     depth_normal,
     feature_estimation_method,
@@ -1423,6 +1521,7 @@ protected:
     m_nodeMap["harris"] = harris;
     m_nodeMap["size_block"] = size_block;
     m_nodeMap["pyramid_lvl"] = pyramid_lvl;
+    m_nodeMap["use_native"] = use_native;
     //<depth_normal>
     m_nodeMap["depth_normal"] = depth_normal;
     m_nodeMap["feature_estimation_method"] = feature_estimation_method;
@@ -1472,6 +1571,29 @@ void vpMbtXmlGenericParser::parse(const std::string &filename)
   m_impl->parse(filename);
 }
 
+/*!
+  Apply a configuration parsed once by vpMbtXmlConfig, exactly as if its XML
+  file was parsed by parse(const std::string &), but without reading the file.
+
+  \param config : Parsed configuration, that is not modified.
+*/
+void vpMbtXmlGenericParser::parse(const vpMbtXmlConfig &config)
+{
+  m_impl->parse(config);
+}
+
+/*!
+  Return the identifier of an XML element name, or -1 if the parser does not
+  know this element. Used by vpMbtXmlConfig.
+
+  \param name : Element name.
+*/
+int vpMbtXmlGenericParser::getNodeId(const std::string &name)
+{
+  static const Impl impl;
+  return impl.getNodeId(name);
+}
+
 /*!
   Get the angle to determine if a face appeared.
 */
@@ -1645,6 +1767,15 @@ unsigned int vpMbtXmlGenericParser::getKltWindowSize() const
   return m_impl->getKltWindowSize();
 }
 
+/*!
+  Get if the native KLT implementation has to be used instead of the OpenCV
+  one.
+*/
+bool vpMbtXmlGenericParser::getKltUseNative() const
+{
+  return m_impl->getKltUseNative();
+}
+
 /*!
   Get the state of LOD setting.
 */
@@ -1920,6 +2051,17 @@ void vpMbtXmlGenericParser::setKltWindowSize(const unsigned int &w)
   m_impl->setKltWindowSize(w);
 }
 
+/*!
+  Set if the native KLT implementation has to be used instead of the OpenCV
+  one.
+
+  \param useNative : True to use vpKltNative, false to use vpKltOpencv.
+*/
+void vpMbtXmlGenericParser::setKltUseNative(bool useNative)
+{
+  m_impl->setKltUseNative(useNative);
+}
+
 /*!
   Set the near clipping distance.
 
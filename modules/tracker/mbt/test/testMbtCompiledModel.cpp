@@ -0,0 +1,296 @@
+/****************************************************************************
+ *
+ * ViSP, open source Visual Servoing Platform software.
+ * Copyright (C) 2005 - 2019 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test the compiled CAD model cache.
+ *
+ *****************************************************************************/
+
+#include <visp3/core/vpConfig.h>
+
+/*!
+  \example testMbtCompiledModel.cpp
+
+  \brief Test the compiled CAD model and the compiled model cache used by
+  vpMbTracker::loadModel().
+*/
+
+#if defined(VISP_HAVE_CATCH2)
+#define CATCH_CONFIG_RUNNER
+#include <catch.hpp>
+#include <fstream>
+
+#include <visp3/core/vpIoTools.h>
+#include <visp3/mbt/vpMbGenericTracker.h>
+#include <visp3/mbt/vpMbtCompiledModel.h>
+
+namespace
+{
+std::string getTmpDir()
+{
+#if defined(_WIN32)
+  std::string tmp_dir = "C:/temp/";
+#else
+  std::string tmp_dir = "/tmp/";
+#endif
+
+  // Get the user login name
+  std::string username;
+  vpIoTools::getUserName(username);
+  tmp_dir += username + "/testMbtCompiledModel/";
+  vpIoTools::makeDirectory(tmp_dir);
+
+  return tmp_dir;
+}
+
+void writeModel(const std::string &tmp_dir, double size)
+{
+  {
+    std::ofstream file(vpIoTools::createFilePath(tmp_dir, "base.cao").c_str());
+    file << "V1\n# Base of the model\n4\n";
+    file << "0 0 0\n" << size << " 0 0\n" << size << " " << size << " 0\n0 " << size << " 0\n";
+    file << "0\n0\n1\n4 0 1 2 3 name=base useLod=true minPolygonAreaThreshold=300\n0\n0\n";
+  }
+  {
+    std::ofstream file(vpIoTools::createFilePath(tmp_dir, "model.cao").c_str());
+    file << "V1\nload(\"base.cao\", t=[0; 0; 0.1])\n8\n";
+    file << "0 0 0\n0.1 0 0\n0.1 0.1 0\n0 0.1 0\n";
+    file << "0.05 0.05 0.2\n0.05 0.05 0.3\n0.1 0.05 0.2\n0.05 0.1 0.2\n";
+    file << "# Lines\n5\n0 1\n1 2\n2 3\n3 0 name=edge\n4 6 name=segment minLineLengthThreshold=20 useLod=true\n";
+    file << "# Faces from lines\n1\n4 0 1 2 3 name=\"bottom face\"\n";
+    file << "# Faces from points\n1\n3 0 1 4\n";
+    file << "# Cylinders\n1\n4 5 0.02 name=cylinder useLod=true minLineLengthThreshold=10\n";
+    file << "# Circles\n1\n0.03 4 6 7 name=circle\n";
+  }
+}
+
+void checkSameModel(vpMbGenericTracker &tracker1, vpMbGenericTracker &tracker2)
+{
+  vpMbHiddenFaces<vpMbtPolygon> &faces1 = tracker1.getFaces();
+  vpMbHiddenFaces<vpMbtPolygon> &faces2 = tracker2.getFaces();
+  REQUIRE(faces1.size() == faces2.size());
+  for (unsigned int i = 0; i < faces1.size(); i++) {
+    CHECK(faces1[i]->getIndex() == faces2[i]->getIndex());
+    CHECK(faces1[i]->getName() == faces2[i]->getName());
+    REQUIRE(faces1[i]->getNbPoint() == faces2[i]->getNbPoint());
+    for (unsigned int j = 0; j < faces1[i]->getNbPoint(); j++) {
+      CHECK(faces1[i]->getPoint(j).get_oX() == faces2[i]->getPoint(j).get_oX());
+      CHECK(faces1[i]->getPoint(j).get_oY() == faces2[i]->getPoint(j).get_oY());
+      CHECK(faces1[i]->getPoint(j).get_oZ() == faces2[i]->getPoint(j).get_oZ());
+    }
+  }
+
+  std::list<vpMbtDistanceLine *> lines1, lines2;
+  tracker1.getLline(lines1);
+  tracker2.getLline(lines2);
+  CHECK(lines1.size() == lines2.size());
+  std::list<vpMbtDistanceCylinder *> cylinders1, cylinders2;
+  tracker1.getLcylinder(cylinders1);
+  tracker2.getLcylinder(cylinders2);
+  CHECK(cylinders1.size() == cylinders2.size());
+  std::list<vpMbtDistanceCircle *> circles1, circles2;
+  tracker1.getLcircle(circles1);
+  tracker2.getLcircle(circles2);
+  CHECK(circles1.size() == circles2.size());
+}
+
+std::string readFile(const std::string &filename)
+{
+  std::ifstream file(filename.c_str(), std::ios::in | std::ios::binary);
+  return std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+}
+} // namespace
+
+TEST_CASE("Compiled model save and load", "[mbt]")
+{
+  std::string tmp_dir = getTmpDir();
+  std::string filename = vpIoTools::createFilePath(tmp_dir, "compiled.bin");
+  std::string source = vpIoTools::createFilePath(tmp_dir, "source.txt");
+  {
+    std::ofstream file(source.c_str());
+    file << "source";
+  }
+
+  {
+    vpMbtCompiledModel model;
+    std::vector<vpPoint> points;
+    points.push_back(vpPoint(0, 0, 0));
+    points.push_back(vpPoint(1, 0, 0));
+    points.push_back(vpPoint(1, 1, 0));
+    model.addPrimitive(vpMbtCompiledModel::FACE_FROM_CORNERS, points, 0, "face", true, 100, 10);
+    points.resize(2);
+    model.addPrimitive(vpMbtCompiledModel::CYLINDER, points, 0.5, "", false, 2500, 50);
+    model.addSource(source);
+    model.setSettingsHash(42);
+    model.save(filename);
+  }
+
+  vpMbtCompiledModel model;
+  REQUIRE(model.load(filename, 42));
+  REQUIRE(model.getNbPrimitives() == 2);
+  const vpMbtCompiledModel::vpPrimitive &face = model.getPrimitive(0);
+  CHECK(face.type == vpMbtCompiledModel::FACE_FROM_CORNERS);
+  CHECK(face.nbPoints == 3);
+  CHECK(model.getName(face) == "face");
+  CHECK(face.useLod == 1);
+  CHECK(face.minPolygonAreaThreshold == Approx(100));
+  CHECK(face.minLineLengthThreshold == Approx(10));
+  CHECK(model.getPoint(face, 2).get_oY() == Approx(1));
+  const vpMbtCompiledModel::vpPrimitive &cylinder = model.getPrimitive(1);
+  CHECK(cylinder.type == vpMbtCompiledModel::CYLINDER);
+  CHECK(cylinder.radius == Approx(0.5));
+  CHECK(model.getName(cylinder).empty());
+  CHECK(cylinder.useLod == 0);
+  CHECK_THROWS(model.getPrimitive(2));
+
+  // Settings changed
+  CHECK_FALSE(model.load(filename, 43));
+
+  // Corrupted name offset of the source, following its hash, that overflows when added to the name length
+  {
+    std::string content = readFile(filename);
+    uint64_t hash = vpMbtCompiledModel::computeFileHash(source);
+    size_t pos = content.find(std::string(reinterpret_cast<const char *>(&hash), sizeof(hash)));
+    REQUIRE(pos != std::string::npos);
+    std::string corrupted = content;
+    uint64_t nameOffset = ~static_cast<uint64_t>(0);
+    corrupted.replace(pos + sizeof(hash), sizeof(nameOffset), reinterpret_cast<const char *>(&nameOffset),
+                      sizeof(nameOffset));
+    {
+      std::ofstream file(filename.c_str(), std::ios::out | std::ios::binary);
+      file.write(corrupted.c_str(), static_cast<std::streamsize>(corrupted.size()));
+    }
+    CHECK_FALSE(model.load(filename, 42));
+    {
+      std::ofstream file(filename.c_str(), std::ios::out | std::ios::binary);
+      file.write(content.c_str(), static_cast<std::streamsize>(content.size()));
+    }
+    CHECK(model.load(filename, 42));
+  }
+
+  // Source changed
+  {
+    std::ofstream file(source.c_str());
+    file << "modified source";
+  }
+  CHECK_FALSE(model.load(filename, 42));
+
+  // Truncated file
+  std::string content = readFile(filename);
+  {
+    std::ofstream file(filename.c_str(), std::ios::out | std::ios::binary);
+    file.write(content.c_str(), static_cast<std::streamsize>(content.size() / 2));
+  }
+  CHECK_FALSE(model.load(filename, 42));
+  CHECK_FALSE(model.load(vpIoTools::createFilePath(tmp_dir, "missing.bin"), 42));
+
+  vpIoTools::remove(tmp_dir);
+}
+
+TEST_CASE("Compiled model cache in loadModel", "[mbt]")
+{
+  std::string tmp_dir = getTmpDir();
+  std::string cache_dir = vpIoTools::createFilePath(tmp_dir, "cache");
+  std::string cad_filename = vpIoTools::createFilePath(tmp_dir, "model.cao");
+  writeModel(tmp_dir, 0.1);
+
+  vpMbGenericTracker reference(1, vpMbGenericTracker::EDGE_TRACKER);
+  reference.loadModel(cad_filename);
+
+  // First load compiles the model
+  vpMbGenericTracker tracker1(1, vpMbGenericTracker::EDGE_TRACKER);
+  tracker1.setModelCacheEnabled(true);
+  tracker1.setModelCacheDirectory(cache_dir);
+  CHECK(tracker1.getModelCacheEnabled());
+  tracker1.loadModel(cad_filename);
+  std::vector<std::string> files = vpIoTools::getDirFiles(cache_dir);
+  REQUIRE(files.size() == 1);
+  std::string cache_filename = vpIoTools::createFilePath(cache_dir, files[0]);
+  std::string compiled = readFile(cache_filename);
+  checkSameModel(reference, tracker1);
+
+  // Second load uses the compiled model
+  vpMbGenericTracker tracker2(1, vpMbGenericTracker::EDGE_TRACKER);
+  tracker2.setModelCacheEnabled(true);
+  tracker2.setModelCacheDirectory(cache_dir);
+  tracker2.loadModel(cad_filename);
+  CHECK(readFile(cache_filename) == compiled);
+  checkSameModel(reference, tracker2);
+
+  SECTION("Included file changed")
+  {
+    writeModel(tmp_dir, 0.2);
+    vpMbGenericTracker reference_modified(1, vpMbGenericTracker::EDGE_TRACKER);
+    reference_modified.loadModel(cad_filename);
+
+    vpMbGenericTracker tracker3(1, vpMbGenericTracker::EDGE_TRACKER);
+    tracker3.setModelCacheEnabled(true);
+    tracker3.setModelCacheDirectory(cache_dir);
+    tracker3.loadModel(cad_filename);
+    CHECK(readFile(cache_filename) != compiled);
+    checkSameModel(reference_modified, tracker3);
+  }
+
+  SECTION("Model transformation changed")
+  {
+    vpHomogeneousMatrix T(0.1, 0.2, 0.3, 0, 0, vpMath::rad(30));
+    vpMbGenericTracker reference_transformed(1, vpMbGenericTracker::EDGE_TRACKER);
+    reference_transformed.loadModel(cad_filename, false, T);
+
+    vpMbGenericTracker tracker3(1, vpMbGenericTracker::EDGE_TRACKER);
+    tracker3.setModelCacheEnabled(true);
+    tracker3.setModelCacheDirectory(cache_dir);
+    tracker3.loadModel(cad_filename, false, T);
+    checkSameModel(reference_transformed, tracker3);
+  }
+
+  vpIoTools::remove(tmp_dir);
+}
+
+int main(int argc, char *argv[])
+{
+  Catch::Session session; // There must be exactly one instance
+
+  // Let Catch (using Clara) parse the command line
+  session.applyCommandLine(argc, argv);
+
+  int numFailed = session.run();
+
+  // numFailed is clamped to 255 as some unices only use the lower 8 bits.
+  // This clamping has already been applied, so just return it here
+  // You can also do any post run clean-up here
+  return numFailed;
+}
+#else
+int main()
+{
+  return 0;
+}
+#endif
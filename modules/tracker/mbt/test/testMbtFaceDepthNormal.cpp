@@ -0,0 +1,252 @@
+/****************************************************************************
+ *
+ * ViSP, open source Visual Servoing Platform software.
+ * Copyright (C) 2005 - 2019 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test depth normal face plane estimation.
+ *
+ *****************************************************************************/
+
+
+#include <visp3/core/vpConfig.h>
+
+/*!
+  \example testMbtFaceDepthNormal.cpp
+
+  \brief Test depth normal face plane estimation.
+*/
+
+#if defined(VISP_HAVE_CATCH2)
+#define CATCH_CONFIG_RUNNER
+#include <catch.hpp>
+#include <fstream>
+
+#include <visp3/core/vpIoTools.h>
+#include <visp3/core/vpPixelMeterConversion.h>
+#include <visp3/core/vpUniRand.h>
+#include <visp3/mbt/vpMbDepthNormalTracker.h>
+#include <visp3/mbt/vpMbtFaceDepthNormal.h>
+
+namespace
+{
+// Render the depth map of the z=0 object plane, with outliers
+void renderPlane(const vpHomogeneousMatrix &cMo, const vpCameraParameters &cam, float depth_scale,
+                 vpImage<uint16_t> &I_depth_raw)
+{
+  vpPlane plane(0, 0, 1, 0);
+  plane.changeFrame(cMo);
+  vpUniRand rng;
+
+  for (unsigned int i = 0; i < I_depth_raw.getHeight(); i++) {
+    for (unsigned int j = 0; j < I_depth_raw.getWidth(); j++) {
+      double x = 0, y = 0;
+      vpPixelMeterConversion::convertPoint(cam, j, i, x, y);
+      double Z = -plane.getD() / (plane.getA() * x + plane.getB() * y + plane.getC());
+      double noise = rng() < 0.1 ? 0.05 * rng() : 0.002 * (rng() - 0.5);
+      I_depth_raw[i][j] = static_cast<uint16_t>(vpMath::round((Z + noise) / depth_scale));
+    }
+  }
+}
+
+// Render the depth map of the [-size, 0] x [0, size] x [0, size] cube by ray casting
+void renderCube(const vpHomogeneousMatrix &cMo, const vpCameraParameters &cam, double size, float depth_scale,
+                vpImage<uint16_t> &I_depth_raw)
+{
+  vpHomogeneousMatrix oMc = cMo.inverse();
+  const double box_min[3] = {-size, 0, 0}, box_max[3] = {0, size, size};
+
+  for (unsigned int i = 0; i < I_depth_raw.getHeight(); i++) {
+    for (unsigned int j = 0; j < I_depth_raw.getWidth(); j++) {
+      double x = 0, y = 0;
+      vpPixelMeterConversion::convertPoint(cam, j, i, x, y);
+
+      // Ray origin and direction (with a unit z-component in the camera frame) in the object frame
+      double t_near = 0, t_far = std::numeric_limits<double>::max();
+      for (unsigned int k = 0; k < 3; k++) {
+        double o = oMc[k][3], d = oMc[k][0] * x + oMc[k][1] * y + oMc[k][2];
+        if (std::fabs(d) < std::numeric_limits<double>::epsilon()) {
+          if (o < box_min[k] || o > box_max[k]) {
+            t_far = -1;
+          }
+        } else {
+          double t1 = (box_min[k] - o) / d, t2 = (box_max[k] - o) / d;
+          t_near = std::max(t_near, std::min(t1, t2));
+          t_far = std::min(t_far, std::max(t1, t2));
+        }
+      }
+
+      I_depth_raw[i][j] = t_near < t_far ? static_cast<uint16_t>(vpMath::round(t_near / depth_scale)) : 0;
+    }
+  }
+}
+}
+
+TEST_CASE("Depth normal plane estimation from the point moments", "[depth_normal]")
+{
+  const double half_size = 0.1;
+  vpMbtPolygon polygon;
+  polygon.setNbPoint(4);
+  polygon.addPoint(0, vpPoint(-half_size, -half_size, 0));
+  polygon.addPoint(1, vpPoint(half_size, -half_size, 0));
+  polygon.addPoint(2, vpPoint(half_size, half_size, 0));
+  polygon.addPoint(3, vpPoint(-half_size, half_size, 0));
+  polygon.setIndex(0);
+
+  vpCameraParameters cam(300.0, 300.0, 160.0, 120.0);
+  vpHomogeneousMatrix cMo(0.01, -0.02, 0.5, 0.2, -0.3, 0.1);
+  const float depth_scale = 0.0001f;
+  vpImage<uint16_t> I_depth_raw(240, 320);
+  renderPlane(cMo, cam, depth_scale, I_depth_raw);
+
+  vpPointCloud point_cloud;
+  point_cloud.buildFrom(I_depth_raw, cam, depth_scale);
+
+  vpMbtFaceDepthNormal face;
+  face.m_polygon = &polygon;
+  face.m_cam = cam;
+  face.m_planeObject = vpPlane(polygon.p[0], polygon.p[1], polygon.p[2], vpPlane::object_frame);
+
+  // Pose slightly different from the one used to render the depth map
+  vpHomogeneousMatrix cMo_est(0.012, -0.018, 0.51, 0.21, -0.29, 0.1);
+
+  vpColVector features_svd, features_moments;
+  face.setFeatureEstimationMethod(vpMbtFaceDepthNormal::ROBUST_SVD_PLANE_ESTIMATION);
+  REQUIRE(face.computeDesiredFeatures(cMo_est, point_cloud, features_svd, 2, 2));
+
+  face.setFeatureEstimationMethod(vpMbtFaceDepthNormal::ROBUST_MOMENTS_PLANE_ESTIMATION);
+  REQUIRE(face.computeDesiredFeatures(cMo_est, point_cloud, features_moments, 2, 2));
+
+  // Features are -n/D of the plane in the camera frame
+  vpPlane plane(0, 0, 1, 0);
+  plane.changeFrame(cMo);
+  REQUIRE(features_moments.size() == 3);
+  CHECK(features_moments[0] == Approx(-plane.getA() / plane.getD()).margin(1e-2));
+  CHECK(features_moments[1] == Approx(-plane.getB() / plane.getD()).margin(1e-2));
+  CHECK(features_moments[2] == Approx(-plane.getC() / plane.getD()).margin(1e-2));
+
+  for (unsigned int i = 0; i < 3; i++) {
+    CHECK(features_moments[i] == Approx(features_svd[i]).epsilon(1e-6));
+  }
+}
+
+TEST_CASE("Depth normal tracking with the moments plane estimation", "[depth_normal]")
+{
+  const double size = 0.042;
+#if defined(_WIN32)
+  std::string tmp_dir = "C:/temp/";
+#else
+  std::string tmp_dir = "/tmp/";
+#endif
+
+  // Get the user login name
+  std::string username;
+  vpIoTools::getUserName(username);
+  tmp_dir += username + "/testMbtFaceDepthNormal/";
+  vpIoTools::makeDirectory(tmp_dir);
+  std::string cad_filename = vpIoTools::createFilePath(tmp_dir, "cube.cao");
+  {
+    std::ofstream file(cad_filename.c_str());
+    file << "V1\n8\n";
+    file << "0 0 0\n" << -size << " 0 0\n" << -size << " " << size << " 0\n0 " << size << " 0\n";
+    file << "0 0 " << size << "\n" << -size << " 0 " << size << "\n" << -size << " " << size << " " << size << "\n";
+    file << "0 " << size << " " << size << "\n";
+    file << "0\n0\n6\n4 0 4 5 1\n4 1 5 6 2\n4 6 7 3 2\n4 3 7 4 0\n4 0 1 2 3\n4 7 6 5 4\n0\n0\n";
+  }
+
+  // Camera looking at the cube center so that three faces are visible
+  vpColVector center(3), direction(3), up(3);
+  center[0] = -size / 2;
+  center[1] = size / 2;
+  center[2] = size / 2;
+  direction[0] = -1;
+  direction[1] = 1;
+  direction[2] = 1;
+  direction.normalize();
+  up[0] = 1;
+  vpColVector zc = -direction;
+  vpColVector xc = vpColVector::crossProd(up, zc).normalize();
+  vpColVector yc = vpColVector::crossProd(zc, xc);
+  vpHomogeneousMatrix oMc;
+  for (unsigned int i = 0; i < 3; i++) {
+    oMc[i][0] = xc[i];
+    oMc[i][1] = yc[i];
+    oMc[i][2] = zc[i];
+    oMc[i][3] = center[i] + 0.25 * direction[i];
+  }
+  vpHomogeneousMatrix cMo = oMc.inverse();
+
+  vpCameraParameters cam(300.0, 300.0, 160.0, 120.0);
+  const float depth_scale = 0.0001f;
+  vpImage<uint16_t> I_depth_raw(240, 320);
+  renderCube(cMo, cam, size, depth_scale, I_depth_raw);
+  vpPointCloud point_cloud;
+  point_cloud.buildFrom(I_depth_raw, cam, depth_scale);
+
+  vpImage<unsigned char> I(I_depth_raw.getHeight(), I_depth_raw.getWidth());
+  vpHomogeneousMatrix cMo_init = vpHomogeneousMatrix(0.003, -0.002, 0.004, vpMath::rad(1), vpMath::rad(-1), 0) * cMo;
+
+  vpMbDepthNormalTracker tracker;
+  tracker.setCameraParameters(cam);
+  tracker.setDepthNormalSamplingStep(2, 2);
+  tracker.setDepthNormalFeatureEstimationMethod(vpMbtFaceDepthNormal::ROBUST_MOMENTS_PLANE_ESTIMATION);
+  tracker.loadModel(cad_filename);
+  tracker.initFromPose(I, cMo_init);
+
+  for (int iter = 0; iter < 5; iter++) {
+    tracker.track(point_cloud);
+  }
+
+  vpPoseVector error(tracker.getPose() * cMo.inverse());
+  for (unsigned int j = 0; j < 6; j++) {
+    CHECK(error[j] == Approx(0).margin(1e-3));
+  }
+
+  vpIoTools::remove(tmp_dir);
+}
+
+int main(int argc, char *argv[])
+{
+  Catch::Session session; // There must be exactly one instance
+
+  // Let Catch (using Clara) parse the command line
+  session.applyCommandLine(argc, argv);
+
+  int numFailed = session.run();
+
+  // numFailed is clamped to 255 as some unices only use the lower 8 bits.
+  // This clamping has already been applied, so just return it here
+  // You can also do any post run clean-up here
+  return numFailed;
+}
+#else
+int main()
+{
+  return 0;
+}
+#endif
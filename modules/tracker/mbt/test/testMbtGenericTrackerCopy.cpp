@@ -0,0 +1,299 @@
+/****************************************************************************
+ *
+ * ViSP, open source Visual Servoing Platform software.
+ * Copyright (C) 2005 - 2019 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test vpMbGenericTracker copy and assignment.
+ *
+ *****************************************************************************/
+
+#include <visp3/core/vpConfig.h>
+
+/*!
+  \example testMbtGenericTrackerCopy.cpp
+
+  \brief Test that a copy of vpMbGenericTracker, or a tracker restored by
+  assignment, tracks exactly as the original one.
+*/
+
+#if defined(VISP_HAVE_CATCH2)
+#define CATCH_CONFIG_RUNNER
+#include <catch.hpp>
+#include <fstream>
+
+#include <visp3/core/vpIoTools.h>
+#include <visp3/core/vpPixelMeterConversion.h>
+#include <visp3/core/vpUniRand.h>
+#include <visp3/mbt/vpMbGenericTracker.h>
+
+namespace
+{
+struct vpBlob {
+  vpColVector center;
+  double sigma;
+  double amplitude;
+};
+
+// Gaussian blobs spread over the [-size, 0] x [0, size] x [0, size] cube
+std::vector<vpBlob> generateTexture(double size)
+{
+  vpUniRand rng(1234);
+  std::vector<vpBlob> blobs(1500);
+  for (size_t k = 0; k < blobs.size(); k++) {
+    blobs[k].center.resize(3);
+    blobs[k].center[0] = rng.uniform(-1.1 * size, 0.1 * size);
+    blobs[k].center[1] = rng.uniform(-0.1 * size, 1.1 * size);
+    blobs[k].center[2] = rng.uniform(-0.1 * size, 1.1 * size);
+    blobs[k].sigma = rng.uniform(0.015 * size, 0.04 * size);
+    blobs[k].amplitude = rng.uniform(-80.0, 80.0);
+  }
+
+  return blobs;
+}
+
+// Render the textured cube by ray casting
+void renderCube(const vpHomogeneousMatrix &cMo, const vpCameraParameters &cam, double size,
+                const std::vector<vpBlob> &blobs, vpImage<unsigned char> &I)
+{
+  vpHomogeneousMatrix oMc = cMo.inverse();
+  const double bmin[3] = {-size, 0, 0};
+  const double bmax[3] = {0, size, size};
+
+  for (unsigned int i = 0; i < I.getHeight(); i++) {
+    for (unsigned int j = 0; j < I.getWidth(); j++) {
+      double x = 0, y = 0;
+      vpPixelMeterConversion::convertPoint(cam, j, i, x, y);
+      // Ray expressed in the object frame
+      double origin[3], dir[3];
+      for (unsigned int k = 0; k < 3; k++) {
+        origin[k] = oMc[k][3];
+        dir[k] = oMc[k][0] * x + oMc[k][1] * y + oMc[k][2];
+      }
+
+      double t_near = -std::numeric_limits<double>::max(), t_far = std::numeric_limits<double>::max();
+      for (unsigned int k = 0; k < 3; k++) {
+        double t1 = (bmin[k] - origin[k]) / dir[k];
+        double t2 = (bmax[k] - origin[k]) / dir[k];
+        t_near = std::max(t_near, std::min(t1, t2));
+        t_far = std::min(t_far, std::max(t1, t2));
+      }
+
+      if (t_near > t_far || t_far < 0) {
+        I[i][j] = 20;
+        continue;
+      }
+
+      double val = 128;
+      for (size_t k = 0; k < blobs.size(); k++) {
+        double d2 = 0;
+        for (unsigned int l = 0; l < 3; l++) {
+          d2 += vpMath::sqr(origin[l] + t_near * dir[l] - blobs[k].center[l]);
+        }
+        if (d2 < vpMath::sqr(3 * blobs[k].sigma)) {
+          val += blobs[k].amplitude * exp(-d2 / (2 * vpMath::sqr(blobs[k].sigma)));
+        }
+      }
+      I[i][j] = static_cast<unsigned char>(std::max(0, std::min(255, vpMath::round(val))));
+    }
+  }
+}
+
+void writeCubeModel(const std::string &cad_filename, double size)
+{
+  std::ofstream file(cad_filename.c_str());
+  file << "V1\n8\n";
+  file << "0 0 0\n" << -size << " 0 0\n" << -size << " " << size << " 0\n0 " << size << " 0\n";
+  file << "0 0 " << size << "\n" << -size << " 0 " << size << "\n" << -size << " " << size << " " << size << "\n";
+  file << "0 " << size << " " << size << "\n";
+  file << "0\n0\n6\n4 0 4 5 1\n4 1 5 6 2\n4 6 7 3 2\n4 3 7 4 0\n4 0 1 2 3\n4 7 6 5 4\n0\n0\n";
+}
+
+vpHomogeneousMatrix initialPose(double size)
+{
+  // Camera looking at the cube center so that three faces are visible
+  vpColVector center(3), direction(3), up(3);
+  center[0] = -size / 2;
+  center[1] = size / 2;
+  center[2] = size / 2;
+  direction[0] = -1;
+  direction[1] = 1;
+  direction[2] = 1;
+  direction.normalize();
+  up[0] = 1;
+  vpColVector zc = -direction;
+  vpColVector xc = vpColVector::crossProd(up, zc).normalize();
+  vpColVector yc = vpColVector::crossProd(zc, xc);
+  vpHomogeneousMatrix oMc;
+  for (unsigned int i = 0; i < 3; i++) {
+    oMc[i][0] = xc[i];
+    oMc[i][1] = yc[i];
+    oMc[i][2] = zc[i];
+    oMc[i][3] = center[i] + 0.4 * direction[i];
+  }
+
+  return oMc.inverse();
+}
+
+vpHomogeneousMatrix groundTruth(const vpHomogeneousMatrix &cMo, int iter)
+{
+  return vpHomogeneousMatrix(0.002 * iter, -0.001 * iter, 0.003 * iter, vpMath::rad(0.4 * iter),
+                             vpMath::rad(-0.3 * iter), vpMath::rad(0.5 * iter)) *
+         cMo;
+}
+
+void checkPoses(const std::vector<vpHomogeneousMatrix> &poses1, const std::vector<vpHomogeneousMatrix> &poses2)
+{
+  REQUIRE(poses1.size() == poses2.size());
+  for (size_t i = 0; i < poses1.size(); i++) {
+    for (unsigned int j = 0; j < 12; j++) {
+      CHECK(poses1[i].data[j] == Approx(poses2[i].data[j]).margin(1e-9));
+    }
+  }
+}
+} // namespace
+
+TEST_CASE("Copy and assignment of vpMbGenericTracker", "[mbt]")
+{
+  const double size = 0.1;
+#if defined(_WIN32)
+  std::string tmp_dir = "C:/temp/";
+#else
+  std::string tmp_dir = "/tmp/";
+#endif
+
+  // Get the user login name
+  std::string username;
+  vpIoTools::getUserName(username);
+  tmp_dir += username + "/testMbtGenericTrackerCopy/";
+  vpIoTools::makeDirectory(tmp_dir);
+  std::string cad_filename = vpIoTools::createFilePath(tmp_dir, "cube.cao");
+  writeCubeModel(cad_filename, size);
+
+  vpHomogeneousMatrix cMo = initialPose(size);
+  vpCameraParameters cam(600.0, 600.0, 240.0, 180.0);
+  std::vector<vpBlob> blobs = generateTexture(size);
+  std::vector<vpImage<unsigned char> > images(7, vpImage<unsigned char>(360, 480));
+  for (int iter = 0; iter < (int)images.size(); iter++) {
+    renderCube(groundTruth(cMo, iter), cam, size, blobs, images[(size_t)iter]);
+  }
+
+  std::vector<int> trackerTypes;
+#if defined(VISP_HAVE_MODULE_KLT)
+  trackerTypes.push_back(vpMbGenericTracker::EDGE_TRACKER | vpMbGenericTracker::KLT_TRACKER);
+#else
+  trackerTypes.push_back(vpMbGenericTracker::EDGE_TRACKER);
+#endif
+  vpMbGenericTracker *tracker = new vpMbGenericTracker(trackerTypes);
+#if defined(VISP_HAVE_MODULE_KLT)
+  tracker->setKltImplementation(vpMbKltTracker::KLT_NATIVE);
+  tracker->setKltMaskBorder(5);
+#endif
+  vpMe me;
+  me.setMaskSize(5);
+  me.setMaskNumber(180);
+  me.setRange(8);
+  me.setThreshold(10000);
+  me.setMu1(0.5);
+  me.setMu2(0.5);
+  me.setSampleStep(4);
+  tracker->setMovingEdge(me);
+  tracker->setCameraParameters(cam);
+  tracker->loadModel(cad_filename);
+  tracker->initFromPose(images[0], cMo);
+
+  // Track the first frames, then save the tracking state
+  for (size_t i = 1; i < 4; i++) {
+    tracker->track(images[i]);
+  }
+  vpMbGenericTracker snapshot(*tracker);
+
+  std::vector<vpHomogeneousMatrix> poses;
+  for (size_t i = 4; i < images.size(); i++) {
+    tracker->track(images[i]);
+    poses.push_back(tracker->getPose());
+
+    vpPoseVector error(tracker->getPose() * groundTruth(cMo, (int)i).inverse());
+    for (unsigned int j = 0; j < 3; j++) {
+      CHECK(error[j] == Approx(0).margin(5e-3));
+      CHECK(error[j + 3] == Approx(0).margin(vpMath::rad(1)));
+    }
+  }
+
+  SECTION("Copy")
+  {
+    // The copy must not depend on the original tracker
+    vpMbGenericTracker *clone = new vpMbGenericTracker(snapshot);
+    delete tracker;
+    tracker = NULL;
+
+    std::vector<vpHomogeneousMatrix> poses_clone;
+    for (size_t i = 4; i < images.size(); i++) {
+      clone->track(images[i]);
+      poses_clone.push_back(clone->getPose());
+    }
+    checkPoses(poses, poses_clone);
+    delete clone;
+  }
+
+  SECTION("Assignment")
+  {
+    *tracker = snapshot;
+
+    std::vector<vpHomogeneousMatrix> poses_restored;
+    for (size_t i = 4; i < images.size(); i++) {
+      tracker->track(images[i]);
+      poses_restored.push_back(tracker->getPose());
+    }
+    checkPoses(poses, poses_restored);
+  }
+
+  delete tracker;
+  vpIoTools::remove(tmp_dir);
+}
+
+int main(int argc, char *argv[])
+{
+  Catch::Session session; // There must be exactly one instance
+
+  // Let Catch (using Clara) parse the command line
+  session.applyCommandLine(argc, argv);
+
+  int numFailed = session.run();
+
+  // numFailed is clamped to 255 as some unices only use the lower 8 bits.
+  // This clamping has already been applied, so just return it here
+  // You can also do any post run clean-up here
+  return numFailed;
+}
+#else
+int main()
+{
+  return 0;
+}
+#endif
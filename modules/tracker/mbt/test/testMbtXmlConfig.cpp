@@ -0,0 +1,303 @@
+/****************************************************************************
+ *
+ * ViSP, open source Visual Servoing Platform software.
+ * Copyright (C) 2005 - 2019 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test the parsed configuration of the model-based trackers.
+ *
+ *****************************************************************************/
+
+
+#include <visp3/core/vpConfig.h>
+
+/*!
+  \example testMbtXmlConfig.cpp
+
+  \brief Test the parsed configuration vpMbtXmlConfig, its binary file and
+  its use by vpMbtXmlGenericParser and vpMbGenericTracker.
+*/
+
+#if defined(VISP_HAVE_CATCH2) && defined(VISP_HAVE_PUGIXML)
+#define CATCH_CONFIG_RUNNER
+#include <algorithm>
+#include <catch.hpp>
+#include <cstring>
+#include <fstream>
+
+#include <visp3/core/vpIoTools.h>
+#include <visp3/mbt/vpMbGenericTracker.h>
+#include <visp3/mbt/vpMbtXmlConfig.h>
+#include <visp3/mbt/vpMbtXmlGenericParser.h>
+
+namespace
+{
+std::string getTmpDir()
+{
+#if defined(_WIN32)
+  std::string tmp_dir = "C:/temp/";
+#else
+  std::string tmp_dir = "/tmp/";
+#endif
+
+  // Get the user login name
+  std::string username;
+  vpIoTools::getUserName(username);
+  tmp_dir += username + "/testMbtXmlConfig/";
+  vpIoTools::makeDirectory(tmp_dir);
+
+  return tmp_dir;
+}
+
+std::string writeConfig(const std::string &tmp_dir)
+{
+  std::string filename = vpIoTools::createFilePath(tmp_dir, "config.xml");
+  std::ofstream file(filename.c_str());
+  file << "<?xml version=\"1.0\"?>\n"
+       << "<conf>\n"
+       << "  <!-- Moving edges -->\n"
+       << "  <ecm>\n"
+       << "    <mask><size>7</size><nb_mask>90</nb_mask></mask>\n"
+       << "    <range><tracking>6</tracking></range>\n"
+       << "    <contrast><edge_threshold>5000</edge_threshold><mu1>0.4</mu1><mu2>0.6</mu2></contrast>\n"
+       << "    <sample><step>3</step></sample>\n"
+       << "  </ecm>\n"
+       << "  <klt>\n"
+       << "    <mask_border>4</mask_border><max_features>300</max_features><window_size>7</window_size>\n"
+       << "    <quality>0.02</quality><min_distance>8</min_distance><harris>0.04</harris>\n"
+       << "    <size_block>5</size_block><pyramid_lvl>2</pyramid_lvl>\n"
+       << "  </klt>\n"
+       << "  <camera><u0>320.5</u0><v0>240.25</v0><px>600.125</px><py>601.75</py></camera>\n"
+       << "  <face>\n"
+       << "    <angle_appear>65</angle_appear><angle_disappear>75</angle_disappear>\n"
+       << "    <near_clipping>0.05</near_clipping><far_clipping>3.5</far_clipping>\n"
+       << "    <fov_clipping>1</fov_clipping>\n"
+       << "  </face>\n"
+       << "  <lod>\n"
+       << "    <use_lod>1</use_lod><min_line_length_threshold>40</min_line_length_threshold>\n"
+       << "    <min_polygon_area_threshold>2500</min_polygon_area_threshold>\n"
+       << "  </lod>\n"
+       << "  <projection_error><sample_step>9</sample_step><kernel_size>7x7</kernel_size></projection_error>\n"
+       << "  <unknown>ignored</unknown>\n"
+       << "</conf>\n";
+  return filename;
+}
+
+void checkEqual(vpMbtXmlGenericParser &xml, vpMbtXmlGenericParser &xml_ref)
+{
+  vpMe me, me_ref;
+  xml.getEdgeMe(me);
+  xml_ref.getEdgeMe(me_ref);
+  CHECK(me.getMaskSize() == me_ref.getMaskSize());
+  CHECK(me.getMaskNumber() == me_ref.getMaskNumber());
+  CHECK(me.getRange() == me_ref.getRange());
+  CHECK(me.getThreshold() == me_ref.getThreshold());
+  CHECK(me.getMu1() == me_ref.getMu1());
+  CHECK(me.getMu2() == me_ref.getMu2());
+  CHECK(me.getSampleStep() == me_ref.getSampleStep());
+
+  CHECK(xml.getKltMaskBorder() == xml_ref.getKltMaskBorder());
+  CHECK(xml.getKltMaxFeatures() == xml_ref.getKltMaxFeatures());
+  CHECK(xml.getKltWindowSize() == xml_ref.getKltWindowSize());
+  CHECK(xml.getKltQuality() == xml_ref.getKltQuality());
+  CHECK(xml.getKltMinDistance() == xml_ref.getKltMinDistance());
+  CHECK(xml.getKltHarrisParam() == xml_ref.getKltHarrisParam());
+  CHECK(xml.getKltBlockSize() == xml_ref.getKltBlockSize());
+  CHECK(xml.getKltPyramidLevels() == xml_ref.getKltPyramidLevels());
+
+  vpCameraParameters cam, cam_ref;
+  xml.getCameraParameters(cam);
+  xml_ref.getCameraParameters(cam_ref);
+  CHECK((cam == cam_ref));
+
+  CHECK(xml.getAngleAppear() == xml_ref.getAngleAppear());
+  CHECK(xml.getAngleDisappear() == xml_ref.getAngleDisappear());
+  CHECK(xml.getNearClippingDistance() == xml_ref.getNearClippingDistance());
+  CHECK(xml.getFarClippingDistance() == xml_ref.getFarClippingDistance());
+  CHECK(xml.getFovClipping() == xml_ref.getFovClipping());
+  CHECK(xml.getLodState() == xml_ref.getLodState());
+  CHECK(xml.getLodMinLineLengthThreshold() == xml_ref.getLodMinLineLengthThreshold());
+  CHECK(xml.getLodMinPolygonAreaThreshold() == xml_ref.getLodMinPolygonAreaThreshold());
+
+}
+} // namespace
+
+TEST_CASE("Parsed configuration", "[mbt]")
+{
+  std::string tmp_dir = getTmpDir();
+  std::string filename = writeConfig(tmp_dir);
+  const int parsers = vpMbtXmlGenericParser::EDGE_PARSER | vpMbtXmlGenericParser::KLT_PARSER;
+
+  vpMbtXmlGenericParser xml_ref(parsers);
+  xml_ref.parse(filename);
+  CHECK(xml_ref.getKltMaxFeatures() == 300);
+
+  vpMbtXmlConfig config(filename);
+  REQUIRE(!config.empty());
+  CHECK(config.getName(config.getNode(0)) == "conf");
+  // The unknown element and the comment are not kept
+  for (unsigned int i = 0; i < config.getNbNodes(); i++) {
+    CHECK(config.getNode(i).id >= 0);
+  }
+  CHECK_THROWS_AS(config.getNode(config.getNbNodes()), vpException);
+
+  SECTION("Parser")
+  {
+    vpMbtXmlGenericParser xml(parsers);
+    xml.parse(config);
+    checkEqual(xml, xml_ref);
+
+    vpMbtXmlGenericParser xml_proj(vpMbtXmlGenericParser::PROJECTION_ERROR_PARSER);
+    xml_proj.parse(config);
+    vpMe me_proj;
+    xml_proj.getProjectionErrorMe(me_proj);
+    CHECK(me_proj.getSampleStep() == 9.0);
+    CHECK(xml_proj.getProjectionErrorKernelSize() == 3);
+
+    vpMbtXmlGenericParser xml_empty(parsers);
+    CHECK_THROWS_AS(xml_empty.parse(vpMbtXmlConfig()), vpException);
+  }
+
+  SECTION("Binary file")
+  {
+    std::string binary_filename = vpIoTools::createFilePath(tmp_dir, "config.bin");
+    config.save(binary_filename);
+
+    vpMbtXmlConfig config_loaded;
+    config_loaded.load(binary_filename);
+    REQUIRE(config_loaded.getNbNodes() == config.getNbNodes());
+    for (unsigned int i = 0; i < config.getNbNodes(); i++) {
+      CHECK(config_loaded.getName(config_loaded.getNode(i)) == config.getName(config.getNode(i)));
+      CHECK(config_loaded.getText(config_loaded.getNode(i)) == config.getText(config.getNode(i)));
+      CHECK(config_loaded.getNode(i).asDouble == config.getNode(i).asDouble);
+    }
+
+    vpMbtXmlGenericParser xml(parsers);
+    xml.parse(config_loaded);
+    checkEqual(xml, xml_ref);
+  }
+
+  SECTION("Corrupted data")
+  {
+    std::vector<unsigned char> data;
+    config.encode(data);
+
+    vpMbtXmlConfig config_decoded;
+    config_decoded.decode(&data[0], data.size());
+    CHECK(config_decoded.getNbNodes() == config.getNbNodes());
+
+    CHECK_THROWS_AS(config_decoded.decode(&data[0], data.size() - 1), vpException);
+    CHECK(config_decoded.empty());
+
+    std::vector<unsigned char> bad_magic = data;
+    bad_magic[0] = 'X';
+    CHECK_THROWS_AS(config_decoded.decode(&bad_magic[0], bad_magic.size()), vpException);
+
+    // Make the last node point outside of the configuration
+    std::vector<unsigned char> bad_link = data;
+    vpMbtXmlConfig::vpNode node = config.getNode(config.getNbNodes() - 1);
+    std::vector<unsigned char>::iterator it =
+        std::search(bad_link.begin(), bad_link.end(), reinterpret_cast<const unsigned char *>(&node),
+                    reinterpret_cast<const unsigned char *>(&node) + sizeof(node));
+    REQUIRE(it != bad_link.end());
+    node.nextSibling = static_cast<int32_t>(config.getNbNodes());
+    std::memcpy(&*it, &node, sizeof(node));
+    CHECK_THROWS_AS(config_decoded.decode(&bad_link[0], bad_link.size()), vpException);
+
+    CHECK_THROWS_AS(config_decoded.load(vpIoTools::createFilePath(tmp_dir, "missing.bin")), vpException);
+  }
+
+  SECTION("Shared by several trackers")
+  {
+    std::vector<vpMbGenericTracker *> trackers;
+    for (unsigned int i = 0; i < 4; i++) {
+      trackers.push_back(new vpMbGenericTracker(1, vpMbGenericTracker::EDGE_TRACKER));
+      trackers.back()->loadConfigFile(config);
+    }
+    vpMbGenericTracker tracker_ref(1, vpMbGenericTracker::EDGE_TRACKER);
+    tracker_ref.loadConfigFile(filename);
+
+    vpCameraParameters cam_ref;
+    tracker_ref.getCameraParameters(cam_ref);
+    for (size_t i = 0; i < trackers.size(); i++) {
+      vpCameraParameters cam;
+      trackers[i]->getCameraParameters(cam);
+      CHECK((cam == cam_ref));
+      CHECK(trackers[i]->getMovingEdge().getMaskSize() == tracker_ref.getMovingEdge().getMaskSize());
+      CHECK(trackers[i]->getMovingEdge().getThreshold() == tracker_ref.getMovingEdge().getThreshold());
+      CHECK(trackers[i]->getAngleAppear() == tracker_ref.getAngleAppear());
+      CHECK(trackers[i]->getFarClippingDistance() == tracker_ref.getFarClippingDistance());
+      delete trackers[i];
+    }
+
+    // The errors of the configuration are not hidden by the tracker
+    std::string invalid_filename = vpIoTools::createFilePath(tmp_dir, "invalid.xml");
+    {
+      std::ofstream file(invalid_filename.c_str());
+      file << "<?xml version=\"1.0\"?>\n"
+           << "<conf><ecm><mask><nb_mask>0</nb_mask></mask></ecm></conf>\n";
+    }
+    vpMbtXmlConfig config_invalid(invalid_filename);
+    vpMbGenericTracker tracker(1, vpMbGenericTracker::EDGE_TRACKER);
+    try {
+      tracker.loadConfigFile(config_invalid);
+      FAIL("The invalid configuration is accepted");
+    } catch (vpException &e) {
+      CHECK(e.getCode() == vpException::badValue);
+    }
+    try {
+      tracker.loadConfigFile(vpMbtXmlConfig());
+      FAIL("The empty configuration is accepted");
+    } catch (vpException &e) {
+      CHECK(e.getCode() == vpException::notInitialized);
+    }
+  }
+
+  vpIoTools::remove(tmp_dir);
+}
+
+int main(int argc, char *argv[])
+{
+  Catch::Session session; // There must be exactly one instance
+
+  // Let Catch (using Clara) parse the command line
+  session.applyCommandLine(argc, argv);
+
+  int numFailed = session.run();
+
+  // numFailed is clamped to 255 as some unices only use the lower 8 bits.
+  // This clamping has already been applied, so just return it here
+  // You can also do any post run clean-up here
+  return numFailed;
+}
+#else
+int main()
+{
+  return 0;
+}
+#endif
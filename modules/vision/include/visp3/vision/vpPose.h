@@ -48,6 +48,7 @@
 
 #include <visp3/core/vpHomogeneousMatrix.h>
 #include <visp3/core/vpPoint.h>
+#include <visp3/core/vpPointCloud.h>
 #include <visp3/core/vpRGBa.h>
 #include <visp3/vision/vpHomography.h>
 #ifdef VISP_BUILD_DEPRECATED_FUNCTIONS
@@ -349,6 +350,9 @@ public:
   static bool computePlanarObjectPoseFromRGBD(const vpImage<float> &depthMap, const std::vector<vpImagePoint> &corners,
                                               const vpCameraParameters &colorIntrinsics, const std::vector<vpPoint> &point3d, vpHomogeneousMatrix &cMo,
                                               double *confidence_index = NULL);
+  static bool computePlanarObjectPoseFromRGBD(const vpPointCloud &pointCloud, const std::vector<vpImagePoint> &corners,
+                                              const vpCameraParameters &colorIntrinsics, const std::vector<vpPoint> &point3d, vpHomogeneousMatrix &cMo,
+                                              double *confidence_index = NULL);
 
 #if defined(VISP_BUILD_DEPRECATED_FUNCTIONS)
   /*!